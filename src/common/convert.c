@@ -22,6 +22,27 @@
 #include "extractor.h"
 #include "convert.h"
 
+/**
+ * Make a 0-terminated copy of the input.
+ *
+ * @param input string to copy (not necessarily 0-terminated)
+ * @param len number of bytes in input
+ * @return the copy, NULL on error
+ */
+static char *
+copy_input (const char *input,
+	    size_t len)
+{
+  char *ret;
+
+  if (NULL == (ret = malloc (len + 1)))
+    return NULL;
+  memcpy (ret, input, len);
+  ret[len] = '\0';
+  return ret;
+}
+
+
 /**
  * Convert the len characters long character sequence
  * given in input that is in the given charset
@@ -52,7 +73,7 @@ EXTRACTOR_common_convert_to_utf8 (const char *input,
   i = input;
   cd = iconv_open ("UTF-8", charset);
   if (cd == (iconv_t) - 1)
-    return strdup (i);
+    return copy_input (i, len);
   if (len > 1024 * 1024)
     {
       iconv_close (cd);
@@ -71,7 +92,7 @@ EXTRACTOR_common_convert_to_utf8 (const char *input,
     {
       iconv_close (cd);
       free (tmp);
-      return strdup (i);
+      return copy_input (i, input - i + len);
     }
   ret = malloc (tmpSize - finSize + 1);
   if (ret == NULL)
@@ -86,12 +107,7 @@ EXTRACTOR_common_convert_to_utf8 (const char *input,
   iconv_close (cd);
   return ret;
 #else
-  char *ret;
-
-  ret = malloc (len + 1);
-  memcpy (ret, input, len);
-  ret[len] = '\0';
-  return ret;
+  return copy_input (input, len);
 #endif
 }
 
@@ -0,0 +1,205 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file common/genres.c
+ * @brief the genre list of ID3v1 (also used by iTunes)
+ */
+#include "genres.h"
+
+
+/**
+ * Genres as defined by ID3v1 (and the Winamp extensions).
+ */
+static const char * const genre_names[] =
+  {
+    gettext_noop ("Blues"),
+    gettext_noop ("Classic Rock"),
+    gettext_noop ("Country"),
+    gettext_noop ("Dance"),
+    gettext_noop ("Disco"),
+    gettext_noop ("Funk"),
+    gettext_noop ("Grunge"),
+    gettext_noop ("Hip-Hop"),
+    gettext_noop ("Jazz"),
+    gettext_noop ("Metal"),
+    gettext_noop ("New Age"),
+    gettext_noop ("Oldies"),
+    gettext_noop ("Other"),
+    gettext_noop ("Pop"),
+    gettext_noop ("R&B"),
+    gettext_noop ("Rap"),
+    gettext_noop ("Reggae"),
+    gettext_noop ("Rock"),
+    gettext_noop ("Techno"),
+    gettext_noop ("Industrial"),
+    gettext_noop ("Alternative"),
+    gettext_noop ("Ska"),
+    gettext_noop ("Death Metal"),
+    gettext_noop ("Pranks"),
+    gettext_noop ("Soundtrack"),
+    gettext_noop ("Euro-Techno"),
+    gettext_noop ("Ambient"),
+    gettext_noop ("Trip-Hop"),
+    gettext_noop ("Vocal"),
+    gettext_noop ("Jazz+Funk"),
+    gettext_noop ("Fusion"),
+    gettext_noop ("Trance"),
+    gettext_noop ("Classical"),
+    gettext_noop ("Instrumental"),
+    gettext_noop ("Acid"),
+    gettext_noop ("House"),
+    gettext_noop ("Game"),
+    gettext_noop ("Sound Clip"),
+    gettext_noop ("Gospel"),
+    gettext_noop ("Noise"),
+    gettext_noop ("Alt. Rock"),
+    gettext_noop ("Bass"),
+    gettext_noop ("Soul"),
+    gettext_noop ("Punk"),
+    gettext_noop ("Space"),
+    gettext_noop ("Meditative"),
+    gettext_noop ("Instrumental Pop"),
+    gettext_noop ("Instrumental Rock"),
+    gettext_noop ("Ethnic"),
+    gettext_noop ("Gothic"),
+    gettext_noop ("Darkwave"),
+    gettext_noop ("Techno-Industrial"),
+    gettext_noop ("Electronic"),
+    gettext_noop ("Pop-Folk"),
+    gettext_noop ("Eurodance"),
+    gettext_noop ("Dream"),
+    gettext_noop ("Southern Rock"),
+    gettext_noop ("Comedy"),
+    gettext_noop ("Cult"),
+    gettext_noop ("Gangsta Rap"),
+    gettext_noop ("Top 40"),
+    gettext_noop ("Christian Rap"),
+    gettext_noop ("Pop/Funk"),
+    gettext_noop ("Jungle"),
+    gettext_noop ("Native American"),
+    gettext_noop ("Cabaret"),
+    gettext_noop ("New Wave"),
+    gettext_noop ("Psychedelic"),
+    gettext_noop ("Rave"),
+    gettext_noop ("Showtunes"),
+    gettext_noop ("Trailer"),
+    gettext_noop ("Lo-Fi"),
+    gettext_noop ("Tribal"),
+    gettext_noop ("Acid Punk"),
+    gettext_noop ("Acid Jazz"),
+    gettext_noop ("Polka"),
+    gettext_noop ("Retro"),
+    gettext_noop ("Musical"),
+    gettext_noop ("Rock & Roll"),
+    gettext_noop ("Hard Rock"),
+    gettext_noop ("Folk"),
+    gettext_noop ("Folk/Rock"),
+    gettext_noop ("National Folk"),
+    gettext_noop ("Swing"),
+    gettext_noop ("Fast-Fusion"),
+    gettext_noop ("Bebop"),
+    gettext_noop ("Latin"),
+    gettext_noop ("Revival"),
+    gettext_noop ("Celtic"),
+    gettext_noop ("Bluegrass"),
+    gettext_noop ("Avantgarde"),
+    gettext_noop ("Gothic Rock"),
+    gettext_noop ("Progressive Rock"),
+    gettext_noop ("Psychedelic Rock"),
+    gettext_noop ("Symphonic Rock"),
+    gettext_noop ("Slow Rock"),
+    gettext_noop ("Big Band"),
+    gettext_noop ("Chorus"),
+    gettext_noop ("Easy Listening"),
+    gettext_noop ("Acoustic"),
+    gettext_noop ("Humour"),
+    gettext_noop ("Speech"),
+    gettext_noop ("Chanson"),
+    gettext_noop ("Opera"),
+    gettext_noop ("Chamber Music"),
+    gettext_noop ("Sonata"),
+    gettext_noop ("Symphony"),
+    gettext_noop ("Booty Bass"),
+    gettext_noop ("Primus"),
+    gettext_noop ("Porn Groove"),
+    gettext_noop ("Satire"),
+    gettext_noop ("Slow Jam"),
+    gettext_noop ("Club"),
+    gettext_noop ("Tango"),
+    gettext_noop ("Samba"),
+    gettext_noop ("Folklore"),
+    gettext_noop ("Ballad"),
+    gettext_noop ("Power Ballad"),
+    gettext_noop ("Rhythmic Soul"),
+    gettext_noop ("Freestyle"),
+    gettext_noop ("Duet"),
+    gettext_noop ("Punk Rock"),
+    gettext_noop ("Drum Solo"),
+    gettext_noop ("A Cappella"),
+    gettext_noop ("Euro-House"),
+    gettext_noop ("Dance Hall"),
+    gettext_noop ("Goa"),
+    gettext_noop ("Drum & Bass"),
+    gettext_noop ("Club-House"),
+    gettext_noop ("Hardcore"),
+    gettext_noop ("Terror"),
+    gettext_noop ("Indie"),
+    gettext_noop ("BritPop"),
+    gettext_noop ("Afro-Punk"),
+    gettext_noop ("Polsk Punk"),
+    gettext_noop ("Beat"),
+    gettext_noop ("Christian Gangsta Rap"),
+    gettext_noop ("Heavy Metal"),
+    gettext_noop ("Black Metal"),
+    gettext_noop ("Crossover"),
+    gettext_noop ("Contemporary Christian"),
+    gettext_noop ("Christian Rock"),
+    gettext_noop ("Merengue"),
+    gettext_noop ("Salsa"),
+    gettext_noop ("Thrash Metal"),
+    gettext_noop ("Anime"),
+    gettext_noop ("JPop"),
+    gettext_noop ("Synthpop")
+  };
+
+
+/**
+ * Number of entries in #genre_names.
+ */
+#define GENRE_NAME_COUNT (sizeof (genre_names) / sizeof (genre_names[0]))
+
+
+/**
+ * Get the name of a genre from the ID3v1 genre list (including
+ * the Winamp extensions).  The name is not translated yet; callers
+ * should pass it to gettext.
+ *
+ * @param id index of the genre in the list
+ * @return name of the genre (statically allocated), NULL if unknown
+ */
+const char *
+EXTRACTOR_common_get_id3_genre (unsigned int id)
+{
+  if (id >= GENRE_NAME_COUNT)
+    return NULL;
+  return genre_names[id];
+}
+
+/* end of genres.c */
@@ -0,0 +1,51 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file common/genres.h
+ * @brief the genre list of ID3v1 (also used by iTunes)
+ */
+#ifndef GENRES_H
+#define GENRES_H
+
+#include "platform.h"
+#include "extractor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Get the name of a genre from the ID3v1 genre list (including
+ * the Winamp extensions).  The name is not translated yet; callers
+ * should pass it to gettext.
+ *
+ * @param id index of the genre in the list
+ * @return name of the genre (statically allocated), NULL if unknown
+ */
+const char *
+EXTRACTOR_common_get_id3_genre (unsigned int id);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
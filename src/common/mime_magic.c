@@ -0,0 +1,91 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file common/mime_magic.c
+ * @brief MIME type detection with libmagic for plugins
+ *
+ * Plugins that only want to know whether the input is a format they
+ * can handle share this code; the 'mime' plugin has its own handle
+ * as it supports custom magic files.
+ */
+#include "mime_magic.h"
+#include <magic.h>
+
+
+/**
+ * Global handle to MAGIC data, NULL if not yet loaded.
+ */
+static magic_t magic;
+
+/**
+ * Set if loading the magic data failed, so that we do not try
+ * again for every file.
+ */
+static int magic_failed;
+
+
+/**
+ * Ask libmagic for the MIME type of the given data, using the
+ * default magic data.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type (valid until the next call), NULL on error
+ */
+const char *
+EXTRACTOR_common_get_magic_mime_type (const void *data,
+				      size_t size)
+{
+  if (NULL == magic)
+    {
+      if (magic_failed)
+	return NULL;
+      if (NULL == (magic = magic_open (MAGIC_MIME_TYPE)))
+	{
+	  magic_failed = 1;
+	  return NULL;
+	}
+      if (0 != magic_load (magic, NULL))
+	{
+	  /* no (usable) magic data installed */
+	  magic_close (magic);
+	  magic = NULL;
+	  magic_failed = 1;
+	  return NULL;
+	}
+    }
+  return magic_buffer (magic, data, size);
+}
+
+
+/**
+ * Destructor for the library, cleans up.
+ */
+void __attribute__ ((destructor))
+mime_magic_ltdl_fini ()
+{
+  if (NULL != magic)
+    {
+      magic_close (magic);
+      magic = NULL;
+    }
+}
+
+/* end of mime_magic.c */
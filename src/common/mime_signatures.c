@@ -0,0 +1,704 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file common/mime_signatures.c
+ * @brief built-in table of file signatures for MIME type detection
+ *
+ * Loading the libmagic database and running magic_buffer() is
+ * comparatively expensive, and most files we see start with one of
+ * a few dozen well-known signatures.  We match those against a
+ * static table, indexed by the first byte of the file, and only
+ * leave the rest to libmagic.  The MIME types in the table are
+ * the ones libmagic reports for the respective signatures; formats
+ * where libmagic looks deeper into the file (plain ZIP, OLE2, ID3,
+ * tar, ...) are deliberately left out.
+ */
+#include "mime_signatures.h"
+
+
+/**
+ * Function that refines a signature match by looking at more
+ * of the data.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type, NULL if the signature is inconclusive
+ */
+typedef const char *
+(*RefineFunction) (const unsigned char *data,
+		   size_t size);
+
+
+/**
+ * Entry in the signature table.
+ */
+struct MimeSignature
+{
+  /**
+   * Offset of the signature in the file.
+   */
+  size_t offset;
+
+  /**
+   * Signature bytes.
+   */
+  const char *magic;
+
+  /**
+   * Number of bytes in @e magic, 0 to always call @e refine.
+   */
+  size_t magic_len;
+
+  /**
+   * Offset of the second signature in the file.
+   */
+  size_t offset2;
+
+  /**
+   * Second signature that must also match, NULL for none.
+   */
+  const char *magic2;
+
+  /**
+   * Number of bytes in @e magic2.
+   */
+  size_t magic2_len;
+
+  /**
+   * MIME type to report on a match (unless @e refine is set).
+   */
+  const char *mime;
+
+  /**
+   * Function to call to determine the MIME type, NULL to
+   * just report @e mime.
+   */
+  RefineFunction refine;
+};
+
+
+/**
+ * Entry matching @a m at offset @a off.
+ */
+#define SIG(off,m,mime) { off, m, sizeof (m) - 1, 0, NULL, 0, mime, NULL }
+
+/**
+ * Entry matching @a m at offset @a off and @a m2 at offset @a off2.
+ */
+#define SIG2(off,m,off2,m2,mime) { off, m, sizeof (m) - 1, off2, m2, sizeof (m2) - 1, mime, NULL }
+
+/**
+ * Entry matching @a m at offset @a off, with @a fn deciding the type.
+ */
+#define SIGF(off,m,fn) { off, m, sizeof (m) - 1, 0, NULL, 0, NULL, fn }
+
+
+/**
+ * Mapping of a codec (or sub-format) identifier to a MIME type.
+ */
+struct SubTypeMapping
+{
+  /**
+   * Identifier as found in the file.
+   */
+  const char *id;
+
+  /**
+   * Number of bytes in @e id.
+   */
+  size_t id_len;
+
+  /**
+   * Corresponding MIME type.
+   */
+  const char *mime;
+};
+
+
+/**
+ * Find the MIME type for the identifier at @a data in @a map.
+ *
+ * @param map table to search, terminated by a NULL @e id
+ * @param data identifier to look for
+ * @param size number of bytes available at @a data
+ * @param exact non-zero if the identifier must be exactly @a size bytes
+ * @return MIME type, NULL if not found
+ */
+static const char *
+find_sub_type (const struct SubTypeMapping *map,
+	       const unsigned char *data,
+	       size_t size,
+	       int exact)
+{
+  unsigned int i;
+
+  for (i = 0; NULL != map[i].id; i++)
+    if ( ( (size == map[i].id_len) ||
+	   ( (! exact) &&
+	     (size > map[i].id_len) ) ) &&
+	 (0 == memcmp (data,
+		       map[i].id,
+		       map[i].id_len)) )
+      return map[i].mime;
+  return NULL;
+}
+
+
+/**
+ * Codecs in the first Ogg packet.
+ */
+static const struct SubTypeMapping ogg_codecs[] =
+  {
+    { "\x01vorbis", 7, "audio/ogg" },
+    { "OpusHead", 8, "audio/ogg" },
+    { "Speex   ", 8, "audio/ogg" },
+    { "\x7F" "FLAC", 5, "audio/ogg" },
+    { "\x80theora", 7, "video/ogg" },
+    { NULL, 0, NULL }
+  };
+
+
+/**
+ * Determine the type of an Ogg stream from the codec of its
+ * first packet.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type, NULL if the codec is not known
+ */
+static const char *
+refine_ogg (const unsigned char *data,
+	    size_t size)
+{
+  /* first page has one segment, so the packet starts right
+     after the segment table */
+  if ( (size < 28) ||
+       (1 != data[26]) )
+    return NULL;
+  return find_sub_type (ogg_codecs,
+			&data[28],
+			size - 28,
+			0);
+}
+
+
+/**
+ * Major brands of ISO base media files.
+ */
+static const struct SubTypeMapping ftyp_brands[] =
+  {
+    { "qt  ", 4, "video/quicktime" },
+    { "isom", 4, "video/mp4" },
+    { "iso2", 4, "video/mp4" },
+    { "mp41", 4, "video/mp4" },
+    { "mp42", 4, "video/mp4" },
+    { "avc1", 4, "video/mp4" },
+    { "dash", 4, "video/mp4" },
+    { "M4V ", 4, "video/x-m4v" },
+    { "M4A ", 4, "audio/x-m4a" },
+    { "M4B ", 4, "audio/mp4" },
+    { "3gp4", 4, "video/3gpp" },
+    { "3gp5", 4, "video/3gpp" },
+    { "3g2a", 4, "video/3gpp2" },
+    { "heic", 4, "image/heic" },
+    { "mif1", 4, "image/heif" },
+    { "avif", 4, "image/avif" },
+    { NULL, 0, NULL }
+  };
+
+
+/**
+ * Determine the type of an ISO base media file (MP4, QuickTime,
+ * 3GPP, HEIF) from the major brand in its 'ftyp' box.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type, NULL if the brand is not known
+ */
+static const char *
+refine_ftyp (const unsigned char *data,
+	     size_t size)
+{
+  if (size < 12)
+    return NULL;
+  return find_sub_type (ftyp_brands,
+			&data[8],
+			4,
+			1);
+}
+
+
+/**
+ * Document types of Matroska files.
+ */
+static const struct SubTypeMapping ebml_doc_types[] =
+  {
+    { "matroska", 8, "video/x-matroska" },
+    { "webm", 4, "video/webm" },
+    { NULL, 0, NULL }
+  };
+
+
+/**
+ * Determine the type of an EBML file from the DocType element of
+ * its header.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type, NULL if the document type is not known
+ */
+static const char *
+refine_ebml (const unsigned char *data,
+	     size_t size)
+{
+  size_t pos;
+  size_t len;
+
+  /* the DocType element (0x4282) is within the first few
+     bytes of the EBML header */
+  for (pos = 4; (pos + 3 < size) && (pos < 64); pos++)
+    {
+      if ( (0x42 != data[pos]) ||
+	   (0x82 != data[pos + 1]) ||
+	   (0x80 != (data[pos + 2] & 0x80)) )
+	continue;
+      len = data[pos + 2] & 0x7F;
+      if (pos + 3 + len > size)
+	return NULL;
+      return find_sub_type (ebml_doc_types,
+			    &data[pos + 3],
+			    len,
+			    1);
+    }
+  return NULL;
+}
+
+
+/**
+ * Contents of the 'mimetype' member of ZIP-based formats.
+ */
+static const struct SubTypeMapping zip_mimetypes[] =
+  {
+#define ODF(t) { "application/vnd.oasis.opendocument." t, sizeof ("application/vnd.oasis.opendocument." t) - 1, "application/vnd.oasis.opendocument." t }
+    ODF ("text"),
+    ODF ("text-template"),
+    ODF ("text-web"),
+    ODF ("text-master"),
+    ODF ("graphics"),
+    ODF ("graphics-template"),
+    ODF ("presentation"),
+    ODF ("presentation-template"),
+    ODF ("spreadsheet"),
+    ODF ("spreadsheet-template"),
+    ODF ("chart"),
+    ODF ("formula"),
+    ODF ("database"),
+    ODF ("image"),
+#undef ODF
+    { "application/epub+zip", 20, "application/epub+zip" },
+    { NULL, 0, NULL }
+  };
+
+
+/**
+ * Determine the type of a ZIP archive from its 'mimetype' member,
+ * which OpenDocument and EPUB store uncompressed as the first
+ * member of the archive.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type, NULL for other ZIP archives
+ */
+static const char *
+refine_zip (const unsigned char *data,
+	    size_t size)
+{
+  size_t len;
+
+  if ( (size < 38) ||
+       (0 != data[8]) || (0 != data[9]) ||    /* stored */
+       (8 != data[26]) || (0 != data[27]) ||  /* name length */
+       (0 != data[28]) || (0 != data[29]) ||  /* extra length */
+       (0 != memcmp (&data[30], "mimetype", 8)) )
+    return NULL;
+  len = data[18] | (data[19] << 8) | (data[20] << 16) | ((size_t) data[21] << 24);
+  if (len > size - 38)
+    return NULL;
+  return find_sub_type (zip_mimetypes,
+			&data[38],
+			len,
+			1);
+}
+
+
+/**
+ * Determine the type of an ELF file from its object file type.
+ * Shared objects are left to libmagic, as it tells libraries and
+ * position-independent executables apart.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type, NULL if inconclusive
+ */
+static const char *
+refine_elf (const unsigned char *data,
+	    size_t size)
+{
+  unsigned int type;
+
+  if (size < 18)
+    return NULL;
+  switch (data[5])
+    {
+    case 1:
+      type = data[16] | (data[17] << 8);
+      break;
+    case 2:
+      type = (data[16] << 8) | data[17];
+      break;
+    default:
+      return NULL;
+    }
+  switch (type)
+    {
+    case 1:
+      return "application/x-object";
+    case 2:
+      return "application/x-executable";
+    case 4:
+      return "application/x-coredump";
+    default:
+      return NULL;
+    }
+}
+
+
+/**
+ * Check that a TIFF file is not one of the camera raw formats built
+ * on TIFF that libmagic reports with a type of their own (Canon CR2
+ * stores "CR" right after the TIFF header).
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return "image/tiff", NULL if inconclusive
+ */
+static const char *
+refine_tiff (const unsigned char *data,
+	     size_t size)
+{
+  if (size < 10)
+    return NULL;
+  if ( ('C' == data[8]) &&
+       ('R' == data[9]) )
+    return NULL; /* image/x-canon-cr2 */
+  return "image/tiff";
+}
+
+
+/**
+ * How many bytes do we check for NUL characters before we believe
+ * that a document is HTML?
+ */
+#define HTML_TEXT_CHECK_SIZE 1024
+
+
+/**
+ * Check if @a data starts with the given tag name (ignoring case),
+ * followed by whitespace or the end of the tag.
+ *
+ * @param data data to check
+ * @param size number of bytes in @a data
+ * @param tag tag to look for, in lower case
+ * @return non-zero if @a data starts with @a tag
+ */
+static int
+starts_with_tag (const unsigned char *data,
+		 size_t size,
+		 const char *tag)
+{
+  size_t len = strlen (tag);
+  size_t i;
+
+  if (size <= len)
+    return 0;
+  for (i = 0; i < len; i++)
+    if (tolower (data[i]) != (unsigned char) tag[i])
+      return 0;
+  return ( ('>' == data[len]) ||
+	   (isspace (data[len])) );
+}
+
+
+/**
+ * Check if the data is an HTML document, that is text starting
+ * with a doctype or html tag.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return "text/html" or NULL
+ */
+static const char *
+refine_html (const unsigned char *data,
+	     size_t size)
+{
+  size_t off;
+
+  off = 0;
+  if ( (size >= 3) &&
+       (0 == memcmp (data, "\xEF\xBB\xBF", 3)) )
+    off = 3;
+  while ( (off < size) &&
+	  (isspace (data[off])) )
+    off++;
+  if ( (! starts_with_tag (&data[off], size - off, "<!doctype html")) &&
+       (! starts_with_tag (&data[off], size - off, "<html")) )
+    return NULL;
+  if (NULL != memchr (data,
+		      '\0',
+		      (size < HTML_TEXT_CHECK_SIZE) ? size : HTML_TEXT_CHECK_SIZE))
+    return NULL; /* binary data, not text */
+  return "text/html";
+}
+
+
+/**
+ * The signature table.  Within the entries for the same first byte,
+ * the table is searched in order, so more specific signatures must
+ * come before more general ones.
+ */
+static const struct MimeSignature signatures[] =
+  {
+    /* images */
+    SIG (0, "\xFF\xD8\xFF", "image/jpeg"),
+    SIG (0, "\x89PNG\r\n\x1A\n", "image/png"),
+    SIG (0, "GIF87a", "image/gif"),
+    SIG (0, "GIF89a", "image/gif"),
+    SIGF (0, "II*\0", &refine_tiff),
+    SIGF (0, "MM\0*", &refine_tiff),
+    SIG2 (0, "RIFF", 8, "WEBP", "image/webp"),
+    SIG (0, "\0\0\0\x0CjP  \r\n\x87\n", "image/jp2"),
+    SIG (0, "gimp xcf ", "image/x-xcf"),
+    SIG (0, "\x76\x2F\x31\x01", "image/x-exr"),
+    SIG (0, "icns", "image/x-icns"),
+    SIG2 (0, "AT&TFORM", 12, "DJVU", "image/vnd.djvu"),
+    SIG (0, "SIMPLE  =", "image/fits"),
+    /* audio */
+    SIG (0, "fLaC", "audio/flac"),
+    SIGF (0, "OggS", &refine_ogg),
+    SIG2 (0, "RIFF", 8, "WAVE", "audio/x-wav"),
+    SIG2 (0, "FORM", 8, "AIFF", "audio/x-aiff"),
+    SIG2 (0, "FORM", 8, "AIFC", "audio/x-aiff"),
+    SIG (0, ".snd", "audio/basic"),
+    SIG (0, "MThd", "audio/midi"),
+    SIG (0, "MAC ", "audio/x-ape"),
+    SIG (0, "#!AMR\n", "audio/amr"),
+    SIG (0, "MPCK", "audio/x-musepack"),
+    SIG (0, "IMPM", "audio/x-mod"),
+    SIG (0, "Extended Module: ", "audio/x-mod"),
+    SIG (44, "SCRM", "audio/x-s3m"),
+    /* video */
+    SIGF (0, "\x1A\x45\xDF\xA3", &refine_ebml),
+    SIG2 (0, "RIFF", 8, "AVI ", "video/x-msvideo"),
+    SIG (0, "FLV\x01", "video/x-flv"),
+    SIG (0, "\x30\x26\xB2\x75\x8E\x66\xCF\x11\xA6\xD9\x00\xAA\x00\x62\xCE\x6C", "video/x-ms-asf"),
+    SIG (0, "\0\0\x01\xBA", "video/mpeg"),
+    SIG (0, "\0\0\x01\xB3", "video/mpeg"),
+    SIG (0, ".RMF", "application/vnd.rn-realmedia"),
+    SIGF (4, "ftyp", &refine_ftyp),
+    SIG (4, "moov", "video/quicktime"),
+    SIG (4, "mdat", "video/quicktime"),
+    /* documents */
+    SIG (0, "%PDF-", "application/pdf"),
+    SIG (0, "%!PS", "application/postscript"),
+    SIG (0, "{\\rtf", "text/rtf"),
+    SIG (60, "BOOKMOBI", "application/x-mobipocket-ebook"),
+    SIGF (0, "PK\x03\x04", &refine_zip),
+    SIGF (0, "", &refine_html),
+    /* archives and compressed data */
+    SIG (0, "Rar!\x1A\x07", "application/x-rar"),
+    SIG (0, "7z\xBC\xAF\x27\x1C", "application/x-7z-compressed"),
+    SIG (0, "\x1F\x8B\x08", "application/gzip"),
+    SIG (0, "\x1F\x9D", "application/x-compress"),
+    SIG (0, "BZh", "application/x-bzip2"),
+    SIG (0, "\xFD" "7zXZ\0", "application/x-xz"),
+    SIG (0, "\x28\xB5\x2F\xFD", "application/zstd"),
+    SIG (0, "LZIP", "application/x-lzip"),
+    SIG (0, "\x04\x22\x4D\x18", "application/x-lz4"),
+    SIG (0, "xar!", "application/x-xar"),
+    SIG (0, "070701", "application/x-cpio"),
+    SIG (0, "070707", "application/x-cpio"),
+    SIG (0, "!<arch>\ndebian-binary", "application/vnd.debian.binary-package"),
+    SIG (0, "!<arch>\n", "application/x-archive"),
+    SIG (0, "\xED\xAB\xEE\xDB", "application/x-rpm"),
+    /* other */
+    SIGF (0, "\x7F" "ELF", &refine_elf),
+    SIG (0, "\0asm", "application/wasm"),
+    SIG (0, "SQLite format 3\0", "application/vnd.sqlite3"),
+    SIG (0, "\x89HDF\r\n\x1A\n", "application/x-hdf5"),
+    SIG (0, "wOFF", "font/woff"),
+    SIG (0, "wOF2", "font/woff2"),
+    SIG (0, "OTTO", "application/vnd.ms-opentype")
+  };
+
+
+/**
+ * Number of entries in #signatures.
+ */
+#define NUM_SIGNATURES (sizeof (signatures) / sizeof (signatures[0]))
+
+
+/**
+ * Indices into #signatures of the entries with a signature at
+ * offset zero, grouped by their first byte.
+ */
+static unsigned char by_first_byte[NUM_SIGNATURES];
+
+/**
+ * The entries for first byte 'b' are
+ * by_first_byte[first_byte_start[b]] to
+ * by_first_byte[first_byte_start[b + 1] - 1].
+ */
+static unsigned int first_byte_start[257];
+
+/**
+ * Indices into #signatures of the entries that must be tried
+ * regardless of the first byte.
+ */
+static unsigned char other_signatures[NUM_SIGNATURES];
+
+/**
+ * Number of entries in #other_signatures.
+ */
+static unsigned int num_other_signatures;
+
+
+/**
+ * Check if the given entry is indexed by its first byte.
+ *
+ * @param sig entry to check
+ * @return non-zero if @a sig has a signature at offset zero
+ */
+static int
+is_indexed (const struct MimeSignature *sig)
+{
+  return (0 == sig->offset) && (0 != sig->magic_len);
+}
+
+
+/**
+ * Check if the data matches the given entry and if so, determine
+ * the MIME type.
+ *
+ * @param sig entry to check
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type, NULL if @a sig does not match
+ */
+static const char *
+try_signature (const struct MimeSignature *sig,
+	       const unsigned char *data,
+	       size_t size)
+{
+  if ( (sig->offset + sig->magic_len > size) ||
+       (0 != memcmp (&data[sig->offset],
+		     sig->magic,
+		     sig->magic_len)) )
+    return NULL;
+  if ( (NULL != sig->magic2) &&
+       ( (sig->offset2 + sig->magic2_len > size) ||
+	 (0 != memcmp (&data[sig->offset2],
+		       sig->magic2,
+		       sig->magic2_len)) ) )
+    return NULL;
+  if (NULL != sig->refine)
+    return sig->refine (data, size);
+  return sig->mime;
+}
+
+
+/**
+ * Determine the MIME type of the given data by matching it against
+ * our built-in table of file signatures.  The table only answers if
+ * the signature is conclusive and the result is the type libmagic
+ * would report; callers should fall back to libmagic if we return
+ * NULL.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type (statically allocated), NULL if unknown
+ */
+const char *
+EXTRACTOR_common_get_mime_type (const void *data,
+				size_t size)
+{
+  const unsigned char *cdata = data;
+  const char *mime;
+  unsigned int i;
+
+  if (0 == size)
+    return NULL;
+  for (i = first_byte_start[cdata[0]]; i < first_byte_start[cdata[0] + 1]; i++)
+    if (NULL != (mime = try_signature (&signatures[by_first_byte[i]],
+				       cdata,
+				       size)))
+      return mime;
+  for (i = 0; i < num_other_signatures; i++)
+    if (NULL != (mime = try_signature (&signatures[other_signatures[i]],
+				       cdata,
+				       size)))
+      return mime;
+  return NULL;
+}
+
+
+/**
+ * Constructor for the library.  Builds the first-byte index
+ * of the signature table.
+ */
+void __attribute__ ((constructor))
+mime_signatures_init ()
+{
+  unsigned int count[257];
+  unsigned int i;
+  unsigned char b;
+
+  memset (count, 0, sizeof (count));
+  for (i = 0; i < NUM_SIGNATURES; i++)
+    if (is_indexed (&signatures[i]))
+      count[(unsigned char) signatures[i].magic[0] + 1]++;
+  first_byte_start[0] = 0;
+  for (i = 1; i < 257; i++)
+    first_byte_start[i] = first_byte_start[i - 1] + count[i];
+  /* 'count[b]' becomes the next free slot for first byte 'b' */
+  memcpy (count, first_byte_start, sizeof (count));
+  num_other_signatures = 0;
+  for (i = 0; i < NUM_SIGNATURES; i++)
+    {
+      if (! is_indexed (&signatures[i]))
+	{
+	  other_signatures[num_other_signatures++] = (unsigned char) i;
+	  continue;
+	}
+      b = (unsigned char) signatures[i].magic[0];
+      by_first_byte[count[b]++] = (unsigned char) i;
+    }
+}
+
+/* end of mime_signatures.c */
@@ -0,0 +1,55 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file common/mime_signatures.h
+ * @brief built-in table of file signatures for MIME type detection
+ */
+#ifndef MIME_SIGNATURES_H
+#define MIME_SIGNATURES_H
+
+#include "platform.h"
+#include "extractor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * Determine the MIME type of the given data by matching it against
+ * our built-in table of file signatures.  The table only answers if
+ * the signature is conclusive and the result is the type libmagic
+ * would report; callers should fall back to libmagic if we return
+ * NULL.
+ *
+ * @param data first bytes of the file
+ * @param size number of bytes in @a data
+ * @return MIME type (statically allocated), NULL if unknown
+ */
+const char *
+EXTRACTOR_common_get_mime_type (const void *data,
+				size_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
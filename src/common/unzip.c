@@ -77,6 +77,12 @@
 
 #define SIZECENTRALDIRITEM (0x2e)
 #define SIZEZIPLOCALHEADER (0x1e)
+#define SIZEENDOFCENTRALDIR (0x16)
+
+/**
+ * Largest central directory we are willing to load into memory.
+ */
+#define MAX_CENTRAL_DIR_SIZE (64 * 1024 * 1024)
 
 
 /**
@@ -323,92 +329,55 @@ struct EXTRACTOR_UnzipFile
    * Is the file encrypted?
    */
   int encrypted;
-};
 
+  /**
+   * The central directory (size_central_dir bytes), which we read
+   * in one go when opening the file.
+   */
+  unsigned char *central_dir;
 
-/**
- * Read a byte from a gz_stream; update next_in and avail_in. Return EOF
- * for end of file.
- * IN assertion: the stream s has been sucessfully opened for reading.
- *
- * @param ffd functions for performing IO operations
- * @param pi where to store the byte that was read
- * @return #EXTRACTOR_UNZIP_OK on success, or #EXTRACTOR_UNZIP_EOF
- */
-static int
-read_byte_from_ffd (const struct FileFuncDefs *ffd,
-		    int *pi)
-{
-  unsigned char c;
+  /**
+   * Offsets of the entries in central_dir (gi.number_entry of them).
+   */
+  uint32_t *entries;
 
-  if (1 != ZREAD (*ffd, &c, 1))
-    return EXTRACTOR_UNZIP_EOF;
-  *pi = (int) c;
-  return EXTRACTOR_UNZIP_OK;
-}
+  /**
+   * Hash table mapping (lower-case) file names to entries, as entry
+   * index plus one (0 for an empty slot); built on the first lookup.
+   */
+  uint32_t *name_index;
+
+  /**
+   * Number of slots in name_index (a power of two).
+   */
+  uint32_t name_index_size;
+};
 
 
 /**
- * Read a short (2 bytes) from a gz_stream; update next_in and avail_in. Return EOF
- * for end of file.
- * IN assertion: the stream s has been sucessfully opened for reading.
+ * Get a short (2 bytes, little endian) from a buffer.
  *
- * @param ffd functions for performing IO operations
- * @param pi where to store the short that was read
- * @return #EXTRACTOR_UNZIP_OK on success, or #EXTRACTOR_UNZIP_EOF
+ * @param p where to read
+ * @return the value
  */
-static int
-read_short_from_ffd (const struct FileFuncDefs *ffd,
-		     uLong *pX)
+static uLong
+get_short (const unsigned char *p)
 {
-  uLong x;
-  int i;
-  int err;
-
-  *pX = 0;
-  if (EXTRACTOR_UNZIP_OK != (err = read_byte_from_ffd (ffd, &i)))
-    return err;
-  x = (uLong) i;
-  if (EXTRACTOR_UNZIP_OK != (err = read_byte_from_ffd (ffd, &i)))
-    return err;
-  x += ((uLong) i) << 8;
-  *pX = x;
-  return err;
+  return (uLong) p[0] | ((uLong) p[1] << 8);
 }
 
 
 /**
- * Read a 'long' (4 bytes) from a gz_stream; update next_in and avail_in. Return EOF
- * for end of file.
- * IN assertion: the stream s has been sucessfully opened for reading.
+ * Get a 'long' (4 bytes, little endian) from a buffer.
  *
- * @param ffd functions for performing IO operations
- * @param pi where to store the long that was read
- * @return #EXTRACTOR_UNZIP_OK on success, or #EXTRACTOR_UNZIP_EOF
+ * @param p where to read
+ * @return the value
  */
-static int
-read_long_from_ffd (const struct FileFuncDefs *ffd,
-		    uLong *pX)
+static uLong
+get_long (const unsigned char *p)
 {
-  uLong x;
-  int i;
-  int err;
-
-  *pX = 0;
-  if (EXTRACTOR_UNZIP_OK != (err = read_byte_from_ffd (ffd, &i)))
-    return err;
-  x = (uLong) i;
-  if (EXTRACTOR_UNZIP_OK != (err = read_byte_from_ffd (ffd, &i)))
-    return err;
-  x += ((uLong) i) << 8;
-  if (EXTRACTOR_UNZIP_OK != (err = read_byte_from_ffd (ffd, &i)))
-    return err;
-  x += ((uLong) i) << 16;
-  if (EXTRACTOR_UNZIP_OK != (err = read_byte_from_ffd (ffd, &i)))
-    return err;
-  x += ((uLong) i) << 24;
-  *pX = x;
-  return err;
+  return (uLong) p[0] | ((uLong) p[1] << 8) |
+    ((uLong) p[2] << 16) | ((uLong) p[3] << 24);
 }
 
 
@@ -425,29 +394,6 @@ read_long_from_ffd (const struct FileFuncDefs *ffd,
 #endif
 
 
-/**
- * Compare two filenames (fileName1, fileName2).
- *
- * @param filename1 name of first file
- * @param filename2 name of second file
- * @param iCaseSensitivity, use 1 for case sensitivity (like strcmp);
- *        2 for no case sensitivity (like strcmpi or strcasecmp); or
- *        0 for defaut of your operating system (like 1 on Unix, 2 on Windows)
- * @return 0 if names are equal
- */
-static int
-EXTRACTOR_common_unzip_string_file_name_compare (const char* fileName1,
-						 const char* fileName2,
-						 int iCaseSensitivity)
-{
-  if (0 == iCaseSensitivity)
-    iCaseSensitivity = CASESENSITIVITYDEFAULTVALUE;
-  if (1 == iCaseSensitivity)
-    return strcmp(fileName1, fileName2);
-  return strcasecmp (fileName1, fileName2);
-}
-
-
 #ifndef BUFREADCOMMENT
 #define BUFREADCOMMENT (0x400)
 #endif
@@ -554,64 +500,46 @@ get_current_file_info (struct EXTRACTOR_UnzipFile *file,
 {
   struct EXTRACTOR_UnzipFileInfo file_info;
   struct UnzipFileInfoInternal file_info_internal;
-  uLong uMagic;
-  long lSeek = 0;
+  const unsigned char *p;
+  uLong off;
+  uLong uSizeRead;
 
   if (NULL == file)
     return EXTRACTOR_UNZIP_PARAMERROR;
-  if (0 != ZSEEK (file->z_filefunc,
-		  file->pos_in_central_dir + file->byte_before_the_zipfile,
-		  SEEK_SET))
+  off = file->pos_in_central_dir - file->offset_central_dir;
+  if ( (file->size_central_dir < SIZECENTRALDIRITEM) ||
+       (off > file->size_central_dir - SIZECENTRALDIRITEM) )
     return EXTRACTOR_UNZIP_ERRNO;
+  p = &file->central_dir[off];
 
   /* we check the magic */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd(&file->z_filefunc, &uMagic))
-    return EXTRACTOR_UNZIP_ERRNO;
-  if (0x02014b50 != uMagic)
+  if (0x02014b50 != get_long (p))
     return EXTRACTOR_UNZIP_BADZIPFILE;
-
-  if ( (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd (&file->z_filefunc, &file_info.version)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd (&file->z_filefunc, &file_info.version_needed)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd (&file->z_filefunc, &file_info.flag)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd (&file->z_filefunc, &file_info.compression_method)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_long_from_ffd (&file->z_filefunc, &file_info.dosDate)) )
-    return EXTRACTOR_UNZIP_ERRNO;
+  file_info.version = get_short (&p[4]);
+  file_info.version_needed = get_short (&p[6]);
+  file_info.flag = get_short (&p[8]);
+  file_info.compression_method = get_short (&p[10]);
+  file_info.dosDate = get_long (&p[12]);
   dos_date_to_tmu_date (file_info.dosDate,
 			&file_info.tmu_date);
-  if ( (EXTRACTOR_UNZIP_OK !=
-	read_long_from_ffd(&file->z_filefunc, &file_info.crc)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_long_from_ffd(&file->z_filefunc, &file_info.compressed_size)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_long_from_ffd(&file->z_filefunc, &file_info.uncompressed_size)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd(&file->z_filefunc, &file_info.size_filename)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd(&file->z_filefunc, &file_info.size_file_extra)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd(&file->z_filefunc, &file_info.size_file_comment)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd(&file->z_filefunc, &file_info.disk_num_start)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd(&file->z_filefunc, &file_info.internal_fa)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_long_from_ffd(&file->z_filefunc, &file_info.external_fa)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_long_from_ffd (&file->z_filefunc,
-			    &file_info_internal.offset_curfile)) )
+  file_info.crc = get_long (&p[16]);
+  file_info.compressed_size = get_long (&p[20]);
+  file_info.uncompressed_size = get_long (&p[24]);
+  file_info.size_filename = get_short (&p[28]);
+  file_info.size_file_extra = get_short (&p[30]);
+  file_info.size_file_comment = get_short (&p[32]);
+  file_info.disk_num_start = get_short (&p[34]);
+  file_info.internal_fa = get_short (&p[36]);
+  file_info.external_fa = get_long (&p[38]);
+  file_info_internal.offset_curfile = get_long (&p[42]);
+  if (file_info.size_filename + file_info.size_file_extra
+      + file_info.size_file_comment >
+      file->size_central_dir - off - SIZECENTRALDIRITEM)
     return EXTRACTOR_UNZIP_ERRNO;
+  p += SIZECENTRALDIRITEM;
 
-  lSeek += file_info.size_filename;
   if (NULL != szFileName)
     {
-      uLong uSizeRead;
-
       if (file_info.size_filename < fileNameBufferSize)
         {
 	  *(szFileName + file_info.size_filename) = '\0';
@@ -619,45 +547,22 @@ get_current_file_info (struct EXTRACTOR_UnzipFile *file,
         }
       else
 	uSizeRead = fileNameBufferSize;
-
-      if ( (file_info.size_filename > 0) &&
-	   (fileNameBufferSize > 0) )
-	if (ZREAD(file->z_filefunc, szFileName, uSizeRead) != uSizeRead)
-	  return EXTRACTOR_UNZIP_ERRNO;
-      lSeek -= uSizeRead;
+      memcpy (szFileName, p, uSizeRead);
     }
+  p += file_info.size_filename;
 
   if (NULL != extraField)
     {
-      uLong uSizeRead;
-
       if (file_info.size_file_extra<extraFieldBufferSize)
 	uSizeRead = file_info.size_file_extra;
       else
 	uSizeRead = extraFieldBufferSize;
-
-      if (0 != lSeek)
-	{
-	  if (0 == ZSEEK (file->z_filefunc, lSeek, SEEK_CUR))
-	    lSeek = 0;
-	  else
-	    return EXTRACTOR_UNZIP_ERRNO;
-	}
-      if ( (file_info.size_file_extra > 0) &&
-	   (extraFieldBufferSize > 0) &&
-	   (ZREAD (file->z_filefunc,
-		   extraField,
-		   uSizeRead) != uSizeRead) )
-	return EXTRACTOR_UNZIP_ERRNO;
-      lSeek += file_info.size_file_extra - uSizeRead;
+      memcpy (extraField, p, uSizeRead);
     }
-  else
-    lSeek += file_info.size_file_extra;
+  p += file_info.size_file_extra;
 
   if (NULL != szComment)
     {
-      uLong uSizeRead;
-
       if (file_info.size_file_comment < commentBufferSize)
         {
 	  *(szComment+file_info.size_file_comment) = '\0';
@@ -665,22 +570,8 @@ get_current_file_info (struct EXTRACTOR_UnzipFile *file,
         }
       else
 	uSizeRead = commentBufferSize;
-
-      if (0 != lSeek)
-	{
-	  if (0 == ZSEEK (file->z_filefunc, lSeek, SEEK_CUR))
-	    lSeek = 0;
-	  else
-	    return EXTRACTOR_UNZIP_ERRNO;
-	}
-      if ( (file_info.size_file_comment > 0) &&
-	   (commentBufferSize > 0) &&
-	   (ZREAD (file->z_filefunc, szComment, uSizeRead) != uSizeRead) )
-	return EXTRACTOR_UNZIP_ERRNO;
-      lSeek += file_info.size_file_comment - uSizeRead;
+      memcpy (szComment, p, uSizeRead);
     }
-  else
-    lSeek += file_info.size_file_comment;
 
   if (NULL != pfile_info)
     *pfile_info = file_info;
@@ -705,6 +596,8 @@ EXTRACTOR_common_unzip_go_to_first_file (struct EXTRACTOR_UnzipFile *file)
     return EXTRACTOR_UNZIP_PARAMERROR;
   file->pos_in_central_dir = file->offset_central_dir;
   file->num_file = 0;
+  if (0 != file->gi.number_entry)
+    file->pos_in_central_dir += file->entries[0];
   err = get_current_file_info (file,
 			       &file->cur_file_info,
 			       &file->cur_file_info_internal,
@@ -714,6 +607,62 @@ EXTRACTOR_common_unzip_go_to_first_file (struct EXTRACTOR_UnzipFile *file)
 }
 
 
+/**
+ * Read the central directory into memory and find the offsets
+ * of all of its entries.  If the directory is truncated, the offsets
+ * of the missing entries point beyond its end (so that
+ * #get_current_file_info() fails once we get there).
+ *
+ * @param file zipfile with the location of the central directory
+ * @return 0 on success
+ */
+static int
+load_central_directory (struct EXTRACTOR_UnzipFile *file)
+{
+  const unsigned char *p;
+  uLong off;
+  uLong i;
+
+  if (NULL == (file->central_dir = malloc (file->size_central_dir + 1)))
+    return -1;
+  if (NULL == (file->entries = malloc ((file->gi.number_entry + 1)
+				       * sizeof (uint32_t))))
+    {
+      free (file->central_dir);
+      file->central_dir = NULL;
+      return -1;
+    }
+  if ( (0 != ZSEEK (file->z_filefunc,
+		    file->offset_central_dir + file->byte_before_the_zipfile,
+		    SEEK_SET)) ||
+       (file->size_central_dir !=
+	ZREAD (file->z_filefunc, file->central_dir, file->size_central_dir)) )
+    {
+      free (file->central_dir);
+      file->central_dir = NULL;
+      free (file->entries);
+      file->entries = NULL;
+      return -1;
+    }
+  off = 0;
+  for (i = 0; i < file->gi.number_entry; i++)
+    {
+      file->entries[i] = off;
+      if (off > file->size_central_dir)
+	continue;
+      if (file->size_central_dir - off < SIZECENTRALDIRITEM)
+	{
+	  off = file->size_central_dir + 1;
+	  continue;
+	}
+      p = &file->central_dir[off];
+      off += SIZECENTRALDIRITEM + get_short (&p[28])
+	+ get_short (&p[30]) + get_short (&p[32]);
+    }
+  return 0;
+}
+
+
 /**
  * Open a Zip file.
  *
@@ -725,8 +674,8 @@ unzip_open_using_ffd (struct FileFuncDefs *ffd)
 {
   struct EXTRACTOR_UnzipFile us;
   struct EXTRACTOR_UnzipFile *file;
+  unsigned char eocd[SIZEENDOFCENTRALDIR];
   uLong central_pos;
-  uLong uL;
   uLong number_disk;          /* number of the current dist, used for
 				 spaning ZIP, unsupported, always 0*/
   uLong number_disk_with_CD;  /* number of the disk with central dir, used
@@ -740,56 +689,27 @@ unzip_open_using_ffd (struct FileFuncDefs *ffd)
   central_pos = locate_central_directory (&us.z_filefunc);
   if (0 == central_pos)
     return NULL;
-  if (0 != ZSEEK (us.z_filefunc,
-		  central_pos, SEEK_SET))
-    return NULL;
-
-  /* the signature, already checked */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd (&us.z_filefunc, &uL))
-    return NULL;
-
-  /* number of this disk */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_short_from_ffd (&us.z_filefunc, &number_disk))
-    return NULL;
-
-  /* number of the disk with the start of the central directory */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_short_from_ffd (&us.z_filefunc, &number_disk_with_CD))
-    return NULL;
-
-  /* total number of entries in the central dir on this disk */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_short_from_ffd (&us.z_filefunc, &us.gi.number_entry))
-    return NULL;
-
-  /* total number of entries in the central dir */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_short_from_ffd (&us.z_filefunc, &number_entry_CD))
+  if ( (0 != ZSEEK (us.z_filefunc,
+		    central_pos, SEEK_SET)) ||
+       (SIZEENDOFCENTRALDIR !=
+	ZREAD (us.z_filefunc, eocd, SIZEENDOFCENTRALDIR)) )
     return NULL;
 
+  /* eocd[0..3] is the signature, already checked */
+  number_disk = get_short (&eocd[4]);
+  number_disk_with_CD = get_short (&eocd[6]);
+  us.gi.number_entry = get_short (&eocd[8]);
+  number_entry_CD = get_short (&eocd[10]);
   if ( (number_entry_CD != us.gi.number_entry) ||
        (0 != number_disk_with_CD) ||
        (0 != number_disk) )
     return NULL;
-
-  /* size of the central directory */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd (&us.z_filefunc, &us.size_central_dir))
-    return NULL;
-
+  us.size_central_dir = get_long (&eocd[12]);
   /* offset of start of central directory with respect to the
      starting disk number */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd (&us.z_filefunc, &us.offset_central_dir))
-    return NULL;
-
-  /* zipfile comment length */
-  if (EXTRACTOR_UNZIP_OK !=
-      read_short_from_ffd (&us.z_filefunc, &us.gi.size_comment))
-    return NULL;
-  us.gi.offset_comment = ZTELL (us.z_filefunc);
+  us.offset_central_dir = get_long (&eocd[16]);
+  us.gi.size_comment = get_short (&eocd[20]);
+  us.gi.offset_comment = central_pos + SIZEENDOFCENTRALDIR;
   if ((central_pos < us.offset_central_dir + us.size_central_dir))
     return NULL;
 
@@ -798,9 +718,17 @@ unzip_open_using_ffd (struct FileFuncDefs *ffd)
   us.central_pos = central_pos;
   us.pfile_in_zip_read = NULL;
   us.encrypted = 0;
+  if (MAX_CENTRAL_DIR_SIZE < us.size_central_dir)
+    return NULL;
+  if (0 != load_central_directory (&us))
+    return NULL;
 
   if (NULL == (file = malloc (sizeof(struct EXTRACTOR_UnzipFile))))
-    return NULL;
+    {
+      free (us.central_dir);
+      free (us.entries);
+      return NULL;
+    }
   *file = us;
   EXTRACTOR_common_unzip_go_to_first_file (file);
   return file;
@@ -850,6 +778,9 @@ EXTRACTOR_common_unzip_close (struct EXTRACTOR_UnzipFile *file)
     return EXTRACTOR_UNZIP_PARAMERROR;
   if (NULL != file->pfile_in_zip_read)
     EXTRACTOR_common_unzip_close_current_file (file);
+  free (file->central_dir);
+  free (file->entries);
+  free (file->name_index);
   free (file);
   return EXTRACTOR_UNZIP_OK;
 }
@@ -932,9 +863,9 @@ EXTRACTOR_common_unzip_go_to_next_file (struct EXTRACTOR_UnzipFile *file)
     return EXTRACTOR_UNZIP_END_OF_LIST_OF_FILE;
   if (file->num_file + 1 == file->gi.number_entry)
     return EXTRACTOR_UNZIP_END_OF_LIST_OF_FILE;
-  file->pos_in_central_dir += SIZECENTRALDIRITEM + file->cur_file_info.size_filename +
-    file->cur_file_info.size_file_extra + file->cur_file_info.size_file_comment;
   file->num_file++;
+  file->pos_in_central_dir = file->offset_central_dir
+    + file->entries[file->num_file];
   err = get_current_file_info (file,
 			       &file->cur_file_info,
 			       &file->cur_file_info_internal,
@@ -944,6 +875,78 @@ EXTRACTOR_common_unzip_go_to_next_file (struct EXTRACTOR_UnzipFile *file)
 }
 
 
+/**
+ * Hash a file name (case-insensitively, so that the index
+ * works for either kind of lookup).
+ *
+ * @param name the file name
+ * @param len number of bytes in name
+ * @return hash of the name
+ */
+static uint32_t
+hash_name (const unsigned char *name,
+	   size_t len)
+{
+  uint32_t h;
+  size_t i;
+
+  /* FNV-1a */
+  h = 2166136261U;
+  for (i = 0; i < len; i++)
+    {
+      h ^= (uint32_t) tolower (name[i]);
+      h *= 16777619U;
+    }
+  return h;
+}
+
+
+/**
+ * Build the index mapping file names to entries of the central
+ * directory.  Entries that are cut off are not indexed.
+ *
+ * @param file zipfile to index
+ * @return 0 on success
+ */
+static int
+build_name_index (struct EXTRACTOR_UnzipFile *file)
+{
+  const unsigned char *p;
+  uLong len;
+  uLong i;
+  uint32_t off;
+  uint32_t slot;
+
+  file->name_index_size = 16;
+  while (file->name_index_size < 2 * file->gi.number_entry)
+    file->name_index_size *= 2;
+  if (NULL == (file->name_index = calloc (file->name_index_size,
+					  sizeof (uint32_t))))
+    return -1;
+  for (i = 0; i < file->gi.number_entry; i++)
+    {
+      off = file->entries[i];
+      if ( (off > file->size_central_dir) ||
+	   (file->size_central_dir - off < SIZECENTRALDIRITEM) )
+	break;
+      p = &file->central_dir[off];
+      len = get_short (&p[28]);
+      if ( (0x02014b50 != get_long (p)) ||
+	   (len > file->size_central_dir - off - SIZECENTRALDIRITEM) )
+	break;
+      /* entries with the same name end up in the order of the
+	 directory, so lookups find the first one (like a linear
+	 search would) */
+      for (slot = hash_name (&p[SIZECENTRALDIRITEM], len)
+	     & (file->name_index_size - 1);
+	   0 != file->name_index[slot];
+	   slot = (slot + 1) & (file->name_index_size - 1)) ;
+      file->name_index[slot] = i + 1;
+    }
+  return 0;
+}
+
+
 /**
  * Try locate the file szFileName in the zipfile.
  *
@@ -960,55 +963,52 @@ EXTRACTOR_common_unzip_go_find_local_file (struct EXTRACTOR_UnzipFile *file,
 					   const char *szFileName,
 					   int iCaseSensitivity)
 {
-  int err;
-  /* We remember the 'current' position in the file so that we can jump
-   * back there if we fail.
-   */
-  struct EXTRACTOR_UnzipFileInfo cur_file_infoSaved;
-  struct UnzipFileInfoInternal cur_file_info_internalSaved;
-  uLong num_fileSaved;
-  uLong pos_in_central_dirSaved;
+  const unsigned char *p;
+  size_t len;
+  uint32_t slot;
+  uint32_t idx;
+  uLong off;
 
   if (NULL == file)
     return EXTRACTOR_UNZIP_PARAMERROR;
-  if (strlen (szFileName) >= UNZ_MAXFILENAMEINZIP)
+  if ((len = strlen (szFileName)) >= UNZ_MAXFILENAMEINZIP)
     return EXTRACTOR_UNZIP_PARAMERROR;
   if (! file->current_file_ok)
     return EXTRACTOR_UNZIP_END_OF_LIST_OF_FILE;
-
-  /* Save the current state */
-  num_fileSaved = file->num_file;
-  pos_in_central_dirSaved = file->pos_in_central_dir;
-  cur_file_infoSaved = file->cur_file_info;
-  cur_file_info_internalSaved = file->cur_file_info_internal;
-  err = EXTRACTOR_common_unzip_go_to_first_file (file);
-
-  while (EXTRACTOR_UNZIP_OK == err)
+  if ( (NULL == file->name_index) &&
+       (0 != build_name_index (file)) )
+    return EXTRACTOR_UNZIP_INTERNALERROR;
+  if (0 == iCaseSensitivity)
+    iCaseSensitivity = CASESENSITIVITYDEFAULTVALUE;
+  for (slot = hash_name ((const unsigned char *) szFileName, len)
+	 & (file->name_index_size - 1);
+       0 != (idx = file->name_index[slot]);
+       slot = (slot + 1) & (file->name_index_size - 1))
     {
-      char szCurrentFileName[UNZ_MAXFILENAMEINZIP + 1];
-
-      if (EXTRACTOR_UNZIP_OK !=
-	  (err = EXTRACTOR_common_unzip_get_current_file_info (file, NULL,
-							       szCurrentFileName,
-							       sizeof (szCurrentFileName) - 1,
-							       NULL, 0, NULL, 0)))
-	break;
-      if (0 ==
-	  EXTRACTOR_common_unzip_string_file_name_compare (szCurrentFileName,
-							   szFileName,
-							   iCaseSensitivity))
-	return EXTRACTOR_UNZIP_OK;
-      err = EXTRACTOR_common_unzip_go_to_next_file (file);
+      off = file->entries[idx - 1];
+      p = &file->central_dir[off];
+      if (len != get_short (&p[28]))
+	continue;
+      p += SIZECENTRALDIRITEM;
+      if (1 == iCaseSensitivity)
+	{
+	  if (0 != memcmp (p, szFileName, len))
+	    continue;
+	}
+      else
+	{
+	  if (0 != strncasecmp ((const char *) p, szFileName, len))
+	    continue;
+	}
+      /* found it, make it the current file */
+      file->num_file = idx - 1;
+      file->pos_in_central_dir = file->offset_central_dir + off;
+      return get_current_file_info (file,
+				    &file->cur_file_info,
+				    &file->cur_file_info_internal,
+				    NULL, 0, NULL, 0, NULL, 0);
     }
-
-  /* We failed, so restore the state of the 'current file' to where we
-   * were.
-   */
-  file->num_file = num_fileSaved;
-  file->pos_in_central_dir = pos_in_central_dirSaved;
-  file->cur_file_info = cur_file_infoSaved;
-  file->cur_file_info_internal = cur_file_info_internalSaved;
-  return err;
+  return EXTRACTOR_UNZIP_END_OF_LIST_OF_FILE;
 }
 
 
@@ -1163,8 +1163,7 @@ parse_current_file_coherency_header (struct EXTRACTOR_UnzipFile *file,
 				     uLong *poffset_local_extrafield,
 				     uInt *psize_local_extrafield)
 {
-  uLong uMagic;
-  uLong uData;
+  unsigned char hdr[SIZEZIPLOCALHEADER];
   uLong uFlags;
   uLong size_filename;
   uLong size_extra_field;
@@ -1173,61 +1172,34 @@ parse_current_file_coherency_header (struct EXTRACTOR_UnzipFile *file,
   *poffset_local_extrafield = 0;
   *psize_local_extrafield = 0;
 
-  if (0 != ZSEEK (file->z_filefunc,
-		  file->cur_file_info_internal.offset_curfile +
-		  file->byte_before_the_zipfile,
-		  SEEK_SET))
+  if ( (0 != ZSEEK (file->z_filefunc,
+		    file->cur_file_info_internal.offset_curfile +
+		    file->byte_before_the_zipfile,
+		    SEEK_SET)) ||
+       (SIZEZIPLOCALHEADER !=
+	ZREAD (file->z_filefunc, hdr, SIZEZIPLOCALHEADER)) )
     return EXTRACTOR_UNZIP_ERRNO;
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd (&file->z_filefunc,
-			  &uMagic))
-    return EXTRACTOR_UNZIP_ERRNO;
-  if (0x04034b50 != uMagic)
+  if (0x04034b50 != get_long (hdr))
     return EXTRACTOR_UNZIP_BADZIPFILE;
-  if ( (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd (&file->z_filefunc, &uData)) ||
-       (EXTRACTOR_UNZIP_OK !=
-	read_short_from_ffd (&file->z_filefunc, &uFlags)) )
-    return EXTRACTOR_UNZIP_ERRNO;
-  if (EXTRACTOR_UNZIP_OK != read_short_from_ffd (&file->z_filefunc, &uData))
-    return EXTRACTOR_UNZIP_ERRNO;
-  if (uData != file->cur_file_info.compression_method)
+  uFlags = get_short (&hdr[6]);
+  if (get_short (&hdr[8]) != file->cur_file_info.compression_method)
     return EXTRACTOR_UNZIP_BADZIPFILE;
   if ( (0 != file->cur_file_info.compression_method) &&
        (Z_DEFLATED != file->cur_file_info.compression_method) )
     return EXTRACTOR_UNZIP_BADZIPFILE;
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd (&file->z_filefunc, &uData)) /* date/time */
-    return EXTRACTOR_UNZIP_ERRNO;
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd (&file->z_filefunc, &uData)) /* crc */
-    return EXTRACTOR_UNZIP_ERRNO;
-  if ( (uData != file->cur_file_info.crc) &&
-       (0 == (uFlags & 8)) )
-    return EXTRACTOR_UNZIP_BADZIPFILE;
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd(&file->z_filefunc, &uData)) /* size compr */
-    return EXTRACTOR_UNZIP_ERRNO;
-  if ( (uData != file->cur_file_info.compressed_size) &&
-       (0 == (uFlags & 8)) )
-    return EXTRACTOR_UNZIP_BADZIPFILE;
-  if (EXTRACTOR_UNZIP_OK !=
-      read_long_from_ffd (&file->z_filefunc,
-			  &uData)) /* size uncompr */
-    return EXTRACTOR_UNZIP_ERRNO;
-  if ( (uData != file->cur_file_info.uncompressed_size) &&
-       (0 == (uFlags & 8)))
-    return EXTRACTOR_UNZIP_BADZIPFILE;
-  if (EXTRACTOR_UNZIP_OK !=
-      read_short_from_ffd (&file->z_filefunc, &size_filename))
-    return EXTRACTOR_UNZIP_ERRNO;
+  /* hdr[10..13] is the date/time, which we do not check */
+  if (0 == (uFlags & 8))
+    {
+      if ( (get_long (&hdr[14]) != file->cur_file_info.crc) ||
+	   (get_long (&hdr[18]) != file->cur_file_info.compressed_size) ||
+	   (get_long (&hdr[22]) != file->cur_file_info.uncompressed_size) )
+	return EXTRACTOR_UNZIP_BADZIPFILE;
+    }
+  size_filename = get_short (&hdr[26]);
   if (size_filename != file->cur_file_info.size_filename)
     return EXTRACTOR_UNZIP_BADZIPFILE;
   *piSizeVar += (uInt) size_filename;
-  if (EXTRACTOR_UNZIP_OK !=
-      read_short_from_ffd (&file->z_filefunc,
-			   &size_extra_field))
-    return EXTRACTOR_UNZIP_ERRNO;
+  size_extra_field = get_short (&hdr[28]);
   *poffset_local_extrafield = file->cur_file_info_internal.offset_curfile +
     SIZEZIPLOCALHEADER + size_filename;
   *psize_local_extrafield = (uInt) size_extra_field;
@@ -1347,7 +1319,7 @@ ec_read_file_func (voidpf opaque,
     {
       ret = ec->read (ec->cls,
 		      &ptr,
-		      size);
+		      size - done);
       if (ret <= 0)
 	return done;
       memcpy (buf + done, ptr, ret);
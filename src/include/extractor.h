@@ -388,7 +388,11 @@ enum EXTRACTOR_MetaType
     EXTRACTOR_METATYPE_NARINFO = 229,
     EXTRACTOR_METATYPE_NAR = 230,
 
-    EXTRACTOR_METATYPE_LAST = 231
+    EXTRACTOR_METATYPE_LIBRARY_SONAME = 231,
+    EXTRACTOR_METATYPE_PROGRAM_INTERPRETER = 232,
+    EXTRACTOR_METATYPE_BUILD_ID = 233,
+
+    EXTRACTOR_METATYPE_LAST = 234
   };
 
 /** @} */ /* end of meta data types */
@@ -514,6 +518,29 @@ struct EXTRACTOR_ExtractContext
    */
   EXTRACTOR_MetaDataProcessor proc;
 
+  /**
+   * Check if the application wants meta data of the given type.
+   * Plugins should use this to skip expensive work (i.e. generating
+   * thumbnails) if nobody wants the result; they may still return
+   * meta data of types that are not wanted.
+   *
+   * @param cls the @e cls member of this struct
+   * @param type type of meta data
+   * @return 1 if meta data of this type is wanted, 0 if not
+   */
+  int (*wants) (void *cls,
+		enum EXTRACTOR_MetaType type);
+
+  /**
+   * MIME type of the file, as determined by libextractor from the
+   * first bytes of the file using its built-in table of signatures;
+   * NULL if the signature is not known.  Plugins can use this to
+   * skip files they cannot handle without reading any data.  As
+   * libextractor does not consult libmagic, plugins must determine
+   * the type themselves if this is NULL.
+   */
+  const char *mime_hint;
+
 };
 
 
@@ -619,6 +646,63 @@ void
 EXTRACTOR_plugin_remove_all (struct EXTRACTOR_PluginList *plugins);
 
 
+/**
+ * Limit how long #EXTRACTOR_extract() may take for each file.  Once
+ * the limit is reached, all plugins are told to stop (as if @a proc
+ * had returned 1); out-of-process plugins that do not finish within
+ * a short grace period are killed (and restarted for the next file).
+ * Meta data delivered before the limit was reached is kept.
+ * In-process plugins can only be stopped when they next call one of
+ * the functions of their #EXTRACTOR_ExtractContext.
+ *
+ * @param plugins the list of plugins (as returned by the last call
+ *        to #EXTRACTOR_plugin_add() or similar functions; removing
+ *        or adding plugins preserves the setting)
+ * @param timeout_ms maximum time in milliseconds, 0 for no limit
+ *        (the default)
+ */
+void
+EXTRACTOR_plugin_set_timeout (struct EXTRACTOR_PluginList *plugins,
+			      unsigned int timeout_ms);
+
+
+/**
+ * Abort the #EXTRACTOR_extract() call that is currently running
+ * with the given list of plugins.  The plugins are stopped the same
+ * way as when the timeout set with #EXTRACTOR_plugin_set_timeout()
+ * is reached, but it may take up to 500 ms for #EXTRACTOR_extract()
+ * to notice.  Safe to call from another thread or from within the
+ * meta data processor.  If no extraction is running, the next call
+ * to #EXTRACTOR_extract() with these plugins returns immediately
+ * without extracting anything.  Either way, the cancellation is
+ * cleared when #EXTRACTOR_extract() returns.
+ *
+ * @param plugins the list of plugins passed to #EXTRACTOR_extract()
+ */
+void
+EXTRACTOR_cancel (struct EXTRACTOR_PluginList *plugins);
+
+
+/**
+ * Tell the plugins which types of meta data the application wants,
+ * so that they can skip work whose results would be ignored (i.e.
+ * thumbnail generation if only the title is wanted).  This is only
+ * a hint: the meta data processor may still be called with other
+ * types of meta data and must filter them if needed.
+ *
+ * @param plugins the list of plugins (as returned by the last call
+ *        to #EXTRACTOR_plugin_add() or similar functions; removing
+ *        or adding plugins preserves the setting)
+ * @param types array of wanted types
+ * @param num_types number of entries in @a types, 0 to want all
+ *        types (the default)
+ */
+void
+EXTRACTOR_plugin_set_wanted_types (struct EXTRACTOR_PluginList *plugins,
+				   const enum EXTRACTOR_MetaType *types,
+				   unsigned int num_types);
+
+
 /**
  * Extract keywords from a file using the given set of plugins.
  *
@@ -47,6 +47,9 @@
 #include <stdint.h>
 #include <fcntl.h>
 #include <time.h>
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
 #include <utime.h>
 #include <errno.h>
 #include <stdarg.h>
@@ -0,0 +1,1653 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_corpus.c
+ * @brief generators for large synthetic files
+ */
+#include "platform.h"
+#include "bench_corpus.h"
+#include "bench_lib.h"
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if HAVE_LIBBZ2
+#include <bzlib.h>
+#endif
+
+/**
+ * Size of the block of pseudo-random data we use as file contents.
+ */
+#define FILLER_SIZE (1024 * 1024)
+
+/**
+ * Size of each file in the tar archives.
+ */
+#define TAR_ENTRY_SIZE (1024 * 1024)
+
+/**
+ * Size of each video frame in the AVI files.
+ */
+#define AVI_FRAME_SIZE (64 * 1024)
+
+/**
+ * Size of each sample in the MP4 files.
+ */
+#define MP4_SAMPLE_SIZE 4096
+
+/**
+ * Number of samples per chunk in the MP4 files.
+ */
+#define MP4_SAMPLES_PER_CHUNK 16
+
+/**
+ * Sector size of the OLE2 files.
+ */
+#define OLE2_SECTOR_SIZE 512
+
+/**
+ * Streams smaller than this are stored in the OLE2 mini stream.
+ */
+#define OLE2_MINI_CUTOFF 4096
+
+/**
+ * Special OLE2 sector numbers.
+ */
+#define OLE2_DIFSECT 0xFFFFFFFCU
+#define OLE2_FATSECT 0xFFFFFFFDU
+#define OLE2_ENDOFCHAIN 0xFFFFFFFEU
+#define OLE2_FREESECT 0xFFFFFFFFU
+
+
+/**
+ * Compression to apply to the generated file.
+ */
+enum CorpusCompression
+{
+  CORPUS_PLAIN,
+  CORPUS_GZIP,
+  CORPUS_BZIP2
+};
+
+
+/**
+ * Output file of a generator.
+ */
+struct CorpusOutput
+{
+  /**
+   * Plain output file (also underlying the bz2 stream).
+   */
+  FILE *f;
+
+#if HAVE_ZLIB
+  /**
+   * gzip output, NULL if not used.
+   */
+  gzFile gz;
+#endif
+
+#if HAVE_LIBBZ2
+  /**
+   * bzip2 output, NULL if not used.
+   */
+  BZFILE *bz;
+#endif
+
+  /**
+   * Number of (uncompressed) bytes written so far.
+   */
+  uint64_t pos;
+
+  /**
+   * Set to 1 once a write failed.
+   */
+  int failed;
+};
+
+
+/**
+ * Growing memory buffer used to assemble headers.
+ */
+struct CorpusBuffer
+{
+  /**
+   * Data of the buffer.
+   */
+  unsigned char *data;
+
+  /**
+   * Number of bytes used in @e data.
+   */
+  size_t len;
+
+  /**
+   * Number of bytes allocated in @e data.
+   */
+  size_t size;
+
+  /**
+   * Set to 1 if we ran out of memory.
+   */
+  int failed;
+};
+
+
+/**
+ * Pseudo-random file contents, see #get_filler().
+ */
+static unsigned char *filler;
+
+/**
+ * Table for #corpus_crc32(), initialized on first use.
+ */
+static uint32_t crc_table[256];
+
+
+/**
+ * Get the block of data we use as file contents.
+ *
+ * @return NULL if we are out of memory
+ */
+static const unsigned char *
+get_filler ()
+{
+  if (NULL != filler)
+    return filler;
+  if (NULL == (filler = malloc (FILLER_SIZE)))
+    return NULL;
+  BENCH_fill (filler, FILLER_SIZE);
+  return filler;
+}
+
+
+/**
+ * Update a CRC-32 (as used by zip and PNG).
+ *
+ * @param crc CRC of the data so far (0 initially)
+ * @param buf data to add
+ * @param size number of bytes in @a buf
+ * @return updated CRC
+ */
+static uint32_t
+corpus_crc32 (uint32_t crc,
+	      const void *buf,
+	      size_t size)
+{
+  const unsigned char *b = buf;
+  uint32_t c;
+  unsigned int i;
+  unsigned int k;
+
+  if (0 == crc_table[1])
+    for (i = 0; i < 256; i++)
+      {
+	c = i;
+	for (k = 0; k < 8; k++)
+	  c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+	crc_table[i] = c;
+      }
+  crc = ~crc;
+  while (size-- > 0)
+    crc = crc_table[(crc ^ *b++) & 0xFF] ^ (crc >> 8);
+  return ~crc;
+}
+
+
+/**
+ * Open the output file.
+ *
+ * @param out output to initialize
+ * @param filename name of the file to create
+ * @param cc compression to use
+ * @return 0 on success, 1 on failure
+ */
+static int
+out_open (struct CorpusOutput *out,
+	  const char *filename,
+	  enum CorpusCompression cc)
+{
+  memset (out, 0, sizeof (struct CorpusOutput));
+  switch (cc)
+    {
+    case CORPUS_PLAIN:
+      out->f = fopen (filename, "wb");
+      break;
+    case CORPUS_GZIP:
+#if HAVE_ZLIB
+      if (NULL != (out->gz = gzopen (filename, "wb6")))
+	return 0;
+#endif
+      break;
+    case CORPUS_BZIP2:
+#if HAVE_LIBBZ2
+      {
+	int bzerror;
+
+	if (NULL == (out->f = fopen (filename, "wb")))
+	  break;
+	if (NULL != (out->bz = BZ2_bzWriteOpen (&bzerror, out->f, 9, 0, 0)))
+	  return 0;
+	fclose (out->f);
+	out->f = NULL;
+      }
+#endif
+      break;
+    }
+  if (NULL != out->f)
+    return 0;
+  fprintf (stderr,
+	   "Failed to create `%s'\n",
+	   filename);
+  return 1;
+}
+
+
+/**
+ * Write data to the output.
+ *
+ * @param out output to write to
+ * @param buf data to write
+ * @param size number of bytes in @a buf
+ */
+static void
+out_write (struct CorpusOutput *out,
+	   const void *buf,
+	   size_t size)
+{
+  if ( (out->failed) ||
+       (0 == size) )
+    return;
+#if HAVE_ZLIB
+  if (NULL != out->gz)
+    {
+      if ((int) size != gzwrite (out->gz, buf, size))
+	out->failed = 1;
+      out->pos += size;
+      return;
+    }
+#endif
+#if HAVE_LIBBZ2
+  if (NULL != out->bz)
+    {
+      int bzerror;
+
+      BZ2_bzWrite (&bzerror, out->bz, (void *) buf, size);
+      if (BZ_OK != bzerror)
+	out->failed = 1;
+      out->pos += size;
+      return;
+    }
+#endif
+  if (size != fwrite (buf, 1, size, out->f))
+    out->failed = 1;
+  out->pos += size;
+}
+
+
+/**
+ * Write @a size bytes of pseudo-random data to the output.
+ *
+ * @param out output to write to
+ * @param size number of bytes to write
+ */
+static void
+out_fill (struct CorpusOutput *out,
+	  uint64_t size)
+{
+  const unsigned char *data;
+  size_t off;
+  size_t chunk;
+
+  if (NULL == (data = get_filler ()))
+    {
+      out->failed = 1;
+      return;
+    }
+  while ( (size > 0) &&
+	  (! out->failed) )
+    {
+      /* vary the offset so that the data does not repeat too often */
+      off = (size_t) ((out->pos * 7) % (FILLER_SIZE / 2));
+      chunk = FILLER_SIZE - off;
+      if (chunk > size)
+	chunk = (size_t) size;
+      out_write (out, &data[off], chunk);
+      size -= chunk;
+    }
+}
+
+
+/**
+ * Write @a size zero bytes to the output.
+ *
+ * @param out output to write to
+ * @param size number of bytes to write (at most 512)
+ */
+static void
+out_zero (struct CorpusOutput *out,
+	  size_t size)
+{
+  static const unsigned char zero[512];
+
+  out_write (out, zero, size);
+}
+
+
+/**
+ * Write a little-endian 32-bit value to the output.
+ *
+ * @param out output to write to
+ * @param v value to write
+ */
+static void
+out_le32 (struct CorpusOutput *out,
+	  uint32_t v)
+{
+  unsigned char b[4];
+
+  b[0] = v & 0xFF;
+  b[1] = (v >> 8) & 0xFF;
+  b[2] = (v >> 16) & 0xFF;
+  b[3] = (v >> 24) & 0xFF;
+  out_write (out, b, sizeof (b));
+}
+
+
+/**
+ * Close the output file.  Removes the file on failure.
+ *
+ * @param out output to close
+ * @param filename name of the file
+ * @return 0 on success, 1 on failure
+ */
+static int
+out_close (struct CorpusOutput *out,
+	   const char *filename)
+{
+  int ret;
+
+  ret = out->failed;
+#if HAVE_ZLIB
+  if (NULL != out->gz)
+    {
+      if (Z_OK != gzclose (out->gz))
+	ret = 1;
+      out->gz = NULL;
+    }
+#endif
+#if HAVE_LIBBZ2
+  if (NULL != out->bz)
+    {
+      int bzerror;
+
+      BZ2_bzWriteClose (&bzerror, out->bz, ret, NULL, NULL);
+      if (BZ_OK != bzerror)
+	ret = 1;
+      out->bz = NULL;
+    }
+#endif
+  if ( (NULL != out->f) &&
+       (0 != fclose (out->f)) )
+    ret = 1;
+  out->f = NULL;
+  if (0 != ret)
+    {
+      fprintf (stderr,
+	       "Failed to write `%s'\n",
+	       filename);
+      UNLINK (filename);
+    }
+  return ret;
+}
+
+
+/**
+ * Append data to a buffer.
+ *
+ * @param b buffer to append to
+ * @param data data to append, NULL to append zeros
+ * @param size number of bytes to append
+ */
+static void
+buf_append (struct CorpusBuffer *b,
+	    const void *data,
+	    size_t size)
+{
+  unsigned char *n;
+  size_t nsize;
+
+  if (b->failed)
+    return;
+  if (b->len + size > b->size)
+    {
+      nsize = (0 == b->size) ? 4096 : b->size;
+      while (nsize < b->len + size)
+	nsize *= 2;
+      if (NULL == (n = realloc (b->data, nsize)))
+	{
+	  b->failed = 1;
+	  return;
+	}
+      b->data = n;
+      b->size = nsize;
+    }
+  if (NULL == data)
+    memset (&b->data[b->len], 0, size);
+  else
+    memcpy (&b->data[b->len], data, size);
+  b->len += size;
+}
+
+
+/**
+ * Append a little-endian 16-bit value to a buffer.
+ *
+ * @param b buffer to append to
+ * @param v value to append
+ */
+static void
+buf_le16 (struct CorpusBuffer *b,
+	  uint16_t v)
+{
+  unsigned char d[2];
+
+  d[0] = v & 0xFF;
+  d[1] = (v >> 8) & 0xFF;
+  buf_append (b, d, sizeof (d));
+}
+
+
+/**
+ * Store a little-endian 32-bit value.
+ *
+ * @param d where to store the value
+ * @param v value to store
+ */
+static void
+set_le32 (unsigned char *d,
+	  uint32_t v)
+{
+  d[0] = v & 0xFF;
+  d[1] = (v >> 8) & 0xFF;
+  d[2] = (v >> 16) & 0xFF;
+  d[3] = (v >> 24) & 0xFF;
+}
+
+
+/**
+ * Append a little-endian 32-bit value to a buffer.
+ *
+ * @param b buffer to append to
+ * @param v value to append
+ */
+static void
+buf_le32 (struct CorpusBuffer *b,
+	  uint32_t v)
+{
+  unsigned char d[4];
+
+  set_le32 (d, v);
+  buf_append (b, d, sizeof (d));
+}
+
+
+/**
+ * Append a little-endian 64-bit value to a buffer.
+ *
+ * @param b buffer to append to
+ * @param v value to append
+ */
+static void
+buf_le64 (struct CorpusBuffer *b,
+	  uint64_t v)
+{
+  buf_le32 (b, (uint32_t) v);
+  buf_le32 (b, (uint32_t) (v >> 32));
+}
+
+
+/**
+ * Append a big-endian 16-bit value to a buffer.
+ *
+ * @param b buffer to append to
+ * @param v value to append
+ */
+static void
+buf_be16 (struct CorpusBuffer *b,
+	  uint16_t v)
+{
+  unsigned char d[2];
+
+  d[0] = (v >> 8) & 0xFF;
+  d[1] = v & 0xFF;
+  buf_append (b, d, sizeof (d));
+}
+
+
+/**
+ * Store a big-endian 32-bit value.
+ *
+ * @param d where to store the value
+ * @param v value to store
+ */
+static void
+set_be32 (unsigned char *d,
+	  uint32_t v)
+{
+  d[0] = (v >> 24) & 0xFF;
+  d[1] = (v >> 16) & 0xFF;
+  d[2] = (v >> 8) & 0xFF;
+  d[3] = v & 0xFF;
+}
+
+
+/**
+ * Append a big-endian 32-bit value to a buffer.
+ *
+ * @param b buffer to append to
+ * @param v value to append
+ */
+static void
+buf_be32 (struct CorpusBuffer *b,
+	  uint32_t v)
+{
+  unsigned char d[4];
+
+  set_be32 (d, v);
+  buf_append (b, d, sizeof (d));
+}
+
+
+/**
+ * Append a big-endian 64-bit value to a buffer.
+ *
+ * @param b buffer to append to
+ * @param v value to append
+ */
+static void
+buf_be64 (struct CorpusBuffer *b,
+	  uint64_t v)
+{
+  buf_be32 (b, (uint32_t) (v >> 32));
+  buf_be32 (b, (uint32_t) v);
+}
+
+
+/**
+ * Write the buffer to the output and empty it.
+ *
+ * @param b buffer to flush
+ * @param out output to write to
+ */
+static void
+buf_flush (struct CorpusBuffer *b,
+	   struct CorpusOutput *out)
+{
+  if (b->failed)
+    out->failed = 1;
+  else
+    out_write (out, b->data, b->len);
+  b->len = 0;
+}
+
+
+/**
+ * Start a RIFF chunk (little-endian size after the fourcc).
+ *
+ * @param b buffer to append to
+ * @param fourcc type of the chunk
+ * @return offset of the size field, for #riff_end()
+ */
+static size_t
+riff_begin (struct CorpusBuffer *b,
+	    const char *fourcc)
+{
+  size_t off;
+
+  buf_append (b, fourcc, 4);
+  off = b->len;
+  buf_le32 (b, 0);
+  return off;
+}
+
+
+/**
+ * Finish a RIFF chunk started with #riff_begin().
+ *
+ * @param b buffer with the chunk
+ * @param off offset of the size field
+ */
+static void
+riff_end (struct CorpusBuffer *b,
+	  size_t off)
+{
+  if (! b->failed)
+    set_le32 (&b->data[off], (uint32_t) (b->len - off - 4));
+}
+
+
+/**
+ * Start an ISO base media file format box (big-endian size
+ * before the type).
+ *
+ * @param b buffer to append to
+ * @param type type of the box
+ * @return offset of the box, for #box_end()
+ */
+static size_t
+box_begin (struct CorpusBuffer *b,
+	   const char *type)
+{
+  size_t off;
+
+  off = b->len;
+  buf_be32 (b, 0);
+  buf_append (b, type, 4);
+  return off;
+}
+
+
+/**
+ * Finish a box started with #box_begin().
+ *
+ * @param b buffer with the box
+ * @param off offset of the box
+ */
+static void
+box_end (struct CorpusBuffer *b,
+	 size_t off)
+{
+  if (! b->failed)
+    set_be32 (&b->data[off], (uint32_t) (b->len - off));
+}
+
+
+/**
+ * Describe a zip entry.
+ *
+ * @param i number of the entry
+ * @param name where to store the name of the entry
+ * @param name_size number of bytes available in @a name
+ * @param data set to the contents of the entry
+ * @param crc set to the CRC-32 of the contents
+ * @return size of the contents, 0 if we are out of memory
+ */
+static size_t
+zip_entry (uint64_t i,
+	   char *name,
+	   size_t name_size,
+	   const unsigned char **data,
+	   uint32_t *crc)
+{
+  const unsigned char *f;
+  size_t len;
+
+  if (NULL == (f = get_filler ()))
+    return 0;
+  snprintf (name,
+	    name_size,
+	    "dir%05llu/file%08llu.dat",
+	    (unsigned long long) (i / 1000),
+	    (unsigned long long) i);
+  len = 32 + (size_t) (i % 128);
+  *data = &f[(i * 4099) % (FILLER_SIZE - 256)];
+  *crc = corpus_crc32 (0, *data, len);
+  return len;
+}
+
+
+/**
+ * Append the fields shared by zip local and central headers.
+ *
+ * @param b buffer to append to
+ * @param crc CRC-32 of the contents
+ * @param len size of the contents
+ * @param name_len length of the name
+ */
+static void
+zip_common (struct CorpusBuffer *b,
+	    uint32_t crc,
+	    size_t len,
+	    size_t name_len)
+{
+  buf_le16 (b, 10);     /* version needed: stored */
+  buf_le16 (b, 0);      /* flags */
+  buf_le16 (b, 0);      /* method: stored */
+  buf_le16 (b, 0x6000); /* 12:00 */
+  buf_le16 (b, ((2018 - 1980) << 9) | (1 << 5) | 1);
+  buf_le32 (b, crc);
+  buf_le32 (b, (uint32_t) len);
+  buf_le32 (b, (uint32_t) len);
+  buf_le16 (b, (uint16_t) name_len);
+  buf_le16 (b, 0);      /* extra field length */
+}
+
+
+int
+BENCH_corpus_zip (const char *filename,
+		  uint64_t entries)
+{
+  static const char comment[] = "libextractor benchmark corpus";
+  struct CorpusOutput out;
+  struct CorpusBuffer b;
+  const unsigned char *data;
+  char name[64];
+  uint64_t i;
+  uint64_t off;
+  uint64_t cd_off;
+  uint64_t cd_size;
+  uint32_t crc;
+  size_t len;
+  size_t name_len;
+
+  if (0 != out_open (&out, filename, CORPUS_PLAIN))
+    return 1;
+  memset (&b, 0, sizeof (b));
+  for (i = 0; (i < entries) && (! out.failed); i++)
+    {
+      if (0 == (len = zip_entry (i, name, sizeof (name), &data, &crc)))
+	out.failed = 1;
+      if (out.pos > 0xFFFFFFFFLLU)
+	{
+	  fprintf (stderr,
+		   "Too many entries, zip64 local headers are not supported\n");
+	  out.failed = 1;
+	}
+      name_len = strlen (name);
+      buf_le32 (&b, 0x04034b50);
+      zip_common (&b, crc, len, name_len);
+      buf_append (&b, name, name_len);
+      buf_append (&b, data, len);
+      buf_flush (&b, &out);
+    }
+  cd_off = out.pos;
+  off = 0;
+  for (i = 0; (i < entries) && (! out.failed); i++)
+    {
+      len = zip_entry (i, name, sizeof (name), &data, &crc);
+      name_len = strlen (name);
+      buf_le32 (&b, 0x02014b50);
+      buf_le16 (&b, 0x031E); /* made by: UNIX, 3.0 */
+      zip_common (&b, crc, len, name_len);
+      buf_le16 (&b, 0);      /* comment length */
+      buf_le16 (&b, 0);      /* disk number */
+      buf_le16 (&b, 0);      /* internal attributes */
+      buf_le32 (&b, 0100644U << 16);
+      buf_le32 (&b, (uint32_t) off);
+      buf_append (&b, name, name_len);
+      buf_flush (&b, &out);
+      off += 30 + name_len + len;
+    }
+  cd_size = out.pos - cd_off;
+  if ( (entries >= 0xFFFF) ||
+       (cd_off + cd_size > 0xFFFFFFFFLLU) )
+    {
+      /* zip64 end of central directory record and locator */
+      buf_le32 (&b, 0x06064b50);
+      buf_le64 (&b, 44);
+      buf_le16 (&b, 45);
+      buf_le16 (&b, 45);
+      buf_le32 (&b, 0);
+      buf_le32 (&b, 0);
+      buf_le64 (&b, entries);
+      buf_le64 (&b, entries);
+      buf_le64 (&b, cd_size);
+      buf_le64 (&b, cd_off);
+      buf_le32 (&b, 0x07064b50);
+      buf_le32 (&b, 0);
+      buf_le64 (&b, cd_off + cd_size);
+      buf_le32 (&b, 1);
+    }
+  buf_le32 (&b, 0x06054b50);
+  buf_le16 (&b, 0);
+  buf_le16 (&b, 0);
+  buf_le16 (&b, (entries >= 0xFFFF) ? 0xFFFF : (uint16_t) entries);
+  buf_le16 (&b, (entries >= 0xFFFF) ? 0xFFFF : (uint16_t) entries);
+  buf_le32 (&b, (cd_size >= 0xFFFFFFFFLLU) ? 0xFFFFFFFFU : (uint32_t) cd_size);
+  buf_le32 (&b, (cd_off >= 0xFFFFFFFFLLU) ? 0xFFFFFFFFU : (uint32_t) cd_off);
+  buf_le16 (&b, sizeof (comment) - 1);
+  buf_append (&b, comment, sizeof (comment) - 1);
+  buf_flush (&b, &out);
+  free (b.data);
+  return out_close (&out, filename);
+}
+
+
+/**
+ * Fill in a ustar header.
+ *
+ * @param hdr header to fill in
+ * @param name name of the file
+ * @param size size of the file
+ */
+static void
+tar_header (char hdr[512],
+	    const char *name,
+	    uint64_t size)
+{
+  unsigned int sum;
+  unsigned int i;
+
+  memset (hdr, 0, 512);
+  snprintf (&hdr[0], 100, "%s", name);
+  memcpy (&hdr[100], "0000644", 8);
+  memcpy (&hdr[108], "0001750", 8);
+  memcpy (&hdr[116], "0001750", 8);
+  snprintf (&hdr[124], 12, "%011llo", (unsigned long long) size);
+  snprintf (&hdr[136], 12, "%011o", 1514764800U); /* 2018-01-01 */
+  memset (&hdr[148], ' ', 8);
+  hdr[156] = '0';
+  memcpy (&hdr[257], "ustar", 6);
+  memcpy (&hdr[263], "00", 2);
+  memcpy (&hdr[265], "bench", 6);
+  memcpy (&hdr[297], "bench", 6);
+  sum = 0;
+  for (i = 0; i < 512; i++)
+    sum += (unsigned char) hdr[i];
+  snprintf (&hdr[148], 8, "%06o", sum);
+  hdr[155] = ' ';
+}
+
+
+/**
+ * Write a (possibly compressed) tar archive.
+ *
+ * @param filename name of the file to create
+ * @param size total size of the files in the archive
+ * @param cc compression to use
+ * @return 0 on success, 1 on failure
+ */
+static int
+tar_write (const char *filename,
+	   uint64_t size,
+	   enum CorpusCompression cc)
+{
+  struct CorpusOutput out;
+  char hdr[512];
+  char name[64];
+  uint64_t i;
+  uint64_t len;
+
+  if (0 != out_open (&out, filename, cc))
+    return 1;
+  for (i = 0; (i * TAR_ENTRY_SIZE < size) && (! out.failed); i++)
+    {
+      len = size - i * TAR_ENTRY_SIZE;
+      if (len > TAR_ENTRY_SIZE)
+	len = TAR_ENTRY_SIZE;
+      snprintf (name,
+		sizeof (name),
+		"bench/file%07llu.dat",
+		(unsigned long long) i);
+      tar_header (hdr, name, len);
+      out_write (&out, hdr, sizeof (hdr));
+      out_fill (&out, len);
+      if (0 != (len % 512))
+	out_zero (&out, 512 - (len % 512));
+    }
+  /* two empty blocks, padded to a full 10 KiB record */
+  out_zero (&out, 512);
+  out_zero (&out, 512);
+  while (0 != (out.pos % 10240))
+    out_zero (&out, 512);
+  return out_close (&out, filename);
+}
+
+
+int
+BENCH_corpus_tar_gz (const char *filename,
+		     uint64_t size)
+{
+  return tar_write (filename, size, CORPUS_GZIP);
+}
+
+
+int
+BENCH_corpus_tar_bz2 (const char *filename,
+		      uint64_t size)
+{
+  return tar_write (filename, size, CORPUS_BZIP2);
+}
+
+
+int
+BENCH_corpus_avi (const char *filename,
+		  uint64_t size)
+{
+  struct CorpusOutput out;
+  struct CorpusBuffer b;
+  uint64_t frames;
+  uint64_t movi_size;
+  uint64_t riff_size;
+  uint64_t i;
+  uint32_t len;
+  uint32_t off;
+  size_t hdrl;
+  size_t strl;
+  size_t chunk;
+
+  frames = (size + AVI_FRAME_SIZE - 1) / AVI_FRAME_SIZE;
+  if (0 == frames)
+    frames = 1;
+  /* frames are even-sized, so no padding is needed */
+  size = (size + 1) & ~1LLU;
+  movi_size = 4 + frames * 8 + size;
+  /* "AVI ", 'hdrl' list (200 bytes), 'movi' list, 'idx1' */
+  riff_size = 4 + 200 + 8 + movi_size + 8 + 16 * frames;
+  if (riff_size > 0xFFFFFFFFLLU)
+    {
+      fprintf (stderr,
+	       "AVI files larger than 4 GiB (AVIX) are not supported\n");
+      return 1;
+    }
+  if (0 != out_open (&out, filename, CORPUS_PLAIN))
+    return 1;
+  memset (&b, 0, sizeof (b));
+  buf_append (&b, "RIFF", 4);
+  buf_le32 (&b, (uint32_t) riff_size);
+  buf_append (&b, "AVI ", 4);
+  hdrl = riff_begin (&b, "LIST");
+  buf_append (&b, "hdrl", 4);
+  chunk = riff_begin (&b, "avih");
+  buf_le32 (&b, 40000);          /* microseconds per frame (25 fps) */
+  buf_le32 (&b, AVI_FRAME_SIZE * 25);
+  buf_le32 (&b, 0);              /* padding granularity */
+  buf_le32 (&b, 0x10);           /* AVIF_HASINDEX */
+  buf_le32 (&b, (uint32_t) frames);
+  buf_le32 (&b, 0);              /* initial frames */
+  buf_le32 (&b, 1);              /* streams */
+  buf_le32 (&b, AVI_FRAME_SIZE);
+  buf_le32 (&b, 640);
+  buf_le32 (&b, 480);
+  buf_append (&b, NULL, 16);
+  riff_end (&b, chunk);
+  strl = riff_begin (&b, "LIST");
+  buf_append (&b, "strl", 4);
+  chunk = riff_begin (&b, "strh");
+  buf_append (&b, "vidsXVID", 8);
+  buf_le32 (&b, 0);              /* flags */
+  buf_le16 (&b, 0);              /* priority */
+  buf_le16 (&b, 0);              /* language */
+  buf_le32 (&b, 0);              /* initial frames */
+  buf_le32 (&b, 1);              /* scale */
+  buf_le32 (&b, 25);             /* rate */
+  buf_le32 (&b, 0);              /* start */
+  buf_le32 (&b, (uint32_t) frames);
+  buf_le32 (&b, AVI_FRAME_SIZE);
+  buf_le32 (&b, 0xFFFFFFFFU);    /* quality */
+  buf_le32 (&b, 0);              /* sample size */
+  buf_le16 (&b, 0);
+  buf_le16 (&b, 0);
+  buf_le16 (&b, 640);
+  buf_le16 (&b, 480);
+  riff_end (&b, chunk);
+  chunk = riff_begin (&b, "strf");
+  buf_le32 (&b, 40);             /* BITMAPINFOHEADER */
+  buf_le32 (&b, 640);
+  buf_le32 (&b, 480);
+  buf_le16 (&b, 1);
+  buf_le16 (&b, 24);
+  buf_append (&b, "XVID", 4);
+  buf_le32 (&b, 640 * 480 * 3);
+  buf_append (&b, NULL, 16);
+  riff_end (&b, chunk);
+  riff_end (&b, strl);
+  riff_end (&b, hdrl);
+  buf_append (&b, "LIST", 4);
+  buf_le32 (&b, (uint32_t) movi_size);
+  buf_append (&b, "movi", 4);
+  buf_flush (&b, &out);
+  for (i = 0; (i < frames) && (! out.failed); i++)
+    {
+      len = (i + 1 < frames) ? AVI_FRAME_SIZE : size - i * AVI_FRAME_SIZE;
+      out_write (&out, "00dc", 4);
+      out_le32 (&out, len);
+      out_fill (&out, len);
+    }
+  out_write (&out, "idx1", 4);
+  out_le32 (&out, (uint32_t) (16 * frames));
+  off = 4;
+  for (i = 0; (i < frames) && (! out.failed); i++)
+    {
+      len = (i + 1 < frames) ? AVI_FRAME_SIZE : size - i * AVI_FRAME_SIZE;
+      out_write (&out, "00dc", 4);
+      out_le32 (&out, (0 == i % 25) ? 0x10 : 0); /* AVIIF_KEYFRAME */
+      out_le32 (&out, off);
+      out_le32 (&out, len);
+      off += 8 + len;
+    }
+  free (b.data);
+  if (out.pos != 8 + riff_size)
+    out.failed = 1;
+  return out_close (&out, filename);
+}
+
+
+/**
+ * Write a PNG chunk.
+ *
+ * @param out output to write to
+ * @param type type of the chunk
+ * @param data payload of the chunk
+ * @param size number of bytes in @a data
+ */
+static void
+png_chunk (struct CorpusOutput *out,
+	   const char *type,
+	   const void *data,
+	   size_t size)
+{
+  unsigned char d[4];
+  uint32_t crc;
+
+  set_be32 (d, (uint32_t) size);
+  out_write (out, d, 4);
+  out_write (out, type, 4);
+  out_write (out, data, size);
+  crc = corpus_crc32 (0, type, 4);
+  crc = corpus_crc32 (crc, data, size);
+  set_be32 (d, crc);
+  out_write (out, d, 4);
+}
+
+
+int
+BENCH_corpus_png (const char *filename,
+		  uint64_t chunks)
+{
+  static const unsigned char signature[] = {
+    0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A
+  };
+  static const unsigned char ihdr[] = {
+    0, 0, 0, 1, 0, 0, 0, 1, 8, 0, 0, 0, 0
+  };
+  /* zlib stream with one stored block: filter byte and one gray pixel */
+  static const unsigned char idat[] = {
+    0x78, 0x01, 0x01, 0x02, 0x00, 0xFD, 0xFF, 0x00, 0x00,
+    0x00, 0x02, 0x00, 0x01
+  };
+  static const char *keywords[] = {
+    "Title", "Author", "Description", "Copyright", "Software", "Comment"
+  };
+  struct CorpusOutput out;
+  char text[128];
+  uint64_t i;
+  int len;
+
+  if (0 != out_open (&out, filename, CORPUS_PLAIN))
+    return 1;
+  out_write (&out, signature, sizeof (signature));
+  png_chunk (&out, "IHDR", ihdr, sizeof (ihdr));
+  for (i = 0; (i < chunks) && (! out.failed); i++)
+    {
+      len = snprintf (text,
+		      sizeof (text),
+		      "%s%cbenchmark text chunk %llu",
+		      keywords[i % (sizeof (keywords) / sizeof (keywords[0]))],
+		      '\0',
+		      (unsigned long long) i);
+      png_chunk (&out, "tEXt", text, len);
+    }
+  png_chunk (&out, "IDAT", idat, sizeof (idat));
+  png_chunk (&out, "IEND", "", 0);
+  return out_close (&out, filename);
+}
+
+
+/**
+ * Append an OLE2 directory entry.
+ *
+ * @param b buffer to append to
+ * @param name name of the entry (ASCII), NULL for an unused entry
+ * @param type 5 for the root, 2 for a stream, 0 for unused
+ * @param right right sibling
+ * @param child child (only for the root)
+ * @param start first sector of the stream
+ * @param size size of the stream
+ */
+static void
+ole2_dirent (struct CorpusBuffer *b,
+	     const char *name,
+	     uint8_t type,
+	     uint32_t right,
+	     uint32_t child,
+	     uint32_t start,
+	     uint32_t size)
+{
+  size_t len;
+  size_t i;
+  uint8_t color;
+
+  len = (NULL == name) ? 0 : strlen (name);
+  for (i = 0; i < 32; i++)
+    buf_le16 (b, (i < len) ? (unsigned char) name[i] : 0);
+  buf_le16 (b, (0 == len) ? 0 : (uint16_t) ((len + 1) * 2));
+  buf_append (b, &type, 1);
+  color = (0 == type) ? 0 : 1; /* black */
+  buf_append (b, &color, 1);
+  buf_le32 (b, OLE2_FREESECT); /* left sibling: none */
+  buf_le32 (b, right);
+  buf_le32 (b, child);
+  buf_append (b, NULL, 16 + 4 + 8 + 8); /* CLSID, state, times */
+  buf_le32 (b, start);
+  buf_le32 (b, size);
+  buf_le32 (b, 0);
+}
+
+
+/**
+ * Append a string property (VT_LPSTR) to a property set.
+ *
+ * @param b buffer to append to
+ * @param value value of the property
+ */
+static void
+ole2_string_property (struct CorpusBuffer *b,
+		      const char *value)
+{
+  size_t len;
+
+  len = strlen (value) + 1;
+  buf_le32 (b, 30); /* VT_LPSTR */
+  buf_le32 (b, (uint32_t) len);
+  buf_append (b, value, len);
+  buf_append (b, NULL, (4 - len % 4) % 4);
+}
+
+
+/**
+ * Append the SummaryInformation property set (padded to
+ * #OLE2_MINI_CUTOFF bytes so that it is not in the mini stream).
+ *
+ * @param b buffer to append to
+ */
+static void
+ole2_summary (struct CorpusBuffer *b)
+{
+  static const unsigned char fmtid[] = {
+    0xE0, 0x85, 0x9F, 0xF2, 0xF9, 0x4F, 0x68, 0x10,
+    0xAB, 0x91, 0x08, 0x00, 0x2B, 0x27, 0xB3, 0xD9
+  };
+  size_t start;
+  size_t section;
+  size_t offsets;
+
+  start = b->len;
+  buf_le16 (b, 0xFFFE);
+  buf_le16 (b, 0);
+  buf_le32 (b, 0x00020005); /* OS version */
+  buf_append (b, NULL, 16);
+  buf_le32 (b, 1);
+  buf_append (b, fmtid, sizeof (fmtid));
+  buf_le32 (b, 48);
+  section = b->len;
+  buf_le32 (b, 0);          /* size, set below */
+  buf_le32 (b, 3);
+  offsets = b->len;
+  buf_append (b, NULL, 3 * 8);
+  if (b->failed)
+    return;
+  set_le32 (&b->data[offsets], 1);  /* PID_CODEPAGE */
+  set_le32 (&b->data[offsets + 4], (uint32_t) (b->len - section));
+  buf_le32 (b, 2);          /* VT_I2 */
+  buf_le16 (b, 1252);
+  buf_le16 (b, 0);
+  if (b->failed)
+    return;
+  set_le32 (&b->data[offsets + 8], 2);  /* PID_TITLE */
+  set_le32 (&b->data[offsets + 12], (uint32_t) (b->len - section));
+  ole2_string_property (b, "Benchmark corpus");
+  if (b->failed)
+    return;
+  set_le32 (&b->data[offsets + 16], 4); /* PID_AUTHOR */
+  set_le32 (&b->data[offsets + 20], (uint32_t) (b->len - section));
+  ole2_string_property (b, "libextractor");
+  if (b->failed)
+    return;
+  set_le32 (&b->data[section], (uint32_t) (b->len - section));
+  buf_append (b, NULL, OLE2_MINI_CUTOFF - (b->len - start));
+}
+
+
+int
+BENCH_corpus_ole2 (const char *filename,
+		   uint64_t size)
+{
+  struct CorpusOutput out;
+  struct CorpusBuffer b;
+  unsigned char sector[OLE2_SECTOR_SIZE];
+  uint32_t summary_sectors;
+  uint32_t word_start;
+  uint32_t word_sectors;
+  uint32_t data_sectors;
+  uint32_t fat_start;
+  uint32_t fat_sectors;
+  uint32_t difat_start;
+  uint32_t difat_sectors;
+  uint32_t old_fat;
+  uint32_t old_difat;
+  uint32_t s;
+  uint32_t v;
+  uint32_t i;
+  uint64_t k;
+
+  if (size < OLE2_MINI_CUTOFF)
+    size = OLE2_MINI_CUTOFF;
+  if (size > 0xFFFFFFFFLLU - 1024 * 1024)
+    {
+      fprintf (stderr,
+	       "OLE2 streams larger than 4 GiB are not supported\n");
+      return 1;
+    }
+  /* layout: directory, SummaryInformation, WordDocument, FAT, DIFAT */
+  summary_sectors = OLE2_MINI_CUTOFF / OLE2_SECTOR_SIZE;
+  word_start = 1 + summary_sectors;
+  word_sectors = (uint32_t) ((size + OLE2_SECTOR_SIZE - 1) / OLE2_SECTOR_SIZE);
+  data_sectors = word_start + word_sectors;
+  fat_sectors = 0;
+  difat_sectors = 0;
+  do
+    {
+      old_fat = fat_sectors;
+      old_difat = difat_sectors;
+      fat_sectors = (data_sectors + fat_sectors + difat_sectors + 127) / 128;
+      difat_sectors = (fat_sectors > 109) ? (fat_sectors - 109 + 126) / 127 : 0;
+    }
+  while ( (old_fat != fat_sectors) ||
+	  (old_difat != difat_sectors) );
+  fat_start = data_sectors;
+  difat_start = fat_start + fat_sectors;
+
+  if (0 != out_open (&out, filename, CORPUS_PLAIN))
+    return 1;
+  memset (&b, 0, sizeof (b));
+  /* header */
+  buf_append (&b, "\xD0\xCF\x11\xE0\xA1\xB1\x1A\xE1", 8);
+  buf_append (&b, NULL, 16);
+  buf_le16 (&b, 0x003E);
+  buf_le16 (&b, 3);
+  buf_le16 (&b, 0xFFFE);
+  buf_le16 (&b, 9);             /* 512 byte sectors */
+  buf_le16 (&b, 6);             /* 64 byte mini sectors */
+  buf_append (&b, NULL, 6);
+  buf_le32 (&b, 0);             /* directory sectors (v4 only) */
+  buf_le32 (&b, fat_sectors);
+  buf_le32 (&b, 0);             /* first directory sector */
+  buf_le32 (&b, 0);
+  buf_le32 (&b, OLE2_MINI_CUTOFF);
+  buf_le32 (&b, OLE2_ENDOFCHAIN); /* no mini FAT */
+  buf_le32 (&b, 0);
+  buf_le32 (&b, (0 == difat_sectors) ? OLE2_ENDOFCHAIN : difat_start);
+  buf_le32 (&b, difat_sectors);
+  for (i = 0; i < 109; i++)
+    buf_le32 (&b, (i < fat_sectors) ? fat_start + i : OLE2_FREESECT);
+  /* directory; the name of the SummaryInformation stream is
+     longer, so it is the right sibling of 'WordDocument' */
+  ole2_dirent (&b, "Root Entry", 5,
+	       OLE2_FREESECT, 1, OLE2_ENDOFCHAIN, 0);
+  ole2_dirent (&b, "WordDocument", 2,
+	       2, OLE2_FREESECT, word_start, (uint32_t) size);
+  ole2_dirent (&b, "\005SummaryInformation", 2,
+	       OLE2_FREESECT, OLE2_FREESECT, 1, OLE2_MINI_CUTOFF);
+  ole2_dirent (&b, NULL, 0,
+	       OLE2_FREESECT, OLE2_FREESECT, 0, 0);
+  ole2_summary (&b);
+  buf_flush (&b, &out);
+  free (b.data);
+  /* WordDocument stream */
+  out_fill (&out, size);
+  if (0 != size % OLE2_SECTOR_SIZE)
+    out_zero (&out, OLE2_SECTOR_SIZE - size % OLE2_SECTOR_SIZE);
+  /* FAT */
+  for (s = 0; (s < fat_sectors * 128) && (! out.failed); s++)
+    {
+      if (0 == s)
+	v = OLE2_ENDOFCHAIN;
+      else if (s < word_start)
+	v = (s + 1 < word_start) ? s + 1 : OLE2_ENDOFCHAIN;
+      else if (s < data_sectors)
+	v = (s + 1 < data_sectors) ? s + 1 : OLE2_ENDOFCHAIN;
+      else if (s < difat_start)
+	v = OLE2_FATSECT;
+      else if (s < difat_start + difat_sectors)
+	v = OLE2_DIFSECT;
+      else
+	v = OLE2_FREESECT;
+      set_le32 (&sector[4 * (s % 128)], v);
+      if (127 == s % 128)
+	out_write (&out, sector, sizeof (sector));
+    }
+  /* DIFAT (FAT sectors beyond the 109 listed in the header) */
+  for (s = 0; (s < difat_sectors) && (! out.failed); s++)
+    {
+      for (i = 0; i < 127; i++)
+	{
+	  k = 109 + (uint64_t) s * 127 + i;
+	  set_le32 (&sector[4 * i],
+		    (k < fat_sectors) ? fat_start + (uint32_t) k : OLE2_FREESECT);
+	}
+      set_le32 (&sector[4 * 127],
+		(s + 1 < difat_sectors) ? difat_start + s + 1 : OLE2_ENDOFCHAIN);
+      out_write (&out, sector, sizeof (sector));
+    }
+  return out_close (&out, filename);
+}
+
+
+/**
+ * Append the matrix used in 'mvhd' and 'tkhd' boxes.
+ *
+ * @param b buffer to append to
+ */
+static void
+mp4_matrix (struct CorpusBuffer *b)
+{
+  buf_be32 (b, 0x00010000);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0x00010000);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0x40000000);
+}
+
+
+/**
+ * Append an iTunes-style meta data item.
+ *
+ * @param b buffer to append to
+ * @param type type of the item
+ * @param value UTF-8 value of the item
+ */
+static void
+mp4_item (struct CorpusBuffer *b,
+	  const char *type,
+	  const char *value)
+{
+  size_t item;
+  size_t data;
+
+  item = box_begin (b, type);
+  data = box_begin (b, "data");
+  buf_be32 (b, 1);  /* UTF-8 */
+  buf_be32 (b, 0);  /* locale */
+  buf_append (b, value, strlen (value));
+  box_end (b, data);
+  box_end (b, item);
+}
+
+
+/**
+ * Append the 'moov' box for the given samples.
+ *
+ * @param b buffer to append to
+ * @param samples number of samples
+ * @param data_off offset of the first sample in the file
+ */
+static void
+mp4_moov (struct CorpusBuffer *b,
+	  uint64_t samples,
+	  uint64_t data_off)
+{
+  static const unsigned char avcc[] = {
+    0x01, 0x42, 0xC0, 0x1E, 0xFF, 0xE1,
+    0x00, 0x09, 0x67, 0x42, 0xC0, 0x1E, 0x95, 0xA0, 0x50, 0x1E, 0xC8,
+    0x01,
+    0x00, 0x04, 0x68, 0xCE, 0x3C, 0x80
+  };
+  uint64_t chunks;
+  uint64_t duration;
+  uint64_t i;
+  size_t moov;
+  size_t trak;
+  size_t mdia;
+  size_t minf;
+  size_t dinf;
+  size_t stbl;
+  size_t stsd;
+  size_t entry;
+  size_t box;
+  size_t udta;
+  size_t meta;
+  size_t ilst;
+  int co64;
+
+  chunks = samples / MP4_SAMPLES_PER_CHUNK;
+  duration = samples * 40; /* 25 fps, in ms */
+  co64 = (data_off + samples * MP4_SAMPLE_SIZE > 0xFFFFFFFFLLU);
+  moov = box_begin (b, "moov");
+  box = box_begin (b, "mvhd");
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 1000);
+  buf_be32 (b, (uint32_t) duration);
+  buf_be32 (b, 0x00010000);
+  buf_be16 (b, 0x0100);
+  buf_append (b, NULL, 10);
+  mp4_matrix (b);
+  buf_append (b, NULL, 24);
+  buf_be32 (b, 2);
+  box_end (b, box);
+
+  trak = box_begin (b, "trak");
+  box = box_begin (b, "tkhd");
+  buf_be32 (b, 3);          /* enabled, in movie */
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 1);          /* track ID */
+  buf_be32 (b, 0);
+  buf_be32 (b, (uint32_t) duration);
+  buf_append (b, NULL, 8 + 2 + 2 + 2 + 2);
+  mp4_matrix (b);
+  buf_be32 (b, 640 << 16);
+  buf_be32 (b, 480 << 16);
+  box_end (b, box);
+  mdia = box_begin (b, "mdia");
+  box = box_begin (b, "mdhd");
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_be32 (b, 12800);
+  buf_be32 (b, (uint32_t) (samples * 512));
+  buf_be16 (b, 0x55C4);     /* 'und' */
+  buf_be16 (b, 0);
+  box_end (b, box);
+  box = box_begin (b, "hdlr");
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_append (b, "vide", 4);
+  buf_append (b, NULL, 12);
+  buf_append (b, "VideoHandler", strlen ("VideoHandler") + 1);
+  box_end (b, box);
+  minf = box_begin (b, "minf");
+  box = box_begin (b, "vmhd");
+  buf_be32 (b, 1);
+  buf_append (b, NULL, 8);
+  box_end (b, box);
+  dinf = box_begin (b, "dinf");
+  box = box_begin (b, "dref");
+  buf_be32 (b, 0);
+  buf_be32 (b, 1);
+  entry = box_begin (b, "url ");
+  buf_be32 (b, 1);          /* data is in this file */
+  box_end (b, entry);
+  box_end (b, box);
+  box_end (b, dinf);
+  stbl = box_begin (b, "stbl");
+  stsd = box_begin (b, "stsd");
+  buf_be32 (b, 0);
+  buf_be32 (b, 1);
+  entry = box_begin (b, "avc1");
+  buf_append (b, NULL, 6);
+  buf_be16 (b, 1);          /* data reference index */
+  buf_append (b, NULL, 16);
+  buf_be16 (b, 640);
+  buf_be16 (b, 480);
+  buf_be32 (b, 0x00480000); /* 72 dpi */
+  buf_be32 (b, 0x00480000);
+  buf_be32 (b, 0);
+  buf_be16 (b, 1);          /* frame count */
+  buf_append (b, NULL, 32); /* compressor name */
+  buf_be16 (b, 0x18);
+  buf_be16 (b, 0xFFFF);
+  box = box_begin (b, "avcC");
+  buf_append (b, avcc, sizeof (avcc));
+  box_end (b, box);
+  box_end (b, entry);
+  box_end (b, stsd);
+  box = box_begin (b, "stts");
+  buf_be32 (b, 0);
+  buf_be32 (b, 1);
+  buf_be32 (b, (uint32_t) samples);
+  buf_be32 (b, 512);
+  box_end (b, box);
+  box = box_begin (b, "stss");
+  buf_be32 (b, 0);
+  buf_be32 (b, (uint32_t) ((samples + 24) / 25));
+  for (i = 0; i < samples; i += 25)
+    buf_be32 (b, (uint32_t) (i + 1));
+  box_end (b, box);
+  box = box_begin (b, "stsc");
+  buf_be32 (b, 0);
+  buf_be32 (b, 1);
+  buf_be32 (b, 1);
+  buf_be32 (b, MP4_SAMPLES_PER_CHUNK);
+  buf_be32 (b, 1);
+  box_end (b, box);
+  box = box_begin (b, "stsz");
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);          /* sizes are given per sample */
+  buf_be32 (b, (uint32_t) samples);
+  for (i = 0; i < samples; i++)
+    buf_be32 (b, MP4_SAMPLE_SIZE);
+  box_end (b, box);
+  box = box_begin (b, co64 ? "co64" : "stco");
+  buf_be32 (b, 0);
+  buf_be32 (b, (uint32_t) chunks);
+  for (i = 0; i < chunks; i++)
+    if (co64)
+      buf_be64 (b, data_off + i * MP4_SAMPLES_PER_CHUNK * MP4_SAMPLE_SIZE);
+    else
+      buf_be32 (b, (uint32_t) (data_off + i * MP4_SAMPLES_PER_CHUNK * MP4_SAMPLE_SIZE));
+  box_end (b, box);
+  box_end (b, stbl);
+  box_end (b, minf);
+  box_end (b, mdia);
+  box_end (b, trak);
+
+  udta = box_begin (b, "udta");
+  meta = box_begin (b, "meta");
+  buf_be32 (b, 0);
+  box = box_begin (b, "hdlr");
+  buf_be32 (b, 0);
+  buf_be32 (b, 0);
+  buf_append (b, "mdirappl", 8);
+  buf_append (b, NULL, 8 + 1);
+  box_end (b, box);
+  ilst = box_begin (b, "ilst");
+  mp4_item (b, "\251nam", "Benchmark corpus");
+  mp4_item (b, "\251ART", "libextractor");
+  mp4_item (b, "\251too", "bench_corpus");
+  box_end (b, ilst);
+  box_end (b, meta);
+  box_end (b, udta);
+  box_end (b, moov);
+}
+
+
+int
+BENCH_corpus_mp4 (const char *filename,
+		  uint64_t size)
+{
+  struct CorpusOutput out;
+  struct CorpusBuffer b;
+  uint64_t samples;
+  uint64_t mdat;
+  size_t box;
+
+  samples = (size + MP4_SAMPLE_SIZE - 1) / MP4_SAMPLE_SIZE;
+  samples = (samples + MP4_SAMPLES_PER_CHUNK - 1)
+    / MP4_SAMPLES_PER_CHUNK * MP4_SAMPLES_PER_CHUNK;
+  if (0 == samples)
+    samples = MP4_SAMPLES_PER_CHUNK;
+  mdat = samples * MP4_SAMPLE_SIZE;
+  if (0 != out_open (&out, filename, CORPUS_PLAIN))
+    return 1;
+  memset (&b, 0, sizeof (b));
+  box = box_begin (&b, "ftyp");
+  buf_append (&b, "isom", 4);
+  buf_be32 (&b, 0x200);
+  buf_append (&b, "isomiso2avc1mp41", 16);
+  box_end (&b, box);
+  if (mdat + 8 > 0xFFFFFFFFLLU)
+    {
+      buf_be32 (&b, 1);         /* 64-bit size follows */
+      buf_append (&b, "mdat", 4);
+      buf_be64 (&b, mdat + 16);
+    }
+  else
+    {
+      buf_be32 (&b, (uint32_t) (mdat + 8));
+      buf_append (&b, "mdat", 4);
+    }
+  buf_flush (&b, &out);
+  out_fill (&out, mdat);
+  mp4_moov (&b, samples, out.pos - mdat);
+  buf_flush (&b, &out);
+  free (b.data);
+  return out_close (&out, filename);
+}
+
+
+/**
+ * Formats we can generate.  The 'base' sizes keep a
+ * scaling run (base, 8x, 64x) within a few minutes.
+ */
+const struct BENCH_CorpusFormat BENCH_corpus_formats[] = {
+  { "zip", "zip", ".zip", "entries", 1000, &BENCH_corpus_zip },
+#if HAVE_ZLIB
+  { "tar.gz", "archive", ".tar.gz", "bytes", 1024 * 1024, &BENCH_corpus_tar_gz },
+#endif
+#if HAVE_LIBBZ2
+  { "tar.bz2", "archive", ".tar.bz2", "bytes", 256 * 1024, &BENCH_corpus_tar_bz2 },
+#endif
+  { "avi", "riff", ".avi", "bytes", 1024 * 1024, &BENCH_corpus_avi },
+  { "png", "png", ".png", "chunks", 100, &BENCH_corpus_png },
+  { "ole2", "ole2", ".doc", "bytes", 1024 * 1024, &BENCH_corpus_ole2 },
+  { "mp4", "mp4", ".mp4", "bytes", 1024 * 1024, &BENCH_corpus_mp4 },
+  { NULL, NULL, NULL, NULL, 0, NULL }
+};
+
+
+const struct BENCH_CorpusFormat *
+BENCH_corpus_find (const char *name)
+{
+  unsigned int i;
+
+  for (i = 0; NULL != BENCH_corpus_formats[i].name; i++)
+    if (0 == strcmp (name, BENCH_corpus_formats[i].name))
+      return &BENCH_corpus_formats[i];
+  return NULL;
+}
+
+/* end of bench_corpus.c */
@@ -0,0 +1,192 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_corpus.h
+ * @brief generators for large synthetic files (zip, tar.gz, tar.bz2,
+ *        AVI, PNG, OLE2, MP4) to measure how plugins scale with the
+ *        size of their input.  The files are written sequentially, so
+ *        they can be much larger than the available memory; they are
+ *        valid enough for the plugins, not for playback.
+ */
+#ifndef BENCH_CORPUS_H
+#define BENCH_CORPUS_H
+
+#include "platform.h"
+
+
+/**
+ * Signature of a corpus file generator.
+ *
+ * @param filename name of the file to create
+ * @param param size parameter (unit depends on the format)
+ * @return 0 on success, 1 on failure
+ */
+typedef int
+(*BENCH_CorpusGenerator) (const char *filename,
+			  uint64_t param);
+
+
+/**
+ * Description of a format we can generate.
+ */
+struct BENCH_CorpusFormat
+{
+  /**
+   * Name of the format (i.e. "zip").
+   */
+  const char *name;
+
+  /**
+   * Name of the plugin that handles the format.
+   */
+  const char *plugin;
+
+  /**
+   * Filename extension to use (i.e. ".tar.gz").
+   */
+  const char *suffix;
+
+  /**
+   * What the size parameter counts (i.e. "entries").
+   */
+  const char *unit;
+
+  /**
+   * Size parameter for the smallest file of a scaling run.
+   */
+  uint64_t base;
+
+  /**
+   * Function to generate a file.
+   */
+  BENCH_CorpusGenerator generate;
+};
+
+
+/**
+ * Formats we can generate, terminated by an entry with a NULL name.
+ */
+extern const struct BENCH_CorpusFormat BENCH_corpus_formats[];
+
+
+/**
+ * Find a format by name.
+ *
+ * @param name name of the format
+ * @return NULL if the format is unknown (or not supported
+ *         by this build, i.e. "tar.bz2" without libbz2)
+ */
+const struct BENCH_CorpusFormat *
+BENCH_corpus_find (const char *name);
+
+
+/**
+ * Write a zip archive with the given number of small (stored)
+ * entries.  Uses zip64 end of central directory records for more
+ * than 65534 entries, as Info-ZIP does.
+ *
+ * @param filename name of the file to create
+ * @param entries number of entries
+ * @return 0 on success, 1 on failure
+ */
+int
+BENCH_corpus_zip (const char *filename,
+		  uint64_t entries);
+
+
+/**
+ * Write a gzip-compressed tar archive of 1 MiB files.
+ *
+ * @param filename name of the file to create
+ * @param size total (uncompressed) size of the files
+ * @return 0 on success, 1 on failure
+ */
+int
+BENCH_corpus_tar_gz (const char *filename,
+		     uint64_t size);
+
+
+/**
+ * Write a bzip2-compressed tar archive of 1 MiB files.
+ *
+ * @param filename name of the file to create
+ * @param size total (uncompressed) size of the files
+ * @return 0 on success, 1 on failure
+ */
+int
+BENCH_corpus_tar_bz2 (const char *filename,
+		      uint64_t size);
+
+
+/**
+ * Write an AVI file with one video stream, 64 KiB frames and
+ * an 'idx1' index.  Only a single RIFF chunk is written, so
+ * @a size must be below 4 GiB.
+ *
+ * @param filename name of the file to create
+ * @param size size of the frame data in the 'movi' list
+ * @return 0 on success, 1 on failure
+ */
+int
+BENCH_corpus_avi (const char *filename,
+		  uint64_t size);
+
+
+/**
+ * Write a 1x1 PNG image with the given number of tEXt chunks.
+ *
+ * @param filename name of the file to create
+ * @param chunks number of text chunks
+ * @return 0 on success, 1 on failure
+ */
+int
+BENCH_corpus_png (const char *filename,
+		  uint64_t chunks);
+
+
+/**
+ * Write an OLE2 compound document (version 3, 512 byte sectors)
+ * with a SummaryInformation stream and one large 'WordDocument'
+ * stream (which needs DIFAT sectors beyond 7 MiB).
+ *
+ * @param filename name of the file to create
+ * @param size size of the large stream, below 4 GiB
+ * @return 0 on success, 1 on failure
+ */
+int
+BENCH_corpus_ole2 (const char *filename,
+		   uint64_t size);
+
+
+/**
+ * Write an MP4 file with one video track of 4 KiB samples; the
+ * 'moov' atom (with full sample tables and iTunes-style meta data)
+ * follows the 'mdat' atom, as written by most cameras.
+ *
+ * @param filename name of the file to create
+ * @param size size of the sample data in the 'mdat' atom
+ * @return 0 on success, 1 on failure
+ */
+int
+BENCH_corpus_mp4 (const char *filename,
+		  uint64_t size);
+
+
+#endif
@@ -0,0 +1,304 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_datasource.c
+ * @brief benchmark for the datasource: sequential reads, forward seeks
+ *        and random seeks on plain files (bfds) and on gzip and bz2
+ *        compressed files (cfs)
+ */
+#include "platform.h"
+#include "extractor.h"
+#include "extractor_datasource.h"
+#include "bench_lib.h"
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+#if HAVE_LIBBZ2
+#include <bzlib.h>
+#endif
+
+/**
+ * Size of the (uncompressed) synthetic file.
+ */
+#define FILE_SIZE (8 * 1024 * 1024)
+
+/**
+ * Distance between two forward seeks.
+ */
+#define SEEK_STRIDE (64 * 1024)
+
+
+/**
+ * Function that libextractor calls for meta data found while
+ * opening the data source.  Ignores everything.
+ *
+ * @return 0 (always)
+ */
+static int
+ignore_replies (void *cls,
+		const char *plugin_name,
+		enum EXTRACTOR_MetaType type,
+		enum EXTRACTOR_MetaFormat format,
+		const char *data_mime_type,
+		const char *data,
+		size_t data_len)
+{
+  return 0;
+}
+
+
+/**
+ * Write a buffer to a file.
+ *
+ * @param filename name of the file to create
+ * @param buf data to write
+ * @param size number of bytes in @a buf
+ * @return 0 on success
+ */
+static int
+write_file (const char *filename,
+	    const void *buf,
+	    size_t size)
+{
+  FILE *f;
+
+  if (NULL == (f = fopen (filename, "wb")))
+    return 1;
+  if (size != fwrite (buf, 1, size, f))
+    {
+      fclose (f);
+      return 1;
+    }
+  if (0 != fclose (f))
+    return 1;
+  return 0;
+}
+
+
+#if HAVE_ZLIB
+/**
+ * Write a buffer to a gzip-compressed file.
+ *
+ * @param filename name of the file to create
+ * @param buf data to write
+ * @param size number of bytes in @a buf
+ * @return 0 on success
+ */
+static int
+write_gzip (const char *filename,
+	    const void *buf,
+	    size_t size)
+{
+  gzFile gz;
+
+  if (NULL == (gz = gzopen (filename, "wb6")))
+    return 1;
+  if ((int) size != gzwrite (gz, buf, size))
+    {
+      gzclose (gz);
+      return 1;
+    }
+  if (Z_OK != gzclose (gz))
+    return 1;
+  return 0;
+}
+#endif
+
+
+#if HAVE_LIBBZ2
+/**
+ * Write a buffer to a bz2-compressed file.
+ *
+ * @param filename name of the file to create
+ * @param buf data to write
+ * @param size number of bytes in @a buf
+ * @return 0 on success
+ */
+static int
+write_bzip2 (const char *filename,
+	     const void *buf,
+	     size_t size)
+{
+  unsigned int csize;
+  char *cbuf;
+  int ret;
+
+  csize = size + size / 100 + 600;
+  if (NULL == (cbuf = malloc (csize)))
+    return 1;
+  if (BZ_OK != BZ2_bzBuffToBuffCompress (cbuf, &csize,
+					 (char *) buf, size,
+					 9, 0, 0))
+    {
+      free (cbuf);
+      return 1;
+    }
+  ret = write_file (filename, cbuf, csize);
+  free (cbuf);
+  return ret;
+}
+#endif
+
+
+/**
+ * Run the benchmarks on one file.
+ *
+ * @param kind name of the file type ("plain", "gzip", "bz2")
+ * @param filename file to open
+ * @param random_seeks number of random seeks to perform
+ * @return 0 on success
+ */
+static int
+bench_file (const char *kind,
+	    const char *filename,
+	    unsigned int random_seeks)
+{
+  struct EXTRACTOR_Datasource *ds;
+  char buf[32 * 1024];
+  char name[64];
+  uint64_t total;
+  uint64_t ops;
+  uint64_t off;
+  uint32_t state;
+  unsigned int i;
+  ssize_t ret;
+  uint64_t t;
+
+  if (NULL == (ds = EXTRACTOR_datasource_create_from_file_ (filename,
+							    &ignore_replies,
+							    NULL)))
+    {
+      fprintf (stderr, "Failed to open `%s'\n", filename);
+      return 1;
+    }
+
+  /* sequential read of the whole file; opening the source
+     sniffed the compression header, so rewind first */
+  total = 0;
+  ops = 0;
+  t = BENCH_now ();
+  if (0 != EXTRACTOR_datasource_seek_ (ds, 0, SEEK_SET))
+    {
+      EXTRACTOR_datasource_destroy_ (ds);
+      return 1;
+    }
+  while (0 < (ret = EXTRACTOR_datasource_read_ (ds, buf, sizeof (buf))))
+    {
+      total += ret;
+      ops++;
+    }
+  t = BENCH_now () - t;
+  if (FILE_SIZE != total)
+    {
+      fprintf (stderr,
+	       "Read %llu bytes from `%s', expected %u\n",
+	       (unsigned long long) total,
+	       filename,
+	       FILE_SIZE);
+      EXTRACTOR_datasource_destroy_ (ds);
+      return 1;
+    }
+  snprintf (name, sizeof (name), "%s_sequential_read", kind);
+  BENCH_report (name, "chunk_size", sizeof (buf), ops, total, t);
+
+  /* forward seeks, as done by most container parsers */
+  ops = 0;
+  t = BENCH_now ();
+  for (off = 0; off < FILE_SIZE; off += SEEK_STRIDE)
+    {
+      if ( ((int64_t) off != EXTRACTOR_datasource_seek_ (ds, off, SEEK_SET)) ||
+	   (1 != EXTRACTOR_datasource_read_ (ds, buf, 1)) )
+	{
+	  EXTRACTOR_datasource_destroy_ (ds);
+	  return 1;
+	}
+      ops++;
+    }
+  t = BENCH_now () - t;
+  snprintf (name, sizeof (name), "%s_forward_seek", kind);
+  BENCH_report (name, "stride", SEEK_STRIDE, ops, 0, t);
+
+  /* random seeks, including backwards seeks */
+  state = 42;
+  t = BENCH_now ();
+  for (i = 0; i < random_seeks; i++)
+    {
+      off = BENCH_random (&state) % FILE_SIZE;
+      if ( ((int64_t) off != EXTRACTOR_datasource_seek_ (ds, off, SEEK_SET)) ||
+	   (1 != EXTRACTOR_datasource_read_ (ds, buf, 1)) )
+	{
+	  EXTRACTOR_datasource_destroy_ (ds);
+	  return 1;
+	}
+    }
+  t = BENCH_now () - t;
+  snprintf (name, sizeof (name), "%s_random_seek", kind);
+  BENCH_report (name, "file_size", FILE_SIZE, random_seeks, 0, t);
+  EXTRACTOR_datasource_destroy_ (ds);
+  return 0;
+}
+
+
+/**
+ * Main function for the datasource benchmark.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  unsigned char *buf;
+  char fn[64];
+  int ret;
+
+  if (NULL == (buf = malloc (FILE_SIZE)))
+    return 1;
+  BENCH_fill (buf, FILE_SIZE);
+  BENCH_start ("datasource");
+  snprintf (fn, sizeof (fn), "bench-%u.dat", (unsigned int) getpid ());
+  ret = write_file (fn, buf, FILE_SIZE);
+  if (0 == ret)
+    ret = bench_file ("plain", fn, 20000);
+  UNLINK (fn);
+#if HAVE_ZLIB
+  snprintf (fn, sizeof (fn), "bench-%u.dat.gz", (unsigned int) getpid ());
+  if (0 == ret)
+    ret = write_gzip (fn, buf, FILE_SIZE);
+  if (0 == ret)
+    ret = bench_file ("gzip", fn, 100);
+  UNLINK (fn);
+#endif
+#if HAVE_LIBBZ2
+  snprintf (fn, sizeof (fn), "bench-%u.dat.bz2", (unsigned int) getpid ());
+  if (0 == ret)
+    ret = write_bzip2 (fn, buf, FILE_SIZE);
+  if (0 == ret)
+    ret = bench_file ("bz2", fn, 20);
+  UNLINK (fn);
+#endif
+  free (buf);
+  if (0 != BENCH_finish ())
+    ret = 1;
+  return ret;
+}
+
+/* end of bench_datasource.c */
@@ -0,0 +1,310 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_extract.c
+ * @brief end-to-end benchmark measuring files per second through
+ *        #EXTRACTOR_extract(), in-process and out-of-process.
+ *
+ * Usage: bench_extract [PLUGINS [FILE...]]
+ *
+ * Without arguments, synthetic workloads are generated and processed
+ * with the "bench" plugin (in "head" mode).  PLUGINS is a plugin
+ * configuration as accepted by #EXTRACTOR_plugin_add_config(); if
+ * FILEs are given, they are used as the workload instead (set
+ * LIBEXTRACTOR_PREFIX to find the plugins to benchmark).
+ */
+#include "platform.h"
+#include "extractor.h"
+#include "bench_lib.h"
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+
+/**
+ * A synthetic workload.
+ */
+struct Workload
+{
+  /**
+   * Name of the workload.
+   */
+  const char *name;
+
+  /**
+   * Number of files to generate.
+   */
+  unsigned int count;
+
+  /**
+   * Size of each file.
+   */
+  size_t size;
+
+  /**
+   * Generate gzip-compressed files?
+   */
+  int compress;
+};
+
+
+/**
+ * Function that libextractor calls for each meta data item found.
+ * Counts the items.
+ *
+ * @param cls pointer to an `unsigned long long` counter
+ * @return 0 (always)
+ */
+static int
+count_replies (void *cls,
+	       const char *plugin_name,
+	       enum EXTRACTOR_MetaType type,
+	       enum EXTRACTOR_MetaFormat format,
+	       const char *data_mime_type,
+	       const char *data,
+	       size_t data_len)
+{
+  unsigned long long *count = cls;
+
+  (*count)++;
+  return 0;
+}
+
+
+/**
+ * Run the plugins over the given files and report the throughput.
+ *
+ * @param workload name of the workload
+ * @param config plugin configuration
+ * @param opt execution policy
+ * @param files NULL-terminated array of file names
+ * @param bytes total size of the @a files
+ * @return 0 on success
+ */
+static int
+bench_files (const char *workload,
+	     const char *config,
+	     enum EXTRACTOR_Options opt,
+	     char *const *files,
+	     uint64_t bytes)
+{
+  struct EXTRACTOR_PluginList *pl;
+  unsigned long long items;
+  unsigned int i;
+  char name[128];
+  uint64_t t;
+
+  pl = EXTRACTOR_plugin_add_config (NULL,
+				    config,
+				    opt);
+  if (NULL == pl)
+    {
+      fprintf (stderr,
+	       "Failed to load plugins `%s'\n",
+	       config);
+      return 1;
+    }
+  items = 0;
+  t = BENCH_now ();
+  for (i = 0; NULL != files[i]; i++)
+    EXTRACTOR_extract (pl,
+		       files[i],
+		       NULL, 0,
+		       &count_replies,
+		       &items);
+  t = BENCH_now () - t;
+  EXTRACTOR_plugin_remove_all (pl);
+  snprintf (name,
+	    sizeof (name),
+	    "%s_%s",
+	    workload,
+	    (EXTRACTOR_OPTION_IN_PROCESS == opt) ? "inproc" : "oop");
+  BENCH_report (name, "meta_items", items, i, bytes, t);
+  return 0;
+}
+
+
+/**
+ * Write a file of the given workload.
+ *
+ * @param w workload description
+ * @param filename name of the file to create
+ * @param buf data to write (at least w->size bytes)
+ * @return 0 on success
+ */
+static int
+write_workload_file (const struct Workload *w,
+		     const char *filename,
+		     const unsigned char *buf)
+{
+  FILE *f;
+
+#if HAVE_ZLIB
+  if (w->compress)
+    {
+      gzFile gz;
+
+      if (NULL == (gz = gzopen (filename, "wb6")))
+	return 1;
+      if ((int) w->size != gzwrite (gz, buf, w->size))
+	{
+	  gzclose (gz);
+	  return 1;
+	}
+      return (Z_OK == gzclose (gz)) ? 0 : 1;
+    }
+#endif
+  if (NULL == (f = fopen (filename, "wb")))
+    return 1;
+  if (w->size != fwrite (buf, 1, w->size, f))
+    {
+      fclose (f);
+      return 1;
+    }
+  return (0 == fclose (f)) ? 0 : 1;
+}
+
+
+/**
+ * Generate the files of a synthetic workload and benchmark them.
+ *
+ * @param w workload description
+ * @param config plugin configuration
+ * @param buf data to use for the files (at least w->size bytes)
+ * @return 0 on success
+ */
+static int
+bench_workload (const struct Workload *w,
+		const char *config,
+		const unsigned char *buf)
+{
+  char *files[w->count + 1];
+  char fn[64];
+  unsigned int i;
+  int ret;
+
+  ret = 0;
+  memset (files, 0, sizeof (files));
+  for (i = 0; i < w->count; i++)
+    {
+      snprintf (fn,
+		sizeof (fn),
+		"bench-%u-%s-%u.dat",
+		(unsigned int) getpid (),
+		w->name,
+		i);
+      if ( (NULL == (files[i] = strdup (fn))) ||
+	   (0 != write_workload_file (w, fn, buf)) )
+	{
+	  ret = 1;
+	  break;
+	}
+    }
+  if (0 == ret)
+    ret = bench_files (w->name,
+		       config,
+		       EXTRACTOR_OPTION_DEFAULT_POLICY,
+		       files,
+		       (uint64_t) w->count * w->size);
+  if (0 == ret)
+    ret = bench_files (w->name,
+		       config,
+		       EXTRACTOR_OPTION_IN_PROCESS,
+		       files,
+		       (uint64_t) w->count * w->size);
+  for (i = 0; NULL != files[i]; i++)
+    {
+      UNLINK (files[i]);
+      free (files[i]);
+    }
+  return ret;
+}
+
+
+/**
+ * Main function for the end-to-end benchmark.
+ *
+ * @param argc number of arguments
+ * @param argv optional plugin configuration and files
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  static const struct Workload workloads[] = {
+    { "small", 2000, 4 * 1024, 0 },
+    { "medium", 200, 256 * 1024, 0 },
+    { "large", 8, 16 * 1024 * 1024, 0 },
+#if HAVE_ZLIB
+    { "gzip", 100, 256 * 1024, 1 },
+#endif
+    { NULL, 0, 0, 0 }
+  };
+  const char *config;
+  unsigned char *buf;
+  struct stat sb;
+  uint64_t bytes;
+  unsigned int i;
+  int ret;
+
+  /* unless told otherwise, find the 'extractor_bench' plugin which
+     is not installed but should be in the current directory (or .libs)
+     on 'make bench' */
+  if ( (NULL == getenv ("LIBEXTRACTOR_PREFIX")) &&
+       (0 != putenv ("LIBEXTRACTOR_PREFIX=." PATH_SEPARATOR_STR ".libs/")) )
+    fprintf (stderr,
+	     "Failed to update my environment, plugin loading may fail: %s\n",
+	     strerror (errno));
+  config = (argc > 1) ? argv[1] : "bench(head)";
+  BENCH_start ("extract");
+  if (argc > 2)
+    {
+      bytes = 0;
+      for (i = 2; i < (unsigned int) argc; i++)
+	if (0 == STAT (argv[i], &sb))
+	  bytes += sb.st_size;
+      ret = bench_files ("files",
+			 config,
+			 EXTRACTOR_OPTION_DEFAULT_POLICY,
+			 &argv[2],
+			 bytes);
+      if (0 == ret)
+	ret = bench_files ("files",
+			   config,
+			   EXTRACTOR_OPTION_IN_PROCESS,
+			   &argv[2],
+			   bytes);
+    }
+  else
+    {
+      if (NULL == (buf = malloc (16 * 1024 * 1024)))
+	return 1;
+      BENCH_fill (buf, 16 * 1024 * 1024);
+      ret = 0;
+      for (i = 0; (0 == ret) && (NULL != workloads[i].name); i++)
+	ret = bench_workload (&workloads[i], config, buf);
+      free (buf);
+    }
+  if (0 != BENCH_finish ())
+    ret = 1;
+  return ret;
+}
+
+/* end of bench_extract.c */
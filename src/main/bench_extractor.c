@@ -0,0 +1,170 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_extractor.c
+ * @brief plugin for benchmarking GNU libextractor; its behaviour
+ *        is selected by the plugin configuration string:
+ *        - "meta:N" sends N small meta data items without reading,
+ *        - "scan" reads the whole file sequentially,
+ *        - "seek:N" reads one byte at N pseudo-random offsets,
+ *        - "head" reads the first 4 KiB and reports one item
+ *          (a cheap 'typical' plugin for end-to-end runs).
+ */
+#include "platform.h"
+#include "extractor.h"
+
+
+/**
+ * Send @a count meta data items to the application.
+ *
+ * @param ec extraction context
+ * @param count number of items to send
+ */
+static void
+bench_meta (struct EXTRACTOR_ExtractContext *ec,
+	    unsigned long count)
+{
+  unsigned long i;
+
+  for (i = 0; i < count; i++)
+    if (0 != ec->proc (ec->cls,
+		       "bench",
+		       EXTRACTOR_METATYPE_COMMENT,
+		       EXTRACTOR_METAFORMAT_UTF8,
+		       "text/plain",
+		       "bench",
+		       strlen ("bench") + 1))
+      return;
+}
+
+
+/**
+ * Read the entire file sequentially.
+ *
+ * @param ec extraction context
+ */
+static void
+bench_scan (struct EXTRACTOR_ExtractContext *ec)
+{
+  void *data;
+  ssize_t ret;
+  uint64_t total;
+  char sum[32];
+
+  total = 0;
+  while (0 < (ret = ec->read (ec->cls, &data, 64 * 1024)))
+    total += ret;
+  snprintf (sum,
+	    sizeof (sum),
+	    "%llu",
+	    (unsigned long long) total);
+  ec->proc (ec->cls,
+	    "bench",
+	    EXTRACTOR_METATYPE_EMBEDDED_FILE_SIZE,
+	    EXTRACTOR_METAFORMAT_UTF8,
+	    "text/plain",
+	    sum,
+	    strlen (sum) + 1);
+}
+
+
+/**
+ * Read one byte at @a count pseudo-random offsets.
+ *
+ * @param ec extraction context
+ * @param count number of seeks to perform
+ */
+static void
+bench_seek (struct EXTRACTOR_ExtractContext *ec,
+	    unsigned long count)
+{
+  uint64_t fsize;
+  uint32_t state;
+  uint64_t off;
+  unsigned long i;
+  void *data;
+
+  fsize = ec->get_size (ec->cls);
+  if ( (0 == fsize) ||
+       (UINT64_MAX == fsize) )
+    return;
+  state = 42;
+  for (i = 0; i < count; i++)
+    {
+      state = state * 1103515245 + 12345;
+      off = (uint64_t) (state >> 1) << 31;
+      state = state * 1103515245 + 12345;
+      off |= state >> 1;
+      if (-1 == ec->seek (ec->cls,
+			  (int64_t) (off % fsize),
+			  SEEK_SET))
+	return;
+      if (1 != ec->read (ec->cls, &data, 1))
+	return;
+    }
+}
+
+
+/**
+ * Read the first few KiB, as most real plugins do to
+ * check the file type, and report a single value.
+ *
+ * @param ec extraction context
+ */
+static void
+bench_head (struct EXTRACTOR_ExtractContext *ec)
+{
+  void *data;
+
+  if (0 >= ec->read (ec->cls, &data, 4 * 1024))
+    return;
+  ec->proc (ec->cls,
+	    "bench",
+	    EXTRACTOR_METATYPE_MIMETYPE,
+	    EXTRACTOR_METAFORMAT_UTF8,
+	    "text/plain",
+	    "application/octet-stream",
+	    strlen ("application/octet-stream") + 1);
+}
+
+
+/**
+ * Main entry method for the 'bench' extraction plugin.
+ *
+ * @param ec extraction context provided to the plugin
+ */
+void
+EXTRACTOR_bench_extract_method (struct EXTRACTOR_ExtractContext *ec)
+{
+  const char *config = ec->config;
+
+  if (NULL == config)
+    return; /* only run in benchmark mode */
+  if (0 == strncmp (config, "meta:", strlen ("meta:")))
+    bench_meta (ec, strtoul (&config[strlen ("meta:")], NULL, 10));
+  else if (0 == strcmp (config, "scan"))
+    bench_scan (ec);
+  else if (0 == strncmp (config, "seek:", strlen ("seek:")))
+    bench_seek (ec, strtoul (&config[strlen ("seek:")], NULL, 10));
+  else if (0 == strcmp (config, "head"))
+    bench_head (ec);
+}
+
+/* end of bench_extractor.c */
@@ -0,0 +1,103 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_gen.c
+ * @brief tool to generate large synthetic files for benchmarking,
+ *        i.e. 'bench_gen zip 100k many.zip' or
+ *        'bench_gen tar.gz 2G big.tar.gz'
+ */
+#include "platform.h"
+#include "bench_corpus.h"
+
+
+/**
+ * Parse a size parameter with an optional 'k', 'M' or 'G'
+ * suffix (powers of 1024).
+ *
+ * @param arg argument to parse
+ * @param ret set to the value
+ * @return 0 on success, 1 on syntax errors
+ */
+static int
+parse_size (const char *arg,
+	    uint64_t *ret)
+{
+  unsigned long long v;
+  char *end;
+
+  errno = 0;
+  v = strtoull (arg, &end, 10);
+  if ( (0 != errno) ||
+       (end == arg) )
+    return 1;
+  switch (*end)
+    {
+    case 'G':
+      v *= 1024;
+      /* fall through */
+    case 'M':
+      v *= 1024;
+      /* fall through */
+    case 'k':
+      v *= 1024;
+      end++;
+      break;
+    }
+  if ('\0' != *end)
+    return 1;
+  *ret = v;
+  return 0;
+}
+
+
+/**
+ * Main function of the corpus generator.
+ *
+ * @param argc number of arguments
+ * @param argv FORMAT SIZE FILENAME
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  const struct BENCH_CorpusFormat *fmt;
+  uint64_t size;
+  unsigned int i;
+
+  if ( (4 != argc) ||
+       (NULL == (fmt = BENCH_corpus_find (argv[1]))) ||
+       (0 != parse_size (argv[2], &size)) )
+    {
+      fprintf (stderr,
+	       "Usage: %s FORMAT SIZE FILENAME\n"
+	       "SIZE may use the suffixes k, M and G.  Formats:\n",
+	       argv[0]);
+      for (i = 0; NULL != BENCH_corpus_formats[i].name; i++)
+	fprintf (stderr,
+		 "  %-8s SIZE is the number of %s (plugin: %s)\n",
+		 BENCH_corpus_formats[i].name,
+		 BENCH_corpus_formats[i].unit,
+		 BENCH_corpus_formats[i].plugin);
+      return 1;
+    }
+  return fmt->generate (argv[3], size);
+}
+
+/* end of bench_gen.c */
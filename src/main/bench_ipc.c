@@ -0,0 +1,383 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_ipc.c
+ * @brief benchmark for the IPC layer: raw channel message throughput,
+ *        shared memory refill rate for various window sizes and
+ *        the cost of sequential and random access from a plugin
+ *        process, using the "bench" plugin
+ */
+#include "platform.h"
+#include "extractor.h"
+#include "extractor_datasource.h"
+#include "extractor_ipc.h"
+#include "extractor_plugins.h"
+#include "bench_lib.h"
+
+/**
+ * Size of the synthetic file we feed through the IPC.
+ */
+#define FILE_SIZE (64 * 1024 * 1024)
+
+/**
+ * Number of meta data messages to exchange over the raw channel.
+ */
+#define META_COUNT 100000
+
+/**
+ * Number of random seeks the plugin is to perform.
+ */
+#define SEEK_COUNT 5000
+
+
+/**
+ * Closure for #count_reply().
+ */
+struct ReplyCounter
+{
+  /**
+   * Number of meta data messages received.
+   */
+  uint64_t count;
+
+  /**
+   * Set to 1 on IPC errors.
+   */
+  int failed;
+};
+
+
+/**
+ * Handler for a message from the plugin; counts the message and
+ * tells the plugin to continue, just like the main library does.
+ *
+ * @param cls our `struct ReplyCounter`
+ * @param plugin plugin of the channel sending the message
+ * @param meta_type type of the meta data
+ * @param meta_format format of the meta data
+ * @param mime mime string send from the plugin
+ * @param value 'data' send from the plugin
+ * @param value_len number of bytes in @a value
+ */
+static void
+count_reply (void *cls,
+	     struct EXTRACTOR_PluginList *plugin,
+	     enum EXTRACTOR_MetaType meta_type,
+	     enum EXTRACTOR_MetaFormat meta_format,
+	     const char *mime,
+	     const void *value,
+	     size_t value_len)
+{
+  static unsigned char cont_msg = MESSAGE_CONTINUE_EXTRACTING;
+  struct ReplyCounter *rc = cls;
+
+  rc->count++;
+  if (sizeof (cont_msg) !=
+      EXTRACTOR_IPC_channel_send_ (plugin->channel,
+				   &cont_msg,
+				   sizeof (cont_msg)))
+    rc->failed = 1;
+}
+
+
+/**
+ * Measure raw EXTRACTOR_IPC_channel_send_/recv_ throughput: the
+ * plugin sends #META_COUNT meta data messages and we answer each
+ * of them with a 'continue' message.
+ *
+ * @param ds data source to start the plugin with
+ * @return 0 on success
+ */
+static int
+bench_channel (struct EXTRACTOR_Datasource *ds)
+{
+  struct EXTRACTOR_PluginList *pl;
+  struct EXTRACTOR_SharedMemory *shm;
+  struct EXTRACTOR_Channel *channels[1];
+  struct StartMessage start;
+  struct ReplyCounter rc;
+  char config[32];
+  ssize_t ready;
+  uint64_t t;
+
+  snprintf (config,
+	    sizeof (config),
+	    "meta:%u",
+	    META_COUNT);
+  pl = EXTRACTOR_plugin_add (NULL,
+			     "bench",
+			     config,
+			     EXTRACTOR_OPTION_DEFAULT_POLICY);
+  if (NULL == pl)
+    {
+      fprintf (stderr, "failed to load bench plugin\n");
+      return 1;
+    }
+  if (NULL == (shm = EXTRACTOR_IPC_shared_memory_create_ (DEFAULT_SHM_SIZE)))
+    {
+      EXTRACTOR_plugin_remove_all (pl);
+      return 1;
+    }
+  pl->shm = shm;
+  (void) EXTRACTOR_IPC_shared_memory_change_rc_ (shm, 1);
+  if (NULL == (pl->channel = EXTRACTOR_IPC_channel_create_ (pl,
+							    shm)))
+    {
+      EXTRACTOR_plugin_remove_all (pl);
+      return 1;
+    }
+  ready = EXTRACTOR_IPC_shared_memory_set_ (shm,
+					    ds,
+					    0,
+					    DEFAULT_SHM_SIZE);
+  memset (&start, 0, sizeof (start));
+  start.opcode = MESSAGE_EXTRACT_START;
+  start.shm_ready_bytes = (uint32_t) ready;
+  start.file_size = EXTRACTOR_datasource_get_size_ (ds, 0);
+  pl->round_finished = 0;
+  pl->seek_request = -1;
+  rc.count = 0;
+  rc.failed = 0;
+  t = BENCH_now ();
+  if (sizeof (start) !=
+      EXTRACTOR_IPC_channel_send_ (pl->channel,
+				   &start,
+				   sizeof (start)))
+    rc.failed = 1;
+  while ( (0 == rc.failed) &&
+	  (0 == pl->round_finished) &&
+	  (NULL != (channels[0] = pl->channel)) )
+    if (-1 == EXTRACTOR_IPC_channel_recv_ (channels,
+					   1,
+					   &count_reply,
+					   &rc,
+					   DEFAULT_RECV_TIMEOUT_MS))
+      rc.failed = 1;
+  t = BENCH_now () - t;
+  EXTRACTOR_plugin_remove_all (pl);
+  if ( (0 != rc.failed) ||
+       (META_COUNT != rc.count) )
+    {
+      fprintf (stderr,
+	       "IPC failed after %llu messages\n",
+	       (unsigned long long) rc.count);
+      return 1;
+    }
+  /* every meta data item is one message in each direction */
+  BENCH_report ("channel_meta_roundtrip",
+		NULL, 0,
+		rc.count,
+		0,
+		t);
+  return 0;
+}
+
+
+/**
+ * Measure how fast the shared memory window can be refilled from
+ * the data source, for various window sizes.
+ *
+ * @param ds data source to copy from
+ * @return 0 on success
+ */
+static int
+bench_shm_refill (struct EXTRACTOR_Datasource *ds)
+{
+  static const size_t sizes[] = {
+    4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024, 0
+  };
+  struct EXTRACTOR_SharedMemory *shm;
+  unsigned int i;
+  uint64_t off;
+  uint64_t refills;
+  ssize_t ready;
+  uint64_t t;
+
+  for (i = 0; 0 != sizes[i]; i++)
+    {
+      if (NULL == (shm = EXTRACTOR_IPC_shared_memory_create_ (sizes[i])))
+	return 1;
+      refills = 0;
+      off = 0;
+      t = BENCH_now ();
+      while (off < FILE_SIZE)
+	{
+	  ready = EXTRACTOR_IPC_shared_memory_set_ (shm,
+						    ds,
+						    off,
+						    sizes[i]);
+	  if (ready <= 0)
+	    break;
+	  off += ready;
+	  refills++;
+	}
+      t = BENCH_now () - t;
+      EXTRACTOR_IPC_shared_memory_destroy_ (shm);
+      if (FILE_SIZE != off)
+	return 1;
+      BENCH_report ("shm_refill",
+		    "shm_size", sizes[i],
+		    refills,
+		    off,
+		    t);
+    }
+  return 0;
+}
+
+
+/**
+ * Function that libextractor calls for each meta data item found.
+ * Ignores everything.
+ *
+ * @return 0 (always)
+ */
+static int
+ignore_replies (void *cls,
+		const char *plugin_name,
+		enum EXTRACTOR_MetaType type,
+		enum EXTRACTOR_MetaFormat format,
+		const char *data_mime_type,
+		const char *data,
+		size_t data_len)
+{
+  return 0;
+}
+
+
+/**
+ * Run the "bench" plugin on the given buffer with the given
+ * configuration and report the time the extraction took.
+ *
+ * @param name name for the report
+ * @param config plugin configuration
+ * @param opt execution policy
+ * @param buf data to process
+ * @param iterations number of operations the plugin performs
+ * @param bytes number of bytes the plugin reads
+ * @return 0 on success
+ */
+static int
+bench_plugin (const char *name,
+	      const char *config,
+	      enum EXTRACTOR_Options opt,
+	      const unsigned char *buf,
+	      uint64_t iterations,
+	      uint64_t bytes)
+{
+  struct EXTRACTOR_PluginList *pl;
+  uint64_t t;
+
+  pl = EXTRACTOR_plugin_add (NULL,
+			     "bench",
+			     config,
+			     opt);
+  if (NULL == pl)
+    {
+      fprintf (stderr, "failed to load bench plugin\n");
+      return 1;
+    }
+  /* run once to start the plugin process, then measure */
+  EXTRACTOR_extract (pl, NULL, buf, FILE_SIZE, &ignore_replies, NULL);
+  t = BENCH_now ();
+  EXTRACTOR_extract (pl, NULL, buf, FILE_SIZE, &ignore_replies, NULL);
+  t = BENCH_now () - t;
+  EXTRACTOR_plugin_remove_all (pl);
+  BENCH_report (name,
+		"shm_size", DEFAULT_SHM_SIZE,
+		iterations,
+		bytes,
+		t);
+  return 0;
+}
+
+
+/**
+ * Main function for the IPC benchmark.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct EXTRACTOR_Datasource *ds;
+  unsigned char *buf;
+  char config[32];
+  int ret;
+
+  /* change environment to find 'extractor_bench' plugin which is
+     not installed but should be in the current directory (or .libs)
+     on 'make bench' */
+  if (0 != putenv ("LIBEXTRACTOR_PREFIX=." PATH_SEPARATOR_STR ".libs/"))
+    fprintf (stderr,
+	     "Failed to update my environment, plugin loading may fail: %s\n",
+	     strerror (errno));
+  if (NULL == (buf = malloc (FILE_SIZE)))
+    return 1;
+  BENCH_fill (buf, FILE_SIZE);
+  if (NULL == (ds = EXTRACTOR_datasource_create_from_buffer_ ((const char *) buf,
+							      FILE_SIZE,
+							      &ignore_replies,
+							      NULL)))
+    {
+      free (buf);
+      return 1;
+    }
+  BENCH_start ("ipc");
+  ret = bench_channel (ds);
+  if (0 == ret)
+    ret = bench_shm_refill (ds);
+  EXTRACTOR_datasource_destroy_ (ds);
+  if (0 == ret)
+    ret = bench_plugin ("oop_sequential_scan", "scan",
+			EXTRACTOR_OPTION_DEFAULT_POLICY,
+			buf,
+			FILE_SIZE / DEFAULT_SHM_SIZE,
+			FILE_SIZE);
+  if (0 == ret)
+    ret = bench_plugin ("inproc_sequential_scan", "scan",
+			EXTRACTOR_OPTION_IN_PROCESS,
+			buf,
+			FILE_SIZE / DEFAULT_SHM_SIZE,
+			FILE_SIZE);
+  snprintf (config,
+	    sizeof (config),
+	    "seek:%u",
+	    SEEK_COUNT);
+  if (0 == ret)
+    ret = bench_plugin ("oop_random_seek", config,
+			EXTRACTOR_OPTION_DEFAULT_POLICY,
+			buf,
+			SEEK_COUNT,
+			0);
+  if (0 == ret)
+    ret = bench_plugin ("inproc_random_seek", config,
+			EXTRACTOR_OPTION_IN_PROCESS,
+			buf,
+			SEEK_COUNT,
+			0);
+  free (buf);
+  if (0 != BENCH_finish ())
+    ret = 1;
+  return ret;
+}
+
+/* end of bench_ipc.c */
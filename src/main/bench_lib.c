@@ -0,0 +1,236 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_lib.c
+ * @brief helper library for writing benchmarks
+ */
+#include "platform.h"
+#include "bench_lib.h"
+
+
+/**
+ * Number of results reported so far (to place the commas).
+ */
+static unsigned int num_results;
+
+
+/**
+ * Obtain a monotonic timestamp (falls back to the wall clock
+ * if no monotonic clock is available).
+ *
+ * @return current time in nanoseconds (arbitrary epoch)
+ */
+uint64_t
+BENCH_now ()
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  if (0 == clock_gettime (CLOCK_MONOTONIC, &ts))
+    return (uint64_t) ts.tv_sec * 1000000000LLU + (uint64_t) ts.tv_nsec;
+#endif
+  {
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+    return (uint64_t) tv.tv_sec * 1000000000LLU + (uint64_t) tv.tv_usec * 1000;
+  }
+}
+
+
+/**
+ * Start the JSON report for a benchmark suite.  Must be
+ * called once before #BENCH_report().
+ *
+ * @param suite name of the benchmark suite (i.e. "ipc")
+ */
+void
+BENCH_start (const char *suite)
+{
+  num_results = 0;
+  fprintf (stdout,
+	   "{\n  \"suite\": \"%s\",\n  \"version\": \"%s\",\n  \"results\": [",
+	   suite,
+	   PACKAGE_VERSION);
+}
+
+
+/**
+ * Add one measurement to the JSON report.  Also prints a
+ * human-readable line to stderr so that 'make bench' shows progress.
+ *
+ * @param name name of the measurement (i.e. "shm_refill")
+ * @param param name of the parameter that was varied, NULL for none
+ * @param param_value value of @a param (ignored if @a param is NULL)
+ * @param iterations number of operations performed
+ * @param bytes number of bytes processed, 0 if not applicable
+ * @param elapsed time the operations took, in nanoseconds
+ */
+void
+BENCH_report (const char *name,
+	      const char *param,
+	      uint64_t param_value,
+	      uint64_t iterations,
+	      uint64_t bytes,
+	      uint64_t elapsed)
+{
+  double secs;
+  double ops_per_sec;
+  double mib_per_sec;
+
+  if (0 == elapsed)
+    elapsed = 1;
+  secs = elapsed / 1000000000.0;
+  ops_per_sec = iterations / secs;
+  mib_per_sec = bytes / secs / (1024.0 * 1024.0);
+  fprintf (stdout,
+	   "%s\n    {\"name\": \"%s\"",
+	   (0 == num_results) ? "" : ",",
+	   name);
+  if (NULL != param)
+    fprintf (stdout,
+	     ", \"%s\": %llu",
+	     param,
+	     (unsigned long long) param_value);
+  fprintf (stdout,
+	   ", \"iterations\": %llu, \"bytes\": %llu, \"elapsed_ns\": %llu,"
+	   " \"ns_per_op\": %.1f, \"ops_per_sec\": %.1f, \"mib_per_sec\": %.2f}",
+	   (unsigned long long) iterations,
+	   (unsigned long long) bytes,
+	   (unsigned long long) elapsed,
+	   (0 == iterations) ? 0.0 : (double) elapsed / iterations,
+	   ops_per_sec,
+	   mib_per_sec);
+  fprintf (stderr,
+	   "%-32s %-14s %12.1f ops/s %10.2f MiB/s\n",
+	   name,
+	   (NULL == param) ? "" : param,
+	   ops_per_sec,
+	   mib_per_sec);
+  num_results++;
+}
+
+
+/**
+ * Add one measurement of an extraction to the JSON report,
+ * including the I/O the plugins caused.
+ *
+ * @param name name of the measurement (i.e. "zip_oop")
+ * @param param name of the parameter that was varied (i.e. "entries")
+ * @param param_value value of @a param
+ * @param file_size size of the file that was processed
+ * @param bytes_read number of bytes read from the file
+ * @param seeks number of (non-sequential) seeks in the file
+ * @param elapsed time the extraction took, in nanoseconds
+ */
+void
+BENCH_report_io (const char *name,
+		 const char *param,
+		 uint64_t param_value,
+		 uint64_t file_size,
+		 uint64_t bytes_read,
+		 uint64_t seeks,
+		 uint64_t elapsed)
+{
+  fprintf (stdout,
+	   "%s\n    {\"name\": \"%s\", \"%s\": %llu, \"file_size\": %llu,"
+	   " \"bytes_read\": %llu, \"seeks\": %llu, \"elapsed_ns\": %llu}",
+	   (0 == num_results) ? "" : ",",
+	   name,
+	   param,
+	   (unsigned long long) param_value,
+	   (unsigned long long) file_size,
+	   (unsigned long long) bytes_read,
+	   (unsigned long long) seeks,
+	   (unsigned long long) elapsed);
+  fprintf (stderr,
+	   "%-16s %-8s %12llu %14llu bytes read %8llu seeks %10.3f ms\n",
+	   name,
+	   param,
+	   (unsigned long long) param_value,
+	   (unsigned long long) bytes_read,
+	   (unsigned long long) seeks,
+	   elapsed / 1000000.0);
+  num_results++;
+}
+
+
+/**
+ * Finish the JSON report.
+ *
+ * @return 0 on success, 1 if writing the report failed
+ */
+int
+BENCH_finish ()
+{
+  fprintf (stdout, "\n  ]\n}\n");
+  if (0 != fflush (stdout))
+    return 1;
+  return 0;
+}
+
+
+/**
+ * Fill a buffer with reproducible, moderately compressible data
+ * (so that the gzip and bz2 decompressors have real work to do).
+ *
+ * @param buf buffer to fill
+ * @param size number of bytes in @a buf
+ */
+void
+BENCH_fill (unsigned char *buf,
+	    size_t size)
+{
+  static const char words[] =
+    "libextractor meta data plugin shared memory seek read title "
+    "author keywords mimetype thumbnail duration archive ";
+  uint32_t state;
+  uint32_t r;
+  size_t i;
+
+  state = 42;
+  r = 0;
+  for (i = 0; i < size; i++)
+    {
+      if (0 == (i % 64))
+	r = BENCH_random (&state);
+      if (0 == (r >> 29))
+	buf[i] = (unsigned char) BENCH_random (&state);
+      else
+	buf[i] = (unsigned char) words[(i + r) % (sizeof (words) - 1)];
+    }
+}
+
+
+/**
+ * Simple linear congruential generator; we do not want
+ * 'random()' to make the runs differ between platforms.
+ *
+ * @param state generator state to update
+ * @return next pseudo-random value (31 bits)
+ */
+uint32_t
+BENCH_random (uint32_t *state)
+{
+  *state = *state * 1103515245 + 12345;
+  return *state >> 1; /* low bits of an LCG are poor */
+}
+
+/* end of bench_lib.c */
@@ -0,0 +1,123 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_lib.h
+ * @brief helper library for writing benchmarks; results are
+ *        written to stdout as one JSON object per benchmark program
+ */
+#ifndef BENCH_LIB_H
+#define BENCH_LIB_H
+
+#include "platform.h"
+
+
+/**
+ * Obtain a monotonic timestamp (falls back to the wall clock
+ * if no monotonic clock is available).
+ *
+ * @return current time in nanoseconds (arbitrary epoch)
+ */
+uint64_t
+BENCH_now (void);
+
+
+/**
+ * Start the JSON report for a benchmark suite.  Must be
+ * called once before #BENCH_report().
+ *
+ * @param suite name of the benchmark suite (i.e. "ipc")
+ */
+void
+BENCH_start (const char *suite);
+
+
+/**
+ * Add one measurement to the JSON report.
+ *
+ * @param name name of the measurement (i.e. "shm_refill")
+ * @param param name of the parameter that was varied, NULL for none
+ * @param param_value value of @a param (ignored if @a param is NULL)
+ * @param iterations number of operations performed
+ * @param bytes number of bytes processed, 0 if not applicable
+ * @param elapsed time the operations took, in nanoseconds
+ */
+void
+BENCH_report (const char *name,
+	      const char *param,
+	      uint64_t param_value,
+	      uint64_t iterations,
+	      uint64_t bytes,
+	      uint64_t elapsed);
+
+
+/**
+ * Add one measurement of an extraction to the JSON report,
+ * including the I/O the plugins caused.
+ *
+ * @param name name of the measurement (i.e. "zip_oop")
+ * @param param name of the parameter that was varied (i.e. "entries")
+ * @param param_value value of @a param
+ * @param file_size size of the file that was processed
+ * @param bytes_read number of bytes read from the file
+ * @param seeks number of (non-sequential) seeks in the file
+ * @param elapsed time the extraction took, in nanoseconds
+ */
+void
+BENCH_report_io (const char *name,
+		 const char *param,
+		 uint64_t param_value,
+		 uint64_t file_size,
+		 uint64_t bytes_read,
+		 uint64_t seeks,
+		 uint64_t elapsed);
+
+
+/**
+ * Finish the JSON report.
+ *
+ * @return 0 on success, 1 if writing the report failed
+ */
+int
+BENCH_finish (void);
+
+
+/**
+ * Fill a buffer with reproducible, moderately compressible data
+ * (so that the gzip and bz2 decompressors have real work to do).
+ *
+ * @param buf buffer to fill
+ * @param size number of bytes in @a buf
+ */
+void
+BENCH_fill (unsigned char *buf,
+	    size_t size);
+
+
+/**
+ * Simple linear congruential generator; we do not want
+ * 'random()' to make the runs differ between platforms.
+ *
+ * @param state generator state to update
+ * @return next pseudo-random value (31 bits)
+ */
+uint32_t
+BENCH_random (uint32_t *state);
+
+#endif
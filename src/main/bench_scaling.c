@@ -0,0 +1,207 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file main/bench_scaling.c
+ * @brief benchmark measuring how latency, bytes read and seeks of
+ *        each plugin grow with the size of its input, using files
+ *        from the synthetic corpus generator.
+ *
+ * Usage: bench_scaling [FACTOR [FORMAT...]]
+ *
+ * Each format is generated at 1x, 8x and 64x its base size, times
+ * FACTOR (default 1).  Formats whose plugin is not available are
+ * skipped.  By default, the plugins are loaded from ../plugins/.libs/
+ * (set LIBEXTRACTOR_PREFIX to use installed plugins instead).
+ */
+#include "platform.h"
+#include "extractor.h"
+#include "extractor_datasource.h"
+#include "bench_corpus.h"
+#include "bench_lib.h"
+
+
+/**
+ * Function that libextractor calls for each meta data item found.
+ * Ignores everything.
+ *
+ * @return 0 (always)
+ */
+static int
+ignore_replies (void *cls,
+		const char *plugin_name,
+		enum EXTRACTOR_MetaType type,
+		enum EXTRACTOR_MetaFormat format,
+		const char *data_mime_type,
+		const char *data,
+		size_t data_len)
+{
+  return 0;
+}
+
+
+/**
+ * Run the plugin of the given format on a file and report
+ * latency, bytes read and seeks.
+ *
+ * @param fmt format of the file
+ * @param opt execution policy
+ * @param filename file to process
+ * @param param size parameter the file was generated with
+ * @return 0 on success, 1 if the plugin is not available
+ */
+static int
+bench_file (const struct BENCH_CorpusFormat *fmt,
+	    enum EXTRACTOR_Options opt,
+	    const char *filename,
+	    uint64_t param)
+{
+  struct EXTRACTOR_PluginList *pl;
+  struct EXTRACTOR_DatasourceStatistics before;
+  struct EXTRACTOR_DatasourceStatistics after;
+  struct stat sb;
+  char name[64];
+  uint64_t t;
+
+  if (NULL == (pl = EXTRACTOR_plugin_add (NULL,
+					  fmt->plugin,
+					  NULL,
+					  opt)))
+    return 1;
+  if (0 != STAT (filename, &sb))
+    sb.st_size = 0;
+  /* run once to start the plugin process (and to have the file
+     in the page cache), then measure */
+  EXTRACTOR_extract (pl, filename, NULL, 0, &ignore_replies, NULL);
+  EXTRACTOR_datasource_get_statistics_ (&before);
+  t = BENCH_now ();
+  EXTRACTOR_extract (pl, filename, NULL, 0, &ignore_replies, NULL);
+  t = BENCH_now () - t;
+  EXTRACTOR_datasource_get_statistics_ (&after);
+  EXTRACTOR_plugin_remove_all (pl);
+  snprintf (name,
+	    sizeof (name),
+	    "%s_%s",
+	    fmt->name,
+	    (EXTRACTOR_OPTION_IN_PROCESS == opt) ? "inproc" : "oop");
+  BENCH_report_io (name,
+		   fmt->unit,
+		   param,
+		   (uint64_t) sb.st_size,
+		   after.bytes_read - before.bytes_read,
+		   after.seeks - before.seeks,
+		   t);
+  return 0;
+}
+
+
+/**
+ * Generate files of the given format at increasing sizes
+ * and benchmark its plugin on them.
+ *
+ * @param fmt format to benchmark
+ * @param factor multiplier for the file sizes
+ * @return 0 on success (including if the plugin is missing)
+ */
+static int
+bench_format (const struct BENCH_CorpusFormat *fmt,
+	      uint64_t factor)
+{
+  static const unsigned int steps[] = { 1, 8, 64, 0 };
+  char fn[64];
+  uint64_t param;
+  unsigned int i;
+
+  snprintf (fn,
+	    sizeof (fn),
+	    "bench-%u%s",
+	    (unsigned int) getpid (),
+	    fmt->suffix);
+  for (i = 0; 0 != steps[i]; i++)
+    {
+      param = fmt->base * steps[i] * factor;
+      if (0 != fmt->generate (fn, param))
+	return 1;
+      if (0 != bench_file (fmt, EXTRACTOR_OPTION_DEFAULT_POLICY, fn, param))
+	{
+	  fprintf (stderr,
+		   "Plugin `%s' not available, skipping `%s'\n",
+		   fmt->plugin,
+		   fmt->name);
+	  UNLINK (fn);
+	  return 0;
+	}
+      bench_file (fmt, EXTRACTOR_OPTION_IN_PROCESS, fn, param);
+      UNLINK (fn);
+    }
+  return 0;
+}
+
+
+/**
+ * Main function for the scaling benchmark.
+ *
+ * @param argc number of arguments
+ * @param argv optional size factor and formats
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  const struct BENCH_CorpusFormat *fmt;
+  uint64_t factor;
+  unsigned int i;
+  int ret;
+
+  if ( (NULL == getenv ("LIBEXTRACTOR_PREFIX")) &&
+       (0 != putenv ("LIBEXTRACTOR_PREFIX=../plugins/.libs/")) )
+    fprintf (stderr,
+	     "Failed to update my environment, plugin loading may fail: %s\n",
+	     strerror (errno));
+  factor = (argc > 1) ? strtoull (argv[1], NULL, 10) : 1;
+  if (0 == factor)
+    factor = 1;
+  BENCH_start ("scaling");
+  ret = 0;
+  if (argc > 2)
+    {
+      for (i = 2; (0 == ret) && (i < (unsigned int) argc); i++)
+	{
+	  if (NULL == (fmt = BENCH_corpus_find (argv[i])))
+	    {
+	      fprintf (stderr,
+		       "Unknown format `%s'\n",
+		       argv[i]);
+	      ret = 1;
+	      break;
+	    }
+	  ret = bench_format (fmt, factor);
+	}
+    }
+  else
+    {
+      for (i = 0; (0 == ret) && (NULL != BENCH_corpus_formats[i].name); i++)
+	ret = bench_format (&BENCH_corpus_formats[i], factor);
+    }
+  if (0 != BENCH_finish ())
+    ret = 1;
+  return ret;
+}
+
+/* end of bench_scaling.c */
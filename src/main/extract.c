@@ -730,6 +730,34 @@ _get_utf8_args (int argc, char *const *argv, int *u8argc, char ***u8argv)
 }
 
 
+/**
+ * Tell the plugins which keyword types we are going to print,
+ * so that they can skip producing the others.
+ *
+ * @param plugins list of plugins to configure
+ */
+static void
+set_wanted_types (struct EXTRACTOR_PluginList *plugins)
+{
+  enum EXTRACTOR_MetaType *types;
+  unsigned int num_types;
+  unsigned int i;
+
+  if (NULL == (types = malloc (sizeof (enum EXTRACTOR_MetaType) *
+			       EXTRACTOR_metatype_get_max ())))
+    return;
+  num_types = 0;
+  for (i = 0; i < EXTRACTOR_metatype_get_max (); i++)
+    if (YES == print[i])
+      types[num_types++] = (enum EXTRACTOR_MetaType) i;
+  if (num_types < EXTRACTOR_metatype_get_max ())
+    EXTRACTOR_plugin_set_wanted_types (plugins,
+				       types,
+				       num_types);
+  free (types);
+}
+
+
 /**
  * Main function for the 'extract' tool.  Invoke with a list of
  * filenames to extract keywords from.
@@ -963,6 +991,7 @@ main (int argc, char *argv[])
 					   : EXTRACTOR_OPTION_DEFAULT_POLICY);
   if (NULL == processor)
     processor = &print_selected_keywords;
+  set_wanted_types (plugins);
 
   /* extract keywords */
   if (YES == bibtex)
@@ -30,12 +30,15 @@
 #include "extractor_logging.h"
 #include "extractor_plugpath.h"
 #include "extractor_plugins.h"
+#include "mime_signatures.h"
 
 
 /**
- * Size used for the shared memory segment.
+ * How long (in ms) plugins get to finish after we told them to stop
+ * (because of #EXTRACTOR_cancel() or because the timeout was reached)
+ * before we kill them.
  */
-#define DEFAULT_SHM_SIZE (16 * 1024)
+#define STOP_GRACE_MS 100
 
 
 /**
@@ -61,6 +64,51 @@ struct PluginReplyProcessor
 };
 
 
+/**
+ * Get the current time from a monotonic clock (if available).
+ *
+ * @return current time in milliseconds
+ */
+static uint64_t
+get_time_ms ()
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  if (0 == clock_gettime (CLOCK_MONOTONIC, &ts))
+    return (uint64_t) ts.tv_sec * 1000LLU + ts.tv_nsec / 1000000;
+#endif
+  {
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+    return (uint64_t) tv.tv_sec * 1000LLU + tv.tv_usec / 1000;
+  }
+}
+
+
+/**
+ * Check if the extraction must stop because it was cancelled
+ * or because it ran out of time.
+ *
+ * @param plugins list of plugins we are running
+ * @param deadline time (see #get_time_ms()) by which we must be done,
+ *        0 for none
+ * @return 1 if we must stop, 0 to continue
+ */
+static int
+must_stop (struct EXTRACTOR_PluginList *plugins,
+	   uint64_t deadline)
+{
+  if (0 != plugins->cancelled)
+    return 1;
+  if ( (0 != deadline) &&
+       (get_time_ms () >= deadline) )
+    return 1;
+  return 0;
+}
+
+
 /**
  * Send an 'update' message to the plugin.
  *
@@ -201,6 +249,11 @@ process_plugin_reply (void *cls,
  */
 struct InProcessContext
 {
+  /**
+   * All plugins (to check for cancellation).
+   */
+  struct EXTRACTOR_PluginList *plugins;
+
   /**
    * Current plugin.
    */
@@ -226,6 +279,11 @@ struct InProcessContext
    */
   char buf[DEFAULT_SHM_SIZE];
 
+  /**
+   * Time by which we must be done, 0 for no limit.
+   */
+  uint64_t deadline;
+
   /**
    * 0 to continue extracting, 1 if we are finished
    */
@@ -253,6 +311,12 @@ in_process_read (void *cls,
   ssize_t ret;
   size_t bsize;
 
+  if (0 != must_stop (ctx->plugins, ctx->deadline))
+    {
+      ctx->finished = 1;
+      *data = NULL;
+      return -1;
+    }
   bsize = sizeof (ctx->buf);
   if (size < bsize)
     bsize = size;
@@ -285,6 +349,11 @@ in_process_seek (void *cls,
 {
   struct InProcessContext *ctx = cls;
 
+  if (0 != must_stop (ctx->plugins, ctx->deadline))
+    {
+      ctx->finished = 1;
+      return -1;
+    }
   return EXTRACTOR_datasource_seek_ (ctx->ds,
 				     pos,
 				     whence);
@@ -307,6 +376,57 @@ in_process_get_size (void *cls)
 }
 
 
+/**
+ * Determine the MIME type hint for the plugins from the first bytes
+ * of the file using the built-in signatures.  Leaves the datasource
+ * at offset 0.
+ *
+ * @param ds data source to look at
+ * @param mime_hint where to store the MIME type; set to the empty
+ *        string if the type is not known
+ */
+static void
+sniff_mime_hint (struct EXTRACTOR_Datasource *ds,
+		 char mime_hint[MAX_MIME_HINT_SIZE])
+{
+  char buf[MIME_HINT_SNIFF_SIZE];
+  const char *mime;
+  ssize_t ret;
+
+  mime_hint[0] = '\0';
+  if (-1 == EXTRACTOR_datasource_seek_ (ds, 0, SEEK_SET))
+    return;
+  ret = EXTRACTOR_datasource_read_ (ds, buf, sizeof (buf));
+  if (-1 == EXTRACTOR_datasource_seek_ (ds, 0, SEEK_SET))
+    return;
+  if (ret <= 0)
+    return;
+  if ( (NULL == (mime = EXTRACTOR_common_get_mime_type (buf, ret))) ||
+       (strlen (mime) >= MAX_MIME_HINT_SIZE) )
+    return;
+  strcpy (mime_hint, mime);
+}
+
+
+/**
+ * Check if the application wants meta data of the given type.
+ * Callback used for in-process plugins.
+ *
+ * @param cls a `struct InProcessContext`
+ * @param type type of meta data
+ * @return 1 if meta data of this type is wanted, 0 if not
+ */
+static int
+in_process_wants (void *cls,
+		  enum EXTRACTOR_MetaType type)
+{
+  struct InProcessContext *ctx = cls;
+
+  return EXTRACTOR_plugin_wants_type_ (ctx->plugins->wanted_types,
+				       type);
+}
+
+
 /**
  * Type of a function that libextractor calls for each
  * meta data item found.
@@ -339,6 +459,11 @@ in_process_proc (void *cls,
 
   if (0 != ctx->finished)
     return 1;
+  if (0 != must_stop (ctx->plugins, ctx->deadline))
+    {
+      ctx->finished = 1;
+      return 1;
+    }
   ret = ctx->proc (ctx->proc_cls,
 		   plugin_name,
 		   type,
@@ -361,12 +486,15 @@ in_process_proc (void *cls,
  * @param ds data to process
  * @param proc function to call for each meta data item found
  * @param proc_cls cls argument to @a proc
+ * @param deadline time (see #get_time_ms()) by which we must be done,
+ *        0 for no limit
  */
 static void
 do_extract (struct EXTRACTOR_PluginList *plugins,
 	    struct EXTRACTOR_SharedMemory *shm,
 	    struct EXTRACTOR_Datasource *ds,
-	    EXTRACTOR_MetaDataProcessor proc, void *proc_cls)
+	    EXTRACTOR_MetaDataProcessor proc, void *proc_cls,
+	    uint64_t deadline)
 {
   unsigned int plugin_count;
   unsigned int plugin_off;
@@ -380,12 +508,17 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
   int64_t end;
   ssize_t data_available;
   ssize_t ready;
+  uint64_t now;
+  uint64_t grace_end;
+  uint32_t timeout;
   int done;
+  int stopping;
   int have_in_memory;
 
   plugin_count = 0;
   for (pos = plugins; NULL != pos; pos = pos->next)
     plugin_count++;
+  sniff_mime_hint (ds, start.mime_hint);
   if (NULL != shm)
     ready = EXTRACTOR_IPC_shared_memory_set_ (shm,
                                               ds,
@@ -406,6 +539,12 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
   start.reserved2 = 0;
   start.shm_ready_bytes = (uint32_t) ready;
   start.file_size = EXTRACTOR_datasource_get_size_ (ds, 0);
+  if (NULL == plugins->wanted_types)
+    memset (start.wanted_types, 0xFF, sizeof (start.wanted_types));
+  else
+    memcpy (start.wanted_types,
+	    plugins->wanted_types,
+	    sizeof (start.wanted_types));
   for (pos = plugins; NULL != pos; pos = pos->next)
     {
       if (EXTRACTOR_OPTION_IN_PROCESS == pos->flags)
@@ -427,10 +566,61 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
     }
   else
     done = 0;
+  stopping = 0;
+  grace_end = 0;
   while (! done)
     {
       struct EXTRACTOR_Channel *channels[plugin_count];
 
+      if ( (0 == stopping) &&
+	   ( (1 == prp.file_finished) ||
+	     (0 != must_stop (plugins, deadline)) ) )
+	{
+	  /* tell all plugins that are still running to stop, and
+	     give them a little time to do so */
+	  prp.file_finished = 1;
+	  stopping = 1;
+	  grace_end = get_time_ms () + STOP_GRACE_MS;
+	  for (pos = plugins; NULL != pos; pos = pos->next)
+	    {
+	      if ( (NULL == pos->channel) ||
+		   (1 == pos->round_finished) )
+		continue;
+	      pos->seek_request = -1;
+	      send_discard_message (pos);
+	    }
+	}
+      timeout = DEFAULT_RECV_TIMEOUT_MS;
+      if (1 == stopping)
+	{
+	  now = get_time_ms ();
+	  if (now >= grace_end)
+	    {
+	      for (pos = plugins; NULL != pos; pos = pos->next)
+		{
+		  if ( (NULL == pos->channel) ||
+		       (1 == pos->round_finished) )
+		    continue;
+		  LOG ("Plugin `%s' did not stop in time, killing it\n",
+		       pos->short_libname);
+		  EXTRACTOR_IPC_channel_destroy_ (pos->channel);
+		  pos->channel = NULL;
+		  pos->round_finished = 1;
+		}
+	      break;
+	    }
+	  if (grace_end - now < timeout)
+	    timeout = (uint32_t) (grace_end - now);
+	}
+      else if (0 != deadline)
+	{
+	  /* a plugin that stays silent past the deadline (plus the
+	     grace period) is killed by the receive timeout */
+	  now = get_time_ms ();
+	  if (deadline + STOP_GRACE_MS - now < timeout)
+	    timeout = (uint32_t) (deadline + STOP_GRACE_MS - now);
+	}
+
       /* calculate current 'channels' array */
       plugin_off = 0;
       for (pos = plugins; NULL != pos; pos = pos->next)
@@ -452,13 +642,30 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
 	  EXTRACTOR_IPC_channel_recv_ (channels,
 				       plugin_count,
 				       &process_plugin_reply,
-				       &prp))
+				       &prp,
+				       timeout))
 	{
 	  /* serious problem in IPC; reset *all* channels */
 	  LOG ("Failed to receive message from channels; full reset\n");
 	  abort_all_channels (plugins);
 	  break;
 	}
+      if (1 == prp.file_finished)
+	{
+	  /* no more seeking; wait for the plugins to confirm that they
+	     are done (they were all sent a 'discard' message, which
+	     also answers any seek request they may have made since) */
+	  done = stopping;
+	  for (pos = plugins; NULL != pos; pos = pos->next)
+	    {
+	      if ( (NULL == pos->channel) ||
+		   (1 == pos->round_finished) )
+		continue;
+	      pos->seek_request = -1;
+	      done = 0;
+	    }
+	  continue;
+	}
 
       /* calculate minimum seek request (or set done=0 to continue here) */
       done = 1;
@@ -521,8 +728,7 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
 	      break;
 	    }
 	}
-      /* if 'prp.file_finished', send 'abort' to plugins;
-	 if not, send 'seek' notification to plugins in range */
+      /* send 'seek' notification to plugins in range */
       for (pos = plugins; NULL != pos; pos = pos->next)
 	{
 	  if (NULL == (channel = pos->channel))
@@ -530,13 +736,6 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
 	      /* Skipping plugin: channel down */
 	      continue;
 	    }
-	  if ( (-1 != pos->seek_request) &&
-	       (1 == prp.file_finished) )
-	    {
-	      send_discard_message (pos);
-	      pos->round_finished = 1;
-	      pos->seek_request = -1;
-	    }
 	  if ( (-1 != data_available) &&
 	       (-1 != pos->seek_request) &&
 	       (min_seek <= pos->seek_request) &&
@@ -559,6 +758,8 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
     return;
   /* run in-process plugins */
   ctx.finished = 0;
+  ctx.plugins = plugins;
+  ctx.deadline = deadline;
   ctx.ds = ds;
   ctx.proc = proc;
   ctx.proc_cls = proc_cls;
@@ -567,10 +768,14 @@ do_extract (struct EXTRACTOR_PluginList *plugins,
   ec.seek = &in_process_seek;
   ec.get_size = &in_process_get_size;
   ec.proc = &in_process_proc;
+  ec.wants = &in_process_wants;
+  ec.mime_hint = ('\0' == start.mime_hint[0]) ? NULL : start.mime_hint;
   for (pos = plugins; NULL != pos; pos = pos->next)
     {
       if (EXTRACTOR_OPTION_IN_PROCESS != pos->flags)
 	continue;
+      if (0 != must_stop (plugins, deadline))
+	break;
       if (-1 == EXTRACTOR_plugin_load_ (pos))
         continue;
       ctx.plugin = pos;
@@ -612,10 +817,21 @@ EXTRACTOR_extract (struct EXTRACTOR_PluginList *plugins,
   struct EXTRACTOR_Datasource *datasource;
   struct EXTRACTOR_SharedMemory *shm;
   struct EXTRACTOR_PluginList *pos;
+  uint64_t deadline;
   int have_oop;
 
   if (NULL == plugins)
     return;
+  if (0 != plugins->cancelled)
+    {
+      /* cancelled before we even started */
+      plugins->cancelled = 0;
+      return;
+    }
+  if (0 != plugins->timeout_ms)
+    deadline = get_time_ms () + plugins->timeout_ms;
+  else
+    deadline = 0;
   if (NULL == filename)
     datasource = EXTRACTOR_datasource_create_from_buffer_ (data, size,
 							   proc, proc_cls);
@@ -623,7 +839,10 @@ EXTRACTOR_extract (struct EXTRACTOR_PluginList *plugins,
     datasource = EXTRACTOR_datasource_create_from_file_ (filename,
 							 proc, proc_cls);
   if (NULL == datasource)
-    return;
+    {
+      plugins->cancelled = 0;
+      return;
+    }
   shm = NULL;
   have_oop = 0;
   for (pos = plugins; NULL != pos; pos = pos->next)
@@ -643,6 +862,7 @@ EXTRACTOR_extract (struct EXTRACTOR_PluginList *plugins,
 	{
 	  LOG ("Failed to setup IPC\n");
 	  EXTRACTOR_datasource_destroy_ (datasource);
+	  plugins->cancelled = 0;
 	  return;
 	}
     }
@@ -663,8 +883,27 @@ EXTRACTOR_extract (struct EXTRACTOR_PluginList *plugins,
               shm,
               datasource,
               proc,
-              proc_cls);
+              proc_cls,
+	      deadline);
   EXTRACTOR_datasource_destroy_ (datasource);
+  /* cleared on exit (not on entry), so that a cancellation issued
+     just before this call is not lost */
+  plugins->cancelled = 0;
+}
+
+
+/**
+ * Abort the extraction currently running with the given plugins,
+ * or the next one if none is running.
+ *
+ * @param plugins the list of plugins passed to #EXTRACTOR_extract()
+ */
+void
+EXTRACTOR_cancel (struct EXTRACTOR_PluginList *plugins)
+{
+  if (NULL == plugins)
+    return;
+  plugins->cancelled = 1;
 }
 
 
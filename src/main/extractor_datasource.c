@@ -1153,6 +1153,12 @@ get_compression_type (struct BufferedFileDataSource *bfds)
 }
 
 
+/**
+ * I/O statistics of all data sources of this process.
+ */
+static struct EXTRACTOR_DatasourceStatistics statistics;
+
+
 /**
  * Handle to a datasource we can use for the plugins.
  */
@@ -1338,10 +1344,15 @@ EXTRACTOR_datasource_read_ (void *cls,
 			    size_t size)
 {
   struct EXTRACTOR_Datasource *ds = cls;
+  ssize_t ret;
 
   if (NULL != ds->cfs)
-    return cfs_read (ds->cfs, data, size);
-  return bfds_read (ds->bfds, data, size);
+    ret = cfs_read (ds->cfs, data, size);
+  else
+    ret = bfds_read (ds->bfds, data, size);
+  if (ret > 0)
+    statistics.bytes_read += ret;
+  return ret;
 }
 
 
@@ -1361,6 +1372,8 @@ EXTRACTOR_datasource_seek_ (void *cls,
 			    int whence)
 {
   struct EXTRACTOR_Datasource *ds = cls;
+  int64_t old_pos;
+  int64_t ret;
 
   if (NULL != ds->cfs)
     {
@@ -1372,9 +1385,18 @@ EXTRACTOR_datasource_seek_ (void *cls,
 	  if (-1 == ds->cfs->uncompressed_size)
 	    return -1;
 	}
-      return cfs_seek (ds->cfs, pos, whence);
+      old_pos = ds->cfs->fpos;
+      ret = cfs_seek (ds->cfs, pos, whence);
+    }
+  else
+    {
+      old_pos = ds->bfds->fpos + ds->bfds->buffer_pos;
+      ret = bfds_seek (ds->bfds, pos, whence);
     }
-  return bfds_seek (ds->bfds, pos, whence);
+  if ( (-1 != ret) &&
+       (old_pos != ret) )
+    statistics.seeks++;
+  return ret;
 }
 
 
@@ -1415,4 +1437,17 @@ EXTRACTOR_datasource_get_size_ (void *cls,
 }
 
 
+/**
+ * Obtain the I/O statistics of all data sources of this process
+ * since the start of the process.
+ *
+ * @param stats where to store the statistics
+ */
+void
+EXTRACTOR_datasource_get_statistics_ (struct EXTRACTOR_DatasourceStatistics *stats)
+{
+  *stats = statistics;
+}
+
+
 /* end of extractor_datasource.c */
@@ -33,6 +33,25 @@
 struct EXTRACTOR_Datasource;
 
 
+/**
+ * I/O performed on all data sources of this process.  Used by the
+ * performance mode of the plugin tests; not thread-safe.
+ */
+struct EXTRACTOR_DatasourceStatistics
+{
+  /**
+   * Number of bytes returned by #EXTRACTOR_datasource_read_().
+   */
+  uint64_t bytes_read;
+
+  /**
+   * Number of calls to #EXTRACTOR_datasource_seek_() that
+   * moved the read position.
+   */
+  uint64_t seeks;
+};
+
+
 /**
  * Create a datasource from a file on disk.
  *
@@ -113,4 +132,14 @@ EXTRACTOR_datasource_get_size_ (void *cls,
 				int force);
 
 
+/**
+ * Obtain the I/O statistics of all data sources of this process
+ * since the start of the process.
+ *
+ * @param stats where to store the statistics
+ */
+void
+EXTRACTOR_datasource_get_statistics_ (struct EXTRACTOR_DatasourceStatistics *stats);
+
+
 #endif
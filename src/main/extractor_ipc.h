@@ -76,6 +76,36 @@
  */
 #define MAX_META_DATA 32 * 1024 * 1024
 
+/**
+ * Size used for the shared memory segment.  Can be overridden
+ * via CPPFLAGS to compare window sizes with 'make bench'.
+ */
+#ifndef DEFAULT_SHM_SIZE
+#define DEFAULT_SHM_SIZE (16 * 1024)
+#endif
+
+/**
+ * How long (in ms) a running plugin may remain silent before we
+ * consider it blocked and close its channel.
+ */
+#define DEFAULT_RECV_TIMEOUT_MS 500
+
+/**
+ * Size of a bitmap with one bit per meta data type.
+ */
+#define WANTED_TYPES_SIZE ((EXTRACTOR_METATYPE_LAST + 7) / 8)
+
+/**
+ * Maximum length of the MIME type hint (including 0-terminator).
+ */
+#define MAX_MIME_HINT_SIZE 64
+
+/**
+ * How many bytes at the beginning of a file do we look at to
+ * determine the MIME type hint for the plugins?
+ */
+#define MIME_HINT_SNIFF_SIZE 1024
+
 /**
  * Maximum length of a shared memory object name
  */
@@ -157,6 +187,18 @@ struct StartMessage
    */
   uint64_t file_size;
 
+  /**
+   * Bitmap of the meta data types the application wants
+   * (bit 'type % 8' of byte 'type / 8').
+   */
+  unsigned char wanted_types[WANTED_TYPES_SIZE];
+
+  /**
+   * MIME type of the file as determined from its first bytes
+   * (0-terminated), empty if unknown.
+   */
+  char mime_hint[MAX_MIME_HINT_SIZE];
+
 };
 
 /**
@@ -469,13 +511,17 @@ EXTRACTOR_IPC_process_reply_ (struct EXTRACTOR_PluginList *plugin,
  * @param proc function to call to process messages (may be called
  *             more than once)
  * @param proc_cls closure for 'proc'
- * @return -1 on error (i.e. no response in 10s), 1 on success
+ * @param timeout_ms how long to wait; channels of plugins that are
+ *        not seeking are closed if nothing arrives in time
+ *        (usually #DEFAULT_RECV_TIMEOUT_MS)
+ * @return -1 on error, 1 on success
  */
 int
 EXTRACTOR_IPC_channel_recv_ (struct EXTRACTOR_Channel **channels,
 			     unsigned int num_channels,
 			     EXTRACTOR_ChannelMessageProcessor proc,
-			     void *proc_cls);
+			     void *proc_cls,
+			     uint32_t timeout_ms);
 
 
 #endif
@@ -457,13 +457,16 @@ EXTRACTOR_IPC_channel_send_ (struct EXTRACTOR_Channel *channel,
  * @param proc function to call to process messages (may be called
  *             more than once)
  * @param proc_cls closure for @a proc
+ * @param timeout_ms how long to wait; channels of plugins that are
+ *        not seeking are closed if nothing arrives in time
  * @return -1 on error, 1 on success
  */
 int
 EXTRACTOR_IPC_channel_recv_ (struct EXTRACTOR_Channel **channels,
 			     unsigned int num_channels,
 			     EXTRACTOR_ChannelMessageProcessor proc,
-			     void *proc_cls)
+			     void *proc_cls,
+			     uint32_t timeout_ms)
 {
   struct timeval tv;
   fd_set to_check;
@@ -490,8 +493,8 @@ EXTRACTOR_IPC_channel_recv_ (struct EXTRACTOR_Channel **channels,
     {
       return 1; /* nothing left to do! */
     }
-  tv.tv_sec = 0;
-  tv.tv_usec = 500000; /* 500 ms */
+  tv.tv_sec = timeout_ms / 1000;
+  tv.tv_usec = (timeout_ms % 1000) * 1000;
   if (0 >= select (max + 1, &to_check, NULL, NULL, &tv))
     {
       /* an error or timeout -> something's wrong or all plugins hung up */
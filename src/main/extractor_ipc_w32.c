@@ -678,13 +678,16 @@ EXTRACTOR_IPC_channel_send_ (struct EXTRACTOR_Channel *channel,
  * @param proc function to call to process messages (may be called
  *             more than once)
  * @param proc_cls closure for 'proc'
+ * @param timeout_ms how long to wait; channels of plugins that are
+ *        not seeking are closed if nothing arrives in time
  * @return -1 on error, 1 on success
  */
 int
 EXTRACTOR_IPC_channel_recv_ (struct EXTRACTOR_Channel **channels,
 			     unsigned int num_channels,
 			     EXTRACTOR_ChannelMessageProcessor proc,
-			     void *proc_cls)
+			     void *proc_cls,
+			     uint32_t timeout_ms)
 {
   DWORD ms;
   DWORD first_ready;
@@ -726,7 +729,7 @@ EXTRACTOR_IPC_channel_recv_ (struct EXTRACTOR_Channel **channels,
   if (c == 0)
     return 1; /* nothing left to do! */
 
-  ms = 500;
+  ms = timeout_ms;
   first_ready = WaitForMultipleObjects (c, events, FALSE, ms);
   if (first_ready == WAIT_TIMEOUT || first_ready == WAIT_FAILED)
   {
@@ -557,6 +557,13 @@ static const struct MetaTypeDescription meta_type_descriptions[] = {
   { gettext_noop ("nar"),
     gettext_noop ("normalized archive") },
 
+  { gettext_noop ("library soname"),
+    gettext_noop ("name under which a shared library is found by the dynamic linker (ELF SONAME)") },
+  { gettext_noop ("program interpreter"),
+    gettext_noop ("dynamic linker that loads the program") },
+  { gettext_noop ("build id"),
+    gettext_noop ("unique identifier of the build that produced the binary (in hexadecimal)") },
+
   { gettext_noop ("last"),
     gettext_noop ("last") }
 };
@@ -92,6 +92,16 @@ struct ProcessingContext
    */
   uint32_t shm_ready_bytes;
 
+  /**
+   * Bitmap of the meta data types the application wants.
+   */
+  unsigned char wanted_types[WANTED_TYPES_SIZE];
+
+  /**
+   * MIME type of the file as determined by the parent, empty if unknown.
+   */
+  char mime_hint[MAX_MIME_HINT_SIZE];
+
   /**
    * Input stream.
    */
@@ -261,6 +271,15 @@ plugin_env_read (void *cls,
   if ( (count + pc->read_position > pc->file_size) ||
        (count + pc->read_position < pc->read_position) )
     count = pc->file_size - pc->read_position;
+  if ( (pc->read_position + count > pc->shm_off + pc->shm_ready_bytes) &&
+       (pc->read_position > pc->shm_off) &&
+       (count <= pc->shm_map_size) )
+    {
+      /* the request crosses the end of the window, but fits into a
+	 window starting at the read position: move the window instead
+	 of returning a short read (which many plugins treat as EOF) */
+      pc->shm_ready_bytes = 0;
+    }
   if ((((pc->read_position >= pc->shm_off + pc->shm_ready_bytes) &&
       (pc->read_position < pc->file_size)) ||
       (pc->read_position < pc->shm_off)) &&
@@ -293,6 +312,24 @@ plugin_env_get_size (void *cls)
 }
 
 
+/**
+ * Check if the application wants meta data of the given type.
+ *
+ * @param cls the 'struct ProcessingContext'
+ * @param type type of meta data
+ * @return 1 if meta data of this type is wanted, 0 if not
+ */
+static int
+plugin_env_wants (void *cls,
+		  enum EXTRACTOR_MetaType type)
+{
+  struct ProcessingContext *pc = cls;
+
+  return EXTRACTOR_plugin_wants_type_ (pc->wanted_types,
+				       type);
+}
+
+
 /**
  * Function called by a plugin in a child process.  Transmits
  * the meta data back to the parent process.
@@ -469,6 +506,13 @@ handle_start_message (struct ProcessingContext *pc)
     }
   pc->shm_ready_bytes = start.shm_ready_bytes;
   pc->file_size = start.file_size;
+  memcpy (pc->wanted_types,
+	  start.wanted_types,
+	  sizeof (pc->wanted_types));
+  memcpy (pc->mime_hint,
+	  start.mime_hint,
+	  sizeof (pc->mime_hint));
+  pc->mime_hint[sizeof (pc->mime_hint) - 1] = '\0';
   pc->read_position = 0;
   pc->shm_off = 0;
   ec.cls = pc;
@@ -477,6 +521,8 @@ handle_start_message (struct ProcessingContext *pc)
   ec.seek = &plugin_env_seek;
   ec.get_size = &plugin_env_get_size;
   ec.proc = &plugin_env_send_proc;
+  ec.wants = &plugin_env_wants;
+  ec.mime_hint = ('\0' == pc->mime_hint[0]) ? NULL : pc->mime_hint;
   pc->plugin->extract_method (&ec);
   done = MESSAGE_DONE;
   if (-1 == EXTRACTOR_write_all_ (pc->out, &done, sizeof (done)))
@@ -237,6 +237,12 @@ EXTRACTOR_plugin_add (struct EXTRACTOR_PluginList *prev,
   else
     plugin->plugin_options = NULL;
   plugin->seek_request = -1;
+  if (NULL != prev)
+    {
+      plugin->timeout_ms = prev->timeout_ms;
+      plugin->wanted_types = prev->wanted_types;
+      prev->wanted_types = NULL;
+    }
   return plugin;
 }
 
@@ -360,7 +366,15 @@ EXTRACTOR_plugin_remove (struct EXTRACTOR_PluginList *prev,
     }
   /* found, close library */
   if (first == pos)
-    first = pos->next;
+    {
+      first = pos->next;
+      if (NULL != first)
+	{
+	  first->timeout_ms = pos->timeout_ms;
+	  first->wanted_types = pos->wanted_types;
+	  pos->wanted_types = NULL;
+	}
+    }
   else
     prev->next = pos->next;
   if (NULL != pos->channel)
@@ -371,6 +385,7 @@ EXTRACTOR_plugin_remove (struct EXTRACTOR_PluginList *prev,
   if (NULL != pos->libname)
     free (pos->libname);
   free (pos->plugin_options);
+  free (pos->wanted_types);
   if (NULL != pos->libraryHandle)
 	lt_dlclose (pos->libraryHandle);
   free (pos);
@@ -391,4 +406,68 @@ EXTRACTOR_plugin_remove_all (struct EXTRACTOR_PluginList *plugins)
 }
 
 
+/**
+ * Limit how long #EXTRACTOR_extract() may take for each file.
+ *
+ * @param plugins the list of plugins
+ * @param timeout_ms maximum time in milliseconds, 0 for no limit
+ */
+void
+EXTRACTOR_plugin_set_timeout (struct EXTRACTOR_PluginList *plugins,
+			      unsigned int timeout_ms)
+{
+  if (NULL == plugins)
+    return;
+  plugins->timeout_ms = timeout_ms;
+}
+
+
+/**
+ * Tell the plugins which types of meta data the application wants.
+ *
+ * @param plugins the list of plugins
+ * @param types array of wanted types
+ * @param num_types number of entries in @a types, 0 to want all types
+ */
+void
+EXTRACTOR_plugin_set_wanted_types (struct EXTRACTOR_PluginList *plugins,
+				   const enum EXTRACTOR_MetaType *types,
+				   unsigned int num_types)
+{
+  unsigned int i;
+
+  if (NULL == plugins)
+    return;
+  free (plugins->wanted_types);
+  plugins->wanted_types = NULL;
+  if (0 == num_types)
+    return;
+  if (NULL == (plugins->wanted_types = calloc (1, WANTED_TYPES_SIZE)))
+    return; /* out of memory, just want everything */
+  for (i = 0; i < num_types; i++)
+    if ( (types[i] >= 0) &&
+	 (types[i] < EXTRACTOR_METATYPE_LAST) )
+      plugins->wanted_types[types[i] / 8] |= 1 << (types[i] % 8);
+}
+
+
+/**
+ * Check if a meta data type is in a bitmap of wanted types.
+ *
+ * @param wanted_types bitmap of wanted types, NULL for all
+ * @param type type to check
+ * @return 1 if the type is wanted, 0 if not
+ */
+int
+EXTRACTOR_plugin_wants_type_ (const unsigned char *wanted_types,
+			      enum EXTRACTOR_MetaType type)
+{
+  if ( (NULL == wanted_types) ||
+       (type < 0) ||
+       (type >= EXTRACTOR_METATYPE_LAST) )
+    return 1;
+  return (0 != (wanted_types[type / 8] & (1 << (type % 8)))) ? 1 : 0;
+}
+
+
 /* end of extractor_plugins.c */
@@ -113,6 +113,26 @@ struct EXTRACTOR_PluginList
    */
   uint16_t seek_whence;
 
+  /**
+   * Maximum time (in ms) #EXTRACTOR_extract() may take, 0 for no
+   * limit.  Only used for the first element of the list.
+   */
+  unsigned int timeout_ms;
+
+  /**
+   * Set by #EXTRACTOR_cancel() (possibly from another thread) to
+   * abort the running extraction.  Only used for the first element
+   * of the list.
+   */
+  volatile sig_atomic_t cancelled;
+
+  /**
+   * Bitmap of the meta data types the application wants (of
+   * #WANTED_TYPES_SIZE bytes), NULL if it wants all of them.
+   * Only used for the first element of the list.
+   */
+  unsigned char *wanted_types;
+
 };
 
 
@@ -125,4 +145,16 @@ struct EXTRACTOR_PluginList
 int
 EXTRACTOR_plugin_load_ (struct EXTRACTOR_PluginList *plugin);
 
+
+/**
+ * Check if a meta data type is in a bitmap of wanted types.
+ *
+ * @param wanted_types bitmap of wanted types, NULL for all
+ * @param type type to check
+ * @return 1 if the type is wanted, 0 if not
+ */
+int
+EXTRACTOR_plugin_wants_type_ (const unsigned char *wanted_types,
+			      enum EXTRACTOR_MetaType type);
+
 #endif /* EXTRACTOR_PLUGINS_H */
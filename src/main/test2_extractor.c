@@ -24,7 +24,8 @@
  * first 4 bytes must be "test", all other bytes should be equal to
  * <FILE_OFFSET> % 256. The test client must return 0 after seeing
  * "Hello World!" metadata, and return 1 after seeing "Goodbye!"
- * metadata.
+ * metadata.  If all checks pass, the plugin reports "test2 passed"
+ * as a comment.
  * @author Christian Grothoff
  */
 #include "platform.h"
@@ -67,6 +68,24 @@ EXTRACTOR_test2_extract_method (struct EXTRACTOR_ExtractContext *ec)
       fprintf (stderr, "Unexpected file size returned (expected 150k)\n");
       ABORT (); 
     }		    
+  /* reads across the end of the (16k) shared memory window
+     must not be short */
+  if (1024 * 16 - 4 != ec->seek (ec->cls, 1024 * 16 - 4, SEEK_SET))
+    {
+      fprintf (stderr, "Failure to seek (SEEK_SET)\n");
+      ABORT ();
+    }
+  if (8 != ec->read (ec->cls, &dp, 8))
+    {
+      fprintf (stderr, "Short read at 16k - 4\n");
+      ABORT ();
+    }
+  if ( ((1024 * 16 - 4) % 256 != ((unsigned char *) dp)[0]) ||
+       ((1024 * 16 + 3) % 256 != ((unsigned char *) dp)[7]) )
+    {
+      fprintf (stderr, "Unexpected data at offset 16k - 4\n");
+      ABORT ();
+    }
   if (1024 * 100 + 4 != ec->seek (ec->cls, 1024 * 100 + 4, SEEK_SET))
     {
       fprintf (stderr, "Failure to seek (SEEK_SET)\n");
@@ -123,6 +142,15 @@ EXTRACTOR_test2_extract_method (struct EXTRACTOR_ExtractContext *ec)
       fprintf (stderr, "Unexpected data at offset 150k - 3\n");
       ABORT ();
     }
+  /* tell the client that all checks passed (a failed check kills
+     an out-of-process plugin, which the client would not notice) */
+  ec->proc (ec->cls,
+	    "test2",
+	    EXTRACTOR_METATYPE_COMMENT,
+	    EXTRACTOR_METAFORMAT_UTF8,
+	    "<no mime>",
+	    "test2 passed",
+	    strlen ("test2 passed") + 1);
 }
 
 /* end of test2_extractor.c */
@@ -49,6 +49,56 @@ EXTRACTOR_test_extract_method (struct EXTRACTOR_ExtractContext *ec)
 {
   void *dp;
 
+  if ( (NULL != ec->config) &&
+       (0 == strcmp (ec->config, "flood")) )
+    {
+      /* keep producing meta data until told to stop (for test_timeout) */
+      while (0 == ec->proc (ec->cls,
+			    "test",
+			    EXTRACTOR_METATYPE_COMMENT,
+			    EXTRACTOR_METAFORMAT_UTF8,
+			    "<no mime>",
+			    "flood",
+			    strlen ("flood") + 1))
+	;
+      return;
+    }
+  if ( (NULL != ec->config) &&
+       (0 == strcmp (ec->config, "mime_hint")) )
+    {
+      const char *msg;
+
+      /* report the MIME type hint (for test_mime_hint) */
+      msg = (NULL == ec->mime_hint) ? "<none>" : ec->mime_hint;
+      ec->proc (ec->cls,
+		"test",
+		EXTRACTOR_METATYPE_COMMENT,
+		EXTRACTOR_METAFORMAT_UTF8,
+		"<no mime>",
+		msg,
+		strlen (msg) + 1);
+      return;
+    }
+  if ( (NULL != ec->config) &&
+       (0 == strcmp (ec->config, "wants")) )
+    {
+      char msg[32];
+
+      /* report which types are wanted (for test_wanted) */
+      snprintf (msg,
+		sizeof (msg),
+		"title=%d thumbnail=%d",
+		ec->wants (ec->cls, EXTRACTOR_METATYPE_TITLE),
+		ec->wants (ec->cls, EXTRACTOR_METATYPE_THUMBNAIL));
+      ec->proc (ec->cls,
+		"test",
+		EXTRACTOR_METATYPE_COMMENT,
+		EXTRACTOR_METAFORMAT_UTF8,
+		"<no mime>",
+		msg,
+		strlen (msg) + 1);
+      return;
+    }
   if ((NULL == ec->config) || (0 != strcmp (ec->config, "test")))
     return; /* only run in test mode */
   if (4 != ec->read (ec->cls, &dp, 4))
@@ -32,6 +32,7 @@ static int ret = 2;
 
 #define HLO "Hello world!"
 #define GOB "Goodbye!"
+#define T2OK "test2 passed"
 
 /**
  * Function that libextractor calls for each
@@ -123,6 +124,43 @@ process_replies (void *cls,
 }
 
 
+/**
+ * Function that libextractor calls for each meta data item found
+ * by the "test2" plugin.  Sets the flag in @a cls once the plugin
+ * reports that all of its read and seek checks passed.
+ *
+ * @param cls pointer to an 'int' flag
+ * @param plugin_name should be "test2"
+ * @param type should be "COMMENT"
+ * @param format should be "UTF8"
+ * @param data_mime_type should be "<no mime>"
+ * @param data should be "test2 passed"
+ * @param data_len number of bytes in data
+ * @return 0 (always)
+ */
+static int
+process_test2_replies (void *cls,
+		       const char *plugin_name,
+		       enum EXTRACTOR_MetaType type,
+		       enum EXTRACTOR_MetaFormat format,
+		       const char *data_mime_type,
+		       const char *data,
+		       size_t data_len)
+{
+  int *passed = cls;
+
+  if ( (0 == strcmp (plugin_name,
+		     "test2")) &&
+       (EXTRACTOR_METATYPE_COMMENT == type) &&
+       (data_len == strlen (T2OK) + 1) &&
+       (0 == strncmp (data,
+		      T2OK,
+		      strlen (T2OK))) )
+    *passed = 1;
+  return 0;
+}
+
+
 /**
  * Main function for the IPC testcase.
  *
@@ -136,6 +174,7 @@ main (int argc, char *argv[])
   struct EXTRACTOR_PluginList *pl;
   unsigned char buf[1024 * 150];
   size_t i;
+  int test2_passed;
 
   /* initialize test buffer as expected by test plugin */
   for (i=0;i<sizeof(buf);i++)
@@ -166,7 +205,27 @@ main (int argc, char *argv[])
       EXTRACTOR_extract (pl, NULL, buf, sizeof (buf), &process_replies, "main-cls");
     }
   EXTRACTOR_plugin_remove_all (pl);
-  return ret;
+  if (0 != ret)
+    return ret;
+
+  /* run "test2" on its own, so that its report is not cut short
+     by "test" aborting the extraction after "Goodbye!" */
+  pl = EXTRACTOR_plugin_add_config (NULL, "test2(test2)",
+				    EXTRACTOR_OPTION_DEFAULT_POLICY);
+  if (NULL == pl)
+    {
+      fprintf (stderr, "failed to load test2 plugin\n");
+      return 1;
+    }
+  test2_passed = 0;
+  EXTRACTOR_extract (pl, NULL, buf, sizeof (buf), &process_test2_replies, &test2_passed);
+  EXTRACTOR_plugin_remove_all (pl);
+  if (1 != test2_passed)
+    {
+      fprintf (stderr, "test2 plugin did not pass its checks\n");
+      return 9;
+    }
+  return 0;
 }
 
 /* end of test_ipc.c */
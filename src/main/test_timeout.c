@@ -0,0 +1,273 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file main/test_timeout.c
+ * @brief testcase for EXTRACTOR_plugin_set_timeout() and
+ *        EXTRACTOR_cancel() using the "test" plugin in "flood" mode,
+ *        which produces meta data until it is told to stop
+ */
+#include "platform.h"
+#include "extractor.h"
+
+/**
+ * Timeout we set for the extraction (in ms).
+ */
+#define TIMEOUT_MS 300
+
+/**
+ * After how many items do we cancel the extraction?
+ */
+#define CANCEL_AFTER 100
+
+/**
+ * After how many ms do we give up if the plugin was not stopped?
+ */
+#define SAFETY_MS 5000
+
+
+/**
+ * Closure for #process_replies().
+ */
+struct TestContext
+{
+  /**
+   * Plugins we are running (to cancel).
+   */
+  struct EXTRACTOR_PluginList *pl;
+
+  /**
+   * When did the extraction start?
+   */
+  uint64_t start;
+
+  /**
+   * Number of meta data items received.
+   */
+  unsigned int count;
+
+  /**
+   * Cancel after #CANCEL_AFTER items?
+   */
+  int cancel;
+
+  /**
+   * Set to 1 if we had to stop the plugin ourselves.
+   */
+  int overrun;
+};
+
+
+/**
+ * Get the current time.
+ *
+ * @return current time in milliseconds
+ */
+static uint64_t
+now_ms ()
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+  return (uint64_t) tv.tv_sec * 1000LLU + tv.tv_usec / 1000;
+}
+
+
+/**
+ * Function that libextractor calls for each meta data item found.
+ * Counts the items, cancels the extraction if requested, and aborts
+ * if the plugin was not stopped in time.
+ *
+ * @param cls our `struct TestContext`
+ * @param plugin_name should be "test"
+ * @param type should be "COMMENT"
+ * @param format should be "UTF8"
+ * @param data_mime_type should be "<no mime>"
+ * @param data should be "flood"
+ * @param data_len number of bytes in data
+ * @return 0 to continue, 1 if the plugin ran for far too long
+ */
+static int
+process_replies (void *cls,
+		 const char *plugin_name,
+		 enum EXTRACTOR_MetaType type,
+		 enum EXTRACTOR_MetaFormat format,
+		 const char *data_mime_type,
+		 const char *data,
+		 size_t data_len)
+{
+  struct TestContext *tc = cls;
+
+  tc->count++;
+  if ( (1 == tc->cancel) &&
+       (CANCEL_AFTER == tc->count) )
+    EXTRACTOR_cancel (tc->pl);
+  if (now_ms () - tc->start > SAFETY_MS)
+    {
+      tc->overrun = 1;
+      return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Run the "flood" plugin once and check that it was stopped in time.
+ *
+ * @param pl plugins to run
+ * @param cancel 1 to cancel after #CANCEL_AFTER items, 0 to rely
+ *        on the timeout
+ * @return 0 on success
+ */
+static int
+run_flood (struct EXTRACTOR_PluginList *pl,
+	   int cancel)
+{
+  static char buf[1024];
+  struct TestContext tc;
+  uint64_t delay;
+
+  memset (&tc, 0, sizeof (tc));
+  tc.pl = pl;
+  tc.cancel = cancel;
+  tc.start = now_ms ();
+  EXTRACTOR_extract (pl, NULL, buf, sizeof (buf), &process_replies, &tc);
+  delay = now_ms () - tc.start;
+  if (1 == tc.overrun)
+    {
+      fprintf (stderr,
+	       "Plugin was not stopped after %u ms\n",
+	       SAFETY_MS);
+      return 1;
+    }
+  if (0 == tc.count)
+    {
+      fprintf (stderr, "Plugin did not produce any meta data\n");
+      return 1;
+    }
+  if ( (1 == cancel) &&
+       (tc.count > CANCEL_AFTER + 1) )
+    {
+      fprintf (stderr,
+	       "Received %u items after cancelling\n",
+	       tc.count - CANCEL_AFTER);
+      return 1;
+    }
+  /* allow for the grace period and for slow build machines */
+  if ( (0 == cancel) &&
+       (delay > 4 * TIMEOUT_MS) )
+    {
+      fprintf (stderr,
+	       "Extraction took %llu ms (timeout was %u ms)\n",
+	       (unsigned long long) delay,
+	       TIMEOUT_MS);
+      return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Cancel before starting the extraction and check that the
+ * cancellation is not lost.
+ *
+ * @param pl plugins to run
+ * @return 0 on success
+ */
+static int
+run_cancelled (struct EXTRACTOR_PluginList *pl)
+{
+  static char buf[1024];
+  struct TestContext tc;
+
+  memset (&tc, 0, sizeof (tc));
+  tc.pl = pl;
+  tc.start = now_ms ();
+  EXTRACTOR_cancel (pl);
+  EXTRACTOR_extract (pl, NULL, buf, sizeof (buf), &process_replies, &tc);
+  if (0 != tc.count)
+    {
+      fprintf (stderr,
+	       "Received %u items although cancelled before the start\n",
+	       tc.count);
+      return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Test the timeout and cancellation with the given execution policy.
+ *
+ * @param flags execution policy for the plugin
+ * @return 0 on success
+ */
+static int
+test_policy (enum EXTRACTOR_Options flags)
+{
+  struct EXTRACTOR_PluginList *pl;
+  int ret;
+
+  pl = EXTRACTOR_plugin_add_config (NULL, "test(flood)", flags);
+  if (NULL == pl)
+    {
+      fprintf (stderr, "failed to load test plugin\n");
+      return 1;
+    }
+  EXTRACTOR_plugin_set_timeout (pl, TIMEOUT_MS);
+  ret = 0;
+  /* run twice, the plugin may have been restarted in between */
+  ret |= run_flood (pl, 0);
+  ret |= run_flood (pl, 0);
+  EXTRACTOR_plugin_set_timeout (pl, 0);
+  ret |= run_flood (pl, 1);
+  ret |= run_flood (pl, 1);
+  /* the cancellation must apply to the next call only */
+  ret |= run_cancelled (pl);
+  ret |= run_flood (pl, 1);
+  EXTRACTOR_plugin_remove_all (pl);
+  return ret;
+}
+
+
+/**
+ * Main function for the timeout testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  /* change environment to find 'extractor_test' plugin which is
+     not installed but should be in the current directory (or .libs)
+     on 'make check' */
+  if (0 != putenv ("LIBEXTRACTOR_PREFIX=." PATH_SEPARATOR_STR ".libs/"))
+    fprintf (stderr,
+	     "Failed to update my environment, plugin loading may fail: %s\n",
+	     strerror (errno));
+  if (0 != test_policy (EXTRACTOR_OPTION_DEFAULT_POLICY))
+    return 1;
+  if (0 != test_policy (EXTRACTOR_OPTION_IN_PROCESS))
+    return 2;
+  return 0;
+}
+
+/* end of test_timeout.c */
@@ -0,0 +1,156 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file main/test_wanted.c
+ * @brief testcase for EXTRACTOR_plugin_set_wanted_types() using the
+ *        "test" plugin in "wants" mode, which reports what
+ *        'ec->wants' returned for TITLE and THUMBNAIL
+ */
+#include "platform.h"
+#include "extractor.h"
+
+
+/**
+ * Function that libextractor calls for each meta data item found.
+ * Remembers the report of the "test" plugin.
+ *
+ * @param cls buffer to store the report in
+ * @param plugin_name should be "test"
+ * @param type should be "COMMENT"
+ * @param format should be "UTF8"
+ * @param data_mime_type should be "<no mime>"
+ * @param data report of the plugin
+ * @param data_len number of bytes in data
+ * @return 0 (always)
+ */
+static int
+process_replies (void *cls,
+		 const char *plugin_name,
+		 enum EXTRACTOR_MetaType type,
+		 enum EXTRACTOR_MetaFormat format,
+		 const char *data_mime_type,
+		 const char *data,
+		 size_t data_len)
+{
+  char *report = cls;
+
+  if ( (0 == strcmp (plugin_name, "test")) &&
+       (EXTRACTOR_METATYPE_COMMENT == type) )
+    snprintf (report, 64, "%s", data);
+  return 0;
+}
+
+
+/**
+ * Run the plugins and check what the "test" plugin reported.
+ *
+ * @param pl plugins to run
+ * @param expected expected report
+ * @return 0 on success
+ */
+static int
+check_report (struct EXTRACTOR_PluginList *pl,
+	      const char *expected)
+{
+  static unsigned char buf[1024 * 150];
+  char report[64];
+  size_t i;
+
+  /* initialize test buffer as expected by the "test2" plugin */
+  for (i = 0; i < sizeof (buf); i++)
+    buf[i] = (unsigned char) (i % 256);
+  memcpy (buf, "test", 4);
+  report[0] = '\0';
+  EXTRACTOR_extract (pl, NULL, buf, sizeof (buf), &process_replies, report);
+  if (0 != strcmp (report, expected))
+    {
+      fprintf (stderr,
+	       "Expected `%s', got `%s'\n",
+	       expected,
+	       report);
+      return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Test the wanted types with the given execution policy.
+ *
+ * @param flags execution policy for the plugin
+ * @return 0 on success
+ */
+static int
+test_policy (enum EXTRACTOR_Options flags)
+{
+  static const enum EXTRACTOR_MetaType title[] = {
+    EXTRACTOR_METATYPE_MIMETYPE,
+    EXTRACTOR_METATYPE_TITLE
+  };
+  struct EXTRACTOR_PluginList *pl;
+  int ret;
+
+  pl = EXTRACTOR_plugin_add_config (NULL, "test(wants)", flags);
+  if (NULL == pl)
+    {
+      fprintf (stderr, "failed to load test plugin\n");
+      return 1;
+    }
+  ret = 0;
+  ret |= check_report (pl, "title=1 thumbnail=1");
+  EXTRACTOR_plugin_set_wanted_types (pl, title, 2);
+  ret |= check_report (pl, "title=1 thumbnail=0");
+  /* the setting must survive changes to the list */
+  pl = EXTRACTOR_plugin_add_config (pl, "test2(test2)", flags);
+  ret |= check_report (pl, "title=1 thumbnail=0");
+  pl = EXTRACTOR_plugin_remove (pl, "test2");
+  ret |= check_report (pl, "title=1 thumbnail=0");
+  EXTRACTOR_plugin_set_wanted_types (pl, NULL, 0);
+  ret |= check_report (pl, "title=1 thumbnail=1");
+  EXTRACTOR_plugin_remove_all (pl);
+  return ret;
+}
+
+
+/**
+ * Main function for the wanted types testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  /* change environment to find 'extractor_test' plugin which is
+     not installed but should be in the current directory (or .libs)
+     on 'make check' */
+  if (0 != putenv ("LIBEXTRACTOR_PREFIX=." PATH_SEPARATOR_STR ".libs/"))
+    fprintf (stderr,
+	     "Failed to update my environment, plugin loading may fail: %s\n",
+	     strerror (errno));
+  if (0 != test_policy (EXTRACTOR_OPTION_DEFAULT_POLICY))
+    return 1;
+  if (0 != test_policy (EXTRACTOR_OPTION_IN_PROCESS))
+    return 2;
+  return 0;
+}
+
+/* end of test_wanted.c */
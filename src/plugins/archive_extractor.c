@@ -96,7 +96,12 @@ EXTRACTOR_archive_extract_method (struct EXTRACTOR_ExtractContext *ec)
   const char *fname;
   const char *s;
   char *format;
+  int want_files;
 
+  want_files = ec->wants (ec->cls, EXTRACTOR_METATYPE_FILENAME);
+  if ( (0 == want_files) &&
+       (0 == ec->wants (ec->cls, EXTRACTOR_METATYPE_FORMAT)) )
+    return;
   format = NULL;
   a = archive_read_new ();
 #if ARCHIVE_VERSION_NUMBER >= 3000000
@@ -113,6 +118,8 @@ EXTRACTOR_archive_extract_method (struct EXTRACTOR_ExtractContext *ec)
       if ( (NULL == format) &&
 	   (NULL != (fname = archive_format_name (a))) )
 	format = strdup (fname);
+      if (0 == want_files)
+	break; /* only wanted the format, no need to walk the entries */
       s = archive_entry_pathname (entry);
       if (0 != ec->proc (ec->cls, 
 			 "tar", 
@@ -0,0 +1,1066 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file plugins/asf_extractor.c
+ * @brief plugin to support ASF files (WMA and WMV)
+ *
+ * We walk the objects of the Header Object and read the File
+ * Properties, Stream Properties, Codec List, Content Description
+ * and Extended Content Description objects.  We stop at the end of
+ * the Header Object and never read the Data Object.
+ */
+#include "platform.h"
+#include "extractor.h"
+#include "convert.h"
+#include <stdint.h>
+
+
+/**
+ * Size of a GUID.
+ */
+#define GUID_SIZE 16
+
+/**
+ * Size of an object header (GUID and 64-bit size).
+ */
+#define OBJECT_HEADER_SIZE 24
+
+/**
+ * Size of the Header Object header (object header, number of
+ * header objects and two reserved bytes).
+ */
+#define HEADER_OBJECT_SIZE 30
+
+/**
+ * Maximum number of header objects we look at.
+ */
+#define MAX_OBJECTS 1024
+
+/**
+ * Maximum size of an object we are willing to read (the Extended
+ * Content Description may contain cover art).
+ */
+#define MAX_OBJECT_SIZE (16 * 1024 * 1024)
+
+/**
+ * Maximum number of streams we keep track of.
+ */
+#define MAX_STREAMS 16
+
+/**
+ * Forward gaps up to this size are skipped by reading over them
+ * instead of seeking.
+ */
+#define MAX_SKIP_READ 256
+
+/**
+ * Number of 100-nanosecond intervals between 1601-01-01 (the
+ * FILETIME epoch) and 1970-01-01.
+ */
+#define FILETIME_EPOCH_OFFSET 116444736000000000ULL
+
+
+/**
+ * ASF Header Object.
+ */
+static const unsigned char guid_header[GUID_SIZE] =
+  { 0x30, 0x26, 0xB2, 0x75, 0x8E, 0x66, 0xCF, 0x11,
+    0xA6, 0xD9, 0x00, 0xAA, 0x00, 0x62, 0xCE, 0x6C };
+
+/**
+ * File Properties Object.
+ */
+static const unsigned char guid_file_properties[GUID_SIZE] =
+  { 0xA1, 0xDC, 0xAB, 0x8C, 0x47, 0xA9, 0xCF, 0x11,
+    0x8E, 0xE4, 0x00, 0xC0, 0x0C, 0x20, 0x53, 0x65 };
+
+/**
+ * Stream Properties Object.
+ */
+static const unsigned char guid_stream_properties[GUID_SIZE] =
+  { 0x91, 0x07, 0xDC, 0xB7, 0xB7, 0xA9, 0xCF, 0x11,
+    0x8E, 0xE6, 0x00, 0xC0, 0x0C, 0x20, 0x53, 0x65 };
+
+/**
+ * Codec List Object.
+ */
+static const unsigned char guid_codec_list[GUID_SIZE] =
+  { 0x40, 0x52, 0xD1, 0x86, 0x1D, 0x31, 0xD0, 0x11,
+    0xA3, 0xA4, 0x00, 0xA0, 0xC9, 0x03, 0x48, 0xF6 };
+
+/**
+ * Content Description Object.
+ */
+static const unsigned char guid_content_description[GUID_SIZE] =
+  { 0x33, 0x26, 0xB2, 0x75, 0x8E, 0x66, 0xCF, 0x11,
+    0xA6, 0xD9, 0x00, 0xAA, 0x00, 0x62, 0xCE, 0x6C };
+
+/**
+ * Extended Content Description Object.
+ */
+static const unsigned char guid_extended_content_description[GUID_SIZE] =
+  { 0x40, 0xA4, 0xD0, 0xD2, 0x07, 0xE3, 0xD2, 0x11,
+    0x97, 0xF0, 0x00, 0xA0, 0xC9, 0x5E, 0xA8, 0x50 };
+
+/**
+ * Stream type of audio streams.
+ */
+static const unsigned char guid_audio_media[GUID_SIZE] =
+  { 0x40, 0x9E, 0x69, 0xF8, 0x4D, 0x5B, 0xCF, 0x11,
+    0xA8, 0xFD, 0x00, 0x80, 0x5F, 0x5C, 0x44, 0x2B };
+
+/**
+ * Stream type of video streams.
+ */
+static const unsigned char guid_video_media[GUID_SIZE] =
+  { 0xC0, 0xEF, 0x19, 0xBC, 0x4D, 0x5B, 0xCF, 0x11,
+    0xA8, 0xFD, 0x00, 0x80, 0x5F, 0x5C, 0x44, 0x2B };
+
+
+/**
+ * MIME types we handle (the signature table in
+ * common/mime_signatures.c reports "video/x-ms-asf").
+ */
+static const char *const mime_types[] =
+  {
+    "video/x-ms-asf",
+    "video/x-ms-wmv",
+    "audio/x-ms-wma",
+    "application/vnd.ms-asf",
+    NULL
+  };
+
+
+/**
+ * Mapping of Extended Content Description attributes to LE types.
+ */
+struct AttributeMap
+{
+  /**
+   * Name of the attribute.
+   */
+  const char *name;
+
+  /**
+   * Corresponding LE type.
+   */
+  enum EXTRACTOR_MetaType type;
+};
+
+
+/**
+ * Attributes we extract.
+ */
+static const struct AttributeMap attribute_map[] =
+  {
+    { "WM/AlbumTitle", EXTRACTOR_METATYPE_ALBUM },
+    { "WM/AlbumArtist", EXTRACTOR_METATYPE_ARTIST },
+    { "WM/Genre", EXTRACTOR_METATYPE_GENRE },
+    { "WM/Year", EXTRACTOR_METATYPE_PUBLICATION_YEAR },
+    { "WM/TrackNumber", EXTRACTOR_METATYPE_TRACK_NUMBER },
+    { "WM/PartOfSet", EXTRACTOR_METATYPE_DISC_NUMBER },
+    { "WM/Composer", EXTRACTOR_METATYPE_COMPOSER },
+    { "WM/Conductor", EXTRACTOR_METATYPE_CONDUCTOR },
+    { "WM/Writer", EXTRACTOR_METATYPE_WRITER },
+    { "WM/Lyrics", EXTRACTOR_METATYPE_LYRICS },
+    { "WM/Publisher", EXTRACTOR_METATYPE_PUBLISHER },
+    { "WM/EncodedBy", EXTRACTOR_METATYPE_ENCODED_BY },
+    { "WM/ToolName", EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE },
+    { "WM/Producer", EXTRACTOR_METATYPE_PRODUCER },
+    { "WM/Director", EXTRACTOR_METATYPE_MOVIE_DIRECTOR },
+    { "WM/SubTitle", EXTRACTOR_METATYPE_SUBTITLE },
+    { "WM/Mood", EXTRACTOR_METATYPE_MOOD },
+    { "WM/ContentGroupDescription", EXTRACTOR_METATYPE_GROUP },
+    { "WM/Category", EXTRACTOR_METATYPE_SECTION },
+    { "WM/BeatsPerMinute", EXTRACTOR_METATYPE_BEATS_PER_MINUTE },
+    { "WM/ParentalRating", EXTRACTOR_METATYPE_RATING },
+    { "WM/AuthorURL", EXTRACTOR_METATYPE_URL },
+    { "WM/PromotionURL", EXTRACTOR_METATYPE_URL },
+    { "WM/Language", EXTRACTOR_METATYPE_LANGUAGE },
+    { "WM/ISRC", EXTRACTOR_METATYPE_ISRC },
+    { "WM/OriginalAlbumTitle", EXTRACTOR_METATYPE_ORIGINAL_TITLE },
+    { "WM/OriginalArtist", EXTRACTOR_METATYPE_ORIGINAL_PERFORMER },
+    { "WM/Picture", EXTRACTOR_METATYPE_THUMBNAIL },
+    { NULL, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * Types of attribute values.
+ */
+enum ValueType
+{
+  /**
+   * UTF-16LE string.
+   */
+  VALUE_STRING = 0,
+
+  /**
+   * Byte array.
+   */
+  VALUE_BYTES = 1,
+
+  /**
+   * 32-bit boolean.
+   */
+  VALUE_BOOL = 2,
+
+  /**
+   * 32-bit integer.
+   */
+  VALUE_DWORD = 3,
+
+  /**
+   * 64-bit integer.
+   */
+  VALUE_QWORD = 4,
+
+  /**
+   * 16-bit integer.
+   */
+  VALUE_WORD = 5
+};
+
+
+/**
+ * Information about a stream.
+ */
+struct Stream
+{
+  /**
+   * 1 for audio, 2 for video.
+   */
+  int type;
+
+  /**
+   * Codec name (from the Codec List), NULL if not known.
+   */
+  char *codec_name;
+
+  /**
+   * Format tag (audio) or compression FOURCC (video).
+   */
+  uint32_t codec;
+
+  /**
+   * Video dimensions.
+   */
+  uint32_t width;
+  uint32_t height;
+
+  /**
+   * Audio properties.
+   */
+  unsigned int channels;
+  unsigned int sample_rate;
+  unsigned int bits;
+};
+
+
+/**
+ * Parser state.
+ */
+struct AsfContext
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Current offset in the file.
+   */
+  uint64_t pos;
+
+  /**
+   * Play duration in 100-nanosecond units (from File Properties).
+   */
+  uint64_t play_duration;
+
+  /**
+   * Preroll in milliseconds (from File Properties).
+   */
+  uint64_t preroll;
+
+  /**
+   * Creation date as FILETIME (from File Properties).
+   */
+  uint64_t creation_date;
+
+  /**
+   * Set if the file is a (live) broadcast and has no duration.
+   */
+  int broadcast;
+
+  /**
+   * Streams we found.
+   */
+  struct Stream streams[MAX_STREAMS];
+
+  /**
+   * Number of entries in @e streams.
+   */
+  unsigned int num_streams;
+
+  /**
+   * Codec names of the Codec List, by type (0 audio, 1 video).
+   */
+  char *codec_names[2][MAX_STREAMS];
+
+  /**
+   * Number of entries in @e codec_names.
+   */
+  unsigned int num_codec_names[2];
+};
+
+
+/**
+ * Give a string to the metadata processor.
+ *
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param str 0-terminated UTF-8 string
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_string (struct AsfContext *ctx,
+	    enum EXTRACTOR_MetaType type,
+	    const char *str)
+{
+  if ('\0' == str[0])
+    return 0;
+  return ctx->ec->proc (ctx->ec->cls,
+			"asf",
+			type,
+			EXTRACTOR_METAFORMAT_UTF8,
+			"text/plain",
+			str,
+			strlen (str) + 1);
+}
+
+
+/**
+ * Convert a UTF-16LE string to UTF-8.
+ *
+ * @param data the string (not necessarily 0-terminated)
+ * @param size number of bytes in @a data
+ * @return the string, NULL on error (or if it is empty)
+ */
+static char *
+convert_utf16 (const unsigned char *data,
+	       size_t size)
+{
+  size &= ~(size_t) 1;
+  /* strip trailing NULs */
+  while ( (size >= 2) &&
+	  (0 == data[size - 1]) &&
+	  (0 == data[size - 2]) )
+    size -= 2;
+  if (0 == size)
+    return NULL;
+  return EXTRACTOR_common_convert_to_utf8 ((const char *) data,
+					   size,
+					   "UTF-16LE");
+}
+
+
+/**
+ * Convert a UTF-16LE string and give it to the metadata processor.
+ *
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param data the string
+ * @param size number of bytes in @a data
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_utf16 (struct AsfContext *ctx,
+	   enum EXTRACTOR_MetaType type,
+	   const unsigned char *data,
+	   size_t size)
+{
+  char *str;
+  int ret;
+
+  if (NULL == (str = convert_utf16 (data, size)))
+    return 0;
+  ret = add_string (ctx, type, str);
+  free (str);
+  return ret;
+}
+
+
+/**
+ * Read exactly @a size bytes from the current position.
+ *
+ * @param ctx parser state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or short file)
+ */
+static int
+read_fully (struct AsfContext *ctx,
+	    void *buf,
+	    size_t size)
+{
+  unsigned char *dst = buf;
+  void *data;
+  ssize_t ret;
+  size_t done;
+
+  done = 0;
+  while (done < size)
+    {
+      if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, size - done)))
+	return -1;
+      memcpy (&dst[done], data, ret);
+      done += ret;
+      ctx->pos += ret;
+    }
+  return 0;
+}
+
+
+/**
+ * Move to the given absolute offset.
+ *
+ * @param ctx parser state
+ * @param pos target offset
+ * @return 0 on success, -1 on error
+ */
+static int
+seek_to (struct AsfContext *ctx,
+	 uint64_t pos)
+{
+  void *data;
+  ssize_t ret;
+
+  if (pos == ctx->pos)
+    return 0;
+  if ( (pos > ctx->pos) &&
+       (pos - ctx->pos <= MAX_SKIP_READ) )
+    {
+      while (ctx->pos < pos)
+	{
+	  if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, pos - ctx->pos)))
+	    return -1;
+	  ctx->pos += ret;
+	}
+      return 0;
+    }
+  if ( (pos > INT64_MAX) ||
+       ((int64_t) pos != ctx->ec->seek (ctx->ec->cls, (int64_t) pos, SEEK_SET)) )
+    return -1;
+  ctx->pos = pos;
+  return 0;
+}
+
+
+/**
+ * Get a 16-bit little endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint16_t
+get_le16 (const unsigned char *p)
+{
+  return (uint16_t) (p[0] | ((uint16_t) p[1] << 8));
+}
+
+
+/**
+ * Get a 32-bit little endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint32_t
+get_le32 (const unsigned char *p)
+{
+  return (uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+    ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+
+/**
+ * Get a 64-bit little endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint64_t
+get_le64 (const unsigned char *p)
+{
+  return (uint64_t) get_le32 (p) | ((uint64_t) get_le32 (&p[4]) << 32);
+}
+
+
+/**
+ * Parse the File Properties Object.
+ *
+ * @param ctx parser state
+ * @param data payload of the object
+ * @param size number of bytes in @a data
+ */
+static void
+parse_file_properties (struct AsfContext *ctx,
+		       const unsigned char *data,
+		       size_t size)
+{
+  /* file ID, file size, creation date, packet count, play duration,
+     send duration, preroll, flags */
+  if (size < 68)
+    return;
+  ctx->creation_date = get_le64 (&data[24]);
+  ctx->play_duration = get_le64 (&data[40]);
+  ctx->preroll = get_le64 (&data[56]);
+  ctx->broadcast = (0 != (get_le32 (&data[64]) & 0x01));
+}
+
+
+/**
+ * Parse a Stream Properties Object.
+ *
+ * @param ctx parser state
+ * @param data payload of the object
+ * @param size number of bytes in @a data
+ */
+static void
+parse_stream_properties (struct AsfContext *ctx,
+			 const unsigned char *data,
+			 size_t size)
+{
+  struct Stream *stream;
+  const unsigned char *ts;
+  uint32_t ts_size;
+
+  /* stream type, error correction type, time offset, type-specific
+     data length, error correction data length, flags, reserved */
+  if ( (size < 54) ||
+       (ctx->num_streams >= MAX_STREAMS) )
+    return;
+  ts_size = get_le32 (&data[40]);
+  if (ts_size > size - 54)
+    return;
+  ts = &data[54];
+  stream = &ctx->streams[ctx->num_streams];
+  memset (stream, 0, sizeof (struct Stream));
+  if (0 == memcmp (data, guid_audio_media, GUID_SIZE))
+    {
+      /* WAVEFORMATEX */
+      stream->type = 1;
+      if (ts_size >= 16)
+	{
+	  stream->codec = get_le16 (ts);
+	  stream->channels = get_le16 (&ts[2]);
+	  stream->sample_rate = get_le32 (&ts[4]);
+	  stream->bits = get_le16 (&ts[14]);
+	}
+    }
+  else if (0 == memcmp (data, guid_video_media, GUID_SIZE))
+    {
+      /* encoded width and height, flags, format data size, then a
+	 BITMAPINFOHEADER */
+      stream->type = 2;
+      if (ts_size >= 11)
+	{
+	  stream->width = get_le32 (ts);
+	  stream->height = get_le32 (&ts[4]);
+	}
+      if (ts_size >= 11 + 20)
+	stream->codec = get_le32 (&ts[11 + 16]);
+    }
+  else
+    return;
+  ctx->num_streams++;
+}
+
+
+/**
+ * Parse the Codec List Object.
+ *
+ * @param ctx parser state
+ * @param data payload of the object
+ * @param size number of bytes in @a data
+ */
+static void
+parse_codec_list (struct AsfContext *ctx,
+		  const unsigned char *data,
+		  size_t size)
+{
+  size_t off;
+  uint32_t count;
+  uint16_t type;
+  uint16_t len;
+  unsigned int idx;
+
+  /* reserved GUID, entry count */
+  if (size < 20)
+    return;
+  count = get_le32 (&data[16]);
+  off = 20;
+  while (count-- > 0)
+    {
+      /* type, name (length in characters), description, information */
+      if (size - off < 4)
+	return;
+      type = get_le16 (&data[off]);
+      len = get_le16 (&data[off + 2]);
+      off += 4;
+      if ((size - off) / 2 < len)
+	return;
+      idx = (2 == type) ? 0 : 1;
+      if ( ( (1 == type) ||
+	     (2 == type) ) &&
+	   (ctx->num_codec_names[idx] < MAX_STREAMS) )
+	ctx->codec_names[idx][ctx->num_codec_names[idx]++]
+	  = convert_utf16 (&data[off], 2 * (size_t) len);
+      off += 2 * (size_t) len;
+      if (size - off < 2)
+	return;
+      len = get_le16 (&data[off]);
+      off += 2;
+      if ((size - off) / 2 < len)
+	return;
+      off += 2 * (size_t) len;
+      if (size - off < 2)
+	return;
+      len = get_le16 (&data[off]);
+      off += 2;
+      if (size - off < len)
+	return;
+      off += len;
+    }
+}
+
+
+/**
+ * Parse the Content Description Object.
+ *
+ * @param ctx parser state
+ * @param data payload of the object
+ * @param size number of bytes in @a data
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+parse_content_description (struct AsfContext *ctx,
+			   const unsigned char *data,
+			   size_t size)
+{
+  static const enum EXTRACTOR_MetaType types[5] =
+    {
+      EXTRACTOR_METATYPE_TITLE,
+      EXTRACTOR_METATYPE_AUTHOR_NAME,
+      EXTRACTOR_METATYPE_COPYRIGHT,
+      EXTRACTOR_METATYPE_DESCRIPTION,
+      EXTRACTOR_METATYPE_RATING
+    };
+  size_t off;
+  uint16_t len;
+  unsigned int i;
+
+  /* five lengths, then the five strings */
+  if (size < 10)
+    return 0;
+  off = 10;
+  for (i = 0; i < 5; i++)
+    {
+      len = get_le16 (&data[2 * i]);
+      if (size - off < len)
+	return 0;
+      if (0 != add_utf16 (ctx, types[i], &data[off], len))
+	return 1;
+      off += len;
+    }
+  return 0;
+}
+
+
+/**
+ * Report the picture of a WM/Picture attribute.
+ *
+ * @param ctx parser state
+ * @param data the value
+ * @param size number of bytes in @a data
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_picture (struct AsfContext *ctx,
+		const unsigned char *data,
+		size_t size)
+{
+  char *mime;
+  uint32_t len;
+  size_t off;
+  size_t mime_end;
+  int ret;
+
+  /* picture type, data length, MIME type, description (both
+     0-terminated UTF-16LE), data */
+  if (size < 5)
+    return 0;
+  len = get_le32 (&data[1]);
+  off = 5;
+  mime_end = 0;
+  while (off + 1 < size)
+    {
+      off += 2;
+      if ( (0 == data[off - 2]) &&
+	   (0 == data[off - 1]) )
+	break;
+      mime_end = off;
+    }
+  while ( (off + 1 < size) &&
+	  ( (0 != data[off]) ||
+	    (0 != data[off + 1]) ) )
+    off += 2;
+  off += 2;
+  if ( (off > size) ||
+       (0 == len) ||
+       (len > size - off) )
+    return 0;
+  mime = (mime_end > 5) ? convert_utf16 (&data[5], mime_end - 5) : NULL;
+  ret = ctx->ec->proc (ctx->ec->cls,
+		       "asf",
+		       EXTRACTOR_METATYPE_THUMBNAIL,
+		       EXTRACTOR_METAFORMAT_BINARY,
+		       (NULL != mime) ? mime : "image/jpeg",
+		       (const char *) &data[off],
+		       len);
+  free (mime);
+  return ret;
+}
+
+
+/**
+ * Parse the Extended Content Description Object.
+ *
+ * @param ctx parser state
+ * @param data payload of the object
+ * @param size number of bytes in @a data
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+parse_extended_content_description (struct AsfContext *ctx,
+				    const unsigned char *data,
+				    size_t size)
+{
+  enum EXTRACTOR_MetaType type;
+  const unsigned char *value;
+  char *name;
+  char num[32];
+  size_t off;
+  uint16_t count;
+  uint16_t name_len;
+  uint16_t value_type;
+  uint16_t value_len;
+  unsigned int i;
+  int ret;
+
+  if (size < 2)
+    return 0;
+  count = get_le16 (data);
+  off = 2;
+  ret = 0;
+  while ( (0 == ret) &&
+	  (count-- > 0) )
+    {
+      /* name length, name, value type, value length, value */
+      if (size - off < 2)
+	return 0;
+      name_len = get_le16 (&data[off]);
+      off += 2;
+      if (size - off < (size_t) name_len + 4)
+	return 0;
+      name = convert_utf16 (&data[off], name_len);
+      off += name_len;
+      value_type = get_le16 (&data[off]);
+      value_len = get_le16 (&data[off + 2]);
+      off += 4;
+      if (size - off < value_len)
+	{
+	  free (name);
+	  return 0;
+	}
+      value = &data[off];
+      off += value_len;
+      if (NULL == name)
+	continue;
+      type = EXTRACTOR_METATYPE_RESERVED;
+      for (i = 0; NULL != attribute_map[i].name; i++)
+	if (0 == strcmp (name, attribute_map[i].name))
+	  type = attribute_map[i].type;
+      free (name);
+      if ( (EXTRACTOR_METATYPE_RESERVED == type) ||
+	   (! ctx->ec->wants (ctx->ec->cls, type)) )
+	continue;
+      switch (value_type)
+	{
+	case VALUE_STRING:
+	  ret = add_utf16 (ctx, type, value, value_len);
+	  break;
+	case VALUE_BYTES:
+	  if (EXTRACTOR_METATYPE_THUMBNAIL == type)
+	    ret = report_picture (ctx, value, value_len);
+	  break;
+	case VALUE_DWORD:
+	case VALUE_QWORD:
+	case VALUE_WORD:
+	  if ( (EXTRACTOR_METATYPE_THUMBNAIL == type) ||
+	       (value_len < ((VALUE_WORD == value_type) ? 2 : 4)) )
+	    break;
+	  snprintf (num,
+		    sizeof (num),
+		    "%llu",
+		    (VALUE_WORD == value_type)
+		    ? (unsigned long long) get_le16 (value)
+		    : ( ( (VALUE_QWORD == value_type) &&
+			  (value_len >= 8) )
+			? (unsigned long long) get_le64 (value)
+			: (unsigned long long) get_le32 (value) ));
+	  ret = add_string (ctx, type, num);
+	  break;
+	default:
+	  break;
+	}
+    }
+  return ret;
+}
+
+
+/**
+ * Report what we found in the File Properties and the streams.
+ *
+ * @param ctx parser state
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_streams (struct AsfContext *ctx)
+{
+  struct Stream *stream;
+  char format[256];
+  char codec[32];
+  char audio[64];
+  uint64_t seconds;
+  time_t t;
+  struct tm tm;
+  unsigned int seen[2];
+  unsigned int idx;
+  unsigned int i;
+  unsigned int j;
+
+  if ( (! ctx->broadcast) &&
+       (ctx->play_duration > 0) )
+    {
+      seconds = ctx->play_duration / 10000000;
+      if (seconds > ctx->preroll / 1000)
+	seconds -= ctx->preroll / 1000;
+      snprintf (format,
+		sizeof (format),
+		"%llus",
+		(unsigned long long) seconds);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_DURATION, format))
+	return 1;
+    }
+  if (ctx->creation_date > FILETIME_EPOCH_OFFSET)
+    {
+      t = (time_t) ((ctx->creation_date - FILETIME_EPOCH_OFFSET) / 10000000);
+      if ( (NULL != gmtime_r (&t, &tm)) &&
+	   (0 != strftime (format,
+			   sizeof (format),
+			   "%Y.%m.%d %H:%M:%S UTC",
+			   &tm)) &&
+	   (0 != add_string (ctx, EXTRACTOR_METATYPE_CREATION_DATE, format)) )
+	return 1;
+    }
+  seen[0] = 0;
+  seen[1] = 0;
+  for (i = 0; i < ctx->num_streams; i++)
+    {
+      stream = &ctx->streams[i];
+      /* the Codec List has one entry per stream, in order */
+      idx = (1 == stream->type) ? 0 : 1;
+      if (seen[idx] < ctx->num_codec_names[idx])
+	stream->codec_name = ctx->codec_names[idx][seen[idx]];
+      seen[idx]++;
+      if (2 == stream->type)
+	{
+	  if ( (0 != stream->width) &&
+	       (0 != stream->height) )
+	    {
+	      snprintf (format,
+			sizeof (format),
+			"%ux%u",
+			(unsigned int) stream->width,
+			(unsigned int) stream->height);
+	      if (0 != add_string (ctx, EXTRACTOR_METATYPE_IMAGE_DIMENSIONS, format))
+		return 1;
+	    }
+	  /* FOURCC, stored little endian */
+	  for (j = 0; j < 4; j++)
+	    {
+	      codec[j] = (char) (stream->codec >> (8 * j));
+	      if ( (codec[j] < 0x20) ||
+		   (codec[j] > 0x7E) )
+		codec[j] = '?';
+	    }
+	  codec[4] = '\0';
+	  audio[0] = '\0';
+	}
+      else
+	{
+	  snprintf (codec,
+		    sizeof (codec),
+		    "0x%04X",
+		    (unsigned int) stream->codec);
+	  audio[0] = '\0';
+	  if ( (0 != stream->channels) &&
+	       (0 != stream->sample_rate) )
+	    snprintf (audio,
+		      sizeof (audio),
+		      ", %u-channel %u-bit at %uHz",
+		      stream->channels,
+		      stream->bits,
+		      stream->sample_rate);
+	}
+      snprintf (format,
+		sizeof (format),
+		"%s track (%s%s%s%s%s)",
+		(1 == stream->type) ? "audio" : "video",
+		codec,
+		(NULL != stream->codec_name) ? " [" : "",
+		(NULL != stream->codec_name) ? stream->codec_name : "",
+		(NULL != stream->codec_name) ? "]" : "",
+		audio);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, format))
+	return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Walk the objects of the Header Object.
+ *
+ * @param ctx parser state, positioned after the Header Object header
+ * @param end offset of the end of the Header Object
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+parse_header_objects (struct AsfContext *ctx,
+		      uint64_t end)
+{
+  unsigned char hdr[OBJECT_HEADER_SIZE];
+  unsigned char *data;
+  uint64_t obj_start;
+  uint64_t obj_size;
+  size_t size;
+  unsigned int i;
+  int ret;
+
+  for (i = 0; i < MAX_OBJECTS; i++)
+    {
+      obj_start = ctx->pos;
+      if ( (end - obj_start < OBJECT_HEADER_SIZE) ||
+	   (0 != read_fully (ctx, hdr, sizeof (hdr))) )
+	return 0;
+      obj_size = get_le64 (&hdr[GUID_SIZE]);
+      if ( (obj_size < OBJECT_HEADER_SIZE) ||
+	   (obj_size > end - obj_start) )
+	return 0;
+      size = obj_size - OBJECT_HEADER_SIZE;
+      if ( ( (0 == memcmp (hdr, guid_file_properties, GUID_SIZE)) ||
+	     (0 == memcmp (hdr, guid_stream_properties, GUID_SIZE)) ||
+	     (0 == memcmp (hdr, guid_codec_list, GUID_SIZE)) ||
+	     (0 == memcmp (hdr, guid_content_description, GUID_SIZE)) ||
+	     (0 == memcmp (hdr, guid_extended_content_description, GUID_SIZE)) ) &&
+	   (size > 0) &&
+	   (size <= MAX_OBJECT_SIZE) &&
+	   (NULL != (data = malloc (size))) )
+	{
+	  ret = 0;
+	  if (0 != read_fully (ctx, data, size))
+	    {
+	      free (data);
+	      return 0;
+	    }
+	  if (0 == memcmp (hdr, guid_file_properties, GUID_SIZE))
+	    parse_file_properties (ctx, data, size);
+	  else if (0 == memcmp (hdr, guid_stream_properties, GUID_SIZE))
+	    parse_stream_properties (ctx, data, size);
+	  else if (0 == memcmp (hdr, guid_codec_list, GUID_SIZE))
+	    parse_codec_list (ctx, data, size);
+	  else if (0 == memcmp (hdr, guid_content_description, GUID_SIZE))
+	    ret = parse_content_description (ctx, data, size);
+	  else
+	    ret = parse_extended_content_description (ctx, data, size);
+	  free (data);
+	  if (0 != ret)
+	    return 1;
+	}
+      if (0 != seek_to (ctx, obj_start + obj_size))
+	return 0;
+    }
+  return 0;
+}
+
+
+/**
+ * Main entry method for the ASF extraction plugin.
+ *
+ * @param ec extraction context provided to the plugin
+ */
+void
+EXTRACTOR_asf_extract_method (struct EXTRACTOR_ExtractContext *ec)
+{
+  struct AsfContext ctx;
+  unsigned char hdr[HEADER_OBJECT_SIZE];
+  uint64_t header_size;
+  unsigned int i;
+  int supported;
+
+  if (NULL != ec->mime_hint)
+    {
+      supported = 0;
+      for (i = 0; NULL != mime_types[i]; i++)
+	if (0 == strcmp (ec->mime_hint, mime_types[i]))
+	  supported = 1;
+      if (! supported)
+	return;
+    }
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.ec = ec;
+  if ( (0 != read_fully (&ctx, hdr, sizeof (hdr))) ||
+       (0 != memcmp (hdr, guid_header, GUID_SIZE)) )
+    return;
+  header_size = get_le64 (&hdr[GUID_SIZE]);
+  if (header_size < HEADER_OBJECT_SIZE)
+    return;
+  if ( (0 == add_string (&ctx, EXTRACTOR_METATYPE_MIMETYPE, "video/x-ms-asf")) &&
+       (0 == parse_header_objects (&ctx, header_size)) )
+    (void) report_streams (&ctx);
+  for (i = 0; i < ctx.num_codec_names[0]; i++)
+    free (ctx.codec_names[0][i]);
+  for (i = 0; i < ctx.num_codec_names[1]; i++)
+    free (ctx.codec_names[1][i]);
+}
+
+/* end of asf_extractor.c */
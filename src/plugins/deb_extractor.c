@@ -22,10 +22,15 @@
  * @brief plugin to support Debian archives
  * @author Christian Grothoff
  *
- * The .deb is an ar-chive file.  It contains a tar.gz file
- * named "control.tar.gz" which then contains a file 'control'
- * that has the meta-data.  And which variant of the various
- * ar file formats is used is also not quite certain. Yuck.
+ * The .deb is an ar-chive file.  It contains a (usually compressed)
+ * tar file named "control.tar.gz" (or .xz, .zst or no suffix) which
+ * then contains a file 'control' that has the meta-data.  And which
+ * variant of the various ar file formats is used is also not quite
+ * certain. Yuck.
+ *
+ * The control tar is decompressed as a stream, and we stop as soon
+ * as we have found the 'control' file; the (large) data.tar member
+ * is never read.
  *
  * References:
  * http://www.mkssoftware.com/docs/man4/tar.4.asp
@@ -35,15 +40,43 @@
 #include "platform.h"
 #include "extractor.h"
 #include <zlib.h>
+#if HAVE_LIBLZMA
+#include <lzma.h>
+#endif
+#if HAVE_LIBZSTD
+#include <zstd.h>
+#endif
 
 
 /**
- * Maximum file size we allow for control.tar.gz files.
+ * Maximum file size we allow for the 'control' file.
  * This is a sanity check to avoid allocating huge amounts
  * of memory.
  */
 #define MAX_CONTROL_SIZE (1024 * 1024)
 
+/**
+ * Maximum number of bytes of the decompressed control tar
+ * we are willing to walk before giving up on finding 'control'.
+ */
+#define MAX_CONTROL_TAR_SIZE (16 * MAX_CONTROL_SIZE)
+
+/**
+ * Maximum amount of memory the xz decoder may use (xz -9 needs
+ * about 65 MB).
+ */
+#define MAX_XZ_MEMORY (128 * 1024 * 1024)
+
+/**
+ * Size of a block in a tar file.
+ */
+#define TAR_BLOCK_SIZE 512
+
+/**
+ * Maximum number of compressed bytes we read at once.
+ */
+#define READ_SIZE (32 * 1024)
+
 
 /**
  * Re-implementation of 'strndup'.
@@ -111,7 +144,7 @@ static struct Matches tmap[] = {
 
 
 /**
- * Process the "control" file from the control.tar.gz
+ * Process the "control" file from the control tar
  *
  * @param data decompressed control data
  * @param size number of bytes in data
@@ -135,9 +168,11 @@ processControl (const char *data,
   pos = 0;
   while (pos < size)
     {
-      for (colon = pos; ':' != data[colon]; colon++)
-	if ((colon > size) || ('\n' == data[colon]))
+      for (colon = pos; (colon < size) && (':' != data[colon]); colon++)
+	if ('\n' == data[colon])
 	  return 0;
+      if (colon >= size)
+	return 0;
       colon++;
       while ((colon < size) && (isspace ((unsigned char) data[colon])))
         colon++;
@@ -281,60 +316,444 @@ struct USTarHeader
 
 
 /**
- * Process the control.tar file.
+ * Compression methods for the control tar.
+ */
+enum Compression
+{
+  /**
+   * Plain tar file.
+   */
+  COMPRESSION_NONE,
+
+  /**
+   * gzip (zlib).
+   */
+  COMPRESSION_GZIP,
+
+#if HAVE_LIBLZMA
+  /**
+   * xz (liblzma).
+   */
+  COMPRESSION_XZ,
+#endif
+
+#if HAVE_LIBZSTD
+  /**
+   * zstd (libzstd).
+   */
+  COMPRESSION_ZSTD,
+#endif
+};
+
+
+/**
+ * Names of the control tar members we support.
+ */
+struct ControlMember
+{
+  /**
+   * Name of the member in the ar archive.
+   */
+  const char *name;
+
+  /**
+   * How the member is compressed.
+   */
+  enum Compression compression;
+};
+
+
+/**
+ * Control tar members we support.
+ */
+static const struct ControlMember control_members[] = {
+  { "control.tar.gz", COMPRESSION_GZIP },
+#if HAVE_LIBLZMA
+  { "control.tar.xz", COMPRESSION_XZ },
+#endif
+#if HAVE_LIBZSTD
+  { "control.tar.zst", COMPRESSION_ZSTD },
+#endif
+  { "control.tar", COMPRESSION_NONE },
+  { NULL, COMPRESSION_NONE }
+};
+
+
+/**
+ * Streaming reader for the (decompressed) control tar.
+ */
+struct ControlReader
+{
+  /**
+   * Extraction context to read the compressed data from.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Compressed data not yet consumed by the decompressor.
+   */
+  const unsigned char *in;
+
+  /**
+   * Number of bytes available at @e in.
+   */
+  size_t in_avail;
+
+  /**
+   * Number of bytes of the ar member we have not read yet.
+   */
+  uint64_t remaining;
+
+  /**
+   * How the member is compressed.
+   */
+  enum Compression compression;
+
+  /**
+   * Set once the decompressor has reached the end of the stream.
+   */
+  int eof;
+
+  /**
+   * zlib state (for #COMPRESSION_GZIP).
+   */
+  z_stream zstrm;
+
+#if HAVE_LIBLZMA
+  /**
+   * liblzma state (for #COMPRESSION_XZ).
+   */
+  lzma_stream xstrm;
+#endif
+
+#if HAVE_LIBZSTD
+  /**
+   * libzstd state (for #COMPRESSION_ZSTD).
+   */
+  ZSTD_DStream *zds;
+#endif
+};
+
+
+/**
+ * Initialize a reader for the control tar at the current
+ * read position.
  *
- * @param data the deflated control.tar file data
- * @param size number of bytes in data
- * @param proc function to call with meta data
- * @param proc_cls closure for 'proc'
- * @return 0 to continue extracting, 1 if we are done
+ * @param r reader to initialize
+ * @param ec extraction context with the control tar at the current read position
+ * @param size number of bytes in the ar member
+ * @param compression how the member is compressed
+ * @return 0 on success, -1 on error
  */
 static int
-processControlTar (const char *data,
+reader_init (struct ControlReader *r,
+	     struct EXTRACTOR_ExtractContext *ec,
+	     uint64_t size,
+	     enum Compression compression)
+{
+  memset (r, 0, sizeof (struct ControlReader));
+  r->ec = ec;
+  r->remaining = size;
+  r->compression = compression;
+  switch (compression)
+    {
+    case COMPRESSION_NONE:
+      return 0;
+    case COMPRESSION_GZIP:
+      if (Z_OK != inflateInit2 (&r->zstrm, 15 + 32))
+	return -1;
+      return 0;
+#if HAVE_LIBLZMA
+    case COMPRESSION_XZ:
+      {
+	lzma_stream init = LZMA_STREAM_INIT;
+
+	r->xstrm = init;
+	if (LZMA_OK != lzma_stream_decoder (&r->xstrm,
+					    MAX_XZ_MEMORY,
+					    0))
+	  return -1;
+	return 0;
+      }
+#endif
+#if HAVE_LIBZSTD
+    case COMPRESSION_ZSTD:
+      if (NULL == (r->zds = ZSTD_createDStream ()))
+	return -1;
+      if (ZSTD_isError (ZSTD_initDStream (r->zds)))
+	{
+	  ZSTD_freeDStream (r->zds);
+	  return -1;
+	}
+      return 0;
+#endif
+    }
+  return -1;
+}
+
+
+/**
+ * Release the resources of a reader.
+ *
+ * @param r reader to clean up
+ */
+static void
+reader_finish (struct ControlReader *r)
+{
+  switch (r->compression)
+    {
+    case COMPRESSION_NONE:
+      break;
+    case COMPRESSION_GZIP:
+      inflateEnd (&r->zstrm);
+      break;
+#if HAVE_LIBLZMA
+    case COMPRESSION_XZ:
+      lzma_end (&r->xstrm);
+      break;
+#endif
+#if HAVE_LIBZSTD
+    case COMPRESSION_ZSTD:
+      ZSTD_freeDStream (r->zds);
+      break;
+#endif
+    }
+}
+
+
+/**
+ * Decompress as much of the available input as fits into
+ * the given buffer.
+ *
+ * @param r reader to use
+ * @param buf where to store decompressed data
+ * @param size number of bytes available in @a buf
+ * @param produced set to the number of bytes stored in @a buf
+ * @return 0 on success, -1 on error
+ */
+static int
+reader_decompress (struct ControlReader *r,
+		   unsigned char *buf,
 		   size_t size,
-		   EXTRACTOR_MetaDataProcessor proc,
-		   void *proc_cls)
+		   size_t *produced)
 {
-  struct TarHeader *tar;
-  struct USTarHeader *ustar;
-  size_t pos;
+  *produced = 0;
+  switch (r->compression)
+    {
+    case COMPRESSION_NONE:
+      *produced = (size < r->in_avail) ? size : r->in_avail;
+      memcpy (buf, r->in, *produced);
+      r->in += *produced;
+      r->in_avail -= *produced;
+      if ( (0 == r->in_avail) &&
+	   (0 == r->remaining) )
+	r->eof = 1;
+      return 0;
+    case COMPRESSION_GZIP:
+      {
+	int ret;
+
+	r->zstrm.next_in = (Bytef *) r->in;
+	r->zstrm.avail_in = r->in_avail;
+	r->zstrm.next_out = (Bytef *) buf;
+	r->zstrm.avail_out = size;
+	ret = inflate (&r->zstrm, Z_NO_FLUSH);
+	r->in = r->zstrm.next_in;
+	r->in_avail = r->zstrm.avail_in;
+	*produced = size - r->zstrm.avail_out;
+	if (Z_STREAM_END == ret)
+	  r->eof = 1;
+	else if ( (Z_OK != ret) &&
+		  (Z_BUF_ERROR != ret) )
+	  return -1;
+	return 0;
+      }
+#if HAVE_LIBLZMA
+    case COMPRESSION_XZ:
+      {
+	lzma_ret ret;
+
+	r->xstrm.next_in = r->in;
+	r->xstrm.avail_in = r->in_avail;
+	r->xstrm.next_out = buf;
+	r->xstrm.avail_out = size;
+	ret = lzma_code (&r->xstrm, LZMA_RUN);
+	r->in = r->xstrm.next_in;
+	r->in_avail = r->xstrm.avail_in;
+	*produced = size - r->xstrm.avail_out;
+	if (LZMA_STREAM_END == ret)
+	  r->eof = 1;
+	else if ( (LZMA_OK != ret) &&
+		  (LZMA_BUF_ERROR != ret) )
+	  return -1;
+	return 0;
+      }
+#endif
+#if HAVE_LIBZSTD
+    case COMPRESSION_ZSTD:
+      {
+	ZSTD_inBuffer in = { r->in, r->in_avail, 0 };
+	ZSTD_outBuffer out = { buf, size, 0 };
+	size_t ret;
+
+	ret = ZSTD_decompressStream (r->zds, &out, &in);
+	if (ZSTD_isError (ret))
+	  return -1;
+	r->in += in.pos;
+	r->in_avail -= in.pos;
+	*produced = out.pos;
+	if (0 == ret)
+	  r->eof = 1;
+	return 0;
+      }
+#endif
+    }
+  return -1;
+}
 
-  pos = 0;
-  while (pos + sizeof (struct TarHeader) < size)
+
+/**
+ * Read decompressed data from the control tar.
+ *
+ * @param r reader to use
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 if @a size bytes were read, -1 on error or premature end of data
+ */
+static int
+reader_read (struct ControlReader *r,
+	     void *buf,
+	     size_t size)
+{
+  unsigned char *dst = buf;
+  size_t done;
+  size_t produced;
+  size_t in_before;
+  ssize_t sret;
+  void *data;
+
+  done = 0;
+  while (done < size)
     {
-      unsigned long long fsize;
-      char buf[13];
+      if (r->eof)
+	return -1;
+      if ( (0 == r->in_avail) &&
+	   (0 < r->remaining) )
+	{
+	  sret = r->ec->read (r->ec->cls,
+			      &data,
+			      (r->remaining < READ_SIZE)
+			      ? r->remaining
+			      : READ_SIZE);
+	  if (0 >= sret)
+	    return -1;
+	  r->in = data;
+	  r->in_avail = sret;
+	  r->remaining -= sret;
+	}
+      in_before = r->in_avail;
+      if (0 != reader_decompress (r, &dst[done], size - done, &produced))
+	return -1;
+      done += produced;
+      if ( (0 == produced) &&
+	   (in_before == r->in_avail) &&
+	   ( (0 < r->in_avail) ||
+	     (0 == r->remaining) ) )
+	return -1; /* no progress possible */
+    }
+  return 0;
+}
 
-      tar = (struct TarHeader *) & data[pos];
-      if (pos + sizeof (struct USTarHeader) < size)
-        {
-          ustar = (struct USTarHeader *) & data[pos];
-          if (0 == strncmp ("ustar", &ustar->magic[0], strlen ("ustar")))
-            pos += 512;         /* sizeof (struct USTarHeader); */
-          else
-            pos += 257;         /* sizeof (struct TarHeader); minus gcc alignment... */
-        }
-      else
-        {
-          pos += 257;           /* sizeof (struct TarHeader); minus gcc alignment... */
-        }
 
-      memcpy (buf, &tar->filesize[0], 12);
+/**
+ * Skip over decompressed data in the control tar.
+ *
+ * @param r reader to use
+ * @param size number of bytes to skip
+ * @return 0 on success, -1 on error or premature end of data
+ */
+static int
+reader_skip (struct ControlReader *r,
+	     uint64_t size)
+{
+  char buf[4 * TAR_BLOCK_SIZE];
+  size_t chunk;
+
+  while (size > 0)
+    {
+      chunk = (size < sizeof (buf)) ? size : sizeof (buf);
+      if (0 != reader_read (r, buf, chunk))
+	return -1;
+      size -= chunk;
+    }
+  return 0;
+}
+
+
+/**
+ * Walk the control tar until we find the 'control' file,
+ * and process it.
+ *
+ * @param r reader for the control tar
+ * @return 0 to continue extracting, 1 if we are done
+ */
+static int
+processControlTar (struct ControlReader *r)
+{
+  union
+  {
+    struct USTarHeader ustar;
+    char block[TAR_BLOCK_SIZE];
+  } hdr;
+  uint64_t pos;
+  unsigned long long fsize;
+  char buf[13];
+  const char *name;
+  size_t name_len;
+  char *data;
+  int ret;
+
+  pos = 0;
+  while (pos < MAX_CONTROL_TAR_SIZE)
+    {
+      if (0 != reader_read (r, hdr.block, TAR_BLOCK_SIZE))
+	return 0;
+      pos += TAR_BLOCK_SIZE;
+      if ('\0' == hdr.ustar.tar.name[0])
+	return 0; /* end of archive */
+      memcpy (buf, &hdr.ustar.tar.filesize[0], 12);
       buf[12] = '\0';
       if (1 != sscanf (buf, "%12llo", &fsize))  /* octal! Yuck yuck! */
         return 0;
-      if ((pos + fsize > size) || (fsize > size) || (pos + fsize < pos))
-        return 0;
-
-      if (0 == strncmp (&tar->name[0], "./control", strlen ("./control")))
-        {
+      name = hdr.ustar.tar.name;
+      name_len = sizeof (hdr.ustar.tar.name);
+      if (0 == strncmp (name, "./", 2))
+	{
+	  name += 2;
+	  name_len -= 2;
+	}
+      if ( (0 == strncmp (name, "control", name_len)) &&
+	   ( ('\0' == hdr.ustar.tar.link) ||
+	     ('0' == hdr.ustar.tar.link) ) )
+	{
 	  /* found the 'control' file we were looking for */
-          return processControl (&data[pos], fsize, proc, proc_cls);
-        }
-      if (0 != (fsize & 511))
-        fsize = (fsize | 511) + 1;      /* round up! */
-      if (pos + fsize < pos)
-        return 0;
+	  if ( (0 == fsize) ||
+	       (fsize > MAX_CONTROL_SIZE) )
+	    return 0;
+	  if (NULL == (data = malloc (fsize)))
+	    return 0;
+	  ret = 0;
+	  if (0 == reader_read (r, data, fsize))
+	    ret = processControl (data, fsize, r->ec->proc, r->ec->cls);
+	  free (data);
+	  return ret;
+	}
+      if (0 != (fsize & (TAR_BLOCK_SIZE - 1)))
+        fsize = (fsize | (TAR_BLOCK_SIZE - 1)) + 1;      /* round up! */
+      if (fsize > MAX_CONTROL_TAR_SIZE)
+	return 0;
+      if (0 != reader_skip (r, fsize))
+	return 0;
       pos += fsize;
     }
   return 0;
@@ -342,74 +761,58 @@ processControlTar (const char *data,
 
 
 /**
- * Process the control.tar.gz file.
+ * Process the control tar member of the archive.
  *
- * @param ec extractor context with control.tar.gz at current read position
- * @param size number of bytes in the control file
+ * @param ec extractor context with the control tar at current read position
+ * @param size number of bytes in the ar member
+ * @param compression how the member is compressed
  * @return 0 to continue extracting, 1 if we are done
  */
 static int
-processControlTGZ (struct EXTRACTOR_ExtractContext *ec,
-                   unsigned long long size)
+processControlMember (struct EXTRACTOR_ExtractContext *ec,
+		      unsigned long long size,
+		      enum Compression compression)
 {
-  uint32_t bufSize;
-  char *buf;
-  void *data;
-  unsigned char *cdata;
-  z_stream strm;
+  struct ControlReader r;
   int ret;
-  ssize_t sret;
-  unsigned long long off;
 
-  if (size > MAX_CONTROL_SIZE)
-    return 0;
   if (0 == size)
     return 0;
-  if (size < 4)
+  if (0 != reader_init (&r, ec, size, compression))
     return 0;
-  if (NULL == (cdata = malloc (size)))
-    return 0;
-  off = 0;
-  while (off < size)
-    {
-      if (0 >= (sret = ec->read (ec->cls, &data, size - off)))
-	{
-	  free (cdata);
-	  return 0;
-	}
-      memcpy (&cdata[off],
-              data,
-              sret);
-      off += sret;
-    }
-  bufSize = cdata[size - 4] + (cdata[size - 3] << 8) + (cdata[size - 2] << 16) + (cdata[size - 1] << 24);
-  if (bufSize > MAX_CONTROL_SIZE)
-    {
-      free (cdata);
-      return 0;
-    }
-  if (NULL == (buf = malloc (bufSize)))
-    {
-      free (cdata);
-      return 0;
-    }
-  ret = 0;
-  memset (&strm, 0, sizeof (z_stream));
-  strm.next_in = (Bytef *) data;
-  strm.avail_in = size;
-  if (Z_OK == inflateInit2 (&strm, 15 + 32))
+  ret = processControlTar (&r);
+  reader_finish (&r);
+  return ret;
+}
+
+
+/**
+ * Check if an ar member name refers to a control tar we support.
+ *
+ * @param name name field of the ar member header (not 0-terminated)
+ * @param name_len size of the name field
+ * @return NULL if this is not a (supported) control tar
+ */
+static const struct ControlMember *
+find_control_member (const char *name,
+		     size_t name_len)
+{
+  unsigned int i;
+  size_t len;
+
+  for (i = 0; NULL != control_members[i].name; i++)
     {
-      strm.next_out = (Bytef *) buf;
-      strm.avail_out = bufSize;
-      inflate (&strm, Z_FINISH);
-      if (strm.total_out > 0)
-	ret = processControlTar (buf, strm.total_out,
-				 ec->proc, ec->cls);
-      inflateEnd (&strm);
+      len = strlen (control_members[i].name);
+      if ( (len > name_len) ||
+	   (0 != strncmp (name, control_members[i].name, len)) )
+	continue;
+      /* the name is terminated by '/' (GNU) or padded with spaces */
+      if ( (len == name_len) ||
+	   ('/' == name[len]) ||
+	   (' ' == name[len]) )
+	return &control_members[i];
     }
-  free (buf);
-  free (cdata);
-  return ret;
+  return NULL;
 }
 
 
@@ -468,6 +871,7 @@ EXTRACTOR_deb_extract_method (struct EXTRACTOR_ExtractContext *ec)
   const struct ObjectHeader *hdr;
   uint64_t fsize;
   unsigned long long csize;
+  const struct ControlMember *cm;
   char buf[11];
   void *data;
 
@@ -498,12 +902,12 @@ EXTRACTOR_deb_extract_method (struct EXTRACTOR_ExtractContext *ec)
       pos += sizeof (struct ObjectHeader);
       if ((pos + csize > fsize) || (csize > fsize) || (pos + csize < pos))
         return;
-      if (0 == strncmp (&hdr->name[0],
-                        "control.tar.gz",
-			strlen ("control.tar.gz")))
+      if (NULL != (cm = find_control_member (&hdr->name[0],
+					      sizeof (hdr->name))))
         {
-	  if (0 != processControlTGZ (ec,
-				      csize))
+	  if (0 != processControlMember (ec,
+					 csize,
+					 cm->compression))
 	    return;
           done++;
         }
@@ -0,0 +1,1429 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file plugins/ebml_extractor.c
+ * @brief plugin to support Matroska and WebM files
+ *
+ * We only look at the EBML header and the Info, Tracks and Tags
+ * elements of the first segment.  The SeekHead tells us where
+ * those are, so we never have to walk over the Clusters (which
+ * hold the actual media and make up almost all of the file).
+ */
+#include "platform.h"
+#include "extractor.h"
+#include <stdint.h>
+#include <time.h>
+
+
+/**
+ * Maximum length of a string element we are willing to read.
+ */
+#define MAX_STRING_SIZE (64 * 1024)
+
+/**
+ * Maximum nesting depth of SimpleTag elements we follow.
+ */
+#define MAX_TAG_DEPTH 8
+
+/**
+ * Maximum number of SeekHead elements we follow.
+ */
+#define MAX_SEEK_HEADS 4
+
+/**
+ * Forward gaps up to this size are skipped by reading over them
+ * instead of seeking (the data is almost always already buffered).
+ */
+#define MAX_SKIP_READ 256
+
+/**
+ * Seconds between the UNIX epoch and the Matroska epoch
+ * (2001-01-01T00:00:00 UTC).
+ */
+#define MATROSKA_EPOCH 978307200LL
+
+/**
+ * Size value that marks an element of unknown size.
+ */
+#define UNKNOWN_SIZE UINT64_MAX
+
+/**
+ * EBML header elements.
+ */
+#define EBML_ID_HEADER 0x1A45DFA3
+#define EBML_ID_VERSION 0x4286
+#define EBML_ID_DOCTYPE 0x4282
+#define EBML_ID_DOCTYPEVERSION 0x4287
+
+/**
+ * Top-level Matroska elements.
+ */
+#define MKV_ID_SEGMENT 0x18538067
+#define MKV_ID_SEEKHEAD 0x114D9B74
+#define MKV_ID_INFO 0x1549A966
+#define MKV_ID_TRACKS 0x1654AE6B
+#define MKV_ID_TAGS 0x1254C367
+#define MKV_ID_CLUSTER 0x1F43B675
+
+/**
+ * Children of SeekHead.
+ */
+#define MKV_ID_SEEK 0x4DBB
+#define MKV_ID_SEEKID 0x53AB
+#define MKV_ID_SEEKPOSITION 0x53AC
+
+/**
+ * Children of Info.
+ */
+#define MKV_ID_TIMECODESCALE 0x2AD7B1
+#define MKV_ID_DURATION 0x4489
+#define MKV_ID_DATEUTC 0x4461
+#define MKV_ID_TITLE 0x7BA9
+#define MKV_ID_MUXINGAPP 0x4D80
+#define MKV_ID_WRITINGAPP 0x5741
+
+/**
+ * Children of Tracks.
+ */
+#define MKV_ID_TRACKENTRY 0xAE
+#define MKV_ID_TRACKTYPE 0x83
+#define MKV_ID_NAME 0x536E
+#define MKV_ID_LANGUAGE 0x22B59C
+#define MKV_ID_CODECID 0x86
+#define MKV_ID_CODECNAME 0x258688
+#define MKV_ID_VIDEO 0xE0
+#define MKV_ID_PIXELWIDTH 0xB0
+#define MKV_ID_PIXELHEIGHT 0xBA
+#define MKV_ID_AUDIO 0xE1
+#define MKV_ID_SAMPLINGFREQUENCY 0xB5
+#define MKV_ID_OUTPUTSAMPLINGFREQUENCY 0x78B5
+#define MKV_ID_CHANNELS 0x9F
+#define MKV_ID_BITDEPTH 0x6264
+
+/**
+ * Children of Tags.
+ */
+#define MKV_ID_TAG 0x7373
+#define MKV_ID_SIMPLETAG 0x67C8
+#define MKV_ID_TAGNAME 0x45A3
+#define MKV_ID_TAGSTRING 0x4487
+
+
+/**
+ * Mapping of DocTypes to MIME types.
+ */
+struct DocType
+{
+  /**
+   * DocType as given in the EBML header.
+   */
+  const char *doctype;
+
+  /**
+   * Corresponding MIME type.
+   */
+  const char *mime;
+};
+
+
+/**
+ * DocTypes we support.
+ */
+static const struct DocType doc_types[] =
+  {
+    { "matroska", "video/x-matroska" },
+    { "webm", "video/webm" },
+    { NULL, NULL }
+  };
+
+
+/**
+ * Mapping of track type codes to names.
+ */
+struct TrackType
+{
+  /**
+   * Value of the TrackType element.
+   */
+  uint64_t code;
+
+  /**
+   * Human-readable name of the type.
+   */
+  const char *name;
+};
+
+
+/**
+ * Track types defined by Matroska.
+ */
+static const struct TrackType track_types[] =
+  {
+    { 0x01, "video" },
+    { 0x02, "audio" },
+    { 0x03, "complex" },
+    { 0x10, "logo" },
+    { 0x11, "subtitle" },
+    { 0x12, "buttons" },
+    { 0x20, "control" },
+    { 0, NULL }
+  };
+
+
+/**
+ * Mapping of SimpleTag names to LE types.
+ */
+struct TagMap
+{
+  /**
+   * TagName as used by Matroska.
+   */
+  const char *name;
+
+  /**
+   * Corresponding LE type.
+   */
+  enum EXTRACTOR_MetaType type;
+};
+
+
+/**
+ * Tag names we know how to map.  Everything else is reported
+ * as "NAME=value" of unknown type.
+ */
+static const struct TagMap tag_map[] =
+  {
+    { "COUNTRY", EXTRACTOR_METATYPE_LOCATION_COUNTRY_CODE },
+    { "TITLE", EXTRACTOR_METATYPE_TITLE },
+    { "SUBTITLE", EXTRACTOR_METATYPE_SUBTITLE },
+    { "URL", EXTRACTOR_METATYPE_URL },
+    { "ARTIST", EXTRACTOR_METATYPE_ARTIST },
+    { "LEAD_PERFORMER", EXTRACTOR_METATYPE_PERFORMER },
+    { "ACCOMPANIMENT", EXTRACTOR_METATYPE_MUSICIAN_CREDITS_LIST },
+    { "COMPOSER", EXTRACTOR_METATYPE_COMPOSER },
+    { "LYRICS", EXTRACTOR_METATYPE_LYRICS },
+    { "CONDUCTOR", EXTRACTOR_METATYPE_CONDUCTOR },
+    { "WRITTEN_BY", EXTRACTOR_METATYPE_WRITER },
+    { "ENCODED_BY", EXTRACTOR_METATYPE_ENCODED_BY },
+    { "PUBLISHER", EXTRACTOR_METATYPE_PUBLISHER },
+    { "GENRE", EXTRACTOR_METATYPE_GENRE },
+    { "MOOD", EXTRACTOR_METATYPE_MOOD },
+    { "SUBJECT", EXTRACTOR_METATYPE_SUBJECT },
+    { "DESCRIPTION", EXTRACTOR_METATYPE_DESCRIPTION },
+    { "KEYWORDS", EXTRACTOR_METATYPE_KEYWORDS },
+    { "SUMMARY", EXTRACTOR_METATYPE_SUMMARY },
+    { "DATE_RELEASED", EXTRACTOR_METATYPE_PUBLICATION_DATE },
+    { "DATE_RECORDED", EXTRACTOR_METATYPE_CREATION_DATE },
+    { "DATE_ENCODED", EXTRACTOR_METATYPE_UNKNOWN_DATE },
+    { "DATE_TAGGED", EXTRACTOR_METATYPE_UNKNOWN_DATE },
+    { "DATE_DIGITIZED", EXTRACTOR_METATYPE_UNKNOWN_DATE },
+    { "DATE_WRITTEN", EXTRACTOR_METATYPE_UNKNOWN_DATE },
+    { "DATE_PURCHASED", EXTRACTOR_METATYPE_UNKNOWN_DATE },
+    { "COMMENT", EXTRACTOR_METATYPE_COMMENT },
+    { "PLAY_COUNTER", EXTRACTOR_METATYPE_PLAY_COUNTER },
+    { "RATING", EXTRACTOR_METATYPE_POPULARITY_METER },
+    { "BPM", EXTRACTOR_METATYPE_BEATS_PER_MINUTE },
+    { "ISRC", EXTRACTOR_METATYPE_ISRC },
+    { NULL, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * Header of an EBML element.
+ */
+struct Element
+{
+  /**
+   * Element ID (including the length marker bits).
+   */
+  uint32_t id;
+
+  /**
+   * Size of the element's payload, #UNKNOWN_SIZE if not given.
+   */
+  uint64_t size;
+
+  /**
+   * Offset of the payload in the file.
+   */
+  uint64_t start;
+
+  /**
+   * Offset of the first byte after the payload (or the end of
+   * the parent if the size is unknown).
+   */
+  uint64_t end;
+};
+
+
+/**
+ * Parser state.
+ */
+struct EbmlContext
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Current offset in the file.
+   */
+  uint64_t pos;
+
+  /**
+   * Offset of the payload of the segment.
+   */
+  uint64_t segment_start;
+
+  /**
+   * Offset of the first byte after the segment.
+   */
+  uint64_t segment_end;
+
+  /**
+   * Offsets of Info, Tracks and Tags as given by the SeekHead
+   * (relative to @e segment_start), UINT64_MAX if unknown.
+   */
+  uint64_t info_pos;
+  uint64_t tracks_pos;
+  uint64_t tags_pos;
+
+  /**
+   * Set once we have processed the respective element.
+   */
+  int have_info;
+  int have_tracks;
+  int have_tags;
+
+  /**
+   * Number of SeekHeads processed so far.
+   */
+  unsigned int seek_heads;
+};
+
+
+/**
+ * Give a string to the metadata processor.
+ *
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param str 0-terminated UTF-8 string
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_string (struct EbmlContext *ctx,
+	    enum EXTRACTOR_MetaType type,
+	    const char *str)
+{
+  if ('\0' == str[0])
+    return 0;
+  return ctx->ec->proc (ctx->ec->cls,
+			"ebml",
+			type,
+			EXTRACTOR_METAFORMAT_UTF8,
+			"text/plain",
+			str,
+			strlen (str) + 1);
+}
+
+
+/**
+ * Read exactly @a size bytes from the current position.
+ *
+ * @param ctx parser state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or short file)
+ */
+static int
+read_fully (struct EbmlContext *ctx,
+	    void *buf,
+	    size_t size)
+{
+  unsigned char *dst = buf;
+  void *data;
+  ssize_t ret;
+  size_t done;
+
+  done = 0;
+  while (done < size)
+    {
+      if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, size - done)))
+	return -1;
+      memcpy (&dst[done], data, ret);
+      done += ret;
+    }
+  ctx->pos += size;
+  return 0;
+}
+
+
+/**
+ * Move to the given absolute offset.
+ *
+ * @param ctx parser state
+ * @param pos target offset
+ * @return 0 on success, -1 on error
+ */
+static int
+seek_to (struct EbmlContext *ctx,
+	 uint64_t pos)
+{
+  void *data;
+  ssize_t ret;
+
+  if (pos == ctx->pos)
+    return 0;
+  if ( (pos > ctx->pos) &&
+       (pos - ctx->pos <= MAX_SKIP_READ) )
+    {
+      while (ctx->pos < pos)
+	{
+	  if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, pos - ctx->pos)))
+	    return -1;
+	  ctx->pos += ret;
+	}
+      return 0;
+    }
+  if ( (pos > INT64_MAX) ||
+       ((int64_t) pos != ctx->ec->seek (ctx->ec->cls, (int64_t) pos, SEEK_SET)) )
+    return -1;
+  ctx->pos = pos;
+  return 0;
+}
+
+
+/**
+ * Read a variable-length integer.
+ *
+ * @param ctx parser state
+ * @param max_len maximum encoded length we accept (4 for IDs, 8 for sizes)
+ * @param keep_marker non-zero to keep the length marker bit (for IDs)
+ * @param value set to the value read; #UNKNOWN_SIZE if all
+ *        value bits are set and @a keep_marker is zero
+ * @return 0 on success, -1 on error
+ */
+static int
+read_vint (struct EbmlContext *ctx,
+	   unsigned int max_len,
+	   int keep_marker,
+	   uint64_t *value)
+{
+  unsigned char buf[8];
+  unsigned int len;
+  unsigned int i;
+  uint64_t v;
+  uint64_t all_ones;
+
+  if (0 != read_fully (ctx, buf, 1))
+    return -1;
+  for (len = 1; len <= max_len; len++)
+    if (0 != (buf[0] & (0x80 >> (len - 1))))
+      break;
+  if (len > max_len)
+    return -1;
+  if ( (len > 1) &&
+       (0 != read_fully (ctx, &buf[1], len - 1)) )
+    return -1;
+  v = keep_marker ? buf[0] : (buf[0] & (0xFF >> len));
+  for (i = 1; i < len; i++)
+    v = (v << 8) | buf[i];
+  if (! keep_marker)
+    {
+      all_ones = (((uint64_t) 1) << (7 * len)) - 1;
+      if (v == all_ones)
+	v = UNKNOWN_SIZE;
+    }
+  *value = v;
+  return 0;
+}
+
+
+/**
+ * Read the header of the element at the current position.
+ *
+ * @param ctx parser state
+ * @param parent_end end of the enclosing element
+ * @param el set to the element's header
+ * @return 0 on success, -1 on error
+ */
+static int
+read_element (struct EbmlContext *ctx,
+	      uint64_t parent_end,
+	      struct Element *el)
+{
+  uint64_t id;
+
+  if (0 != read_vint (ctx, 4, 1, &id))
+    return -1;
+  if (0 != read_vint (ctx, 8, 0, &el->size))
+    return -1;
+  el->id = (uint32_t) id;
+  el->start = ctx->pos;
+  if (UNKNOWN_SIZE == el->size)
+    {
+      el->end = parent_end;
+      return 0;
+    }
+  if ( (el->start > parent_end) ||
+       (el->size > parent_end - el->start) )
+    return -1;
+  el->end = el->start + el->size;
+  return 0;
+}
+
+
+/**
+ * Read the payload of an unsigned integer element.
+ *
+ * @param ctx parser state
+ * @param el the element
+ * @param value set to the value
+ * @return 0 on success, -1 on error
+ */
+static int
+read_uint (struct EbmlContext *ctx,
+	   const struct Element *el,
+	   uint64_t *value)
+{
+  unsigned char buf[8];
+  uint64_t v;
+  unsigned int i;
+
+  if (el->size > sizeof (buf))
+    return -1;
+  if (0 != read_fully (ctx, buf, el->size))
+    return -1;
+  v = 0;
+  for (i = 0; i < el->size; i++)
+    v = (v << 8) | buf[i];
+  *value = v;
+  return 0;
+}
+
+
+/**
+ * Read the payload of a floating point element.
+ *
+ * @param ctx parser state
+ * @param el the element
+ * @param value set to the value
+ * @return 0 on success, -1 on error
+ */
+static int
+read_float (struct EbmlContext *ctx,
+	    const struct Element *el,
+	    double *value)
+{
+  uint64_t bits;
+  uint32_t bits32;
+  float f;
+  double d;
+
+  if ( (4 != el->size) &&
+       (8 != el->size) )
+    return -1;
+  if (0 != read_uint (ctx, el, &bits))
+    return -1;
+  if (4 == el->size)
+    {
+      bits32 = (uint32_t) bits;
+      memcpy (&f, &bits32, sizeof (f));
+      *value = f;
+    }
+  else
+    {
+      memcpy (&d, &bits, sizeof (d));
+      *value = d;
+    }
+  return 0;
+}
+
+
+/**
+ * Read the payload of a string element.  Strings may be
+ * padded with NUL bytes, the result is always 0-terminated.
+ *
+ * @param ctx parser state
+ * @param el the element
+ * @return the string (to be freed by the caller), NULL on error
+ *         or if the string is too long
+ */
+static char *
+read_string (struct EbmlContext *ctx,
+	     const struct Element *el)
+{
+  char *str;
+
+  if (el->size > MAX_STRING_SIZE)
+    return NULL;
+  if (NULL == (str = malloc (el->size + 1)))
+    return NULL;
+  if (0 != read_fully (ctx, str, el->size))
+    {
+      free (str);
+      return NULL;
+    }
+  str[el->size] = '\0';
+  return str;
+}
+
+
+/**
+ * Replace a string with a newly read one.
+ *
+ * @param ctx parser state
+ * @param el the string element
+ * @param str string to replace
+ * @return 0 on success, -1 on error
+ */
+static int
+replace_string (struct EbmlContext *ctx,
+		const struct Element *el,
+		char **str)
+{
+  char *s;
+
+  if (NULL == (s = read_string (ctx, el)))
+    return (el->size > MAX_STRING_SIZE) ? seek_to (ctx, el->end) : -1;
+  free (*str);
+  *str = s;
+  return 0;
+}
+
+
+/**
+ * Parse the EBML header at the beginning of the file.
+ *
+ * @param ctx parser state
+ * @return 0 on success, -1 if this is not a Matroska or WebM file
+ *         (or if extraction was aborted)
+ */
+static int
+parse_header (struct EbmlContext *ctx)
+{
+  struct Element hdr;
+  struct Element el;
+  uint64_t version = 1;
+  uint64_t doctype_version = 1;
+  char *doctype = NULL;
+  char format[256];
+  unsigned int i;
+
+  if ( (0 != read_element (ctx, UINT64_MAX, &hdr)) ||
+       (EBML_ID_HEADER != hdr.id) ||
+       (UNKNOWN_SIZE == hdr.size) )
+    return -1;
+  while (ctx->pos < hdr.end)
+    {
+      if (0 != read_element (ctx, hdr.end, &el))
+	goto ERROR;
+      switch (el.id)
+	{
+	case EBML_ID_VERSION:
+	  if (0 != read_uint (ctx, &el, &version))
+	    goto ERROR;
+	  break;
+	case EBML_ID_DOCTYPEVERSION:
+	  if (0 != read_uint (ctx, &el, &doctype_version))
+	    goto ERROR;
+	  break;
+	case EBML_ID_DOCTYPE:
+	  if (0 != replace_string (ctx, &el, &doctype))
+	    goto ERROR;
+	  break;
+	}
+      if (0 != seek_to (ctx, el.end))
+	goto ERROR;
+    }
+  if (NULL == doctype)
+    return -1;
+  for (i = 0; NULL != doc_types[i].doctype; i++)
+    if (0 == strcmp (doctype, doc_types[i].doctype))
+      break;
+  if (NULL == doc_types[i].doctype)
+    goto ERROR;
+  if (0 != add_string (ctx, EXTRACTOR_METATYPE_MIMETYPE, doc_types[i].mime))
+    goto ERROR;
+  snprintf (format,
+	    sizeof (format),
+	    "%llu",
+	    (unsigned long long) version);
+  if (0 != add_string (ctx, EXTRACTOR_METATYPE_FORMAT_VERSION, format))
+    goto ERROR;
+  snprintf (format,
+	    sizeof (format),
+	    "%s %llu (EBML %llu)",
+	    doctype,
+	    (unsigned long long) doctype_version,
+	    (unsigned long long) version);
+  if (0 != add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, format))
+    goto ERROR;
+  free (doctype);
+  return 0;
+ ERROR:
+  free (doctype);
+  return -1;
+}
+
+
+/**
+ * Parse a SeekHead and remember where Info, Tracks and Tags are.
+ *
+ * @param ctx parser state
+ * @param seekhead the SeekHead element
+ * @return 0 on success, -1 on error
+ */
+static int
+parse_seek_head (struct EbmlContext *ctx,
+		 const struct Element *seekhead)
+{
+  struct Element seek;
+  struct Element el;
+  uint64_t id;
+  uint64_t pos;
+
+  ctx->seek_heads++;
+  while (ctx->pos < seekhead->end)
+    {
+      if (0 != read_element (ctx, seekhead->end, &seek))
+	return -1;
+      if (MKV_ID_SEEK != seek.id)
+	{
+	  if (0 != seek_to (ctx, seek.end))
+	    return -1;
+	  continue;
+	}
+      id = 0;
+      pos = UINT64_MAX;
+      while (ctx->pos < seek.end)
+	{
+	  if (0 != read_element (ctx, seek.end, &el))
+	    return -1;
+	  if ( (MKV_ID_SEEKID == el.id) &&
+	       (0 != read_uint (ctx, &el, &id)) )
+	    return -1;
+	  if ( (MKV_ID_SEEKPOSITION == el.id) &&
+	       (0 != read_uint (ctx, &el, &pos)) )
+	    return -1;
+	  if (0 != seek_to (ctx, el.end))
+	    return -1;
+	}
+      switch (id)
+	{
+	case MKV_ID_INFO:
+	  ctx->info_pos = pos;
+	  break;
+	case MKV_ID_TRACKS:
+	  ctx->tracks_pos = pos;
+	  break;
+	case MKV_ID_TAGS:
+	  ctx->tags_pos = pos;
+	  break;
+	}
+    }
+  return 0;
+}
+
+
+/**
+ * Parse the segment Info and report title, duration, date
+ * and the applications that wrote the file.
+ *
+ * @param ctx parser state
+ * @param info the Info element
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_info (struct EbmlContext *ctx,
+	    const struct Element *info)
+{
+  struct Element el;
+  uint64_t timecode_scale = 1000000;
+  double duration = -1.0;
+  double seconds;
+  int64_t date = 0;
+  int have_date = 0;
+  uint64_t udate;
+  char *title = NULL;
+  char *muxing_app = NULL;
+  char *writing_app = NULL;
+  char format[128];
+  char *apps;
+  size_t slen;
+  struct tm tm;
+  time_t t;
+  int ret;
+
+  ctx->have_info = 1;
+  ret = -1;
+  while (ctx->pos < info->end)
+    {
+      if (0 != read_element (ctx, info->end, &el))
+	goto CLEANUP;
+      switch (el.id)
+	{
+	case MKV_ID_TIMECODESCALE:
+	  if (0 != read_uint (ctx, &el, &timecode_scale))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_DURATION:
+	  if (0 != read_float (ctx, &el, &duration))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_DATEUTC:
+	  if ( (8 != el.size) ||
+	       (0 != read_uint (ctx, &el, &udate)) )
+	    goto CLEANUP;
+	  date = (int64_t) udate;
+	  have_date = 1;
+	  break;
+	case MKV_ID_TITLE:
+	  if (0 != replace_string (ctx, &el, &title))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_MUXINGAPP:
+	  if (0 != replace_string (ctx, &el, &muxing_app))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_WRITINGAPP:
+	  if (0 != replace_string (ctx, &el, &writing_app))
+	    goto CLEANUP;
+	  break;
+	}
+      if (0 != seek_to (ctx, el.end))
+	goto CLEANUP;
+    }
+  ret = 1;
+  seconds = duration * timecode_scale / 1e9;
+  if ( (seconds > 0) &&
+       (seconds < 1e15) )
+    {
+      snprintf (format,
+		sizeof (format),
+		"%llus",
+		(unsigned long long) seconds);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_DURATION, format))
+	goto CLEANUP;
+    }
+  if (have_date)
+    {
+      t = (time_t) (MATROSKA_EPOCH + date / 1000000000LL);
+      if ( (NULL != gmtime_r (&t, &tm)) &&
+	   (0 != strftime (format,
+			   sizeof (format),
+			   "%Y.%m.%d %H:%M:%S UTC",
+			   &tm)) &&
+	   (0 != add_string (ctx, EXTRACTOR_METATYPE_CREATION_DATE, format)) )
+	goto CLEANUP;
+    }
+  if ( (NULL != title) &&
+       (0 != add_string (ctx, EXTRACTOR_METATYPE_TITLE, title)) )
+    goto CLEANUP;
+  if ( (NULL != writing_app) &&
+       (NULL != muxing_app) )
+    {
+      slen = strlen (writing_app) + strlen (muxing_app) + 64;
+      if (NULL == (apps = malloc (slen)))
+	goto CLEANUP;
+      if (0 == strcmp (writing_app, muxing_app))
+	snprintf (apps,
+		  slen,
+		  "Written and muxed with %s",
+		  writing_app);
+      else
+	snprintf (apps,
+		  slen,
+		  "Written with %s, muxed with %s",
+		  writing_app,
+		  muxing_app);
+      ret = add_string (ctx, EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE, apps);
+      free (apps);
+      if (0 != ret)
+	goto CLEANUP;
+    }
+  ret = 0;
+ CLEANUP:
+  free (title);
+  free (muxing_app);
+  free (writing_app);
+  return ret;
+}
+
+
+/**
+ * Information about a track.
+ */
+struct Track
+{
+  /**
+   * Name of the track, NULL if not given.
+   */
+  char *name;
+
+  /**
+   * Language of the track, NULL for the default ("eng").
+   */
+  char *language;
+
+  /**
+   * Codec identifier, NULL if not given.
+   */
+  char *codec_id;
+
+  /**
+   * Human-readable codec name, NULL if not given.
+   */
+  char *codec_name;
+
+  /**
+   * Track type code.
+   */
+  uint64_t type;
+
+  /**
+   * Dimensions of a video track.
+   */
+  uint64_t pixel_width;
+  uint64_t pixel_height;
+
+  /**
+   * Number of channels of an audio track.
+   */
+  uint64_t channels;
+
+  /**
+   * Bits per sample of an audio track, 0 if not given.
+   */
+  uint64_t bit_depth;
+
+  /**
+   * Sampling frequencies of an audio track.
+   */
+  double sampling_frequency;
+  double output_sampling_frequency;
+};
+
+
+/**
+ * Parse the Video or Audio settings of a track.
+ *
+ * @param ctx parser state
+ * @param settings the Video or Audio element
+ * @param track track to update
+ * @return 0 on success, -1 on error
+ */
+static int
+parse_track_settings (struct EbmlContext *ctx,
+		      const struct Element *settings,
+		      struct Track *track)
+{
+  struct Element el;
+  int ret;
+
+  while (ctx->pos < settings->end)
+    {
+      if (0 != read_element (ctx, settings->end, &el))
+	return -1;
+      ret = 0;
+      switch (el.id)
+	{
+	case MKV_ID_PIXELWIDTH:
+	  ret = read_uint (ctx, &el, &track->pixel_width);
+	  break;
+	case MKV_ID_PIXELHEIGHT:
+	  ret = read_uint (ctx, &el, &track->pixel_height);
+	  break;
+	case MKV_ID_CHANNELS:
+	  ret = read_uint (ctx, &el, &track->channels);
+	  break;
+	case MKV_ID_BITDEPTH:
+	  ret = read_uint (ctx, &el, &track->bit_depth);
+	  break;
+	case MKV_ID_SAMPLINGFREQUENCY:
+	  ret = read_float (ctx, &el, &track->sampling_frequency);
+	  break;
+	case MKV_ID_OUTPUTSAMPLINGFREQUENCY:
+	  ret = read_float (ctx, &el, &track->output_sampling_frequency);
+	  break;
+	}
+      if ( (0 != ret) ||
+	   (0 != seek_to (ctx, el.end)) )
+	return -1;
+    }
+  return 0;
+}
+
+
+/**
+ * Report a track.
+ *
+ * @param ctx parser state
+ * @param track the track
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_track (struct EbmlContext *ctx,
+	      const struct Track *track)
+{
+  char *format;
+  char dims[64];
+  char hz[64];
+  char bits[32];
+  char audio[160];
+  const char *type_name;
+  const char *name;
+  const char *codec_name;
+  const char *language;
+  size_t slen;
+  unsigned int i;
+  int ret;
+
+  if ( (0 == track->type) ||
+       (NULL == track->codec_id) )
+    return 0;
+  type_name = "unknown";
+  for (i = 0; NULL != track_types[i].name; i++)
+    if (track->type == track_types[i].code)
+      type_name = track_types[i].name;
+  name = (NULL != track->name) ? track->name : "";
+  codec_name = (NULL != track->codec_name) ? track->codec_name : "";
+  language = (NULL != track->language) ? track->language : "eng";
+  if ( (0x01 == track->type) &&
+       (0 != track->pixel_width) &&
+       (0 != track->pixel_height) )
+    {
+      snprintf (dims,
+		sizeof (dims),
+		"%llux%llu",
+		(unsigned long long) track->pixel_width,
+		(unsigned long long) track->pixel_height);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_IMAGE_DIMENSIONS, dims))
+	return 1;
+    }
+  audio[0] = '\0';
+  if ( (0x02 == track->type) &&
+       (track->sampling_frequency > 0) &&
+       (0 != track->channels) )
+    {
+      if ( (track->output_sampling_frequency > 0) &&
+	   (track->output_sampling_frequency != track->sampling_frequency) )
+	snprintf (hz,
+		  sizeof (hz),
+		  "%.0fHz (%.0fHz SBR)",
+		  track->sampling_frequency,
+		  track->output_sampling_frequency);
+      else
+	snprintf (hz,
+		  sizeof (hz),
+		  "%.0fHz",
+		  track->sampling_frequency);
+      if (0 != track->bit_depth)
+	snprintf (bits,
+		  sizeof (bits),
+		  "%llu-bit ",
+		  (unsigned long long) track->bit_depth);
+      else
+	bits[0] = '\0';
+      snprintf (audio,
+		sizeof (audio),
+		", %llu-channel %sat %s",
+		(unsigned long long) track->channels,
+		bits,
+		hz);
+    }
+  slen = strlen (type_name) + strlen (name) + strlen (track->codec_id)
+    + strlen (codec_name) + strlen (audio) + strlen (language) + 32;
+  if (NULL == (format = malloc (slen)))
+    return 0;
+  snprintf (format,
+	    slen,
+	    "%s track %s%s%s(%s%s%s%s%s) [%s]",
+	    type_name,
+	    ('\0' != name[0]) ? "`" : "",
+	    name,
+	    ('\0' != name[0]) ? "' " : "",
+	    track->codec_id,
+	    ('\0' != codec_name[0]) ? " [" : "",
+	    codec_name,
+	    ('\0' != codec_name[0]) ? "]" : "",
+	    audio,
+	    language);
+  ret = add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, format);
+  free (format);
+  return ret;
+}
+
+
+/**
+ * Parse a TrackEntry and report it.
+ *
+ * @param ctx parser state
+ * @param entry the TrackEntry element
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_track_entry (struct EbmlContext *ctx,
+		   const struct Element *entry)
+{
+  struct Element el;
+  struct Track track;
+  int ret;
+
+  memset (&track, 0, sizeof (track));
+  track.channels = 1;
+  ret = -1;
+  while (ctx->pos < entry->end)
+    {
+      if (0 != read_element (ctx, entry->end, &el))
+	goto CLEANUP;
+      switch (el.id)
+	{
+	case MKV_ID_TRACKTYPE:
+	  if (0 != read_uint (ctx, &el, &track.type))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_NAME:
+	  if (0 != replace_string (ctx, &el, &track.name))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_LANGUAGE:
+	  if (0 != replace_string (ctx, &el, &track.language))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_CODECID:
+	  if (0 != replace_string (ctx, &el, &track.codec_id))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_CODECNAME:
+	  if (0 != replace_string (ctx, &el, &track.codec_name))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_VIDEO:
+	case MKV_ID_AUDIO:
+	  if (0 != parse_track_settings (ctx, &el, &track))
+	    goto CLEANUP;
+	  break;
+	}
+      if (0 != seek_to (ctx, el.end))
+	goto CLEANUP;
+    }
+  ret = report_track (ctx, &track);
+ CLEANUP:
+  free (track.name);
+  free (track.language);
+  free (track.codec_id);
+  free (track.codec_name);
+  return ret;
+}
+
+
+/**
+ * Parse the Tracks element.
+ *
+ * @param ctx parser state
+ * @param tracks the Tracks element
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_tracks (struct EbmlContext *ctx,
+	      const struct Element *tracks)
+{
+  struct Element el;
+  int ret;
+
+  ctx->have_tracks = 1;
+  while (ctx->pos < tracks->end)
+    {
+      if (0 != read_element (ctx, tracks->end, &el))
+	return -1;
+      if ( (MKV_ID_TRACKENTRY == el.id) &&
+	   (0 != (ret = parse_track_entry (ctx, &el))) )
+	return ret;
+      if (0 != seek_to (ctx, el.end))
+	return -1;
+    }
+  return 0;
+}
+
+
+/**
+ * Report a SimpleTag.
+ *
+ * @param ctx parser state
+ * @param name name of the tag
+ * @param value value of the tag
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_tag (struct EbmlContext *ctx,
+	    const char *name,
+	    const char *value)
+{
+  char *format;
+  size_t slen;
+  unsigned int i;
+  int ret;
+
+  if ( ('\0' == name[0]) ||
+       ('\0' == value[0]) )
+    return 0;
+  for (i = 0; NULL != tag_map[i].name; i++)
+    if (0 == strcmp (name, tag_map[i].name))
+      return add_string (ctx, tag_map[i].type, value);
+  slen = strlen (name) + strlen (value) + 2;
+  if (NULL == (format = malloc (slen)))
+    return 0;
+  snprintf (format, slen, "%s=%s", name, value);
+  ret = add_string (ctx, EXTRACTOR_METATYPE_UNKNOWN, format);
+  free (format);
+  return ret;
+}
+
+
+/**
+ * Parse a SimpleTag (and the SimpleTags nested in it) and report
+ * it.  A tag is reported before the tags nested in it.
+ *
+ * @param ctx parser state
+ * @param tag the SimpleTag element
+ * @param depth nesting depth of @a tag
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_simple_tag (struct EbmlContext *ctx,
+		  const struct Element *tag,
+		  unsigned int depth)
+{
+  struct Element el;
+  char *name = NULL;
+  char *value = NULL;
+  int reported = 0;
+  int ret;
+
+  ret = -1;
+  while (ctx->pos < tag->end)
+    {
+      if (0 != read_element (ctx, tag->end, &el))
+	goto CLEANUP;
+      switch (el.id)
+	{
+	case MKV_ID_TAGNAME:
+	  if (0 != replace_string (ctx, &el, &name))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_TAGSTRING:
+	  if (0 != replace_string (ctx, &el, &value))
+	    goto CLEANUP;
+	  break;
+	case MKV_ID_SIMPLETAG:
+	  if (depth >= MAX_TAG_DEPTH)
+	    break;
+	  if ( (! reported) &&
+	       (NULL != name) &&
+	       (NULL != value) )
+	    {
+	      reported = 1;
+	      if (0 != (ret = report_tag (ctx, name, value)))
+		goto CLEANUP;
+	    }
+	  if (0 != (ret = parse_simple_tag (ctx, &el, depth + 1)))
+	    goto CLEANUP;
+	  ret = -1;
+	  break;
+	}
+      if (0 != seek_to (ctx, el.end))
+	goto CLEANUP;
+    }
+  ret = 0;
+  if ( (! reported) &&
+       (NULL != name) &&
+       (NULL != value) )
+    ret = report_tag (ctx, name, value);
+ CLEANUP:
+  free (name);
+  free (value);
+  return ret;
+}
+
+
+/**
+ * Parse the Tags element.
+ *
+ * @param ctx parser state
+ * @param tags the Tags element
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_tags (struct EbmlContext *ctx,
+	    const struct Element *tags)
+{
+  struct Element tag;
+  struct Element el;
+  int ret;
+
+  ctx->have_tags = 1;
+  while (ctx->pos < tags->end)
+    {
+      if (0 != read_element (ctx, tags->end, &tag))
+	return -1;
+      if (MKV_ID_TAG == tag.id)
+	{
+	  while (ctx->pos < tag.end)
+	    {
+	      if (0 != read_element (ctx, tag.end, &el))
+		return -1;
+	      if ( (MKV_ID_SIMPLETAG == el.id) &&
+		   (0 != (ret = parse_simple_tag (ctx, &el, 0))) )
+		return ret;
+	      if (0 != seek_to (ctx, el.end))
+		return -1;
+	    }
+	}
+      if (0 != seek_to (ctx, tag.end))
+	return -1;
+    }
+  return 0;
+}
+
+
+/**
+ * Parse a top-level element of the segment if it is one we
+ * are interested in.
+ *
+ * @param ctx parser state
+ * @param el the element
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_level1 (struct EbmlContext *ctx,
+	      const struct Element *el)
+{
+  switch (el->id)
+    {
+    case MKV_ID_SEEKHEAD:
+      if (ctx->seek_heads >= MAX_SEEK_HEADS)
+	return 0;
+      return parse_seek_head (ctx, el);
+    case MKV_ID_INFO:
+      if (ctx->have_info)
+	return 0;
+      return parse_info (ctx, el);
+    case MKV_ID_TRACKS:
+      if (ctx->have_tracks)
+	return 0;
+      return parse_tracks (ctx, el);
+    case MKV_ID_TAGS:
+      if (ctx->have_tags)
+	return 0;
+      return parse_tags (ctx, el);
+    }
+  return 0;
+}
+
+
+/**
+ * Jump to a top-level element the SeekHead told us about and
+ * parse it.
+ *
+ * @param ctx parser state
+ * @param rel_pos position relative to the segment start, UINT64_MAX
+ *        if unknown
+ * @param id expected element ID
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_at (struct EbmlContext *ctx,
+	  uint64_t rel_pos,
+	  uint32_t id)
+{
+  struct Element el;
+
+  if ( (UINT64_MAX == rel_pos) ||
+       (rel_pos >= ctx->segment_end - ctx->segment_start) )
+    return 0;
+  if ( (0 != seek_to (ctx, ctx->segment_start + rel_pos)) ||
+       (0 != read_element (ctx, ctx->segment_end, &el)) ||
+       (id != el.id) )
+    return -1;
+  return parse_level1 (ctx, &el);
+}
+
+
+/**
+ * Main entry method for the Matroska/WebM extraction plugin.
+ *
+ * @param ec extraction context provided to the plugin
+ */
+void
+EXTRACTOR_ebml_extract_method (struct EXTRACTOR_ExtractContext *ec)
+{
+  struct EbmlContext ctx;
+  struct Element segment;
+  struct Element el;
+  uint64_t fsize;
+
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.ec = ec;
+  ctx.info_pos = UINT64_MAX;
+  ctx.tracks_pos = UINT64_MAX;
+  ctx.tags_pos = UINT64_MAX;
+  if (0 != parse_header (&ctx))
+    return;
+  fsize = ec->get_size (ec->cls);
+  if (0 != read_element (&ctx, fsize, &segment))
+    return;
+  if (MKV_ID_SEGMENT != segment.id)
+    return;
+  ctx.segment_start = segment.start;
+  ctx.segment_end = segment.end;
+
+  /* Walk the elements in front of the first Cluster; usually this
+     covers the SeekHead, Info and Tracks. */
+  while ( (ctx.pos < ctx.segment_end) &&
+	  ( (! ctx.have_info) ||
+	    (! ctx.have_tracks) ||
+	    (! ctx.have_tags) ) )
+    {
+      if (0 != read_element (&ctx, ctx.segment_end, &el))
+	return;
+      if (MKV_ID_CLUSTER == el.id)
+	break;
+      if (0 != parse_level1 (&ctx, &el))
+	return;
+      if ( (UNKNOWN_SIZE == el.size) ||
+	   (0 != seek_to (&ctx, el.end)) )
+	break;
+    }
+
+  /* Jump to whatever the SeekHead knows about that we have not
+     seen yet (typically the Tags at the end of the file). */
+  if ( (! ctx.have_info) &&
+       (0 != parse_at (&ctx, ctx.info_pos, MKV_ID_INFO)) )
+    return;
+  if ( (! ctx.have_tracks) &&
+       (0 != parse_at (&ctx, ctx.tracks_pos, MKV_ID_TRACKS)) )
+    return;
+  if (! ctx.have_tags)
+    (void) parse_at (&ctx, ctx.tags_pos, MKV_ID_TAGS);
+}
+
+/* end of ebml_extractor.c */
@@ -0,0 +1,1152 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2004, 2009, 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file plugins/elf_extractor.c
+ * @brief plugin to support ELF executables, libraries and objects
+ *
+ * We read the ELF header and the program header table and then
+ * only the segments that the dynamic linker would look at: the
+ * interpreter, the notes (for the build ID) and the dynamic section
+ * with the part of its string table that we need.  Section headers
+ * are never read, so objects without program headers (i.e. ".o"
+ * files) only give the data from the ELF header.
+ */
+#include "platform.h"
+#include "extractor.h"
+#include <stdint.h>
+
+
+/**
+ * Size of the identification bytes at the start of the file.
+ */
+#define EI_NIDENT 16
+
+/**
+ * Offsets in the identification bytes.
+ */
+#define EI_CLASS 4
+#define EI_DATA 5
+#define EI_VERSION 6
+#define EI_OSABI 7
+
+/**
+ * File classes.
+ */
+#define ELFCLASS32 1
+#define ELFCLASS64 2
+
+/**
+ * Data encodings.
+ */
+#define ELFDATA2LSB 1
+#define ELFDATA2MSB 2
+
+/**
+ * Size of the ELF header (including the identification bytes).
+ */
+#define ELF32_EHDR_SIZE 52
+#define ELF64_EHDR_SIZE 64
+
+/**
+ * Size of a program header.
+ */
+#define ELF32_PHDR_SIZE 32
+#define ELF64_PHDR_SIZE 56
+
+/**
+ * Size of an entry in the dynamic section.
+ */
+#define ELF32_DYN_SIZE 8
+#define ELF64_DYN_SIZE 16
+
+/**
+ * Size of the header of a note.
+ */
+#define NOTE_HEADER_SIZE 12
+
+/**
+ * Object file types.
+ */
+#define ET_REL 1
+#define ET_EXEC 2
+#define ET_DYN 3
+#define ET_CORE 4
+
+/**
+ * Segment types.
+ */
+#define PT_LOAD 1
+#define PT_DYNAMIC 2
+#define PT_INTERP 3
+#define PT_NOTE 4
+
+/**
+ * Dynamic section tags.
+ */
+#define DT_NULL 0
+#define DT_NEEDED 1
+#define DT_STRTAB 5
+#define DT_STRSZ 10
+#define DT_SONAME 14
+#define DT_RPATH 15
+#define DT_RUNPATH 29
+#define DT_FLAGS_1 0x6ffffffb
+
+/**
+ * Flag in DT_FLAGS_1 marking position-independent executables.
+ */
+#define DF_1_PIE 0x08000000
+
+/**
+ * GNU note types.
+ */
+#define NT_GNU_ABI_TAG 1
+#define NT_GNU_BUILD_ID 3
+
+/**
+ * OS/ABI values.
+ */
+#define ELFOSABI_NETBSD 2
+#define ELFOSABI_LINUX 3
+#define ELFOSABI_SOLARIS 6
+#define ELFOSABI_IRIX 8
+#define ELFOSABI_FREEBSD 9
+#define ELFOSABI_OPENBSD 12
+
+/**
+ * Largest program header table we read.  This is the limit the
+ * Linux kernel enforces when loading a binary.
+ */
+#define MAX_PHDR_TABLE_SIZE (64 * 1024)
+
+/**
+ * Largest part of the dynamic section we read.
+ */
+#define MAX_DYNAMIC_SIZE (64 * 1024)
+
+/**
+ * Largest interpreter path we accept.
+ */
+#define MAX_INTERP_SIZE 4096
+
+/**
+ * Maximum number of notes we look at per note segment.
+ */
+#define MAX_NOTES 64
+
+/**
+ * Largest build ID we accept (SHA-1 IDs have 20 bytes).
+ */
+#define MAX_BUILD_ID_SIZE 64
+
+/**
+ * How much of the dynamic string table we read at once.  Strings
+ * longer than this are ignored.
+ */
+#define STRING_WINDOW_SIZE 1024
+
+/**
+ * Forward gaps up to this size are skipped by reading over them
+ * instead of seeking.
+ */
+#define MAX_SKIP_READ 256
+
+
+/**
+ * Names of the machine types.
+ */
+static const struct
+{
+  /**
+   * Value of e_machine.
+   */
+  uint16_t machine;
+
+  /**
+   * Name of the architecture.
+   */
+  const char *name;
+} machines[] =
+  {
+    { 1, "M32" },
+    { 2, "Sparc" },
+    { 3, "i386" },
+    { 4, "68K" },
+    { 5, "88K" },
+    { 7, "i860" },
+    { 8, "MIPS" },
+    { 10, "MIPS" },
+    { 15, "PA-RISC" },
+    { 18, "Sparc32+" },
+    { 20, "PPC" },
+    { 21, "PPC64" },
+    { 22, "S390" },
+    { 40, "ARM" },
+    { 41, "ALPHA" },
+    { 42, "SuperH" },
+    { 43, "Sparc V9" },
+    { 50, "IA-64" },
+    { 62, "x86_64" },
+    { 83, "AVR" },
+    { 94, "Xtensa" },
+    { 183, "AArch64" },
+    { 190, "NVIDIA CUDA" },
+    { 243, "RISC-V" },
+    { 247, "BPF" },
+    { 258, "LoongArch" },
+    { 0, NULL }
+  };
+
+
+/**
+ * The fields of a program header that we use.
+ */
+struct ProgramHeader
+{
+  /**
+   * Segment type (PT_*).
+   */
+  uint32_t type;
+
+  /**
+   * Offset of the segment in the file.
+   */
+  uint64_t offset;
+
+  /**
+   * Virtual address of the segment.
+   */
+  uint64_t vaddr;
+
+  /**
+   * Size of the segment in the file.
+   */
+  uint64_t filesz;
+
+  /**
+   * Required alignment of the segment.
+   */
+  uint64_t align;
+};
+
+
+/**
+ * State of the parser.
+ */
+struct ElfContext
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Current offset in the file.
+   */
+  uint64_t pos;
+
+  /**
+   * Non-zero for ELFCLASS64 files.
+   */
+  int is64;
+
+  /**
+   * Non-zero for ELFDATA2MSB files.
+   */
+  int big_endian;
+
+  /**
+   * Object file type (ET_*).
+   */
+  uint16_t type;
+
+  /**
+   * The program header table, NULL if there is none.
+   */
+  unsigned char *phdrs;
+
+  /**
+   * Number of entries in @e phdrs.
+   */
+  unsigned int phnum;
+
+  /**
+   * Size of an entry in @e phdrs.
+   */
+  unsigned int phentsize;
+
+  /**
+   * The dynamic section, NULL if we did not read it.
+   */
+  unsigned char *dynamic;
+
+  /**
+   * Number of entries in @e dynamic.
+   */
+  unsigned int dynnum;
+
+  /**
+   * Value of DT_FLAGS_1 (0 if not present).
+   */
+  uint64_t flags_1;
+
+  /**
+   * Offset of the dynamic string table in the file.
+   */
+  uint64_t strtab_offset;
+
+  /**
+   * Size of the dynamic string table (0 if we did not find it).
+   */
+  uint64_t strtab_size;
+
+  /**
+   * The part of the dynamic string table we read last.
+   */
+  char window[STRING_WINDOW_SIZE];
+
+  /**
+   * Offset of @e window in the dynamic string table.
+   */
+  uint64_t window_start;
+
+  /**
+   * Number of valid bytes in @e window.
+   */
+  size_t window_size;
+
+  /**
+   * Set if we know the target OS (from the OS/ABI byte or an ABI
+   * tag note).
+   */
+  int have_os;
+};
+
+
+/**
+ * Give a string to the metadata processor.
+ *
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param str 0-terminated UTF-8 string
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_string (struct ElfContext *ctx,
+	    enum EXTRACTOR_MetaType type,
+	    const char *str)
+{
+  if ('\0' == str[0])
+    return 0;
+  return ctx->ec->proc (ctx->ec->cls,
+			"elf",
+			type,
+			EXTRACTOR_METAFORMAT_UTF8,
+			"text/plain",
+			str,
+			strlen (str) + 1);
+}
+
+
+/**
+ * Read exactly @a size bytes from the current position.
+ *
+ * @param ctx parser state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or short file)
+ */
+static int
+read_fully (struct ElfContext *ctx,
+	    void *buf,
+	    size_t size)
+{
+  unsigned char *dst = buf;
+  void *data;
+  ssize_t ret;
+  size_t done;
+
+  done = 0;
+  while (done < size)
+    {
+      if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, size - done)))
+	return -1;
+      memcpy (&dst[done], data, ret);
+      done += ret;
+      ctx->pos += ret;
+    }
+  return 0;
+}
+
+
+/**
+ * Move to the given absolute offset.
+ *
+ * @param ctx parser state
+ * @param pos target offset
+ * @return 0 on success, -1 on error
+ */
+static int
+seek_to (struct ElfContext *ctx,
+	 uint64_t pos)
+{
+  void *data;
+  ssize_t ret;
+
+  if (pos == ctx->pos)
+    return 0;
+  if ( (pos > ctx->pos) &&
+       (pos - ctx->pos <= MAX_SKIP_READ) )
+    {
+      while (ctx->pos < pos)
+	{
+	  if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, pos - ctx->pos)))
+	    return -1;
+	  ctx->pos += ret;
+	}
+      return 0;
+    }
+  if ( (pos > INT64_MAX) ||
+       ((int64_t) pos != ctx->ec->seek (ctx->ec->cls, (int64_t) pos, SEEK_SET)) )
+    return -1;
+  ctx->pos = pos;
+  return 0;
+}
+
+
+/**
+ * Read @a size bytes at the given offset into a new buffer.
+ *
+ * @param ctx parser state
+ * @param offset where to read
+ * @param size number of bytes to read
+ * @return NULL on error, otherwise a buffer to be freed by the caller
+ */
+static unsigned char *
+read_at (struct ElfContext *ctx,
+	 uint64_t offset,
+	 size_t size)
+{
+  unsigned char *buf;
+
+  if (0 != seek_to (ctx, offset))
+    return NULL;
+  if (NULL == (buf = malloc (size)))
+    return NULL;
+  if (0 != read_fully (ctx, buf, size))
+    {
+      free (buf);
+      return NULL;
+    }
+  return buf;
+}
+
+
+/**
+ * Get a 16-bit integer in the byte order of the file.
+ *
+ * @param ctx parser state
+ * @param p where to read
+ * @return the value
+ */
+static uint16_t
+get_16 (const struct ElfContext *ctx,
+	const unsigned char *p)
+{
+  if (ctx->big_endian)
+    return (uint16_t) (((uint16_t) p[0] << 8) | p[1]);
+  return (uint16_t) (((uint16_t) p[1] << 8) | p[0]);
+}
+
+
+/**
+ * Get a 32-bit integer in the byte order of the file.
+ *
+ * @param ctx parser state
+ * @param p where to read
+ * @return the value
+ */
+static uint32_t
+get_32 (const struct ElfContext *ctx,
+	const unsigned char *p)
+{
+  if (ctx->big_endian)
+    return ((uint32_t) get_16 (ctx, p) << 16) | get_16 (ctx, &p[2]);
+  return ((uint32_t) get_16 (ctx, &p[2]) << 16) | get_16 (ctx, p);
+}
+
+
+/**
+ * Get a 64-bit integer in the byte order of the file.
+ *
+ * @param ctx parser state
+ * @param p where to read
+ * @return the value
+ */
+static uint64_t
+get_64 (const struct ElfContext *ctx,
+	const unsigned char *p)
+{
+  if (ctx->big_endian)
+    return ((uint64_t) get_32 (ctx, p) << 32) | get_32 (ctx, &p[4]);
+  return ((uint64_t) get_32 (ctx, &p[4]) << 32) | get_32 (ctx, p);
+}
+
+
+/**
+ * Get an address or offset (32 or 64 bits, depending on the class
+ * of the file).
+ *
+ * @param ctx parser state
+ * @param p where to read
+ * @return the value
+ */
+static uint64_t
+get_word (const struct ElfContext *ctx,
+	  const unsigned char *p)
+{
+  if (ctx->is64)
+    return get_64 (ctx, p);
+  return get_32 (ctx, p);
+}
+
+
+/**
+ * Decode an entry of the program header table.
+ *
+ * @param ctx parser state
+ * @param idx index of the entry
+ * @param ph where to store the result
+ */
+static void
+get_phdr (const struct ElfContext *ctx,
+	  unsigned int idx,
+	  struct ProgramHeader *ph)
+{
+  const unsigned char *p = &ctx->phdrs[idx * ctx->phentsize];
+
+  ph->type = get_32 (ctx, p);
+  /* ELF64 moves p_flags up, right after p_type */
+  ph->offset = get_word (ctx, &p[ctx->is64 ? 8 : 4]);
+  ph->vaddr = get_word (ctx, &p[ctx->is64 ? 16 : 8]);
+  ph->filesz = get_word (ctx, &p[ctx->is64 ? 32 : 16]);
+  ph->align = get_word (ctx, &p[ctx->is64 ? 48 : 28]);
+}
+
+
+/**
+ * Decode an entry of the dynamic section.
+ *
+ * @param ctx parser state
+ * @param idx index of the entry
+ * @param tag where to store the tag
+ * @return the value of the entry
+ */
+static uint64_t
+get_dyn (const struct ElfContext *ctx,
+	 unsigned int idx,
+	 uint64_t *tag)
+{
+  unsigned int size = ctx->is64 ? ELF64_DYN_SIZE : ELF32_DYN_SIZE;
+  const unsigned char *p = &ctx->dynamic[idx * size];
+
+  *tag = get_word (ctx, p);
+  return get_word (ctx, &p[size / 2]);
+}
+
+
+/**
+ * Find the file offset of a virtual address using the PT_LOAD
+ * segments.
+ *
+ * @param ctx parser state
+ * @param addr the virtual address
+ * @param offset set to the file offset
+ * @param avail set to the number of bytes of the segment in the
+ *        file from @a offset on
+ * @return 0 on success, -1 if no segment maps @a addr
+ */
+static int
+addr_to_offset (const struct ElfContext *ctx,
+		uint64_t addr,
+		uint64_t *offset,
+		uint64_t *avail)
+{
+  struct ProgramHeader ph;
+  unsigned int i;
+
+  for (i = 0; i < ctx->phnum; i++)
+    {
+      get_phdr (ctx, i, &ph);
+      if ( (PT_LOAD != ph.type) ||
+	   (addr < ph.vaddr) ||
+	   (addr - ph.vaddr >= ph.filesz) )
+	continue;
+      *offset = ph.offset + (addr - ph.vaddr);
+      *avail = ph.filesz - (addr - ph.vaddr);
+      return 0;
+    }
+  return -1;
+}
+
+
+/**
+ * Get a string from the dynamic string table.  Consecutive lookups
+ * of nearby strings are served from the same window of the table.
+ *
+ * @param ctx parser state
+ * @param off offset of the string in the table
+ * @return NULL on error, otherwise the 0-terminated string (valid
+ *         until the next call)
+ */
+static const char *
+get_string (struct ElfContext *ctx,
+	    uint64_t off)
+{
+  uint64_t end;
+
+  if (off >= ctx->strtab_size)
+    return NULL;
+  if ( (off < ctx->window_start) ||
+       (off >= ctx->window_start + ctx->window_size) ||
+       (NULL == memchr (&ctx->window[off - ctx->window_start],
+			'\0',
+			ctx->window_start + ctx->window_size - off)) )
+    {
+      end = ctx->strtab_size;
+      if (end - off > STRING_WINDOW_SIZE)
+	end = off + STRING_WINDOW_SIZE;
+      ctx->window_start = off;
+      ctx->window_size = 0;
+      if ( (0 != seek_to (ctx, ctx->strtab_offset + off)) ||
+	   (0 != read_fully (ctx, ctx->window, end - off)) )
+	return NULL;
+      ctx->window_size = end - off;
+      if (NULL == memchr (ctx->window, '\0', ctx->window_size))
+	return NULL;
+    }
+  return &ctx->window[off - ctx->window_start];
+}
+
+
+/**
+ * Report the interpreter of the program.
+ *
+ * @param ctx parser state
+ * @param ph the PT_INTERP program header
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+parse_interp (struct ElfContext *ctx,
+	      const struct ProgramHeader *ph)
+{
+  char *interp;
+  int ret;
+
+  if ( (ph->filesz < 2) ||
+       (ph->filesz > MAX_INTERP_SIZE) ||
+       (! ctx->ec->wants (ctx->ec->cls,
+			  EXTRACTOR_METATYPE_PROGRAM_INTERPRETER)) ||
+       (NULL == (interp = (char *) read_at (ctx, ph->offset, ph->filesz))) )
+    return 0;
+  interp[ph->filesz - 1] = '\0';
+  ret = add_string (ctx, EXTRACTOR_METATYPE_PROGRAM_INTERPRETER, interp);
+  free (interp);
+  return ret;
+}
+
+
+/**
+ * Handle a note with the name "GNU".
+ *
+ * @param ctx parser state
+ * @param type type of the note
+ * @param desc the descriptor of the note
+ * @param size number of bytes in @a desc
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+handle_gnu_note (struct ElfContext *ctx,
+		 uint32_t type,
+		 const unsigned char *desc,
+		 size_t size)
+{
+  static const char * const abi_os[] =
+    {
+      "Linux",
+      "GNU/Hurd",
+      "Solaris",
+      "FreeBSD"
+    };
+  char buf[MAX_BUILD_ID_SIZE * 2 + 1];
+  uint32_t os;
+  size_t i;
+
+  switch (type)
+    {
+    case NT_GNU_BUILD_ID:
+      for (i = 0; i < size; i++)
+	snprintf (&buf[i * 2], 3, "%02x", desc[i]);
+      buf[size * 2] = '\0';
+      return add_string (ctx, EXTRACTOR_METATYPE_BUILD_ID, buf);
+    case NT_GNU_ABI_TAG:
+      os = get_32 (ctx, desc);
+      if ( (ctx->have_os) ||
+	   (os >= sizeof (abi_os) / sizeof (abi_os[0])) )
+	return 0;
+      ctx->have_os = 1;
+      snprintf (buf,
+		sizeof (buf),
+		"%s %u.%u.%u",
+		abi_os[os],
+		(unsigned int) get_32 (ctx, &desc[4]),
+		(unsigned int) get_32 (ctx, &desc[8]),
+		(unsigned int) get_32 (ctx, &desc[12]));
+      return add_string (ctx, EXTRACTOR_METATYPE_TARGET_OS, buf);
+    default:
+      return 0;
+    }
+}
+
+
+/**
+ * Look for the build ID and the ABI tag in a note segment.  We only
+ * read the headers of the other notes.
+ *
+ * @param ctx parser state
+ * @param ph the PT_NOTE program header
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+parse_notes (struct ElfContext *ctx,
+	     const struct ProgramHeader *ph)
+{
+  unsigned char hdr[NOTE_HEADER_SIZE];
+  unsigned char body[4 + MAX_BUILD_ID_SIZE];
+  uint64_t pos;
+  uint64_t end;
+  uint64_t name_size;
+  uint64_t desc_size;
+  uint64_t align;
+  uint32_t type;
+  unsigned int i;
+  int want_id;
+  int want_os;
+
+  want_id = ctx->ec->wants (ctx->ec->cls, EXTRACTOR_METATYPE_BUILD_ID);
+  want_os = ( (! ctx->have_os) &&
+	      (ctx->ec->wants (ctx->ec->cls, EXTRACTOR_METATYPE_TARGET_OS)) );
+  /* notes in 8-aligned segments (i.e. .note.gnu.property) are padded
+     to 8 bytes */
+  align = (8 == ph->align) ? 8 : 4;
+  pos = ph->offset;
+  end = ph->offset + ph->filesz;
+  if (end < pos)
+    return 0;
+  for (i = 0; i < MAX_NOTES; i++)
+    {
+      if ( (! want_id) && (! want_os) )
+	break;
+      if ( (end - pos < NOTE_HEADER_SIZE) ||
+	   (0 != seek_to (ctx, pos)) ||
+	   (0 != read_fully (ctx, hdr, sizeof (hdr))) )
+	break;
+      name_size = get_32 (ctx, hdr);
+      desc_size = get_32 (ctx, &hdr[4]);
+      type = get_32 (ctx, &hdr[8]);
+      pos += NOTE_HEADER_SIZE;
+      if ( (4 == name_size) &&
+	   ( ( (want_id) &&
+	       (NT_GNU_BUILD_ID == type) &&
+	       (desc_size > 0) &&
+	       (desc_size <= MAX_BUILD_ID_SIZE) ) ||
+	     ( (want_os) &&
+	       (NT_GNU_ABI_TAG == type) &&
+	       (desc_size >= 16) &&
+	       (desc_size <= MAX_BUILD_ID_SIZE) ) ) &&
+	   (end - pos >= 4 + desc_size) )
+	{
+	  if (0 != read_fully (ctx, body, 4 + desc_size))
+	    break;
+	  if (0 == memcmp (body, "GNU", 4))
+	    {
+	      if (NT_GNU_BUILD_ID == type)
+		want_id = 0;
+	      else
+		want_os = 0;
+	      if (0 != handle_gnu_note (ctx, type, &body[4], desc_size))
+		return 1;
+	    }
+	}
+      name_size = (name_size + align - 1) & ~(align - 1);
+      desc_size = (desc_size + align - 1) & ~(align - 1);
+      if ( (end - pos < name_size) ||
+	   (end - pos - name_size < desc_size) )
+	break;
+      pos += name_size + desc_size;
+    }
+  return 0;
+}
+
+
+/**
+ * Read the dynamic section and look up its string table and flags.
+ *
+ * @param ctx parser state
+ * @param ph the PT_DYNAMIC program header
+ */
+static void
+load_dynamic (struct ElfContext *ctx,
+	      const struct ProgramHeader *ph)
+{
+  unsigned int entsize;
+  uint64_t size;
+  uint64_t tag;
+  uint64_t val;
+  uint64_t strtab_addr;
+  uint64_t strtab_size;
+  uint64_t avail;
+  unsigned int i;
+
+  entsize = ctx->is64 ? ELF64_DYN_SIZE : ELF32_DYN_SIZE;
+  size = ph->filesz;
+  if (size > MAX_DYNAMIC_SIZE)
+    size = MAX_DYNAMIC_SIZE;
+  size -= size % entsize;
+  if ( (0 == size) ||
+       (NULL == (ctx->dynamic = read_at (ctx, ph->offset, size))) )
+    return;
+  ctx->dynnum = size / entsize;
+  strtab_addr = 0;
+  strtab_size = 0;
+  for (i = 0; i < ctx->dynnum; i++)
+    {
+      val = get_dyn (ctx, i, &tag);
+      if (DT_NULL == tag)
+	{
+	  ctx->dynnum = i;
+	  break;
+	}
+      switch (tag)
+	{
+	case DT_STRTAB:
+	  strtab_addr = val;
+	  break;
+	case DT_STRSZ:
+	  strtab_size = val;
+	  break;
+	case DT_FLAGS_1:
+	  ctx->flags_1 = val;
+	  break;
+	default:
+	  break;
+	}
+    }
+  if ( (0 == strtab_addr) ||
+       (0 != addr_to_offset (ctx, strtab_addr, &ctx->strtab_offset, &avail)) )
+    return;
+  if ( (0 == strtab_size) ||
+       (strtab_size > avail) )
+    strtab_size = avail;
+  ctx->strtab_size = strtab_size;
+}
+
+
+/**
+ * Report the SONAME, the needed libraries and the library search
+ * path from the dynamic section.
+ *
+ * @param ctx parser state
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+report_dynamic (struct ElfContext *ctx)
+{
+  enum EXTRACTOR_MetaType type;
+  const char *str;
+  uint64_t tag;
+  uint64_t val;
+  unsigned int i;
+
+  if (0 == ctx->strtab_size)
+    return 0;
+  for (i = 0; i < ctx->dynnum; i++)
+    {
+      val = get_dyn (ctx, i, &tag);
+      switch (tag)
+	{
+	case DT_NEEDED:
+	  type = EXTRACTOR_METATYPE_LIBRARY_DEPENDENCY;
+	  break;
+	case DT_SONAME:
+	  type = EXTRACTOR_METATYPE_LIBRARY_SONAME;
+	  break;
+	case DT_RPATH:
+	case DT_RUNPATH:
+	  type = EXTRACTOR_METATYPE_LIBRARY_SEARCH_PATH;
+	  break;
+	default:
+	  continue;
+	}
+      if ( (! ctx->ec->wants (ctx->ec->cls, type)) ||
+	   (NULL == (str = get_string (ctx, val))) )
+	continue;
+      if (0 != add_string (ctx, type, str))
+	return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Get the name of the operating system from the OS/ABI
+ * identification byte.
+ *
+ * @param osabi the OS/ABI identification byte
+ * @return NULL if the byte does not name a specific system
+ */
+static const char *
+get_osabi_name (unsigned char osabi)
+{
+  switch (osabi)
+    {
+    case ELFOSABI_NETBSD:
+      return "NetBSD";
+    case ELFOSABI_LINUX:
+      return "Linux";
+    case ELFOSABI_SOLARIS:
+      return "Solaris";
+    case ELFOSABI_IRIX:
+      return "IRIX";
+    case ELFOSABI_FREEBSD:
+      return "FreeBSD";
+    case ELFOSABI_OPENBSD:
+      return "OpenBSD";
+    default:
+      return NULL;
+    }
+}
+
+
+/**
+ * Report the meta data we get from the ELF header (and the flags of
+ * the dynamic section).
+ *
+ * @param ctx parser state
+ * @param osabi the OS/ABI identification byte
+ * @param machine the machine type
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+report_header (struct ElfContext *ctx,
+	       unsigned char osabi,
+	       uint16_t machine)
+{
+  const char *mime;
+  const char *kind;
+  const char *os;
+  unsigned int i;
+
+  switch (ctx->type)
+    {
+    case ET_REL:
+      mime = "application/x-object";
+      kind = "Relocatable file";
+      break;
+    case ET_EXEC:
+      mime = "application/x-executable";
+      kind = "Executable file";
+      break;
+    case ET_DYN:
+      if (0 != (ctx->flags_1 & DF_1_PIE))
+	{
+	  mime = "application/x-pie-executable";
+	  kind = "Position-independent executable file";
+	}
+      else
+	{
+	  mime = "application/x-sharedlib";
+	  kind = "Shared object file";
+	}
+      break;
+    case ET_CORE:
+      mime = "application/x-coredump";
+      kind = "Core file";
+      break;
+    default:
+      mime = "application/x-executable";
+      kind = "";
+      break;
+    }
+  if ( (0 != add_string (ctx, EXTRACTOR_METATYPE_MIMETYPE, mime)) ||
+       (0 != add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, kind)) )
+    return 1;
+  for (i = 0; NULL != machines[i].name; i++)
+    if (machines[i].machine == machine)
+      {
+	if (0 != add_string (ctx,
+			     EXTRACTOR_METATYPE_TARGET_ARCHITECTURE,
+			     machines[i].name))
+	  return 1;
+	break;
+      }
+  if (NULL == (os = get_osabi_name (osabi)))
+    return 0;
+  return add_string (ctx, EXTRACTOR_METATYPE_TARGET_OS, os);
+}
+
+
+/**
+ * Check if we can handle files of the given MIME type.
+ *
+ * @param mime MIME type determined by libextractor, or NULL
+ * @return 1 if the file may be an ELF file, 0 if not
+ */
+static int
+is_elf_mime (const char *mime)
+{
+  static const char * const types[] =
+    {
+      "application/x-object",
+      "application/x-executable",
+      "application/x-pie-executable",
+      "application/x-sharedlib",
+      "application/x-coredump",
+      NULL
+    };
+  unsigned int i;
+
+  if (NULL == mime)
+    return 1;
+  for (i = 0; NULL != types[i]; i++)
+    if (0 == strcmp (mime, types[i]))
+      return 1;
+  return 0;
+}
+
+
+/**
+ * Main entry method for the 'application/x-executable' extraction
+ * plugin (and the other ELF types).
+ *
+ * @param ec extraction context provided to the plugin
+ */
+void
+EXTRACTOR_elf_extract_method (struct EXTRACTOR_ExtractContext *ec)
+{
+  struct ElfContext ctx;
+  struct ProgramHeader ph;
+  unsigned char ehdr[ELF64_EHDR_SIZE];
+  size_t ehdr_size;
+  uint64_t phoff;
+  uint16_t machine;
+  unsigned int i;
+  int need_dynamic;
+
+  if (! is_elf_mime (ec->mime_hint))
+    return;
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.ec = ec;
+  if ( (0 != read_fully (&ctx, ehdr, EI_NIDENT)) ||
+       (0 != memcmp (ehdr, "\177ELF", 4)) ||
+       (1 != ehdr[EI_VERSION]) )
+    return;
+  switch (ehdr[EI_CLASS])
+    {
+    case ELFCLASS32:
+      ehdr_size = ELF32_EHDR_SIZE;
+      break;
+    case ELFCLASS64:
+      ctx.is64 = 1;
+      ehdr_size = ELF64_EHDR_SIZE;
+      break;
+    default:
+      return;
+    }
+  switch (ehdr[EI_DATA])
+    {
+    case ELFDATA2LSB:
+      break;
+    case ELFDATA2MSB:
+      ctx.big_endian = 1;
+      break;
+    default:
+      return;
+    }
+  if (0 != read_fully (&ctx, &ehdr[EI_NIDENT], ehdr_size - EI_NIDENT))
+    return;
+  ctx.type = get_16 (&ctx, &ehdr[16]);
+  machine = get_16 (&ctx, &ehdr[18]);
+  phoff = get_word (&ctx, &ehdr[ctx.is64 ? 32 : 28]);
+  ctx.phentsize = get_16 (&ctx, &ehdr[ctx.is64 ? 54 : 42]);
+  ctx.phnum = get_16 (&ctx, &ehdr[ctx.is64 ? 56 : 44]);
+
+  ctx.have_os = (NULL != get_osabi_name (ehdr[EI_OSABI]));
+
+  /* program header table */
+  if ( (0 == phoff) ||
+       (ctx.phentsize != (ctx.is64 ? ELF64_PHDR_SIZE : ELF32_PHDR_SIZE)) ||
+       (ctx.phnum * ctx.phentsize > MAX_PHDR_TABLE_SIZE) ||
+       (NULL == (ctx.phdrs = read_at (&ctx, phoff, ctx.phnum * ctx.phentsize))) )
+    ctx.phnum = 0;
+
+  /* the interpreter and the notes usually follow the program
+     headers, the dynamic section is further back */
+  for (i = 0; i < ctx.phnum; i++)
+    {
+      get_phdr (&ctx, i, &ph);
+      if ( (PT_INTERP == ph.type) &&
+	   (0 != parse_interp (&ctx, &ph)) )
+	goto CLEANUP;
+    }
+  if (ET_CORE != ctx.type)
+    for (i = 0; i < ctx.phnum; i++)
+      {
+	get_phdr (&ctx, i, &ph);
+	if ( (PT_NOTE == ph.type) &&
+	     (0 != parse_notes (&ctx, &ph)) )
+	  goto CLEANUP;
+      }
+  need_dynamic = ( (ec->wants (ec->cls, EXTRACTOR_METATYPE_LIBRARY_DEPENDENCY)) ||
+		   (ec->wants (ec->cls, EXTRACTOR_METATYPE_LIBRARY_SONAME)) ||
+		   (ec->wants (ec->cls, EXTRACTOR_METATYPE_LIBRARY_SEARCH_PATH)) ||
+		   ( (ET_DYN == ctx.type) &&
+		     ( (ec->wants (ec->cls, EXTRACTOR_METATYPE_MIMETYPE)) ||
+		       (ec->wants (ec->cls, EXTRACTOR_METATYPE_RESOURCE_TYPE)) ) ) );
+  for (i = 0; i < ctx.phnum; i++)
+    {
+      get_phdr (&ctx, i, &ph);
+      if ( (need_dynamic) &&
+	   (PT_DYNAMIC == ph.type) )
+	{
+	  load_dynamic (&ctx, &ph);
+	  break;
+	}
+    }
+  if ( (0 != report_header (&ctx, ehdr[EI_OSABI], machine)) ||
+       (NULL == ctx.dynamic) )
+    goto CLEANUP;
+  (void) report_dynamic (&ctx);
+ CLEANUP:
+  free (ctx.dynamic);
+  free (ctx.phdrs);
+}
+
+/* end of elf_extractor.c */
@@ -38,19 +38,118 @@
 #define DEBUG 0
 
 
+/**
+ * Size of a block in the cache of ExtractorIO.
+ */
+#define BLOCK_SIZE (16 * 1024)
+
+/**
+ * Number of blocks in the cache of ExtractorIO.
+ */
+#define CACHE_BLOCKS 64
+
+/**
+ * Number of blocks to read at once if the reads are sequential.
+ */
+#define READ_AHEAD_BLOCKS 4
+
+/**
+ * Largest file we copy into memory if Exiv2 wants to mmap() it
+ * and we do not have it in one piece; also the most we allocate
+ * for a single read().
+ */
+#define MAX_MMAP_SIZE (128 * 1024 * 1024)
+
+
 /**
  * Implementation of EXIV2's BasicIO interface based
- * on the 'struct EXTRACTOR_ExtractContext.
+ * on the 'struct EXTRACTOR_ExtractContext.  If the extract
+ * context gives us the entire file in one piece, we work on that
+ * directly; otherwise reads go through a block cache, so that
+ * the many small reads and seeks Exiv2 does for TIFF-based (RAW)
+ * files do not each turn into a request to the extract context.
  */
 class ExtractorIO : public Exiv2::BasicIo
 {
 private:
 
+  /**
+   * Cached block of the file.
+   */
+  struct Block
+  {
+    /**
+     * Offset of the block divided by BLOCK_SIZE.
+     */
+    uint64_t index;
+
+    /**
+     * Number of valid bytes in data, 0 if the block is unused.
+     */
+    size_t size;
+
+    /**
+     * Data of the block.
+     */
+    Exiv2::byte data[BLOCK_SIZE];
+  };
+
   /**
    * Extract context we are using.
    */
   struct EXTRACTOR_ExtractContext *ec;
 
+  /**
+   * Size of the file.
+   */
+  uint64_t fsize;
+
+  /**
+   * Current offset in the file.
+   */
+  uint64_t pos;
+
+  /**
+   * The entire file if the extract context gave it to us in one
+   * piece (valid as we make no further calls to the context),
+   * otherwise NULL.
+   */
+  const Exiv2::byte *whole;
+
+  /**
+   * Copy of the entire file we made for mmap(), or NULL.
+   */
+  Exiv2::byte *mapped;
+
+  /**
+   * Blocks we have read (CACHE_BLOCKS of them).
+   */
+  Block *cache;
+
+  /**
+   * Block we used last (to make getb() fast).
+   */
+  const Block *current;
+
+  /**
+   * Slot in the cache for the next block we read.
+   */
+  unsigned int next_block;
+
+  /**
+   * Index of the last block we read from the extract context,
+   * to detect sequential reads.
+   */
+  uint64_t last_read;
+
+  /**
+   * Get a block of the file, from the cache or by reading it.
+   *
+   * @param index offset of the block divided by BLOCK_SIZE
+   * @return NULL on error (or beyond the end of the file)
+   */
+  const Block *getBlock (uint64_t index);
+
 public:
 
   /**
@@ -60,7 +159,26 @@ public:
    */
   ExtractorIO (struct EXTRACTOR_ExtractContext *s_ec)
   {
+    void *data;
+
     ec = s_ec;
+    pos = 0;
+    whole = NULL;
+    mapped = NULL;
+    cache = NULL;
+    current = NULL;
+    next_block = 0;
+    last_read = UINT64_MAX;
+    fsize = ec->get_size (ec->cls);
+    if ( (UINT64_MAX != fsize) &&
+	 (fsize <= SSIZE_MAX) &&
+	 (0 == ec->seek (ec->cls, 0, SEEK_SET)) &&
+	 (fsize == (uint64_t) ec->read (ec->cls, &data, fsize)) )
+      whole = (const Exiv2::byte *) data;
+    else
+      cache = new Block[CACHE_BLOCKS];
+    for (unsigned int i = 0; (NULL != cache) && (i < CACHE_BLOCKS); i++)
+      cache[i].size = 0;
   }
 
   /**
@@ -68,7 +186,8 @@ public:
    */
   virtual ~ExtractorIO ()
   {
-    /* nothing to do */
+    delete[] cache;
+    free (mapped);
   }
 
   /**
@@ -106,8 +225,7 @@ public:
   /**
    * Read a single character.
    *
-   * @return the character
-   * @throw exception on errors
+   * @return the character, EOF at the end of the file
    */
   virtual int getb ();
 
@@ -155,16 +273,18 @@ public:
 		    Exiv2::BasicIo::Position pos);
 
   /**
-   * Not supported.
+   * Give Exiv2 the entire file in memory.
    *
-   * @throws error
+   * @param isWritable must be false
+   * @return the file
+   * @throws error if the file is too large (or writable was requested)
    */
   virtual Exiv2::byte* mmap (bool isWritable);
 
   /**
-   * Not supported.
+   * Release the memory from mmap() (we keep it until we are destroyed).
    *
-   * @return -1 (error)
+   * @return 0 (always successful)
    */
   virtual int munmap ();
 
@@ -256,6 +376,63 @@ ExtractorIO::close ()
 }
 
 
+/**
+ * Get a block of the file, from the cache or by reading it.
+ *
+ * @param index offset of the block divided by BLOCK_SIZE
+ * @return NULL on error (or beyond the end of the file)
+ */
+const ExtractorIO::Block *
+ExtractorIO::getBlock (uint64_t index)
+{
+  const Block *ret;
+  Block *block;
+  unsigned int count;
+  void *data;
+  ssize_t rd;
+
+  if ( (NULL != current) &&
+       (index == current->index) )
+    return current;
+  for (unsigned int i = 0; i < CACHE_BLOCKS; i++)
+    if ( (0 != cache[i].size) &&
+	 (index == cache[i].index) )
+      return current = &cache[i];
+  /* read ahead if Exiv2 is walking through the file */
+  count = (index == last_read + 1) ? READ_AHEAD_BLOCKS : 1;
+  if ((int64_t) (index * BLOCK_SIZE) !=
+      ec->seek (ec->cls, index * BLOCK_SIZE, SEEK_SET))
+    return NULL;
+  ret = NULL;
+  for (unsigned int j = 0; j < count; j++)
+    {
+      block = &cache[next_block];
+      next_block = (next_block + 1) % CACHE_BLOCKS;
+      if (current == block)
+	current = NULL;
+      block->index = index + j;
+      block->size = 0;
+      while (block->size < BLOCK_SIZE)
+	{
+	  if (0 >= (rd = ec->read (ec->cls, &data, BLOCK_SIZE - block->size)))
+	    break;
+	  memcpy (&block->data[block->size], data, rd);
+	  block->size += rd;
+	}
+      if (0 == block->size)
+	break;
+      last_read = index + j;
+      if (0 == j)
+	ret = block;
+      if (BLOCK_SIZE != block->size)
+	break; /* end of file */
+    }
+  if (NULL != ret)
+    current = ret;
+  return ret;
+}
+
+
 /**
  * Read up to 'rcount' bytes into a buffer
  *
@@ -265,12 +442,18 @@ ExtractorIO::close ()
 Exiv2::DataBuf
 ExtractorIO::read (long rcount)
 {
-  void *data;
-  ssize_t ret;
-
-  if (-1 == (ret = ec->read (ec->cls, &data, rcount)))
+  if ( (rcount <= 0) ||
+       (pos >= fsize) )
     return Exiv2::DataBuf (NULL, 0);
-  return Exiv2::DataBuf ((const Exiv2::byte *) data, ret);
+  /* Exiv2 passes sizes straight from the file, do not allocate
+     more than we can return */
+  if ((uint64_t) rcount > fsize - pos)
+    rcount = fsize - pos;
+  if (rcount > MAX_MMAP_SIZE)
+    rcount = MAX_MMAP_SIZE;
+  Exiv2::DataBuf buf (rcount);
+  buf.size_ = read (buf.pData_, rcount);
+  return buf;
 }
 
 
@@ -285,19 +468,37 @@ long
 ExtractorIO::read (Exiv2::byte *buf,
 		   long rcount)
 {
-  void *data;
-  ssize_t ret;
+  const Block *block;
+  size_t boff;
+  size_t n;
   long got;
 
+  if (rcount <= 0)
+    return 0;
+  if (NULL != whole)
+    {
+      if (pos >= fsize)
+	return 0;
+      if ((uint64_t) rcount > fsize - pos)
+	rcount = fsize - pos;
+      memcpy (buf, &whole[pos], rcount);
+      pos += rcount;
+      return rcount;
+    }
   got = 0;
   while (got < rcount)
     {
-      if (-1 == (ret = ec->read (ec->cls, &data, rcount - got)))
-	return got;
-      if (0 == ret)
+      if (NULL == (block = getBlock (pos / BLOCK_SIZE)))
 	break;
-      memcpy (&buf[got], data, ret);
-      got += ret;
+      boff = pos % BLOCK_SIZE;
+      if (boff >= block->size)
+	break; /* end of file */
+      n = block->size - boff;
+      if (n > (size_t) (rcount - got))
+	n = rcount - got;
+      memcpy (&buf[got], &block->data[boff], n);
+      got += n;
+      pos += n;
     }
   return got;
 }
@@ -306,19 +507,27 @@ ExtractorIO::read (Exiv2::byte *buf,
 /**
  * Read a single character.
  *
- * @return the character
- * @throw exception on errors
+ * @return the character, EOF at the end of the file
  */
 int
 ExtractorIO::getb ()
 {
-  void *data;
-  const unsigned char *r;
+  const Block *block;
+  size_t boff;
 
-  if (1 != ec->read (ec->cls, &data, 1))
-    throw Exiv2::BasicError<char> (42 /* error code */);
-  r = (const unsigned char *) data;
-  return *r;
+  if (NULL != whole)
+    {
+      if (pos >= fsize)
+	return EOF;
+      return whole[pos++];
+    }
+  if (NULL == (block = getBlock (pos / BLOCK_SIZE)))
+    return EOF;
+  boff = pos % BLOCK_SIZE;
+  if (boff >= block->size)
+    return EOF;
+  pos++;
+  return block->data[boff];
 }
 
 
@@ -386,49 +595,85 @@ int
 ExtractorIO::seek (long offset,
 		   Exiv2::BasicIo::Position pos)
 {
-  int rel;
+  int64_t base;
+  int64_t target;
 
   switch (pos)
     {
     case beg: // Exiv2::BasicIo::beg:
-      rel = SEEK_SET;
+      base = 0;
       break;
     case cur:
-      rel = SEEK_CUR;
+      base = this->pos;
       break;
     case end:
-      rel = SEEK_END;
+      base = fsize;
       break;
     default:
       abort ();
     }
-  if (-1 == ec->seek (ec->cls, offset, rel))
+  target = base + offset;
+  if ( (target < 0) ||
+       ((uint64_t) target > fsize) )
     return -1;
+  this->pos = target;
   return 0;
 }
 
 
 /**
- * Not supported.
+ * Give Exiv2 the entire file in memory.
  *
- * @throws error
+ * @param isWritable must be false
+ * @return the file
+ * @throws error if the file is too large (or writable was requested)
  */
 Exiv2::byte *
 ExtractorIO::mmap (bool isWritable)
 {
-  throw Exiv2::BasicError<char> (42 /* error code */);
+  void *data;
+  uint64_t off;
+  ssize_t rd;
+
+  if (isWritable)
+    throw Exiv2::BasicError<char> (42 /* error code */);
+  if (NULL != whole)
+    return const_cast<Exiv2::byte *> (whole);
+  if (NULL != mapped)
+    return mapped;
+  if ( (UINT64_MAX == fsize) ||
+       (fsize > MAX_MMAP_SIZE) ||
+       (0 != ec->seek (ec->cls, 0, SEEK_SET)) ||
+       (NULL == (mapped = (Exiv2::byte *) malloc (fsize + 1))) )
+    throw Exiv2::BasicError<char> (42 /* error code */);
+  /* our cache is not in sync with the context's position anymore,
+     but it does not need to be */
+  last_read = UINT64_MAX;
+  off = 0;
+  while (off < fsize)
+    {
+      if (0 >= (rd = ec->read (ec->cls, &data, fsize - off)))
+	{
+	  free (mapped);
+	  mapped = NULL;
+	  throw Exiv2::BasicError<char> (42 /* error code */);
+	}
+      memcpy (&mapped[off], data, rd);
+      off += rd;
+    }
+  return mapped;
 }
 
 
 /**
- * Not supported.
+ * Release the memory from mmap() (we keep it until we are destroyed).
  *
- * @return -1 error
+ * @return 0 (always successful)
  */
 int
 ExtractorIO::munmap ()
 {
-  return -1;
+  return 0;
 }
 
 
@@ -440,7 +685,7 @@ ExtractorIO::munmap ()
 long int
 ExtractorIO::tell (void) const
 {
-  return (long) ec->seek (ec->cls, 0, SEEK_CUR);
+  return (long) pos;
 }
 
 
@@ -456,7 +701,7 @@ long int
 #endif
 ExtractorIO::size (void) const
 {
-  return (long) ec->get_size (ec->cls);
+  return (long) fsize;
 }
 
 
@@ -492,7 +737,7 @@ ExtractorIO::error () const
 bool
 ExtractorIO::eof () const
 {
-  return size () == tell ();
+  return pos >= fsize;
 }
 
 
@@ -0,0 +1,1131 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file plugins/flv_extractor.c
+ * @brief plugin to support Flash Video (FLV) files
+ *
+ * We parse the 'onMetaData' AMF0 script tag (which writers put
+ * right after the file header) and look at the first bytes of the
+ * first audio and video tags for the codecs.  We stop there and
+ * never read the rest of the stream.
+ */
+#include "platform.h"
+#include "extractor.h"
+#include <stdint.h>
+
+
+/**
+ * Size of the FLV file header.
+ */
+#define FLV_HEADER_SIZE 9
+
+/**
+ * Size of an FLV tag header.
+ */
+#define FLV_TAG_HEADER_SIZE 11
+
+/**
+ * Tag types.
+ */
+#define FLV_TAG_AUDIO 0x08
+#define FLV_TAG_VIDEO 0x09
+#define FLV_TAG_SCRIPT 0x12
+
+/**
+ * Flags in the file header.
+ */
+#define FLV_FLAG_VIDEO 0x01
+#define FLV_FLAG_AUDIO 0x04
+
+/**
+ * Maximum number of tags we look at before giving up on finding
+ * the metadata and the first audio and video tags.
+ */
+#define MAX_TAGS 32
+
+/**
+ * Maximum size of a script tag we are willing to read.
+ */
+#define MAX_SCRIPT_SIZE (1024 * 1024)
+
+/**
+ * How much of the first video tag we read (enough for the
+ * picture header of the codecs we know).
+ */
+#define VIDEO_PEEK_SIZE 16
+
+/**
+ * Maximum nesting depth of AMF values we follow.
+ */
+#define MAX_AMF_DEPTH 8
+
+/**
+ * Forward gaps up to this size are skipped by reading over them
+ * instead of seeking.
+ */
+#define MAX_SKIP_READ 256
+
+/**
+ * AMF0 value types.
+ */
+#define AMF_NUMBER 0x00
+#define AMF_BOOLEAN 0x01
+#define AMF_STRING 0x02
+#define AMF_OBJECT 0x03
+#define AMF_NULL 0x05
+#define AMF_UNDEFINED 0x06
+#define AMF_REFERENCE 0x07
+#define AMF_ECMA_ARRAY 0x08
+#define AMF_OBJECT_END 0x09
+#define AMF_STRICT_ARRAY 0x0A
+#define AMF_DATE 0x0B
+#define AMF_LONG_STRING 0x0C
+
+
+/**
+ * Names of the audio codecs (by sound format).
+ */
+static const char * const audio_codecs[16] =
+  {
+    "Linear PCM",
+    "ADPCM",
+    "MP3",
+    "Linear PCM",
+    "Nellymoser",
+    "Nellymoser",
+    "Nellymoser",
+    "G.711 A-law",
+    "G.711 mu-law",
+    NULL,
+    "AAC",
+    "Speex",
+    NULL,
+    NULL,
+    "MP3",
+    NULL
+  };
+
+/**
+ * Sampling rates of the audio tag header.
+ */
+static const unsigned int audio_rates[4] =
+  {
+    5512, 11025, 22050, 44100
+  };
+
+/**
+ * Names of the video codecs (by codec ID).
+ */
+static const char * const video_codecs[16] =
+  {
+    NULL,
+    "JPEG",
+    "Sorenson H.263",
+    "Screen Video",
+    "On2 VP6",
+    "On2 VP6 with alpha",
+    "Screen Video 2",
+    "H.264",
+    NULL,
+    NULL,
+    NULL,
+    NULL,
+    "HEVC",
+    NULL,
+    NULL,
+    NULL
+  };
+
+/**
+ * Picture sizes of Sorenson H.263 by size code.
+ */
+static const unsigned int sorenson_sizes[8][2] =
+  {
+    { 0, 0 },
+    { 0, 0 },
+    { 352, 288 },
+    { 176, 144 },
+    { 128, 96 },
+    { 320, 240 },
+    { 160, 120 },
+    { 0, 0 }
+  };
+
+
+/**
+ * Properties of the streams that we collect from the metadata
+ * and the tag headers.
+ */
+enum StreamAttribute
+{
+  /**
+   * Not a stream property.
+   */
+  ATTR_NONE = 0,
+
+  /**
+   * Video width in pixels.
+   */
+  ATTR_WIDTH,
+
+  /**
+   * Video height in pixels.
+   */
+  ATTR_HEIGHT,
+
+  /**
+   * Frames per second.
+   */
+  ATTR_FRAMERATE,
+
+  /**
+   * Video codec ID.
+   */
+  ATTR_VIDEO_CODEC,
+
+  /**
+   * Audio codec ID.
+   */
+  ATTR_AUDIO_CODEC,
+
+  /**
+   * Audio sampling rate.
+   */
+  ATTR_SAMPLE_RATE,
+
+  /**
+   * Audio sample size.
+   */
+  ATTR_SAMPLE_SIZE,
+
+  /**
+   * Number of audio channels.
+   */
+  ATTR_CHANNELS,
+
+  /**
+   * Stereo flag.
+   */
+  ATTR_STEREO,
+
+  /**
+   * Duration in seconds.
+   */
+  ATTR_DURATION
+};
+
+
+/**
+ * Mapping of 'onMetaData' keys to stream properties.
+ */
+struct AttributeMap
+{
+  /**
+   * Key in the metadata.
+   */
+  const char *key;
+
+  /**
+   * Corresponding stream property.
+   */
+  enum StreamAttribute attribute;
+};
+
+
+/**
+ * Keys with stream properties.
+ */
+static const struct AttributeMap attribute_map[] =
+  {
+    { "width", ATTR_WIDTH },
+    { "height", ATTR_HEIGHT },
+    { "framerate", ATTR_FRAMERATE },
+    { "videoframerate", ATTR_FRAMERATE },
+    { "videocodecid", ATTR_VIDEO_CODEC },
+    { "audiocodecid", ATTR_AUDIO_CODEC },
+    { "audiosamplerate", ATTR_SAMPLE_RATE },
+    { "audiosamplesize", ATTR_SAMPLE_SIZE },
+    { "audiochannels", ATTR_CHANNELS },
+    { "stereo", ATTR_STEREO },
+    { "duration", ATTR_DURATION },
+    { NULL, ATTR_NONE }
+  };
+
+
+/**
+ * Mapping of 'onMetaData' keys to LE types.
+ */
+struct KeyMap
+{
+  /**
+   * Key in the metadata.
+   */
+  const char *key;
+
+  /**
+   * Corresponding LE type.
+   */
+  enum EXTRACTOR_MetaType type;
+};
+
+
+/**
+ * Keys we report as they are.
+ */
+static const struct KeyMap key_map[] =
+  {
+    { "title", EXTRACTOR_METATYPE_TITLE },
+    { "author", EXTRACTOR_METATYPE_AUTHOR_NAME },
+    { "artist", EXTRACTOR_METATYPE_ARTIST },
+    { "album", EXTRACTOR_METATYPE_ALBUM },
+    { "genre", EXTRACTOR_METATYPE_GENRE },
+    { "description", EXTRACTOR_METATYPE_DESCRIPTION },
+    { "comment", EXTRACTOR_METATYPE_COMMENT },
+    { "copyright", EXTRACTOR_METATYPE_COPYRIGHT },
+    { "keywords", EXTRACTOR_METATYPE_KEYWORDS },
+    { "creator", EXTRACTOR_METATYPE_CREATOR },
+    { "encoder", EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE },
+    { "metadatacreator", EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE },
+    { "creationdate", EXTRACTOR_METATYPE_CREATION_DATE },
+    { "metadatadate", EXTRACTOR_METATYPE_MODIFICATION_DATE },
+    { NULL, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * Parser state.
+ */
+struct FlvContext
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Current offset in the file.
+   */
+  uint64_t pos;
+
+  /**
+   * Duration in seconds (-1 if not known).
+   */
+  double duration;
+
+  /**
+   * Frames per second (0 if not known).
+   */
+  double frame_rate;
+
+  /**
+   * Video dimensions (0 if not known).
+   */
+  unsigned int width;
+  unsigned int height;
+
+  /**
+   * Video codec ID (-1 if not known).
+   */
+  int video_codec;
+
+  /**
+   * Audio codec ID (-1 if not known).
+   */
+  int audio_codec;
+
+  /**
+   * Audio sampling rate (0 if not known).
+   */
+  unsigned int sample_rate;
+
+  /**
+   * Audio sample size in bits (0 if not known).
+   */
+  unsigned int sample_size;
+
+  /**
+   * Number of audio channels (0 if not known).
+   */
+  unsigned int channels;
+
+  /**
+   * Set once we parsed the 'onMetaData' tag.
+   */
+  int have_metadata;
+
+  /**
+   * Set once we looked at the first audio tag.
+   */
+  int have_audio;
+
+  /**
+   * Set once we looked at the first video tag.
+   */
+  int have_video;
+};
+
+
+/**
+ * Give a string to the metadata processor.
+ *
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param str 0-terminated UTF-8 string
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_string (struct FlvContext *ctx,
+	    enum EXTRACTOR_MetaType type,
+	    const char *str)
+{
+  if ('\0' == str[0])
+    return 0;
+  return ctx->ec->proc (ctx->ec->cls,
+			"flv",
+			type,
+			EXTRACTOR_METAFORMAT_UTF8,
+			"text/plain",
+			str,
+			strlen (str) + 1);
+}
+
+
+/**
+ * Read exactly @a size bytes from the current position.
+ *
+ * @param ctx parser state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or short file)
+ */
+static int
+read_fully (struct FlvContext *ctx,
+	    void *buf,
+	    size_t size)
+{
+  unsigned char *dst = buf;
+  void *data;
+  ssize_t ret;
+  size_t done;
+
+  done = 0;
+  while (done < size)
+    {
+      if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, size - done)))
+	return -1;
+      memcpy (&dst[done], data, ret);
+      done += ret;
+      ctx->pos += ret;
+    }
+  return 0;
+}
+
+
+/**
+ * Move to the given absolute offset.
+ *
+ * @param ctx parser state
+ * @param pos target offset
+ * @return 0 on success, -1 on error
+ */
+static int
+seek_to (struct FlvContext *ctx,
+	 uint64_t pos)
+{
+  void *data;
+  ssize_t ret;
+
+  if (pos == ctx->pos)
+    return 0;
+  if ( (pos > ctx->pos) &&
+       (pos - ctx->pos <= MAX_SKIP_READ) )
+    {
+      while (ctx->pos < pos)
+	{
+	  if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, pos - ctx->pos)))
+	    return -1;
+	  ctx->pos += ret;
+	}
+      return 0;
+    }
+  if ( (pos > INT64_MAX) ||
+       ((int64_t) pos != ctx->ec->seek (ctx->ec->cls, (int64_t) pos, SEEK_SET)) )
+    return -1;
+  ctx->pos = pos;
+  return 0;
+}
+
+
+/**
+ * Get a 16-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint16_t
+get_be16 (const unsigned char *p)
+{
+  return (uint16_t) (((uint16_t) p[0] << 8) | p[1]);
+}
+
+
+/**
+ * Get a 24-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint32_t
+get_be24 (const unsigned char *p)
+{
+  return ((uint32_t) p[0] << 16) | ((uint32_t) p[1] << 8) | (uint32_t) p[2];
+}
+
+
+/**
+ * Get a 32-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint32_t
+get_be32 (const unsigned char *p)
+{
+  return ((uint32_t) p[0] << 24) | get_be24 (&p[1]);
+}
+
+
+/**
+ * Get a big endian IEEE 754 double from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static double
+get_double (const unsigned char *p)
+{
+  uint64_t bits;
+  double d;
+
+  bits = ((uint64_t) get_be32 (p) << 32) | get_be32 (&p[4]);
+  memcpy (&d, &bits, sizeof (d));
+  return d;
+}
+
+
+/**
+ * Check if a (finite) number fits the given range.
+ *
+ * @param d the number
+ * @param max upper limit
+ * @return 1 if 0 < @a d <= @a max, 0 if not (or NaN)
+ */
+static int
+in_range (double d,
+	  double max)
+{
+  return (d > 0) && (d <= max);
+}
+
+
+/**
+ * Record a numeric stream property from the metadata.
+ *
+ * @param ctx parser state
+ * @param attribute the property
+ * @param d the value
+ */
+static void
+set_attribute (struct FlvContext *ctx,
+	       enum StreamAttribute attribute,
+	       double d)
+{
+  switch (attribute)
+    {
+    case ATTR_WIDTH:
+      if (in_range (d, 65535))
+	ctx->width = (unsigned int) d;
+      break;
+    case ATTR_HEIGHT:
+      if (in_range (d, 65535))
+	ctx->height = (unsigned int) d;
+      break;
+    case ATTR_FRAMERATE:
+      if (in_range (d, 1000))
+	ctx->frame_rate = d;
+      break;
+    case ATTR_VIDEO_CODEC:
+      if ( (d >= 0) && (d < 16) )
+	ctx->video_codec = (int) d;
+      break;
+    case ATTR_AUDIO_CODEC:
+      if ( (d >= 0) && (d < 16) )
+	ctx->audio_codec = (int) d;
+      break;
+    case ATTR_SAMPLE_RATE:
+      if (in_range (d, 1000000))
+	ctx->sample_rate = (unsigned int) d;
+      break;
+    case ATTR_SAMPLE_SIZE:
+      if (in_range (d, 64))
+	ctx->sample_size = (unsigned int) d;
+      break;
+    case ATTR_CHANNELS:
+      if (in_range (d, 255))
+	ctx->channels = (unsigned int) d;
+      break;
+    case ATTR_DURATION:
+      if (in_range (d, 1e15))
+	ctx->duration = d;
+      break;
+    default:
+      break;
+    }
+}
+
+
+/**
+ * Handle a value of the 'onMetaData' array.
+ *
+ * @param ctx parser state
+ * @param key key of the value (0-terminated)
+ * @param type AMF type of the value
+ * @param value the value (for strings, without terminator)
+ * @param size number of bytes in @a value
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+handle_metadata (struct FlvContext *ctx,
+		 const char *key,
+		 unsigned char type,
+		 const unsigned char *value,
+		 size_t size)
+{
+  enum EXTRACTOR_MetaType le_type;
+  enum StreamAttribute attribute;
+  char buf[64];
+  char *str;
+  double d;
+  time_t t;
+  struct tm tm;
+  unsigned int i;
+  int ret;
+
+  attribute = ATTR_NONE;
+  for (i = 0; NULL != attribute_map[i].key; i++)
+    if (0 == strcasecmp (key, attribute_map[i].key))
+      attribute = attribute_map[i].attribute;
+  le_type = EXTRACTOR_METATYPE_RESERVED;
+  for (i = 0; NULL != key_map[i].key; i++)
+    if (0 == strcasecmp (key, key_map[i].key))
+      le_type = key_map[i].type;
+  switch (type)
+    {
+    case AMF_NUMBER:
+      set_attribute (ctx, attribute, get_double (value));
+      return 0;
+    case AMF_BOOLEAN:
+      if ( (ATTR_STEREO == attribute) &&
+	   (0 == ctx->channels) )
+	ctx->channels = (0 != value[0]) ? 2 : 1;
+      return 0;
+    case AMF_STRING:
+    case AMF_LONG_STRING:
+      if (EXTRACTOR_METATYPE_RESERVED == le_type)
+	return 0;
+      if (NULL == (str = malloc (size + 1)))
+	return 0;
+      memcpy (str, value, size);
+      str[size] = '\0';
+      ret = add_string (ctx, le_type, str);
+      free (str);
+      return ret;
+    case AMF_DATE:
+      /* milliseconds since the epoch (UTC) and a time zone we ignore */
+      d = get_double (value) / 1000;
+      if ( (EXTRACTOR_METATYPE_RESERVED == le_type) ||
+	   (! in_range (d, 1e12)) )
+	return 0;
+      t = (time_t) d;
+      if ( (NULL == gmtime_r (&t, &tm)) ||
+	   (0 == strftime (buf,
+			   sizeof (buf),
+			   "%Y.%m.%d %H:%M:%S UTC",
+			   &tm)) )
+	return 0;
+      return add_string (ctx, le_type, buf);
+    default:
+      return 0;
+    }
+}
+
+
+/**
+ * Parse an AMF0 value.
+ *
+ * @param ctx parser state
+ * @param p pointer to the value, updated to point after it
+ * @param end end of the data
+ * @param depth nesting depth
+ * @param key key of the value if it is a member of the top-level
+ *        'onMetaData' array, NULL otherwise
+ * @return 0 on success, 1 to abort extraction, -1 on error
+ */
+static int
+parse_amf (struct FlvContext *ctx,
+	   const unsigned char **p,
+	   const unsigned char *end,
+	   unsigned int depth,
+	   const char *key)
+{
+  const unsigned char *pos = *p;
+  unsigned char type;
+  char name[256];
+  uint32_t count;
+  uint32_t len;
+  size_t klen;
+  int ret;
+
+  if ( (pos >= end) ||
+       (depth >= MAX_AMF_DEPTH) )
+    return -1;
+  type = *pos++;
+  ret = 0;
+  switch (type)
+    {
+    case AMF_NUMBER:
+      if (end - pos < 8)
+	return -1;
+      if (NULL != key)
+	ret = handle_metadata (ctx, key, type, pos, 8);
+      pos += 8;
+      break;
+    case AMF_BOOLEAN:
+      if (end - pos < 1)
+	return -1;
+      if (NULL != key)
+	ret = handle_metadata (ctx, key, type, pos, 1);
+      pos += 1;
+      break;
+    case AMF_STRING:
+    case AMF_LONG_STRING:
+      if (AMF_STRING == type)
+	{
+	  if (end - pos < 2)
+	    return -1;
+	  len = get_be16 (pos);
+	  pos += 2;
+	}
+      else
+	{
+	  if (end - pos < 4)
+	    return -1;
+	  len = get_be32 (pos);
+	  pos += 4;
+	}
+      if ((size_t) (end - pos) < len)
+	return -1;
+      if (NULL != key)
+	ret = handle_metadata (ctx, key, type, pos, len);
+      pos += len;
+      break;
+    case AMF_DATE:
+      if (end - pos < 10)
+	return -1;
+      if (NULL != key)
+	ret = handle_metadata (ctx, key, type, pos, 10);
+      pos += 10;
+      break;
+    case AMF_NULL:
+    case AMF_UNDEFINED:
+      break;
+    case AMF_REFERENCE:
+      if (end - pos < 2)
+	return -1;
+      pos += 2;
+      break;
+    case AMF_OBJECT:
+    case AMF_ECMA_ARRAY:
+      if (AMF_ECMA_ARRAY == type)
+	{
+	  /* approximate number of entries, ignored */
+	  if (end - pos < 4)
+	    return -1;
+	  pos += 4;
+	}
+      while (0 == ret)
+	{
+	  if (end - pos < 3)
+	    return -1;
+	  len = get_be16 (pos);
+	  pos += 2;
+	  if ( (0 == len) &&
+	       (AMF_OBJECT_END == *pos) )
+	    {
+	      pos++;
+	      break;
+	    }
+	  if ((size_t) (end - pos) < len)
+	    return -1;
+	  klen = (len < sizeof (name)) ? len : sizeof (name) - 1;
+	  memcpy (name, pos, klen);
+	  name[klen] = '\0';
+	  pos += len;
+	  /* only the members of the top-level array are metadata */
+	  ret = parse_amf (ctx,
+			   &pos,
+			   end,
+			   depth + 1,
+			   (0 == depth) ? name : NULL);
+	}
+      break;
+    case AMF_STRICT_ARRAY:
+      if (end - pos < 4)
+	return -1;
+      count = get_be32 (pos);
+      pos += 4;
+      while ( (0 == ret) &&
+	      (count-- > 0) )
+	ret = parse_amf (ctx, &pos, end, depth + 1, NULL);
+      break;
+    default:
+      return -1;
+    }
+  *p = pos;
+  return ret;
+}
+
+
+/**
+ * Parse a script tag and extract the 'onMetaData' values.
+ *
+ * @param ctx parser state
+ * @param size size of the tag body
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+parse_script (struct FlvContext *ctx,
+	      uint32_t size)
+{
+  unsigned char *data;
+  const unsigned char *pos;
+  const unsigned char *end;
+  uint16_t len;
+  int ret;
+
+  if ( (size > MAX_SCRIPT_SIZE) ||
+       (size < 3) ||
+       (NULL == (data = malloc (size))) )
+    return 0;
+  if (0 != read_fully (ctx, data, size))
+    {
+      free (data);
+      return 0;
+    }
+  ret = 0;
+  pos = data;
+  end = &data[size];
+  /* name of the event, then its argument */
+  if (AMF_STRING == pos[0])
+    {
+      len = get_be16 (&pos[1]);
+      if ( (len == sizeof ("onMetaData") - 1) &&
+	   (size - 3 >= len) &&
+	   (0 == memcmp (&pos[3], "onMetaData", len)) )
+	{
+	  ctx->have_metadata = 1;
+	  pos += 3 + len;
+	  if ( (pos < end) &&
+	       ( (AMF_ECMA_ARRAY == *pos) ||
+		 (AMF_OBJECT == *pos) ) )
+	    ret = parse_amf (ctx, &pos, end, 0, NULL);
+	}
+    }
+  free (data);
+  return (1 == ret) ? 1 : 0;
+}
+
+
+/**
+ * Look at the first audio tag.
+ *
+ * @param ctx parser state
+ * @param size size of the tag body
+ */
+static void
+parse_audio (struct FlvContext *ctx,
+	     uint32_t size)
+{
+  unsigned char flags;
+
+  ctx->have_audio = 1;
+  if ( (size < 1) ||
+       (0 != read_fully (ctx, &flags, 1)) )
+    return;
+  if (-1 == ctx->audio_codec)
+    ctx->audio_codec = flags >> 4;
+  /* AAC always claims 44 kHz stereo here, the metadata knows better */
+  if (0 == ctx->sample_rate)
+    ctx->sample_rate = audio_rates[(flags >> 2) & 0x03];
+  if (0 == ctx->sample_size)
+    ctx->sample_size = (0 != (flags & 0x02)) ? 16 : 8;
+  if (0 == ctx->channels)
+    ctx->channels = (0 != (flags & 0x01)) ? 2 : 1;
+}
+
+
+/**
+ * Look at the first video tag, and get the dimensions from the
+ * picture header if the metadata did not tell us.
+ *
+ * @param ctx parser state
+ * @param size size of the tag body
+ */
+static void
+parse_video (struct FlvContext *ctx,
+	     uint32_t size)
+{
+  unsigned char data[VIDEO_PEEK_SIZE];
+  const unsigned char *p;
+  unsigned int codec;
+  unsigned int frame_type;
+  unsigned int frame_size;
+  unsigned int adjust;
+
+  ctx->have_video = 1;
+  if (size > sizeof (data))
+    size = sizeof (data);
+  if ( (size < 1) ||
+       (0 != read_fully (ctx, data, size)) )
+    return;
+  codec = data[0] & 0x0F;
+  frame_type = data[0] >> 4;
+  if (-1 == ctx->video_codec)
+    ctx->video_codec = codec;
+  if ( (0 != ctx->width) &&
+       (0 != ctx->height) )
+    return;
+  p = &data[1];
+  switch (codec)
+    {
+    case 2: /* Sorenson H.263 */
+      if ( (size < 10) ||
+	   (1 != frame_type) ||
+	   (1 != ((p[0] << 9) | (p[1] << 1) | (p[2] >> 7))) )
+	break;
+      frame_size = ((p[3] & 0x03) << 1) | (p[4] >> 7);
+      if (0 == frame_size)
+	{
+	  ctx->width = ((p[4] & 0x7F) << 1) | (p[5] >> 7);
+	  ctx->height = ((p[5] & 0x7F) << 1) | (p[6] >> 7);
+	}
+      else if (1 == frame_size)
+	{
+	  ctx->width = ((p[4] & 0x7F) << 9) | (p[5] << 1) | (p[6] >> 7);
+	  ctx->height = ((p[6] & 0x7F) << 9) | (p[7] << 1) | (p[8] >> 7);
+	}
+      else
+	{
+	  ctx->width = sorenson_sizes[frame_size][0];
+	  ctx->height = sorenson_sizes[frame_size][1];
+	}
+      break;
+    case 3: /* Screen Video */
+    case 6: /* Screen Video 2 */
+      if (size < 5)
+	break;
+      ctx->width = get_be16 (p) & 0x0FFF;
+      ctx->height = get_be16 (&p[2]) & 0x0FFF;
+      break;
+    case 4: /* On2 VP6 */
+    case 5: /* On2 VP6 with alpha */
+      /* dimension adjustment, (alpha offset,) then the VP6 key frame */
+      if ( (size < 12) ||
+	   (1 != frame_type) )
+	break;
+      adjust = p[0];
+      p += (5 == codec) ? 4 : 1;
+      if ( (5 == codec) &&
+	   (size < 15) )
+	break;
+      if (0 != (p[0] & 0x80))
+	break; /* not a key frame */
+      if ( (0 != (p[0] & 0x01)) ||
+	   (0 == (p[1] & 0x06)) )
+	p += 2;
+      ctx->width = p[3] * 16 - (adjust >> 4);
+      ctx->height = p[2] * 16 - (adjust & 0x0F);
+      break;
+    default:
+      break;
+    }
+}
+
+
+/**
+ * Report what we found about the streams.
+ *
+ * @param ctx parser state
+ * @param header_flags flags from the file header
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_streams (struct FlvContext *ctx,
+		unsigned char header_flags)
+{
+  char format[256];
+  char detail[64];
+  const char *codec;
+
+  if (ctx->duration > 0)
+    {
+      snprintf (format,
+		sizeof (format),
+		"%llus",
+		(unsigned long long) ctx->duration);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_DURATION, format))
+	return 1;
+    }
+  if ( (0 != ctx->width) &&
+       (0 != ctx->height) )
+    {
+      snprintf (format,
+		sizeof (format),
+		"%ux%u",
+		ctx->width,
+		ctx->height);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_IMAGE_DIMENSIONS, format))
+	return 1;
+    }
+  codec = (ctx->video_codec >= 0) ? video_codecs[ctx->video_codec] : NULL;
+  if ( (NULL != codec) ||
+       ( (0 != (header_flags & FLV_FLAG_VIDEO)) &&
+	 (ctx->have_video) ) )
+    {
+      detail[0] = '\0';
+      if (ctx->frame_rate > 0)
+	snprintf (detail,
+		  sizeof (detail),
+		  ", %.2f fps",
+		  ctx->frame_rate);
+      snprintf (format,
+		sizeof (format),
+		"video track (%s%s)",
+		(NULL != codec) ? codec : "unknown",
+		detail);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, format))
+	return 1;
+    }
+  codec = (ctx->audio_codec >= 0) ? audio_codecs[ctx->audio_codec] : NULL;
+  if ( (NULL != codec) ||
+       ( (0 != (header_flags & FLV_FLAG_AUDIO)) &&
+	 (ctx->have_audio) ) )
+    {
+      detail[0] = '\0';
+      if ( (0 != ctx->channels) &&
+	   (0 != ctx->sample_rate) )
+	snprintf (detail,
+		  sizeof (detail),
+		  ", %u-channel %u-bit at %uHz",
+		  ctx->channels,
+		  ctx->sample_size,
+		  ctx->sample_rate);
+      snprintf (format,
+		sizeof (format),
+		"audio track (%s%s)",
+		(NULL != codec) ? codec : "unknown",
+		detail);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, format))
+	return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Main entry method for the FLV extraction plugin.
+ *
+ * @param ec extraction context provided to the plugin
+ */
+void
+EXTRACTOR_flv_extract_method (struct EXTRACTOR_ExtractContext *ec)
+{
+  struct FlvContext ctx;
+  unsigned char header[FLV_HEADER_SIZE];
+  unsigned char tag[FLV_TAG_HEADER_SIZE];
+  uint64_t next;
+  uint32_t size;
+  unsigned int i;
+  unsigned char flags;
+
+  if ( (NULL != ec->mime_hint) &&
+       (0 != strcmp (ec->mime_hint, "video/x-flv")) )
+    return;
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.ec = ec;
+  ctx.duration = -1;
+  ctx.video_codec = -1;
+  ctx.audio_codec = -1;
+  if ( (0 != read_fully (&ctx, header, sizeof (header))) ||
+       (0 != memcmp (header, "FLV", 3)) ||
+       (1 != header[3]) ||
+       (get_be32 (&header[5]) < FLV_HEADER_SIZE) )
+    return;
+  flags = header[4];
+  if (0 != add_string (&ctx, EXTRACTOR_METATYPE_MIMETYPE, "video/x-flv"))
+    return;
+  /* the first tag follows the header and a (zero) previous tag size */
+  next = (uint64_t) get_be32 (&header[5]) + 4;
+  for (i = 0; i < MAX_TAGS; i++)
+    {
+      if ( (ctx.have_metadata) &&
+	   ( (ctx.have_audio) ||
+	     (0 == (flags & FLV_FLAG_AUDIO)) ) &&
+	   ( (ctx.have_video) ||
+	     (0 == (flags & FLV_FLAG_VIDEO)) ) )
+	break; /* got everything we need */
+      if ( (0 != seek_to (&ctx, next)) ||
+	   (0 != read_fully (&ctx, tag, sizeof (tag))) )
+	break;
+      size = get_be24 (&tag[1]);
+      next = ctx.pos + size + 4;
+      switch (tag[0] & 0x1F)
+	{
+	case FLV_TAG_SCRIPT:
+	  if ( (! ctx.have_metadata) &&
+	       (1 == parse_script (&ctx, size)) )
+	    return;
+	  break;
+	case FLV_TAG_AUDIO:
+	  if (! ctx.have_audio)
+	    parse_audio (&ctx, size);
+	  break;
+	case FLV_TAG_VIDEO:
+	  if (! ctx.have_video)
+	    parse_video (&ctx, size);
+	  break;
+	default:
+	  break;
+	}
+    }
+  (void) report_streams (&ctx, flags);
+}
+
+/* end of flv_extractor.c */
@@ -42,8 +42,45 @@ GST_DEBUG_CATEGORY_STATIC (gstreamer_extractor);
  */
 #define DATA_TIMEOUT 750 /* 750ms */
 
+/**
+ * How often #_data_timeout() checks for progress (in milliseconds).
+ * A stall is detected between #DATA_TIMEOUT and #DATA_TIMEOUT +
+ * #DATA_TIMEOUT_CHECK ms after the last activity (so within 940ms).
+ */
+#define DATA_TIMEOUT_CHECK (DATA_TIMEOUT / 4)
+
+/**
+ * Timeout we give the discoverer for each file.
+ */
+#define DISCOVERER_TIMEOUT (8 * GST_SECOND)
+
+/**
+ * In header-only mode, how many buffers do we let the demuxer produce
+ * (and drop) waiting for streams that did not produce data yet?
+ */
+#define HEADER_MAX_BUFFERS 64
+
 pthread_mutex_t pipe_mutex;
 
+/**
+ * Discoverer we use for all files.  Created on first use and kept
+ * (with its pipeline) across files, as setting it up is much more
+ * expensive than discovering a typical file.  Destroyed (and
+ * re-created for the next file) if it hangs.
+ */
+static GstDiscoverer *discoverer;
+
+/**
+ * Glib main loop running the discoverer.
+ */
+static GMainLoop *main_loop;
+
+/**
+ * Demuxer and parser factories we use in header-only mode, sorted
+ * by rank.  Looked up on first use.
+ */
+static GList *header_factories;
+
 /**
  * Struct mapping GSTREAMER tags to LE tags.
  */
@@ -847,6 +884,18 @@ struct PrivStruct
    */
   guint timeout_id;
 
+  /**
+   * Monotonic time (in microseconds) when the discoverer last
+   * asked for data, seeked or gave us discovered info.  Protected
+   * by #pipe_mutex.
+   */
+  gint64 last_activity;
+
+  /**
+   * Set to TRUE if the discoverer did not finish in time.
+   */
+  gboolean timed_out;
+
   /**
    * Counter used to determine our current depth in the TOC hierarchy.
    */
@@ -871,6 +920,69 @@ struct PrivStruct
    */
   gboolean toc_print_phase;
 
+  /**
+   * Pipeline in header-only mode, NULL when using the discoverer.
+   */
+  GstElement *pipeline;
+
+  /**
+   * Streams of the demuxer in header-only mode, of type
+   * 'struct HeaderStream *'.  Protected by #pipe_mutex.
+   */
+  GPtrArray *streams;
+
+  /**
+   * Global tags of the file in header-only mode.  Protected by
+   * #pipe_mutex.
+   */
+  GstTagList *global_tags;
+
+  /**
+   * Caps found by typefind in header-only mode.
+   */
+  GstCaps *container_caps;
+
+  /**
+   * Number of buffers dropped in header-only mode.  Protected by
+   * #pipe_mutex.
+   */
+  unsigned int buffers;
+
+  /**
+   * Set to TRUE once the demuxer signalled 'no-more-pads' in
+   * header-only mode.  Protected by #pipe_mutex.
+   */
+  gboolean no_more_pads;
+
+  /**
+   * Set to TRUE once we told the main loop that we have all we need
+   * in header-only mode.  Protected by #pipe_mutex.
+   */
+  gboolean headers_done;
+
+};
+
+
+/**
+ * Stream of a demuxer (or the output of a parser) in header-only mode.
+ */
+struct HeaderStream
+{
+  /**
+   * Caps of the stream, NULL if not yet known.
+   */
+  GstCaps *caps;
+
+  /**
+   * Tags of the stream, NULL if none.
+   */
+  GstTagList *tags;
+
+  /**
+   * Set to TRUE once the stream produced data (or ended), at
+   * which point we know its caps and tags.
+   */
+  gboolean done;
 };
 
 
@@ -895,11 +1007,41 @@ static GQuark *subtitle_quarks;
 static GQuark duration_quark;
 
 
+/**
+ * Note that the discoverer is making progress.  We only record the
+ * time here; #_data_timeout() checks it every #DATA_TIMEOUT_CHECK ms,
+ * which is much cheaper than re-arming a timeout for every buffer.
+ *
+ * @param ps our execution context
+ */
+static void
+touch (struct PrivStruct *ps)
+{
+  pthread_mutex_lock (&pipe_mutex);
+  ps->last_activity = g_get_monotonic_time ();
+  pthread_mutex_unlock (&pipe_mutex);
+}
+
+
+/**
+ * Periodic task checking if the discoverer hanged up.
+ *
+ * @param ps our execution context
+ * @return TRUE to keep checking, FALSE once we gave up
+ */
 static gboolean
 _data_timeout (struct PrivStruct *ps)
 {
+  gint64 idle;
+
+  pthread_mutex_lock (&pipe_mutex);
+  idle = g_get_monotonic_time () - ps->last_activity;
+  pthread_mutex_unlock (&pipe_mutex);
+  if (idle < DATA_TIMEOUT * G_GINT64_CONSTANT (1000))
+    return TRUE;
   GST_ERROR ("GstDiscoverer I/O timed out");
   ps->timeout_id = 0;
+  ps->timed_out = TRUE;
   g_main_loop_quit (ps->loop);
   return FALSE;
 }
@@ -927,10 +1069,6 @@ feed_data (GstElement * appsrc,
 
   GST_DEBUG ("Request %u bytes", size);
 
-  if (ps->timeout_id > 0)
-    g_source_remove (ps->timeout_id);
-  ps->timeout_id = g_timeout_add (DATA_TIMEOUT, (GSourceFunc) _data_timeout, ps);
-
   if ( (ps->length > 0) && (ps->offset >= ps->length) )
   {
     /* we are at the EOS, send end-of-stream */
@@ -953,6 +1091,7 @@ feed_data (GstElement * appsrc,
   accumulated = 0;
   data_len = 1;
   pthread_mutex_lock (&pipe_mutex);
+  ps->last_activity = g_get_monotonic_time ();
   while ( (accumulated < size) && (data_len > 0) )
   {
     data_len = ps->ec->read (ps->ec->cls, (void **) &le_data, size - accumulated);
@@ -984,10 +1123,6 @@ feed_data (GstElement * appsrc,
     gst_app_src_end_of_stream (GST_APP_SRC (ps->source));
     ps->offset = UINT64_MAX; /* set to invalid value */
   }
-
-  if (ps->timeout_id > 0)
-    g_source_remove (ps->timeout_id);
-  ps->timeout_id = g_timeout_add (DATA_TIMEOUT, (GSourceFunc) _data_timeout, ps);
 }
 
 
@@ -1007,11 +1142,9 @@ seek_data (GstElement * appsrc,
 {
   GST_DEBUG ("seek to offset %" G_GUINT64_FORMAT, position);
   pthread_mutex_lock (&pipe_mutex);
+  ps->last_activity = g_get_monotonic_time ();
   ps->offset = ps->ec->seek (ps->ec->cls, position, SEEK_SET);
   pthread_mutex_unlock (&pipe_mutex);
-  if (ps->timeout_id > 0)
-    g_source_remove (ps->timeout_id);
-  ps->timeout_id = g_timeout_add (DATA_TIMEOUT, (GSourceFunc) _data_timeout, ps);
   return ps->offset == position;
 }
 
@@ -1696,6 +1829,32 @@ send_streams (GstDiscovererStreamInfo *info,
 	      struct PrivStruct *ps);
 
 
+/**
+ * Send the mime type and the interesting fields of the caps of a
+ * stream.  Sets 'ps->st' to STREAM_TYPE_IMAGE for images.
+ *
+ * @param caps caps of the stream
+ * @param ps processing context
+ */
+static void
+send_caps (GstCaps *caps,
+	   struct PrivStruct *ps)
+{
+  GstStructure *structure = gst_caps_get_structure (caps, 0);
+  const gchar *structname = gst_structure_get_name (structure);
+
+  if (g_str_has_prefix (structname, "image/"))
+    ps->st = STREAM_TYPE_IMAGE;
+  ps->time_to_leave = ps->ec->proc (ps->ec->cls, "gstreamer",
+    EXTRACTOR_METATYPE_MIMETYPE, EXTRACTOR_METAFORMAT_UTF8, "text/plain",
+    (const char *) structname, strlen (structname) + 1);
+  if (!ps->time_to_leave)
+  {
+    gst_structure_foreach (structure, send_structure_foreach, ps);
+  }
+}
+
+
 static void
 send_stream_info (GstDiscovererStreamInfo * info,
 		  struct PrivStruct *ps)
@@ -1717,17 +1876,7 @@ send_stream_info (GstDiscovererStreamInfo * info,
 
   if (caps)
   {
-    GstStructure *structure = gst_caps_get_structure (caps, 0);
-    const gchar *structname = gst_structure_get_name (structure);
-    if (g_str_has_prefix (structname, "image/"))
-      ps->st = STREAM_TYPE_IMAGE;
-    ps->time_to_leave = ps->ec->proc (ps->ec->cls, "gstreamer",
-      EXTRACTOR_METATYPE_MIMETYPE, EXTRACTOR_METAFORMAT_UTF8, "text/plain",
-      (const char *) structname, strlen (structname) + 1);
-    if (!ps->time_to_leave)
-    {
-      gst_structure_foreach (structure, send_structure_foreach, ps);
-    }
+    send_caps (caps, ps);
     gst_caps_unref (caps);
   }
 
@@ -1957,17 +2106,18 @@ send_toc_foreach (gpointer data, gpointer user_data)
 #define TOC_XML_HEADER "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n"
 
 
+/**
+ * Send the duration of the input.
+ *
+ * @param duration duration of the input
+ * @param ps processing context
+ */
 static void
-send_info (GstDiscovererInfo * info,
-	   struct PrivStruct *ps)
+send_duration (GstClockTime duration,
+	       struct PrivStruct *ps)
 {
-  const GstToc *toc;
   gchar *s;
-  GstDiscovererStreamInfo *sinfo;
-  GstClockTime duration;
-  GList *entries;
 
-  duration = gst_discoverer_info_get_duration (info);
   if ((GST_CLOCK_TIME_IS_VALID (duration)) && (duration > 0))
   {
     s = g_strdup_printf ("%" GST_TIME_FORMAT, GST_TIME_ARGS (duration));
@@ -1983,6 +2133,18 @@ send_info (GstDiscovererInfo * info,
       g_free (s);
     }
   }
+}
+
+
+static void
+send_info (GstDiscovererInfo * info,
+	   struct PrivStruct *ps)
+{
+  const GstToc *toc;
+  GstDiscovererStreamInfo *sinfo;
+  GList *entries;
+
+  send_duration (gst_discoverer_info_get_duration (info), ps);
 
   if (ps->time_to_leave)
     return;
@@ -2078,36 +2240,31 @@ _new_discovered_uri (GstDiscoverer * dc,
 		     struct PrivStruct *ps)
 {
   send_discovered_info (info, ps);
-  if (ps->timeout_id > 0)
-    g_source_remove (ps->timeout_id);
-  ps->timeout_id = g_timeout_add (DATA_TIMEOUT, (GSourceFunc) _data_timeout, ps);
+  touch (ps);
 }
 
 
 static void
 _discoverer_finished (GstDiscoverer * dc, struct PrivStruct *ps)
 {
-  if (ps->timeout_id > 0)
-    g_source_remove (ps->timeout_id);
-  ps->timeout_id = 0;
   g_main_loop_quit (ps->loop);
 }
 
 
 /**
- * This callback is called when discoverer has constructed a source object to
- * read from. Since we provided the appsrc:// uri to discoverer, this will be
- * the appsrc that we must handle. We set up some signals - one to push data
- * into appsrc and one to perform a seek.
+ * Set up the appsrc we read from (created either by discoverer, since we
+ * provided the appsrc:// uri to it, or by us in header-only mode).  We set
+ * up some signals - one to push data into appsrc and one to perform a seek.
+ * If we know the size of the file, appsrc operates in random-access mode,
+ * so each seek of the pipeline maps directly onto a seek in the extraction
+ * context.
  *
- * @param dc
- * @param source
- * @param ps
+ * @param source the appsrc
+ * @param ps our execution context
  */
 static void
-_source_setup (GstDiscoverer * dc,
-	       GstElement * source,
-	       struct PrivStruct *ps)
+setup_source (GstElement * source,
+	      struct PrivStruct *ps)
 {
   if (ps->source)
     gst_object_unref (GST_OBJECT (ps->source));
@@ -2129,7 +2286,23 @@ _source_setup (GstDiscoverer * dc,
    * data */
   g_signal_connect (ps->source, "need-data", G_CALLBACK (feed_data), ps);
   g_signal_connect (ps->source, "seek-data", G_CALLBACK (seek_data), ps);
-  ps->timeout_id = g_timeout_add (DATA_TIMEOUT, (GSourceFunc) _data_timeout, ps);
+  touch (ps);
+}
+
+
+/**
+ * Called by the discoverer once it has constructed the appsrc.
+ *
+ * @param dc the discoverer
+ * @param source the appsrc
+ * @param ps our execution context
+ */
+static void
+_source_setup (GstDiscoverer * dc,
+	       GstElement * source,
+	       struct PrivStruct *ps)
+{
+  setup_source (source, ps);
 }
 
 
@@ -2162,8 +2335,461 @@ _run_async (struct PrivStruct * ps)
 
 
 /**
- * This will be the main method of your plugin.
- * Describe a bit what it does here.
+ * Free a stream of header-only mode.
+ *
+ * @param data the 'struct HeaderStream' to free
+ */
+static void
+free_header_stream (gpointer data)
+{
+  struct HeaderStream *hs = data;
+
+  if (NULL != hs->caps)
+    gst_caps_unref (hs->caps);
+  if (NULL != hs->tags)
+    gst_tag_list_unref (hs->tags);
+  g_free (hs);
+}
+
+
+/**
+ * Tell the main loop (via the bus, as we are usually called from a
+ * streaming thread and the loop may not even be running yet) that
+ * we are done in header-only mode.  Must be called with #pipe_mutex
+ * held.
+ *
+ * @param ps our execution context
+ */
+static void
+post_headers_done (struct PrivStruct *ps)
+{
+  if (ps->headers_done)
+    return;
+  ps->headers_done = TRUE;
+  gst_element_post_message (ps->pipeline,
+			    gst_message_new_application (NULL,
+							 gst_structure_new_empty ("le-done")));
+}
+
+
+/**
+ * Check if we know everything we need in header-only mode, and if
+ * so, stop.  Must be called with #pipe_mutex held.
+ *
+ * @param ps our execution context
+ */
+static void
+check_headers_done (struct PrivStruct *ps)
+{
+  guint i;
+
+  if (ps->buffers < HEADER_MAX_BUFFERS)
+  {
+    if (! ps->no_more_pads)
+      return;
+    for (i = 0; i < ps->streams->len; i++)
+      if (! ((struct HeaderStream *) g_ptr_array_index (ps->streams, i))->done)
+        return;
+  }
+  post_headers_done (ps);
+}
+
+
+/**
+ * Probe on the source pads of the demuxer (or parser) in header-only
+ * mode.  Collects caps and tags, and drops all data and events (there
+ * is nothing downstream, and this way sticky events count as sent).
+ *
+ * @param pad the pad
+ * @param info what is passing the pad
+ * @param user_data our execution context
+ * @return what to do with the data
+ */
+static GstPadProbeReturn
+header_probe (GstPad * pad,
+	      GstPadProbeInfo * info,
+	      gpointer user_data)
+{
+  struct PrivStruct *ps = user_data;
+  struct HeaderStream *hs;
+  GstEvent *event;
+  GstCaps *caps;
+  GstTagList *tags;
+  GstTagList **target;
+
+  pthread_mutex_lock (&pipe_mutex);
+  ps->last_activity = g_get_monotonic_time ();
+  hs = g_object_get_data (G_OBJECT (pad), "le-stream");
+  if (GST_PAD_PROBE_INFO_TYPE (info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)
+  {
+    event = GST_PAD_PROBE_INFO_EVENT (info);
+    switch (GST_EVENT_TYPE (event))
+    {
+    case GST_EVENT_CAPS:
+      gst_event_parse_caps (event, &caps);
+      gst_caps_replace (&hs->caps, caps);
+      break;
+    case GST_EVENT_TAG:
+      gst_event_parse_tag (event, &tags);
+      /* global tags are sent on all streams, keep them only once */
+      if (GST_TAG_SCOPE_GLOBAL == gst_tag_list_get_scope (tags))
+        target = &ps->global_tags;
+      else
+        target = &hs->tags;
+      if (NULL == *target)
+        *target = gst_tag_list_copy (tags);
+      else
+        gst_tag_list_insert (*target, tags, GST_TAG_MERGE_REPLACE);
+      break;
+    case GST_EVENT_EOS:
+      hs->done = TRUE;
+      check_headers_done (ps);
+      break;
+    default:
+      break;
+    }
+  }
+  else
+  {
+    /* first data on this stream, so caps and tags are known */
+    hs->done = TRUE;
+    ps->buffers++;
+    check_headers_done (ps);
+  }
+  pthread_mutex_unlock (&pipe_mutex);
+  return GST_PAD_PROBE_DROP;
+}
+
+
+/**
+ * Start collecting caps and tags of a source pad of the demuxer
+ * (or parser) in header-only mode.
+ *
+ * @param element the demuxer or parser
+ * @param pad the new source pad
+ * @param ps our execution context
+ */
+static void
+_header_pad_added (GstElement * element,
+		   GstPad * pad,
+		   struct PrivStruct *ps)
+{
+  struct HeaderStream *hs;
+
+  if (GST_PAD_SRC != GST_PAD_DIRECTION (pad))
+    return;
+  hs = g_new0 (struct HeaderStream, 1);
+  pthread_mutex_lock (&pipe_mutex);
+  g_ptr_array_add (ps->streams, hs);
+  pthread_mutex_unlock (&pipe_mutex);
+  g_object_set_data (G_OBJECT (pad), "le-stream", hs);
+  gst_pad_add_probe (pad,
+		     GST_PAD_PROBE_TYPE_DATA_DOWNSTREAM,
+		     &header_probe,
+		     ps,
+		     NULL);
+}
+
+
+/**
+ * The demuxer created all of its source pads.
+ *
+ * @param element the demuxer
+ * @param ps our execution context
+ */
+static void
+_header_no_more_pads (GstElement * element,
+		      struct PrivStruct *ps)
+{
+  pthread_mutex_lock (&pipe_mutex);
+  ps->no_more_pads = TRUE;
+  check_headers_done (ps);
+  pthread_mutex_unlock (&pipe_mutex);
+}
+
+
+/**
+ * Get the demuxers and parsers we may use in header-only mode.
+ *
+ * @return list of element factories, sorted by rank
+ */
+static GList *
+get_header_factories ()
+{
+  GList *demuxers;
+  GList *parsers;
+
+  if (NULL != header_factories)
+    return header_factories;
+  demuxers = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_DEMUXER,
+						    GST_RANK_MARGINAL);
+  parsers = gst_element_factory_list_get_elements (GST_ELEMENT_FACTORY_TYPE_PARSER,
+						   GST_RANK_MARGINAL);
+  header_factories = g_list_sort (g_list_concat (demuxers, parsers),
+				  &gst_plugin_feature_rank_compare_func);
+  return header_factories;
+}
+
+
+/**
+ * Typefind figured out what the input is.  Plug the best demuxer
+ * (or parser) for it, and nothing else.
+ *
+ * @param typefind the typefind element
+ * @param probability how sure typefind is
+ * @param caps type of the input
+ * @param ps our execution context
+ */
+static void
+_header_have_type (GstElement * typefind,
+		   guint probability,
+		   GstCaps * caps,
+		   struct PrivStruct *ps)
+{
+  GList *matching;
+  GList *pos;
+  GstElement *demux;
+  GstPad *pad;
+
+  gst_caps_replace (&ps->container_caps, caps);
+  matching = gst_element_factory_list_filter (get_header_factories (),
+					      caps,
+					      GST_PAD_SINK,
+					      FALSE);
+  demux = NULL;
+  for (pos = matching; (NULL != pos) && (NULL == demux); pos = pos->next)
+  {
+    demux = gst_element_factory_create (GST_ELEMENT_FACTORY (pos->data), NULL);
+    if (NULL == demux)
+      continue;
+    g_signal_connect (demux, "pad-added", G_CALLBACK (_header_pad_added), ps);
+    g_signal_connect (demux, "no-more-pads", G_CALLBACK (_header_no_more_pads), ps);
+    gst_bin_add (GST_BIN (ps->pipeline), demux);
+    if (! gst_element_link (typefind, demux))
+    {
+      gst_element_set_state (demux, GST_STATE_NULL);
+      gst_bin_remove (GST_BIN (ps->pipeline), demux);
+      demux = NULL;
+      continue;
+    }
+    /* parsers have an 'always' source pad and do not signal 'no-more-pads' */
+    if (NULL != (pad = gst_element_get_static_pad (demux, "src")))
+    {
+      _header_pad_added (demux, pad, ps);
+      gst_object_unref (pad);
+      pthread_mutex_lock (&pipe_mutex);
+      ps->no_more_pads = TRUE;
+      pthread_mutex_unlock (&pipe_mutex);
+    }
+    gst_element_sync_state_with_parent (demux);
+  }
+  gst_plugin_feature_list_free (matching);
+  if (NULL == demux)
+  {
+    GST_DEBUG ("No demuxer or parser for this input");
+    pthread_mutex_lock (&pipe_mutex);
+    post_headers_done (ps);
+    pthread_mutex_unlock (&pipe_mutex);
+  }
+}
+
+
+/**
+ * Watch the bus of our pipeline in header-only mode, stop once we
+ * are done or on errors.
+ *
+ * @param bus the bus
+ * @param message message on the bus
+ * @param ps our execution context
+ * @return TRUE (keep watching)
+ */
+static gboolean
+_header_bus_watch (GstBus * bus,
+		   GstMessage * message,
+		   struct PrivStruct *ps)
+{
+  switch (GST_MESSAGE_TYPE (message))
+  {
+  case GST_MESSAGE_APPLICATION:
+  case GST_MESSAGE_ERROR:
+  case GST_MESSAGE_EOS:
+    g_main_loop_quit (ps->loop);
+    break;
+  default:
+    break;
+  }
+  return TRUE;
+}
+
+
+/**
+ * Send what we found in header-only mode.
+ *
+ * @param ps our execution context
+ */
+static void
+send_headers (struct PrivStruct *ps)
+{
+  struct HeaderStream *hs;
+  const gchar *name;
+  gint64 duration;
+  guint i;
+
+  if (gst_element_query_duration (ps->pipeline, GST_FORMAT_TIME, &duration))
+    send_duration ((GstClockTime) duration, ps);
+  if ( (! ps->time_to_leave) &&
+       (NULL != ps->container_caps) )
+  {
+    ps->st = STREAM_TYPE_CONTAINER;
+    send_caps (ps->container_caps, ps);
+  }
+  if ( (! ps->time_to_leave) &&
+       (NULL != ps->global_tags) )
+  {
+    ps->st = STREAM_TYPE_NONE;
+    gst_tag_list_foreach (ps->global_tags, send_tag_foreach, ps);
+  }
+  for (i = 0; (i < ps->streams->len) && (! ps->time_to_leave); i++)
+  {
+    hs = g_ptr_array_index (ps->streams, i);
+    ps->st = STREAM_TYPE_NONE;
+    if (NULL != hs->caps)
+    {
+      name = gst_structure_get_name (gst_caps_get_structure (hs->caps, 0));
+      if (g_str_has_prefix (name, "audio/"))
+        ps->st = STREAM_TYPE_AUDIO;
+      else if (g_str_has_prefix (name, "video/"))
+        ps->st = STREAM_TYPE_VIDEO;
+      else if ( (g_str_has_prefix (name, "text/")) ||
+                (g_str_has_prefix (name, "subpicture/")) ||
+                (g_str_has_prefix (name, "subtitle/")) )
+        ps->st = STREAM_TYPE_SUBTITLE;
+      send_caps (hs->caps, ps);
+    }
+    if ( (! ps->time_to_leave) &&
+         (NULL != hs->tags) )
+      gst_tag_list_foreach (hs->tags, send_tag_foreach, ps);
+  }
+  ps->st = STREAM_TYPE_NONE;
+}
+
+
+/**
+ * Extract meta data in header-only mode: instead of letting the
+ * discoverer preroll a full decoding pipeline, we only plug typefind
+ * and a demuxer (or parser), and stop as soon as all streams have
+ * produced data, i.e. once their caps and tags are known.  Nothing
+ * is decoded, so we do not get the meta data that only decoders
+ * know about.
+ *
+ * @param ps our execution context
+ */
+static void
+extract_headers (struct PrivStruct *ps)
+{
+  GstElement *source;
+  GstElement *typefind;
+  GstBus *bus;
+  guint watch_id;
+
+  ps->pipeline = gst_pipeline_new (NULL);
+  source = gst_element_factory_make ("appsrc", NULL);
+  typefind = gst_element_factory_make ("typefind", NULL);
+  if ( (NULL == ps->pipeline) ||
+       (NULL == source) ||
+       (NULL == typefind) )
+  {
+    if (NULL != source)
+      gst_object_unref (source);
+    if (NULL != typefind)
+      gst_object_unref (typefind);
+    if (NULL != ps->pipeline)
+      gst_object_unref (ps->pipeline);
+    ps->pipeline = NULL;
+    return;
+  }
+  gst_bin_add_many (GST_BIN (ps->pipeline), source, typefind, NULL);
+  gst_element_link (source, typefind);
+  setup_source (source, ps);
+  ps->streams = g_ptr_array_new_with_free_func (&free_header_stream);
+  g_signal_connect (typefind, "have-type", G_CALLBACK (_header_have_type), ps);
+  bus = gst_element_get_bus (ps->pipeline);
+  watch_id = gst_bus_add_watch (bus, (GstBusFunc) &_header_bus_watch, ps);
+  gst_object_unref (bus);
+  ps->last_activity = g_get_monotonic_time ();
+  ps->timeout_id = g_timeout_add (DATA_TIMEOUT_CHECK, (GSourceFunc) _data_timeout, ps);
+  /* without sinks, the pipeline never prerolls, but data flows */
+  if (GST_STATE_CHANGE_FAILURE !=
+      gst_element_set_state (ps->pipeline, GST_STATE_PAUSED))
+    g_main_loop_run (ps->loop);
+  if (ps->timeout_id > 0)
+    g_source_remove (ps->timeout_id);
+  g_source_remove (watch_id);
+  if ( (! ps->timed_out) ||
+       (0 != ps->streams->len) )
+    send_headers (ps);
+  gst_element_set_state (ps->pipeline, GST_STATE_NULL);
+  g_signal_handlers_disconnect_by_data (ps->source, ps);
+  gst_object_unref (ps->source);
+  gst_object_unref (ps->pipeline);
+  g_ptr_array_free (ps->streams, TRUE);
+  if (NULL != ps->global_tags)
+    gst_tag_list_unref (ps->global_tags);
+  if (NULL != ps->container_caps)
+    gst_caps_unref (ps->container_caps);
+}
+
+
+/**
+ * Extract meta data using the discoverer.
+ *
+ * @param ps our execution context
+ */
+static void
+discover (struct PrivStruct *ps)
+{
+  GError *err = NULL;
+
+  if (NULL == discoverer)
+    {
+      discoverer = gst_discoverer_new (DISCOVERER_TIMEOUT, &err);
+      if (NULL != err)
+	g_error_free (err);
+      if (NULL == discoverer)
+	return;
+      gst_discoverer_start (discoverer);
+    }
+  ps->dc = discoverer;
+  /* connect signals */
+  g_signal_connect (ps->dc, "discovered", G_CALLBACK (_new_discovered_uri), ps);
+  g_signal_connect (ps->dc, "finished", G_CALLBACK (_discoverer_finished), ps);
+  g_signal_connect (ps->dc, "source-setup", G_CALLBACK (_source_setup), ps);
+  ps->last_activity = g_get_monotonic_time ();
+  ps->timeout_id = g_timeout_add (DATA_TIMEOUT_CHECK, (GSourceFunc) _data_timeout, ps);
+  g_idle_add ((GSourceFunc) &_run_async, ps);
+  g_main_loop_run (ps->loop);
+  if (ps->timeout_id > 0)
+    g_source_remove (ps->timeout_id);
+  g_signal_handlers_disconnect_by_data (ps->dc, ps);
+  if (ps->timed_out)
+    {
+      /* discoverer is stuck on this file, start over with a fresh one */
+      gst_discoverer_stop (discoverer);
+      g_object_unref (discoverer);
+      discoverer = NULL;
+    }
+  if (NULL != ps->source)
+    {
+      g_signal_handlers_disconnect_by_data (ps->source, ps);
+      gst_object_unref (GST_OBJECT (ps->source));
+    }
+}
+
+
+/**
+ * Main method of the GStreamer plugin.  Uses the discoverer, unless
+ * the plugin was loaded with the option "headers", in which case
+ * we only run typefind and a demuxer (see #extract_headers()).
  *
  * @param ec extraction context, here you get the API
  *   for accessing the file data and for returning
@@ -2173,38 +2799,23 @@ void
 EXTRACTOR_gstreamer_extract_method (struct EXTRACTOR_ExtractContext *ec)
 {
   struct PrivStruct ps;
-  GError *err = NULL;
 
+  if (NULL == main_loop)
+    main_loop = g_main_loop_new (NULL, FALSE);
   memset (&ps, 0, sizeof (ps));
-  ps.dc = gst_discoverer_new (8 * GST_SECOND, &err);
-  if (NULL == ps.dc)
-    {
-      if (NULL != err)
-	g_error_free (err);
-      return;
-    }
-  if (NULL != err)
-    g_error_free (err);
-  /* connect signals */
-  g_signal_connect (ps.dc, "discovered", G_CALLBACK (_new_discovered_uri), &ps);
-  g_signal_connect (ps.dc, "finished", G_CALLBACK (_discoverer_finished), &ps);
-  g_signal_connect (ps.dc, "source-setup", G_CALLBACK (_source_setup), &ps);
-  ps.loop = g_main_loop_new (NULL, TRUE);
+  ps.loop = main_loop;
   ps.ec = ec;
   ps.length = ps.ec->get_size (ps.ec->cls);
-  if (ps.length == UINT_MAX)
+  if (ps.length == UINT64_MAX)
     ps.length = 0;
   g_log_set_default_handler (&log_handler, NULL);
   g_log_set_handler (NULL, G_LOG_LEVEL_MASK | G_LOG_FLAG_FATAL | G_LOG_FLAG_RECURSION,
 		     &log_handler, NULL);
-  gst_discoverer_start (ps.dc);
-  g_idle_add ((GSourceFunc) &_run_async, &ps);
-  g_main_loop_run (ps.loop);
-  if (ps.timeout_id > 0)
-    g_source_remove (ps.timeout_id);
-  gst_discoverer_stop (ps.dc);
-  g_object_unref (ps.dc);
-  g_main_loop_unref (ps.loop);
+  if ( (NULL != ec->config) &&
+       (0 == strcmp (ec->config, "headers")) )
+    extract_headers (&ps);
+  else
+    discover (&ps);
 }
 
 
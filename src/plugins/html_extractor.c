@@ -25,9 +25,13 @@
  */
 #include "platform.h"
 #include "extractor.h"
-#include <magic.h>
+#include "convert.h"
+#include "mime_signatures.h"
+#include "mime_magic.h"
+#if HAVE_TIDY
 #include <tidy/tidy.h>
 #include <tidy/tidybuffio.h>
+#endif
 
 /**
  * Mapping of HTML META names to LE types.
@@ -70,12 +74,6 @@ static struct
 };
 
 
-/**
- * Global handle to MAGIC data.
- */
-static magic_t magic;
-
-
 /**
  * Map 'meta' tag to LE type.
  *
@@ -95,6 +93,919 @@ tag_to_type (const char *tag)
 }
 
 
+/**
+ * Number of bytes we ask for per read.
+ */
+#define SCAN_CHUNK_SIZE (16 * 1024)
+
+/**
+ * Maximum size of a single tag (or comment, or title) we are
+ * willing to buffer.
+ */
+#define MAX_TOKEN_SIZE (64 * 1024)
+
+/**
+ * Maximum number of bytes we scan looking for the end of the head.
+ */
+#define MAX_HEAD_SIZE (1024 * 1024)
+
+/**
+ * Number of bytes we keep when skipping over the contents of
+ * a script or style element (enough for the closing tag).
+ */
+#define RAW_TEXT_KEEP 16
+
+
+/**
+ * Elements that may appear in the head of a document; any other
+ * start tag implicitly ends the head.
+ */
+static const char *const head_elements[] = {
+  "html",
+  "head",
+  "title",
+  "base",
+  "link",
+  "meta",
+  "style",
+  "script",
+  "noscript",
+  "template",
+  "object",
+  NULL
+};
+
+
+/**
+ * Meta data item found in the head, kept until we know the
+ * character set of the document.
+ */
+struct HeadItem
+{
+  /**
+   * This is a linked list.
+   */
+  struct HeadItem *next;
+
+  /**
+   * Type of the meta data.
+   */
+  enum EXTRACTOR_MetaType type;
+
+  /**
+   * Raw value (not converted, entities not decoded).
+   */
+  char *value;
+
+  /**
+   * Number of bytes in @e value.
+   */
+  size_t value_len;
+};
+
+
+/**
+ * Result of scanning (part of) the head.
+ */
+enum ScanResult
+{
+  /**
+   * Token processed, continue scanning.
+   */
+  SCAN_CONTINUE,
+
+  /**
+   * Need more input to process the current token.
+   */
+  SCAN_MORE,
+
+  /**
+   * We found the end of the head.
+   */
+  SCAN_END,
+
+  /**
+   * The document ended inside of a token.
+   */
+  SCAN_MALFORMED,
+
+  /**
+   * Scanning limits exceeded (or out of memory).
+   */
+  SCAN_LIMIT
+};
+
+
+/**
+ * State of the scanner for the head of an HTML document.
+ */
+struct HeadScanner
+{
+  /**
+   * Where to read the document from.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Window of the document we are currently looking at.
+   */
+  char *buf;
+
+  /**
+   * Number of bytes allocated for @e buf.
+   */
+  size_t buf_size;
+
+  /**
+   * Current scan position in @e buf.
+   */
+  size_t pos;
+
+  /**
+   * Number of valid bytes in @e buf.
+   */
+  size_t end;
+
+  /**
+   * Number of bytes of the document before @e buf.
+   */
+  uint64_t consumed;
+
+  /**
+   * Set to 1 once we have read the entire document.
+   */
+  int eof;
+
+  /**
+   * Name of the element whose raw text we are skipping ("script"
+   * or "style"), NULL if we are not inside of such an element.
+   */
+  const char *raw_element;
+
+  /**
+   * Meta data found so far (first item).
+   */
+  struct HeadItem *items_head;
+
+  /**
+   * Meta data found so far (last item).
+   */
+  struct HeadItem *items_tail;
+
+  /**
+   * Character set of the document, NULL if unknown.
+   */
+  char *charset;
+};
+
+
+/**
+ * Find a string in a buffer, ignoring case.
+ *
+ * @param data buffer to search
+ * @param size number of bytes in @a data
+ * @param needle string to find, must start with '<'
+ * @return offset of the match, -1 if not found
+ */
+static ssize_t
+find_ci (const char *data,
+	 size_t size,
+	 const char *needle)
+{
+  size_t nlen = strlen (needle);
+  const char *p;
+  size_t off;
+
+  off = 0;
+  while ( (off + nlen <= size) &&
+	  (NULL != (p = memchr (&data[off], '<', size - off))) )
+    {
+      off = p - data;
+      if (off + nlen > size)
+	break;
+      if (0 == strncasecmp (p, needle, nlen))
+	return off;
+      off++;
+    }
+  return -1;
+}
+
+
+/**
+ * Find the '>' that ends a tag, skipping over quoted
+ * attribute values.
+ *
+ * @param data start of the tag (after the tag name)
+ * @param size number of bytes in @a data
+ * @return offset of the '>', -1 if not found
+ */
+static ssize_t
+find_tag_end (const char *data,
+	      size_t size)
+{
+  const char *q;
+  size_t off;
+  int after_eq;
+
+  after_eq = 0;
+  for (off = 0; off < size; off++)
+    {
+      switch (data[off])
+	{
+	case '>':
+	  return off;
+	case '=':
+	  after_eq = 1;
+	  continue;
+	case '"':
+	case '\'':
+	  if (after_eq)
+	    {
+	      if (NULL == (q = memchr (&data[off + 1],
+				       data[off],
+				       size - off - 1)))
+		return -1;
+	      off = q - data;
+	    }
+	  break;
+	default:
+	  if (isspace ((unsigned char) data[off]))
+	    continue;
+	  break;
+	}
+      after_eq = 0;
+    }
+  return -1;
+}
+
+
+/**
+ * Find the value of an attribute in a tag.
+ *
+ * @param tag attributes of the tag (after the tag name)
+ * @param size number of bytes in @a tag (up to the '>')
+ * @param name name of the attribute to find (lower case)
+ * @param value_len set to the length of the value
+ * @return start of the value, NULL if the attribute is not present
+ */
+static const char *
+get_attribute (const char *tag,
+	       size_t size,
+	       const char *name,
+	       size_t *value_len)
+{
+  size_t off;
+  size_t nstart;
+  size_t nlen;
+  const char *q;
+  const char *value;
+  size_t vlen;
+
+  off = 0;
+  while (off < size)
+    {
+      while ( (off < size) &&
+	      ( (isspace ((unsigned char) tag[off])) ||
+		('/' == tag[off]) ) )
+	off++;
+      nstart = off;
+      while ( (off < size) &&
+	      (! isspace ((unsigned char) tag[off])) &&
+	      ('/' != tag[off]) &&
+	      ('=' != tag[off]) )
+	off++;
+      nlen = off - nstart;
+      if (0 == nlen)
+	{
+	  off++;
+	  continue;
+	}
+      while ( (off < size) &&
+	      (isspace ((unsigned char) tag[off])) )
+	off++;
+      value = NULL;
+      vlen = 0;
+      if ( (off < size) &&
+	   ('=' == tag[off]) )
+	{
+	  off++;
+	  while ( (off < size) &&
+		  (isspace ((unsigned char) tag[off])) )
+	    off++;
+	  if ( (off < size) &&
+	       ( ('"' == tag[off]) ||
+		 ('\'' == tag[off]) ) )
+	    {
+	      value = &tag[off + 1];
+	      if (NULL == (q = memchr (value, tag[off], size - off - 1)))
+		return NULL;
+	      vlen = q - value;
+	      off += vlen + 2;
+	    }
+	  else
+	    {
+	      value = &tag[off];
+	      while ( (off < size) &&
+		      (! isspace ((unsigned char) tag[off])) )
+		off++;
+	      vlen = &tag[off] - value;
+	    }
+	}
+      if ( (nlen == strlen (name)) &&
+	   (0 == strncasecmp (&tag[nstart], name, nlen)) )
+	{
+	  if (NULL == value)
+	    value = &tag[nstart + nlen];
+	  *value_len = vlen;
+	  return value;
+	}
+    }
+  return NULL;
+}
+
+
+/**
+ * Remember a meta data item found in the head.
+ *
+ * @param s scanner state
+ * @param type type of the meta data
+ * @param value raw value
+ * @param value_len number of bytes in @a value
+ * @return #SCAN_CONTINUE on success, #SCAN_LIMIT if we are out of memory
+ */
+static enum ScanResult
+add_item (struct HeadScanner *s,
+	  enum EXTRACTOR_MetaType type,
+	  const char *value,
+	  size_t value_len)
+{
+  struct HeadItem *item;
+
+  if (NULL == (item = malloc (sizeof (struct HeadItem) + value_len)))
+    return SCAN_LIMIT;
+  item->next = NULL;
+  item->type = type;
+  item->value = (char *) &item[1];
+  item->value_len = value_len;
+  memcpy (item->value, value, value_len);
+  if (NULL == s->items_tail)
+    s->items_head = item;
+  else
+    s->items_tail->next = item;
+  s->items_tail = item;
+  return SCAN_CONTINUE;
+}
+
+
+/**
+ * Remember the character set of the document, unless we already
+ * know it.
+ *
+ * @param s scanner state
+ * @param charset name of the character set
+ * @param len number of bytes in @a charset
+ */
+static void
+set_charset (struct HeadScanner *s,
+	     const char *charset,
+	     size_t len)
+{
+  size_t i;
+
+  if (NULL != s->charset)
+    return;
+  while ( (len > 0) &&
+	  ( (isspace ((unsigned char) *charset)) ||
+	    ('"' == *charset) ||
+	    ('\'' == *charset) ) )
+    {
+      charset++;
+      len--;
+    }
+  for (i = 0; i < len; i++)
+    if ( (isspace ((unsigned char) charset[i])) ||
+	 (';' == charset[i]) ||
+	 ('"' == charset[i]) ||
+	 ('\'' == charset[i]) )
+      break;
+  if ( (0 == i) ||
+       (NULL == (s->charset = malloc (i + 1))) )
+    return;
+  memcpy (s->charset, charset, i);
+  s->charset[i] = '\0';
+}
+
+
+/**
+ * Process a 'meta' tag.
+ *
+ * @param s scanner state
+ * @param attrs attributes of the tag
+ * @param size number of bytes in @a attrs
+ * @return #SCAN_CONTINUE on success
+ */
+static enum ScanResult
+process_meta (struct HeadScanner *s,
+	      const char *attrs,
+	      size_t size)
+{
+  const char *name;
+  const char *content;
+  const char *charset;
+  size_t name_len;
+  size_t content_len;
+  size_t charset_len;
+  char tmp[32];
+  enum EXTRACTOR_MetaType type;
+
+  if (NULL != (charset = get_attribute (attrs, size, "charset", &charset_len)))
+    set_charset (s, charset, charset_len);
+  if (NULL == (content = get_attribute (attrs, size, "content", &content_len)))
+    return SCAN_CONTINUE;
+  if ( (NULL != (name = get_attribute (attrs, size, "http-equiv", &name_len))) &&
+       (name_len == strlen ("content-type")) &&
+       (0 == strncasecmp (name, "content-type", name_len)) )
+    {
+      charset = content;
+      charset_len = content_len;
+      while (charset_len >= strlen ("charset="))
+	{
+	  if (0 == strncasecmp (charset, "charset=", strlen ("charset=")))
+	    {
+	      set_charset (s,
+			   &charset[strlen ("charset=")],
+			   charset_len - strlen ("charset="));
+	      break;
+	    }
+	  charset++;
+	  charset_len--;
+	}
+      return SCAN_CONTINUE;
+    }
+  if ( (NULL == (name = get_attribute (attrs, size, "name", &name_len))) ||
+       (name_len >= sizeof (tmp)) )
+    return SCAN_CONTINUE;
+  memcpy (tmp, name, name_len);
+  tmp[name_len] = '\0';
+  if (EXTRACTOR_METATYPE_RESERVED == (type = tag_to_type (tmp)))
+    return SCAN_CONTINUE;
+  return add_item (s, type, content, content_len);
+}
+
+
+/**
+ * Process the markup at the current position (which is a '<').
+ *
+ * @param s scanner state
+ * @return how to continue
+ */
+static enum ScanResult
+scan_markup (struct HeadScanner *s)
+{
+  const char *p = &s->buf[s->pos];
+  size_t n = s->end - s->pos;
+  size_t nlen;
+  ssize_t off;
+  ssize_t close;
+  unsigned int i;
+  enum ScanResult ret;
+
+  if (n < 4)
+    return SCAN_MORE;
+  if (0 == strncmp (p, "<!--", 4))
+    {
+      for (off = 4; off + 3 <= (ssize_t) n; off++)
+	if (0 == strncmp (&p[off], "-->", 3))
+	  {
+	    s->pos += off + 3;
+	    return SCAN_CONTINUE;
+	  }
+      return SCAN_MORE;
+    }
+  if ( ('!' == p[1]) ||
+       ('?' == p[1]) ||
+       ('/' == p[1]) )
+    {
+      if (NULL == memchr (p, '>', n))
+	return SCAN_MORE;
+      if ( ('/' == p[1]) &&
+	   (n >= 7) &&
+	   (0 == strncasecmp (&p[2], "head", 4)) &&
+	   ( ('>' == p[6]) ||
+	     (isspace ((unsigned char) p[6])) ) )
+	return SCAN_END;
+      s->pos += (const char *) memchr (p, '>', n) - p + 1;
+      return SCAN_CONTINUE;
+    }
+  if (! isalpha ((unsigned char) p[1]))
+    {
+      /* stray '<' */
+      s->pos++;
+      return SCAN_CONTINUE;
+    }
+  for (nlen = 1; nlen + 1 < n; nlen++)
+    if (! isalnum ((unsigned char) p[nlen + 1]))
+      break;
+  if (nlen + 1 >= n)
+    return SCAN_MORE;
+  if (-1 == (off = find_tag_end (&p[nlen + 1], n - nlen - 1)))
+    return SCAN_MORE;
+  off += nlen + 1; /* offset of the '>' */
+  for (i = 0; NULL != head_elements[i]; i++)
+    if ( (nlen == strlen (head_elements[i])) &&
+	 (0 == strncasecmp (&p[1], head_elements[i], nlen)) )
+      break;
+  if (NULL == head_elements[i])
+    return SCAN_END; /* 'body' or any other element ends the head */
+  if (0 == strcmp (head_elements[i], "title"))
+    {
+      if (-1 == (close = find_ci (&p[off + 1], n - off - 1, "</title")))
+	return SCAN_MORE;
+      if (NULL == memchr (&p[off + 1 + close], '>', n - off - 1 - close))
+	return SCAN_MORE;
+      ret = add_item (s, EXTRACTOR_METATYPE_TITLE, &p[off + 1], close);
+      s->pos += off + 1 + close;
+      return ret;
+    }
+  if (0 == strcmp (head_elements[i], "meta"))
+    {
+      ret = process_meta (s, &p[nlen + 1], off - nlen - 1);
+      s->pos += off + 1;
+      return ret;
+    }
+  if ( (0 == strcmp (head_elements[i], "script")) ||
+       (0 == strcmp (head_elements[i], "style")) )
+    s->raw_element = head_elements[i];
+  s->pos += off + 1;
+  return SCAN_CONTINUE;
+}
+
+
+/**
+ * Skip over the contents of a script or style element.
+ *
+ * @param s scanner state
+ * @return #SCAN_CONTINUE if we found the end of the element,
+ *         #SCAN_MORE if we need more data
+ */
+static enum ScanResult
+skip_raw_text (struct HeadScanner *s)
+{
+  char needle[16];
+  ssize_t off;
+  size_t n = s->end - s->pos;
+
+  snprintf (needle, sizeof (needle), "</%s", s->raw_element);
+  if (-1 == (off = find_ci (&s->buf[s->pos], n, needle)))
+    {
+      /* keep just enough to find a closing tag that straddles
+	 the end of the buffer */
+      if (n > RAW_TEXT_KEEP)
+	s->pos = s->end - RAW_TEXT_KEEP;
+      return SCAN_MORE;
+    }
+  s->pos += off;
+  s->raw_element = NULL;
+  return SCAN_CONTINUE;
+}
+
+
+/**
+ * Read more of the document into the window, dropping the part
+ * before the current position.
+ *
+ * @param s scanner state
+ * @return #SCAN_CONTINUE on success, #SCAN_MALFORMED at the end
+ *         of the document, #SCAN_LIMIT if we should give up
+ */
+static enum ScanResult
+fill_buffer (struct HeadScanner *s)
+{
+  void *data;
+  ssize_t ret;
+  char *tmp;
+
+  if (s->eof)
+    return SCAN_MALFORMED;
+  memmove (s->buf, &s->buf[s->pos], s->end - s->pos);
+  s->consumed += s->pos;
+  s->end -= s->pos;
+  s->pos = 0;
+  if ( (s->consumed + s->end > MAX_HEAD_SIZE) ||
+       (s->end > MAX_TOKEN_SIZE) )
+    return SCAN_LIMIT;
+  if (s->end + SCAN_CHUNK_SIZE > s->buf_size)
+    {
+      if (NULL == (tmp = realloc (s->buf, s->end + SCAN_CHUNK_SIZE)))
+	return SCAN_LIMIT;
+      s->buf = tmp;
+      s->buf_size = s->end + SCAN_CHUNK_SIZE;
+    }
+  ret = s->ec->read (s->ec->cls, &data, SCAN_CHUNK_SIZE);
+  if (ret <= 0)
+    {
+      s->eof = 1;
+      return SCAN_MALFORMED;
+    }
+  memcpy (&s->buf[s->end], data, ret);
+  s->end += ret;
+  return SCAN_CONTINUE;
+}
+
+
+/**
+ * Scan the head of the document for the title and meta tags.
+ * Stops at the end of the head (explicit or implied by the
+ * first element that is not allowed in the head).
+ *
+ * @param s scanner state, with the start of the document in the buffer
+ * @return #SCAN_END if we found the end of the head (or the document
+ *         ended outside of any markup), #SCAN_MALFORMED if the document
+ *         ended inside of some markup, #SCAN_LIMIT if we gave up
+ */
+static enum ScanResult
+scan_head (struct HeadScanner *s)
+{
+  const char *p;
+  enum ScanResult ret;
+
+  while (1)
+    {
+      if (NULL != s->raw_element)
+	ret = skip_raw_text (s);
+      else if (NULL == (p = memchr (&s->buf[s->pos], '<', s->end - s->pos)))
+	{
+	  s->pos = s->end;
+	  ret = SCAN_MORE;
+	}
+      else
+	{
+	  s->pos = p - s->buf;
+	  ret = scan_markup (s);
+	}
+      switch (ret)
+	{
+	case SCAN_CONTINUE:
+	  break;
+	case SCAN_MORE:
+	  ret = fill_buffer (s);
+	  if ( (SCAN_MALFORMED == ret) &&
+	       (s->pos == s->end) &&
+	       (NULL == s->raw_element) )
+	    return SCAN_END; /* document ended outside of markup */
+	  if (SCAN_CONTINUE != ret)
+	    return ret;
+	  break;
+	default:
+	  return ret;
+	}
+    }
+}
+
+
+/**
+ * Check if a string is valid UTF-8.
+ *
+ * @param data string to check
+ * @param size number of bytes in @a data
+ * @return 1 if @a data is valid UTF-8
+ */
+static int
+is_utf8 (const unsigned char *data,
+	 size_t size)
+{
+  size_t i;
+  unsigned int follow;
+
+  i = 0;
+  while (i < size)
+    {
+      if (data[i] < 0x80)
+	follow = 0;
+      else if ( (data[i] >= 0xc2) && (data[i] <= 0xdf) )
+	follow = 1;
+      else if ( (data[i] >= 0xe0) && (data[i] <= 0xef) )
+	follow = 2;
+      else if ( (data[i] >= 0xf0) && (data[i] <= 0xf4) )
+	follow = 3;
+      else
+	return 0;
+      if (size - i <= follow)
+	return 0;
+      for (i++; follow > 0; follow--, i++)
+	if (0x80 != (data[i] & 0xc0))
+	  return 0;
+    }
+  return 1;
+}
+
+
+/**
+ * Encode a code point as UTF-8.
+ *
+ * @param cp code point
+ * @param out where to write the encoding (at least 4 bytes)
+ * @return number of bytes written, 0 if @a cp is not valid
+ */
+static size_t
+encode_utf8 (unsigned long cp,
+	     char *out)
+{
+  if ( (0 == cp) ||
+       ( (cp >= 0xd800) && (cp <= 0xdfff) ) ||
+       (cp > 0x10ffff) )
+    return 0;
+  if (cp < 0x80)
+    {
+      out[0] = (char) cp;
+      return 1;
+    }
+  if (cp < 0x800)
+    {
+      out[0] = (char) (0xc0 | (cp >> 6));
+      out[1] = (char) (0x80 | (cp & 0x3f));
+      return 2;
+    }
+  if (cp < 0x10000)
+    {
+      out[0] = (char) (0xe0 | (cp >> 12));
+      out[1] = (char) (0x80 | ((cp >> 6) & 0x3f));
+      out[2] = (char) (0x80 | (cp & 0x3f));
+      return 3;
+    }
+  out[0] = (char) (0xf0 | (cp >> 18));
+  out[1] = (char) (0x80 | ((cp >> 12) & 0x3f));
+  out[2] = (char) (0x80 | ((cp >> 6) & 0x3f));
+  out[3] = (char) (0x80 | (cp & 0x3f));
+  return 4;
+}
+
+
+/**
+ * Named character references we decode.
+ */
+static const struct
+{
+  /**
+   * Name of the entity (without '&' and ';').
+   */
+  const char *name;
+
+  /**
+   * Code point it stands for.
+   */
+  unsigned long cp;
+} entities[] = {
+  { "amp", '&' },
+  { "lt", '<' },
+  { "gt", '>' },
+  { "quot", '"' },
+  { "apos", '\'' },
+  { "nbsp", 0xa0 },
+  { "copy", 0xa9 },
+  { "reg", 0xae },
+  { NULL, 0 }
+};
+
+
+/**
+ * Decode character references in a UTF-8 string (in place; the
+ * result is never longer than the input) and trim whitespace.
+ *
+ * @param str string to decode, 0-terminated
+ */
+static void
+decode_entities (char *str)
+{
+  char *in;
+  char *out;
+  char *semi;
+  unsigned long cp;
+  size_t len;
+  unsigned int i;
+
+  in = str;
+  while (isspace ((unsigned char) *in))
+    in++;
+  out = str;
+  while ('\0' != *in)
+    {
+      if ( ('&' != *in) ||
+	   (NULL == (semi = strchr (in, ';'))) ||
+	   (semi - in > 10) )
+	{
+	  *out++ = *in++;
+	  continue;
+	}
+      cp = 0;
+      if ('#' == in[1])
+	{
+	  if ( ('x' == in[2]) || ('X' == in[2]) )
+	    cp = strtoul (&in[3], NULL, 16);
+	  else
+	    cp = strtoul (&in[2], NULL, 10);
+	}
+      else
+	{
+	  for (i = 0; NULL != entities[i].name; i++)
+	    if ( (strlen (entities[i].name) == (size_t) (semi - in - 1)) &&
+		 (0 == strncmp (&in[1], entities[i].name, semi - in - 1)) )
+	      {
+		cp = entities[i].cp;
+		break;
+	      }
+	}
+      if (0 == (len = encode_utf8 (cp, out)))
+	{
+	  *out++ = *in++;
+	  continue;
+	}
+      out += len;
+      in = semi + 1;
+    }
+  while ( (out > str) &&
+	  (isspace ((unsigned char) out[-1])) )
+    out--;
+  *out = '\0';
+}
+
+
+/**
+ * Pass the meta data found in the head to LE.
+ *
+ * @param s scanner state
+ */
+static void
+report_items (struct HeadScanner *s)
+{
+  struct HeadItem *item;
+  char *str;
+  int utf8;
+
+  utf8 = ( (NULL == s->charset) ||
+	   (0 == strcasecmp (s->charset, "utf-8")) ||
+	   (0 == strcasecmp (s->charset, "utf8")) );
+  for (item = s->items_head; NULL != item; item = item->next)
+    {
+      if ( (utf8) &&
+	   (is_utf8 ((const unsigned char *) item->value, item->value_len)) )
+	{
+	  if (NULL == (str = malloc (item->value_len + 1)))
+	    return;
+	  memcpy (str, item->value, item->value_len);
+	  str[item->value_len] = '\0';
+	}
+      else
+	{
+	  /* documents without (valid) charset that are not UTF-8
+	     are most likely Latin-1 */
+	  str = EXTRACTOR_common_convert_to_utf8 (item->value,
+						  item->value_len,
+						  utf8
+						  ? "ISO-8859-1"
+						  : s->charset);
+	  if (NULL == str)
+	    continue;
+	}
+      decode_entities (str);
+      if ( ('\0' != str[0]) &&
+	   (0 != s->ec->proc (s->ec->cls,
+			      "html",
+			      item->type,
+			      EXTRACTOR_METAFORMAT_UTF8,
+			      "text/plain",
+			      str,
+			      strlen (str) + 1)) )
+	{
+	  free (str);
+	  return;
+	}
+      free (str);
+    }
+}
+
+
+/**
+ * Release the resources of a head scanner.
+ *
+ * @param s scanner to clean up
+ */
+static void
+scanner_free (struct HeadScanner *s)
+{
+  struct HeadItem *item;
+
+  while (NULL != (item = s->items_head))
+    {
+      s->items_head = item->next;
+      free (item);
+    }
+  free (s->charset);
+  free (s->buf);
+}
+
+
+#if HAVE_TIDY
 /**
  * Function called by libtidy for error reporting.
  *
@@ -167,12 +1078,14 @@ eof_cb (void *sourceData)
 
 
 /**
- * Main entry method for the 'text/html' extraction plugin.
+ * Extract the title and meta tags by parsing the document with
+ * libtidy.  Used for documents our own scanner cannot make sense
+ * of.
  *
- * @param ec extraction context provided to the plugin
+ * @param ec extraction context, positioned at the start of the document
  */
-void
-EXTRACTOR_html_extract_method (struct EXTRACTOR_ExtractContext *ec)
+static void
+extract_with_tidy (struct EXTRACTOR_ExtractContext *ec)
 {
   TidyDoc doc;
   TidyNode head;
@@ -183,23 +1096,6 @@ EXTRACTOR_html_extract_method (struct EXTRACTOR_ExtractContext *ec)
   TidyBuffer tbuf;
   TidyAttr attr;
   enum EXTRACTOR_MetaType type;
-  ssize_t iret;
-  void *data;
-  const char *mime;
-
-  if (-1 == (iret = ec->read (ec->cls,
-			      &data,
-			      16 * 1024)))
-    return;
-  if (NULL == (mime = magic_buffer (magic, data, iret)))
-    return;
-  if (0 != strncmp (mime,
-		    "text/html",
-		    strlen ("text/html")))
-    return; /* not HTML */
-
-  if (0 != ec->seek (ec->cls, 0, SEEK_SET))
-    return; /* seek failed !? */
 
   tidyInitSource (&src, ec,
 		  &get_byte_cb,
@@ -221,7 +1117,6 @@ EXTRACTOR_html_extract_method (struct EXTRACTOR_ExtractContext *ec)
     }
   if (NULL == (head = tidyGetHead (doc)))
     {
-      fprintf (stderr, "no head\n");
       tidyRelease (doc);
       return;
     }
@@ -312,383 +1207,60 @@ EXTRACTOR_html_extract_method (struct EXTRACTOR_ExtractContext *ec)
 
 
 
-#if OLD
-
-
-/* ******************** parser helper functions ************** */
-
-static int
-tagMatch (const char *tag, const char *s, const char *e)
-{
-  return (((e - s) == strlen (tag)) && (0 == strncasecmp (tag, s, e - s)));
-}
-
-static int
-lookFor (char c, size_t * pos, const char *data, size_t size)
-{
-  size_t p = *pos;
-
-  while ((p < size) && (data[p] != c))
-    {
-      if (data[p] == '\0')
-        return 0;
-      p++;
-    }
-  *pos = p;
-  return p < size;
-}
-
-static int
-skipWhitespace (size_t * pos, const char *data, size_t size)
-{
-  size_t p = *pos;
-
-  while ((p < size) && (isspace ( (unsigned char) data[p])))
-    {
-      if (data[p] == '\0')
-        return 0;
-      p++;
-    }
-  *pos = p;
-  return p < size;
-}
-
-static int
-skipLetters (size_t * pos, const char *data, size_t size)
-{
-  size_t p = *pos;
-
-  while ((p < size) && (isalpha ( (unsigned char) data[p])))
-    {
-      if (data[p] == '\0')
-        return 0;
-      p++;
-    }
-  *pos = p;
-  return p < size;
-}
-
-static int
-lookForMultiple (const char *c, size_t * pos, const char *data, size_t size)
-{
-  size_t p = *pos;
-
-  while ((p < size) && (strchr (c, data[p]) == NULL))
-    {
-      if (data[p] == '\0')
-        return 0;
-      p++;
-    }
-  *pos = p;
-  return p < size;
-}
-
-static void
-findEntry (const char *key,
-           const char *start,
-           const char *end, const char **mstart, const char **mend)
-{
-  size_t len;
+#endif
 
-  *mstart = NULL;
-  *mend = NULL;
-  len = strlen (key);
-  while (start < end - len - 1)
-    {
-      start++;
-      if (start[len] != '=')
-        continue;
-      if (0 == strncasecmp (start, key, len))
-        {
-          start += len + 1;
-          *mstart = start;
-          if ((*start == '\"') || (*start == '\''))
-            {
-              start++;
-              while ((start < end) && (*start != **mstart))
-                start++;
-              (*mstart)++;      /* skip quote */
-            }
-          else
-            {
-              while ((start < end) && (!isspace ( (unsigned char) *start)))
-                start++;
-            }
-          *mend = start;
-          return;
-        }
-    }
-}
 
 /**
- * Search all tags that correspond to "tagname".  Example:
- * If the tag is <meta name="foo" desc="bar">, and
- * tagname == "meta", keyname="name", keyvalue="foo",
- * and searchname="desc", then this function returns a
- * copy (!) of "bar".  Easy enough?
+ * Main entry method for the 'text/html' extraction plugin.
  *
- * @return NULL if nothing is found
+ * @param ec extraction context provided to the plugin
  */
-static char *
-findInTags (struct TagInfo * t,
-            const char *tagname,
-            const char *keyname, const char *keyvalue, const char *searchname)
-{
-  const char *pstart;
-  const char *pend;
-
-  while (t != NULL)
-    {
-      if (tagMatch (tagname, t->tagStart, t->tagEnd))
-        {
-          findEntry (keyname, t->tagEnd, t->dataStart, &pstart, &pend);
-          if ((pstart != NULL) && (tagMatch (keyvalue, pstart, pend)))
-            {
-              findEntry (searchname, t->tagEnd, t->dataStart, &pstart, &pend);
-              if (pstart != NULL)
-                {
-                  char *ret = malloc (pend - pstart + 1);
-		  if (ret == NULL)
-		    return NULL;
-                  memcpy (ret, pstart, pend - pstart);
-                  ret[pend - pstart] = '\0';
-                  return ret;
-                }
-            }
-        }
-      t = t->next;
-    }
-  return NULL;
-}
-
-
-/* mimetype = text/html */
-int
-EXTRACTOR_html_extract (const char *data,
-			size_t size,
-			EXTRACTOR_MetaDataProcessor proc,
-			void *proc_cls,
-			const char *options)
+void
+EXTRACTOR_html_extract_method (struct EXTRACTOR_ExtractContext *ec)
 {
-  size_t xsize;
-  struct TagInfo *tags;
-  struct TagInfo *t;
-  struct TagInfo tag;
-  size_t pos;
-  size_t tpos;
-  int i;
-  char *charset;
-  char *tmp;
-  char *xtmp;
-  int ret;
-
-  ret = 0;
-  if (size == 0)
-    return 0;
-  /* only scan first 32k */
-  if (size > 1024 * 32)
-    xsize = 1024 * 32;
-  else
-    xsize = size;
-  tags = NULL;
-  tag.next = NULL;
-  pos = 0;
-  while (pos < xsize)
-    {
-      if (!lookFor ('<', &pos, data, size))
-        break;
-      tag.tagStart = &data[++pos];
-      if (!skipLetters (&pos, data, size))
-        break;
-      tag.tagEnd = &data[pos];
-      if (!skipWhitespace (&pos, data, size))
-        break;
-    STEP3:
-      if (!lookForMultiple (">\"\'", &pos, data, size))
-        break;
-      if (data[pos] != '>')
-        {
-          /* find end-quote, ignore escaped quotes (\') */
-          do
-            {
-              tpos = pos;
-              pos++;
-              if (!lookFor (data[tpos], &pos, data, size))
-                break;
-            }
-          while (data[pos - 1] == '\\');
-          pos++;
-          goto STEP3;
-        }
-      pos++;
-      if (!skipWhitespace (&pos, data, size))
-        break;
-      tag.dataStart = &data[pos];
-      if (!lookFor ('<', &pos, data, size))
-        break;
-      tag.dataEnd = &data[pos];
-      i = 0;
-      while (relevantTags[i] != NULL)
-        {
-          if ((strlen (relevantTags[i]) == tag.tagEnd - tag.tagStart) &&
-              (0 == strncasecmp (relevantTags[i],
-                                 tag.tagStart, tag.tagEnd - tag.tagStart)))
-            {
-              t = malloc (sizeof (struct TagInfo));
-	      if (t == NULL)
-		return 0;
-              *t = tag;
-              t->next = tags;
-              tags = t;
-              break;
-            }
-          i++;
-        }
-      /* abort early if we hit the body tag */
-      if (tagMatch ("body", tag.tagStart, tag.tagEnd))
-        break;
-    }
-
-  /* fast exit */
-  if (tags == NULL)
-    return 0;
+  struct HeadScanner s;
+  ssize_t iret;
+  void *data;
+  const char *mime;
 
-  charset = NULL;
-  /* first, try to determine mime type and/or character set */
-  tmp = findInTags (tags, "meta", "http-equiv", "content-type", "content");
-  if (tmp != NULL)
-    {
-      /* ideally, tmp == "test/html; charset=ISO-XXXX-Y" or something like that;
-         if text/html is present, we take that as the mime-type; if charset=
-         is present, we try to use that for character set conversion. */
-      if (0 == strncasecmp (tmp, "text/html", strlen ("text/html")))
-        ret = proc (proc_cls,
-		    "html",
-		    EXTRACTOR_METATYPE_MIMETYPE,
-		    EXTRACTOR_METAFORMAT_UTF8,
-		    "text/plain",
+  if ( (NULL != ec->mime_hint) &&
+       (0 != strcmp (ec->mime_hint,
+		     "text/html")) )
+    return; /* not HTML */
+  if (-1 == (iret = ec->read (ec->cls,
+			      &data,
+			      SCAN_CHUNK_SIZE)))
+    return;
+  if ( (NULL == (mime = ec->mime_hint)) &&
+       (NULL == (mime = EXTRACTOR_common_get_mime_type (data, iret))) &&
+       (NULL == (mime = EXTRACTOR_common_get_magic_mime_type (data, iret))) )
+    return;
+  if (0 != strncmp (mime,
 		    "text/html",
-		    strlen ("text/html")+1);
-      charset = strcasestr (tmp, "charset=");
-      if (charset != NULL)
-        charset = strdup (&charset[strlen ("charset=")]);
-      free (tmp);
-    }
-  i = 0;
-  while (tagmap[i].name != NULL)
-    {
-      tmp = findInTags (tags, "meta", "name", tagmap[i].name, "content");
-      if ( (tmp != NULL) &&
-	   (ret == 0) )
-        {
-	  if (charset == NULL)
-	    {
-	      ret = proc (proc_cls,
-			  "html",
-			  tagmap[i].type,
-			  EXTRACTOR_METAFORMAT_C_STRING,
-			  "text/plain",
-			  tmp,
-			  strlen (tmp) + 1);
-	    }
-	  else
-	    {
-	      xtmp = EXTRACTOR_common_convert_to_utf8 (tmp,
-						       strlen (tmp),
-						       charset);
-	      if (xtmp != NULL)
-		{
-		  ret = proc (proc_cls,
-			      "html",
-			      tagmap[i].type,
-			      EXTRACTOR_METAFORMAT_UTF8,
-			      "text/plain",
-			      xtmp,
-			      strlen (xtmp) + 1);
-		  free (xtmp);
-		}
-	    }
-        }
-      if (tmp != NULL)
-	free (tmp);
-      i++;
-    }
-  while (tags != NULL)
+		    strlen ("text/html")))
+    return; /* not HTML */
+  memset (&s, 0, sizeof (s));
+  s.ec = ec;
+  if (NULL == (s.buf = malloc (iret + SCAN_CHUNK_SIZE)))
+    return;
+  s.buf_size = iret + SCAN_CHUNK_SIZE;
+  memcpy (s.buf, data, iret);
+  s.end = iret;
+#if HAVE_TIDY
+  if (SCAN_MALFORMED == scan_head (&s))
     {
-      t = tags;
-      if ( (tagMatch ("title", t->tagStart, t->tagEnd)) &&
-	   (ret == 0) )
-	{
-	  if (charset == NULL)
-	    {
-	      xtmp = malloc (t->dataEnd - t->dataStart + 1);
-	      if (xtmp != NULL)
-		{
-		  memcpy (xtmp, t->dataStart, t->dataEnd - t->dataStart);
-		  xtmp[t->dataEnd - t->dataStart] = '\0';
-		  ret = proc (proc_cls,
-			      "html",
-			      EXTRACTOR_METATYPE_TITLE,
-			      EXTRACTOR_METAFORMAT_C_STRING,
-			      "text/plain",
-			      xtmp,
-			      strlen (xtmp) + 1);
-		  free (xtmp);
-		}
-	    }
-	  else
-	    {
-	      xtmp = EXTRACTOR_common_convert_to_utf8 (t->dataStart,
-						       t->dataEnd - t->dataStart,
-						       charset);
-	      if (xtmp != NULL)
-		{
-		  ret = proc (proc_cls,
-			      "html",
-			      EXTRACTOR_METATYPE_TITLE,
-			      EXTRACTOR_METAFORMAT_UTF8,
-			      "text/plain",
-			      xtmp,
-			      strlen (xtmp) + 1);
-		  free (xtmp);
-		}
-	    }
-	}
-      tags = t->next;
-      free (t);
+      scanner_free (&s);
+      if (0 == ec->seek (ec->cls, 0, SEEK_SET))
+	extract_with_tidy (ec);
+      return;
     }
-  if (charset != NULL)
-    free (charset);
-  return ret;
-}
+#else
+  /* without libtidy we report whatever we found, even if the
+     document ended inside of a token */
+  (void) scan_head (&s);
 #endif
-
-
-/**
- * Initialize glib and load magic file.
- */
-void __attribute__ ((constructor))
-html_gobject_init ()
-{
-  magic = magic_open (MAGIC_MIME_TYPE);
-  if (0 != magic_load (magic, NULL))
-    {
-      /* FIXME: how to deal with errors? */
-    }
-}
-
-
-/**
- * Destructor for the library, cleans up.
- */
-void __attribute__ ((destructor))
-html_ltdl_fini ()
-{
-  if (NULL != magic)
-    {
-      magic_close (magic);
-      magic = NULL;
-    }
+  report_items (&s);
+  scanner_free (&s);
 }
 
 /* end of html_extractor.c */
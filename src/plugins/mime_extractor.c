@@ -19,16 +19,18 @@
  */
 /**
  * @file plugins/mime_extractor.c
- * @brief plugin to determine mime types using libmagic (from 'file')
+ * @brief plugin to determine mime types using built-in signatures
+ *        and libmagic (from 'file')
  * @author Christian Grothoff
  */
 #include "platform.h"
 #include "extractor.h"
+#include "mime_signatures.h"
 #include <magic.h>
 
 
 /**
- * Global handle to MAGIC data.
+ * Global handle to MAGIC data, NULL until we first need it.
  */
 static magic_t magic;
 
@@ -39,70 +41,88 @@ static char *magic_path;
  
 
 /**
- * Main entry method for the 'application/ogg' extraction plugin.  The
- * 'config' of the context can be used to specify an alternative magic
- * path.  If config is not given, the default magic path will be
- * used.
+ * Ask libmagic for the MIME type of the given data, (re)loading
+ * the magic data if we have not loaded it yet or if the magic path
+ * changed.
  *
- * @param ec extraction context provided to the plugin
+ * @param config magic path to use, NULL for the default
+ * @param buf data to analyze
+ * @param size number of bytes in @a buf
+ * @return MIME type, NULL on error
  */
-void
-EXTRACTOR_mime_extract_method (struct EXTRACTOR_ExtractContext *ec)
+static const char *
+get_magic_mime_type (const char *config,
+		     const void *buf,
+		     size_t size)
 {
-  void *buf;
-  ssize_t ret;
-  const char *mime;
-
-  ret = ec->read (ec->cls,
-		  &buf,
-		  16 * 1024);
-  if (-1 == ret)
-    return;
-  if ( ( (NULL == magic_path) &&
-	 (NULL != ec->config) ) ||
+  if ( (NULL == magic) ||
+       ( (NULL == magic_path) &&
+	 (NULL != config) ) ||
        ( (NULL != magic_path) &&
-	 (NULL == ec->config) ) ||
+	 (NULL == config) ) ||
        ( (NULL != magic_path) &&
-	 (NULL != ec->config) &&
+	 (NULL != config) &&
 	 (0 != strcmp (magic_path,
-		       ec->config) )) )
+		       config) )) )
     {
       if (NULL != magic_path)
-	free (magic_path);		
-      magic_close (magic);
+	free (magic_path);
+      if (NULL != magic)
+	magic_close (magic);
       magic = magic_open (MAGIC_MIME_TYPE);
-      if (0 != magic_load (magic, ec->config))
+      if (0 != magic_load (magic, config))
 	{
 	  /* FIXME: report errors? */
 	}
-      if (NULL != ec->config)
-	magic_path = strdup (ec->config);
+      if (NULL != config)
+	magic_path = strdup (config);
       else
 	magic_path = NULL;
     }
-  if (NULL == (mime = magic_buffer (magic, buf, ret)))
-    return;
-  ec->proc (ec->cls,
-	    "mime",
-	    EXTRACTOR_METATYPE_MIMETYPE,
-	    EXTRACTOR_METAFORMAT_UTF8,
-	    "text/plain",
-	    mime,
-	    strlen (mime) + 1);
+  if (NULL == magic)
+    return NULL;
+  return magic_buffer (magic, buf, size);
 }
 
 
 /**
- * Constructor for the library.  Loads the magic file.
+ * Main entry method for the 'application/ogg' extraction plugin.  The
+ * 'config' of the context can be used to specify an alternative magic
+ * path.  If config is not given, the default magic path will be
+ * used.
+ *
+ * @param ec extraction context provided to the plugin
  */
-void __attribute__ ((constructor)) 
-mime_ltdl_init () 
+void
+EXTRACTOR_mime_extract_method (struct EXTRACTOR_ExtractContext *ec)
 {
-  magic = magic_open (MAGIC_MIME_TYPE);
-  if (0 != magic_load (magic, magic_path))
+  void *buf;
+  ssize_t ret;
+  const char *mime;
+
+  /* our built-in signatures match the default magic data; with a
+     custom magic file, only libmagic can tell */
+  if ( (NULL != ec->config) ||
+       (NULL == (mime = ec->mime_hint)) )
     {
-      /* FIXME: how to deal with errors? */
+      ret = ec->read (ec->cls,
+		      &buf,
+		      16 * 1024);
+      if (-1 == ret)
+	return;
+      if ( (NULL != ec->config) ||
+	   (NULL == (mime = EXTRACTOR_common_get_mime_type (buf, ret))) )
+	mime = get_magic_mime_type (ec->config, buf, ret);
+      if (NULL == mime)
+	return;
     }
+  ec->proc (ec->cls,
+	    "mime",
+	    EXTRACTOR_METATYPE_MIMETYPE,
+	    EXTRACTOR_METAFORMAT_UTF8,
+	    "text/plain",
+	    mime,
+	    strlen (mime) + 1);
 }
 
 
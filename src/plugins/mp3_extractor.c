@@ -0,0 +1,1898 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+ */
+/**
+ * @file plugins/mp3_extractor.c
+ * @brief plugin to support MPEG audio (MP3) files
+ *
+ * We parse the ID3v2 tag at the start of the file, the first MPEG
+ * audio frame (and the Xing/Info/LAME or VBRI header in it) and the
+ * APEv2 and ID3v1 tags at the end.  The duration is taken from the
+ * frame count in the VBR header (or computed from the bitrate for
+ * CBR files), so we never have to scan the audio frames.
+ */
+#include "platform.h"
+#include "extractor.h"
+#include "convert.h"
+#include "genres.h"
+#include <stdint.h>
+
+
+/**
+ * Maximum size of an ID3v2 tag that we read into memory as a whole
+ * (only needed for tags using unsynchronisation).
+ */
+#define MAX_ID3V2_SIZE (16 * 1024 * 1024)
+
+/**
+ * Maximum size of an ID3v2 frame we are willing to process.
+ */
+#define MAX_ID3V2_FRAME_SIZE (16 * 1024 * 1024)
+
+/**
+ * Maximum size of an APEv2 tag we are willing to process.
+ */
+#define MAX_APE_SIZE (16 * 1024 * 1024)
+
+/**
+ * How far past the ID3v2 tag we search for the first audio frame.
+ */
+#define MAX_SYNC_SEARCH (64 * 1024)
+
+/**
+ * Size of the buffer we search for frames in.  Must be larger
+ * than three of the largest possible MPEG audio frames.
+ */
+#define SYNC_WINDOW (16 * 1024)
+
+/**
+ * How much we read at a time while searching for frames.
+ */
+#define SYNC_CHUNK 4096
+
+/**
+ * Forward gaps up to this size are skipped by reading over them
+ * instead of seeking.
+ */
+#define MAX_SKIP_READ 256
+
+/**
+ * Size of an ID3v1 tag.
+ */
+#define ID3V1_SIZE 128
+
+/**
+ * Size of the APEv2 header and footer.
+ */
+#define APE_FOOTER_SIZE 32
+
+
+/**
+ * MPEG audio versions.
+ */
+enum MpegVersion
+{
+  MPEG_V1 = 0,
+  MPEG_V2 = 1,
+  MPEG_V25 = 2
+};
+
+
+/**
+ * Bitrates (kbps) by bitrate index, for MPEG-1 layers I, II and III
+ * and MPEG-2/2.5 layers I and II/III.
+ */
+static const unsigned int bitrate_table[16][5] =
+  {
+    { 0, 0, 0, 0, 0 },
+    { 32, 32, 32, 32, 8 },
+    { 64, 48, 40, 48, 16 },
+    { 96, 56, 48, 56, 24 },
+    { 128, 64, 56, 64, 32 },
+    { 160, 80, 64, 80, 40 },
+    { 192, 96, 80, 96, 48 },
+    { 224, 112, 96, 112, 56 },
+    { 256, 128, 112, 128, 64 },
+    { 288, 160, 128, 144, 80 },
+    { 320, 192, 160, 160, 96 },
+    { 352, 224, 192, 176, 112 },
+    { 384, 256, 224, 192, 128 },
+    { 416, 320, 256, 224, 144 },
+    { 448, 384, 320, 256, 160 },
+    { 0, 0, 0, 0, 0 }
+  };
+
+
+/**
+ * Sampling rates by frequency index and MPEG version.
+ */
+static const unsigned int freq_table[3][3] =
+  {
+    { 44100, 22050, 11025 },
+    { 48000, 24000, 12000 },
+    { 32000, 16000, 8000 }
+  };
+
+
+/**
+ * Names of the channel modes.
+ */
+static const char * const channel_modes[4] =
+  {
+    gettext_noop ("stereo"),
+    gettext_noop ("joint stereo"),
+    gettext_noop ("dual channel"),
+    gettext_noop ("mono")
+  };
+
+
+/**
+ * Names of the MPEG versions.
+ */
+static const char * const mpeg_versions[3] =
+  {
+    "MPEG-1",
+    "MPEG-2",
+    "MPEG-2.5"
+  };
+
+
+/**
+ * Names of the layers.
+ */
+static const char * const layer_names[3] =
+  {
+    "Layer I",
+    "Layer II",
+    "Layer III"
+  };
+
+
+/**
+ * How the payload of an ID3v2 frame is structured.
+ */
+enum FrameKind
+{
+  /**
+   * Text information frame (T???).
+   */
+  FRAME_TEXT,
+
+  /**
+   * Content type (TCON), may refer to ID3v1 genres.
+   */
+  FRAME_GENRE,
+
+  /**
+   * User defined text information frame (TXXX).
+   */
+  FRAME_USER_TEXT,
+
+  /**
+   * URL link frame (W???).
+   */
+  FRAME_URL,
+
+  /**
+   * User defined URL link frame (WXXX).
+   */
+  FRAME_USER_URL,
+
+  /**
+   * Comment or unsynchronised lyrics (COMM, USLT).
+   */
+  FRAME_COMMENT,
+
+  /**
+   * Attached picture (APIC).
+   */
+  FRAME_PICTURE
+};
+
+
+/**
+ * Mapping of ID3v2 frames to LE types.
+ */
+struct FrameMap
+{
+  /**
+   * Three-character frame ID used by ID3v2.2.
+   */
+  const char *id22;
+
+  /**
+   * Four-character frame ID used by ID3v2.3 and ID3v2.4.
+   */
+  const char *id;
+
+  /**
+   * How the frame is structured.
+   */
+  enum FrameKind kind;
+
+  /**
+   * LE type of the frame's value.
+   */
+  enum EXTRACTOR_MetaType type;
+};
+
+
+/**
+ * ID3v2 frames we extract.
+ */
+static const struct FrameMap frame_map[] =
+  {
+    { "TT1", "TIT1", FRAME_TEXT, EXTRACTOR_METATYPE_GROUPING },
+    { "TT2", "TIT2", FRAME_TEXT, EXTRACTOR_METATYPE_TITLE },
+    { "TT3", "TIT3", FRAME_TEXT, EXTRACTOR_METATYPE_SUBTITLE },
+    { "TP1", "TPE1", FRAME_TEXT, EXTRACTOR_METATYPE_ARTIST },
+    { "TP2", "TPE2", FRAME_TEXT, EXTRACTOR_METATYPE_PERFORMER },
+    { "TP3", "TPE3", FRAME_TEXT, EXTRACTOR_METATYPE_CONDUCTOR },
+    { "TP4", "TPE4", FRAME_TEXT, EXTRACTOR_METATYPE_INTERPRETATION },
+    { "TCM", "TCOM", FRAME_TEXT, EXTRACTOR_METATYPE_COMPOSER },
+    { "TXT", "TEXT", FRAME_TEXT, EXTRACTOR_METATYPE_WRITER },
+    { "TAL", "TALB", FRAME_TEXT, EXTRACTOR_METATYPE_ALBUM },
+    { "TRK", "TRCK", FRAME_TEXT, EXTRACTOR_METATYPE_TRACK_NUMBER },
+    { "TPA", "TPOS", FRAME_TEXT, EXTRACTOR_METATYPE_DISC_NUMBER },
+    { "TYE", "TYER", FRAME_TEXT, EXTRACTOR_METATYPE_PUBLICATION_YEAR },
+    { NULL, "TDRC", FRAME_TEXT, EXTRACTOR_METATYPE_CREATION_DATE },
+    { NULL, "TDRL", FRAME_TEXT, EXTRACTOR_METATYPE_PUBLICATION_DATE },
+    { "TOR", "TORY", FRAME_TEXT, EXTRACTOR_METATYPE_ORIGINAL_RELEASE_YEAR },
+    { NULL, "TDOR", FRAME_TEXT, EXTRACTOR_METATYPE_ORIGINAL_RELEASE_YEAR },
+    { "TCO", "TCON", FRAME_GENRE, EXTRACTOR_METATYPE_GENRE },
+    { "TEN", "TENC", FRAME_TEXT, EXTRACTOR_METATYPE_ENCODED_BY },
+    { "TSS", "TSSE", FRAME_TEXT, EXTRACTOR_METATYPE_ENCODER },
+    { "TCR", "TCOP", FRAME_TEXT, EXTRACTOR_METATYPE_COPYRIGHT },
+    { "TPB", "TPUB", FRAME_TEXT, EXTRACTOR_METATYPE_PUBLISHER },
+    { "TBP", "TBPM", FRAME_TEXT, EXTRACTOR_METATYPE_BEATS_PER_MINUTE },
+    { "TLA", "TLAN", FRAME_TEXT, EXTRACTOR_METATYPE_LANGUAGE },
+    { "TRC", "TSRC", FRAME_TEXT, EXTRACTOR_METATYPE_ISRC },
+    { "TOT", "TOAL", FRAME_TEXT, EXTRACTOR_METATYPE_ORIGINAL_TITLE },
+    { "TOA", "TOPE", FRAME_TEXT, EXTRACTOR_METATYPE_ORIGINAL_ARTIST },
+    { "TOL", "TOLY", FRAME_TEXT, EXTRACTOR_METATYPE_ORIGINAL_WRITER },
+    { "TMT", "TMED", FRAME_TEXT, EXTRACTOR_METATYPE_SOURCE },
+    { NULL, "TMOO", FRAME_TEXT, EXTRACTOR_METATYPE_MOOD },
+    { NULL, "TRSN", FRAME_TEXT, EXTRACTOR_METATYPE_NETWORK_NAME },
+    { "TXX", "TXXX", FRAME_USER_TEXT, EXTRACTOR_METATYPE_UNKNOWN },
+    { "WAR", "WOAR", FRAME_URL, EXTRACTOR_METATYPE_URL },
+    { "WAS", "WOAS", FRAME_URL, EXTRACTOR_METATYPE_URL },
+    { "WAF", "WOAF", FRAME_URL, EXTRACTOR_METATYPE_URL },
+    { "WCM", "WCOM", FRAME_URL, EXTRACTOR_METATYPE_URL },
+    { "WPB", "WPUB", FRAME_URL, EXTRACTOR_METATYPE_URL },
+    { "WXX", "WXXX", FRAME_USER_URL, EXTRACTOR_METATYPE_URL },
+    { "COM", "COMM", FRAME_COMMENT, EXTRACTOR_METATYPE_COMMENT },
+    { "ULT", "USLT", FRAME_COMMENT, EXTRACTOR_METATYPE_LYRICS },
+    { "PIC", "APIC", FRAME_PICTURE, EXTRACTOR_METATYPE_PICTURE },
+    { NULL, NULL, FRAME_TEXT, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * Mapping of APEv2 item keys to LE types.
+ */
+struct ApeMap
+{
+  /**
+   * Item key (compared case-insensitively).
+   */
+  const char *key;
+
+  /**
+   * Corresponding LE type.
+   */
+  enum EXTRACTOR_MetaType type;
+};
+
+
+/**
+ * APEv2 items we extract.
+ */
+static const struct ApeMap ape_map[] =
+  {
+    { "Title", EXTRACTOR_METATYPE_TITLE },
+    { "Subtitle", EXTRACTOR_METATYPE_SUBTITLE },
+    { "Artist", EXTRACTOR_METATYPE_ARTIST },
+    { "Album", EXTRACTOR_METATYPE_ALBUM },
+    { "Album Artist", EXTRACTOR_METATYPE_PERFORMER },
+    { "Composer", EXTRACTOR_METATYPE_COMPOSER },
+    { "Conductor", EXTRACTOR_METATYPE_CONDUCTOR },
+    { "Publisher", EXTRACTOR_METATYPE_PUBLISHER },
+    { "Comment", EXTRACTOR_METATYPE_COMMENT },
+    { "Copyright", EXTRACTOR_METATYPE_COPYRIGHT },
+    { "Year", EXTRACTOR_METATYPE_PUBLICATION_YEAR },
+    { "Track", EXTRACTOR_METATYPE_TRACK_NUMBER },
+    { "Disc", EXTRACTOR_METATYPE_DISC_NUMBER },
+    { "Genre", EXTRACTOR_METATYPE_GENRE },
+    { "Language", EXTRACTOR_METATYPE_LANGUAGE },
+    { "ISRC", EXTRACTOR_METATYPE_ISRC },
+    { "Lyrics", EXTRACTOR_METATYPE_LYRICS },
+    { "Media", EXTRACTOR_METATYPE_SOURCE },
+    { NULL, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * Header of an MPEG audio frame.
+ */
+struct FrameHeader
+{
+  /**
+   * MPEG version.
+   */
+  enum MpegVersion version;
+
+  /**
+   * Layer (1 to 3).
+   */
+  unsigned int layer;
+
+  /**
+   * Bitrate in kbps.
+   */
+  unsigned int bitrate;
+
+  /**
+   * Sampling rate in Hz.
+   */
+  unsigned int sample_rate;
+
+  /**
+   * Channel mode (index into #channel_modes).
+   */
+  unsigned int channel_mode;
+
+  /**
+   * Copyright bit.
+   */
+  int copyright;
+
+  /**
+   * Original bit.
+   */
+  int original;
+
+  /**
+   * Size of the frame in bytes (including the header).
+   */
+  unsigned int size;
+
+  /**
+   * Number of samples per channel in the frame.
+   */
+  unsigned int samples;
+};
+
+
+/**
+ * Parser state.
+ */
+struct Mp3Context
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Current offset in the file.
+   */
+  uint64_t pos;
+
+  /**
+   * Size of the file.
+   */
+  uint64_t fsize;
+
+  /**
+   * Offset of the first byte after the ID3v2 tag (0 if there
+   * is none).
+   */
+  uint64_t audio_start;
+
+  /**
+   * Offset of the first byte of the trailing tags (APEv2, ID3v1),
+   * or the file size if there are none.
+   */
+  uint64_t audio_end;
+
+  /**
+   * Set if we found an ID3v2 tag.
+   */
+  int have_id3v2;
+};
+
+
+/**
+ * State of the ID3v2 tag we are parsing.
+ */
+struct Id3v2Tag
+{
+  /**
+   * Tag contents after the header, if we had to read the whole
+   * tag into memory (unsynchronisation); NULL if we read the
+   * frames directly from the file.
+   */
+  unsigned char *mem;
+
+  /**
+   * Current offset in @e mem.
+   */
+  size_t mem_pos;
+
+  /**
+   * Number of bytes of the tag left to parse.
+   */
+  size_t remaining;
+
+  /**
+   * Major version (2, 3 or 4).
+   */
+  unsigned int version;
+};
+
+
+/**
+ * Give a string to the metadata processor.
+ *
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param str 0-terminated UTF-8 string
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_string (struct Mp3Context *ctx,
+	    enum EXTRACTOR_MetaType type,
+	    const char *str)
+{
+  if ('\0' == str[0])
+    return 0;
+  return ctx->ec->proc (ctx->ec->cls,
+			"mp3",
+			type,
+			EXTRACTOR_METAFORMAT_UTF8,
+			"text/plain",
+			str,
+			strlen (str) + 1);
+}
+
+
+/**
+ * Read up to @a size bytes from the current position.
+ *
+ * @param ctx parser state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return number of bytes read (less than @a size at the end of the file)
+ */
+static size_t
+read_some (struct Mp3Context *ctx,
+	   void *buf,
+	   size_t size)
+{
+  unsigned char *dst = buf;
+  void *data;
+  ssize_t ret;
+  size_t done;
+
+  done = 0;
+  while (done < size)
+    {
+      if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, size - done)))
+	break;
+      memcpy (&dst[done], data, ret);
+      done += ret;
+    }
+  ctx->pos += done;
+  return done;
+}
+
+
+/**
+ * Read exactly @a size bytes from the current position.
+ *
+ * @param ctx parser state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or short file)
+ */
+static int
+read_fully (struct Mp3Context *ctx,
+	    void *buf,
+	    size_t size)
+{
+  return (size == read_some (ctx, buf, size)) ? 0 : -1;
+}
+
+
+/**
+ * Move to the given absolute offset.
+ *
+ * @param ctx parser state
+ * @param pos target offset
+ * @return 0 on success, -1 on error
+ */
+static int
+seek_to (struct Mp3Context *ctx,
+	 uint64_t pos)
+{
+  void *data;
+  ssize_t ret;
+
+  if (pos == ctx->pos)
+    return 0;
+  if ( (pos > ctx->pos) &&
+       (pos - ctx->pos <= MAX_SKIP_READ) )
+    {
+      while (ctx->pos < pos)
+	{
+	  if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, pos - ctx->pos)))
+	    return -1;
+	  ctx->pos += ret;
+	}
+      return 0;
+    }
+  if ( (pos > INT64_MAX) ||
+       ((int64_t) pos != ctx->ec->seek (ctx->ec->cls, (int64_t) pos, SEEK_SET)) )
+    return -1;
+  ctx->pos = pos;
+  return 0;
+}
+
+
+/**
+ * Get a 32-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint32_t
+get_be32 (const unsigned char *p)
+{
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+    ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+
+/**
+ * Get a 32-bit little endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint32_t
+get_le32 (const unsigned char *p)
+{
+  return ((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16) |
+    ((uint32_t) p[1] << 8) | (uint32_t) p[0];
+}
+
+
+/**
+ * Get a 28-bit "syncsafe" integer (7 bits per byte) from a buffer.
+ *
+ * @param p where to read
+ * @param value set to the value
+ * @return 0 on success, -1 if a byte has its top bit set
+ */
+static int
+get_syncsafe (const unsigned char *p,
+	      uint32_t *value)
+{
+  if (0 != ((p[0] | p[1] | p[2] | p[3]) & 0x80))
+    return -1;
+  *value = ((uint32_t) p[0] << 21) | ((uint32_t) p[1] << 14) |
+    ((uint32_t) p[2] << 7) | (uint32_t) p[3];
+  return 0;
+}
+
+
+/**
+ * Undo unsynchronisation (remove the 0x00 inserted after every
+ * 0xFF) in place.
+ *
+ * @param data data to resynchronise
+ * @param size number of bytes in @a data
+ * @return new number of bytes in @a data
+ */
+static size_t
+resync (unsigned char *data,
+	size_t size)
+{
+  size_t i;
+  size_t j;
+
+  for (i = 0, j = 0; i < size; i++)
+    {
+      data[j++] = data[i];
+      if ( (0xFF == data[i]) &&
+	   (i + 1 < size) &&
+	   (0x00 == data[i + 1]) )
+	i++;
+    }
+  return j;
+}
+
+
+/**
+ * Decode the string at the beginning of @a data.
+ *
+ * @param enc ID3v2 text encoding (0: ISO-8859-1, 1: UTF-16 with BOM,
+ *        2: UTF-16BE, 3: UTF-8)
+ * @param data the string, possibly followed by a terminator
+ * @param size number of bytes in @a data
+ * @param consumed set to the number of bytes used (including
+ *        the terminator)
+ * @return the string as UTF-8, NULL if empty or on error
+ */
+static char *
+decode_string (unsigned char enc,
+	       const unsigned char *data,
+	       size_t size,
+	       size_t *consumed)
+{
+  const char *charset;
+  size_t len;
+
+  *consumed = size;
+  switch (enc)
+    {
+    case 0:
+      charset = "ISO-8859-1";
+      break;
+    case 1:
+      charset = "UTF-16";
+      break;
+    case 2:
+      charset = "UTF-16BE";
+      break;
+    case 3:
+      charset = "UTF-8";
+      break;
+    default:
+      return NULL;
+    }
+  if ( (1 == enc) ||
+       (2 == enc) )
+    {
+      for (len = 0; len + 1 < size; len += 2)
+	if ( (0 == data[len]) &&
+	     (0 == data[len + 1]) )
+	  break;
+      if (len + 1 < size)
+	*consumed = len + 2;
+      else
+	len = size & ~((size_t) 1);
+    }
+  else
+    {
+      for (len = 0; len < size; len++)
+	if (0 == data[len])
+	  break;
+      if (len < size)
+	*consumed = len + 1;
+    }
+  if (0 == len)
+    return NULL;
+  return EXTRACTOR_common_convert_to_utf8 ((const char *) data,
+					   len,
+					   charset);
+}
+
+
+/**
+ * Report a genre, resolving references to the ID3v1 genre list
+ * ("(17)", "(17)Rock" or "17").
+ *
+ * @param ctx parser state
+ * @param genre the genre as given in the tag
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+add_genre (struct Mp3Context *ctx,
+	   const char *genre)
+{
+  const char *end;
+  const char *name;
+  unsigned long idx;
+  char *endp;
+
+  if ('(' == genre[0])
+    {
+      idx = strtoul (&genre[1], &endp, 10);
+      if ( (endp == &genre[1]) ||
+	   (')' != *endp) )
+	return add_string (ctx, EXTRACTOR_METATYPE_GENRE, genre);
+      end = endp + 1;
+      if ('\0' != *end)
+	return add_string (ctx, EXTRACTOR_METATYPE_GENRE, end);
+      if ( (idx <= UINT_MAX) &&
+	   (NULL != (name = EXTRACTOR_common_get_id3_genre (idx))) )
+	return add_string (ctx, EXTRACTOR_METATYPE_GENRE, _(name));
+      return 0;
+    }
+  idx = strtoul (genre, &endp, 10);
+  if ( (endp != genre) &&
+       ('\0' == *endp) )
+    {
+      if ( (idx <= UINT_MAX) &&
+	   (NULL != (name = EXTRACTOR_common_get_id3_genre (idx))) )
+	return add_string (ctx, EXTRACTOR_METATYPE_GENRE, _(name));
+      return 0;
+    }
+  return add_string (ctx, EXTRACTOR_METATYPE_GENRE, genre);
+}
+
+
+/**
+ * Determine the LE type for an attached picture.
+ *
+ * @param picture_type ID3v2 picture type
+ * @return LE type to use
+ */
+static enum EXTRACTOR_MetaType
+get_picture_type (unsigned char picture_type)
+{
+  switch (picture_type)
+    {
+    case 0x01: /* file icon */
+    case 0x02: /* other file icon */
+    case 0x03: /* front cover */
+      return EXTRACTOR_METATYPE_THUMBNAIL;
+    case 0x07: /* lead artist */
+    case 0x08: /* artist */
+    case 0x09: /* conductor */
+    case 0x0A: /* band */
+    case 0x0B: /* composer */
+    case 0x0C: /* lyricist */
+      return EXTRACTOR_METATYPE_CONTRIBUTOR_PICTURE;
+    case 0x0D: /* recording location */
+    case 0x0E: /* during recording */
+    case 0x0F: /* during performance */
+    case 0x10: /* video screen capture */
+      return EXTRACTOR_METATYPE_EVENT_PICTURE;
+    case 0x13: /* band logo */
+    case 0x14: /* publisher logo */
+      return EXTRACTOR_METATYPE_LOGO;
+    default:
+      return EXTRACTOR_METATYPE_PICTURE;
+    }
+}
+
+
+/**
+ * Check if the application wants any kind of picture.
+ *
+ * @param ec extraction context
+ * @return non-zero if pictures are wanted
+ */
+static int
+wants_pictures (struct EXTRACTOR_ExtractContext *ec)
+{
+  return ec->wants (ec->cls, EXTRACTOR_METATYPE_THUMBNAIL) ||
+    ec->wants (ec->cls, EXTRACTOR_METATYPE_PICTURE) ||
+    ec->wants (ec->cls, EXTRACTOR_METATYPE_CONTRIBUTOR_PICTURE) ||
+    ec->wants (ec->cls, EXTRACTOR_METATYPE_EVENT_PICTURE) ||
+    ec->wants (ec->cls, EXTRACTOR_METATYPE_LOGO);
+}
+
+
+/**
+ * Report an attached picture (APIC or PIC frame).
+ *
+ * @param ctx parser state
+ * @param version ID3v2 major version
+ * @param data frame payload
+ * @param size number of bytes in @a data
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+handle_picture (struct Mp3Context *ctx,
+		unsigned int version,
+		const unsigned char *data,
+		size_t size)
+{
+  char mime[64];
+  size_t off;
+  size_t len;
+  size_t consumed;
+  unsigned char picture_type;
+  char *desc;
+
+  if (size < 5)
+    return 0;
+  if (2 == version)
+    {
+      /* PIC has a three-character image format instead of a MIME type */
+      if (0 == memcmp (&data[1], "JPG", 3))
+	strcpy (mime, "image/jpeg");
+      else if (0 == memcmp (&data[1], "PNG", 3))
+	strcpy (mime, "image/png");
+      else
+	strcpy (mime, "application/octet-stream");
+      off = 4;
+    }
+  else
+    {
+      for (len = 0; 1 + len < size; len++)
+	if (0 == data[1 + len])
+	  break;
+      if (1 + len >= size)
+	return 0;
+      if ( (0 == len) ||
+	   (len >= sizeof (mime)) )
+	strcpy (mime, "application/octet-stream");
+      else
+	{
+	  memcpy (mime, &data[1], len);
+	  mime[len] = '\0';
+	}
+      if (0 == strcmp (mime, "-->"))
+	return 0; /* only a link to the picture */
+      if (NULL == strchr (mime, '/'))
+	{
+	  /* some taggers write "jpg" or "PNG" */
+	  if ( (0 == strcasecmp (mime, "jpg")) ||
+	       (0 == strcasecmp (mime, "jpeg")) )
+	    strcpy (mime, "image/jpeg");
+	  else if (0 == strcasecmp (mime, "png"))
+	    strcpy (mime, "image/png");
+	  else
+	    strcpy (mime, "application/octet-stream");
+	}
+      off = 1 + len + 1;
+    }
+  if (off >= size)
+    return 0;
+  picture_type = data[off++];
+  desc = decode_string (data[0], &data[off], size - off, &consumed);
+  free (desc);
+  off += consumed;
+  if (off >= size)
+    return 0;
+  return ctx->ec->proc (ctx->ec->cls,
+			"mp3",
+			get_picture_type (picture_type),
+			EXTRACTOR_METAFORMAT_BINARY,
+			mime,
+			(const char *) &data[off],
+			size - off);
+}
+
+
+/**
+ * Report the contents of an ID3v2 frame.
+ *
+ * @param ctx parser state
+ * @param fm what kind of frame this is
+ * @param version ID3v2 major version
+ * @param data frame payload
+ * @param size number of bytes in @a data
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+handle_frame (struct Mp3Context *ctx,
+	      const struct FrameMap *fm,
+	      unsigned int version,
+	      const unsigned char *data,
+	      size_t size)
+{
+  char *str;
+  char *desc;
+  char *kv;
+  size_t off;
+  size_t consumed;
+  size_t slen;
+  int ret;
+
+  if (0 == size)
+    return 0;
+  ret = 0;
+  switch (fm->kind)
+    {
+    case FRAME_TEXT:
+    case FRAME_GENRE:
+      /* ID3v2.4 allows several NUL-separated values */
+      for (off = 1; (0 == ret) && (off < size); off += consumed)
+	{
+	  if (NULL == (str = decode_string (data[0], &data[off], size - off, &consumed)))
+	    continue;
+	  if (FRAME_GENRE == fm->kind)
+	    ret = add_genre (ctx, str);
+	  else
+	    ret = add_string (ctx, fm->type, str);
+	  free (str);
+	}
+      return ret;
+    case FRAME_URL:
+      if (NULL == (str = decode_string (0, data, size, &consumed)))
+	return 0;
+      ret = add_string (ctx, fm->type, str);
+      free (str);
+      return ret;
+    case FRAME_USER_URL:
+      desc = decode_string (data[0], &data[1], size - 1, &consumed);
+      free (desc);
+      off = 1 + consumed;
+      if ( (off >= size) ||
+	   (NULL == (str = decode_string (0, &data[off], size - off, &consumed))) )
+	return 0;
+      ret = add_string (ctx, fm->type, str);
+      free (str);
+      return ret;
+    case FRAME_USER_TEXT:
+      desc = decode_string (data[0], &data[1], size - 1, &consumed);
+      off = 1 + consumed;
+      str = (off < size) ? decode_string (data[0], &data[off], size - off, &consumed) : NULL;
+      if ( (NULL != desc) &&
+	   (NULL != str) )
+	{
+	  slen = strlen (desc) + strlen (str) + 2;
+	  if (NULL != (kv = malloc (slen)))
+	    {
+	      snprintf (kv, slen, "%s=%s", desc, str);
+	      ret = add_string (ctx, fm->type, kv);
+	      free (kv);
+	    }
+	}
+      free (desc);
+      free (str);
+      return ret;
+    case FRAME_COMMENT:
+      /* encoding, language, short description, text */
+      if (size < 4)
+	return 0;
+      desc = decode_string (data[0], &data[4], size - 4, &consumed);
+      off = 4 + consumed;
+      if ( (NULL != desc) &&
+	   (0 == strncmp (desc, "iTun", strlen ("iTun"))) )
+	{
+	  /* iTunes keeps gapless and normalisation data in comments */
+	  free (desc);
+	  return 0;
+	}
+      free (desc);
+      if ( (off >= size) ||
+	   (NULL == (str = decode_string (data[0], &data[off], size - off, &consumed))) )
+	return 0;
+      ret = add_string (ctx, fm->type, str);
+      free (str);
+      return ret;
+    case FRAME_PICTURE:
+      return handle_picture (ctx, version, data, size);
+    }
+  return 0;
+}
+
+
+/**
+ * Read bytes of the ID3v2 tag.
+ *
+ * @param ctx parser state
+ * @param tag tag state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or end of tag)
+ */
+static int
+tag_read (struct Mp3Context *ctx,
+	  struct Id3v2Tag *tag,
+	  void *buf,
+	  size_t size)
+{
+  if (size > tag->remaining)
+    return -1;
+  if (NULL != tag->mem)
+    {
+      memcpy (buf, &tag->mem[tag->mem_pos], size);
+      tag->mem_pos += size;
+    }
+  else if (0 != read_fully (ctx, buf, size))
+    return -1;
+  tag->remaining -= size;
+  return 0;
+}
+
+
+/**
+ * Skip bytes of the ID3v2 tag.
+ *
+ * @param ctx parser state
+ * @param tag tag state
+ * @param size number of bytes to skip
+ * @return 0 on success, -1 on error (or end of tag)
+ */
+static int
+tag_skip (struct Mp3Context *ctx,
+	  struct Id3v2Tag *tag,
+	  size_t size)
+{
+  if (size > tag->remaining)
+    return -1;
+  if (NULL != tag->mem)
+    tag->mem_pos += size;
+  else if (0 != seek_to (ctx, ctx->pos + size))
+    return -1;
+  tag->remaining -= size;
+  return 0;
+}
+
+
+/**
+ * Parse the frames of an ID3v2 tag.
+ *
+ * @param ctx parser state
+ * @param tag tag state
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+parse_id3v2_frames (struct Mp3Context *ctx,
+		    struct Id3v2Tag *tag)
+{
+  unsigned char hdr[10];
+  unsigned char *data;
+  const struct FrameMap *fm;
+  unsigned int hdr_size;
+  uint32_t fsize;
+  size_t size;
+  size_t off;
+  unsigned int flags;
+  unsigned int i;
+  int ret;
+
+  hdr_size = (2 == tag->version) ? 6 : 10;
+  while (tag->remaining >= hdr_size)
+    {
+      if (0 != tag_read (ctx, tag, hdr, hdr_size))
+	return 0;
+      if (0 == hdr[0])
+	return 0; /* padding */
+      if (2 == tag->version)
+	{
+	  fsize = ((uint32_t) hdr[3] << 16) | ((uint32_t) hdr[4] << 8) | hdr[5];
+	  flags = 0;
+	}
+      else
+	{
+	  if (4 == tag->version)
+	    {
+	      if (0 != get_syncsafe (&hdr[4], &fsize))
+		return 0;
+	    }
+	  else
+	    fsize = get_be32 (&hdr[4]);
+	  flags = hdr[9];
+	}
+      if (fsize > tag->remaining)
+	return 0;
+      fm = NULL;
+      for (i = 0; NULL != frame_map[i].id; i++)
+	if ( (2 == tag->version)
+	     ? ( (NULL != frame_map[i].id22) &&
+		 (0 == memcmp (hdr, frame_map[i].id22, 3)) )
+	     : (0 == memcmp (hdr, frame_map[i].id, 4)) )
+	  {
+	    fm = &frame_map[i];
+	    break;
+	  }
+      if ( (NULL == fm) ||
+	   (fsize > MAX_ID3V2_FRAME_SIZE) ||
+	   ( (3 == tag->version) && (0 != (flags & 0xC0)) ) || /* compressed or encrypted */
+	   ( (4 == tag->version) && (0 != (flags & 0x0C)) ) ||
+	   ( (FRAME_PICTURE == fm->kind) && (! wants_pictures (ctx->ec)) ) )
+	{
+	  if (0 != tag_skip (ctx, tag, fsize))
+	    return 0;
+	  continue;
+	}
+      if (NULL == (data = malloc (fsize + 1)))
+	return 0;
+      if (0 != tag_read (ctx, tag, data, fsize))
+	{
+	  free (data);
+	  return 0;
+	}
+      size = fsize;
+      off = 0;
+      if ( (3 == tag->version) &&
+	   (0 != (flags & 0x20)) )
+	off++; /* group identifier */
+      if (4 == tag->version)
+	{
+	  if (0 != (flags & 0x40))
+	    off++; /* group identifier */
+	  if (0 != (flags & 0x01))
+	    off += 4; /* data length indicator */
+	  if ( (off <= size) &&
+	       (0 != (flags & 0x02)) )
+	    size = off + resync (&data[off], size - off);
+	}
+      ret = (off <= size)
+	? handle_frame (ctx, fm, tag->version, &data[off], size - off)
+	: 0;
+      free (data);
+      if (0 != ret)
+	return 1;
+    }
+  return 0;
+}
+
+
+/**
+ * Parse the ID3v2 tag at the beginning of the file (if any)
+ * and set the start of the audio data.
+ *
+ * @param ctx parser state
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+parse_id3v2 (struct Mp3Context *ctx)
+{
+  unsigned char hdr[10];
+  unsigned char ext[4];
+  struct Id3v2Tag tag;
+  uint32_t size;
+  uint32_t ext_size;
+  int ret;
+
+  if ( (0 != seek_to (ctx, 0)) ||
+       (0 != read_fully (ctx, hdr, sizeof (hdr))) ||
+       (0 != memcmp (hdr, "ID3", 3)) ||
+       (hdr[3] < 2) ||
+       (hdr[3] > 4) ||
+       (0xFF == hdr[4]) ||
+       (0 != get_syncsafe (&hdr[6], &size)) )
+    return 0;
+  ctx->have_id3v2 = 1;
+  ctx->audio_start = sizeof (hdr) + size;
+  if ( (4 == hdr[3]) &&
+       (0 != (hdr[5] & 0x10)) )
+    ctx->audio_start += 10; /* footer */
+  if ( (2 == hdr[3]) &&
+       (0 != (hdr[5] & 0x40)) )
+    return 0; /* ID3v2.2 compression was never defined */
+  memset (&tag, 0, sizeof (tag));
+  tag.version = hdr[3];
+  tag.remaining = size;
+  if ( (4 != tag.version) &&
+       (0 != (hdr[5] & 0x80)) )
+    {
+      /* the whole tag is unsynchronised, resync it in memory */
+      if (size > MAX_ID3V2_SIZE)
+	return 0;
+      if (NULL == (tag.mem = malloc (size)))
+	return 0;
+      if (0 != read_fully (ctx, tag.mem, size))
+	{
+	  free (tag.mem);
+	  return 0;
+	}
+      tag.remaining = resync (tag.mem, size);
+    }
+  ret = 0;
+  if ( (2 != tag.version) &&
+       (0 != (hdr[5] & 0x40)) )
+    {
+      /* skip the extended header */
+      if (0 != tag_read (ctx, &tag, ext, sizeof (ext)))
+	goto CLEANUP;
+      if (3 == tag.version)
+	ext_size = get_be32 (ext);
+      else if ( (0 != get_syncsafe (ext, &ext_size)) ||
+		(ext_size < sizeof (ext)) )
+	goto CLEANUP;
+      else
+	ext_size -= sizeof (ext);
+      if (0 != tag_skip (ctx, &tag, ext_size))
+	goto CLEANUP;
+    }
+  ret = parse_id3v2_frames (ctx, &tag);
+ CLEANUP:
+  free (tag.mem);
+  return ret;
+}
+
+
+/**
+ * Parse the header of an MPEG audio frame.
+ *
+ * @param p the four header bytes
+ * @param fh set to the parsed header
+ * @return 0 on success, -1 if this is not a valid header
+ */
+static int
+parse_frame_header (const unsigned char *p,
+		    struct FrameHeader *fh)
+{
+  unsigned int bitrate_idx;
+  unsigned int freq_idx;
+  unsigned int column;
+  unsigned int padding;
+
+  if ( (0xFF != p[0]) ||
+       (0xE0 != (p[1] & 0xE0)) )
+    return -1;
+  switch ((p[1] >> 3) & 0x03)
+    {
+    case 0:
+      fh->version = MPEG_V25;
+      break;
+    case 2:
+      fh->version = MPEG_V2;
+      break;
+    case 3:
+      fh->version = MPEG_V1;
+      break;
+    default:
+      return -1;
+    }
+  if (0 == (fh->layer = 4 - ((p[1] >> 1) & 0x03)))
+    return -1;
+  if (4 == fh->layer)
+    return -1;
+  bitrate_idx = (p[2] >> 4) & 0x0F;
+  freq_idx = (p[2] >> 2) & 0x03;
+  if ( (0 == bitrate_idx) ||  /* free format */
+       (15 == bitrate_idx) ||
+       (3 == freq_idx) )
+    return -1;
+  if (MPEG_V1 == fh->version)
+    column = fh->layer - 1;
+  else
+    column = (1 == fh->layer) ? 3 : 4;
+  fh->bitrate = bitrate_table[bitrate_idx][column];
+  fh->sample_rate = freq_table[freq_idx][fh->version];
+  padding = (p[2] >> 1) & 0x01;
+  fh->channel_mode = (p[3] >> 6) & 0x03;
+  fh->copyright = (p[3] >> 3) & 0x01;
+  fh->original = (p[3] >> 2) & 0x01;
+  if (1 == fh->layer)
+    {
+      fh->samples = 384;
+      fh->size = (12000 * fh->bitrate / fh->sample_rate + padding) * 4;
+    }
+  else if ( (3 == fh->layer) &&
+	    (MPEG_V1 != fh->version) )
+    {
+      fh->samples = 576;
+      fh->size = 72000 * fh->bitrate / fh->sample_rate + padding;
+    }
+  else
+    {
+      fh->samples = 1152;
+      fh->size = 144000 * fh->bitrate / fh->sample_rate + padding;
+    }
+  if (fh->size < 21)
+    return -1;
+  return 0;
+}
+
+
+/**
+ * Check if the frame at @a p is a plausible successor of the
+ * frame described by @a first.
+ *
+ * @param p header bytes of the next frame
+ * @param first header of the previous frame
+ * @param next set to the header of the next frame
+ * @return 0 if so, -1 if not
+ */
+static int
+check_next_frame (const unsigned char *p,
+		  const struct FrameHeader *first,
+		  struct FrameHeader *next)
+{
+  if ( (0 != parse_frame_header (p, next)) ||
+       (next->version != first->version) ||
+       (next->layer != first->layer) ||
+       (next->sample_rate != first->sample_rate) )
+    return -1;
+  return 0;
+}
+
+
+/**
+ * Find the first audio frame and copy it to @a frame.
+ *
+ * We require two consecutive frames (three if the file had no
+ * ID3v2 tag) with consistent headers to avoid false positives.
+ * The data is read sequentially in chunks of #SYNC_CHUNK bytes,
+ * so usually a single read is enough.
+ *
+ * @param ctx parser state
+ * @param frame where to store the first frame (at least #SYNC_WINDOW bytes)
+ * @param fh set to the header of the first frame
+ * @param frame_offset set to the offset of the first frame
+ * @param avail set to the number of bytes stored in @a frame
+ * @return 0 on success, -1 if no frame was found
+ */
+static int
+find_first_frame (struct Mp3Context *ctx,
+		  unsigned char *frame,
+		  struct FrameHeader *fh,
+		  uint64_t *frame_offset,
+		  size_t *avail)
+{
+  struct FrameHeader next;
+  uint64_t off;
+  size_t got;
+  size_t want;
+  size_t i;
+  size_t j;
+  unsigned int needed;
+  unsigned int found;
+  int eof;
+
+  needed = ctx->have_id3v2 ? 2 : 3;
+  off = ctx->audio_start;
+  if (0 != seek_to (ctx, off))
+    return -1;
+  got = read_some (ctx, frame, SYNC_CHUNK);
+  eof = (got < SYNC_CHUNK);
+  i = 0;
+  while (1)
+    {
+      for (; i + 4 <= got; i++)
+	{
+	  if (0 != parse_frame_header (&frame[i], fh))
+	    continue;
+	  j = i;
+	  next = *fh;
+	  for (found = 1; found < needed; found++)
+	    {
+	      j += next.size;
+	      if ( (j + 4 > got) ||
+		   (0 != check_next_frame (&frame[j], fh, &next)) )
+		break;
+	    }
+	  if ( (found < needed) &&
+	       (j + 4 <= got) )
+	    continue; /* inconsistent successor */
+	  if ( (found < needed) &&
+	       (! eof) &&
+	       ( (got < SYNC_WINDOW) || (i > 0) ) )
+	    break; /* need more data to decide */
+	  /* either enough frames, or the chain ran into the end of the file */
+	  if (i > 0)
+	    memmove (frame, &frame[i], got - i);
+	  *frame_offset = off + i;
+	  *avail = got - i;
+	  return 0;
+	}
+      if ( (eof) ||
+	   (off + i >= ctx->audio_start + MAX_SYNC_SEARCH) )
+	return -1;
+      /* drop what we have looked at and append the next chunk */
+      memmove (frame, &frame[i], got - i);
+      off += i;
+      got -= i;
+      i = 0;
+      want = SYNC_WINDOW - got;
+      if (want > SYNC_CHUNK)
+	want = SYNC_CHUNK;
+      j = read_some (ctx, &frame[got], want);
+      eof = (j < want);
+      got += j;
+    }
+}
+
+
+/**
+ * Information from the Xing/Info/LAME or VBRI header.
+ */
+struct VbrInfo
+{
+  /**
+   * Number of audio frames, 0 if unknown.
+   */
+  uint32_t frames;
+
+  /**
+   * Number of bytes of audio data, 0 if unknown.
+   */
+  uint32_t bytes;
+
+  /**
+   * Encoder delay and padding (in samples) from the LAME tag.
+   */
+  unsigned int delay;
+  unsigned int padding;
+
+  /**
+   * Set if the header indicates a VBR file.
+   */
+  int vbr;
+
+  /**
+   * Encoder name and version from the LAME tag ("" if none).
+   */
+  char encoder[10];
+};
+
+
+/**
+ * Look for a Xing, Info or VBRI header in the first frame.
+ *
+ * @param frame the first frame
+ * @param avail number of bytes available in @a frame
+ * @param fh header of the first frame
+ * @param vi set to the information found
+ * @return 0 if a header was found, -1 if not
+ */
+static int
+parse_vbr_header (const unsigned char *frame,
+		  size_t avail,
+		  const struct FrameHeader *fh,
+		  struct VbrInfo *vi)
+{
+  const unsigned char *p;
+  const unsigned char *end;
+  size_t off;
+  uint32_t flags;
+  unsigned int i;
+
+  memset (vi, 0, sizeof (*vi));
+  end = &frame[(fh->size < avail) ? fh->size : avail];
+  /* Xing/Info follows the side information */
+  if (MPEG_V1 == fh->version)
+    off = (3 == fh->channel_mode) ? 4 + 17 : 4 + 32;
+  else
+    off = (3 == fh->channel_mode) ? 4 + 9 : 4 + 17;
+  p = &frame[off];
+  if ( (p + 8 <= end) &&
+       ( (0 == memcmp (p, "Xing", 4)) ||
+	 (0 == memcmp (p, "Info", 4)) ) )
+    {
+      vi->vbr = (0 == memcmp (p, "Xing", 4));
+      flags = get_be32 (&p[4]);
+      p += 8;
+      if (0 != (flags & 0x01))
+	{
+	  if (p + 4 > end)
+	    return 0;
+	  vi->frames = get_be32 (p);
+	  p += 4;
+	}
+      if (0 != (flags & 0x02))
+	{
+	  if (p + 4 > end)
+	    return 0;
+	  vi->bytes = get_be32 (p);
+	  p += 4;
+	}
+      if (0 != (flags & 0x04))
+	p += 100; /* seek table */
+      if (0 != (flags & 0x08))
+	p += 4; /* quality */
+      /* LAME tag: encoder version, ..., delay and padding at 21-23 */
+      if ( (p + 24 <= end) &&
+	   ( (0 == memcmp (p, "LAME", 4)) ||
+	     (0 == memcmp (p, "Lavf", 4)) ||
+	     (0 == memcmp (p, "Lavc", 4)) ) )
+	{
+	  for (i = 0; i < 9; i++)
+	    {
+	      if ( (p[i] < 0x20) ||
+		   (p[i] > 0x7E) )
+		break;
+	      vi->encoder[i] = p[i];
+	    }
+	  while ( (i > 0) &&
+		  (' ' == vi->encoder[i - 1]) )
+	    i--;
+	  vi->encoder[i] = '\0';
+	  vi->delay = ((unsigned int) p[21] << 4) | (p[22] >> 4);
+	  vi->padding = ((unsigned int) (p[22] & 0x0F) << 8) | p[23];
+	}
+      return 0;
+    }
+  /* VBRI always starts 32 bytes after the header */
+  p = &frame[4 + 32];
+  if ( (p + 18 <= end) &&
+       (0 == memcmp (p, "VBRI", 4)) )
+    {
+      vi->vbr = 1;
+      vi->bytes = get_be32 (&p[10]);
+      vi->frames = get_be32 (&p[14]);
+      return 0;
+    }
+  return -1;
+}
+
+
+/**
+ * Find the first audio frame and report the stream properties.
+ *
+ * @param ctx parser state
+ * @return 0 to continue, 1 to abort extraction, -1 if no audio
+ *         frame was found
+ */
+static int
+parse_audio (struct Mp3Context *ctx)
+{
+  unsigned char frame[SYNC_WINDOW];
+  char format[256];
+  struct FrameHeader fh;
+  struct VbrInfo vi;
+  uint64_t frame_offset;
+  size_t avail;
+  uint64_t audio_bytes;
+  uint64_t samples;
+  uint64_t skip;
+  uint64_t duration;
+  unsigned int bitrate;
+  int have_vbr_header;
+
+  if (0 != find_first_frame (ctx, frame, &fh, &frame_offset, &avail))
+    return -1;
+  have_vbr_header = (0 == parse_vbr_header (frame, avail, &fh, &vi));
+  audio_bytes = (ctx->audio_end > frame_offset)
+    ? ctx->audio_end - frame_offset
+    : 0;
+  if (have_vbr_header)
+    {
+      /* the frame with the VBR header contains no audio */
+      audio_bytes = (audio_bytes > fh.size) ? audio_bytes - fh.size : 0;
+      if (0 != vi.bytes)
+	audio_bytes = vi.bytes;
+    }
+  bitrate = fh.bitrate;
+  if ( (have_vbr_header) &&
+       (0 != vi.frames) )
+    {
+      samples = (uint64_t) vi.frames * fh.samples;
+      skip = (uint64_t) vi.delay + vi.padding;
+      if (skip < samples)
+	samples -= skip;
+      duration = samples / fh.sample_rate;
+      if ( (vi.vbr) &&
+	   (0 != samples) )
+	bitrate = (unsigned int) (audio_bytes * 8 * fh.sample_rate / samples / 1000);
+    }
+  else
+    duration = audio_bytes * 8 / (fh.bitrate * 1000);
+
+  if (0 != add_string (ctx, EXTRACTOR_METATYPE_MIMETYPE, "audio/mpeg"))
+    return 1;
+  if (0 != add_string (ctx,
+		       EXTRACTOR_METATYPE_FORMAT_VERSION,
+		       mpeg_versions[fh.version]))
+    return 1;
+  snprintf (format,
+	    sizeof (format),
+	    "%s %s audio, %u kbps (%s), %u Hz, %s, %s, %s",
+	    mpeg_versions[fh.version],
+	    layer_names[fh.layer - 1],
+	    bitrate,
+	    (have_vbr_header && vi.vbr) ? _("VBR") : _("CBR"),
+	    fh.sample_rate,
+	    _(channel_modes[fh.channel_mode]),
+	    fh.copyright ? _("copyright") : _("no copyright"),
+	    fh.original ? _("original") : _("copy"));
+  if (0 != add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, format))
+    return 1;
+  snprintf (format,
+	    sizeof (format),
+	    "%llum%02u",
+	    (unsigned long long) (duration / 60),
+	    (unsigned int) (duration % 60));
+  if (0 != add_string (ctx, EXTRACTOR_METATYPE_DURATION, format))
+    return 1;
+  if ( (have_vbr_header) &&
+       (0 != add_string (ctx, EXTRACTOR_METATYPE_ENCODER, vi.encoder)) )
+    return 1;
+  return 0;
+}
+
+
+/**
+ * Report a field of an ID3v1 tag.
+ *
+ * @param ctx parser state
+ * @param type LE type of the field
+ * @param field the field (space or NUL padded, ISO-8859-1)
+ * @param len length of @a field
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+add_id3v1_field (struct Mp3Context *ctx,
+		 enum EXTRACTOR_MetaType type,
+		 const unsigned char *field,
+		 size_t len)
+{
+  char *str;
+  size_t i;
+  int ret;
+
+  for (i = 0; i < len; i++)
+    if (0 == field[i])
+      break;
+  while ( (i > 0) &&
+	  (' ' == field[i - 1]) )
+    i--;
+  if (0 == i)
+    return 0;
+  if (NULL == (str = EXTRACTOR_common_convert_to_utf8 ((const char *) field,
+							i,
+							"ISO-8859-1")))
+    return 0;
+  ret = add_string (ctx, type, str);
+  free (str);
+  return ret;
+}
+
+
+/**
+ * Report the contents of an ID3v1 tag.
+ *
+ * @param ctx parser state
+ * @param tag the 128 bytes of the tag
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_id3v1 (struct Mp3Context *ctx,
+	      const unsigned char *tag)
+{
+  const char *genre;
+  char track[8];
+
+  if ( (0 != add_id3v1_field (ctx, EXTRACTOR_METATYPE_TITLE, &tag[3], 30)) ||
+       (0 != add_id3v1_field (ctx, EXTRACTOR_METATYPE_ARTIST, &tag[33], 30)) ||
+       (0 != add_id3v1_field (ctx, EXTRACTOR_METATYPE_ALBUM, &tag[63], 30)) ||
+       (0 != add_id3v1_field (ctx, EXTRACTOR_METATYPE_PUBLICATION_YEAR, &tag[93], 4)) )
+    return 1;
+  if ( (0 == tag[125]) &&
+       (0 != tag[126]) )
+    {
+      /* ID3v1.1: the last two bytes of the comment are a track number */
+      if (0 != add_id3v1_field (ctx, EXTRACTOR_METATYPE_COMMENT, &tag[97], 28))
+	return 1;
+      snprintf (track, sizeof (track), "%u", tag[126]);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_TRACK_NUMBER, track))
+	return 1;
+    }
+  else if (0 != add_id3v1_field (ctx, EXTRACTOR_METATYPE_COMMENT, &tag[97], 30))
+    return 1;
+  if ( (NULL != (genre = EXTRACTOR_common_get_id3_genre (tag[127]))) &&
+       (0 != add_string (ctx, EXTRACTOR_METATYPE_GENRE, _(genre))) )
+    return 1;
+  return 0;
+}
+
+
+/**
+ * Guess the MIME type of an image from its signature
+ * (APEv2 cover art does not come with one).
+ *
+ * @param data the image
+ * @param size number of bytes in @a data
+ * @return MIME type of the image
+ */
+static const char *
+get_image_mime (const unsigned char *data,
+		size_t size)
+{
+  if ( (size >= 3) &&
+       (0 == memcmp (data, "\xFF\xD8\xFF", 3)) )
+    return "image/jpeg";
+  if ( (size >= 8) &&
+       (0 == memcmp (data, "\x89PNG\r\n\x1A\n", 8)) )
+    return "image/png";
+  if ( (size >= 6) &&
+       (0 == memcmp (data, "GIF8", 4)) )
+    return "image/gif";
+  return "application/octet-stream";
+}
+
+
+/**
+ * Report the items of an APEv2 tag.
+ *
+ * @param ctx parser state
+ * @param items the items
+ * @param size number of bytes in @a items
+ * @param count number of items
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_ape_items (struct Mp3Context *ctx,
+		  const unsigned char *items,
+		  size_t size,
+		  uint32_t count)
+{
+  const char *key;
+  char *value;
+  size_t off;
+  size_t klen;
+  uint32_t vlen;
+  uint32_t flags;
+  unsigned int i;
+  int ret;
+
+  off = 0;
+  while ( (count-- > 0) &&
+	  (off + 8 < size) )
+    {
+      vlen = get_le32 (&items[off]);
+      flags = get_le32 (&items[off + 4]);
+      off += 8;
+      key = (const char *) &items[off];
+      for (klen = 0; off + klen < size; klen++)
+	if (0 == items[off + klen])
+	  break;
+      if ( (off + klen >= size) ||
+	   (vlen > size - off - klen - 1) )
+	return 0;
+      off += klen + 1;
+      if (0 != ((flags >> 1) & 0x03))
+	{
+	  /* binary or external item; covers are "filename\0data" */
+	  if ( (0 == strcasecmp (key, "Cover Art (Front)")) &&
+	       (1 == ((flags >> 1) & 0x03)) &&
+	       (NULL != memchr (&items[off], 0, vlen)) )
+	    {
+	      const unsigned char *img;
+
+	      img = memchr (&items[off], 0, vlen);
+	      img++;
+	      if ( (img < &items[off + vlen]) &&
+		   (0 != ctx->ec->proc (ctx->ec->cls,
+					"mp3",
+					EXTRACTOR_METATYPE_THUMBNAIL,
+					EXTRACTOR_METAFORMAT_BINARY,
+					get_image_mime (img, &items[off + vlen] - img),
+					(const char *) img,
+					&items[off + vlen] - img)) )
+		return 1;
+	    }
+	  off += vlen;
+	  continue;
+	}
+      for (i = 0; NULL != ape_map[i].key; i++)
+	if (0 == strcasecmp (key, ape_map[i].key))
+	  break;
+      if ( (NULL != ape_map[i].key) &&
+	   (0 != vlen) &&
+	   (NULL != (value = malloc (vlen + 1))) )
+	{
+	  memcpy (value, &items[off], vlen);
+	  value[vlen] = '\0';
+	  if (EXTRACTOR_METATYPE_GENRE == ape_map[i].type)
+	    ret = add_genre (ctx, value);
+	  else
+	    ret = add_string (ctx, ape_map[i].type, value);
+	  free (value);
+	  if (0 != ret)
+	    return 1;
+	}
+      off += vlen;
+    }
+  return 0;
+}
+
+
+/**
+ * Look for APEv2 and ID3v1 tags at the end of the file, set the
+ * end of the audio data and report the tags.  The ID3v1 tag is
+ * only reported if there is no other tag, as it usually only
+ * holds a truncated copy of the same data.
+ *
+ * @param ctx parser state
+ * @param report set to 0 to only find the end of the audio data
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+parse_trailing_tags (struct Mp3Context *ctx,
+		     int report)
+{
+  unsigned char tail[ID3V1_SIZE + APE_FOOTER_SIZE];
+  const unsigned char *id3v1;
+  const unsigned char *ape;
+  unsigned char *items;
+  uint64_t start;
+  uint32_t ape_size;
+  uint32_t ape_count;
+  size_t got;
+  int ret;
+
+  ctx->audio_end = ctx->fsize;
+  if ( (UINT64_MAX == ctx->fsize) ||
+       (ctx->fsize < ctx->audio_start + sizeof (tail)) )
+    return 0;
+  start = ctx->fsize - sizeof (tail);
+  if (0 != seek_to (ctx, start))
+    return 0;
+  got = read_some (ctx, tail, sizeof (tail));
+  if (sizeof (tail) != got)
+    return 0;
+  id3v1 = NULL;
+  ape = &tail[ID3V1_SIZE];
+  if (0 == memcmp (&tail[APE_FOOTER_SIZE], "TAG", 3))
+    {
+      id3v1 = &tail[APE_FOOTER_SIZE];
+      ape = tail;
+      ctx->audio_end -= ID3V1_SIZE;
+    }
+  ape_size = 0;
+  ape_count = 0;
+  if (0 == memcmp (ape, "APETAGEX", 8))
+    {
+      ape_size = get_le32 (&ape[12]);
+      ape_count = get_le32 (&ape[16]);
+      if ( (ape_size < APE_FOOTER_SIZE) ||
+	   (ape_size > ctx->audio_end - ctx->audio_start) )
+	ape_size = 0;
+      else
+	{
+	  ctx->audio_end -= ape_size;
+	  if (0 != (get_le32 (&ape[20]) & 0x80000000))
+	    ctx->audio_end -= APE_FOOTER_SIZE; /* tag has a header, too */
+	}
+    }
+  if (! report)
+    return 0;
+  if ( (0 != ape_size) &&
+       (ape_size - APE_FOOTER_SIZE <= MAX_APE_SIZE) )
+    {
+      /* the size includes the footer, but not the header */
+      start = ctx->fsize - ((NULL != id3v1) ? ID3V1_SIZE : 0) - ape_size;
+      if ( (0 == seek_to (ctx, start)) &&
+	   (NULL != (items = malloc (ape_size - APE_FOOTER_SIZE + 1))) )
+	{
+	  ret = 0;
+	  if (0 == read_fully (ctx, items, ape_size - APE_FOOTER_SIZE))
+	    ret = report_ape_items (ctx, items, ape_size - APE_FOOTER_SIZE, ape_count);
+	  free (items);
+	  if (0 != ret)
+	    return 1;
+	}
+    }
+  if ( (NULL != id3v1) &&
+       (0 == ape_size) &&
+       (! ctx->have_id3v2) )
+    return report_id3v1 (ctx, id3v1);
+  return 0;
+}
+
+
+/**
+ * Main entry method for the MP3 extraction plugin.
+ *
+ * @param ec extraction context provided to the plugin
+ */
+void
+EXTRACTOR_mp3_extract_method (struct EXTRACTOR_ExtractContext *ec)
+{
+  struct Mp3Context ctx;
+
+  if ( (NULL != ec->mime_hint) &&
+       (0 != strcmp (ec->mime_hint, "audio/mpeg")) )
+    return; /* some other known format */
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.ec = ec;
+  ctx.fsize = ec->get_size (ec->cls);
+  if (0 != parse_id3v2 (&ctx))
+    return;
+  if (0 != parse_trailing_tags (&ctx, 0))
+    return;
+  if (0 != parse_audio (&ctx))
+    return;
+  (void) parse_trailing_tags (&ctx, 1);
+}
+
+/* end of mp3_extractor.c */
@@ -1,6 +1,6 @@
 /*
      This file is part of libextractor.
-     Copyright (C) 2012 Christian Grothoff
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
 
      libextractor is free software; you can redistribute it and/or modify
      it under the terms of the GNU General Public License as published
@@ -17,190 +17,1999 @@
      Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
      Boston, MA 02110-1301, USA.
  */
-
 /**
  * @file plugins/mp4_extractor.c
- * @brief plugin to support MP4 files
- * @author Christian Grothoff
+ * @brief plugin to support ISO base media (MP4, M4A, 3GP) and QuickTime files
+ *
+ * We walk the top-level atoms, seeking over 'mdat' without reading
+ * it, so the 'moov' atom can be at either end of the file.  Inside
+ * 'moov' we only read the atoms we need ('mvhd', 'tkhd', 'mdhd',
+ * 'hdlr', the first 'stsd' entry and the metadata) and skip the
+ * sample tables.  For fragmented files the duration comes from
+ * 'mehd', or from the last 'moof' (which we find via 'mfra').
  */
 #include "platform.h"
 #include "extractor.h"
-#include <mp4v2/mp4v2.h>
+#include "convert.h"
+#include "genres.h"
+#include <stdint.h>
+#if HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+
+/**
+ * Build a four character code.
+ */
+#define FOURCC(a,b,c,d) \
+  (((uint32_t) (unsigned char) (a) << 24) | ((uint32_t) (unsigned char) (b) << 16) | \
+   ((uint32_t) (unsigned char) (c) << 8) | (uint32_t) (unsigned char) (d))
+
+/**
+ * Atoms we know.
+ */
+#define ATOM_FTYP FOURCC ('f','t','y','p')
+#define ATOM_MOOV FOURCC ('m','o','o','v')
+#define ATOM_MDAT FOURCC ('m','d','a','t')
+#define ATOM_FREE FOURCC ('f','r','e','e')
+#define ATOM_SKIP FOURCC ('s','k','i','p')
+#define ATOM_WIDE FOURCC ('w','i','d','e')
+#define ATOM_PNOT FOURCC ('p','n','o','t')
+#define ATOM_JUNK FOURCC ('j','u','n','k')
+#define ATOM_UUID FOURCC ('u','u','i','d')
+#define ATOM_MOOF FOURCC ('m','o','o','f')
+#define ATOM_MFRA FOURCC ('m','f','r','a')
+#define ATOM_MFRO FOURCC ('m','f','r','o')
+#define ATOM_TFRA FOURCC ('t','f','r','a')
+#define ATOM_SIDX FOURCC ('s','i','d','x')
+#define ATOM_STYP FOURCC ('s','t','y','p')
+#define ATOM_CMOV FOURCC ('c','m','o','v')
+#define ATOM_DCOM FOURCC ('d','c','o','m')
+#define ATOM_CMVD FOURCC ('c','m','v','d')
+#define ATOM_MVHD FOURCC ('m','v','h','d')
+#define ATOM_TRAK FOURCC ('t','r','a','k')
+#define ATOM_TKHD FOURCC ('t','k','h','d')
+#define ATOM_MDIA FOURCC ('m','d','i','a')
+#define ATOM_MDHD FOURCC ('m','d','h','d')
+#define ATOM_HDLR FOURCC ('h','d','l','r')
+#define ATOM_MINF FOURCC ('m','i','n','f')
+#define ATOM_STBL FOURCC ('s','t','b','l')
+#define ATOM_STSD FOURCC ('s','t','s','d')
+#define ATOM_MVEX FOURCC ('m','v','e','x')
+#define ATOM_MEHD FOURCC ('m','e','h','d')
+#define ATOM_TREX FOURCC ('t','r','e','x')
+#define ATOM_TRAF FOURCC ('t','r','a','f')
+#define ATOM_TFHD FOURCC ('t','f','h','d')
+#define ATOM_TFDT FOURCC ('t','f','d','t')
+#define ATOM_TRUN FOURCC ('t','r','u','n')
+#define ATOM_UDTA FOURCC ('u','d','t','a')
+#define ATOM_META FOURCC ('m','e','t','a')
+#define ATOM_KEYS FOURCC ('k','e','y','s')
+#define ATOM_ILST FOURCC ('i','l','s','t')
+#define ATOM_DATA FOURCC ('d','a','t','a')
+
+/**
+ * Handler types.
+ */
+#define HANDLER_VIDE FOURCC ('v','i','d','e')
+#define HANDLER_SOUN FOURCC ('s','o','u','n')
+#define HANDLER_MDTA FOURCC ('m','d','t','a')
+
+/**
+ * Maximum nesting depth of atoms we follow.
+ */
+#define MAX_ATOM_DEPTH 8
+
+/**
+ * Maximum number of top-level atoms we look at.
+ */
+#define MAX_TOP_LEVEL_ATOMS 65536
+
+/**
+ * Maximum number of tracks we keep track of.
+ */
+#define MAX_TRACKS 32
+
+/**
+ * Maximum number of keys in a QuickTime 'keys' atom we keep.
+ */
+#define MAX_KEYS 64
+
+/**
+ * Maximum size of a metadata item we are willing to read (cover
+ * art can be rather large).
+ */
+#define MAX_ITEM_SIZE (16 * 1024 * 1024)
+
+/**
+ * Maximum size of other atoms we read into memory ('keys', 'trun',
+ * 'tfra', QuickTime user data).
+ */
+#define MAX_ATOM_SIZE (1024 * 1024)
+
+/**
+ * Maximum size of a compressed movie header after decompression.
+ */
+#define MAX_CMOV_SIZE (16 * 1024 * 1024)
+
+/**
+ * How much of the 'stsd' atom we read (we only look at the
+ * first sample description).
+ */
+#define STSD_READ_SIZE 64
+
+/**
+ * Forward gaps up to this size are skipped by reading over them
+ * instead of seeking.
+ */
+#define MAX_SKIP_READ 256
+
+/**
+ * Seconds between 1904-01-01 (the QuickTime epoch) and 1970-01-01.
+ */
+#define MAC_EPOCH_OFFSET 2082844800LL
+
+
+/**
+ * Mapping of major brands to MIME types.
+ */
+struct BrandMap
+{
+  /**
+   * Major brand from the 'ftyp' atom.
+   */
+  const char *brand;
+
+  /**
+   * Corresponding MIME type.
+   */
+  const char *mime;
+};
+
+
+/**
+ * Brands we know (the MIME types match what the signature table
+ * in common/mime_signatures.c reports).
+ */
+static const struct BrandMap brand_map[] =
+  {
+    { "qt  ", "video/quicktime" },
+    { "isom", "video/mp4" },
+    { "iso2", "video/mp4" },
+    { "iso4", "video/mp4" },
+    { "iso5", "video/mp4" },
+    { "iso6", "video/mp4" },
+    { "mp41", "video/mp4" },
+    { "mp42", "video/mp4" },
+    { "avc1", "video/mp4" },
+    { "dash", "video/mp4" },
+    { "mmp4", "video/mp4" },
+    { "M4V ", "video/x-m4v" },
+    { "M4A ", "audio/x-m4a" },
+    { "M4B ", "audio/mp4" },
+    { "M4P ", "audio/mp4" },
+    { "3gp4", "video/3gpp" },
+    { "3gp5", "video/3gpp" },
+    { "3gp6", "video/3gpp" },
+    { "3g2a", "video/3gpp2" },
+    { NULL, NULL }
+  };
+
+
+/**
+ * Names of track types.
+ */
+struct TrackType
+{
+  /**
+   * Handler type from the 'hdlr' atom.
+   */
+  uint32_t handler;
+
+  /**
+   * Human-readable name.
+   */
+  const char *name;
+};
+
+
+/**
+ * Track types we report.
+ */
+static const struct TrackType track_types[] =
+  {
+    { FOURCC ('v','i','d','e'), "video" },
+    { FOURCC ('s','o','u','n'), "audio" },
+    { FOURCC ('t','e','x','t'), "subtitle" },
+    { FOURCC ('s','b','t','l'), "subtitle" },
+    { FOURCC ('s','u','b','t'), "subtitle" },
+    { FOURCC ('c','l','c','p'), "subtitle" },
+    { FOURCC ('t','m','c','d'), "timecode" },
+    { FOURCC ('m','e','t','a'), "metadata" },
+    { 0, NULL }
+  };
+
+
+/**
+ * Mapping of atoms to LE types.
+ */
+struct AtomMap
+{
+  /**
+   * Type of the atom.
+   */
+  uint32_t type;
+
+  /**
+   * Corresponding LE type.
+   */
+  enum EXTRACTOR_MetaType le_type;
+};
+
+
+/**
+ * iTunes metadata items (in 'ilst').
+ */
+static const struct AtomMap ilst_map[] =
+  {
+    { FOURCC ('\xA9','a','l','b'), EXTRACTOR_METATYPE_ALBUM },
+    { FOURCC ('\xA9','A','R','T'), EXTRACTOR_METATYPE_ARTIST },
+    { FOURCC ('a','A','R','T'), EXTRACTOR_METATYPE_ARTIST },
+    { FOURCC ('\xA9','c','m','t'), EXTRACTOR_METATYPE_COMMENT },
+    { FOURCC ('\xA9','d','a','y'), EXTRACTOR_METATYPE_UNKNOWN_DATE },
+    { FOURCC ('\xA9','n','a','m'), EXTRACTOR_METATYPE_TITLE },
+    { FOURCC ('t','r','k','n'), EXTRACTOR_METATYPE_TRACK_NUMBER },
+    { FOURCC ('d','i','s','k'), EXTRACTOR_METATYPE_DISC_NUMBER },
+    { FOURCC ('\xA9','g','e','n'), EXTRACTOR_METATYPE_GENRE },
+    { FOURCC ('g','n','r','e'), EXTRACTOR_METATYPE_GENRE },
+    { FOURCC ('\xA9','w','r','t'), EXTRACTOR_METATYPE_WRITER },
+    { FOURCC ('\xA9','t','o','o'), EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE },
+    { FOURCC ('c','p','r','t'), EXTRACTOR_METATYPE_COPYRIGHT },
+    { FOURCC ('\xA9','g','r','p'), EXTRACTOR_METATYPE_GROUP },
+    { FOURCC ('\xA9','l','y','r'), EXTRACTOR_METATYPE_LYRICS },
+    { FOURCC ('t','m','p','o'), EXTRACTOR_METATYPE_BEATS_PER_MINUTE },
+    { FOURCC ('c','a','t','g'), EXTRACTOR_METATYPE_SECTION },
+    { FOURCC ('k','e','y','w'), EXTRACTOR_METATYPE_KEYWORDS },
+    { FOURCC ('d','e','s','c'), EXTRACTOR_METATYPE_DESCRIPTION },
+    { FOURCC ('t','v','n','n'), EXTRACTOR_METATYPE_NETWORK_NAME },
+    { FOURCC ('t','v','s','h'), EXTRACTOR_METATYPE_SHOW_NAME },
+    { FOURCC ('t','v','e','n'), EXTRACTOR_METATYPE_NETWORK_NAME },
+    { FOURCC ('c','o','v','r'), EXTRACTOR_METATYPE_THUMBNAIL },
+    { 0, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * QuickTime user data text atoms (in 'udta').
+ */
+static const struct AtomMap udta_map[] =
+  {
+    { FOURCC ('\xA9','a','u','t'), EXTRACTOR_METATYPE_AUTHOR_NAME },
+    { FOURCC ('\xA9','c','p','y'), EXTRACTOR_METATYPE_COPYRIGHT },
+    { FOURCC ('\xA9','d','a','y'), EXTRACTOR_METATYPE_CREATION_DATE },
+    { FOURCC ('\xA9','c','m','t'), EXTRACTOR_METATYPE_COMMENT },
+    { FOURCC ('\xA9','u','r','l'), EXTRACTOR_METATYPE_URL },
+    { FOURCC ('\xA9','e','n','c'), EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE },
+    { FOURCC ('\xA9','h','s','t'), EXTRACTOR_METATYPE_BUILDHOST },
+    { FOURCC ('\xA9','n','a','m'), EXTRACTOR_METATYPE_TITLE },
+    { FOURCC ('\xA9','g','e','n'), EXTRACTOR_METATYPE_GENRE },
+    { FOURCC ('\xA9','m','a','k'), EXTRACTOR_METATYPE_CAMERA_MAKE },
+    { FOURCC ('\xA9','m','o','d'), EXTRACTOR_METATYPE_CAMERA_MODEL },
+    { FOURCC ('\xA9','d','e','s'), EXTRACTOR_METATYPE_DESCRIPTION },
+    { FOURCC ('\xA9','i','n','f'), EXTRACTOR_METATYPE_DESCRIPTION },
+    { FOURCC ('\xA9','d','i','s'), EXTRACTOR_METATYPE_DISCLAIMER },
+    { FOURCC ('\xA9','d','i','r'), EXTRACTOR_METATYPE_MOVIE_DIRECTOR },
+    { FOURCC ('\xA9','s','r','c'), EXTRACTOR_METATYPE_CONTRIBUTOR_NAME },
+    { FOURCC ('\xA9','p','r','f'), EXTRACTOR_METATYPE_PERFORMER },
+    { FOURCC ('\xA9','p','r','d'), EXTRACTOR_METATYPE_PRODUCER },
+    { FOURCC ('\xA9','P','R','D'), EXTRACTOR_METATYPE_PRODUCT_VERSION },
+    { FOURCC ('\xA9','s','w','r'), EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE },
+    { FOURCC ('\xA9','i','s','r'), EXTRACTOR_METATYPE_ISRC },
+    { FOURCC ('\xA9','w','r','t'), EXTRACTOR_METATYPE_WRITER },
+    { FOURCC ('\xA9','w','r','n'), EXTRACTOR_METATYPE_WARNING },
+    { FOURCC ('\xA9','c','h','p'), EXTRACTOR_METATYPE_CHAPTER_NAME },
+    { FOURCC ('\xA9','r','e','q'), EXTRACTOR_METATYPE_TARGET_PLATFORM },
+    { FOURCC ('\xA9','f','m','t'), EXTRACTOR_METATYPE_FORMAT },
+    { 0, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * 3GPP user data atoms (in 'udta').
+ */
+static const struct AtomMap udta_3gpp_map[] =
+  {
+    { FOURCC ('t','i','t','l'), EXTRACTOR_METATYPE_TITLE },
+    { FOURCC ('a','u','t','h'), EXTRACTOR_METATYPE_AUTHOR_NAME },
+    { FOURCC ('p','e','r','f'), EXTRACTOR_METATYPE_PERFORMER },
+    { FOURCC ('d','s','c','p'), EXTRACTOR_METATYPE_DESCRIPTION },
+    { FOURCC ('c','p','r','t'), EXTRACTOR_METATYPE_COPYRIGHT },
+    { FOURCC ('g','n','r','e'), EXTRACTOR_METATYPE_GENRE },
+    { FOURCC ('a','l','b','m'), EXTRACTOR_METATYPE_ALBUM },
+    { 0, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * Mapping of QuickTime metadata keys to LE types.
+ */
+struct KeyMap
+{
+  /**
+   * Key (in the 'mdta' namespace).
+   */
+  const char *key;
+
+  /**
+   * Corresponding LE type.
+   */
+  enum EXTRACTOR_MetaType type;
+};
+
+
+/**
+ * QuickTime metadata keys we extract (as written by cameras
+ * and phones).
+ */
+static const struct KeyMap key_map[] =
+  {
+    { "com.apple.quicktime.make", EXTRACTOR_METATYPE_CAMERA_MAKE },
+    { "com.apple.quicktime.model", EXTRACTOR_METATYPE_CAMERA_MODEL },
+    { "com.apple.quicktime.software", EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE },
+    { "com.apple.quicktime.creationdate", EXTRACTOR_METATYPE_CREATION_DATE },
+    { "com.apple.quicktime.title", EXTRACTOR_METATYPE_TITLE },
+    { "com.apple.quicktime.artist", EXTRACTOR_METATYPE_ARTIST },
+    { "com.apple.quicktime.author", EXTRACTOR_METATYPE_AUTHOR_NAME },
+    { "com.apple.quicktime.album", EXTRACTOR_METATYPE_ALBUM },
+    { "com.apple.quicktime.comment", EXTRACTOR_METATYPE_COMMENT },
+    { "com.apple.quicktime.description", EXTRACTOR_METATYPE_DESCRIPTION },
+    { "com.apple.quicktime.copyright", EXTRACTOR_METATYPE_COPYRIGHT },
+    { "com.apple.quicktime.keywords", EXTRACTOR_METATYPE_KEYWORDS },
+    { "com.apple.quicktime.genre", EXTRACTOR_METATYPE_GENRE },
+    { "com.apple.quicktime.location.name", EXTRACTOR_METATYPE_LOCATION_NAME },
+    { NULL, EXTRACTOR_METATYPE_RESERVED }
+  };
+
+
+/**
+ * An atom.
+ */
+struct Atom
+{
+  /**
+   * Type of the atom.
+   */
+  uint32_t type;
+
+  /**
+   * Offset of the atom header.
+   */
+  uint64_t start;
+
+  /**
+   * Offset of the payload (after the header).
+   */
+  uint64_t data;
+
+  /**
+   * Offset of the first byte after the atom.
+   */
+  uint64_t end;
+};
+
+
+/**
+ * Information about a track.
+ */
+struct Track
+{
+  /**
+   * Track ID (from 'tkhd').
+   */
+  uint32_t id;
+
+  /**
+   * Handler type (from 'hdlr'), 0 if not known.
+   */
+  uint32_t handler;
+
+  /**
+   * Time scale of the media (from 'mdhd').
+   */
+  uint32_t timescale;
+
+  /**
+   * Default sample duration for fragments (from 'trex').
+   */
+  uint32_t default_duration;
+
+  /**
+   * Format of the first sample description (from 'stsd').
+   */
+  uint32_t codec;
+
+  /**
+   * Presentation size (from 'tkhd').
+   */
+  uint32_t width;
+  uint32_t height;
+
+  /**
+   * Coded size (from the video sample description).
+   */
+  uint32_t coded_width;
+  uint32_t coded_height;
+
+  /**
+   * Audio properties (from the sound sample description).
+   */
+  uint32_t channels;
+  uint32_t sample_size;
+  uint32_t sample_rate;
+
+  /**
+   * ISO 639-2/T language code (from 'mdhd'), 0-terminated.
+   */
+  char language[4];
+};
 
 
 /**
- * Callback invoked by libmp4v2 to open the file. 
- * We cheated and passed our extractor context as
- * the filename (fingers crossed) and will simply
- * return it again to make it the handle.
+ * Parser state.
+ */
+struct Mp4Context
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Current offset (in the file, or in @e mem).
+   */
+  uint64_t pos;
+
+  /**
+   * Size of the file.
+   */
+  uint64_t fsize;
+
+  /**
+   * If we are parsing a decompressed movie header, the header;
+   * NULL if we read from the file.
+   */
+  const unsigned char *mem;
+
+  /**
+   * Number of bytes in @e mem.
+   */
+  size_t mem_size;
+
+  /**
+   * MIME type (from the 'ftyp' atom), NULL if not known.
+   */
+  const char *mime;
+
+  /**
+   * Movie time scale (from 'mvhd').
+   */
+  uint32_t timescale;
+
+  /**
+   * Movie duration in @e timescale units (from 'mvhd').
+   */
+  uint64_t duration;
+
+  /**
+   * Duration of a fragmented movie in @e timescale units (from 'mehd').
+   */
+  uint64_t fragment_duration;
+
+  /**
+   * Creation time in seconds since 1904 (from 'mvhd').
+   */
+  uint64_t creation_time;
+
+  /**
+   * Duration of a fragmented movie in seconds as determined from
+   * the last fragment (-1 if not known).
+   */
+  double last_fragment_end;
+
+  /**
+   * Offset of the last 'moof' atom we saw, 0 if none.
+   */
+  uint64_t last_moof;
+
+  /**
+   * Set once we parsed the 'moov' atom.
+   */
+  int have_moov;
+
+  /**
+   * Set if the movie has fragments ('mvex' in 'moov').
+   */
+  int fragmented;
+
+  /**
+   * Handler type of the current 'meta' atom.
+   */
+  uint32_t meta_handler;
+
+  /**
+   * Keys from the 'keys' atom of the current 'meta' atom.
+   */
+  char *keys[MAX_KEYS];
+
+  /**
+   * Number of entries in @e keys.
+   */
+  unsigned int num_keys;
+
+  /**
+   * Tracks we found.
+   */
+  struct Track tracks[MAX_TRACKS];
+
+  /**
+   * Number of entries in @e tracks.
+   */
+  unsigned int num_tracks;
+};
+
+
+/**
+ * Give a string to the metadata processor.
  *
- * @param name "filename" to open
- * @param open mode, only reading allowed
- * @return NULL if the file is not opened for reading
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param str 0-terminated UTF-8 string
+ * @return 0 to continue extracting, 1 to abort
  */
-static void*
-open_cb (const char *name,
-	 MP4FileMode mode)
+static int
+add_string (struct Mp4Context *ctx,
+	    enum EXTRACTOR_MetaType type,
+	    const char *str)
 {
-  void *ecp;
+  if ('\0' == str[0])
+    return 0;
+  return ctx->ec->proc (ctx->ec->cls,
+			"mp4",
+			type,
+			EXTRACTOR_METAFORMAT_UTF8,
+			"text/plain",
+			str,
+			strlen (str) + 1);
+}
 
-  if (FILEMODE_READ != mode)
-    return NULL;
-  if (1 != sscanf (name, "%p", &ecp))
-    return NULL;
-  return ecp;
+
+/**
+ * Convert a string and give it to the metadata processor.
+ *
+ * @param ctx parser state
+ * @param type type of the meta data
+ * @param data the string (not 0-terminated)
+ * @param size number of bytes in @a data
+ * @param charset character set of @a data
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_converted (struct Mp4Context *ctx,
+	       enum EXTRACTOR_MetaType type,
+	       const unsigned char *data,
+	       size_t size,
+	       const char *charset)
+{
+  char *str;
+  size_t i;
+  int ret;
+
+  /* strip trailing NULs, some writers include them */
+  while ( (size > 0) &&
+	  (0 == data[size - 1]) )
+    size--;
+  if (0 == size)
+    return 0;
+  if (NULL == (str = EXTRACTOR_common_convert_to_utf8 ((const char *) data,
+							size,
+							charset)))
+    return 0;
+  for (i = 0; '\0' != str[i]; i++)
+    if ('\r' == str[i])
+      str[i] = '\n';
+  ret = add_string (ctx, type, str);
+  free (str);
+  return ret;
 }
 
 
 /**
- * Seek callback for libmp4v2.
+ * Read exactly @a size bytes from the current position.
  *
- * @param handle the 'struct EXTRACTOR_ExtractContext'
- * @param pos target seek position (relative or absolute?)
- * @return true on failure, false on success
+ * @param ctx parser state
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or short file)
  */
 static int
-seek_cb (void *handle,
-	 int64_t pos)
+read_fully (struct Mp4Context *ctx,
+	    void *buf,
+	    size_t size)
 {
-  struct EXTRACTOR_ExtractContext *ec = handle;
+  unsigned char *dst = buf;
+  void *data;
+  ssize_t ret;
+  size_t done;
 
-  fprintf (stderr, "Seek: %lld!\n", (long long) pos);
-  if (-1 == 
-      ec->seek (ec->cls,
-		pos,
-		SEEK_CUR))
-    return true; /* failure */
-  return false;
+  if (NULL != ctx->mem)
+    {
+      if ( (ctx->pos > ctx->mem_size) ||
+	   (size > ctx->mem_size - ctx->pos) )
+	return -1;
+      memcpy (buf, &ctx->mem[ctx->pos], size);
+      ctx->pos += size;
+      return 0;
+    }
+  done = 0;
+  while (done < size)
+    {
+      if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, size - done)))
+	return -1;
+      memcpy (&dst[done], data, ret);
+      done += ret;
+      ctx->pos += ret;
+    }
+  return 0;
 }
 
 
 /**
- * Read callback for libmp4v2.
+ * Move to the given absolute offset.
  *
- * @param handle the 'struct EXTRACTOR_ExtractContext'
- * @param buffer where to write data read
- * @param size desired number of bytes to read
- * @param nin where to write number of bytes read
- * @param maxChunkSize some chunk size (ignored)
- * @return true on failure, false on success
+ * @param ctx parser state
+ * @param pos target offset
+ * @return 0 on success, -1 on error
  */
-static int 
-read_cb (void *handle,
-	 void *buffer,
-	 int64_t size,
-	 int64_t *nin,
-	 int64_t maxChunkSize)
+static int
+seek_to (struct Mp4Context *ctx,
+	 uint64_t pos)
 {
-  struct EXTRACTOR_ExtractContext *ec = handle;
-  void *buf;
+  void *data;
   ssize_t ret;
- 
- fprintf (stderr, "read!\n");
-  *nin = 0;
-  if (-1 == 
-      (ret = ec->read (ec->cls,
-		       &buf,
-		       size)))
-    return true; /* failure */
-  memcpy (buffer, buf, ret);
-  *nin = ret;
-  return false; /* success */
+
+  if (pos == ctx->pos)
+    return 0;
+  if (NULL != ctx->mem)
+    {
+      if (pos > ctx->mem_size)
+	return -1;
+      ctx->pos = pos;
+      return 0;
+    }
+  if ( (pos > ctx->pos) &&
+       (pos - ctx->pos <= MAX_SKIP_READ) )
+    {
+      while (ctx->pos < pos)
+	{
+	  if (0 >= (ret = ctx->ec->read (ctx->ec->cls, &data, pos - ctx->pos)))
+	    return -1;
+	  ctx->pos += ret;
+	}
+      return 0;
+    }
+  if ( (pos > INT64_MAX) ||
+       ((int64_t) pos != ctx->ec->seek (ctx->ec->cls, (int64_t) pos, SEEK_SET)) )
+    return -1;
+  ctx->pos = pos;
+  return 0;
+}
+
+
+/**
+ * Get a 16-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint16_t
+get_be16 (const unsigned char *p)
+{
+  return (uint16_t) (((uint16_t) p[0] << 8) | p[1]);
+}
+
+
+/**
+ * Get a 32-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint32_t
+get_be32 (const unsigned char *p)
+{
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+    ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
+
+
+/**
+ * Get a 64-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
+ */
+static uint64_t
+get_be64 (const unsigned char *p)
+{
+  return ((uint64_t) get_be32 (p) << 32) | get_be32 (&p[4]);
+}
+
+
+/**
+ * Read the header of the atom at the current position.
+ *
+ * @param ctx parser state
+ * @param end end of the enclosing atom (or file)
+ * @param atom set to the atom
+ * @return 0 on success, -1 on error (or end of data)
+ */
+static int
+read_atom (struct Mp4Context *ctx,
+	   uint64_t end,
+	   struct Atom *atom)
+{
+  unsigned char hdr[8];
+  uint64_t size;
+
+  atom->start = ctx->pos;
+  if ( (ctx->pos >= end) ||
+       (end - ctx->pos < sizeof (hdr)) ||
+       (0 != read_fully (ctx, hdr, sizeof (hdr))) )
+    return -1;
+  size = get_be32 (hdr);
+  atom->type = get_be32 (&hdr[4]);
+  if (1 == size)
+    {
+      /* 64-bit size follows the type */
+      if ( (end - ctx->pos < sizeof (hdr)) ||
+	   (0 != read_fully (ctx, hdr, sizeof (hdr))) )
+	return -1;
+      size = get_be64 (hdr);
+    }
+  else if (0 == size)
+    {
+      /* atom extends to the end of the enclosing atom */
+      if (UINT64_MAX == end)
+	return -1;
+      size = end - atom->start;
+    }
+  atom->data = ctx->pos;
+  if ( (size < atom->data - atom->start) ||
+       (size > end - atom->start) )
+    return -1;
+  atom->end = atom->start + size;
+  return 0;
+}
+
+
+/**
+ * Read (the beginning of) the payload of an atom into memory.
+ *
+ * @param ctx parser state, positioned at the payload
+ * @param atom the atom
+ * @param max maximum number of bytes to read
+ * @param size set to the number of bytes read
+ * @return the data, NULL on error (or if the atom is empty)
+ */
+static unsigned char *
+read_payload (struct Mp4Context *ctx,
+	      const struct Atom *atom,
+	      size_t max,
+	      size_t *size)
+{
+  unsigned char *data;
+
+  if (atom->end - atom->data < max)
+    max = atom->end - atom->data;
+  if (0 == max)
+    return NULL;
+  if (NULL == (data = malloc (max)))
+    return NULL;
+  if (0 != read_fully (ctx, data, max))
+    {
+      free (data);
+      return NULL;
+    }
+  *size = max;
+  return data;
+}
+
+
+/**
+ * Find the track with the given ID.
+ *
+ * @param ctx parser state
+ * @param id track ID
+ * @return the track, NULL if not found
+ */
+static struct Track *
+find_track (struct Mp4Context *ctx,
+	    uint32_t id)
+{
+  unsigned int i;
+
+  for (i = 0; i < ctx->num_tracks; i++)
+    if (id == ctx->tracks[i].id)
+      return &ctx->tracks[i];
+  return NULL;
+}
+
+
+/**
+ * Parse the movie header ('mvhd').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ */
+static void
+parse_mvhd (struct Mp4Context *ctx,
+	    const struct Atom *atom)
+{
+  unsigned char *data;
+  size_t size;
+
+  if (NULL == (data = read_payload (ctx, atom, 32, &size)))
+    return;
+  if ( (1 == data[0]) &&
+       (size >= 32) )
+    {
+      ctx->creation_time = get_be64 (&data[4]);
+      ctx->timescale = get_be32 (&data[20]);
+      ctx->duration = get_be64 (&data[24]);
+    }
+  else if ( (0 == data[0]) &&
+	    (size >= 20) )
+    {
+      ctx->creation_time = get_be32 (&data[4]);
+      ctx->timescale = get_be32 (&data[12]);
+      ctx->duration = get_be32 (&data[16]);
+      if (UINT32_MAX == ctx->duration)
+	ctx->duration = 0; /* unknown */
+    }
+  free (data);
+}
+
+
+/**
+ * Parse a track header ('tkhd').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ * @param track track to update
+ */
+static void
+parse_tkhd (struct Mp4Context *ctx,
+	    const struct Atom *atom,
+	    struct Track *track)
+{
+  unsigned char *data;
+  size_t size;
+  size_t off;
+
+  if (NULL == (data = read_payload (ctx, atom, 96, &size)))
+    return;
+  off = (1 == data[0]) ? 20 : 12;
+  if (size >= off + 4)
+    track->id = get_be32 (&data[off]);
+  off = (1 == data[0]) ? 88 : 76;
+  if (size >= off + 8)
+    {
+      /* 16.16 fixed point */
+      track->width = get_be32 (&data[off]) >> 16;
+      track->height = get_be32 (&data[off + 4]) >> 16;
+    }
+  free (data);
+}
+
+
+/**
+ * Parse a media header ('mdhd').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ * @param track track to update
+ */
+static void
+parse_mdhd (struct Mp4Context *ctx,
+	    const struct Atom *atom,
+	    struct Track *track)
+{
+  unsigned char *data;
+  size_t size;
+  size_t off;
+  uint16_t lang;
+
+  if (NULL == (data = read_payload (ctx, atom, 34, &size)))
+    return;
+  off = (1 == data[0]) ? 20 : 12;
+  if (size >= off + 4)
+    track->timescale = get_be32 (&data[off]);
+  off = (1 == data[0]) ? 32 : 20;
+  if (size >= off + 2)
+    {
+      lang = get_be16 (&data[off]);
+      if (lang >= 0x400)
+	{
+	  /* ISO 639-2/T code, packed as three 5-bit values */
+	  track->language[0] = 0x60 + ((lang >> 10) & 0x1F);
+	  track->language[1] = 0x60 + ((lang >> 5) & 0x1F);
+	  track->language[2] = 0x60 + (lang & 0x1F);
+	  track->language[3] = '\0';
+	}
+      else if (0 == lang)
+	strcpy (track->language, "eng"); /* Macintosh language code */
+    }
+  free (data);
+}
+
+
+/**
+ * Parse a handler reference ('hdlr').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ * @param handler set to the handler type
+ */
+static void
+parse_hdlr (struct Mp4Context *ctx,
+	    const struct Atom *atom,
+	    uint32_t *handler)
+{
+  unsigned char *data;
+  size_t size;
+
+  if (NULL == (data = read_payload (ctx, atom, 12, &size)))
+    return;
+  if ( (size >= 12) &&
+       (FOURCC ('d','h','l','r') != get_be32 (&data[4])) )
+    *handler = get_be32 (&data[8]);
+  free (data);
+}
+
+
+/**
+ * Parse the first sample description of a track ('stsd').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ * @param track track to update
+ */
+static void
+parse_stsd (struct Mp4Context *ctx,
+	    const struct Atom *atom,
+	    struct Track *track)
+{
+  unsigned char *data;
+  const unsigned char *entry;
+  size_t size;
+
+  if (NULL == (data = read_payload (ctx, atom, STSD_READ_SIZE, &size)))
+    return;
+  /* version/flags, entry count, then the first entry */
+  if ( (size < 16) ||
+       (0 == get_be32 (&data[4])) )
+    {
+      free (data);
+      return;
+    }
+  entry = &data[8];
+  track->codec = get_be32 (&entry[4]);
+  if ( (HANDLER_VIDE == track->handler) &&
+       (size >= 8 + 36) )
+    {
+      track->coded_width = get_be16 (&entry[32]);
+      track->coded_height = get_be16 (&entry[34]);
+    }
+  if ( (HANDLER_SOUN == track->handler) &&
+       (size >= 8 + 36) &&
+       (get_be16 (&entry[16]) < 2) )
+    {
+      /* sound description version 0 or 1 */
+      track->channels = get_be16 (&entry[24]);
+      track->sample_size = get_be16 (&entry[26]);
+      track->sample_rate = get_be32 (&entry[32]) >> 16;
+    }
+  free (data);
+}
+
+
+/**
+ * Parse a track extends atom ('trex').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ */
+static void
+parse_trex (struct Mp4Context *ctx,
+	    const struct Atom *atom)
+{
+  unsigned char *data;
+  struct Track *track;
+  size_t size;
+
+  if (NULL == (data = read_payload (ctx, atom, 16, &size)))
+    return;
+  if ( (size >= 16) &&
+       (NULL != (track = find_track (ctx, get_be32 (&data[4])))) )
+    track->default_duration = get_be32 (&data[12]);
+  free (data);
+}
+
+
+/**
+ * Parse a movie extends header ('mehd').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ */
+static void
+parse_mehd (struct Mp4Context *ctx,
+	    const struct Atom *atom)
+{
+  unsigned char *data;
+  size_t size;
+
+  if (NULL == (data = read_payload (ctx, atom, 12, &size)))
+    return;
+  if ( (1 == data[0]) &&
+       (size >= 12) )
+    ctx->fragment_duration = get_be64 (&data[4]);
+  else if ( (0 == data[0]) &&
+	    (size >= 8) )
+    ctx->fragment_duration = get_be32 (&data[4]);
+  free (data);
+}
+
+
+/**
+ * Parse the keys of QuickTime metadata ('keys').
+ *
+ * @param ctx parser state
+ * @param atom the atom
+ */
+static void
+parse_keys (struct Mp4Context *ctx,
+	    const struct Atom *atom)
+{
+  unsigned char *data;
+  size_t size;
+  size_t off;
+  uint32_t count;
+  uint32_t ksize;
+
+  if ( (atom->end - atom->data > MAX_ATOM_SIZE) ||
+       (NULL == (data = read_payload (ctx, atom, MAX_ATOM_SIZE, &size))) )
+    return;
+  if (size < 8)
+    {
+      free (data);
+      return;
+    }
+  count = get_be32 (&data[4]);
+  off = 8;
+  while ( (count-- > 0) &&
+	  (ctx->num_keys < MAX_KEYS) &&
+	  (off + 8 <= size) )
+    {
+      ksize = get_be32 (&data[off]);
+      if ( (ksize < 8) ||
+	   (ksize > size - off) )
+	break;
+      ctx->keys[ctx->num_keys] = NULL;
+      if (FOURCC ('m','d','t','a') == get_be32 (&data[off + 4]))
+	{
+	  if (NULL != (ctx->keys[ctx->num_keys] = malloc (ksize - 8 + 1)))
+	    {
+	      memcpy (ctx->keys[ctx->num_keys], &data[off + 8], ksize - 8);
+	      ctx->keys[ctx->num_keys][ksize - 8] = '\0';
+	    }
+	}
+      ctx->num_keys++;
+      off += ksize;
+    }
+  free (data);
+}
+
+
+/**
+ * Forget the keys of the current 'meta' atom.
+ *
+ * @param ctx parser state
+ */
+static void
+free_keys (struct Mp4Context *ctx)
+{
+  unsigned int i;
+
+  for (i = 0; i < ctx->num_keys; i++)
+    free (ctx->keys[i]);
+  ctx->num_keys = 0;
+}
+
+
+/**
+ * Report the value of a metadata item ('data' atom).
+ *
+ * @param ctx parser state
+ * @param item type of the enclosing item
+ * @param type LE type to use
+ * @param data payload of the 'data' atom
+ * @param size number of bytes in @a data
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_data (struct Mp4Context *ctx,
+	     uint32_t item,
+	     enum EXTRACTOR_MetaType type,
+	     const unsigned char *data,
+	     size_t size)
+{
+  const unsigned char *value;
+  const char *genre;
+  const char *mime;
+  char num[32];
+  uint32_t well_known;
+  size_t len;
+
+  /* type indicator (version and well-known type), locale */
+  if (size < 8)
+    return 0;
+  well_known = get_be32 (data) & 0xFFFFFF;
+  value = &data[8];
+  len = size - 8;
+  switch (well_known)
+    {
+    case 1: /* UTF-8 */
+      return add_converted (ctx, type, value, len, "UTF-8");
+    case 2: /* UTF-16BE */
+      return add_converted (ctx, type, value, len, "UTF-16BE");
+    case 13: /* JPEG */
+    case 14: /* PNG */
+    case 27: /* BMP */
+      if (EXTRACTOR_METATYPE_THUMBNAIL != type)
+	return 0;
+      if (13 == well_known)
+	mime = "image/jpeg";
+      else if (14 == well_known)
+	mime = "image/png";
+      else
+	mime = "image/bmp";
+      if (0 == len)
+	return 0;
+      return ctx->ec->proc (ctx->ec->cls,
+			    "mp4",
+			    type,
+			    EXTRACTOR_METAFORMAT_BINARY,
+			    mime,
+			    (const char *) value,
+			    len);
+    case 0: /* implicit, depends on the item */
+    case 21: /* big endian signed integer */
+      if (FOURCC ('g','n','r','e') == item)
+	{
+	  /* ID3v1 genre plus one */
+	  if ( (len < 2) ||
+	       (0 == get_be16 (value)) ||
+	       (NULL == (genre = EXTRACTOR_common_get_id3_genre (get_be16 (value) - 1))) )
+	    return 0;
+	  return add_string (ctx, type, _(genre));
+	}
+      if ( (FOURCC ('t','r','k','n') == item) ||
+	   (FOURCC ('d','i','s','k') == item) )
+	{
+	  /* reserved, number, total */
+	  if ( (len < 6) ||
+	       (0 == get_be16 (&value[2])) )
+	    return 0;
+	  if (0 != get_be16 (&value[4]))
+	    snprintf (num,
+		      sizeof (num),
+		      "%u/%u",
+		      (unsigned int) get_be16 (&value[2]),
+		      (unsigned int) get_be16 (&value[4]));
+	  else
+	    snprintf (num,
+		      sizeof (num),
+		      "%u",
+		      (unsigned int) get_be16 (&value[2]));
+	  return add_string (ctx, type, num);
+	}
+      if ( (FOURCC ('t','m','p','o') == item) &&
+	   (len >= 2) &&
+	   (0 != get_be16 (value)) )
+	{
+	  snprintf (num,
+		    sizeof (num),
+		    "%u",
+		    (unsigned int) get_be16 (value));
+	  return add_string (ctx, type, num);
+	}
+      return 0;
+    default:
+      return 0;
+    }
 }
 
 
 /**
- * Write callback for libmp4v2.
+ * Parse an item of the metadata list ('ilst').
  *
- * @param handle the 'struct EXTRACTOR_ExtractContext'
- * @param buffer data to write
- * @param size desired number of bytes to write
- * @param nin where to write number of bytes written
- * @param maxChunkSize some chunk size (ignored)
- * @return true on failure (always fails)
+ * @param ctx parser state
+ * @param atom the item
+ * @return 0 to continue, 1 to abort extraction
  */
 static int
-write_cb (void *handle,
-	  const void *buffer,
-	  int64_t size,
-	  int64_t *nout,
-	  int64_t maxChunkSize)
+parse_ilst_item (struct Mp4Context *ctx,
+		 const struct Atom *atom)
 {
-  fprintf (stderr, "Write!?\n");
-  return true; /* failure  */
+  enum EXTRACTOR_MetaType type;
+  unsigned char *data;
+  const char *key;
+  size_t size;
+  size_t off;
+  uint32_t dsize;
+  unsigned int i;
+  int ret;
+
+  type = EXTRACTOR_METATYPE_RESERVED;
+  if (HANDLER_MDTA == ctx->meta_handler)
+    {
+      /* the item type is a (1-based) index into the keys */
+      if ( (0 == atom->type) ||
+	   (atom->type > ctx->num_keys) ||
+	   (NULL == (key = ctx->keys[atom->type - 1])) )
+	return 0;
+      for (i = 0; NULL != key_map[i].key; i++)
+	if (0 == strcmp (key, key_map[i].key))
+	  type = key_map[i].type;
+    }
+  else
+    {
+      for (i = 0; 0 != ilst_map[i].type; i++)
+	if (atom->type == ilst_map[i].type)
+	  type = ilst_map[i].le_type;
+    }
+  if ( (EXTRACTOR_METATYPE_RESERVED == type) ||
+       (! ctx->ec->wants (ctx->ec->cls, type)) ||
+       (atom->end - atom->data > MAX_ITEM_SIZE) ||
+       (NULL == (data = read_payload (ctx, atom, MAX_ITEM_SIZE, &size))) )
+    return 0;
+  ret = 0;
+  off = 0;
+  while ( (0 == ret) &&
+	  (off + 8 <= size) )
+    {
+      dsize = get_be32 (&data[off]);
+      if ( (dsize < 8) ||
+	   (dsize > size - off) )
+	break;
+      if (ATOM_DATA == get_be32 (&data[off + 4]))
+	ret = report_data (ctx,
+			   (HANDLER_MDTA == ctx->meta_handler) ? 0 : atom->type,
+			   type,
+			   &data[off + 8],
+			   dsize - 8);
+      off += dsize;
+    }
+  free (data);
+  return ret;
 }
 
 
 /**
- * Write callback for libmp4v2.  Does nothing.
+ * Parse a QuickTime or 3GPP user data atom.
  *
- * @param handle the 'struct EXTRACTOR_ExtractContext'
- * @return false on success (always succeeds)
+ * @param ctx parser state
+ * @param atom the atom
+ * @return 0 to continue, 1 to abort extraction
  */
 static int
-close_cb (void *handle)
+parse_udta_item (struct Mp4Context *ctx,
+		 const struct Atom *atom)
 {
-  fprintf (stderr, "Close!\n");
-  return false; /* success */
+  enum EXTRACTOR_MetaType type;
+  unsigned char *data;
+  size_t size;
+  uint16_t len;
+  uint16_t lang;
+  unsigned int i;
+  int is_3gpp;
+  int ret;
+
+  type = EXTRACTOR_METATYPE_RESERVED;
+  is_3gpp = 0;
+  for (i = 0; 0 != udta_map[i].type; i++)
+    if (atom->type == udta_map[i].type)
+      type = udta_map[i].le_type;
+  for (i = 0; 0 != udta_3gpp_map[i].type; i++)
+    if (atom->type == udta_3gpp_map[i].type)
+      {
+	type = udta_3gpp_map[i].le_type;
+	is_3gpp = 1;
+      }
+  if ( (EXTRACTOR_METATYPE_RESERVED == type) ||
+       (atom->end - atom->data > MAX_ATOM_SIZE) ||
+       (NULL == (data = read_payload (ctx, atom, MAX_ATOM_SIZE, &size))) )
+    return 0;
+  ret = 0;
+  if (is_3gpp)
+    {
+      /* version/flags, language, string (UTF-8 or UTF-16 with BOM) */
+      if (size > 6)
+	{
+	  if ( (size >= 8) &&
+	       (0xFE == data[6]) &&
+	       (0xFF == data[7]) )
+	    ret = add_converted (ctx, type, &data[6], size - 6, "UTF-16");
+	  else
+	    ret = add_converted (ctx, type, &data[6], size - 6, "UTF-8");
+	}
+    }
+  else if (size >= 4)
+    {
+      /* length, language, text */
+      len = get_be16 (data);
+      lang = get_be16 (&data[2]);
+      if (len <= size - 4)
+	ret = add_converted (ctx,
+			     type,
+			     &data[4],
+			     len,
+			     (lang < 0x400) ? "MACINTOSH" : "UTF-8");
+    }
+  free (data);
+  return ret;
 }
 
 
-#if 0
 /**
- * Wrapper to replace 'stat64' call by libmp4v2.
+ * Parse the children of an atom.
+ *
+ * @param ctx parser state, positioned at the first child
+ * @param parent the parent atom
+ * @param depth nesting depth of @a parent
+ * @param track track we are in, NULL if we are not in a track
+ * @return 0 to continue, 1 to abort extraction, -1 on error
  */
-int 
-stat_cb (const char * path,
-	 struct stat64 * buf) 
+static int
+parse_children (struct Mp4Context *ctx,
+		const struct Atom *parent,
+		unsigned int depth,
+		struct Track *track);
+
+
+#if HAVE_ZLIB
+/**
+ * Parse a compressed movie header ('cmov').
+ *
+ * @param ctx parser state
+ * @param atom the 'cmov' atom
+ * @param depth nesting depth of @a atom
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_cmov (struct Mp4Context *ctx,
+	    const struct Atom *atom,
+	    unsigned int depth)
 {
-  void *ecp;
-  struct EXTRACTOR_ExtractContext *ec;
+  struct Atom child;
+  struct Atom moov;
+  unsigned char dcom[4];
+  unsigned char *in;
+  unsigned char *out;
+  size_t in_size;
+  uLongf out_size;
+  uint64_t pos;
+  int ret;
 
-  fprintf (stderr, "stat!\n");
-  if (1 != sscanf (path, "%p", &ecp))
+  if (0 != read_atom (ctx, atom->end, &child))
+    return -1;
+  if ( (ATOM_DCOM != child.type) ||
+       (child.end - child.data < sizeof (dcom)) ||
+       (0 != read_fully (ctx, dcom, sizeof (dcom))) ||
+       (0 != memcmp (dcom, "zlib", 4)) ||
+       (0 != seek_to (ctx, child.end)) ||
+       (0 != read_atom (ctx, atom->end, &child)) ||
+       (ATOM_CMVD != child.type) ||
+       (child.end - child.data > MAX_CMOV_SIZE) ||
+       (NULL == (in = read_payload (ctx, &child, MAX_CMOV_SIZE, &in_size))) )
+    return -1;
+  out_size = (in_size >= 4) ? get_be32 (in) : 0;
+  if ( (0 == out_size) ||
+       (out_size > MAX_CMOV_SIZE) ||
+       (NULL == (out = malloc (out_size))) )
     {
-      errno = EINVAL;
+      free (in);
       return -1;
     }
-  ec = ecp;
-  memset (buf, 0, sizeof (struct stat));
-  buf->st_size = ec->get_size (ec->cls);
-  return 0;
+  if (Z_OK != uncompress (out, &out_size, &in[4], in_size - 4))
+    {
+      free (in);
+      free (out);
+      return -1;
+    }
+  free (in);
+  /* the result is a complete 'moov' atom; parse it from memory */
+  pos = ctx->pos;
+  ctx->mem = out;
+  ctx->mem_size = out_size;
+  ctx->pos = 0;
+  ret = -1;
+  if ( (0 == read_atom (ctx, out_size, &moov)) &&
+       (ATOM_MOOV == moov.type) )
+    ret = parse_children (ctx, &moov, depth, NULL);
+  ctx->mem = NULL;
+  ctx->mem_size = 0;
+  ctx->pos = pos;
+  free (out);
+  return ret;
 }
 #endif
 
 
+/**
+ * Parse the children of an atom.
+ *
+ * @param ctx parser state, positioned at the first child
+ * @param parent the parent atom
+ * @param depth nesting depth of @a parent
+ * @param track track we are in, NULL if we are not in a track
+ * @return 0 to continue, 1 to abort extraction, -1 on error
+ */
+static int
+parse_children (struct Mp4Context *ctx,
+		const struct Atom *parent,
+		unsigned int depth,
+		struct Track *track)
+{
+  struct Atom atom;
+  unsigned char peek[8];
+  int ret;
+
+  if (depth >= MAX_ATOM_DEPTH)
+    return 0;
+  while (ctx->pos < parent->end)
+    {
+      if (0 != read_atom (ctx, parent->end, &atom))
+	return 0; /* ignore trailing garbage */
+      ret = 0;
+      if (ATOM_ILST == parent->type)
+	ret = parse_ilst_item (ctx, &atom);
+      else
+	switch (atom.type)
+	  {
+	  case ATOM_MVHD:
+	    if (ATOM_MOOV == parent->type)
+	      parse_mvhd (ctx, &atom);
+	    break;
+	  case ATOM_TRAK:
+	    if ( (ATOM_MOOV == parent->type) &&
+		 (ctx->num_tracks < MAX_TRACKS) )
+	      {
+		track = &ctx->tracks[ctx->num_tracks++];
+		memset (track, 0, sizeof (struct Track));
+		ret = parse_children (ctx, &atom, depth + 1, track);
+		track = NULL;
+	      }
+	    break;
+	  case ATOM_TKHD:
+	    if (NULL != track)
+	      parse_tkhd (ctx, &atom, track);
+	    break;
+	  case ATOM_MDHD:
+	    if (NULL != track)
+	      parse_mdhd (ctx, &atom, track);
+	    break;
+	  case ATOM_HDLR:
+	    if (ATOM_META == parent->type)
+	      parse_hdlr (ctx, &atom, &ctx->meta_handler);
+	    else if ( (ATOM_MDIA == parent->type) &&
+		      (NULL != track) )
+	      parse_hdlr (ctx, &atom, &track->handler);
+	    break;
+	  case ATOM_STSD:
+	    if (NULL != track)
+	      parse_stsd (ctx, &atom, track);
+	    break;
+	  case ATOM_MDIA:
+	  case ATOM_MINF:
+	  case ATOM_STBL:
+	    if (NULL != track)
+	      ret = parse_children (ctx, &atom, depth + 1, track);
+	    break;
+	  case ATOM_MVEX:
+	    if (ATOM_MOOV == parent->type)
+	      {
+		ctx->fragmented = 1;
+		ret = parse_children (ctx, &atom, depth + 1, NULL);
+	      }
+	    break;
+	  case ATOM_MEHD:
+	    if (ATOM_MVEX == parent->type)
+	      parse_mehd (ctx, &atom);
+	    break;
+	  case ATOM_TREX:
+	    if (ATOM_MVEX == parent->type)
+	      parse_trex (ctx, &atom);
+	    break;
+	  case ATOM_UDTA:
+	    if (NULL == track)
+	      ret = parse_children (ctx, &atom, depth + 1, NULL);
+	    break;
+	  case ATOM_META:
+	    /* ISO 'meta' is a full atom, QuickTime 'meta' is not */
+	    if ( (atom.end - atom.data >= sizeof (peek)) &&
+		 (0 == read_fully (ctx, peek, sizeof (peek))) )
+	      {
+		atom.data += (ATOM_HDLR == get_be32 (&peek[4])) ? 0 : 4;
+		if (0 != seek_to (ctx, atom.data))
+		  return -1;
+		ctx->meta_handler = 0;
+		ret = parse_children (ctx, &atom, depth + 1, NULL);
+		free_keys (ctx);
+	      }
+	    break;
+	  case ATOM_KEYS:
+	    if (ATOM_META == parent->type)
+	      parse_keys (ctx, &atom);
+	    break;
+	  case ATOM_ILST:
+	    if (ATOM_META == parent->type)
+	      ret = parse_children (ctx, &atom, depth + 1, NULL);
+	    break;
+#if HAVE_ZLIB
+	  case ATOM_CMOV:
+	    if (ATOM_MOOV == parent->type)
+	      ret = parse_cmov (ctx, &atom, depth);
+	    break;
+#endif
+	  default:
+	    if (ATOM_UDTA == parent->type)
+	      ret = parse_udta_item (ctx, &atom);
+	    break;
+	  }
+      if (0 != ret)
+	return ret;
+      if (0 != seek_to (ctx, atom.end))
+	return -1;
+    }
+  return 0;
+}
+
+
+/**
+ * Parse a movie fragment ('moof') and determine where the
+ * presentation ends, using the decode time of the fragment and
+ * the durations of its samples.
+ *
+ * @param ctx parser state
+ * @param offset offset of the 'moof' atom
+ */
+static void
+parse_last_moof (struct Mp4Context *ctx,
+		 uint64_t offset)
+{
+  struct Atom moof;
+  struct Atom traf;
+  struct Atom atom;
+  struct Track *track;
+  unsigned char *data;
+  size_t size;
+  size_t off;
+  uint64_t base_time;
+  uint64_t total;
+  uint32_t flags;
+  uint32_t count;
+  uint32_t default_duration;
+  uint32_t i;
+  int have_base_time;
+  double end;
+
+  if ( (0 != seek_to (ctx, offset)) ||
+       (0 != read_atom (ctx, ctx->fsize, &moof)) ||
+       (ATOM_MOOF != moof.type) )
+    return;
+  while ( (ctx->pos < moof.end) &&
+	  (0 == read_atom (ctx, moof.end, &traf)) )
+    {
+      if (ATOM_TRAF != traf.type)
+	{
+	  if (0 != seek_to (ctx, traf.end))
+	    return;
+	  continue;
+	}
+      track = NULL;
+      default_duration = 0;
+      have_base_time = 0;
+      base_time = 0;
+      total = 0;
+      while ( (ctx->pos < traf.end) &&
+	      (0 == read_atom (ctx, traf.end, &atom)) )
+	{
+	  data = NULL;
+	  if ( ( (ATOM_TFHD == atom.type) ||
+		 (ATOM_TFDT == atom.type) ||
+		 (ATOM_TRUN == atom.type) ) &&
+	       (atom.end - atom.data <= MAX_ATOM_SIZE) )
+	    data = read_payload (ctx, &atom, MAX_ATOM_SIZE, &size);
+	  if (NULL != data)
+	    {
+	      flags = (size >= 4) ? get_be32 (data) & 0xFFFFFF : 0;
+	      if ( (ATOM_TFHD == atom.type) &&
+		   (size >= 8) &&
+		   (NULL != (track = find_track (ctx, get_be32 (&data[4])))) )
+		{
+		  default_duration = track->default_duration;
+		  off = 8;
+		  if (0 != (flags & 0x01))
+		    off += 8; /* base data offset */
+		  if (0 != (flags & 0x02))
+		    off += 4; /* sample description index */
+		  if ( (0 != (flags & 0x08)) &&
+		       (size >= off + 4) )
+		    default_duration = get_be32 (&data[off]);
+		}
+	      if ( (ATOM_TFDT == atom.type) &&
+		   (size >= 8) )
+		{
+		  if ( (1 == data[0]) &&
+		       (size >= 12) )
+		    base_time = get_be64 (&data[4]);
+		  else
+		    base_time = get_be32 (&data[4]);
+		  have_base_time = 1;
+		}
+	      if ( (ATOM_TRUN == atom.type) &&
+		   (size >= 8) )
+		{
+		  count = get_be32 (&data[4]);
+		  off = 8;
+		  if (0 != (flags & 0x01))
+		    off += 4; /* data offset */
+		  if (0 != (flags & 0x04))
+		    off += 4; /* first sample flags */
+		  if (0 == (flags & 0x100))
+		    total += (uint64_t) count * default_duration;
+		  else
+		    for (i = 0; (i < count) && (off + 4 <= size); i++)
+		      {
+			total += get_be32 (&data[off]);
+			off += 4 * (1 + (0 != (flags & 0x200)) +
+				    (0 != (flags & 0x400)) + (0 != (flags & 0x800)));
+		      }
+		}
+	      free (data);
+	    }
+	  if (0 != seek_to (ctx, atom.end))
+	    return;
+	}
+      if ( (NULL != track) &&
+	   (have_base_time) &&
+	   (0 != track->timescale) )
+	{
+	  end = (double) (base_time + total) / track->timescale;
+	  if (end > ctx->last_fragment_end)
+	    ctx->last_fragment_end = end;
+	}
+      if (0 != seek_to (ctx, traf.end))
+	return;
+    }
+}
+
+
+/**
+ * Find the last movie fragment using the movie fragment random
+ * access atom ('mfra') at the end of the file.
+ *
+ * @param ctx parser state
+ * @return offset of the last 'moof' atom, 0 if not found
+ */
+static uint64_t
+find_last_moof (struct Mp4Context *ctx)
+{
+  struct Atom mfra;
+  struct Atom tfra;
+  unsigned char mfro[16];
+  unsigned char *data;
+  size_t size;
+  size_t off;
+  size_t entry_size;
+  uint64_t last;
+  uint64_t moof;
+  uint32_t mfra_size;
+  uint32_t lengths;
+  uint32_t count;
+
+  if ( (UINT64_MAX == ctx->fsize) ||
+       (ctx->fsize < sizeof (mfro)) ||
+       (0 != seek_to (ctx, ctx->fsize - sizeof (mfro))) ||
+       (0 != read_fully (ctx, mfro, sizeof (mfro))) ||
+       (ATOM_MFRO != get_be32 (&mfro[4])) )
+    return 0;
+  mfra_size = get_be32 (&mfro[12]);
+  if ( (mfra_size > ctx->fsize) ||
+       (0 != seek_to (ctx, ctx->fsize - mfra_size)) ||
+       (0 != read_atom (ctx, ctx->fsize, &mfra)) ||
+       (ATOM_MFRA != mfra.type) )
+    return 0;
+  last = 0;
+  while ( (ctx->pos < mfra.end) &&
+	  (0 == read_atom (ctx, mfra.end, &tfra)) )
+    {
+      if ( (ATOM_TFRA == tfra.type) &&
+	   (tfra.end - tfra.data <= MAX_ATOM_SIZE) &&
+	   (NULL != (data = read_payload (ctx, &tfra, MAX_ATOM_SIZE, &size))) )
+	{
+	  if (size >= 16)
+	    {
+	      lengths = get_be32 (&data[8]);
+	      count = get_be32 (&data[12]);
+	      /* time and moof offset, then traf, trun and sample numbers */
+	      entry_size = ((1 == data[0]) ? 16 : 8)
+		+ ((lengths >> 4) & 3) + 1
+		+ ((lengths >> 2) & 3) + 1
+		+ (lengths & 3) + 1;
+	      for (off = 16; (count > 0) && (off + entry_size <= size); off += entry_size, count--)
+		{
+		  moof = (1 == data[0])
+		    ? get_be64 (&data[off + 8])
+		    : get_be32 (&data[off + 4]);
+		  if (moof > last)
+		    last = moof;
+		}
+	    }
+	  free (data);
+	}
+      if (0 != seek_to (ctx, tfra.end))
+	break;
+    }
+  return last;
+}
+
+
+/**
+ * Report a track.
+ *
+ * @param ctx parser state
+ * @param track the track
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_track (struct Mp4Context *ctx,
+	      const struct Track *track)
+{
+  char format[256];
+  char dims[64];
+  char audio[128];
+  char codec[5];
+  const char *type_name;
+  unsigned int width;
+  unsigned int height;
+  unsigned int i;
+
+  type_name = NULL;
+  for (i = 0; NULL != track_types[i].name; i++)
+    if (track->handler == track_types[i].handler)
+      type_name = track_types[i].name;
+  if ( (NULL == type_name) ||
+       (0 == track->codec) )
+    return 0;
+  for (i = 0; i < 4; i++)
+    {
+      codec[i] = (char) (track->codec >> (24 - 8 * i));
+      if ( (codec[i] < 0x20) ||
+	   (codec[i] > 0x7E) )
+	codec[i] = '?';
+    }
+  codec[4] = '\0';
+  width = (0 != track->width) ? track->width : track->coded_width;
+  height = (0 != track->height) ? track->height : track->coded_height;
+  if ( (HANDLER_VIDE == track->handler) &&
+       (0 != width) &&
+       (0 != height) )
+    {
+      snprintf (dims,
+		sizeof (dims),
+		"%ux%u",
+		width,
+		height);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_IMAGE_DIMENSIONS, dims))
+	return 1;
+    }
+  audio[0] = '\0';
+  if ( (HANDLER_SOUN == track->handler) &&
+       (0 != track->channels) &&
+       (0 != track->sample_rate) )
+    snprintf (audio,
+	      sizeof (audio),
+	      ", %u-channel %u-bit at %uHz",
+	      (unsigned int) track->channels,
+	      (unsigned int) track->sample_size,
+	      (unsigned int) track->sample_rate);
+  snprintf (format,
+	    sizeof (format),
+	    "%s track (%s%s) [%s]",
+	    type_name,
+	    codec,
+	    audio,
+	    ('\0' != track->language[0]) ? track->language : "und");
+  return add_string (ctx, EXTRACTOR_METATYPE_RESOURCE_TYPE, format);
+}
+
+
+/**
+ * Report what we found in the movie header and the tracks.
+ *
+ * @param ctx parser state
+ * @return 0 to continue, 1 to abort extraction
+ */
+static int
+report_movie (struct Mp4Context *ctx)
+{
+  char format[64];
+  double seconds;
+  time_t t;
+  struct tm tm;
+  unsigned int i;
+
+  if (0 != add_string (ctx,
+		       EXTRACTOR_METATYPE_MIMETYPE,
+		       (NULL != ctx->mime) ? ctx->mime : "video/quicktime"))
+    return 1;
+  seconds = -1;
+  if (0 != ctx->timescale)
+    {
+      if (0 != ctx->duration)
+	seconds = (double) ctx->duration / ctx->timescale;
+      else if (0 != ctx->fragment_duration)
+	seconds = (double) ctx->fragment_duration / ctx->timescale;
+    }
+  if (seconds < 0)
+    seconds = ctx->last_fragment_end;
+  if ( (seconds > 0) &&
+       (seconds < 1e15) )
+    {
+      snprintf (format,
+		sizeof (format),
+		"%llus",
+		(unsigned long long) seconds);
+      if (0 != add_string (ctx, EXTRACTOR_METATYPE_DURATION, format))
+	return 1;
+    }
+  if ( (ctx->creation_time > MAC_EPOCH_OFFSET) &&
+       (ctx->creation_time - MAC_EPOCH_OFFSET < (1ULL << 40)) )
+    {
+      t = (time_t) (ctx->creation_time - MAC_EPOCH_OFFSET);
+      if ( (NULL != gmtime_r (&t, &tm)) &&
+	   (0 != strftime (format,
+			   sizeof (format),
+			   "%Y.%m.%d %H:%M:%S UTC",
+			   &tm)) &&
+	   (0 != add_string (ctx, EXTRACTOR_METATYPE_CREATION_DATE, format)) )
+	return 1;
+    }
+  for (i = 0; i < ctx->num_tracks; i++)
+    if (0 != report_track (ctx, &ctx->tracks[i]))
+      return 1;
+  return 0;
+}
+
+
+/**
+ * Check if the MIME type we were given is one we handle.
+ *
+ * @param mime MIME type
+ * @return 1 if so, 0 if not
+ */
+static int
+is_supported_mime (const char *mime)
+{
+  unsigned int i;
+
+  for (i = 0; NULL != brand_map[i].brand; i++)
+    if (0 == strcmp (mime, brand_map[i].mime))
+      return 1;
+  return 0;
+}
+
+
 /**
  * Main entry method for the MP4 extraction plugin.
  *
  * @param ec extraction context provided to the plugin
  */
-void 
+void
 EXTRACTOR_mp4_extract_method (struct EXTRACTOR_ExtractContext *ec)
 {
-  MP4FileProvider fp;
-  MP4FileHandle mp4;
-  const MP4Tags *tags;
-  char ecp[128];
-
-  if (1)
-    return; /* plugin is known not to work yet;
-	       see issue 138 filed against MP4v2 lib */
-  snprintf (ecp, sizeof (ecp), "%p", ec);
-  fp.open = &open_cb;
-  fp.seek = &seek_cb;
-  fp.read = &read_cb;
-  fp.write = &write_cb;
-  fp.close = &close_cb;
-  if (NULL == (mp4 = MP4ReadProvider (ecp,
-				      &fp)))
+  struct Mp4Context ctx;
+  struct Atom atom;
+  unsigned char brand[4];
+  unsigned int count;
+  unsigned int i;
+  uint64_t last_moof;
+  int ret;
+
+  if ( (NULL != ec->mime_hint) &&
+       (! is_supported_mime (ec->mime_hint)) )
     return;
-  tags = MP4TagsAlloc ();
-  if (MP4TagsFetch (tags, mp4))
+  memset (&ctx, 0, sizeof (ctx));
+  ctx.ec = ec;
+  ctx.fsize = ec->get_size (ec->cls);
+  ctx.last_fragment_end = -1;
+  for (count = 0; count < MAX_TOP_LEVEL_ATOMS; count++)
     {
-      fprintf (stderr, "got tags!\n");
+      if (0 != read_atom (&ctx, ctx.fsize, &atom))
+	break;
+      ret = 0;
+      switch (atom.type)
+	{
+	case ATOM_FTYP:
+	  if ( (atom.end - atom.data >= sizeof (brand)) &&
+	       (0 == read_fully (&ctx, brand, sizeof (brand))) )
+	    for (i = 0; NULL != brand_map[i].brand; i++)
+	      if (0 == memcmp (brand, brand_map[i].brand, 4))
+		ctx.mime = brand_map[i].mime;
+	  break;
+	case ATOM_MOOV:
+	  if (! ctx.have_moov)
+	    {
+	      ctx.have_moov = 1;
+	      ret = parse_children (&ctx, &atom, 0, NULL);
+	    }
+	  break;
+	case ATOM_MOOF:
+	  ctx.last_moof = atom.start;
+	  break;
+	case ATOM_MDAT:
+	case ATOM_FREE:
+	case ATOM_SKIP:
+	case ATOM_WIDE:
+	case ATOM_PNOT:
+	case ATOM_JUNK:
+	case ATOM_UUID:
+	case ATOM_MFRA:
+	case ATOM_SIDX:
+	case ATOM_STYP:
+	  break;
+	default:
+	  if (0 == count)
+	    return; /* not an ISO base media or QuickTime file */
+	  break;
+	}
+      if (1 == ret)
+	return;
+      if ( (ctx.have_moov) &&
+	   ( (! ctx.fragmented) ||
+	     (0 != ctx.fragment_duration) ) )
+	break; /* got everything we need */
+      if ( (ctx.have_moov) &&
+	   (0 == ctx.last_moof) &&
+	   (0 != (last_moof = find_last_moof (&ctx))) )
+	{
+	  /* no need to walk all the fragments */
+	  ctx.last_moof = last_moof;
+	  break;
+	}
+      if (0 != seek_to (&ctx, atom.end))
+	break;
     }
-  MP4Close (mp4, 0);
+  if (! ctx.have_moov)
+    return;
+  if ( (ctx.fragmented) &&
+       (0 == ctx.fragment_duration) &&
+       (0 != ctx.last_moof) )
+    parse_last_moof (&ctx, ctx.last_moof);
+  (void) report_movie (&ctx);
 }
 
 /* end of mp4_extractor.c */
@@ -45,10 +45,10 @@
 
 
 /**
- * Set to 1 to use our own GsfInput subclass which supports seeking
- * and thus can handle very large files.  Set to 0 to use the simple
- * gsf in-memory buffer (which can only access the first ~16k) for
- * debugging.
+ * Set to 1 to use our own GsfInput subclass which reads (and caches)
+ * only the parts of the file GSF asks for and thus can handle very
+ * large files.  Set to 0 to use the simple gsf in-memory buffer
+ * (which can only access the first ~1k) for debugging.
  */
 #define USE_LE_INPUT 1
 
@@ -626,6 +626,42 @@ history_extract (GsfInput *stream,
 #define IS_LE_INPUT_CLASS(klass)       (G_TYPE_CHECK_CLASS_TYPE ((klass), LE_TYPE_INPUT))
 #define LE_INPUT_GET_CLASS(obj)        (G_TYPE_INSTANCE_GET_CLASS ((obj), LE_TYPE_INPUT, LeInputClass))
 
+/**
+ * Size of a block in our cache; a multiple of both OLE2 sector
+ * sizes (512 and 4096).
+ */
+#define LE_INPUT_BLOCK_SIZE 4096
+
+/**
+ * Number of blocks in our cache.  OLE2 readers jump between the
+ * FAT, the directory and the streams, so a few blocks go a long way.
+ */
+#define LE_INPUT_CACHE_BLOCKS 32
+
+
+/**
+ * Cached block of the file.
+ */
+struct LeInputBlock
+{
+  /**
+   * Offset of the block divided by LE_INPUT_BLOCK_SIZE.
+   */
+  uint64_t index;
+
+  /**
+   * Number of valid bytes in data, 0 if the block is unused
+   * (less than LE_INPUT_BLOCK_SIZE only for the last block).
+   */
+  size_t size;
+
+  /**
+   * Data of the block.
+   */
+  guint8 data[LE_INPUT_BLOCK_SIZE];
+};
+
+
 /**
  * Internal state of an "LeInput" object.
  */
@@ -635,6 +671,27 @@ typedef struct _LeInputPrivate
    * Our extraction context.
    */
   struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Blocks we have read (array of length LE_INPUT_CACHE_BLOCKS).
+   */
+  struct LeInputBlock *cache;
+
+  /**
+   * Slot in cache to use for the next block we read.
+   */
+  unsigned int next_block;
+
+  /**
+   * Buffer for reads spanning several blocks (if the caller
+   * did not provide one).
+   */
+  guint8 *buf;
+
+  /**
+   * Number of bytes allocated for buf.
+   */
+  size_t buf_size;
 } LeInputPrivate;
 
 
@@ -709,20 +766,75 @@ GSF_CLASS (LeInput, le_input, le_input_class_init, le_input_init, GSF_INPUT_TYPE
 
 
 /**
- * Duplicate input, leaving the new one at the same offset.
+ * Duplicate input, leaving the new one at the same offset.  As we
+ * seek before every read of a block, the copies can share the
+ * extraction context (but each has its own cache).
  *
  * @param input the input to duplicate
  * @param err location for error reporting, can be NULL
- * @return NULL on error (always)
+ * @return NULL on error
  */
 static GsfInput *
 le_input_dup (GsfInput *input,
 	      GError **err)
 {
-  if (NULL != err)
-    *err = g_error_new (gsf_input_error_id (), 0,
-			"dup not supported on LeInput");
-  return NULL;
+  LeInput *li = LE_INPUT (input);
+  GsfInput *dup;
+
+  if (NULL == (dup = le_input_new (li->priv->ec)))
+    {
+      if (NULL != err)
+	*err = g_error_new (gsf_input_error_id (), 0,
+			    "failed to duplicate LeInput");
+      return NULL;
+    }
+  /* gsf_input_dup() moves the copy to our offset */
+  return dup;
+}
+
+
+/**
+ * Get a block of the file, from the cache or by reading it.
+ *
+ * @param priv state of the input
+ * @param index offset of the block divided by LE_INPUT_BLOCK_SIZE
+ * @return NULL on error
+ */
+static const struct LeInputBlock *
+le_input_get_block (LeInputPrivate *priv,
+		    uint64_t index)
+{
+  struct EXTRACTOR_ExtractContext *ec = priv->ec;
+  struct LeInputBlock *block;
+  unsigned int i;
+  void *data;
+  ssize_t ret;
+
+  for (i = 0; i < LE_INPUT_CACHE_BLOCKS; i++)
+    if ( (0 != priv->cache[i].size) &&
+	 (index == priv->cache[i].index) )
+      return &priv->cache[i];
+  block = &priv->cache[priv->next_block];
+  priv->next_block = (priv->next_block + 1) % LE_INPUT_CACHE_BLOCKS;
+  block->size = 0;
+  if (index * LE_INPUT_BLOCK_SIZE !=
+      ec->seek (ec->cls, index * LE_INPUT_BLOCK_SIZE, SEEK_SET))
+    return NULL;
+  while (block->size < LE_INPUT_BLOCK_SIZE)
+    {
+      /* the shared memory window may give us less than we asked for */
+      ret = ec->read (ec->cls,
+		      &data,
+		      LE_INPUT_BLOCK_SIZE - block->size);
+      if (ret <= 0)
+	break;
+      memcpy (&block->data[block->size], data, ret);
+      block->size += ret;
+    }
+  if (0 == block->size)
+    return NULL;
+  block->index = index;
+  return block;
 }
 
 
@@ -743,36 +855,56 @@ le_input_read (GsfInput *input,
 	       guint8 *optional_buffer)
 {
   LeInput *li = LE_INPUT (input);
-  struct EXTRACTOR_ExtractContext *ec;
-  void *buf;
-  uint64_t old_off;
-  ssize_t ret;
-
-  ec = li->priv->ec;
-  old_off = ec->seek (ec->cls, 0, SEEK_CUR);
-  if (num_bytes
-      != (ret = ec->read (ec->cls,
-			  &buf,
-			  num_bytes)))
+  LeInputPrivate *priv = li->priv;
+  const struct LeInputBlock *block;
+  guint8 *buf;
+  gsf_off_t off;
+  size_t pos;
+  size_t boff;
+  size_t n;
+
+  off = gsf_input_tell (input);
+  boff = off % LE_INPUT_BLOCK_SIZE;
+  if ( (NULL == optional_buffer) &&
+       (boff + num_bytes <= LE_INPUT_BLOCK_SIZE) )
     {
-      /* we don't support partial reads;
-	 most other GsfInput implementations in this case
-	 allocate some huge temporary buffer just to avoid
-	 the partial read; we might need to do that as well!? */
-      ec->seek (ec->cls, SEEK_SET, old_off);
-      return NULL;
+      /* common case, no need to copy */
+      if ( (NULL == (block = le_input_get_block (priv,
+						 off / LE_INPUT_BLOCK_SIZE))) ||
+	   (block->size < boff + num_bytes) )
+	return NULL;
+      return &block->data[boff];
+    }
+  buf = optional_buffer;
+  if (NULL == buf)
+    {
+      if (priv->buf_size < num_bytes)
+	{
+	  g_free (priv->buf);
+	  priv->buf = g_malloc (num_bytes);
+	  priv->buf_size = num_bytes;
+	}
+      buf = priv->buf;
     }
-  if (NULL != optional_buffer)
+  for (pos = 0; pos < num_bytes; pos += n)
     {
-      memcpy (optional_buffer, buf, num_bytes);
-      return optional_buffer;
+      boff = (off + pos) % LE_INPUT_BLOCK_SIZE;
+      n = LE_INPUT_BLOCK_SIZE - boff;
+      if (n > num_bytes - pos)
+	n = num_bytes - pos;
+      if ( (NULL == (block = le_input_get_block (priv,
+						 (off + pos) / LE_INPUT_BLOCK_SIZE))) ||
+	   (block->size < boff + n) )
+	return NULL;
+      memcpy (&buf[pos], &block->data[boff], n);
     }
   return buf;
 }
 
 
 /**
- * Move the current location in an input stream
+ * Move the current location in an input stream.  We read at
+ * the offset GSF keeps track of, so there is nothing to do.
  *
  * @param input stream to seek
  * @param offset target offset
@@ -784,32 +916,39 @@ le_input_seek (GsfInput *input,
 	       gsf_off_t offset,
 	       GSeekType whence)
 {
-  LeInput *li = LE_INPUT (input);
-  struct EXTRACTOR_ExtractContext *ec;
-  int w;
-  int64_t ret;
-
-  ec = li->priv->ec;
   switch (whence)
     {
     case G_SEEK_SET:
-      w = SEEK_SET;
-      break;
     case G_SEEK_CUR:
-      w = SEEK_CUR;
-      break;
     case G_SEEK_END:
-      w = SEEK_END;
-      break;
+      return FALSE;
     default:
       return TRUE;
     }
-  if (-1 ==
-      (ret = ec->seek (ec->cls,
-		       offset,
-		       w)))
-    return TRUE;
-  return FALSE;
+}
+
+
+/**
+ * Parent class of LeInput, for chaining up in finalize.
+ */
+static GObjectClass *le_input_parent_class;
+
+
+/**
+ * Release the resources of an LeInput object.
+ *
+ * @param obj the object to finalize
+ */
+static void
+le_input_finalize (GObject *obj)
+{
+  LeInput *li = LE_INPUT (obj);
+
+  g_free (li->priv->cache);
+  li->priv->cache = NULL;
+  g_free (li->priv->buf);
+  li->priv->buf = NULL;
+  le_input_parent_class->finalize (obj);
 }
 
 
@@ -823,6 +962,8 @@ le_input_class_init (LeInputClass *class)
 {
   GsfInputClass *input_class;
 
+  le_input_parent_class = g_type_class_peek_parent (class);
+  G_OBJECT_CLASS (class)->finalize = le_input_finalize;
   input_class = (GsfInputClass *) class;
   input_class->Dup = le_input_dup;
   input_class->Read = le_input_read;
@@ -846,6 +987,10 @@ le_input_init (LeInput *input)
 				 LeInputPrivate);
   priv = input->priv;
   priv->ec = NULL;
+  priv->cache = g_new0 (struct LeInputBlock, LE_INPUT_CACHE_BLOCKS);
+  priv->next_block = 0;
+  priv->buf = NULL;
+  priv->buf_size = 0;
 }
 
 
@@ -907,7 +1052,8 @@ EXTRACTOR_ole2_extract_method (struct EXTRACTOR_ExtractContext *ec)
       /* File too small for OLE2 */
       return; /* can hardly be OLE2 */
     }
-  if (512 + 898 > (data_size = ec->read (ec->cls, &data, fsize)))
+  /* only read what we need here, LeInput reads the rest on demand */
+  if (512 + 898 > (data_size = ec->read (ec->cls, &data, 512 + 898)))
     {
       /* Failed to read minimum file size to buffer */
       return;
@@ -1,6 +1,6 @@
 /*
      This file is part of libextractor.
-     Copyright (C) 2016 Christian Grothoff
+     Copyright (C) 2016, 2018 Christian Grothoff
 
      libextractor is free software; you can redistribute it and/or modify
      it under the terms of the GNU General Public License as published
@@ -22,25 +22,1826 @@
  * @brief plugin to support PDF files
  * @author Christian Grothoff
  *
- * PDF libraries today are a nightmare (TM).  So instead of doing the
- * fast thing and calling some library functions to parse the PDF,
- * we execute 'pdfinfo' and parse the output. Because that's 21st
- * century plumbing: nobody writes reasonable code anymore.
+ * We only parse the small part of PDF needed for meta data: starting
+ * from 'startxref' at the end of the file, we follow the cross
+ * reference tables (or streams) to the trailer, and from there load
+ * only the '/Info' dictionary, the catalog with its XMP '/Metadata'
+ * stream and the root of the page tree.  So even for huge files, we
+ * only do a few small reads.  Encrypted documents are not decrypted.
  */
 #include "platform.h"
-#include <extractor.h>
-#include <sys/types.h>
-#include <sys/wait.h>
-#include <signal.h>
-#include <unistd.h>
+#include "extractor.h"
+#include "convert.h"
+#include <zlib.h>
 
 /**
- * Entry in the mapping from control data to LE types.
+ * How many bytes at the end of the file do we search for 'startxref'?
+ */
+#define TAIL_SIZE 1024
+
+/**
+ * Initial number of bytes we read to parse an object; we retry with
+ * more if the object turns out to be larger.
+ */
+#define OBJECT_WINDOW 4096
+
+/**
+ * Maximum number of bytes we read to parse a (non-stream) object.
+ */
+#define MAX_OBJECT_SIZE (1024 * 1024)
+
+/**
+ * Maximum (encoded and decoded) size of streams we are willing to load.
+ */
+#define MAX_STREAM_SIZE (32 * 1024 * 1024)
+
+/**
+ * Maximum number of cross reference sections we follow via '/Prev'.
+ */
+#define MAX_SECTIONS 64
+
+/**
+ * Maximum nesting of arrays and dictionaries, and of indirect
+ * objects we resolve while loading another object.
+ */
+#define MAX_DEPTH 32
+
+/**
+ * Maximum number of elements in an array or dictionary.
+ */
+#define MAX_ITEMS 65536
+
+/**
+ * Object number to pass to #parse_object_at() to accept any object.
+ */
+#define ANY_OBJECT UINT64_MAX
+
+/**
+ * Object number to pass to #parse_object_at() for objects without
+ * 'NUM GEN obj' header (the trailer dictionary).
+ */
+#define NO_HEADER (UINT64_MAX - 1)
+
+
+/**
+ * Types of PDF objects.
+ */
+enum PdfType
+{
+  PDF_NULL,
+  PDF_BOOL,
+  PDF_NUMBER,
+  PDF_STRING,
+  PDF_NAME,
+  PDF_ARRAY,
+  PDF_DICT,
+  PDF_REF
+};
+
+
+/**
+ * A parsed PDF object.
+ */
+struct PdfObject
+{
+  /**
+   * Type of the object.
+   */
+  enum PdfType type;
+
+  /**
+   * Value of a number (integer part) or boolean, object number
+   * of a reference.
+   */
+  int64_t num;
+
+  /**
+   * Bytes of a string or name (0-terminated, but strings may also
+   * contain 0-bytes).
+   */
+  char *str;
+
+  /**
+   * Number of bytes in @e str.
+   */
+  size_t str_len;
+
+  /**
+   * Elements of an array, or alternating keys (names) and values
+   * of a dictionary.
+   */
+  struct PdfObject **items;
+
+  /**
+   * Number of entries in @e items.
+   */
+  unsigned int num_items;
+};
+
+
+/**
+ * Sub-section of a cross reference table ('xref' keyword).
+ */
+struct XrefSubsection
+{
+  /**
+   * Offset of the first entry in the file.
+   */
+  uint64_t offset;
+
+  /**
+   * Number of the first object.
+   */
+  uint64_t first;
+
+  /**
+   * Number of objects.
+   */
+  uint64_t count;
+
+  /**
+   * Length of an entry (20 according to the standard, but some
+   * writers get the line endings wrong).
+   */
+  unsigned int entry_len;
+};
+
+
+/**
+ * A section of cross reference information, either a table
+ * or a (decoded) cross reference stream.
+ */
+struct XrefSection
+{
+  /**
+   * Subsections of a table, NULL for a stream.
+   */
+  struct XrefSubsection *subs;
+
+  /**
+   * Number of entries in @e subs.
+   */
+  unsigned int num_subs;
+
+  /**
+   * Decoded data of a stream.
+   */
+  unsigned char *data;
+
+  /**
+   * Number of bytes in @e data.
+   */
+  size_t data_len;
+
+  /**
+   * Field widths of a stream ('/W').
+   */
+  unsigned int w[3];
+
+  /**
+   * Pairs of first object number and count of a stream ('/Index').
+   */
+  uint64_t *index;
+
+  /**
+   * Number of pairs in @e index.
+   */
+  unsigned int num_index;
+};
+
+
+/**
+ * Where to find an object.
+ */
+struct XrefEntry
+{
+  /**
+   * 1 for an object at a file offset, 2 for an object in
+   * an object stream.
+   */
+  unsigned int type;
+
+  /**
+   * File offset (type 1) or number of the object stream (type 2).
+   */
+  uint64_t offset;
+
+  /**
+   * Index in the object stream (type 2).
+   */
+  uint64_t index;
+};
+
+
+/**
+ * Our state while processing a PDF file.
+ */
+struct PdfContext
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Size of the file.
+   */
+  uint64_t fsize;
+
+  /**
+   * Cross reference sections, newest first.
+   */
+  struct XrefSection sections[MAX_SECTIONS];
+
+  /**
+   * Number of valid entries in @e sections.
+   */
+  unsigned int num_sections;
+
+  /**
+   * Decoded data of the last object stream we used.
+   */
+  unsigned char *objstm;
+
+  /**
+   * Number of bytes in @e objstm.
+   */
+  size_t objstm_len;
+
+  /**
+   * Object number of @e objstm.
+   */
+  uint64_t objstm_num;
+
+  /**
+   * '/N' of @e objstm.
+   */
+  uint64_t objstm_n;
+
+  /**
+   * '/First' of @e objstm.
+   */
+  uint64_t objstm_first;
+
+  /**
+   * Current nesting of object loads (to detect reference loops).
+   */
+  unsigned int depth;
+};
+
+
+/**
+ * Buffer we parse objects from.
+ */
+struct Buffer
+{
+  /**
+   * Data to parse.
+   */
+  const unsigned char *data;
+
+  /**
+   * Number of bytes in @e data.
+   */
+  size_t size;
+
+  /**
+   * Current position in @e data.
+   */
+  size_t pos;
+
+  /**
+   * Set to 1 if parsing failed because we hit the end of the data.
+   */
+  int truncated;
+};
+
+
+/**
+ * Is the given character PDF whitespace?
+ *
+ * @param c character to test
+ * @return non-zero if @a c is whitespace
+ */
+static int
+is_space (unsigned char c)
+{
+  return ( (' ' == c) || ('\n' == c) || ('\r' == c) ||
+	   ('\t' == c) || ('\f' == c) || ('\0' == c) );
+}
+
+
+/**
+ * Is the given character a PDF delimiter?
+ *
+ * @param c character to test
+ * @return non-zero if @a c is a delimiter
+ */
+static int
+is_delim (unsigned char c)
+{
+  return (NULL != strchr ("()<>[]{}/%", c)) && ('\0' != c);
+}
+
+
+/**
+ * Read exactly @a size bytes at @a off from the file.
+ *
+ * @param pc our context
+ * @param off offset to read from
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return number of bytes read (smaller than @a size only at
+ *         the end of the file), -1 on error
+ */
+static ssize_t
+read_at (struct PdfContext *pc,
+	 uint64_t off,
+	 unsigned char *buf,
+	 size_t size)
+{
+  size_t got;
+  ssize_t ret;
+  void *data;
+
+  if (off >= pc->fsize)
+    return 0;
+  if (size > pc->fsize - off)
+    size = pc->fsize - off;
+  if ((int64_t) off != pc->ec->seek (pc->ec->cls, off, SEEK_SET))
+    return -1;
+  got = 0;
+  while (got < size)
+    {
+      if (0 >= (ret = pc->ec->read (pc->ec->cls, &data, size - got)))
+	break;
+      memcpy (&buf[got], data, ret);
+      got += ret;
+    }
+  return got;
+}
+
+
+/**
+ * Skip whitespace and comments.
+ *
+ * @param b buffer to advance
+ */
+static void
+skip_space (struct Buffer *b)
+{
+  while (b->pos < b->size)
+    {
+      if ('%' == b->data[b->pos])
+	{
+	  while ( (b->pos < b->size) &&
+		  ('\n' != b->data[b->pos]) &&
+		  ('\r' != b->data[b->pos]) )
+	    b->pos++;
+	  continue;
+	}
+      if (! is_space (b->data[b->pos]))
+	return;
+      b->pos++;
+    }
+}
+
+
+/**
+ * Parse an unsigned integer at the current position (without
+ * skipping whitespace before it).
+ *
+ * @param b buffer to parse
+ * @param ret set to the value
+ * @return 0 on success, -1 if there is no integer
+ */
+static int
+parse_uint (struct Buffer *b,
+	    uint64_t *ret)
+{
+  uint64_t v;
+  size_t start;
+
+  start = b->pos;
+  v = 0;
+  while ( (b->pos < b->size) &&
+	  (isdigit (b->data[b->pos])) &&
+	  (v < UINT64_MAX / 100) )
+    v = v * 10 + (b->data[b->pos++] - '0');
+  if (start == b->pos)
+    return -1;
+  *ret = v;
+  return 0;
+}
+
+
+/**
+ * Check if the given keyword follows at the current position
+ * (after whitespace), and if so skip it.
+ *
+ * @param b buffer to parse
+ * @param kw keyword to check for
+ * @return 1 if the keyword was found, 0 if not
+ */
+static int
+skip_keyword (struct Buffer *b,
+	      const char *kw)
+{
+  size_t len = strlen (kw);
+
+  skip_space (b);
+  if (b->pos + len > b->size)
+    {
+      b->truncated = 1;
+      return 0;
+    }
+  if (0 != memcmp (&b->data[b->pos], kw, len))
+    return 0;
+  if ( (b->pos + len < b->size) &&
+       (! is_space (b->data[b->pos + len])) &&
+       (! is_delim (b->data[b->pos + len])) )
+    return 0;
+  b->pos += len;
+  return 1;
+}
+
+
+/**
+ * Free a parsed object.
+ *
+ * @param obj object to free, can be NULL
+ */
+static void
+free_object (struct PdfObject *obj)
+{
+  unsigned int i;
+
+  if (NULL == obj)
+    return;
+  for (i = 0; i < obj->num_items; i++)
+    free_object (obj->items[i]);
+  free (obj->items);
+  free (obj->str);
+  free (obj);
+}
+
+
+/**
+ * Append an element to an array or dictionary.
+ *
+ * @param obj array or dictionary to extend
+ * @param item element to append
+ * @return 0 on success, -1 on error (@a item is freed)
+ */
+static int
+append_item (struct PdfObject *obj,
+	     struct PdfObject *item)
+{
+  struct PdfObject **items;
+
+  if (obj->num_items >= MAX_ITEMS)
+    {
+      free_object (item);
+      return -1;
+    }
+  if (0 == (obj->num_items & (obj->num_items - 1)))
+    {
+      /* size is 0 or a power of two, double the allocation */
+      items = realloc (obj->items,
+		       sizeof (struct PdfObject *) *
+		       (0 == obj->num_items ? 4 : 2 * obj->num_items));
+      if (NULL == items)
+	{
+	  free_object (item);
+	  return -1;
+	}
+      obj->items = items;
+    }
+  obj->items[obj->num_items++] = item;
+  return 0;
+}
+
+
+/**
+ * Parse a literal string ('(...)'), the opening parenthesis has
+ * already been consumed.
+ *
+ * @param b buffer to parse
+ * @param obj string object to fill in
+ * @return 0 on success, -1 on error
+ */
+static int
+parse_literal_string (struct Buffer *b,
+		      struct PdfObject *obj)
+{
+  unsigned int nesting;
+  unsigned int i;
+  size_t len;
+  char *str;
+  unsigned char c;
+  unsigned char v;
+
+  /* decoded string is never longer than the rest of the buffer */
+  if (NULL == (str = malloc (b->size - b->pos + 1)))
+    return -1;
+  len = 0;
+  nesting = 1;
+  while (1)
+    {
+      if (b->pos >= b->size)
+	{
+	  b->truncated = 1;
+	  free (str);
+	  return -1;
+	}
+      c = b->data[b->pos++];
+      if ('(' == c)
+	nesting++;
+      if ( (')' == c) &&
+	   (0 == --nesting) )
+	break;
+      if ('\\' != c)
+	{
+	  str[len++] = c;
+	  continue;
+	}
+      if (b->pos >= b->size)
+	continue; /* we'll notice the truncation above */
+      c = b->data[b->pos++];
+      switch (c)
+	{
+	case 'n': str[len++] = '\n'; break;
+	case 'r': str[len++] = '\r'; break;
+	case 't': str[len++] = '\t'; break;
+	case 'b': str[len++] = '\b'; break;
+	case 'f': str[len++] = '\f'; break;
+	case '\r':
+	  /* line continuation */
+	  if ( (b->pos < b->size) &&
+	       ('\n' == b->data[b->pos]) )
+	    b->pos++;
+	  break;
+	case '\n':
+	  break;
+	default:
+	  if ( (c >= '0') && (c <= '7') )
+	    {
+	      v = c - '0';
+	      for (i = 0; i < 2; i++)
+		{
+		  if ( (b->pos >= b->size) ||
+		       (b->data[b->pos] < '0') ||
+		       (b->data[b->pos] > '7') )
+		    break;
+		  v = v * 8 + (b->data[b->pos++] - '0');
+		}
+	      str[len++] = v;
+	    }
+	  else
+	    {
+	      /* '\\', '(', ')' and unknown escapes */
+	      str[len++] = c;
+	    }
+	  break;
+	}
+    }
+  str[len] = '\0';
+  obj->str = str;
+  obj->str_len = len;
+  return 0;
+}
+
+
+/**
+ * Get the value of a hex digit.
+ *
+ * @param c character to convert
+ * @return value of @a c, -1 if it is not a hex digit
+ */
+static int
+hex_value (unsigned char c)
+{
+  if ( (c >= '0') && (c <= '9') )
+    return c - '0';
+  if ( (c >= 'a') && (c <= 'f') )
+    return c - 'a' + 10;
+  if ( (c >= 'A') && (c <= 'F') )
+    return c - 'A' + 10;
+  return -1;
+}
+
+
+/**
+ * Parse a hex string ('<...>'), the opening bracket has
+ * already been consumed.
+ *
+ * @param b buffer to parse
+ * @param obj string object to fill in
+ * @return 0 on success, -1 on error
+ */
+static int
+parse_hex_string (struct Buffer *b,
+		  struct PdfObject *obj)
+{
+  size_t len;
+  char *str;
+  int hi;
+  int v;
+
+  if (NULL == (str = malloc ((b->size - b->pos) / 2 + 2)))
+    return -1;
+  len = 0;
+  hi = -1;
+  while (1)
+    {
+      if (b->pos >= b->size)
+	{
+	  b->truncated = 1;
+	  free (str);
+	  return -1;
+	}
+      if ('>' == b->data[b->pos])
+	{
+	  b->pos++;
+	  break;
+	}
+      if (-1 == (v = hex_value (b->data[b->pos++])))
+	continue; /* whitespace (or junk) */
+      if (-1 == hi)
+	{
+	  hi = v;
+	  continue;
+	}
+      str[len++] = (char) (hi * 16 + v);
+      hi = -1;
+    }
+  if (-1 != hi)
+    str[len++] = (char) (hi * 16);
+  str[len] = '\0';
+  obj->str = str;
+  obj->str_len = len;
+  return 0;
+}
+
+
+/**
+ * Parse a name ('/...'), the slash has already been consumed.
+ *
+ * @param b buffer to parse
+ * @param obj name object to fill in
+ * @return 0 on success, -1 on error
+ */
+static int
+parse_name (struct Buffer *b,
+	    struct PdfObject *obj)
+{
+  size_t start;
+  size_t len;
+  char *str;
+  int hi;
+  int lo;
+
+  start = b->pos;
+  while ( (b->pos < b->size) &&
+	  (! is_space (b->data[b->pos])) &&
+	  (! is_delim (b->data[b->pos])) )
+    b->pos++;
+  if (NULL == (str = malloc (b->pos - start + 1)))
+    return -1;
+  len = 0;
+  while (start < b->pos)
+    {
+      if ( ('#' == b->data[start]) &&
+	   (start + 2 < b->pos) &&
+	   (-1 != (hi = hex_value (b->data[start + 1]))) &&
+	   (-1 != (lo = hex_value (b->data[start + 2]))) )
+	{
+	  str[len++] = (char) (hi * 16 + lo);
+	  start += 3;
+	  continue;
+	}
+      str[len++] = b->data[start++];
+    }
+  str[len] = '\0';
+  obj->str = str;
+  obj->str_len = len;
+  return 0;
+}
+
+
+/**
+ * Parse a PDF object.
+ *
+ * @param b buffer to parse
+ * @param depth nesting level of the object
+ * @return NULL on error
+ */
+static struct PdfObject *
+parse_object (struct Buffer *b,
+	      unsigned int depth)
+{
+  struct PdfObject *obj;
+  struct PdfObject *item;
+  uint64_t val;
+  uint64_t gen;
+  size_t save;
+  int neg;
+  unsigned char c;
+
+  if (depth > MAX_DEPTH)
+    return NULL;
+  skip_space (b);
+  if (b->pos >= b->size)
+    {
+      b->truncated = 1;
+      return NULL;
+    }
+  if (NULL == (obj = malloc (sizeof (struct PdfObject))))
+    return NULL;
+  memset (obj, 0, sizeof (struct PdfObject));
+  c = b->data[b->pos++];
+  switch (c)
+    {
+    case '(':
+      obj->type = PDF_STRING;
+      if (0 != parse_literal_string (b, obj))
+	goto ERROR;
+      return obj;
+    case '/':
+      obj->type = PDF_NAME;
+      if (0 != parse_name (b, obj))
+	goto ERROR;
+      return obj;
+    case '[':
+      obj->type = PDF_ARRAY;
+      while (1)
+	{
+	  skip_space (b);
+	  if (b->pos >= b->size)
+	    {
+	      b->truncated = 1;
+	      goto ERROR;
+	    }
+	  if (']' == b->data[b->pos])
+	    {
+	      b->pos++;
+	      return obj;
+	    }
+	  if ( (NULL == (item = parse_object (b, depth + 1))) ||
+	       (0 != append_item (obj, item)) )
+	    goto ERROR;
+	}
+    case '<':
+      if (b->pos >= b->size)
+	{
+	  b->truncated = 1;
+	  goto ERROR;
+	}
+      if ('<' != b->data[b->pos])
+	{
+	  obj->type = PDF_STRING;
+	  if (0 != parse_hex_string (b, obj))
+	    goto ERROR;
+	  return obj;
+	}
+      b->pos++;
+      obj->type = PDF_DICT;
+      while (1)
+	{
+	  skip_space (b);
+	  if (b->pos + 1 >= b->size)
+	    {
+	      b->truncated = 1;
+	      goto ERROR;
+	    }
+	  if ( ('>' == b->data[b->pos]) &&
+	       ('>' == b->data[b->pos + 1]) )
+	    {
+	      b->pos += 2;
+	      if (0 != (obj->num_items % 2))
+		goto ERROR;
+	      return obj;
+	    }
+	  if ( (NULL == (item = parse_object (b, depth + 1))) ||
+	       (0 != append_item (obj, item)) )
+	    goto ERROR;
+	  if ( (0 != (obj->num_items % 2)) &&
+	       (PDF_NAME != item->type) )
+	    goto ERROR; /* keys must be names */
+	}
+    default:
+      break;
+    }
+  b->pos--;
+  if ( (isdigit (c)) ||
+       ('-' == c) ||
+       ('+' == c) ||
+       ('.' == c) )
+    {
+      obj->type = PDF_NUMBER;
+      neg = ('-' == c);
+      if ( ('-' == c) || ('+' == c) )
+	b->pos++;
+      if (0 != parse_uint (b, &val))
+	val = 0; /* i.e. '.5' */
+      obj->num = (int64_t) val;
+      /* skip fractional part, we only need integers */
+      if ( (b->pos < b->size) &&
+	   ('.' == b->data[b->pos]) )
+	{
+	  b->pos++;
+	  while ( (b->pos < b->size) &&
+		  (isdigit (b->data[b->pos])) )
+	    b->pos++;
+	}
+      else if (! neg)
+	{
+	  /* might be a reference, 'NUM GEN R' */
+	  save = b->pos;
+	  skip_space (b);
+	  if ( (0 == parse_uint (b, &gen)) &&
+	       (skip_keyword (b, "R")) )
+	    {
+	      obj->type = PDF_REF;
+	      return obj;
+	    }
+	  /* 'truncated' may have been set by looking ahead past the
+	     end, but the number itself is complete */
+	  b->truncated = 0;
+	  b->pos = save;
+	}
+      if (neg)
+	obj->num = - obj->num;
+      return obj;
+    }
+  if (skip_keyword (b, "true"))
+    {
+      obj->type = PDF_BOOL;
+      obj->num = 1;
+      return obj;
+    }
+  if (skip_keyword (b, "false"))
+    {
+      obj->type = PDF_BOOL;
+      return obj;
+    }
+  if (skip_keyword (b, "null"))
+    {
+      obj->type = PDF_NULL;
+      return obj;
+    }
+ ERROR:
+  free_object (obj);
+  return NULL;
+}
+
+
+/**
+ * Look up a key in a dictionary.
+ *
+ * @param dict dictionary to search
+ * @param key name of the key (without '/')
+ * @return NULL if @a dict is not a dictionary or has no such key
+ */
+static struct PdfObject *
+dict_get (const struct PdfObject *dict,
+	  const char *key)
+{
+  unsigned int i;
+
+  if ( (NULL == dict) ||
+       (PDF_DICT != dict->type) )
+    return NULL;
+  for (i = 0; i + 1 < dict->num_items; i += 2)
+    if (0 == strcmp (dict->items[i]->str, key))
+      return dict->items[i + 1];
+  return NULL;
+}
+
+
+/**
+ * Check if a dictionary entry is a name with the given value.
+ *
+ * @param dict dictionary to check
+ * @param key name of the key
+ * @param value expected name
+ * @return 1 if the entry is the given name, 0 if not
+ */
+static int
+dict_has_name (const struct PdfObject *dict,
+	       const char *key,
+	       const char *value)
+{
+  const struct PdfObject *obj;
+
+  obj = dict_get (dict, key);
+  return ( (NULL != obj) &&
+	   (PDF_NAME == obj->type) &&
+	   (0 == strcmp (obj->str, value)) );
+}
+
+
+/**
+ * Find where to find an object in the cross reference sections.
+ *
+ * @param pc our context
+ * @param num number of the object
+ * @param entry set to the location of the object
+ * @return 0 on success, -1 if the object was not found
+ */
+static int
+find_object (struct PdfContext *pc,
+	     uint64_t num,
+	     struct XrefEntry *entry)
+{
+  const struct XrefSection *sec;
+  const struct XrefSubsection *sub;
+  const unsigned char *row;
+  unsigned char line[20];
+  uint64_t fields[3];
+  uint64_t skip;
+  unsigned int s;
+  unsigned int i;
+  unsigned int j;
+  unsigned int k;
+  unsigned int row_len;
+
+  for (s = 0; s < pc->num_sections; s++)
+    {
+      sec = &pc->sections[s];
+      for (i = 0; i < sec->num_subs; i++)
+	{
+	  sub = &sec->subs[i];
+	  if ( (num < sub->first) ||
+	       (num - sub->first >= sub->count) )
+	    continue;
+	  if (18 != read_at (pc,
+			     sub->offset + (num - sub->first) * sub->entry_len,
+			     line,
+			     18))
+	    return -1;
+	  if ('n' != line[17])
+	    break; /* free, maybe an older section knows it */
+	  entry->type = 1;
+	  entry->offset = 0;
+	  for (j = 0; j < 10; j++)
+	    if (isdigit (line[j]))
+	      entry->offset = entry->offset * 10 + (line[j] - '0');
+	  entry->index = 0;
+	  return 0;
+	}
+      if (NULL == sec->data)
+	continue;
+      row_len = sec->w[0] + sec->w[1] + sec->w[2];
+      skip = 0;
+      for (i = 0; i < sec->num_index; i++)
+	{
+	  if ( (num < sec->index[2 * i]) ||
+	       (num - sec->index[2 * i] >= sec->index[2 * i + 1]) )
+	    {
+	      skip += sec->index[2 * i + 1];
+	      continue;
+	    }
+	  skip += num - sec->index[2 * i];
+	  if ( (skip >= sec->data_len / row_len) )
+	    break;
+	  row = &sec->data[skip * row_len];
+	  for (j = 0; j < 3; j++)
+	    {
+	      fields[j] = 0;
+	      for (k = 0; k < sec->w[j]; k++)
+		fields[j] = (fields[j] << 8) + *row++;
+	    }
+	  if (0 == sec->w[0])
+	    fields[0] = 1; /* default type */
+	  if ( (1 != fields[0]) &&
+	       (2 != fields[0]) )
+	    break; /* free (or unknown), maybe an older section knows it */
+	  entry->type = (unsigned int) fields[0];
+	  entry->offset = fields[1];
+	  entry->index = fields[2];
+	  return 0;
+	}
+    }
+  return -1;
+}
+
+
+static struct PdfObject *
+load_object (struct PdfContext *pc,
+	     uint64_t num,
+	     unsigned char **stream,
+	     size_t *stream_len);
+
+
+/**
+ * Get the value of a dictionary entry as an integer, resolving
+ * indirect references.
+ *
+ * @param pc our context
+ * @param dict dictionary to search
+ * @param key name of the key
+ * @param ret set to the value
+ * @return 0 on success, -1 if there is no such (integer) entry
+ */
+static int
+dict_get_int (struct PdfContext *pc,
+	      const struct PdfObject *dict,
+	      const char *key,
+	      int64_t *ret)
+{
+  struct PdfObject *obj;
+  struct PdfObject *ind;
+
+  if (NULL == (obj = dict_get (dict, key)))
+    return -1;
+  if (PDF_NUMBER == obj->type)
+    {
+      *ret = obj->num;
+      return 0;
+    }
+  if ( (PDF_REF != obj->type) ||
+       (NULL == (ind = load_object (pc, obj->num, NULL, NULL))) )
+    return -1;
+  if (PDF_NUMBER != ind->type)
+    {
+      free_object (ind);
+      return -1;
+    }
+  *ret = ind->num;
+  free_object (ind);
+  return 0;
+}
+
+
+/**
+ * Undo the PNG predictor of a decoded stream.
+ *
+ * @param data decoded data (modified in place, rows become
+ *        one byte shorter)
+ * @param len number of bytes in @a data, updated
+ * @param columns number of bytes per row (without the predictor byte)
+ * @return 0 on success, -1 on error
+ */
+static int
+undo_png_predictor (unsigned char *data,
+		    size_t *len,
+		    size_t columns)
+{
+  unsigned char *prev;
+  unsigned char *out;
+  const unsigned char *in;
+  size_t rows;
+  size_t r;
+  size_t i;
+  unsigned char type;
+  int a;
+  int b;
+  int c;
+  int p;
+
+  if ( (0 == columns) ||
+       (columns > *len) )
+    return -1;
+  if (NULL == (prev = calloc (1, columns)))
+    return -1;
+  rows = *len / (columns + 1);
+  out = data;
+  for (r = 0; r < rows; r++)
+    {
+      in = &data[r * (columns + 1)];
+      /* the first output byte may overwrite the predictor type */
+      type = in[0];
+      for (i = 0; i < columns; i++)
+	{
+	  a = (i > 0) ? out[i - 1] : 0; /* left (bpp is 1) */
+	  b = prev[i];                  /* up */
+	  c = (i > 0) ? prev[i - 1] : 0; /* up left */
+	  switch (type)
+	    {
+	    case 0:
+	      out[i] = in[i + 1];
+	      break;
+	    case 1:
+	      out[i] = in[i + 1] + a;
+	      break;
+	    case 2:
+	      out[i] = in[i + 1] + b;
+	      break;
+	    case 3:
+	      out[i] = in[i + 1] + (a + b) / 2;
+	      break;
+	    case 4:
+	      p = a + b - c;
+	      if ( (abs (p - a) <= abs (p - b)) &&
+		   (abs (p - a) <= abs (p - c)) )
+		out[i] = in[i + 1] + a;
+	      else if (abs (p - b) <= abs (p - c))
+		out[i] = in[i + 1] + b;
+	      else
+		out[i] = in[i + 1] + c;
+	      break;
+	    default:
+	      free (prev);
+	      return -1;
+	    }
+	}
+      /* 'out' never overtakes 'in', so the row can be saved as is */
+      memcpy (prev, out, columns);
+      out += columns;
+    }
+  free (prev);
+  *len = rows * columns;
+  return 0;
+}
+
+
+/**
+ * Decode the data of a stream.  Only FlateDecode (with or without
+ * PNG predictors) is supported.
+ *
+ * @param dict dictionary of the stream
+ * @param raw encoded data
+ * @param raw_len number of bytes in @a raw
+ * @param len set to the number of bytes of the result
+ * @return NULL on error or unsupported filters, otherwise the
+ *         decoded data (to be freed by the caller)
+ */
+static unsigned char *
+decode_stream (const struct PdfObject *dict,
+	       const unsigned char *raw,
+	       size_t raw_len,
+	       size_t *len)
+{
+  const struct PdfObject *filter;
+  const struct PdfObject *parms;
+  const struct PdfObject *pred;
+  const struct PdfObject *cols;
+  unsigned char *out;
+  unsigned char *tmp;
+  size_t out_size;
+  z_stream strm;
+  int ret;
+
+  filter = dict_get (dict, "Filter");
+  parms = dict_get (dict, "DecodeParms");
+  if ( (NULL != filter) &&
+       (PDF_ARRAY == filter->type) )
+    {
+      if (0 == filter->num_items)
+	{
+	  filter = NULL;
+	}
+      else if (1 == filter->num_items)
+	{
+	  filter = filter->items[0];
+	  if ( (NULL != parms) &&
+	       (PDF_ARRAY == parms->type) )
+	    parms = (1 == parms->num_items) ? parms->items[0] : NULL;
+	}
+      else
+	return NULL; /* filter chains are not supported */
+    }
+  if (NULL == filter)
+    {
+      if (NULL == (out = malloc (raw_len + 1)))
+	return NULL;
+      memcpy (out, raw, raw_len);
+      out[raw_len] = '\0';
+      *len = raw_len;
+      return out;
+    }
+  if ( (PDF_NAME != filter->type) ||
+       ( (0 != strcmp (filter->str, "FlateDecode")) &&
+	 (0 != strcmp (filter->str, "Fl")) ) )
+    return NULL;
+  memset (&strm, 0, sizeof (strm));
+  if (Z_OK != inflateInit (&strm))
+    return NULL;
+  out_size = 4 * raw_len + 1024;
+  if (out_size > MAX_STREAM_SIZE)
+    out_size = MAX_STREAM_SIZE;
+  if (NULL == (out = malloc (out_size + 1)))
+    {
+      inflateEnd (&strm);
+      return NULL;
+    }
+  strm.next_in = (Bytef *) raw;
+  strm.avail_in = raw_len;
+  strm.next_out = out;
+  strm.avail_out = out_size;
+  while (1)
+    {
+      ret = inflate (&strm, Z_SYNC_FLUSH);
+      if (Z_STREAM_END == ret)
+	break;
+      if ( (Z_OK != ret) &&
+	   (Z_BUF_ERROR != ret) )
+	break; /* corrupt data; keep what we have */
+      if (0 != strm.avail_out)
+	break; /* input exhausted (possibly truncated stream) */
+      if (out_size >= MAX_STREAM_SIZE)
+	break;
+      out_size *= 2;
+      if (out_size > MAX_STREAM_SIZE)
+	out_size = MAX_STREAM_SIZE;
+      if (NULL == (tmp = realloc (out, out_size + 1)))
+	break;
+      out = tmp;
+      strm.next_out = &out[strm.total_out];
+      strm.avail_out = out_size - strm.total_out;
+    }
+  *len = strm.total_out;
+  inflateEnd (&strm);
+  pred = dict_get (parms, "Predictor");
+  if ( (NULL != pred) &&
+       (PDF_NUMBER == pred->type) &&
+       (pred->num >= 10) )
+    {
+      cols = dict_get (parms, "Columns");
+      if ( (0 != undo_png_predictor (out,
+				     len,
+				     ( (NULL != cols) &&
+				       (PDF_NUMBER == cols->type) &&
+				       (cols->num > 0) )
+				     ? (size_t) cols->num : 1)) )
+	{
+	  free (out);
+	  return NULL;
+	}
+    }
+  else if ( (NULL != pred) &&
+	    (PDF_NUMBER == pred->type) &&
+	    (pred->num > 1) )
+    {
+      /* TIFF predictor is not supported */
+      free (out);
+      return NULL;
+    }
+  out[*len] = '\0';
+  return out;
+}
+
+
+/**
+ * Parse an object at the given offset in the file, including the
+ * 'NUM GEN obj' header.  If the object is a stream and @a stream
+ * is not NULL, also load and decode the stream data.
+ *
+ * @param pc our context
+ * @param offset offset of the object in the file
+ * @param num expected object number, #ANY_OBJECT for any,
+ *        #NO_HEADER if there is no object header
+ * @param stream set to the decoded stream data (0-terminated),
+ *        NULL if the object is not a stream or the data could
+ *        not be decoded; can be NULL
+ * @param stream_len set to the number of bytes in @a stream
+ * @return NULL on error
+ */
+static struct PdfObject *
+parse_object_at (struct PdfContext *pc,
+		 uint64_t offset,
+		 uint64_t num,
+		 unsigned char **stream,
+		 size_t *stream_len)
+{
+  struct PdfObject *obj;
+  struct Buffer b;
+  unsigned char *buf;
+  unsigned char *raw;
+  size_t window;
+  ssize_t got;
+  uint64_t onum;
+  uint64_t ogen;
+  int64_t length;
+
+  if (NULL != stream)
+    *stream = NULL;
+  window = OBJECT_WINDOW;
+  while (1)
+    {
+      if (NULL == (buf = malloc (window)))
+	return NULL;
+      if (-1 == (got = read_at (pc, offset, buf, window)))
+	{
+	  free (buf);
+	  return NULL;
+	}
+      memset (&b, 0, sizeof (b));
+      b.data = buf;
+      b.size = got;
+      skip_space (&b);
+      obj = NULL;
+      if (NO_HEADER == num)
+	obj = parse_object (&b, 0);
+      else if ( (0 == parse_uint (&b, &onum)) &&
+		( (ANY_OBJECT == num) || (onum == num) ) &&
+		(skip_space (&b), 0 == parse_uint (&b, &ogen)) &&
+		(skip_keyword (&b, "obj")) )
+	obj = parse_object (&b, 0);
+      if ( (NULL != obj) ||
+	   (0 == b.truncated) ||
+	   ((size_t) got < window) ||
+	   (window >= MAX_OBJECT_SIZE) )
+	break;
+      /* object did not fit, try again with more data */
+      free (buf);
+      window *= 16;
+    }
+  if ( (NULL == obj) ||
+       (NULL == stream) ||
+       (PDF_DICT != obj->type) ||
+       (! skip_keyword (&b, "stream")) )
+    {
+      free (buf);
+      return obj;
+    }
+  /* the keyword is followed by CRLF or LF (or, wrongly, by CR) */
+  if ( (b.pos < b.size) &&
+       ('\r' == b.data[b.pos]) )
+    b.pos++;
+  if ( (b.pos < b.size) &&
+       ('\n' == b.data[b.pos]) )
+    b.pos++;
+  offset += b.pos;
+  free (buf);
+  pc->depth++;
+  if ( (0 != dict_get_int (pc, obj, "Length", &length)) ||
+       (length < 0) ||
+       (length > MAX_STREAM_SIZE) ||
+       (NULL == (raw = malloc (length + 1))) )
+    {
+      pc->depth--;
+      return obj;
+    }
+  pc->depth--;
+  if (length != read_at (pc, offset, raw, length))
+    {
+      free (raw);
+      return obj;
+    }
+  *stream = decode_stream (obj, raw, length, stream_len);
+  free (raw);
+  return obj;
+}
+
+
+/**
+ * Make sure the given object stream is loaded into the cache.
+ *
+ * @param pc our context
+ * @param num number of the object stream
+ * @return 0 on success, -1 on error
+ */
+static int
+load_object_stream (struct PdfContext *pc,
+		    uint64_t num)
+{
+  struct XrefEntry entry;
+  struct PdfObject *dict;
+  unsigned char *data;
+  size_t len;
+  int64_t n;
+  int64_t first;
+
+  if ( (NULL != pc->objstm) &&
+       (num == pc->objstm_num) )
+    return 0;
+  if ( (0 != find_object (pc, num, &entry)) ||
+       (1 != entry.type) )
+    return -1; /* object streams must not be in object streams */
+  if (NULL == (dict = parse_object_at (pc, entry.offset, num, &data, &len)))
+    return -1;
+  if ( (NULL == data) ||
+       (0 != dict_get_int (pc, dict, "N", &n)) ||
+       (0 != dict_get_int (pc, dict, "First", &first)) ||
+       (n < 0) ||
+       (first < 0) ||
+       ((uint64_t) first > len) )
+    {
+      free (data);
+      free_object (dict);
+      return -1;
+    }
+  free_object (dict);
+  free (pc->objstm);
+  pc->objstm = data;
+  pc->objstm_len = len;
+  pc->objstm_num = num;
+  pc->objstm_n = n;
+  pc->objstm_first = first;
+  return 0;
+}
+
+
+/**
+ * Load an indirect object.
+ *
+ * @param pc our context
+ * @param num number of the object
+ * @param stream set to the decoded stream data (if the object is
+ *        a stream), can be NULL
+ * @param stream_len set to the number of bytes in @a stream
+ * @return NULL on error
+ */
+static struct PdfObject *
+load_object (struct PdfContext *pc,
+	     uint64_t num,
+	     unsigned char **stream,
+	     size_t *stream_len)
+{
+  struct XrefEntry entry;
+  struct PdfObject *obj;
+  struct Buffer b;
+  uint64_t onum;
+  uint64_t off;
+  uint64_t i;
+
+  if (NULL != stream)
+    *stream = NULL;
+  if ( (pc->depth >= MAX_DEPTH) ||
+       (0 != find_object (pc, num, &entry)) )
+    return NULL;
+  if (1 == entry.type)
+    return parse_object_at (pc, entry.offset, num, stream, stream_len);
+  /* in an object stream, find its offset in the stream's header */
+  pc->depth++;
+  if ( (0 != load_object_stream (pc, entry.offset)) ||
+       (entry.index >= pc->objstm_n) )
+    {
+      pc->depth--;
+      return NULL;
+    }
+  pc->depth--;
+  memset (&b, 0, sizeof (b));
+  b.data = pc->objstm;
+  b.size = pc->objstm_first;
+  onum = 0;
+  off = 0;
+  for (i = 0; i <= entry.index; i++)
+    {
+      skip_space (&b);
+      if (0 != parse_uint (&b, &onum))
+	return NULL;
+      skip_space (&b);
+      if (0 != parse_uint (&b, &off))
+	return NULL;
+    }
+  if ( (onum != num) ||
+       (off >= pc->objstm_len - pc->objstm_first) )
+    return NULL;
+  b.size = pc->objstm_len;
+  b.pos = pc->objstm_first + off;
+  obj = parse_object (&b, 0);
+  return obj;
+}
+
+
+/**
+ * Parse a cross reference table (the 'xref' keyword has been
+ * consumed) and its trailer.
+ *
+ * @param pc our context
+ * @param sec section to initialize
+ * @param offset offset of the first subsection in the file
+ * @return the trailer dictionary, NULL on error
+ */
+static struct PdfObject *
+parse_xref_table (struct PdfContext *pc,
+		  struct XrefSection *sec,
+		  uint64_t offset)
+{
+  struct XrefSubsection *subs;
+  struct Buffer b;
+  unsigned char buf[64];
+  ssize_t got;
+  uint64_t first;
+  uint64_t count;
+  unsigned int i;
+
+  while (1)
+    {
+      if (0 >= (got = read_at (pc, offset, buf, sizeof (buf))))
+	return NULL;
+      memset (&b, 0, sizeof (b));
+      b.data = buf;
+      b.size = got;
+      skip_space (&b);
+      if (b.pos + strlen ("trailer") <= b.size &&
+	  (0 == memcmp (&buf[b.pos], "trailer", strlen ("trailer"))) )
+	break;
+      if ( (0 != parse_uint (&b, &first)) ||
+	   (skip_space (&b), 0 != parse_uint (&b, &count)) )
+	return NULL;
+      /* skip to the first entry, which starts with a digit */
+      while ( (b.pos < b.size) &&
+	      (! isdigit (buf[b.pos])) )
+	b.pos++;
+      if ( (count > 0) &&
+	   (b.pos + 20 > b.size) )
+	return NULL;
+      if (sec->num_subs >= MAX_ITEMS)
+	return NULL;
+      subs = realloc (sec->subs,
+		      (sec->num_subs + 1) * sizeof (struct XrefSubsection));
+      if (NULL == subs)
+	return NULL;
+      sec->subs = subs;
+      subs = &sec->subs[sec->num_subs++];
+      subs->offset = offset + b.pos;
+      subs->first = first;
+      subs->count = count;
+      /* entries are 'nnnnnnnnnn ggggg n' and a two byte line end,
+	 but some writers only use a one byte line end */
+      subs->entry_len = 18;
+      for (i = 18; (i < 20) && (b.pos + i < b.size); i++)
+	if (is_space (buf[b.pos + i]))
+	  subs->entry_len++;
+      if (count > (pc->fsize - subs->offset) / subs->entry_len)
+	return NULL;
+      offset = subs->offset + count * subs->entry_len;
+    }
+  return parse_object_at (pc,
+			  offset + b.pos + strlen ("trailer"),
+			  NO_HEADER,
+			  NULL,
+			  NULL);
+}
+
+
+/**
+ * Load a cross reference section (table or stream) and add it to
+ * the list of sections.
+ *
+ * @param pc our context
+ * @param offset offset of the section in the file
+ * @return the trailer dictionary of the section, NULL on error
+ */
+static struct PdfObject *
+load_xref_section (struct PdfContext *pc,
+		   uint64_t offset)
+{
+  struct XrefSection *sec;
+  struct PdfObject *trailer;
+  struct PdfObject *w;
+  struct PdfObject *index;
+  unsigned char buf[16];
+  ssize_t got;
+  int64_t size;
+  unsigned int i;
+
+  if (pc->num_sections >= MAX_SECTIONS)
+    return NULL;
+  sec = &pc->sections[pc->num_sections];
+  memset (sec, 0, sizeof (struct XrefSection));
+  if (0 >= (got = read_at (pc, offset, buf, sizeof (buf))))
+    return NULL;
+  i = 0;
+  while ( (i < got) && (is_space (buf[i])) )
+    i++;
+  if ( (i + 4 <= got) &&
+       (0 == memcmp (&buf[i], "xref", 4)) )
+    {
+      if (NULL == (trailer = parse_xref_table (pc, sec, offset + i + 4)))
+	{
+	  free (sec->subs);
+	  return NULL;
+	}
+      pc->num_sections++;
+      return trailer;
+    }
+  /* cross reference stream */
+  trailer = parse_object_at (pc,
+			     offset,
+			     ANY_OBJECT,
+			     &sec->data,
+			     &sec->data_len);
+  if ( (NULL == trailer) ||
+       (NULL == sec->data) ||
+       (! dict_has_name (trailer, "Type", "XRef")) ||
+       (NULL == (w = dict_get (trailer, "W"))) ||
+       (PDF_ARRAY != w->type) ||
+       (3 != w->num_items) ||
+       (0 != dict_get_int (pc, trailer, "Size", &size)) ||
+       (size < 0) )
+    goto ERROR;
+  for (i = 0; i < 3; i++)
+    {
+      if ( (PDF_NUMBER != w->items[i]->type) ||
+	   (w->items[i]->num < 0) ||
+	   (w->items[i]->num > 8) )
+	goto ERROR;
+      sec->w[i] = (unsigned int) w->items[i]->num;
+    }
+  if (0 == sec->w[0] + sec->w[1] + sec->w[2])
+    goto ERROR;
+  index = dict_get (trailer, "Index");
+  if ( (NULL != index) &&
+       (PDF_ARRAY == index->type) &&
+       (0 == index->num_items % 2) &&
+       (0 != index->num_items) )
+    {
+      sec->num_index = index->num_items / 2;
+      if (NULL == (sec->index = malloc (sizeof (uint64_t) *
+					index->num_items)))
+	goto ERROR;
+      for (i = 0; i < index->num_items; i++)
+	{
+	  if ( (PDF_NUMBER != index->items[i]->type) ||
+	       (index->items[i]->num < 0) )
+	    goto ERROR;
+	  sec->index[i] = (uint64_t) index->items[i]->num;
+	}
+    }
+  else
+    {
+      sec->num_index = 1;
+      if (NULL == (sec->index = malloc (2 * sizeof (uint64_t))))
+	goto ERROR;
+      sec->index[0] = 0;
+      sec->index[1] = (uint64_t) size;
+    }
+  pc->num_sections++;
+  return trailer;
+ ERROR:
+  free (sec->data);
+  free (sec->index);
+  free_object (trailer);
+  return NULL;
+}
+
+
+/**
+ * Find the offset of the last cross reference section via
+ * 'startxref' at the end of the file.
+ *
+ * @param pc our context
+ * @param offset set to the offset of the section
+ * @return 0 on success, -1 on error
+ */
+static int
+find_startxref (struct PdfContext *pc,
+		uint64_t *offset)
+{
+  unsigned char buf[TAIL_SIZE + 1];
+  struct Buffer b;
+  uint64_t start;
+  ssize_t got;
+  ssize_t i;
+
+  start = (pc->fsize > TAIL_SIZE) ? pc->fsize - TAIL_SIZE : 0;
+  if (0 >= (got = read_at (pc, start, buf, TAIL_SIZE)))
+    return -1;
+  for (i = got - strlen ("startxref"); i >= 0; i--)
+    if (0 == memcmp (&buf[i], "startxref", strlen ("startxref")))
+      break;
+  if (i < 0)
+    return -1;
+  memset (&b, 0, sizeof (b));
+  b.data = buf;
+  b.size = got;
+  b.pos = i + strlen ("startxref");
+  skip_space (&b);
+  if ( (0 != parse_uint (&b, offset)) ||
+       (*offset >= pc->fsize) )
+    return -1;
+  return 0;
+}
+
+
+/**
+ * Convert a PDF text string (PDFDocEncoding, UTF-16BE or UTF-8,
+ * depending on the byte order mark) to UTF-8.
+ *
+ * @param str string to convert
+ * @param len number of bytes in @a str
+ * @return NULL on error
+ */
+static char *
+text_to_utf8 (const char *str,
+	      size_t len)
+{
+  /* PDFDocEncoding differs from Latin-1 in 0x18-0x1F and 0x80-0xA0 */
+  static const uint16_t low[8] = {
+    0x02D8, 0x02C7, 0x02C6, 0x02D9, 0x02DD, 0x02DB, 0x02DA, 0x02DC
+  };
+  static const uint16_t high[33] = {
+    0x2022, 0x2020, 0x2021, 0x2026, 0x2014, 0x2013, 0x0192, 0x2044,
+    0x2039, 0x203A, 0x2212, 0x2030, 0x201E, 0x201C, 0x201D, 0x2018,
+    0x2019, 0x201A, 0x2122, 0xFB01, 0xFB02, 0x0141, 0x0152, 0x0160,
+    0x0178, 0x017D, 0x0131, 0x0142, 0x0153, 0x0161, 0x017E, 0xFFFD,
+    0x20AC
+  };
+  const unsigned char *u = (const unsigned char *) str;
+  char *utf16;
+  char *ret;
+  uint16_t c;
+  size_t i;
+
+  if ( (len >= 2) &&
+       (0xFE == u[0]) &&
+       (0xFF == u[1]) )
+    return EXTRACTOR_common_convert_to_utf8 (&str[2],
+					     len - 2,
+					     "UTF-16BE");
+  if ( (len >= 3) &&
+       (0xEF == u[0]) &&
+       (0xBB == u[1]) &&
+       (0xBF == u[2]) )
+    return EXTRACTOR_common_convert_to_utf8 (&str[3],
+					     len - 3,
+					     "UTF-8");
+  if (NULL == (utf16 = malloc (2 * len + 1)))
+    return NULL;
+  for (i = 0; i < len; i++)
+    {
+      if ( (u[i] >= 0x18) && (u[i] <= 0x1F) )
+	c = low[u[i] - 0x18];
+      else if ( (u[i] >= 0x80) && (u[i] <= 0xA0) )
+	c = high[u[i] - 0x80];
+      else
+	c = u[i];
+      utf16[2 * i] = (char) (c >> 8);
+      utf16[2 * i + 1] = (char) (c & 0xFF);
+    }
+  ret = EXTRACTOR_common_convert_to_utf8 (utf16,
+					  2 * len,
+					  "UTF-16BE");
+  free (utf16);
+  return ret;
+}
+
+
+/**
+ * Convert a PDF date ('D:YYYYMMDDHHmmSSOHH'mm'', all but the year
+ * optional) to 'YYYY-MM-DD HH:mm:SS+HH:mm'.
+ *
+ * @param date date to convert
+ * @return NULL if @a date is not in PDF date format
+ */
+static char *
+convert_date (const char *date)
+{
+  static const char *seps = "-- ::";
+  char ret[32];
+  size_t len;
+  size_t pos;
+  unsigned int i;
+
+  if (0 == strncmp (date, "D:", 2))
+    date += 2;
+  for (len = 0; isdigit ((unsigned char) date[len]); len++)
+    ;
+  if ( (len < 4) ||
+       (len > 14) ||
+       (0 != len % 2) )
+    return NULL;
+  memcpy (ret, date, 4);
+  pos = 4;
+  for (i = 4; i < len; i += 2)
+    {
+      ret[pos++] = seps[(i - 4) / 2];
+      ret[pos++] = date[i];
+      ret[pos++] = date[i + 1];
+    }
+  date += len;
+  if ( ('Z' == date[0]) &&
+       (len > 8) )
+    ret[pos++] = 'Z';
+  if ( ( ('+' == date[0]) || ('-' == date[0]) ) &&
+       (len > 8) &&
+       (isdigit ((unsigned char) date[1])) &&
+       (isdigit ((unsigned char) date[2])) )
+    {
+      ret[pos++] = date[0];
+      ret[pos++] = date[1];
+      ret[pos++] = date[2];
+      ret[pos++] = ':';
+      if ( ('\'' == date[3]) &&
+	   (isdigit ((unsigned char) date[4])) &&
+	   (isdigit ((unsigned char) date[5])) )
+	{
+	  ret[pos++] = date[4];
+	  ret[pos++] = date[5];
+	}
+      else
+	{
+	  ret[pos++] = '0';
+	  ret[pos++] = '0';
+	}
+    }
+  ret[pos] = '\0';
+  return strdup (ret);
+}
+
+
+/**
+ * Entry in the mapping from PDF keys to LE types.
  */
 struct Matches
 {
   /**
-   * Key in the Pdfian control file.
+   * Key in the '/Info' dictionary or XMP property.
    */
   const char *text;
 
@@ -52,11 +1853,9 @@ struct Matches
 
 
 /**
- * Map from pdf-control entries to LE types.
- *
- * See output of 'pdfinfo'.
+ * Map from '/Info' entries to LE types.
  */
-static struct Matches tmap[] = {
+static const struct Matches tmap[] = {
   {"Title",        EXTRACTOR_METATYPE_TITLE},
   {"Subject",      EXTRACTOR_METATYPE_SUBJECT},
   {"Keywords",     EXTRACTOR_METATYPE_KEYWORDS},
@@ -65,62 +1864,570 @@ static struct Matches tmap[] = {
   {"Producer",     EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE},
   {"CreationDate", EXTRACTOR_METATYPE_CREATION_DATE},
   {"ModDate",      EXTRACTOR_METATYPE_MODIFICATION_DATE},
-  {"PDF version",  EXTRACTOR_METATYPE_ENCODER_VERSION},
-  {"Pages",        EXTRACTOR_METATYPE_PAGE_COUNT},
   {NULL, 0}
 };
 
 
 /**
- * Process the "stdout" file from pdfinfo.
+ * Map from XMP properties to LE types.  For 'dc:creator', we
+ * report all entries, for the others only the first.
+ */
+static const struct Matches xmap[] = {
+  {"dc:title",        EXTRACTOR_METATYPE_TITLE},
+  {"dc:description",  EXTRACTOR_METATYPE_SUBJECT},
+  {"pdf:Keywords",    EXTRACTOR_METATYPE_KEYWORDS},
+  {"dc:creator",      EXTRACTOR_METATYPE_AUTHOR_NAME},
+  {"xmp:CreatorTool", EXTRACTOR_METATYPE_CREATOR},
+  {"pdf:Producer",    EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE},
+  {"xmp:CreateDate",  EXTRACTOR_METATYPE_CREATION_DATE},
+  {"xmp:ModifyDate",  EXTRACTOR_METATYPE_MODIFICATION_DATE},
+  {NULL, 0}
+};
+
+
+/**
+ * Closure for #report().
+ */
+struct Reporter
+{
+  /**
+   * Extraction context.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Types we reported from '/Info'.
+   */
+  enum EXTRACTOR_MetaType reported[8];
+
+  /**
+   * Number of entries in @e reported.
+   */
+  unsigned int num_reported;
+
+  /**
+   * Set to 1 once the application asked us to stop.
+   */
+  int stop;
+};
+
+
+/**
+ * Report a meta data item.
+ *
+ * @param r reporting context
+ * @param type type of the item
+ * @param value 0-terminated UTF-8 value, trailing whitespace
+ *        is removed (and leading whitespace is not reported)
+ * @return 0 to continue, 1 to stop
+ */
+static int
+report (struct Reporter *r,
+	enum EXTRACTOR_MetaType type,
+	char *value)
+{
+  size_t len;
+
+  while (isspace ((unsigned char) value[0]))
+    value++;
+  len = strlen (value);
+  while ( (len > 0) &&
+	  (isspace ((unsigned char) value[len - 1])) )
+    len--;
+  value[len] = '\0';
+  if (0 == len)
+    return 0;
+  if (0 != r->ec->proc (r->ec->cls,
+			"pdf",
+			type,
+			EXTRACTOR_METAFORMAT_UTF8,
+			"text/plain",
+			value,
+			len + 1))
+    r->stop = 1;
+  return r->stop;
+}
+
+
+/**
+ * Report the entries of the '/Info' dictionary.
  *
- * @param fout stdout of pdfinfo
- * @param proc function to call with meta data
- * @param proc_cls closure for @e proc
+ * @param r reporting context
+ * @param info the dictionary
  */
 static void
-process_stdout (FILE *fout,
-		EXTRACTOR_MetaDataProcessor proc,
-		void *proc_cls)
+report_info (struct Reporter *r,
+	     const struct PdfObject *info)
 {
+  const struct PdfObject *value;
+  char *utf8;
+  char *date;
   unsigned int i;
-  char line[1025];
-  const char *psuffix;
-  const char *colon;
-
-  while (! feof (fout))
-    {
-      if (NULL == fgets (line, sizeof (line) - 1, fout))
-        break;
-      if (0 == strlen (line))
-        continue;
-      if ('\n' == line[strlen(line)-1])
-        line[strlen(line)-1] = '\0';
-      colon = strchr (line, (int) ':');
-      if (NULL == colon)
-        break;
-      psuffix = colon + 1;
-      while (isblank ((unsigned char) psuffix[0]))
-        psuffix++;
-      if (0 == strlen (psuffix))
-        continue;
-      for (i = 0; NULL != tmap[i].text; i++)
-        {
-          if (0 != strncasecmp (line,
-                                tmap[i].text,
-                                colon - line))
-	    continue;
-	  if (0 != proc (proc_cls,
-			 "pdf",
-			 tmap[i].type,
-			 EXTRACTOR_METAFORMAT_UTF8,
-			 "text/plain",
-			 psuffix,
-			 strlen(psuffix) + 1))
-            return;
+
+  for (i = 0; NULL != tmap[i].text; i++)
+    {
+      value = dict_get (info, tmap[i].text);
+      if ( (NULL == value) ||
+	   (PDF_STRING != value->type) ||
+	   (NULL == (utf8 = text_to_utf8 (value->str, value->str_len))) )
+	continue;
+      if ( ( (EXTRACTOR_METATYPE_CREATION_DATE == tmap[i].type) ||
+	     (EXTRACTOR_METATYPE_MODIFICATION_DATE == tmap[i].type) ) &&
+	   (NULL != (date = convert_date (utf8))) )
+	{
+	  free (utf8);
+	  utf8 = date;
+	}
+      /* remember what we got, so we skip it in the XMP packet */
+      if ( (strlen (utf8) > 0) &&
+	   (r->num_reported < sizeof (r->reported) / sizeof (r->reported[0])) )
+	r->reported[r->num_reported++] = tmap[i].type;
+      report (r, tmap[i].type, utf8);
+      free (utf8);
+      if (r->stop)
+	return;
+    }
+}
+
+
+/**
+ * Decode XML entities.
+ *
+ * @param start start of the text
+ * @param len number of bytes in @a start
+ * @return decoded 0-terminated text, NULL on error
+ */
+static char *
+decode_xml (const char *start,
+	    size_t len)
+{
+  static const struct
+  {
+    const char *name;
+    char c;
+  } entities[] = {
+    { "&lt;", '<' },
+    { "&gt;", '>' },
+    { "&amp;", '&' },
+    { "&quot;", '"' },
+    { "&apos;", '\'' },
+    { NULL, 0 }
+  };
+  char *ret;
+  char *end;
+  size_t pos;
+  size_t i;
+  unsigned long cp;
+  unsigned int j;
+
+  if (NULL == (ret = malloc (len + 1)))
+    return NULL;
+  pos = 0;
+  i = 0;
+  while (i < len)
+    {
+      if ('&' != start[i])
+	{
+	  ret[pos++] = start[i++];
+	  continue;
+	}
+      for (j = 0; NULL != entities[j].name; j++)
+	if ( (i + strlen (entities[j].name) <= len) &&
+	     (0 == strncmp (&start[i],
+			    entities[j].name,
+			    strlen (entities[j].name))) )
+	  break;
+      if (NULL != entities[j].name)
+	{
+	  ret[pos++] = entities[j].c;
+	  i += strlen (entities[j].name);
+	  continue;
+	}
+      if ( (i + 3 < len) &&
+	   ('#' == start[i + 1]) )
+	{
+	  /* character reference; never longer than the UTF-8 encoding */
+	  if ( ('x' == start[i + 2]) || ('X' == start[i + 2]) )
+	    cp = strtoul (&start[i + 3], &end, 16);
+	  else
+	    cp = strtoul (&start[i + 2], &end, 10);
+	  if ( (end < &start[len]) &&
+	       (';' == *end) &&
+	       (cp > 0) &&
+	       (cp < 0x110000) )
+	    {
+	      if (cp < 0x80)
+		{
+		  ret[pos++] = (char) cp;
+		}
+	      else if (cp < 0x800)
+		{
+		  ret[pos++] = (char) (0xC0 | (cp >> 6));
+		  ret[pos++] = (char) (0x80 | (cp & 0x3F));
+		}
+	      else if (cp < 0x10000)
+		{
+		  ret[pos++] = (char) (0xE0 | (cp >> 12));
+		  ret[pos++] = (char) (0x80 | ((cp >> 6) & 0x3F));
+		  ret[pos++] = (char) (0x80 | (cp & 0x3F));
+		}
+	      else
+		{
+		  ret[pos++] = (char) (0xF0 | (cp >> 18));
+		  ret[pos++] = (char) (0x80 | ((cp >> 12) & 0x3F));
+		  ret[pos++] = (char) (0x80 | ((cp >> 6) & 0x3F));
+		  ret[pos++] = (char) (0x80 | (cp & 0x3F));
+		}
+	      i = end + 1 - start;
+	      continue;
+	    }
+	}
+      ret[pos++] = start[i++];
+    }
+  ret[pos] = '\0';
+  return ret;
+}
+
+
+/**
+ * Find a string in a buffer that is not necessarily 0-terminated.
+ *
+ * @param start where to start searching
+ * @param end end of the buffer
+ * @param needle 0-terminated string to search for
+ * @return NULL if @a needle was not found
+ */
+static const char *
+find_str (const char *start,
+	  const char *end,
+	  const char *needle)
+{
+  size_t len = strlen (needle);
+
+  while (start + len <= end)
+    {
+      if (NULL == (start = memchr (start, needle[0], end - start - len + 1)))
+	return NULL;
+      if (0 == memcmp (start, needle, len))
+	return start;
+      start++;
+    }
+  return NULL;
+}
+
+
+/**
+ * Report an XMP value.
+ *
+ * @param r reporting context
+ * @param type type of the value
+ * @param start start of the (XML-encoded) value
+ * @param len number of bytes in @a start
+ * @return 0 to continue, 1 to stop
+ */
+static int
+report_xmp_value (struct Reporter *r,
+		  enum EXTRACTOR_MetaType type,
+		  const char *start,
+		  size_t len)
+{
+  char *value;
+
+  if (NULL == (value = decode_xml (start, len)))
+    return 0;
+  /* XMP dates are ISO 8601, use a blank like for '/Info' dates */
+  if ( ( (EXTRACTOR_METATYPE_CREATION_DATE == type) ||
+	 (EXTRACTOR_METATYPE_MODIFICATION_DATE == type) ) &&
+       (strlen (value) > 10) &&
+       ('T' == value[10]) )
+    value[10] = ' ';
+  report (r, type, value);
+  free (value);
+  return r->stop;
+}
+
+
+/**
+ * Find and report an XMP property, either given as element
+ * (possibly with an 'rdf:Alt', 'rdf:Bag' or 'rdf:Seq' of 'rdf:li'
+ * values) or as attribute of 'rdf:Description'.
+ *
+ * @param r reporting context
+ * @param xmp the XMP packet
+ * @param xmp_len number of bytes in @a xmp
+ * @param m property to look for and its type
+ */
+static void
+report_xmp_property (struct Reporter *r,
+		     const char *xmp,
+		     size_t xmp_len,
+		     const struct Matches *m)
+{
+  const char *end = &xmp[xmp_len];
+  const char *pos;
+  const char *val;
+  const char *val_end;
+  const char *li;
+  char tag[64];
+  size_t tlen;
+  int all;
+
+  all = (EXTRACTOR_METATYPE_AUTHOR_NAME == m->type);
+  tlen = snprintf (tag, sizeof (tag), "<%s", m->text);
+  pos = xmp;
+  while (NULL != (pos = find_str (pos, end, tag)))
+    {
+      pos += tlen;
+      if ( (pos < end) &&
+	   ('>' == *pos || isspace ((unsigned char) *pos)) )
+	break;
+    }
+  if ( (NULL != pos) &&
+       (NULL != (val = memchr (pos, '>', end - pos))) &&
+       ('/' != val[-1]) )
+    {
+      /* element form */
+      val++;
+      snprintf (tag, sizeof (tag), "</%s>", m->text);
+      if (NULL == (val_end = find_str (val, end, tag)))
+	return;
+      if (NULL == find_str (val, val_end, "<rdf:li"))
+	{
+	  report_xmp_value (r, m->type, val, val_end - val);
+	  return;
+	}
+      li = val;
+      while (NULL != (li = find_str (li, val_end, "<rdf:li")))
+	{
+	  if (NULL == (val = memchr (li, '>', val_end - li)))
+	    return;
+	  val++;
+	  if ('/' == val[-2])
+	    {
+	      li = val;
+	      continue; /* empty element */
+	    }
+	  if (NULL == (li = find_str (val, val_end, "</rdf:li>")))
+	    return;
+	  if ( (0 != report_xmp_value (r, m->type, val, li - val)) ||
+	       (! all) )
+	    return;
+	}
+      return;
+    }
+  /* attribute form */
+  tlen = snprintf (tag, sizeof (tag), "%s=", m->text);
+  pos = xmp;
+  while (NULL != (pos = find_str (pos, end, tag)))
+    {
+      if ( (pos > xmp) &&
+	   (isspace ((unsigned char) pos[-1])) &&
+	   (pos + tlen < end) &&
+	   ( ('"' == pos[tlen]) || ('\'' == pos[tlen]) ) )
+	break;
+      pos += tlen;
+    }
+  if (NULL == pos)
+    return;
+  val = pos + tlen + 1;
+  if (NULL == (val_end = memchr (val, pos[tlen], end - val)))
+    return;
+  report_xmp_value (r, m->type, val, val_end - val);
+}
+
+
+/**
+ * Report the properties of an XMP packet that we did not
+ * already get from the '/Info' dictionary.
+ *
+ * @param r reporting context
+ * @param xmp the XMP packet
+ * @param xmp_len number of bytes in @a xmp
+ */
+static void
+report_xmp (struct Reporter *r,
+	    const char *xmp,
+	    size_t xmp_len)
+{
+  unsigned int i;
+  unsigned int j;
+
+  for (i = 0; (0 == r->stop) && (NULL != xmap[i].text); i++)
+    {
+      for (j = 0; j < r->num_reported; j++)
+	if (r->reported[j] == xmap[i].type)
+	  break;
+      if ( (j < r->num_reported) ||
+	   (0 == r->ec->wants (r->ec->cls, xmap[i].type)) )
+	continue;
+      report_xmp_property (r, xmp, xmp_len, &xmap[i]);
+    }
+}
+
+
+/**
+ * Load the object a dictionary entry refers to, or copy the
+ * entry if it is a direct object.
+ *
+ * @param pc our context
+ * @param dict dictionary to search
+ * @param key name of the key
+ * @param stream set to the decoded stream data (if the object is
+ *        an indirect stream), can be NULL
+ * @param stream_len set to the number of bytes in @a stream
+ * @return NULL if there is no such entry, or if it is neither
+ *         an indirect object nor a dictionary; to be freed with
+ *         #free_object()
+ */
+static struct PdfObject *
+load_dict_entry (struct PdfContext *pc,
+		 struct PdfObject *dict,
+		 const char *key,
+		 unsigned char **stream,
+		 size_t *stream_len)
+{
+  struct PdfObject *obj;
+  unsigned int i;
+
+  if (NULL != stream)
+    *stream = NULL;
+  if (NULL == dict)
+    return NULL;
+  for (i = 0; i + 1 < dict->num_items; i += 2)
+    {
+      if (0 != strcmp (dict->items[i]->str, key))
+	continue;
+      obj = dict->items[i + 1];
+      if (PDF_REF == obj->type)
+	return load_object (pc, obj->num, stream, stream_len);
+      if (PDF_DICT != obj->type)
+	return NULL;
+      /* take it out of the parent, which we do not need anymore */
+      dict->items[i + 1] = NULL;
+      return obj;
+    }
+  return NULL;
+}
+
+
+/**
+ * Follow the chain of cross reference sections, starting at
+ * 'startxref', and find the newest trailer with a '/Root'.
+ *
+ * @param pc our context
+ * @return NULL if the file has no valid trailer
+ */
+static struct PdfObject *
+load_xref (struct PdfContext *pc)
+{
+  struct PdfObject *trailer;
+  struct PdfObject *ret;
+  struct PdfObject *stm;
+  uint64_t visited[MAX_SECTIONS];
+  unsigned int num_visited;
+  unsigned int i;
+  uint64_t offset;
+  int64_t next;
+
+  if (0 != find_startxref (pc, &offset))
+    return NULL;
+  ret = NULL;
+  num_visited = 0;
+  while (num_visited < MAX_SECTIONS)
+    {
+      for (i = 0; i < num_visited; i++)
+	if (visited[i] == offset)
 	  break;
+      if (i < num_visited)
+	break; /* loop */
+      visited[num_visited++] = offset;
+      if (NULL == (trailer = load_xref_section (pc, offset)))
+	break;
+      /* hybrid files have the objects of newer PDF versions in an
+	 additional cross reference stream */
+      if ( (0 == dict_get_int (pc, trailer, "XRefStm", &next)) &&
+	   (next > 0) &&
+	   ((uint64_t) next < pc->fsize) &&
+	   (NULL != (stm = load_xref_section (pc, next))) )
+	free_object (stm);
+      if ( (0 != dict_get_int (pc, trailer, "Prev", &next)) ||
+	   (next <= 0) ||
+	   ((uint64_t) next >= pc->fsize) )
+	next = -1;
+      if ( (NULL == ret) &&
+	   (NULL != dict_get (trailer, "Root")) )
+	ret = trailer;
+      else
+	free_object (trailer);
+      if (-1 == next)
+	break;
+      offset = (uint64_t) next;
+    }
+  return ret;
+}
+
+
+/**
+ * Report the meta data of a PDF file.
+ *
+ * @param pc our context
+ * @param r reporting context
+ */
+static void
+process_document (struct PdfContext *pc,
+		  struct Reporter *r)
+{
+  struct PdfObject *trailer;
+  struct PdfObject *info;
+  struct PdfObject *root;
+  struct PdfObject *meta;
+  struct PdfObject *pages;
+  const struct PdfObject *count;
+  unsigned char *xmp;
+  size_t xmp_len;
+  char buf[32];
+  int encrypted;
+
+  if (NULL == (trailer = load_xref (pc)))
+    return;
+  /* we do not decrypt strings, and the XMP stream is usually also
+     encrypted */
+  encrypted = (NULL != dict_get (trailer, "Encrypt"));
+  if ( (! encrypted) &&
+       (NULL != (info = load_dict_entry (pc, trailer, "Info", NULL, NULL))) )
+    {
+      report_info (r, info);
+      free_object (info);
+    }
+  if ( (0 != r->stop) ||
+       (NULL == (root = load_dict_entry (pc, trailer, "Root", NULL, NULL))) )
+    {
+      free_object (trailer);
+      return;
+    }
+  free_object (trailer);
+  if (! encrypted)
+    {
+      meta = load_dict_entry (pc, root, "Metadata", &xmp, &xmp_len);
+      if (NULL != xmp)
+	{
+	  report_xmp (r, (const char *) xmp, xmp_len);
+	  free (xmp);
 	}
+      free_object (meta);
     }
+  pages = load_dict_entry (pc, root, "Pages", NULL, NULL);
+  free_object (root);
+  count = dict_get (pages, "Count");
+  if ( (0 == r->stop) &&
+       (NULL != count) &&
+       (PDF_NUMBER == count->type) &&
+       (count->num > 0) )
+    {
+      snprintf (buf, sizeof (buf), "%lld", (long long) count->num);
+      report (r, EXTRACTOR_METATYPE_PAGE_COUNT, buf);
+    }
+  free_object (pages);
 }
 
 
@@ -132,106 +2439,46 @@ process_stdout (FILE *fout,
 void
 EXTRACTOR_pdf_extract_method (struct EXTRACTOR_ExtractContext *ec)
 {
-  uint64_t fsize;
+  struct PdfContext pc;
+  struct Reporter r;
+  char version[8];
+  const char *hdr;
   void *data;
-  pid_t pid;
-  int in[2];
-  int out[2];
-  FILE *fout;
-  uint64_t pos;
-
-  fsize = ec->get_size (ec->cls);
-  if (fsize < 128)
-    return;
-  if (4 !=
-      ec->read (ec->cls, &data, 4))
-    return;
-  if (0 != strncmp ("%PDF", data, 4))
+  ssize_t got;
+  unsigned int i;
+
+  memset (&pc, 0, sizeof (pc));
+  pc.ec = ec;
+  pc.fsize = ec->get_size (ec->cls);
+  if (pc.fsize < 128)
     return;
-  if (0 !=
-      ec->seek (ec->cls, 0, SEEK_SET))
+  if (16 > (got = ec->read (ec->cls, &data, 16)))
     return;
-  if (0 != pipe (in))
+  hdr = data;
+  if (0 != strncmp ("%PDF-", hdr, 5))
     return;
-  if (0 != pipe (out))
+  /* version is 'M.m' */
+  for (i = 0; (i + 1 < sizeof (version)) && (i + 5 < got); i++)
     {
-      close (in[0]);
-      close (in[1]);
-      return;
+      if ( (! isdigit ((unsigned char) hdr[i + 5])) &&
+	   ('.' != hdr[i + 5]) )
+	break;
+      version[i] = hdr[i + 5];
     }
-  pid = fork ();
-  if (-1 == pid)
+  version[i] = '\0';
+  memset (&r, 0, sizeof (r));
+  r.ec = ec;
+  process_document (&pc, &r);
+  if ( (0 == r.stop) &&
+       (strlen (version) > 0) )
+    report (&r, EXTRACTOR_METATYPE_ENCODER_VERSION, version);
+  for (i = 0; i < pc.num_sections; i++)
     {
-      close (in[0]);
-      close (in[1]);
-      close (out[0]);
-      close (out[1]);
-      return;
-    }
-  if (0 == pid)
-    {
-      char *const args[] = {
-        "pdfinfo",
-        "-",
-        NULL
-      };
-      /* am child, exec 'pdfinfo' */
-      close (0);
-      close (1);
-      if ( (-1 == dup2 (in[0], 0)) ||
-           (-1 == dup2 (out[1], 1)) )
-        exit (1);
-      close (in[0]);
-      close (in[1]);
-      close (out[0]);
-      close (out[1]);
-      execvp ("pdfinfo", args);
-      exit (1);
-    }
-  /* am parent, send file */
-  close (in[0]);
-  close (out[1]);
-  fout = fdopen (out[0], "r");
-  if (NULL == fout)
-    {
-      close (in[1]);
-      close (out[0]);
-      kill (pid, SIGKILL);
-      waitpid (pid, NULL, 0);
-      return;
+      free (pc.sections[i].subs);
+      free (pc.sections[i].data);
+      free (pc.sections[i].index);
     }
-  pos = 0;
-  while (pos < fsize)
-    {
-      ssize_t got;
-      size_t wpos;
-
-      data = NULL;
-      got = ec->read (ec->cls,
-                      &data,
-                      fsize - pos);
-      if ( (-1 == got) ||
-           (NULL == data) )
-        break;
-      wpos = 0;
-      while (wpos < got)
-        {
-          ssize_t out;
-
-          out = write (in[1], data + wpos, got - wpos);
-          if (out <= 0)
-            break;
-          wpos += out;
-        }
-      if (wpos < got)
-        break;
-      pos += got;
-    }
-  close (in[1]);
-  process_stdout (fout, ec->proc, ec->cls);
-  fclose (fout);
-  kill (pid, SIGKILL);
-  waitpid (pid, NULL, 0);
+  free (pc.objstm);
 }
 
 /* end of pdf_extractor.c */
@@ -35,7 +35,6 @@
  */
 #include "platform.h"
 #include "extractor.h"
-#include <magic.h>
 
 #if HAVE_LIBAVUTIL_AVUTIL_H
 #include <libavutil/avutil.h>
@@ -1147,7 +1146,14 @@ EXTRACTOR_previewopus_extract_method (struct EXTRACTOR_ExtractContext *ec)
   ssize_t iret;
   void *data;
 
-
+  if (0 == ec->wants (ec->cls, EXTRACTOR_METATYPE_AUDIO_PREVIEW))
+    return;
+  if ( (NULL != ec->mime_hint) &&
+       (0 != strncmp (ec->mime_hint, "audio/", strlen ("audio/"))) &&
+       (0 != strncmp (ec->mime_hint, "video/", strlen ("video/"))) &&
+       (0 != strcmp (ec->mime_hint, "application/ogg")) &&
+       (0 != strcmp (ec->mime_hint, "application/vnd.rn-realmedia")) )
+    return; /* no audio in there */
   if (-1 == (iret = ec->read (ec->cls,
 			      &data,
 			      16 * 1024)))
@@ -25,118 +25,358 @@
 #include "platform.h"
 #include "extractor.h"
 #include <stdint.h>
-#include <rpm/rpmlib.h>
-#include <rpm/rpmts.h>
-#include <rpm/rpmlog.h>
-#if SOMEBSD
-#include <pthread_np.h>
-#else
-#include <pthread.h>
-#endif
-#include <sys/types.h>
-#include <signal.h>
 
 
 /**
- * Closure for the 'pipe_feeder'.
+ * Size of the RPM lead (obsolete header at the start of the file).
+ */
+#define RPM_LEAD_SIZE 96
+
+/**
+ * Size of the fixed part of a header structure (magic, reserved,
+ * number of index entries and size of the data store).
+ */
+#define HEADER_INTRO_SIZE 16
+
+/**
+ * Size of an entry in the index of a header structure.
+ */
+#define INDEX_ENTRY_SIZE 16
+
+/**
+ * Maximum number of index entries we accept in the main header.
+ */
+#define MAX_INDEX_ENTRIES (64 * 1024)
+
+/**
+ * Maximum size of the data store of the main header.  Headers
+ * of packages with huge file lists are a few MB.
+ */
+#define MAX_STORE_SIZE (64 * 1024 * 1024)
+
+/**
+ * Data types of header entries.
+ */
+#define RPM_INT32_TYPE 4
+#define RPM_STRING_TYPE 6
+#define RPM_STRING_ARRAY_TYPE 8
+#define RPM_I18NSTRING_TYPE 9
+
+/**
+ * Tags of header entries we care about.
+ */
+#define RPMTAG_NAME 1000
+#define RPMTAG_VERSION 1001
+#define RPMTAG_RELEASE 1002
+#define RPMTAG_SUMMARY 1004
+#define RPMTAG_DESCRIPTION 1005
+#define RPMTAG_BUILDTIME 1006
+#define RPMTAG_BUILDHOST 1007
+#define RPMTAG_SIZE 1009
+#define RPMTAG_DISTRIBUTION 1010
+#define RPMTAG_VENDOR 1011
+#define RPMTAG_LICENSE 1014
+#define RPMTAG_PACKAGER 1015
+#define RPMTAG_GROUP 1016
+#define RPMTAG_URL 1020
+#define RPMTAG_OS 1021
+#define RPMTAG_ARCH 1022
+#define RPMTAG_OLDFILENAMES 1027
+#define RPMTAG_PROVIDENAME 1047
+#define RPMTAG_REQUIRENAME 1049
+#define RPMTAG_CONFLICTNAME 1054
+#define RPMTAG_DIRINDEXES 1116
+#define RPMTAG_BASENAMES 1117
+#define RPMTAG_DIRNAMES 1118
+#define RPMTAG_DISTURL 1123
+#define RPMTAG_PLATFORM 1132
+
+
+/**
+ * Main header of an RPM, as read from the file.
  */
-struct PipeArgs
+struct Header
 {
+  /**
+   * Index entries followed by the data store.
+   */
+  unsigned char *data;
+
+  /**
+   * Start of the data store (within @e data).
+   */
+  const unsigned char *store;
+
+  /**
+   * Number of index entries.
+   */
+  uint32_t nindex;
+
+  /**
+   * Size of the data store.
+   */
+  uint32_t hsize;
+};
 
+
+/**
+ * An entry from the index of a header.
+ */
+struct IndexEntry
+{
   /**
-   * Context for reading data from.
+   * Tag of the entry.
    */
-  struct EXTRACTOR_ExtractContext *ec;
+  uint32_t tag;
 
   /**
-   * Lock for synchronizing access to 'ec'.
+   * Data type of the entry.
    */
-  pthread_mutex_t lock;
+  uint32_t type;
 
   /**
-   * Pipe to write to at [1].
+   * Offset of the value in the data store.
    */
-  int pi[2];
+  uint32_t offset;
 
   /**
-   * Set to 1 if we should stop writing to the pipe.
+   * Number of values.
    */
-  int shutdown;
+  uint32_t count;
 };
 
 
 /**
- * Size of the buffer we use for reading.
+ * Get a 32-bit big endian integer from a buffer.
+ *
+ * @param p where to read
+ * @return the value
  */
-#define BUF_SIZE (16 * 1024)
+static uint32_t
+get_be32 (const unsigned char *p)
+{
+  return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) |
+    ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+}
 
 
 /**
- * Main function of a helper thread that passes the package data
- * to librpm.
+ * Read exactly @a size bytes from the file.
  *
- * @param args the 'struct PipeArgs*'
- * @return NULL
+ * @param ec extraction context
+ * @param buf where to store the data
+ * @param size number of bytes to read
+ * @return 0 on success, -1 on error (or short file)
  */
-static void *
-pipe_feeder (void * args)
+static int
+read_fully (struct EXTRACTOR_ExtractContext *ec,
+	    void *buf,
+	    size_t size)
 {
-  struct PipeArgs *p = args;
-  ssize_t rret;
-  ssize_t wret;
-  ssize_t done;
-  void *ptr;
-  char *buf;
-
-  /* buffer is heap-allocated as this is a thread and
-     large stack allocations might not be the best idea */
-  while (0 == p->shutdown)
+  unsigned char *dst = buf;
+  void *data;
+  ssize_t ret;
+  size_t done;
+
+  done = 0;
+  while (done < size)
     {
-      pthread_mutex_lock (&p->lock);
-      if (-1 == (rret = p->ec->read (p->ec->cls, &ptr, BUF_SIZE)))
-	{
-	  pthread_mutex_unlock (&p->lock);
-	  break;
-	}
-      pthread_mutex_unlock (&p->lock);
-      if (0 == rret)
-	break;
-      buf = ptr;
-      done = 0;
-      while ( (0 == p->shutdown) &&
-	      (done < rret) )
-	{
-	  if (-1 == (wret = WRITE (p->pi[1],
-				   &buf[done],
-				   rret - done)))
-	    {
-	      break;
-	    }
-	  if (0 == wret)
-	    break;
-	  done += wret;
-	}
-      if (done != rret)
-	break;
+      if (0 >= (ret = ec->read (ec->cls, &data, size - done)))
+	return -1;
+      memcpy (&dst[done], data, ret);
+      done += ret;
     }
-  CLOSE (p->pi[1]);
-  return NULL;
+  return 0;
 }
 
 
 /**
- * LOG callback called by librpm.  Does nothing, we
- * just need this to override the default behavior.
+ * Read the fixed part of a header structure.
+ *
+ * @param ec extraction context
+ * @param nindex set to the number of index entries
+ * @param hsize set to the size of the data store
+ * @return 0 on success, -1 if this is not a header structure
  */
 static int
-discard_log_callback (rpmlogRec rec,
-		      void *ctx)
+read_header_intro (struct EXTRACTOR_ExtractContext *ec,
+		   uint32_t *nindex,
+		   uint32_t *hsize)
 {
-  /* do nothing! */
+  static const unsigned char header_magic[] = { 0x8e, 0xad, 0xe8, 0x01 };
+  unsigned char intro[HEADER_INTRO_SIZE];
+
+  if ( (0 != read_fully (ec, intro, sizeof (intro))) ||
+       (0 != memcmp (intro, header_magic, sizeof (header_magic))) )
+    return -1;
+  *nindex = get_be32 (&intro[8]);
+  *hsize = get_be32 (&intro[12]);
   return 0;
 }
 
 
+/**
+ * Skip over the lead and the signature header and read the main
+ * header of the package.  Nothing beyond the main header (i.e. the
+ * payload) is read.
+ *
+ * @param ec extraction context
+ * @param hdr where to store the main header
+ * @return 0 on success, -1 if this is not an RPM
+ */
+static int
+read_main_header (struct EXTRACTOR_ExtractContext *ec,
+		  struct Header *hdr)
+{
+  static const unsigned char lead_magic[] = { 0xed, 0xab, 0xee, 0xdb };
+  unsigned char lead[RPM_LEAD_SIZE];
+  uint32_t nindex;
+  uint32_t hsize;
+  int64_t skip;
+
+  if ( (0 != read_fully (ec, lead, sizeof (lead))) ||
+       (0 != memcmp (lead, lead_magic, sizeof (lead_magic))) )
+    return -1;
+  /* signature header, padded to a multiple of 8 bytes */
+  if (0 != read_header_intro (ec, &nindex, &hsize))
+    return -1;
+  skip = (int64_t) nindex * INDEX_ENTRY_SIZE + hsize + (8 - hsize % 8) % 8;
+  if (-1 == ec->seek (ec->cls, skip, SEEK_CUR))
+    return -1;
+  if (0 != read_header_intro (ec, &hdr->nindex, &hdr->hsize))
+    return -1;
+  if ( (hdr->nindex > MAX_INDEX_ENTRIES) ||
+       (hdr->hsize > MAX_STORE_SIZE) )
+    return -1;
+  if (NULL == (hdr->data = malloc ((size_t) hdr->nindex * INDEX_ENTRY_SIZE
+				   + hdr->hsize)))
+    return -1;
+  if (0 != read_fully (ec, hdr->data,
+		       (size_t) hdr->nindex * INDEX_ENTRY_SIZE + hdr->hsize))
+    {
+      free (hdr->data);
+      hdr->data = NULL;
+      return -1;
+    }
+  hdr->store = &hdr->data[hdr->nindex * INDEX_ENTRY_SIZE];
+  return 0;
+}
+
+
+/**
+ * Get an entry from the index of a header.
+ *
+ * @param hdr header to inspect
+ * @param i number of the entry (must be smaller than the number of entries)
+ * @param ie where to store the entry
+ */
+static void
+get_index_entry (const struct Header *hdr,
+		 uint32_t i,
+		 struct IndexEntry *ie)
+{
+  const unsigned char *p = &hdr->data[i * INDEX_ENTRY_SIZE];
+
+  ie->tag = get_be32 (&p[0]);
+  ie->type = get_be32 (&p[4]);
+  ie->offset = get_be32 (&p[8]);
+  ie->count = get_be32 (&p[12]);
+}
+
+
+/**
+ * Find an entry with the given tag in the index of a header.
+ *
+ * @param hdr header to search
+ * @param tag tag to look for
+ * @param type required data type of the entry
+ * @param ie where to store the entry
+ * @return 0 if the entry was found
+ */
+static int
+find_index_entry (const struct Header *hdr,
+		  uint32_t tag,
+		  uint32_t type,
+		  struct IndexEntry *ie)
+{
+  uint32_t i;
+
+  for (i = 0; i < hdr->nindex; i++)
+    {
+      get_index_entry (hdr, i, ie);
+      if ( (tag == ie->tag) &&
+	   (type == ie->type) )
+	return 0;
+    }
+  return -1;
+}
+
+
+/**
+ * Get a string from the data store of a header.
+ *
+ * @param hdr header to use
+ * @param offset offset of the string in the data store
+ * @return NULL if the string is not 0-terminated within the store
+ */
+static const char *
+get_string (const struct Header *hdr,
+	    uint32_t offset)
+{
+  if ( (offset >= hdr->hsize) ||
+       (NULL == memchr (&hdr->store[offset], 0, hdr->hsize - offset)) )
+    return NULL;
+  return (const char *) &hdr->store[offset];
+}
+
+
+/**
+ * Get a 32-bit integer from the data store of a header.
+ *
+ * @param hdr header to use
+ * @param ie entry with the integers
+ * @param i index of the integer to get
+ * @param val where to store the value
+ * @return 0 on success, -1 if the value is outside of the store
+ */
+static int
+get_int32 (const struct Header *hdr,
+	   const struct IndexEntry *ie,
+	   uint32_t i,
+	   uint32_t *val)
+{
+  if ( (i >= ie->count) ||
+       (ie->offset > hdr->hsize) ||
+       ((hdr->hsize - ie->offset) / 4 <= i) )
+    return -1;
+  *val = get_be32 (&hdr->store[ie->offset + 4 * i]);
+  return 0;
+}
+
+
+/**
+ * Pass a string to LE.
+ *
+ * @param ec extraction context
+ * @param type meta data type of the string
+ * @param str the string
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_string (struct EXTRACTOR_ExtractContext *ec,
+	    enum EXTRACTOR_MetaType type,
+	    const char *str)
+{
+  return ec->proc (ec->cls,
+		   "rpm",
+		   type,
+		   EXTRACTOR_METAFORMAT_UTF8,
+		   "text/plain",
+		   str,
+		   strlen (str) + 1);
+}
+
+
 /**
  * Mapping from RPM tags to LE types.
  */
@@ -145,7 +385,7 @@ struct Matches
   /**
    * RPM tag.
    */
-  int32_t rtype;
+  uint32_t rtype;
 
   /**
    * Corresponding LE type.
@@ -165,9 +405,6 @@ static struct Matches tests[] = {
   {RPMTAG_SUMMARY, EXTRACTOR_METATYPE_SUMMARY},
   {RPMTAG_PACKAGER, EXTRACTOR_METATYPE_PACKAGE_MAINTAINER},
   {RPMTAG_BUILDTIME, EXTRACTOR_METATYPE_CREATION_DATE},
-#ifdef RPMTAG_COPYRIGHT
-  {RPMTAG_COPYRIGHT, EXTRACTOR_METATYPE_COPYRIGHT},
-#endif
   {RPMTAG_LICENSE, EXTRACTOR_METATYPE_LICENSE},
   {RPMTAG_DISTRIBUTION, EXTRACTOR_METATYPE_PACKAGE_DISTRIBUTION},
   {RPMTAG_BUILDHOST, EXTRACTOR_METATYPE_BUILDHOST},
@@ -181,7 +418,6 @@ static struct Matches tests[] = {
   {RPMTAG_ARCH, EXTRACTOR_METATYPE_TARGET_ARCHITECTURE},
   {RPMTAG_CONFLICTNAME, EXTRACTOR_METATYPE_PACKAGE_CONFLICTS},
   {RPMTAG_REQUIRENAME, EXTRACTOR_METATYPE_PACKAGE_DEPENDENCY},
-  {RPMTAG_CONFLICTNAME, EXTRACTOR_METATYPE_PACKAGE_CONFLICTS},
   {RPMTAG_PROVIDENAME, EXTRACTOR_METATYPE_PACKAGE_PROVIDES},
 
 #if 0
@@ -200,7 +436,6 @@ static struct Matches tests[] = {
     RPMTAG_POSTUN		= 1026,	/* s */
     RPMTAG_ICON			= 1043, /* x */
     RPMTAG_SOURCERPM		= 1044,	/* s */
-    RPMTAG_PROVIDENAME		= 1047,	/* s[] */
     RPMTAG_EXCLUDEARCH		= 1059, /* s[] */
     RPMTAG_EXCLUDEOS		= 1060, /* s[] */
     RPMTAG_EXCLUSIVEARCH	= 1061, /* s[] */
@@ -223,8 +458,6 @@ static struct Matches tests[] = {
     RPMTAG_INSTPREFIXES		= 1099,	/* s[] */
     RPMTAG_PROVIDEVERSION	= 1113,	/* s[] */
     RPMTAG_OBSOLETEVERSION	= 1115,	/* s[] */
-    RPMTAG_BASENAMES		= 1117,	/* s[] */
-    RPMTAG_DIRNAMES		= 1118,	/* s[] */
     RPMTAG_OPTFLAGS		= 1122,	/* s */
     RPMTAG_PAYLOADFORMAT	= 1124,	/* s */
     RPMTAG_PAYLOADCOMPRESSOR	= 1125,	/* s */
@@ -242,186 +475,192 @@ static struct Matches tests[] = {
 
 
 /**
- * Main entry method for the 'application/x-rpm' extraction plugin.
+ * Pass the values of a header entry to LE.
  *
- * @param ec extraction context provided to the plugin
+ * @param ec extraction context
+ * @param hdr header with the entry
+ * @param ie the entry
+ * @param type meta data type of the values
+ * @return 0 to continue extracting, 1 to abort
  */
-void
-EXTRACTOR_rpm_extract_method (struct EXTRACTOR_ExtractContext *ec)
+static int
+add_entry (struct EXTRACTOR_ExtractContext *ec,
+	   const struct Header *hdr,
+	   const struct IndexEntry *ie,
+	   enum EXTRACTOR_MetaType type)
 {
-  struct PipeArgs parg;
-  pthread_t pthr;
-  void *unused;
   const char *str;
-  Header hdr;
-  HeaderIterator hi;
-  rpmtd p;
-  int i;
-  FD_t fdi;
-  rpmRC rc;
-  rpmts ts;
-  struct sigaction sig;
-  struct sigaction old;
-
-  /* FIXME: here it might be worthwhile to do some minimal
-     check to see if this is actually an RPM before we go
-     and create a pipe and a thread for nothing... */
-  parg.ec = ec;
-  parg.shutdown = 0;
-  if (0 != pipe (parg.pi))
-    return;
-  if (0 != pthread_mutex_init (&parg.lock, NULL))
+  uint32_t offset;
+  uint32_t val;
+  uint32_t i;
+
+  switch (ie->type)
     {
-      CLOSE (parg.pi[0]);
-      CLOSE (parg.pi[1]);
-      return;
+    case RPM_STRING_TYPE:
+    case RPM_I18NSTRING_TYPE:
+      /* for I18N strings, the first one is the untranslated ("C") one */
+      if (NULL == (str = get_string (hdr, ie->offset)))
+	return 0;
+      return add_string (ec, type, str);
+    case RPM_STRING_ARRAY_TYPE:
+      offset = ie->offset;
+      for (i = 0; i < ie->count; i++)
+	{
+	  if (NULL == (str = get_string (hdr, offset)))
+	    return 0;
+	  if (0 != add_string (ec, type, str))
+	    return 1;
+	  offset += strlen (str) + 1;
+	}
+      return 0;
+    case RPM_INT32_TYPE:
+      if (0 != get_int32 (hdr, ie, 0, &val))
+	return 0;
+      if (RPMTAG_BUILDTIME == ie->tag)
+	{
+	  char tmp[80];
+	  time_t tp = (time_t) val;
+
+	  if (NULL == ctime_r (&tp, tmp))
+	    return 0;
+	  if ( (strlen (tmp) > 0) &&
+	       (isspace ((unsigned char) tmp[strlen(tmp)-1])) )
+	    tmp[strlen (tmp) - 1] = '\0';   /* eat linefeed */
+	  return add_string (ec, type, tmp);
+	}
+      else
+	{
+	  char tmp[14];
+
+	  snprintf (tmp,
+		    sizeof (tmp),
+		    "%u",
+		    (unsigned int) val);
+	  return add_string (ec, type, tmp);
+	}
+    default:
+      return 0;
     }
-  if (0 != pthread_create (&pthr,
-			   NULL,
-			   &pipe_feeder,
-			   &parg))
+}
+
+
+/**
+ * Pass the names of the files in the package to LE.  Modern
+ * packages store the file names split into directory and base
+ * names, older ones store the full names.
+ *
+ * @param ec extraction context
+ * @param hdr main header of the package
+ * @return 0 to continue extracting, 1 to abort
+ */
+static int
+add_file_names (struct EXTRACTOR_ExtractContext *ec,
+		const struct Header *hdr)
+{
+  struct IndexEntry base_ie;
+  struct IndexEntry dir_ie;
+  struct IndexEntry idx_ie;
+  const char **dirs;
+  const char *base;
+  char *path;
+  char *tmp;
+  size_t path_size;
+  size_t dlen;
+  size_t blen;
+  uint32_t offset;
+  uint32_t didx;
+  uint32_t i;
+  int ret;
+
+  if (0 == find_index_entry (hdr, RPMTAG_OLDFILENAMES,
+			     RPM_STRING_ARRAY_TYPE, &base_ie))
+    return add_entry (ec, hdr, &base_ie, EXTRACTOR_METATYPE_FILENAME);
+  if ( (0 != find_index_entry (hdr, RPMTAG_BASENAMES,
+			       RPM_STRING_ARRAY_TYPE, &base_ie)) ||
+       (0 != find_index_entry (hdr, RPMTAG_DIRNAMES,
+			       RPM_STRING_ARRAY_TYPE, &dir_ie)) ||
+       (0 != find_index_entry (hdr, RPMTAG_DIRINDEXES,
+			       RPM_INT32_TYPE, &idx_ie)) )
+    return 0;
+  /* each string takes at least one byte of the store */
+  if ( (dir_ie.count > hdr->hsize) ||
+       (NULL == (dirs = malloc ((dir_ie.count + 1) * sizeof (const char *)))) )
+    return 0;
+  offset = dir_ie.offset;
+  for (i = 0; i < dir_ie.count; i++)
     {
-      pthread_mutex_destroy (&parg.lock);
-      CLOSE (parg.pi[0]);
-      CLOSE (parg.pi[1]);
-      return;
+      if (NULL == (dirs[i] = get_string (hdr, offset)))
+	{
+	  free (dirs);
+	  return 0;
+	}
+      offset += strlen (dirs[i]) + 1;
     }
-  rpmlogSetCallback (&discard_log_callback, NULL);
-  fdi = fdDup (parg.pi[0]);
-  ts = rpmtsCreate();
-  rc = rpmReadPackageFile (ts, fdi, "GNU libextractor", &hdr);
-  switch (rc)
+  ret = 0;
+  path = NULL;
+  path_size = 0;
+  offset = base_ie.offset;
+  for (i = 0; i < base_ie.count; i++)
     {
-    case RPMRC_OK:
-    case RPMRC_NOKEY:
-    case RPMRC_NOTTRUSTED:
-      break;
-    case RPMRC_NOTFOUND:
-    case RPMRC_FAIL:
-    default:
-      goto END;
+      if ( (NULL == (base = get_string (hdr, offset))) ||
+	   (0 != get_int32 (hdr, &idx_ie, i, &didx)) ||
+	   (didx >= dir_ie.count) )
+	break;
+      offset += strlen (base) + 1;
+      dlen = strlen (dirs[didx]);
+      blen = strlen (base);
+      if (dlen + blen + 1 > path_size)
+	{
+	  path_size = 2 * (dlen + blen + 1);
+	  if (NULL == (tmp = realloc (path, path_size)))
+	    break;
+	  path = tmp;
+	}
+      memcpy (path, dirs[didx], dlen);
+      memcpy (&path[dlen], base, blen + 1);
+      if (0 != (ret = add_string (ec, EXTRACTOR_METATYPE_FILENAME, path)))
+	break;
     }
-  pthread_mutex_lock (&parg.lock);
-  if (0 != ec->proc (ec->cls,
-		     "rpm",
-		     EXTRACTOR_METATYPE_MIMETYPE,
-		     EXTRACTOR_METAFORMAT_UTF8,
-		     "text/plain",
-		     "application/x-rpm",
-		     strlen ("application/x-rpm") +1))
+  free (path);
+  free (dirs);
+  return ret;
+}
+
+
+/**
+ * Main entry method for the 'application/x-rpm' extraction plugin.
+ *
+ * @param ec extraction context provided to the plugin
+ */
+void
+EXTRACTOR_rpm_extract_method (struct EXTRACTOR_ExtractContext *ec)
+{
+  struct Header hdr;
+  struct IndexEntry ie;
+  uint32_t i;
+  unsigned int j;
+
+  if (0 != read_main_header (ec, &hdr))
+    return;
+  if (0 != add_string (ec,
+		       EXTRACTOR_METATYPE_MIMETYPE,
+		       "application/x-rpm"))
+    goto CLEANUP;
+  for (i = 0; i < hdr.nindex; i++)
     {
-      pthread_mutex_unlock (&parg.lock);
-      goto END;
+      get_index_entry (&hdr, i, &ie);
+      for (j = 0; 0 != tests[j].rtype; j++)
+	{
+	  if (tests[j].rtype != ie.tag)
+	    continue;
+	  if (0 != add_entry (ec, &hdr, &ie, tests[j].type))
+	    goto CLEANUP;
+	}
     }
-  pthread_mutex_unlock (&parg.lock);
-  hi = headerInitIterator (hdr);
-  p = rpmtdNew ();
-  while (1 == headerNext (hi, p))
-    for (i = 0; 0 != tests[i].rtype; i++)
-      {
-	if (tests[i].rtype != p->tag)
-	  continue;
-	switch (p->type)
-	  {
-	  case RPM_STRING_ARRAY_TYPE:
-	  case RPM_I18NSTRING_TYPE:
-	  case RPM_STRING_TYPE:
-	    while (NULL != (str = rpmtdNextString (p)))
-	      {
-		pthread_mutex_lock (&parg.lock);
-		if (0 != ec->proc (ec->cls,
-				   "rpm",
-				   tests[i].type,
-				   EXTRACTOR_METAFORMAT_UTF8,
-				   "text/plain",
-				   str,
-				   strlen (str) + 1))
-
-		  {
-		    pthread_mutex_unlock (&parg.lock);
-		    goto CLEANUP;
-		  }
-		pthread_mutex_unlock (&parg.lock);
-	      }
-	    break;
-	  case RPM_INT32_TYPE:
-	    {
-	      if (p->tag == RPMTAG_BUILDTIME)
-		{
-		  char tmp[80];
-		  uint32_t *v = rpmtdNextUint32 (p);
-		  time_t tp = (time_t) *v;
-
-                  if (NULL == ctime_r (&tp, tmp))
-                    break;
-                  if ( (strlen (tmp) > 0) &&
-                       (isspace ((unsigned char) tmp[strlen(tmp)-1])) )
-                    tmp[strlen (tmp) - 1] = '\0';   /* eat linefeed */
-		  pthread_mutex_lock (&parg.lock);
-		  if (0 != ec->proc (ec->cls,
-				     "rpm",
-				     tests[i].type,
-				     EXTRACTOR_METAFORMAT_UTF8,
-				     "text/plain",
-				     tmp,
-				     strlen (tmp) + 1))
-		    {
-		      pthread_mutex_unlock (&parg.lock);
-		      goto CLEANUP;
-		    }
-		  pthread_mutex_unlock (&parg.lock);
-		}
-	      else
-		{
-		  char tmp[14];
-		  uint32_t *s = rpmtdNextUint32 (p);
-
-		  snprintf (tmp,
-			    sizeof (tmp),
-			    "%u",
-			    (unsigned int) *s);
-		  pthread_mutex_lock (&parg.lock);
-		  if (0 != ec->proc (ec->cls,
-				     "rpm",
-				     tests[i].type,
-				     EXTRACTOR_METAFORMAT_UTF8,
-				     "text/plain",
-				     tmp,
-				     strlen (tmp) + 1))
-		    {
-		      pthread_mutex_unlock (&parg.lock);
-		      goto CLEANUP;
-		    }
-		  pthread_mutex_unlock (&parg.lock);
-		}
-	      break;
-	    }
-	  default:
-	    break;
-	  }
-      }
+  if (ec->wants (ec->cls, EXTRACTOR_METATYPE_FILENAME))
+    add_file_names (ec, &hdr);
  CLEANUP:
-  rpmtdFree (p);
-  headerFreeIterator (hi);
-
- END:
-  headerFree (hdr);
-  rpmtsFree(ts);
-
-  /* make sure SIGALRM does not kill us, then use it to
-     kill the thread */
-  memset (&sig, 0, sizeof (struct sigaction));
-  memset (&old, 0, sizeof (struct sigaction));
-  sig.sa_flags = SA_NODEFER;
-  sig.sa_handler = SIG_IGN;
-  sigaction (SIGALRM, &sig, &old);
-  parg.shutdown = 1;
-  CLOSE (parg.pi[0]);
-  Fclose (fdi);
-  pthread_kill (pthr, SIGALRM);
-  pthread_join (pthr, &unused);
-  pthread_mutex_destroy (&parg.lock);
-  sigaction (SIGALRM, &old, &sig);
+  free (hdr.data);
 }
 
 /* end of rpm_extractor.c */
@@ -0,0 +1,171 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file plugins/test_asf.c
+ * @brief testcase for asf plugin
+ */
+#include "platform.h"
+#include "test_lib.h"
+
+
+/**
+ * Main function for the ASF testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct SolutionData asf_30_and_33_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video/x-ms-asf",
+	strlen ("video/x-ms-asf") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_SUBTITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Some subtitle",
+	strlen ("Some subtitle") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COMPOSER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Composed by ThisGuy",
+	strlen ("Composed by ThisGuy") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CONDUCTOR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"More like semi-conductors",
+	strlen ("More like semi-conductors") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TRACK_NUMBER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"21",
+	strlen ("21") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ALBUM,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Zee Album",
+	strlen ("Zee Album") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PUBLICATION_YEAR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"9999",
+	strlen ("9999") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ARTIST,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"All performed by Nobody",
+	strlen ("All performed by Nobody") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_GENRE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Flabberghasting",
+	strlen ("Flabberghasting") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Some title",
+	strlen ("Some title") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_AUTHOR_NAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"This Artist Contributed",
+	strlen ("This Artist Contributed") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DESCRIPTION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"A witty comment",
+	strlen ("A witty comment") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"5s",
+	strlen ("5s") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2012.08.18 06:49:54 UTC",
+	strlen ("2012.08.18 06:49:54 UTC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio track (0x0161 [Windows Media Audio 9.2], 2-channel 16-bit at 44100Hz)",
+	strlen ("audio track (0x0161 [Windows Media Audio 9.2], 2-channel 16-bit at 44100Hz)") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet ps[] =
+    {
+      { "testdata/gstreamer_30_and_33.asf",
+	asf_30_and_33_sol },
+      { NULL, NULL }
+    };
+  return ET_main ("asf", ps);
+}
+
+/* end of test_asf.c */
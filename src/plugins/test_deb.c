@@ -162,12 +162,37 @@ main (int argc, char *argv[])
       },
       { 0, 0, NULL, NULL, 0, -1 }
     };
+#if HAVE_LIBLZMA
+  /* same package, with control.tar.xz instead of control.tar.gz */
+  struct SolutionData deb_xz_sol[sizeof (deb_bzip2_sol) /
+				 sizeof (struct SolutionData)];
+#endif
+#if HAVE_LIBZSTD
+  /* same package, with control.tar.zst instead of control.tar.gz */
+  struct SolutionData deb_zstd_sol[sizeof (deb_bzip2_sol) /
+				   sizeof (struct SolutionData)];
+#endif
   struct ProblemSet ps[] =
     {
       { "testdata/deb_bzip2.deb",
 	deb_bzip2_sol },
+#if HAVE_LIBLZMA
+      { "testdata/deb_xz.deb",
+	deb_xz_sol },
+#endif
+#if HAVE_LIBZSTD
+      { "testdata/deb_zstd.deb",
+	deb_zstd_sol },
+#endif
       { NULL, NULL }
     };
+
+#if HAVE_LIBLZMA
+  memcpy (deb_xz_sol, deb_bzip2_sol, sizeof (deb_bzip2_sol));
+#endif
+#if HAVE_LIBZSTD
+  memcpy (deb_zstd_sol, deb_bzip2_sol, sizeof (deb_bzip2_sol));
+#endif
   return ET_main ("deb", ps);
 }
 
@@ -0,0 +1,198 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file plugins/test_ebml.c
+ * @brief testcase for ebml plugin
+ */
+#include "platform.h"
+#include "test_lib.h"
+
+
+/**
+ * Expected software description.
+ */
+#define CREATED_BY "Written with mkvmerge v5.7.0 ('The Whirlwind') built on Jul  8 2012 20:08:51, muxed with libebml v1.2.3 + libmatroska v1.3.0"
+
+/**
+ * Expected comment (from the Tags at the end of the file).
+ */
+#define COMMENT "The purpose of this file is to hold as many examples of Matroska tags as possible."
+
+
+/**
+ * Main function for the EBML testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct SolutionData matroska_flame_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video/x-matroska",
+	strlen ("video/x-matroska") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_FORMAT_VERSION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1",
+	strlen ("1") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"matroska 2 (EBML 1)",
+	strlen ("matroska 2 (EBML 1)") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"3s",
+	strlen ("3s") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2012.08.29 18:57:25 UTC",
+	strlen ("2012.08.29 18:57:25 UTC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"filesegmenttitle",
+	strlen ("filesegmenttitle") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	CREATED_BY,
+	strlen (CREATED_BY) + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"256x240",
+	strlen ("256x240") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video track `videotrackname' (V_MS/VFW/FOURCC) [ita]",
+	strlen ("video track `videotrackname' (V_MS/VFW/FOURCC) [ita]") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"ALBUM/TITLE",
+	strlen ("ALBUM/TITLE") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ARTIST,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"ALBUM/ARTIST",
+	strlen ("ALBUM/ARTIST") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_UNKNOWN,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"TOTAL_PARTS=20",
+	strlen ("TOTAL_PARTS=20") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_UNKNOWN,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"EMAIL=COPYRIGHT/EMAIL",
+	strlen ("EMAIL=COPYRIGHT/EMAIL") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PUBLICATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1999",
+	strlen ("1999") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COMMENT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	COMMENT,
+	strlen (COMMENT) + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PERFORMER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"LEAD_PERFORMER",
+	strlen ("LEAD_PERFORMER") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"VIDEO/TITLE",
+	strlen ("VIDEO/TITLE") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet ps[] =
+    {
+      { "testdata/matroska_flame.mkv",
+	matroska_flame_sol },
+      { NULL, NULL }
+    };
+  return ET_main ("ebml", ps);
+}
+
+/* end of test_ebml.c */
@@ -0,0 +1,201 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file plugins/test_elf.c
+ * @brief testcase for elf plugin
+ */
+#include "platform.h"
+#include "test_lib.h"
+
+
+/**
+ * Main function for the ELF testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct SolutionData elf_pie_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"application/x-pie-executable",
+	strlen ("application/x-pie-executable") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Position-independent executable file",
+	strlen ("Position-independent executable file") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TARGET_ARCHITECTURE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"x86_64",
+	strlen ("x86_64") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PROGRAM_INTERPRETER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/lib64/ld-linux-x86-64.so.2",
+	strlen ("/lib64/ld-linux-x86-64.so.2") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TARGET_OS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Linux 3.2.0",
+	strlen ("Linux 3.2.0") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_BUILD_ID,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"5d3f0e6a9c1b2f4e8a7d6c5b4a39281706f5e4d3",
+	strlen ("5d3f0e6a9c1b2f4e8a7d6c5b4a39281706f5e4d3") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LIBRARY_DEPENDENCY,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"libz.so.1",
+	strlen ("libz.so.1") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LIBRARY_DEPENDENCY,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"libc.so.6",
+	strlen ("libc.so.6") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LIBRARY_SEARCH_PATH,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"$ORIGIN/../lib",
+	strlen ("$ORIGIN/../lib") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData elf_ppc_lib_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"application/x-sharedlib",
+	strlen ("application/x-sharedlib") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Shared object file",
+	strlen ("Shared object file") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TARGET_ARCHITECTURE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"PPC",
+	strlen ("PPC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TARGET_OS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Linux",
+	strlen ("Linux") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_BUILD_ID,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"0123456789abcdeffedcba9876543210aabbccdd",
+	strlen ("0123456789abcdeffedcba9876543210aabbccdd") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LIBRARY_SONAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"libtest.so.1",
+	strlen ("libtest.so.1") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LIBRARY_DEPENDENCY,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"libm.so.6",
+	strlen ("libm.so.6") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LIBRARY_DEPENDENCY,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"libc.so.6",
+	strlen ("libc.so.6") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LIBRARY_SEARCH_PATH,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/opt/test/lib",
+	strlen ("/opt/test/lib") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet ps[] =
+    {
+      { "testdata/elf_pie_x86_64",
+	elf_pie_sol },
+      { "testdata/elf_ppc_lib",
+	elf_ppc_lib_sol },
+      { NULL, NULL }
+    };
+  return ET_main ("elf", ps);
+}
+
+/* end of test_elf.c */
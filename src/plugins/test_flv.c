@@ -0,0 +1,169 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file plugins/test_flv.c
+ * @brief testcase for flv plugin
+ */
+#include "platform.h"
+#include "test_lib.h"
+
+
+/**
+ * Main function for the FLV testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct SolutionData flv_barsandtone_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video/x-flv",
+	strlen ("video/x-flv") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"6s",
+	strlen ("6s") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"360x288",
+	strlen ("360x288") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video track (On2 VP6, 10.00 fps)",
+	strlen ("video track (On2 VP6, 10.00 fps)") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio track (MP3, 2-channel 16-bit at 44100Hz)",
+	strlen ("audio track (MP3, 2-channel 16-bit at 44100Hz)") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData flv_sorenson_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video/x-flv",
+	strlen ("video/x-flv") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Sorenson Test",
+	strlen ("Sorenson Test") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATOR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"libextractor",
+	strlen ("libextractor") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"flvtool2",
+	strlen ("flvtool2") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_MODIFICATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2018.01.01 12:00:00 UTC",
+	strlen ("2018.01.01 12:00:00 UTC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"93s",
+	strlen ("93s") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"200x112",
+	strlen ("200x112") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video track (Sorenson H.263)",
+	strlen ("video track (Sorenson H.263)") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio track (AAC, 2-channel 16-bit at 48000Hz)",
+	strlen ("audio track (AAC, 2-channel 16-bit at 48000Hz)") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet ps[] =
+    {
+      { "testdata/gstreamer_barsandtone.flv",
+	flv_barsandtone_sol },
+      { "testdata/flv_sorenson.flv",
+	flv_sorenson_sol },
+      { NULL, NULL }
+    };
+  return ET_main ("flv", ps);
+}
+
+/* end of test_flv.c */
@@ -502,6 +502,66 @@ main (int argc, char *argv[])
     g_print ("flv GStreamer test result: %s\n", test_result == 0 ? "OK" : "FAILED");
     result += test_result;
   }
+  if (pre_test != GST_DISCOVERER_MISSING_PLUGINS)
+  {
+    int test_result;
+    /* header-only mode: only typefind and the demuxer run, so we get
+       the caps of the container and of the demuxed streams, but
+       nothing that only the decoders (or parsers) know about */
+    struct SolutionData barsandtone_headers_sol[] =
+      {
+        {
+	  EXTRACTOR_METATYPE_MIMETYPE,
+	  EXTRACTOR_METAFORMAT_UTF8,
+	  "text/plain",
+	  "video/x-flv",
+	  strlen ("video/x-flv") + 1,
+	  0
+        },
+        {
+	  EXTRACTOR_METATYPE_MIMETYPE,
+	  EXTRACTOR_METAFORMAT_UTF8,
+	  "text/plain",
+	  "video/x-vp6-flash",
+	  strlen ("video/x-vp6-flash") + 1,
+	  0
+        },
+        {
+	  EXTRACTOR_METATYPE_MIMETYPE,
+	  EXTRACTOR_METAFORMAT_UTF8,
+	  "text/plain",
+	  "audio/mpeg",
+	  strlen ("audio/mpeg") + 1,
+	  0
+        },
+        {
+	  EXTRACTOR_METATYPE_UNKNOWN,
+	  EXTRACTOR_METAFORMAT_UTF8,
+	  "text/plain",
+	  "mpegversion=1",
+	  strlen ("mpegversion=1") + 1,
+	  0
+        },
+        {
+	  EXTRACTOR_METATYPE_UNKNOWN,
+	  EXTRACTOR_METAFORMAT_UTF8,
+	  "text/plain",
+	  "layer=3",
+	  strlen ("layer=3") + 1,
+	  0
+        },
+        { 0, 0, NULL, NULL, 0, -1 }
+      };
+    struct ProblemSet ps[] =
+      {
+        { "testdata/gstreamer_barsandtone.flv", barsandtone_headers_sol },
+        { NULL, NULL }
+      };
+    g_print ("Running flv header-only test on GStreamer:\n");
+    test_result = (0 == ET_main ("gstreamer(headers)", ps) ? 0 : 1);
+    g_print ("flv header-only GStreamer test result: %s\n", test_result == 0 ? "OK" : "FAILED");
+    result += test_result;
+  }
   pre_test = discoverer_main (dc, "testdata/gstreamer_sample_sorenson.mov");
   if (pre_test != GST_DISCOVERER_MISSING_PLUGINS)
   {
@@ -112,10 +112,40 @@ main (int argc, char *argv[])
       },
       { 0, 0, NULL, NULL, 0, -1 }
     };
+  struct SolutionData html_head_sol[] =
+    {
+      { 
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Caf\xc3\xa9 & Bar \xe2\x82\xac" "5",
+	strlen ("Caf\xc3\xa9 & Bar \xe2\x82\xac" "5") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_DESCRIPTION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Caf\xc3\xa9 \"menu\"",
+	strlen ("Caf\xc3\xa9 \"menu\"") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_KEYWORDS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"coffee, bar",
+	strlen ("coffee, bar") + 1,
+	0 
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
   struct ProblemSet ps[] =
     {
       { "testdata/html_grothoff.html",
 	html_grothoff_sol },
+      { "testdata/html_head.html",
+	html_head_sol },
       { NULL, NULL }
     };
   return ET_main ("html", ps);
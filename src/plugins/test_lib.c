@@ -24,6 +24,75 @@
  */
 #include "platform.h"
 #include "test_lib.h"
+#include "extractor_datasource.h"
+#if HAVE_SYS_RESOURCE_H
+#include <sys/resource.h>
+#endif
+
+/**
+ * Default location of the performance baseline (relative
+ * to the directory 'make check' runs the tests in).
+ */
+#define PERF_BASELINE "testdata/perf_baseline.txt"
+
+
+/**
+ * How much worse than the baseline may a metric get
+ * before the performance test fails?
+ */
+struct PerfTolerance
+{
+  /**
+   * Name of the metric.
+   */
+  const char *metric;
+
+  /**
+   * Allowed relative increase (0.1 for 10%).
+   */
+  double relative;
+
+  /**
+   * Allowed absolute increase (on top of @e relative).
+   */
+  uint64_t absolute;
+};
+
+
+/**
+ * Tolerances for the metrics we record.  I/O is deterministic,
+ * time and memory depend on the machine and its load.
+ */
+static const struct PerfTolerance tolerances[] = {
+  { "bytes_read", 0.10, 4096 },
+  { "seeks", 0.10, 2 },
+  { "wall_us", 1.00, 5000 },
+  { "peak_rss_kb", 0.50, 8192 },
+  { NULL, 0.0, 0 }
+};
+
+
+/**
+ * Entry in the performance baseline.
+ */
+struct PerfEntry
+{
+  /**
+   * This is a linked list.
+   */
+  struct PerfEntry *next;
+
+  /**
+   * Name of the plugin, file, execution mode and metric,
+   * separated by spaces.
+   */
+  char *key;
+
+  /**
+   * Recorded value.
+   */
+  unsigned long long value;
+};
 
 
 /**
@@ -141,6 +210,352 @@ run (const char *plugin_name,
 }
 
 
+/**
+ * Function that libextractor calls for each meta data item
+ * found during performance runs.  Ignores the data.
+ *
+ * @return 0 (always)
+ */
+static int
+ignore_replies (void *cls,
+		const char *plugin_name,
+		enum EXTRACTOR_MetaType type,
+		enum EXTRACTOR_MetaFormat format,
+		const char *data_mime_type,
+		const char *data,
+		size_t data_len)
+{
+  return 0;
+}
+
+
+/**
+ * Obtain a monotonic timestamp (falls back to the wall clock
+ * if no monotonic clock is available).
+ *
+ * @return current time in microseconds (arbitrary epoch)
+ */
+static uint64_t
+now_us ()
+{
+#if HAVE_CLOCK_GETTIME && defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+
+  if (0 == clock_gettime (CLOCK_MONOTONIC, &ts))
+    return (uint64_t) ts.tv_sec * 1000000LLU + ts.tv_nsec / 1000;
+#endif
+  {
+    struct timeval tv;
+
+    gettimeofday (&tv, NULL);
+    return (uint64_t) tv.tv_sec * 1000000LLU + tv.tv_usec;
+  }
+}
+
+
+/**
+ * Load the performance baseline.
+ *
+ * @param filename name of the baseline file
+ * @return list of entries, NULL if the file does not exist
+ */
+static struct PerfEntry *
+perf_load (const char *filename)
+{
+  struct PerfEntry *head;
+  struct PerfEntry *pe;
+  FILE *f;
+  char line[1024];
+  char *sp;
+
+  if (NULL == (f = fopen (filename, "r")))
+    return NULL;
+  head = NULL;
+  while (NULL != fgets (line, sizeof (line), f))
+    {
+      if ( ('#' == line[0]) ||
+	   (NULL == (sp = strrchr (line, ' '))) )
+	continue;
+      *sp = '\0';
+      if (NULL == (pe = malloc (sizeof (struct PerfEntry))))
+	break;
+      pe->key = strdup (line);
+      pe->value = strtoull (&sp[1], NULL, 10);
+      pe->next = head;
+      head = pe;
+    }
+  fclose (f);
+  return head;
+}
+
+
+/**
+ * Write the performance baseline (in the order it was read).
+ *
+ * @param filename name of the baseline file
+ * @param head list of entries to write (in reverse order)
+ * @return 0 on success, 1 on failure
+ */
+static int
+perf_save (const char *filename,
+	   struct PerfEntry *head)
+{
+  struct PerfEntry *rev;
+  struct PerfEntry *pe;
+  FILE *f;
+
+  rev = NULL;
+  while (NULL != (pe = head))
+    {
+      head = pe->next;
+      pe->next = rev;
+      rev = pe;
+    }
+  if (NULL == (f = fopen (filename, "w")))
+    {
+      fprintf (stderr,
+	       "Failed to write `%s': %s\n",
+	       filename,
+	       strerror (errno));
+      return 1;
+    }
+  fprintf (f,
+	   "# plugin file mode metric value; regenerate with\n"
+	   "# LIBEXTRACTOR_TEST_PERF=K LIBEXTRACTOR_TEST_PERF_UPDATE=1 make -j1 check\n");
+  for (pe = rev; NULL != pe; pe = pe->next)
+    fprintf (f, "%s %llu\n", pe->key, pe->value);
+  return (0 == fclose (f)) ? 0 : 1;
+}
+
+
+/**
+ * Compare a measurement against the baseline, or record it in
+ * the baseline if we are updating it.
+ *
+ * @param baseline baseline to compare to or update
+ * @param update 1 to update the baseline, 0 to compare
+ * @param plugin_name name of the plugin
+ * @param filename file the measurement is about ("-" for all files)
+ * @param opt execution mode used
+ * @param metric name of the metric
+ * @param value measured value
+ * @return 0 if the value is acceptable, 1 if it regressed
+ */
+static int
+perf_check (struct PerfEntry **baseline,
+	    int update,
+	    const char *plugin_name,
+	    const char *filename,
+	    enum EXTRACTOR_Options opt,
+	    const char *metric,
+	    unsigned long long value)
+{
+  struct PerfEntry *pe;
+  const struct PerfTolerance *tol;
+  char key[1024];
+  double limit;
+
+  snprintf (key,
+	    sizeof (key),
+	    "%s %s %s %s",
+	    plugin_name,
+	    filename,
+	    (EXTRACTOR_OPTION_IN_PROCESS == opt) ? "inproc" : "oop",
+	    metric);
+  for (pe = *baseline; NULL != pe; pe = pe->next)
+    if (0 == strcmp (pe->key, key))
+      break;
+  if (update)
+    {
+      if (NULL == pe)
+	{
+	  if (NULL == (pe = malloc (sizeof (struct PerfEntry))))
+	    return 1;
+	  pe->key = strdup (key);
+	  pe->next = *baseline;
+	  *baseline = pe;
+	}
+      pe->value = value;
+      return 0;
+    }
+  if (NULL == pe)
+    {
+      fprintf (stderr,
+	       "No performance baseline for `%s' (measured %llu)\n",
+	       key,
+	       value);
+      return 0;
+    }
+  for (tol = tolerances; NULL != tol->metric; tol++)
+    if (0 == strcmp (tol->metric, metric))
+      break;
+  limit = pe->value * (1.0 + tol->relative) + tol->absolute;
+  if (value <= limit)
+    return 0;
+  fprintf (stderr,
+	   "Performance regression for `%s': %llu, baseline %llu (limit %.0f)\n",
+	   key,
+	   value,
+	   pe->value,
+	   limit);
+  return 1;
+}
+
+
+/**
+ * Helper for qsort() to sort the timings.
+ *
+ * @param a first timing
+ * @param b second timing
+ * @return -1, 0 or 1
+ */
+static int
+cmp_timing (const void *a,
+	    const void *b)
+{
+  const uint64_t *ta = a;
+  const uint64_t *tb = b;
+
+  if (*ta < *tb)
+    return -1;
+  if (*ta > *tb)
+    return 1;
+  return 0;
+}
+
+
+/**
+ * Run the plugin on each file of the problem set @a rounds times and
+ * compare wall time (median), bytes read, seeks and peak memory use
+ * against the baseline.
+ *
+ * @param plugin_name name of the plugin to load
+ * @param ps array of problems the plugin should solve;
+ *        NULL in filename terminates the array.
+ * @param opt options to use for loading the plugin
+ * @param rounds number of runs per file
+ * @param baseline baseline to compare to or update
+ * @param update 1 to update the baseline, 0 to compare
+ * @return 0 on success, 1 on failure
+ */
+static int
+perf_run (const char *plugin_name,
+	  struct ProblemSet *ps,
+	  enum EXTRACTOR_Options opt,
+	  unsigned int rounds,
+	  struct PerfEntry **baseline,
+	  int update)
+{
+  struct EXTRACTOR_PluginList *pl;
+  struct EXTRACTOR_DatasourceStatistics before;
+  struct EXTRACTOR_DatasourceStatistics after;
+  uint64_t timings[rounds];
+  uint64_t t;
+  unsigned int i;
+  unsigned int r;
+  int ret;
+
+  ret = 0;
+  pl = EXTRACTOR_plugin_add_config (NULL,
+				    plugin_name,
+				    opt);
+  for (i=0; NULL != ps[i].filename; i++)
+    {
+      /* warm up (starts the plugin process for out-of-process runs) */
+      EXTRACTOR_extract (pl,
+			 ps[i].filename,
+			 NULL, 0,
+			 &ignore_replies,
+			 NULL);
+      EXTRACTOR_datasource_get_statistics_ (&before);
+      for (r=0; r < rounds; r++)
+	{
+	  t = now_us ();
+	  EXTRACTOR_extract (pl,
+			     ps[i].filename,
+			     NULL, 0,
+			     &ignore_replies,
+			     NULL);
+	  timings[r] = now_us () - t;
+	}
+      EXTRACTOR_datasource_get_statistics_ (&after);
+      qsort (timings, rounds, sizeof (uint64_t), &cmp_timing);
+      ret |= perf_check (baseline, update, plugin_name, ps[i].filename, opt,
+			 "wall_us",
+			 timings[rounds / 2]);
+      ret |= perf_check (baseline, update, plugin_name, ps[i].filename, opt,
+			 "bytes_read",
+			 (after.bytes_read - before.bytes_read) / rounds);
+      ret |= perf_check (baseline, update, plugin_name, ps[i].filename, opt,
+			 "seeks",
+			 (after.seeks - before.seeks) / rounds);
+    }
+  /* stops the plugin processes, so that their memory use is known */
+  EXTRACTOR_plugin_remove_all (pl);
+#if HAVE_SYS_RESOURCE_H && HAVE_GETRUSAGE
+  {
+    struct rusage ru;
+
+    if (0 == getrusage ((EXTRACTOR_OPTION_IN_PROCESS == opt)
+			? RUSAGE_SELF
+			: RUSAGE_CHILDREN,
+			&ru))
+      ret |= perf_check (baseline, update, plugin_name, "-", opt,
+			 "peak_rss_kb",
+			 (unsigned long long) ru.ru_maxrss);
+  }
+#endif
+  return ret;
+}
+
+
+/**
+ * Run the performance tests if the LIBEXTRACTOR_TEST_PERF
+ * environment variable is set to the number of runs per file.
+ * LIBEXTRACTOR_TEST_PERF_BASELINE can be used to specify the
+ * baseline file; if LIBEXTRACTOR_TEST_PERF_UPDATE is set, the
+ * baseline is updated instead of compared against.
+ *
+ * @param plugin_name name of the plugin to load
+ * @param ps array of problems the plugin should solve;
+ *        NULL in filename terminates the array.
+ * @return 0 on success, 1 on failure
+ */
+static int
+perf_main (const char *plugin_name,
+	   struct ProblemSet *ps)
+{
+  struct PerfEntry *baseline;
+  struct PerfEntry *pe;
+  const char *env;
+  const char *filename;
+  unsigned int rounds;
+  int update;
+  int ret;
+
+  if ( (NULL == (env = getenv ("LIBEXTRACTOR_TEST_PERF"))) ||
+       (0 == (rounds = (unsigned int) strtoul (env, NULL, 10))) )
+    return 0;
+  if (NULL == (filename = getenv ("LIBEXTRACTOR_TEST_PERF_BASELINE")))
+    filename = PERF_BASELINE;
+  update = (NULL != getenv ("LIBEXTRACTOR_TEST_PERF_UPDATE"));
+  baseline = perf_load (filename);
+  ret = perf_run (plugin_name, ps, EXTRACTOR_OPTION_DEFAULT_POLICY,
+		  rounds, &baseline, update);
+  ret |= perf_run (plugin_name, ps, EXTRACTOR_OPTION_IN_PROCESS,
+		   rounds, &baseline, update);
+  if (update)
+    ret = perf_save (filename, baseline);
+  while (NULL != (pe = baseline))
+    {
+      baseline = pe->next;
+      free (pe->key);
+      free (pe);
+    }
+  return ret;
+}
+
+
 /**
  * Main function to be called to test a plugin.
  *
@@ -168,7 +583,7 @@ ET_main (const char *plugin_name,
   ret = run (plugin_name, ps, EXTRACTOR_OPTION_IN_PROCESS);
   if (0 != ret)
     return ret;
-  return 0;
+  return perf_main (plugin_name, ps);
 }
 
 
@@ -86,12 +86,80 @@ main (int argc, char *argv[])
       },
       { 0, 0, NULL, NULL, 0, -1 }
     };
+  struct SolutionData tiff_haute_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"image/tiff",
+	strlen ("image/tiff") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData canon_cr2_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"image/x-canon-cr2",
+	strlen ("image/x-canon-cr2") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData odf_cg_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"application/vnd.oasis.opendocument.text",
+	strlen ("application/vnd.oasis.opendocument.text") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData zip_test_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"application/zip",
+	strlen ("application/zip") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
   struct ProblemSet ps_gif[] =
     {
       { "testdata/gif_image.gif",
 	gif_image_sol },
       { NULL, NULL }
     };
+  struct ProblemSet ps_tiff[] =
+    {
+      /* recognized by our built-in signatures */
+      { "testdata/tiff_haute.tiff",
+	tiff_haute_sol },
+      /* camera raw formats based on TIFF are left to libmagic */
+      { "testdata/mime_canon.cr2",
+	canon_cr2_sol },
+      { NULL, NULL }
+    };
+  struct ProblemSet ps_zip[] =
+    {
+      /* recognized by our built-in signatures */
+      { "testdata/odf_cg.odt",
+	odf_cg_sol },
+      /* plain ZIP archives are left to libmagic */
+      { "testdata/zip_test.zip",
+	zip_test_sol },
+      { NULL, NULL }
+    };
   struct ProblemSet ps_ogg_around_19[] =
     {
       { "testdata/ogg_courseclear.ogg",
@@ -109,6 +177,16 @@ main (int argc, char *argv[])
   printf ("gif libmagic test result: %s\n", test_result == 0 ? "OK" : "FAILED");
   result += test_result;
 
+  printf ("Running tiff test on libmagic:\n");
+  test_result = (0 == ET_main ("mime", ps_tiff) ? 0 : 1);
+  printf ("tiff libmagic test result: %s\n", test_result == 0 ? "OK" : "FAILED");
+  result += test_result;
+
+  printf ("Running zip test on libmagic:\n");
+  test_result = (0 == ET_main ("mime", ps_zip) ? 0 : 1);
+  printf ("zip libmagic test result: %s\n", test_result == 0 ? "OK" : "FAILED");
+  result += test_result;
+
   printf ("Running ogg test on libmagic, assuming version ~5.19:\n");
   test_result_around_19 = (0 == ET_main ("mime", ps_ogg_around_19) ? 0 : 1);
   printf ("ogg libmagic test result: %s\n", test_result_around_19 == 0 ? "OK" : "FAILED");
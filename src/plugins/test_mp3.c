@@ -0,0 +1,448 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file plugins/test_mp3.c
+ * @brief testcase for mp3 plugin
+ */
+#include "platform.h"
+#include "test_lib.h"
+
+
+/**
+ * Expected stream description of the CBR files.
+ */
+#define CBR_128 "MPEG-1 Layer III audio, 128 kbps (CBR), 44100 Hz, joint stereo, no copyright, original"
+
+/**
+ * Cover art stored in the APEv2 tag of mp3_picture.mp3.
+ */
+#define APE_COVER "\xFF\xD8\xFF\xE0" "fakejpeg" "\xFF\xD9"
+
+
+/**
+ * Main function for the MP3 testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct SolutionData mp3_bilmusik_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio/mpeg",
+	strlen ("audio/mpeg") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_FORMAT_VERSION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"MPEG-1",
+	strlen ("MPEG-1") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	CBR_128,
+	strlen (CBR_128) + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"0m01",
+	strlen ("0m01") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ALBUM,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Bilmusik vol 1. Stainless Steel Providers",
+	strlen ("Bilmusik vol 1. Stainless Steel Providers") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PUBLICATION_YEAR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2003",
+	strlen ("2003") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_GENRE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Car music",
+	strlen ("Car music") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"07. motorbike",
+	strlen ("07. motorbike") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ARTIST,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Sheep On Drugs",
+	strlen ("Sheep On Drugs") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TRACK_NUMBER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"7/13",
+	strlen ("7/13") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COMMENT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Stainless Steel Provider is compilated to the car of Twinstar.",
+	strlen ("Stainless Steel Provider is compilated to the car of Twinstar.") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData mp3_picture_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Aquarium",
+	strlen ("Aquarium") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_GROUPING,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Short fraction of 'Carnival of the Animals: A Grand Zoological Fantasy'",
+	strlen ("Short fraction of 'Carnival of the Animals: A Grand Zoological Fantasy'") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COMPOSER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Camille Saint-Sa\xC3\xABns",
+	strlen ("Camille Saint-Sa\xC3\xABns") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PERFORMER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Slovakia Radio Symphony Orchestra",
+	strlen ("Slovakia Radio Symphony Orchestra") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CONDUCTOR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Ondrej Len\xC3\xA1rd",
+	strlen ("Ondrej Len\xC3\xA1rd") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COPYRIGHT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1996 HNH international Ltd.",
+	strlen ("1996 HNH international Ltd.") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_GENRE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Classical",
+	strlen ("Classical") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio/mpeg",
+	strlen ("audio/mpeg") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	CBR_128,
+	strlen (CBR_128) + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"0m26",
+	strlen ("0m26") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ENCODER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"LAME3.99r",
+	strlen ("LAME3.99r") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Aquarium (APE)",
+	strlen ("Aquarium (APE)") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PUBLICATION_YEAR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1886",
+	strlen ("1886") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_THUMBNAIL,
+	EXTRACTOR_METAFORMAT_BINARY,
+	"image/jpeg",
+	APE_COVER,
+	sizeof (APE_COVER) - 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData mp3_vbri_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Erste",
+	strlen ("Erste") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Zweite",
+	strlen ("Zweite") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ARTIST,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"J\xC3\xBCrgen",
+	strlen ("J\xC3\xBCrgen") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_GENRE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Rock",
+	strlen ("Rock") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2010-05-04",
+	strlen ("2010-05-04") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_UNKNOWN,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"MusicBrainz Album Type=album",
+	strlen ("MusicBrainz Album Type=album") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COMMENT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Gelungen",
+	strlen ("Gelungen") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_LYRICS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"la la la",
+	strlen ("la la la") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_URL,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"http://example.org/artist",
+	strlen ("http://example.org/artist") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ALBUM,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Beispiel \xC3\xBF",
+	strlen ("Beispiel \xC3\xBF") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_FORMAT_VERSION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"MPEG-2",
+	strlen ("MPEG-2") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"MPEG-2 Layer III audio, 48 kbps (VBR), 24000 Hz, mono, no copyright, original",
+	strlen ("MPEG-2 Layer III audio, 48 kbps (VBR), 24000 Hz, mono, no copyright, original") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1m00",
+	strlen ("1m00") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData mp3_id3v1_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio/mpeg",
+	strlen ("audio/mpeg") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"MPEG-1 Layer I audio, 160 kbps (CBR), 48000 Hz, joint stereo, no copyright, copy",
+	strlen ("MPEG-1 Layer I audio, 160 kbps (CBR), 48000 Hz, joint stereo, no copyright, copy") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaA",
+	strlen ("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaA") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ARTIST,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"bbbbbbbbbbbbbbbbbbbbbbbbbbbbbB",
+	strlen ("bbbbbbbbbbbbbbbbbbbbbbbbbbbbbB") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ALBUM,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"cccccccccccccccccccccccccccccC",
+	strlen ("cccccccccccccccccccccccccccccC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PUBLICATION_YEAR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2003",
+	strlen ("2003") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COMMENT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"dddddddddddddddddddddddddddddD",
+	strlen ("dddddddddddddddddddddddddddddD") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_GENRE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Blues",
+	strlen ("Blues") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet ps[] =
+    {
+      { "testdata/mp3_bilmusik.mp3",
+	mp3_bilmusik_sol },
+      { "testdata/mp3_picture.mp3",
+	mp3_picture_sol },
+      { "testdata/mp3_vbri.mp3",
+	mp3_vbri_sol },
+      { "testdata/mp3_id3v1.mp3",
+	mp3_id3v1_sol },
+      { NULL, NULL }
+    };
+  return ET_main ("mp3", ps);
+}
+
+/* end of test_mp3.c */
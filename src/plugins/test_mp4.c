@@ -0,0 +1,309 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file plugins/test_mp4.c
+ * @brief testcase for mp4 plugin
+ */
+#include "platform.h"
+#include "test_lib.h"
+
+
+/**
+ * Cover art stored in mp4_itunes.m4a.
+ */
+#define ITUNES_COVER "\xFF\xD8\xFF\xE0\x00\x10JFIF\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00\xFF\xD9"
+
+
+/**
+ * Main function for the MP4 testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct SolutionData mov_sorenson_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"QuickTime Sample Movie",
+	strlen ("QuickTime Sample Movie") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_COPYRIGHT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"\xC2\xA9 Apple Computer, Inc. 2001",
+	strlen ("\xC2\xA9 Apple Computer, Inc. 2001") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video/quicktime",
+	strlen ("video/quicktime") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"5s",
+	strlen ("5s") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2001.02.19 16:45:54 UTC",
+	strlen ("2001.02.19 16:45:54 UTC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"190x240",
+	strlen ("190x240") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video track (SVQ1) [eng]",
+	strlen ("video track (SVQ1) [eng]") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio track (QDM2, 2-channel 16-bit at 22050Hz) [eng]",
+	strlen ("audio track (QDM2, 2-channel 16-bit at 22050Hz) [eng]") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData mp4_itunes_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"\xC3\x9C" "berschrift",
+	strlen ("\xC3\x9C" "berschrift") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ARTIST,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"The Testers",
+	strlen ("The Testers") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ALBUM,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Atoms and Boxes",
+	strlen ("Atoms and Boxes") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_UNKNOWN_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2018",
+	strlen ("2018") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_TRACK_NUMBER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"3/12",
+	strlen ("3/12") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DISC_NUMBER,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1",
+	strlen ("1") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_GENRE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Jazz",
+	strlen ("Jazz") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_BEATS_PER_MINUTE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"120",
+	strlen ("120") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Lavf58.12.100",
+	strlen ("Lavf58.12.100") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_THUMBNAIL,
+	EXTRACTOR_METAFORMAT_BINARY,
+	"image/jpeg",
+	ITUNES_COVER,
+	sizeof (ITUNES_COVER) - 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio/x-m4a",
+	strlen ("audio/x-m4a") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"187s",
+	strlen ("187s") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2018.01.01 00:00:00 UTC",
+	strlen ("2018.01.01 00:00:00 UTC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"audio track (mp4a, 2-channel 16-bit at 44100Hz) [deu]",
+	strlen ("audio track (mp4a, 2-channel 16-bit at 44100Hz) [deu]") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData mp4_fragmented_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_CAMERA_MAKE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Apple",
+	strlen ("Apple") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CAMERA_MODEL,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"iPhone 7",
+	strlen ("iPhone 7") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATED_BY_SOFTWARE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"11.2.6",
+	strlen ("11.2.6") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_MIMETYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video/mp4",
+	strlen ("video/mp4") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_DURATION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"10s",
+	strlen ("10s") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2018.03.25 17:46:40 UTC",
+	strlen ("2018.03.25 17:46:40 UTC") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"640x360",
+	strlen ("640x360") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_RESOURCE_TYPE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"video track (avc1) [und]",
+	strlen ("video track (avc1) [und]") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet ps[] =
+    {
+      { "testdata/gstreamer_sample_sorenson.mov",
+	mov_sorenson_sol },
+      { "testdata/mp4_itunes.m4a",
+	mp4_itunes_sol },
+      { "testdata/mp4_fragmented.mp4",
+	mp4_fragmented_sol },
+      { NULL, NULL }
+    };
+  return ET_main ("mp4", ps);
+}
+
+/* end of test_mp4.c */
@@ -0,0 +1,250 @@
+/*
+     This file is part of libextractor.
+     Copyright (C) 2018 Vidyut Samanta and Christian Grothoff
+
+     libextractor is free software; you can redistribute it and/or modify
+     it under the terms of the GNU General Public License as published
+     by the Free Software Foundation; either version 3, or (at your
+     option) any later version.
+
+     libextractor is distributed in the hope that it will be useful, but
+     WITHOUT ANY WARRANTY; without even the implied warranty of
+     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+     General Public License for more details.
+
+     You should have received a copy of the GNU General Public License
+     along with libextractor; see the file COPYING.  If not, write to the
+     Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+     Boston, MA 02110-1301, USA.
+*/
+/**
+ * @file plugins/test_pdf.c
+ * @brief testcase for pdf plugin
+ */
+#include "platform.h"
+#include "test_lib.h"
+
+
+/**
+ * Main function for the PDF testcase.
+ *
+ * @param argc number of arguments (ignored)
+ * @param argv arguments (ignored)
+ * @return 0 on success
+ */
+int
+main (int argc, char *argv[])
+{
+  struct SolutionData pdf_extract_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_CREATOR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Writer",
+	strlen ("Writer") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"OpenOffice.org 1.1.4",
+	strlen ("OpenOffice.org 1.1.4") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2005-08-09 09:58:21+02:00",
+	strlen ("2005-08-09 09:58:21+02:00") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PAGE_COUNT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2",
+	strlen ("2") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ENCODER_VERSION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1.4",
+	strlen ("1.4") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData pdf_verne_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Der Gr\303\274ne Strahl",
+	strlen ("Der Gr\303\274ne Strahl") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_SUBJECT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Jules Verne: Der Gr\303\274ne Strahl",
+	strlen ("Jules Verne: Der Gr\303\274ne Strahl") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_AUTHOR_NAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Jules Verne",
+	strlen ("Jules Verne") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATOR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Adobe InDesign CS (3.0.1)",
+	strlen ("Adobe InDesign CS (3.0.1)") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Adobe PDF Library 6.0",
+	strlen ("Adobe PDF Library 6.0") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2004-07-11 10:53:08Z",
+	strlen ("2004-07-11 10:53:08Z") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_MODIFICATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2004-07-11 12:07:17+02:00",
+	strlen ("2004-07-11 12:07:17+02:00") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PAGE_COUNT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"191",
+	strlen ("191") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ENCODER_VERSION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1.3",
+	strlen ("1.3") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData pdf_objstm_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_TITLE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Objekt-Str\303\266me",
+	strlen ("Objekt-Str\303\266me") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_MODIFICATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2018-03-04 05:06:07Z",
+	strlen ("2018-03-04 05:06:07Z") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_AUTHOR_NAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Vidyut Samanta",
+	strlen ("Vidyut Samanta") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_AUTHOR_NAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Christian Grothoff",
+	strlen ("Christian Grothoff") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATOR,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"LE test & generator",
+	strlen ("LE test & generator") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PRODUCED_BY_SOFTWARE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"Hand\303\251made",
+	strlen ("Hand\303\251made") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_CREATION_DATE,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"2018-03-04 05:06:07+01:00",
+	strlen ("2018-03-04 05:06:07+01:00") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_PAGE_COUNT,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1",
+	strlen ("1") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_ENCODER_VERSION,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1.5",
+	strlen ("1.5") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet ps[] =
+    {
+      /* classic cross reference table, UTF-16 strings */
+      { "testdata/pdf_extract.pdf",
+	pdf_extract_sol },
+      /* linearized, PDFDocEncoding strings */
+      { "testdata/pdf_verne.pdf",
+	pdf_verne_sol },
+      /* cross reference and object streams, XMP */
+      { "testdata/pdf_objstm.pdf",
+	pdf_objstm_sol },
+      { NULL, NULL }
+    };
+  return ET_main ("pdf", ps);
+}
+
+/* end of test_pdf.c */
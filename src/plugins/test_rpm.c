@@ -312,6 +312,366 @@ main (int argc, char *argv[])
 	strlen ("ia64-redhat-linux-gnu") + 1,
 	0 
       },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/bin/libtool",
+	strlen ("/usr/bin/libtool") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/bin/libtoolize",
+	strlen ("/usr/bin/libtoolize") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/include/ltdl.h",
+	strlen ("/usr/include/ltdl.h") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/lib/libltdl.a",
+	strlen ("/usr/lib/libltdl.a") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/lib/libltdl.la",
+	strlen ("/usr/lib/libltdl.la") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/lib/libltdl.so",
+	strlen ("/usr/lib/libltdl.so") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/aclocal/libtool.m4",
+	strlen ("/usr/share/aclocal/libtool.m4") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/aclocal/ltdl.m4",
+	strlen ("/usr/share/aclocal/ltdl.m4") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5",
+	strlen ("/usr/share/doc/libtool-1.5") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/AUTHORS",
+	strlen ("/usr/share/doc/libtool-1.5/AUTHORS") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/COPYING",
+	strlen ("/usr/share/doc/libtool-1.5/COPYING") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/ChangeLog",
+	strlen ("/usr/share/doc/libtool-1.5/ChangeLog") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/INSTALL",
+	strlen ("/usr/share/doc/libtool-1.5/INSTALL") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/NEWS",
+	strlen ("/usr/share/doc/libtool-1.5/NEWS") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/README",
+	strlen ("/usr/share/doc/libtool-1.5/README") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/THANKS",
+	strlen ("/usr/share/doc/libtool-1.5/THANKS") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/doc/libtool-1.5/TODO",
+	strlen ("/usr/share/doc/libtool-1.5/TODO") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/info/libtool.info-1.gz",
+	strlen ("/usr/share/info/libtool.info-1.gz") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/info/libtool.info-2.gz",
+	strlen ("/usr/share/info/libtool.info-2.gz") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/info/libtool.info-3.gz",
+	strlen ("/usr/share/info/libtool.info-3.gz") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/info/libtool.info-4.gz",
+	strlen ("/usr/share/info/libtool.info-4.gz") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/info/libtool.info-5.gz",
+	strlen ("/usr/share/info/libtool.info-5.gz") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/info/libtool.info.gz",
+	strlen ("/usr/share/info/libtool.info.gz") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool",
+	strlen ("/usr/share/libtool") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/config.guess",
+	strlen ("/usr/share/libtool/config.guess") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/config.sub",
+	strlen ("/usr/share/libtool/config.sub") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl",
+	strlen ("/usr/share/libtool/libltdl") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/COPYING.LIB",
+	strlen ("/usr/share/libtool/libltdl/COPYING.LIB") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/Makefile.am",
+	strlen ("/usr/share/libtool/libltdl/Makefile.am") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/Makefile.in",
+	strlen ("/usr/share/libtool/libltdl/Makefile.in") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/README",
+	strlen ("/usr/share/libtool/libltdl/README") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/acinclude.m4",
+	strlen ("/usr/share/libtool/libltdl/acinclude.m4") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/aclocal.m4",
+	strlen ("/usr/share/libtool/libltdl/aclocal.m4") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/config-h.in",
+	strlen ("/usr/share/libtool/libltdl/config-h.in") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/config.guess",
+	strlen ("/usr/share/libtool/libltdl/config.guess") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/config.sub",
+	strlen ("/usr/share/libtool/libltdl/config.sub") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/configure",
+	strlen ("/usr/share/libtool/libltdl/configure") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/configure.ac",
+	strlen ("/usr/share/libtool/libltdl/configure.ac") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/install-sh",
+	strlen ("/usr/share/libtool/libltdl/install-sh") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/ltdl.c",
+	strlen ("/usr/share/libtool/libltdl/ltdl.c") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/ltdl.h",
+	strlen ("/usr/share/libtool/libltdl/ltdl.h") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/ltmain.sh",
+	strlen ("/usr/share/libtool/libltdl/ltmain.sh") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/missing",
+	strlen ("/usr/share/libtool/libltdl/missing") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/libltdl/mkinstalldirs",
+	strlen ("/usr/share/libtool/libltdl/mkinstalldirs") + 1,
+	0 
+      },
+      { 
+	EXTRACTOR_METATYPE_FILENAME,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"/usr/share/libtool/ltmain.sh",
+	strlen ("/usr/share/libtool/ltmain.sh") + 1,
+	0 
+      },
       { 0, 0, NULL, NULL, 0, -1 }
     };
   struct ProblemSet ps[] =
@@ -320,6 +680,10 @@ main (int argc, char *argv[])
 	rpm_test_sol },
       { NULL, NULL }
     };
+
+  /* the build time is reported in local time */
+  putenv ("TZ=CET-1CEST,M3.5.0,M10.5.0/3");
+  tzset ();
   return ET_main ("rpm", ps);
 }
 
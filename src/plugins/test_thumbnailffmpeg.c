@@ -39,15 +39,78 @@ main (int argc, char *argv[])
 {
   struct SolutionData thumbnailffmpeg_video_sol[] =
     {
+      {
+	EXTRACTOR_METATYPE_THUMBNAIL,
+	EXTRACTOR_METAFORMAT_BINARY,
+	"image/png",
+	"",
+	0,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  /* the same image twice, so that the second thumbnail is made
+     with the encoder kept from the first one */
+  struct SolutionData thumbnailffmpeg_image_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_THUMBNAIL,
+	EXTRACTOR_METAFORMAT_BINARY,
+	"image/png",
+	"",
+	0,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData thumbnailffmpeg_image_again_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_THUMBNAIL,
+	EXTRACTOR_METAFORMAT_BINARY,
+	"image/png",
+	"",
+	0,
+	0
+      },
       { 0, 0, NULL, NULL, 0, -1 }
     };
   struct ProblemSet ps[] =
     {
-      { "testdata/thumbnailffmpeg_video.mov",
+      { "testdata/mpeg_melt.mpg",
 	thumbnailffmpeg_video_sol },
+      { "testdata/jpeg_image.jpg",
+	thumbnailffmpeg_image_sol },
+      { "testdata/jpeg_image.jpg",
+	thumbnailffmpeg_image_again_sol },
       { NULL, NULL }
     };
-  return ET_main ("thumbnailffmpeg", ps);
+  /* the first keyframe we look for (at 10% of this 3 MB video) must
+     be within reach with only 1 MB to read */
+  struct SolutionData thumbnailffmpeg_capped_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_THUMBNAIL,
+	EXTRACTOR_METAFORMAT_BINARY,
+	"image/png",
+	"",
+	0,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct ProblemSet capped_ps[] =
+    {
+      { "testdata/mpeg_alien.mpg",
+	thumbnailffmpeg_capped_sol },
+      { NULL, NULL }
+    };
+  int ret;
+
+  ret = ET_main ("thumbnailffmpeg", ps);
+  if (0 != ret)
+    return ret;
+  return ET_main ("thumbnailffmpeg(1048576)", capped_ps);
 }
 
 /* end of test_thumbnailffmpeg.c */
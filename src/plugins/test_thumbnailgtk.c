@@ -58,10 +58,62 @@ main (int argc, char *argv[])
       },
       { 0, 0, NULL, NULL, 0, -1 }
     };
+  /* JPEG with EXIF data, decoded by libjpeg (if available) */
+  struct SolutionData thumbnail_exif_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"1440x1080",
+	strlen ("1440x1080") + 1,
+	0
+      },
+      {
+	EXTRACTOR_METATYPE_THUMBNAIL,
+	EXTRACTOR_METAFORMAT_BINARY,
+	"image/png",
+	(void *) thumbnail_data,
+	sizeof (thumbnail_data),
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  /* fed to the pixbuf loader in chunks; too small for a thumbnail */
+  struct SolutionData thumbnail_png_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"4x4",
+	strlen ("4x4") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
+  struct SolutionData thumbnail_gif_sol[] =
+    {
+      {
+	EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+	EXTRACTOR_METAFORMAT_UTF8,
+	"text/plain",
+	"4x4",
+	strlen ("4x4") + 1,
+	0
+      },
+      { 0, 0, NULL, NULL, 0, -1 }
+    };
   struct ProblemSet ps[] =
     {
       { "testdata/thumbnail_torsten.jpg",
 	thumbnail_torsten_sol },
+      { "testdata/exiv2_iptc.jpg",
+	thumbnail_exif_sol },
+      { "testdata/png_image.png",
+	thumbnail_png_sol },
+      { "testdata/gif_image.gif",
+	thumbnail_gif_sol },
       { NULL, NULL }
     };
   return ET_main ("thumbnailgtk", ps);
@@ -36,7 +36,8 @@
  */
 #include "platform.h"
 #include "extractor.h"
-#include <magic.h>
+#include "mime_signatures.h"
+#include "mime_magic.h"
 
 #if HAVE_LIBAVUTIL_AVUTIL_H
 #include <libavutil/avutil.h>
@@ -110,32 +111,73 @@
 #define PADDED_BUFFER_SIZE (BUFFER_SIZE + FF_INPUT_BUFFER_PADDING_SIZE)
 
 /**
- * Global handle to MAGIC data.
+ * Size of the I/O buffer for libavformat when reading videos.
  */
-static magic_t magic;
+#define IO_BUFFER_SIZE (64 * 1024)
+
+/**
+ * Default for the maximum number of bytes we read from a video
+ * (can be changed with the plugin option).
+ */
+#define DEFAULT_MAX_VIDEO_BYTES (16 * 1024 * 1024)
+
+/**
+ * Thumbnails with a lower average luma are considered black.
+ */
+#define BLACK_LUMA 24
+
+/**
+ * Thumbnails with at least this percentage of the pixels in one
+ * bucket of the luma histogram are considered blank.
+ */
+#define BLANK_PERCENT 90
+
+/**
+ * Source of a video for libavformat.
+ */
+struct VideoSource
+{
+  /**
+   * Context to read the video from.
+   */
+  struct EXTRACTOR_ExtractContext *ec;
+
+  /**
+   * Number of bytes we may still read.
+   */
+  uint64_t bytes_left;
+};
 
 
 /**
  * Read callback.
  *
- * @param opaque the 'struct EXTRACTOR_ExtractContext'
+ * @param opaque the 'struct VideoSource'
  * @param buf where to write data
  * @param buf_size how many bytes to read
- * @return -1 on error (or for unknown file size)
+ * @return number of bytes read, AVERROR_EOF at the end of the file
+ *         (or of our budget), -1 on error
  */
 static int
 read_cb (void *opaque,
 	 uint8_t *buf,
 	 int buf_size)
 {
-  struct EXTRACTOR_ExtractContext *ec = opaque;
+  struct VideoSource *vs = opaque;
   void *data;
   ssize_t ret;
 
-  ret = ec->read (ec->cls, &data, buf_size);
-  if (ret <= 0)
+  if (0 == vs->bytes_left)
+    return AVERROR_EOF;
+  if (buf_size > vs->bytes_left)
+    buf_size = vs->bytes_left;
+  ret = vs->ec->read (vs->ec->cls, &data, buf_size);
+  if (0 == ret)
+    return AVERROR_EOF;
+  if (ret < 0)
     return ret;
   memcpy (buf, data, ret);
+  vs->bytes_left -= ret;
   return ret;
 }
 
@@ -143,7 +185,7 @@ read_cb (void *opaque,
 /**
  * Seek callback.
  *
- * @param opaque the 'struct EXTRACTOR_ExtractContext'
+ * @param opaque the 'struct VideoSource'
  * @param offset where to seek
  * @param whence how to seek; AVSEEK_SIZE to return file size without seeking
  * @return -1 on error (or for unknown file size)
@@ -153,52 +195,169 @@ seek_cb (void *opaque,
 	 int64_t offset,
 	 int whence)
 {
-  struct EXTRACTOR_ExtractContext *ec = opaque;
+  struct VideoSource *vs = opaque;
 
   if (AVSEEK_SIZE == whence)
-    return ec->get_size (ec->cls);
-  return ec->seek (ec->cls, offset, whence);
+    return vs->ec->get_size (vs->ec->cls);
+  return vs->ec->seek (vs->ec->cls, offset, whence);
 }
 
 
+#if LIBAVCODEC_BUILD >= AV_VERSION_INT(54,25,0)
+	#define ENUM_CODEC_ID enum AVCodecID
+#else
+	 #define ENUM_CODEC_ID enum CodecID
+#endif
+
+
+/**
+ * Number of image decoders we keep open.
+ */
+#define MAX_CACHED_DECODERS 4
+
+
+/**
+ * Image decoder we keep open across files.
+ */
+struct CachedDecoder
+{
+  /**
+   * Codec the context was opened for.
+   */
+  ENUM_CODEC_ID codec_id;
+
+  /**
+   * Opened decoder context, NULL if this slot is unused.
+   */
+  AVCodecContext *codec_ctx;
+};
+
+
+/**
+ * Image decoders we keep open across files.  The plugin process
+ * lives for many files, and setting up the contexts costs more than
+ * thumbnailing a typical photo; so all the contexts below are
+ * created on first use, reset between files and only freed when the
+ * library is unloaded.
+ */
+static struct CachedDecoder decoders[MAX_CACHED_DECODERS];
+
+/**
+ * Slot in #decoders to replace next if all are in use.
+ */
+static unsigned int next_decoder;
+
+/**
+ * Frame we decode images into.
+ */
+static AVFrame *image_frame;
+
+/**
+ * Scaler, re-created by sws_getCachedContext() only if the source
+ * format or the source or destination size changes.
+ */
+static struct SwsContext *scaler_ctx;
+
+/**
+ * Opened encoder for the thumbnails, re-opened only if the
+ * thumbnail size changes.
+ */
+static AVCodecContext *encoder_codec_ctx;
+
+/**
+ * Timestamp for the next frame given to #encoder_codec_ctx.  The
+ * MJPEG encoder rejects frames whose pts does not increase, so this
+ * counts up for as long as the encoder is kept.
+ */
+static int64_t encoder_next_pts;
+
+/**
+ * Frame with the scaled image (buffer is large enough for
+ * the largest thumbnail).
+ */
+static AVFrame *dst_frame;
+
+/**
+ * Buffer of #dst_frame.
+ */
+static uint8_t *dst_buffer;
+
+
 /**
- * Rescale and encode a PNG thumbnail.
+ * Allocate a frame.
  *
- * @param src_width source image width
- * @param src_height source image height
- * @param src_stride
- * @param src_pixfmt
- * @param src_data source data
- * @param dst_width desired thumbnail width
- * @param dst_height desired thumbnail height
- * @param output_data where to store the resulting PNG data
- * @param output_max_size maximum size of result that is allowed
- * @return the number of bytes used, 0 on error
+ * @return NULL on error
  */
-static size_t
-create_thumbnail (AVCodecContext *pCodecCtx, int src_width, int src_height,
-		  int src_stride[],
-		  enum AVPixelFormat src_pixfmt,
-		  const uint8_t * const src_data[],
-		  int dst_width, int dst_height,
-		  uint8_t **output_data,
-		  size_t output_max_size)
+static AVFrame *
+frame_alloc ()
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
+  return av_frame_alloc ();
+#else
+  return avcodec_alloc_frame ();
+#endif
+}
+
+
+/**
+ * Free a frame.
+ *
+ * @param frame frame to free, set to NULL
+ */
+static void
+frame_free (AVFrame **frame)
+{
+#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
+  av_frame_free (frame);
+#else
+  avcodec_free_frame (frame);
+#endif
+}
+
+
+/**
+ * Close and free an opened codec context.
+ *
+ * @param codec_ctx context to free, set to NULL
+ */
+static void
+codec_ctx_free (AVCodecContext **codec_ctx)
+{
+  avcodec_close (*codec_ctx);
+  avcodec_free_context (codec_ctx);
+}
+
+
+/**
+ * Get an opened encoder for thumbnails of the given size.  The
+ * encoder is kept and reused for the next file as long as everything
+ * we configure it with (size, and for JPEG also the time base and
+ * bit rate of the source) stays the same.
+ *
+ * @param pCodecCtx codec context of the source
+ * @param dst_width thumbnail width
+ * @param dst_height thumbnail height
+ * @return NULL on error
+ */
+static AVCodecContext *
+get_encoder (AVCodecContext *pCodecCtx,
+	     int dst_width, int dst_height)
 {
-  AVCodecContext *encoder_codec_ctx;
   AVDictionary *opts;
   AVCodec *encoder_codec;
-  struct SwsContext *scaler_ctx;
-  AVFrame *dst_frame;
-  uint8_t *dst_buffer;
-  uint8_t *encoder_output_buffer;
-  size_t encoder_output_buffer_size;
-  int err;
 
-  AVPacket pkt;
-  av_init_packet(&pkt);
-  pkt.data = NULL;
-  pkt.size = 0;
-  int gotPacket;
+  if ( (NULL != encoder_codec_ctx) &&
+       (dst_width == encoder_codec_ctx->width) &&
+       (dst_height == encoder_codec_ctx->height)
+#if USE_JPEG
+       && (pCodecCtx->time_base.num == encoder_codec_ctx->time_base.num) &&
+       (pCodecCtx->time_base.den == encoder_codec_ctx->time_base.den) &&
+       (pCodecCtx->bit_rate == encoder_codec_ctx->bit_rate)
+#endif
+       )
+    return encoder_codec_ctx;
+  if (NULL != encoder_codec_ctx)
+    codec_ctx_free (&encoder_codec_ctx);
 #if USE_JPEG
 	#if LIBAVCODEC_BUILD >= AV_VERSION_INT(54,25,0)
 	if (NULL == (encoder_codec = avcodec_find_encoder ( AV_CODEC_ID_MJPEG )))
@@ -213,54 +372,123 @@ create_thumbnail (AVCodecContext *pCodecCtx, int src_width, int src_height,
       fprintf (stderr,
 	       "Couldn't find a encoder\n");
 #endif
-      return 0;
+      return NULL;
     }
+  if (NULL == (encoder_codec_ctx = avcodec_alloc_context3 (encoder_codec)))
+    {
+#if DEBUG
+      fprintf (stderr,
+               "Failed to allocate the encoder codec context\n");
+#endif
+      return NULL;
+    }
+  encoder_codec_ctx->width = dst_width;
+  encoder_codec_ctx->height = dst_height;
+#if USE_JPEG
+  encoder_codec_ctx->bit_rate      = pCodecCtx->bit_rate;
+#if LIBAVCODEC_BUILD >= AV_VERSION_INT(54,25,0)
+  encoder_codec_ctx->codec_id      = AV_CODEC_ID_MJPEG;
+#else
+  encoder_codec_ctx->codec_id      = CODEC_ID_MJPEG;
+#endif
+#if LIBAVCODEC_BUILD >= AV_VERSION_INT(53,35,0)
+  encoder_codec_ctx->codec_type    = AVMEDIA_TYPE_VIDEO;
+#else
+  encoder_codec_ctx->codec_type    = CODEC_TYPE_VIDEO;
+#endif
+  encoder_codec_ctx->time_base.num = pCodecCtx->time_base.num;
+  encoder_codec_ctx->time_base.den = pCodecCtx->time_base.den;
+  encoder_codec_ctx->pix_fmt = PIX_OUTPUT_FORMAT;
+#else
+  encoder_codec_ctx->pix_fmt = PIX_OUTPUT_FORMAT;
+#endif
+
+  opts = NULL;
+  if (avcodec_open2 (encoder_codec_ctx, encoder_codec, &opts) < 0)
+    {
+#if DEBUG
+      fprintf (stderr,
+               "Failed to open the encoder\n");
+#endif
+      av_dict_free (&opts);
+      avcodec_free_context (&encoder_codec_ctx);
+      return NULL;
+    }
+  av_dict_free (&opts);
+  encoder_next_pts = 1;
+
+#ifdef USE_JPEG
+#if FF_API_MPV_OPT
+   encoder_codec_ctx->mb_lmin        = encoder_codec_ctx->lmin = encoder_codec_ctx->qmin * FF_QP2LAMBDA;
+   encoder_codec_ctx->mb_lmax        = encoder_codec_ctx->lmax = encoder_codec_ctx->qmax * FF_QP2LAMBDA;
+#else
+   encoder_codec_ctx->mb_lmin = encoder_codec_ctx->qmin * FF_QP2LAMBDA;
+   encoder_codec_ctx->mb_lmax = encoder_codec_ctx->qmax * FF_QP2LAMBDA;
+#endif
+   encoder_codec_ctx->flags          = CODEC_FLAG_QSCALE;
+   encoder_codec_ctx->global_quality = encoder_codec_ctx->qmin * FF_QP2LAMBDA;
+#endif
+  return encoder_codec_ctx;
+}
+
 
+/**
+ * Rescale (and colour-convert) an image into #dst_frame.
+ *
+ * @param src_width source image width
+ * @param src_height source image height
+ * @param src_stride
+ * @param src_pixfmt
+ * @param src_data source data
+ * @param dst_width desired thumbnail width
+ * @param dst_height desired thumbnail height
+ * @return 0 on success, -1 on error
+ */
+static int
+scale_image (int src_width, int src_height,
+	     int src_stride[],
+	     enum AVPixelFormat src_pixfmt,
+	     const uint8_t * const src_data[],
+	     int dst_width, int dst_height)
+{
   /* NOTE: the scaler will be used even if the src and dst image dimensions
    * match, because the scaler will also perform colour space conversion */
   if (NULL ==
       (scaler_ctx =
-       sws_getContext (src_width, src_height, src_pixfmt,
-		       dst_width, dst_height,
-                       PIX_OUTPUT_FORMAT,
-                       SWS_BILINEAR, NULL, NULL, NULL)))
+       sws_getCachedContext (scaler_ctx,
+			     src_width, src_height, src_pixfmt,
+			     dst_width, dst_height,
+			     PIX_OUTPUT_FORMAT,
+			     SWS_BILINEAR, NULL, NULL, NULL)))
     {
 #if DEBUG
       fprintf (stderr,
                "Failed to get a scaler context\n");
 #endif
-      return 0;
+      return -1;
     }
 
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-  dst_frame = av_frame_alloc ();
-#else
-  dst_frame = avcodec_alloc_frame();
-#endif
-  if (NULL == dst_frame)
+  if ( (NULL == dst_frame) &&
+       (NULL == (dst_frame = frame_alloc ())) )
     {
 #if DEBUG
       fprintf (stderr,
                "Failed to allocate the destination image frame\n");
 #endif
-      sws_freeContext (scaler_ctx);
-      return 0;
+      return -1;
     }
-  if (NULL == (dst_buffer =
-	       av_malloc (avpicture_get_size (PIX_OUTPUT_FORMAT,
-                                              dst_width, dst_height))))
+  /* thumbnails are never larger than MAX_THUMB_DIMENSION squared */
+  if ( (NULL == dst_buffer) &&
+       (NULL == (dst_buffer =
+		 av_malloc (avpicture_get_size (PIX_OUTPUT_FORMAT,
+						MAX_THUMB_DIMENSION,
+						MAX_THUMB_DIMENSION)))) )
     {
 #if DEBUG
       fprintf (stderr,
                "Failed to allocate the destination image buffer\n");
 #endif
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-      av_frame_free (&dst_frame);
-#else
-      avcodec_free_frame (&dst_frame);
-#endif
-      sws_freeContext (scaler_ctx);
-      return 0;
+      return -1;
     }
   avpicture_fill ((AVPicture *) dst_frame, dst_buffer,
                   PIX_OUTPUT_FORMAT,
@@ -271,133 +499,204 @@ create_thumbnail (AVCodecContext *pCodecCtx, int src_width, int src_height,
              0, src_height,
              dst_frame->data,
              dst_frame->linesize);
+  return 0;
+}
 
-  encoder_output_buffer_size = output_max_size;
-  if (NULL == (encoder_output_buffer = av_malloc (encoder_output_buffer_size)))
-    {
-#if DEBUG
-      fprintf (stderr,
-               "Failed to allocate the encoder output buffer\n");
-#endif
-      av_free (dst_buffer);
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-      av_frame_free (&dst_frame);
-#else
-      avcodec_free_frame (&dst_frame);
-#endif
-      sws_freeContext (scaler_ctx);
-      return 0;
-    }
 
-  if (NULL == (encoder_codec_ctx = avcodec_alloc_context3 (encoder_codec)))
-    {
-#if DEBUG
-      fprintf (stderr,
-               "Failed to allocate the encoder codec context\n");
-#endif
-      av_free (encoder_output_buffer);
-      av_free (dst_buffer);
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-      av_frame_free (&dst_frame);
-#else
-      avcodec_free_frame (&dst_frame);
-#endif
-      sws_freeContext (scaler_ctx);
-      return 0;
-    }
-  encoder_codec_ctx->width = dst_width;
-  encoder_codec_ctx->height = dst_height;
-#if USE_JPEG
-  encoder_codec_ctx->bit_rate      = pCodecCtx->bit_rate;
-#if LIBAVCODEC_BUILD >= AV_VERSION_INT(54,25,0)
-  encoder_codec_ctx->codec_id      = AV_CODEC_ID_MJPEG;
-#else
-  encoder_codec_ctx->codec_id      = CODEC_ID_MJPEG;
-#endif
-#if LIBAVCODEC_BUILD >= AV_VERSION_INT(53,35,0)
-  encoder_codec_ctx->codec_type    = AVMEDIA_TYPE_VIDEO;
-#else
-  encoder_codec_ctx->codec_type    = CODEC_TYPE_VIDEO;
-#endif
-  encoder_codec_ctx->time_base.num = pCodecCtx->time_base.num;
-  encoder_codec_ctx->time_base.den = pCodecCtx->time_base.den;
-  encoder_codec_ctx->pix_fmt = PIX_OUTPUT_FORMAT;
-#else
-  encoder_codec_ctx->pix_fmt = PIX_OUTPUT_FORMAT;
-#endif
+/**
+ * Encode the image in #dst_frame as a thumbnail.
+ *
+ * @param pCodecCtx codec context of the source
+ * @param dst_width width of the image in #dst_frame
+ * @param dst_height height of the image in #dst_frame
+ * @param output_data where to store the resulting thumbnail data
+ * @param output_max_size maximum size of result that is allowed
+ * @return the number of bytes used, 0 on error
+ */
+static size_t
+encode_thumbnail (AVCodecContext *pCodecCtx,
+		  int dst_width, int dst_height,
+		  uint8_t **output_data,
+		  size_t output_max_size)
+{
+  AVCodecContext *encoder;
+  uint8_t *encoder_output_buffer;
+  size_t encoder_output_buffer_size;
+  int err;
 
-  opts = NULL;
-  if (avcodec_open2 (encoder_codec_ctx, encoder_codec, &opts) < 0)
+  AVPacket pkt;
+  av_init_packet(&pkt);
+  pkt.data = NULL;
+  pkt.size = 0;
+  int gotPacket;
+
+  if (NULL == (encoder = get_encoder (pCodecCtx, dst_width, dst_height)))
+    return 0;
+  encoder_output_buffer_size = output_max_size;
+  if (NULL == (encoder_output_buffer = av_malloc (encoder_output_buffer_size)))
     {
 #if DEBUG
       fprintf (stderr,
-               "Failed to open the encoder\n");
-#endif
-      avcodec_free_context (&encoder_codec_ctx);
-      av_free (encoder_output_buffer);
-      av_free (dst_buffer);
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-      av_frame_free (&dst_frame);
-#else
-      avcodec_free_frame (&dst_frame);
+               "Failed to allocate the encoder output buffer\n");
 #endif
-      sws_freeContext  (scaler_ctx);
       return 0;
     }
 
-
-
 #ifdef USE_JPEG
-#if FF_API_MPV_OPT
-   encoder_codec_ctx->mb_lmin        = encoder_codec_ctx->lmin = encoder_codec_ctx->qmin * FF_QP2LAMBDA;
-   encoder_codec_ctx->mb_lmax        = encoder_codec_ctx->lmax = encoder_codec_ctx->qmax * FF_QP2LAMBDA;
-#else
-   encoder_codec_ctx->mb_lmin = encoder_codec_ctx->qmin * FF_QP2LAMBDA;
-   encoder_codec_ctx->mb_lmax = encoder_codec_ctx->qmax * FF_QP2LAMBDA;
-#endif
-   encoder_codec_ctx->flags          = CODEC_FLAG_QSCALE;
-   encoder_codec_ctx->global_quality = encoder_codec_ctx->qmin * FF_QP2LAMBDA;
-
-   dst_frame->pts     = 1;
-   dst_frame->quality = encoder_codec_ctx->global_quality;
+   dst_frame->pts     = encoder_next_pts++;
+   dst_frame->quality = encoder->global_quality;
 #endif
 
 #if LIBAVCODEC_BUILD >= AV_VERSION_INT(54,25,0)
-  err = avcodec_encode_video2 (encoder_codec_ctx,
+  err = avcodec_encode_video2 (encoder,
                               &pkt,
                                dst_frame, &gotPacket);
 
   if(err < 0)
 	goto cleanup;
   err = pkt.size;
-  memcpy(encoder_output_buffer,pkt.data, pkt.size);
+  if (err > encoder_output_buffer_size)
+    err = -1;
+  else
+    memcpy(encoder_output_buffer,pkt.data, pkt.size);
 
   av_free_packet(&pkt);
 
 
 #else
-  err = avcodec_encode_video (encoder_codec_ctx,
+  err = avcodec_encode_video (encoder,
                               encoder_output_buffer,
                               encoder_output_buffer_size, dst_frame);
 
 #endif
 cleanup:
-  av_dict_free (&opts);
-  avcodec_close (encoder_codec_ctx);
-  avcodec_free_context (&encoder_codec_ctx);
-  av_free (dst_buffer);
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-  av_frame_free (&dst_frame);
-#else
-  avcodec_free_frame (&dst_frame);
-#endif
-  sws_freeContext (scaler_ctx);
+  if (err <= 0)
+    {
+      /* do not keep an encoder in an unknown state */
+      codec_ctx_free (&encoder_codec_ctx);
+      av_free (encoder_output_buffer);
+      return 0;
+    }
   *output_data = encoder_output_buffer;
+  return err;
+}
+
+
+/**
+ * Rescale and encode a thumbnail.
+ *
+ * @param src_width source image width
+ * @param src_height source image height
+ * @param src_stride
+ * @param src_pixfmt
+ * @param src_data source data
+ * @param dst_width desired thumbnail width
+ * @param dst_height desired thumbnail height
+ * @param output_data where to store the resulting thumbnail data
+ * @param output_max_size maximum size of result that is allowed
+ * @return the number of bytes used, 0 on error
+ */
+static size_t
+create_thumbnail (AVCodecContext *pCodecCtx, int src_width, int src_height,
+		  int src_stride[],
+		  enum AVPixelFormat src_pixfmt,
+		  const uint8_t * const src_data[],
+		  int dst_width, int dst_height,
+		  uint8_t **output_data,
+		  size_t output_max_size)
+{
+  if (0 != scale_image (src_width, src_height,
+			src_stride, src_pixfmt, src_data,
+			dst_width, dst_height))
+    return 0;
+  return encode_thumbnail (pCodecCtx,
+			   dst_width, dst_height,
+			   output_data, output_max_size);
+}
+
+
+/**
+ * Get an opened decoder for images of the given format, either
+ * from the cache (reset) or newly opened.
+ *
+ * @param image_codec_id ffmpeg codec for the image format
+ * @return NULL on error
+ */
+static AVCodecContext *
+get_image_decoder (ENUM_CODEC_ID image_codec_id)
+{
+  AVDictionary *opts;
+  AVCodecContext *codec_ctx;
+  AVCodec *codec;
+  unsigned int i;
 
-  return err < 0 ? 0 : err;
+  for (i = 0; i < MAX_CACHED_DECODERS; i++)
+    {
+      if ( (NULL == decoders[i].codec_ctx) ||
+	   (image_codec_id != decoders[i].codec_id) )
+	continue;
+      avcodec_flush_buffers (decoders[i].codec_ctx);
+      return decoders[i].codec_ctx;
+    }
+  if (NULL == (codec = avcodec_find_decoder (image_codec_id)))
+    {
+#if DEBUG
+      fprintf (stderr,
+               "No suitable codec found\n");
+#endif
+      return NULL;
+    }
+  if (NULL == (codec_ctx = avcodec_alloc_context3 (codec)))
+    {
+#if DEBUG
+      fprintf (stderr,
+               "Failed to allocate codec context\n");
+#endif
+      return NULL;
+    }
+  opts = NULL;
+  if (0 != avcodec_open2 (codec_ctx, codec, &opts))
+    {
+#if DEBUG
+      fprintf (stderr,
+	       "Failed to open image codec\n");
+#endif
+      av_dict_free (&opts);
+      avcodec_free_context (&codec_ctx);
+      return NULL;
+    }
+  av_dict_free (&opts);
+  for (i = 0; i < MAX_CACHED_DECODERS; i++)
+    if (NULL == decoders[i].codec_ctx)
+      break;
+  if (MAX_CACHED_DECODERS == i)
+    {
+      i = next_decoder;
+      next_decoder = (next_decoder + 1) % MAX_CACHED_DECODERS;
+      codec_ctx_free (&decoders[i].codec_ctx);
+    }
+  decoders[i].codec_id = image_codec_id;
+  decoders[i].codec_ctx = codec_ctx;
+  return codec_ctx;
 }
 
 
+/**
+ * Drop an image decoder from the cache (because it failed and
+ * may be in a bad state).
+ *
+ * @param codec_ctx decoder to drop
+ */
+static void
+drop_image_decoder (AVCodecContext *codec_ctx)
+{
+  unsigned int i;
+
+  for (i = 0; i < MAX_CACHED_DECODERS; i++)
+    if (codec_ctx == decoders[i].codec_ctx)
+      codec_ctx_free (&decoders[i].codec_ctx);
+}
+
 
 /**
  * calculate the thumbnail dimensions, taking pixel aspect into account
@@ -446,12 +745,6 @@ calculate_thumbnail_dimensions (int src_width,
 #endif
 }
 
-#if LIBAVCODEC_BUILD >= AV_VERSION_INT(54,25,0)
-	#define ENUM_CODEC_ID enum AVCodecID
-#else
-	 #define ENUM_CODEC_ID enum CodecID
-#endif
-
 /**
  * Perform thumbnailing when the input is an image.
  *
@@ -462,9 +755,7 @@ static void
 extract_image (ENUM_CODEC_ID image_codec_id,
                struct EXTRACTOR_ExtractContext *ec)
 {
-  AVDictionary *opts;
   AVCodecContext *codec_ctx;
-  AVCodec *codec;
   AVPacket avpkt;
   AVFrame *frame;
   uint8_t *encoded_thumbnail;
@@ -476,48 +767,18 @@ extract_image (ENUM_CODEC_ID image_codec_id,
   void *data;
   unsigned char padded_data[PADDED_BUFFER_SIZE];
 
-  if (NULL == (codec = avcodec_find_decoder (image_codec_id)))
-    {
-#if DEBUG
-      fprintf (stderr,
-               "No suitable codec found\n");
-#endif
-      return;
-    }
-  if (NULL == (codec_ctx = avcodec_alloc_context3 (codec)))
-    {
-#if DEBUG
-      fprintf (stderr,
-               "Failed to allocate codec context\n");
-#endif
-      return;
-    }
-  opts = NULL;
-  if (0 != avcodec_open2 (codec_ctx, codec, &opts))
-    {
-#if DEBUG
-      fprintf (stderr,
-	       "Failed to open image codec\n");
-#endif
-      avcodec_free_context (&codec_ctx);
-      return;
-    }
-  av_dict_free (&opts);
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-  frame = av_frame_alloc ();
-#else
-  frame = avcodec_alloc_frame();
-#endif
-  if (NULL == frame)
+  if ( (NULL == image_frame) &&
+       (NULL == (image_frame = frame_alloc ())) )
     {
 #if DEBUG
       fprintf (stderr,
                "Failed to allocate frame\n");
 #endif
-      avcodec_close (codec_ctx);
-      avcodec_free_context (&codec_ctx);
       return;
     }
+  frame = image_frame;
+  if (NULL == (codec_ctx = get_image_decoder (image_codec_id)))
+    return;
 
   frame_finished = 0;
   while (! frame_finished)
@@ -539,13 +800,7 @@ extract_image (ENUM_CODEC_ID image_codec_id,
       fprintf (stderr,
 	       "Failed to decode a complete frame\n");
 #endif
-#if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-      av_frame_free (&frame);
-#else
-      avcodec_free_frame (&frame);
-#endif
-      avcodec_close (codec_ctx);
-      avcodec_free_context (&codec_ctx);
+      drop_image_decoder (codec_ctx);
       return;
     }
   calculate_thumbnail_dimensions (codec_ctx->width, codec_ctx->height,
@@ -589,12 +844,104 @@ extract_image (ENUM_CODEC_ID image_codec_id,
       av_free (encoded_thumbnail);
     }
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(55,28,1)
-  av_frame_free (&frame);
+  av_frame_unref (frame);
+#endif
+}
+
+
+/**
+ * Where we look for a keyframe for the thumbnail of a video, in
+ * order; we move on if the keyframe we find is blank.
+ */
+struct SeekTarget
+{
+  /**
+   * Position in percent of the duration.
+   */
+  unsigned int percent;
+
+  /**
+   * Position in seconds if the duration is unknown.
+   */
+  unsigned int seconds;
+};
+
+
+/**
+ * Positions we try for thumbnails of videos.
+ */
+static const struct SeekTarget seek_targets[] =
+  {
+    { 10, 10 },
+    { 25, 30 },
+    { 50, 60 }
+  };
+
+
+/**
+ * Get the maximum number of bytes to read from a video.
+ *
+ * @param config plugin option, the number of bytes; NULL for the default
+ * @return maximum number of bytes to read
+ */
+static uint64_t
+get_max_video_bytes (const char *config)
+{
+  unsigned long long max;
+  char dummy;
+
+  if ( (NULL == config) ||
+       (1 != sscanf (config, "%llu%c", &max, &dummy)) ||
+       (0 == max) )
+    return DEFAULT_MAX_VIDEO_BYTES;
+  return max;
+}
+
+
+/**
+ * Check if the image in #dst_frame is black or blank, using a
+ * histogram of the luma.  This is cheap as the image is already
+ * scaled down to thumbnail size.
+ *
+ * @param width width of the image
+ * @param height height of the image
+ * @return 1 if the image is black or blank, 0 if not
+ */
+static int
+is_blank_thumbnail (int width, int height)
+{
+  unsigned int histogram[16];
+  unsigned long long sum;
+  unsigned int pixels;
+  unsigned int luma;
+  const uint8_t *row;
+  int x;
+  int y;
+  unsigned int i;
+
+  memset (histogram, 0, sizeof (histogram));
+  sum = 0;
+  for (y = 0; y < height; y++)
+    {
+      row = dst_frame->data[0] + y * dst_frame->linesize[0];
+      for (x = 0; x < width; x++)
+	{
+#if USE_JPEG
+	  luma = row[x];
 #else
-  avcodec_free_frame (&frame);
+	  luma = (77 * row[3 * x] + 150 * row[3 * x + 1] + 29 * row[3 * x + 2]) >> 8;
 #endif
-  avcodec_close (codec_ctx);
-  avcodec_free_context (&codec_ctx);
+	  histogram[luma >> 4]++;
+	  sum += luma;
+	}
+    }
+  pixels = width * height;
+  if (sum < (unsigned long long) pixels * BLACK_LUMA)
+    return 1;
+  for (i = 0; i < 16; i++)
+    if (histogram[i] * 100ULL >= (unsigned long long) pixels * BLANK_PERCENT)
+      return 1;
+  return 0;
 }
 
 
@@ -613,20 +960,25 @@ extract_video (struct EXTRACTOR_ExtractContext *ec)
   AVCodec *codec;
   AVDictionary *options;
   AVFrame *frame;
+  struct VideoSource vs;
   uint8_t *encoded_thumbnail;
+  int64_t target;
   int video_stream_index;
   int thumb_width;
   int thumb_height;
   int i;
   int err;
   int frame_finished;
+  int scaled;
+  unsigned int c;
   unsigned char *iob;
-  int duration;
 
-  if (NULL == (iob = av_malloc (16 * 1024)))
+  vs.ec = ec;
+  vs.bytes_left = get_max_video_bytes (ec->config);
+  if (NULL == (iob = av_malloc (IO_BUFFER_SIZE)))
     return;
-  if (NULL == (io_ctx = avio_alloc_context (iob, 16 * 1024,
-					    0, ec,
+  if (NULL == (io_ctx = avio_alloc_context (iob, IO_BUFFER_SIZE,
+					    0, &vs,
 					    &read_cb,
 					    NULL /* no writing */,
 					    &seek_cb)))
@@ -705,53 +1057,78 @@ extract_video (struct EXTRACTOR_ExtractContext *ec)
       av_free (io_ctx);
       return;
     }
+  calculate_thumbnail_dimensions (codec_ctx->width, codec_ctx->height,
+                                  codec_ctx->sample_aspect_ratio.num,
+                                  codec_ctx->sample_aspect_ratio.den,
+                                  &thumb_width, &thumb_height);
 
-  if (format_ctx->duration == AV_NOPTS_VALUE)
+  /* we only ever want the keyframe we seek to, so let the decoder
+     drop everything else */
+  codec_ctx->skip_frame = AVDISCARD_NONKEY;
+  scaled = 0;
+  for (c = 0; c < sizeof (seek_targets) / sizeof (seek_targets[0]); c++)
     {
-      duration = -1;
+      if (AV_NOPTS_VALUE != format_ctx->duration)
+	target = format_ctx->duration / 100 * seek_targets[c].percent;
+      else
+	target = (int64_t) seek_targets[c].seconds * AV_TIME_BASE;
+      if (AV_NOPTS_VALUE != format_ctx->start_time)
+	target += format_ctx->start_time;
+      /* seek to the keyframe at or before the target, using the index
+	 of the container if it has one */
+      if (0 > av_seek_frame (format_ctx, -1, target, AVSEEK_FLAG_BACKWARD))
+	{
 #if DEBUG
-      fprintf (stderr,
-               "Duration unknown\n");
+	  fprintf (stderr,
+		   "Failed to seek to %lld\n",
+		   (long long) target);
 #endif
-    }
-  else
-    {
-      duration = format_ctx->duration;
-    }
-
-  /* if duration is known, seek to first tried,
-   * else use 10 sec into stream */
-
-  if(-1 != duration)
-    err = av_seek_frame (format_ctx, -1, (duration/3), 0);
-  else
-    err = av_seek_frame (format_ctx, -1, 10 * AV_TIME_BASE, 0);
-
-  if (err >= 0)
-    avcodec_flush_buffers (codec_ctx);
-  frame_finished = 0;
-
-  while (1)
-    {
-      err = av_read_frame (format_ctx, &packet);
-      if (err < 0)
-        break;
-      if (packet.stream_index == video_stream_index)
-        {
-          avcodec_decode_video2 (codec_ctx,
+	  /* without seeking, we can only use the first keyframe */
+	  if (0 != c)
+	    break;
+	}
+      avcodec_flush_buffers (codec_ctx);
+      frame_finished = 0;
+      while ( (! frame_finished) &&
+	      (0 <= av_read_frame (format_ctx, &packet)) )
+	{
+	  if (packet.stream_index == video_stream_index)
+	    avcodec_decode_video2 (codec_ctx,
+				   frame,
+				   &frame_finished,
+				   &packet);
+	  av_free_packet (&packet);
+	}
+      if (! frame_finished)
+	{
+	  /* end of input (or of our budget), get the frame the
+	     decoder may still be holding on to */
+	  av_init_packet (&packet);
+	  packet.data = NULL;
+	  packet.size = 0;
+	  avcodec_decode_video2 (codec_ctx,
 				 frame,
 				 &frame_finished,
 				 &packet);
-          if (frame_finished && frame->key_frame)
-            {
-              av_free_packet (&packet);
-              break;
-            }
-        }
-      av_free_packet (&packet);
+	}
+      if (! frame_finished)
+	break;
+      if (0 != scale_image (codec_ctx->width, codec_ctx->height,
+			    frame->linesize, codec_ctx->pix_fmt,
+			    (const uint8_t * const *) frame->data,
+			    thumb_width, thumb_height))
+	break;
+      scaled = 1;
+      if (! is_blank_thumbnail (thumb_width, thumb_height))
+	break;
+#if DEBUG
+      fprintf (stderr,
+	       "Keyframe at %lld is blank\n",
+	       (long long) target);
+#endif
     }
 
-  if (! frame_finished)
+  if (! scaled)
     {
 #if DEBUG
       fprintf (stderr,
@@ -767,16 +1144,10 @@ extract_video (struct EXTRACTOR_ExtractContext *ec)
       av_free (io_ctx);
       return;
     }
-  calculate_thumbnail_dimensions (codec_ctx->width, codec_ctx->height,
-                                  codec_ctx->sample_aspect_ratio.num,
-                                  codec_ctx->sample_aspect_ratio.den,
-                                  &thumb_width, &thumb_height);
-
-  err = create_thumbnail (codec_ctx, codec_ctx->width, codec_ctx->height,
-                          frame->linesize, codec_ctx->pix_fmt,
-			  (const uint8_t* const *) frame->data,
-                          thumb_width, thumb_height,
-                          &encoded_thumbnail, MAX_THUMB_BYTES);
+  /* if all keyframes we tried were blank, we use the last one */
+  err = encode_thumbnail (codec_ctx,
+			  thumb_width, thumb_height,
+			  &encoded_thumbnail, MAX_THUMB_BYTES);
   if (err > 0)
     {
 
@@ -860,6 +1231,24 @@ static const struct MIMEToDecoderMapping m2d_map[] =
   };
 
 
+/**
+ * Check if a file of the given type may contain images or video
+ * that ffmpeg can decode.
+ *
+ * @param mime MIME type of the file
+ * @return 1 if so, 0 if we should not bother
+ */
+static int
+is_media_type (const char *mime)
+{
+  return ( (0 == strncmp (mime, "image/", strlen ("image/"))) ||
+	   (0 == strncmp (mime, "video/", strlen ("video/"))) ||
+	   (0 == strncmp (mime, "audio/", strlen ("audio/"))) ||
+	   (0 == strcmp (mime, "application/ogg")) ||
+	   (0 == strcmp (mime, "application/vnd.rn-realmedia")) );
+}
+
+
 /**
  * Main method for the ffmpeg-thumbnailer plugin.
  *
@@ -873,14 +1262,25 @@ EXTRACTOR_thumbnailffmpeg_extract_method (struct EXTRACTOR_ExtractContext *ec)
   void *data;
   const char *mime;
 
-  if (-1 == (iret = ec->read (ec->cls,
-			      &data,
-			      16 * 1024)))
-    return;
-  if (NULL == (mime = magic_buffer (magic, data, iret)))
-    return;
-  if (0 != ec->seek (ec->cls, 0, SEEK_SET))
+  if (0 == ec->wants (ec->cls, EXTRACTOR_METATYPE_THUMBNAIL))
     return;
+  if (NULL != (mime = ec->mime_hint))
+    {
+      if (! is_media_type (mime))
+	return; /* e.g. a PDF or an archive */
+    }
+  else
+    {
+      if (-1 == (iret = ec->read (ec->cls,
+				  &data,
+				  16 * 1024)))
+	return;
+      if ( (NULL == (mime = EXTRACTOR_common_get_mime_type (data, iret))) &&
+	   (NULL == (mime = EXTRACTOR_common_get_magic_mime_type (data, iret))) )
+	return;
+      if (0 != ec->seek (ec->cls, 0, SEEK_SET))
+	return;
+    }
   for (i = 0; NULL != m2d_map[i].mime_type; i++)
     if (0 == strcmp (m2d_map[i].mime_type, mime))
       {
@@ -925,18 +1325,13 @@ thumbnailffmpeg_av_log_callback (void* ptr,
 
 
 /**
- * Initialize av-libs and load magic file.
+ * Initialize av-libs.
  */
 void __attribute__ ((constructor))
 thumbnailffmpeg_lib_init (void)
 {
   av_log_set_callback (&thumbnailffmpeg_av_log_callback);
   av_register_all ();
-  magic = magic_open (MAGIC_MIME_TYPE);
-  if (0 != magic_load (magic, NULL))
-    {
-      /* FIXME: how to deal with errors? */
-    }
 }
 
 
@@ -946,10 +1341,26 @@ thumbnailffmpeg_lib_init (void)
 void __attribute__ ((destructor))
 thumbnailffmpeg_ltdl_fini ()
 {
-  if (NULL != magic)
+  unsigned int i;
+
+  for (i = 0; i < MAX_CACHED_DECODERS; i++)
+    if (NULL != decoders[i].codec_ctx)
+      codec_ctx_free (&decoders[i].codec_ctx);
+  if (NULL != encoder_codec_ctx)
+    codec_ctx_free (&encoder_codec_ctx);
+  if (NULL != image_frame)
+    frame_free (&image_frame);
+  if (NULL != dst_frame)
+    frame_free (&dst_frame);
+  if (NULL != dst_buffer)
     {
-      magic_close (magic);
-      magic = NULL;
+      av_free (dst_buffer);
+      dst_buffer = NULL;
+    }
+  if (NULL != scaler_ctx)
+    {
+      sws_freeContext (scaler_ctx);
+      scaler_ctx = NULL;
     }
 }
 
@@ -24,14 +24,29 @@
  * thumbnail of images (using gdk pixbuf).  The bottom
  * of the file includes a decoder method that can be used
  * to reproduce the 128x128 PNG thumbnails.  We use
- * libmagic to test if the input data is actually an
+ * built-in signatures (and libmagic) to test if the input data is an
  * image before trying to give it to gdk-pixbuf.
+ * JPEGs are decoded with libjpeg at 1/2, 1/4 or 1/8
+ * of their size (or the EXIF thumbnail is used), all
+ * other images are decoded by gdk-pixbuf straight to
+ * the size of the thumbnail where the loader supports it.
  */
 #include "platform.h"
 #include "extractor.h"
-#include <magic.h>
+#include "mime_signatures.h"
+#include "mime_magic.h"
 #include <glib.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#if HAVE_JPEG
+#if WINDOWS || DARWIN
+#if DARWIN
+typedef int boolean;
+#endif
+#define HAVE_BOOLEAN
+#endif
+#include <jpeglib.h>
+#include <setjmp.h>
+#endif
 
 /**
  * Target size for the thumbnails (width and height).
@@ -44,11 +59,581 @@
  */
 #define MAX_IMAGE_SIZE (32 * 1024 * 1024)
 
+/**
+ * Number of bytes we feed to the pixbuf loader in one go.
+ */
+#define LOADER_CHUNK_SIZE (64 * 1024)
+
+
+/**
+ * Compute the size of the thumbnail for an image.
+ *
+ * @param width width of the image
+ * @param height height of the image
+ * @param thumb_width set to the width of the thumbnail
+ * @param thumb_height set to the height of the thumbnail
+ * @return 0 on success, -1 if the image is too small to
+ *         need a thumbnail (or degenerate)
+ */
+static int
+get_thumbnail_size (unsigned long width,
+		    unsigned long height,
+		    unsigned long *thumb_width,
+		    unsigned long *thumb_height)
+{
+  if ( (height <= THUMBSIZE) && (width <= THUMBSIZE) )
+    return -1;
+  if (height > THUMBSIZE)
+    {
+      width = width * THUMBSIZE / height;
+      height = THUMBSIZE;
+    }
+  if (width > THUMBSIZE)
+    {
+      height = height * THUMBSIZE / width;
+      width = THUMBSIZE;
+    }
+  if ( (0 == height) || (0 == width) )
+    return -1;
+  *thumb_width = width;
+  *thumb_height = height;
+  return 0;
+}
+
+
+/**
+ * Report the dimensions of the image.
+ *
+ * @param ec extraction context
+ * @param width width of the image
+ * @param height height of the image
+ * @return return value of 'proc'
+ */
+static int
+send_dimensions (struct EXTRACTOR_ExtractContext *ec,
+		 unsigned long width,
+		 unsigned long height)
+{
+  char format[64];
+
+  snprintf (format,
+	    sizeof (format),
+	    "%ux%u",
+	    (unsigned int) width,
+	    (unsigned int) height);
+  return ec->proc (ec->cls,
+		   "thumbnailgtk",
+		   EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
+		   EXTRACTOR_METAFORMAT_UTF8,
+		   "text/plain",
+		   format,
+		   strlen (format) + 1);
+}
+
+
+/**
+ * Scale the image to the thumbnail size (if it is not already
+ * that size), encode it as PNG and report it.
+ *
+ * @param ec extraction context
+ * @param in image to send, consumed
+ * @param thumb_width width of the thumbnail
+ * @param thumb_height height of the thumbnail
+ */
+static void
+send_thumbnail (struct EXTRACTOR_ExtractContext *ec,
+		GdkPixbuf *in,
+		unsigned long thumb_width,
+		unsigned long thumb_height)
+{
+  GdkPixbuf *out;
+  gchar *thumb;
+  gsize length;
+
+  if ( (thumb_width == gdk_pixbuf_get_width (in)) &&
+       (thumb_height == gdk_pixbuf_get_height (in)) )
+    out = in;
+  else
+    {
+      out = gdk_pixbuf_scale_simple (in, thumb_width, thumb_height,
+				     GDK_INTERP_BILINEAR);
+      g_object_unref (in);
+    }
+  thumb = NULL;
+  length = 0;
+  if (NULL == out)
+    return;
+  if (! gdk_pixbuf_save_to_buffer (out, &thumb,
+				   &length,
+				   "png", NULL,
+				   "compression", "9",
+				   NULL))
+    {
+      g_object_unref (out);
+      return;
+    }
+  g_object_unref (out);
+  if (NULL == thumb)
+    return;
+  ec->proc (ec->cls,
+	    "thumbnailgtk",
+	    EXTRACTOR_METATYPE_THUMBNAIL,
+	    EXTRACTOR_METAFORMAT_BINARY,
+	    "image/png",
+	    thumb, length);
+  g_free (thumb);
+}
+
 
+#if HAVE_JPEG
 /**
- * Global handle to MAGIC data.
+ * Context for our libjpeg error handler.
  */
-static magic_t magic;
+struct JpegContext
+{
+  /**
+   * Environment for longjmp from within error_exit handler.
+   */
+  jmp_buf env;
+
+  /**
+   * Image we are decoding into, freed if libjpeg fails.
+   */
+  GdkPixbuf *pixbuf;
+};
+
+
+/**
+ * Function used to avoid having libjpeg write error messages to the console.
+ */
+static void
+no_emit (j_common_ptr cinfo, int msg_level)
+{
+  /* do nothing */
+}
+
+
+/**
+ * Function used to avoid having libjpeg write error messages to the console.
+ */
+static void
+no_output (j_common_ptr cinfo)
+{
+  /* do nothing */
+}
+
+
+/**
+ * Function used to avoid having libjpeg kill our process.
+ */
+static void
+no_exit (j_common_ptr cinfo)
+{
+  struct JpegContext *ctx = cinfo->client_data;
+
+  /* we're not allowed to return (by API definition),
+     and we don't want to abort/exit.  So we longjmp
+     to our cleanup code instead. */
+  longjmp (ctx->env, 1);
+}
+
+
+/**
+ * Read a 16-bit value from TIFF data.
+ *
+ * @param p where to read
+ * @param big_endian byte order of the TIFF data
+ * @return the value
+ */
+static unsigned int
+tiff_get16 (const unsigned char *p,
+	    int big_endian)
+{
+  if (big_endian)
+    return (p[0] << 8) | p[1];
+  return (p[1] << 8) | p[0];
+}
+
+
+/**
+ * Read a 32-bit value from TIFF data.
+ *
+ * @param p where to read
+ * @param big_endian byte order of the TIFF data
+ * @return the value
+ */
+static uint32_t
+tiff_get32 (const unsigned char *p,
+	    int big_endian)
+{
+  if (big_endian)
+    return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | (p[2] << 8) | p[3];
+  return ((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16) | (p[1] << 8) | p[0];
+}
+
+
+/**
+ * Find the JPEG thumbnail in an EXIF (APP1) segment.  The
+ * thumbnail is described by the second IFD of the TIFF structure.
+ *
+ * @param app1 the APP1 segment
+ * @param app1_len number of bytes in app1
+ * @param thumb_len set to the number of bytes in the thumbnail
+ * @return NULL if there is no (valid) thumbnail
+ */
+static const unsigned char *
+find_exif_thumbnail (const unsigned char *app1,
+		     size_t app1_len,
+		     size_t *thumb_len)
+{
+  const unsigned char *tiff;
+  size_t tiff_len;
+  int big_endian;
+  uint32_t ifd;
+  unsigned int entries;
+  unsigned int i;
+  const unsigned char *entry;
+  uint32_t off;
+  uint32_t len;
+
+  if ( (app1_len < 6 + 8) ||
+       (0 != memcmp (app1, "Exif\0\0", 6)) )
+    return NULL;
+  tiff = app1 + 6;
+  tiff_len = app1_len - 6;
+  if (0 == memcmp (tiff, "MM\0\x2A", 4))
+    big_endian = 1;
+  else if (0 == memcmp (tiff, "II\x2A\0", 4))
+    big_endian = 0;
+  else
+    return NULL;
+  /* skip IFD0, the thumbnail is described by IFD1 */
+  ifd = tiff_get32 (&tiff[4], big_endian);
+  if ( (ifd < 8) ||
+       (ifd > tiff_len - 2) )
+    return NULL;
+  entries = tiff_get16 (&tiff[ifd], big_endian);
+  if ((uint64_t) ifd + 2 + 12 * entries + 4 > tiff_len)
+    return NULL;
+  ifd = tiff_get32 (&tiff[ifd + 2 + 12 * entries], big_endian);
+  if ( (0 == ifd) ||
+       (ifd > tiff_len - 2) )
+    return NULL;
+  entries = tiff_get16 (&tiff[ifd], big_endian);
+  if ((uint64_t) ifd + 2 + 12 * entries > tiff_len)
+    return NULL;
+  off = 0;
+  len = 0;
+  for (i = 0; i < entries; i++)
+    {
+      entry = &tiff[ifd + 2 + 12 * i];
+      switch (tiff_get16 (entry, big_endian))
+	{
+	case 0x0103: /* Compression, 6 is JPEG */
+	  if (6 != tiff_get16 (&entry[8], big_endian))
+	    return NULL;
+	  break;
+	case 0x0201: /* JPEGInterchangeFormat */
+	  off = tiff_get32 (&entry[8], big_endian);
+	  break;
+	case 0x0202: /* JPEGInterchangeFormatLength */
+	  len = tiff_get32 (&entry[8], big_endian);
+	  break;
+	default:
+	  break;
+	}
+    }
+  if ( (0 == off) ||
+       (0 == len) ||
+       (off > tiff_len) ||
+       (len > tiff_len - off) )
+    return NULL;
+  *thumb_len = len;
+  return &tiff[off];
+}
+
+
+/**
+ * Decode a JPEG image at the smallest of the 1/1, 1/2, 1/4 and 1/8
+ * scales libjpeg can produce directly in the IDCT that is still at
+ * least the given size.
+ *
+ * @param data the JPEG image
+ * @param size number of bytes in data
+ * @param min_width minimum width of the result
+ * @param min_height minimum height of the result
+ * @param width set to the (full) width of the JPEG image
+ * @param height set to the (full) height of the JPEG image
+ * @param app1 set to the first EXIF segment, NULL to not look for one
+ * @param app1_len set to the number of bytes in app1
+ * @return NULL on error (or if the image is smaller than required)
+ */
+static GdkPixbuf *
+decode_jpeg (const void *data,
+	     size_t size,
+	     unsigned long min_width,
+	     unsigned long min_height,
+	     unsigned long *width,
+	     unsigned long *height,
+	     const unsigned char **app1,
+	     size_t *app1_len)
+{
+  struct jpeg_decompress_struct jds;
+  struct jpeg_error_mgr em;
+  struct JpegContext ctx;
+  struct jpeg_marker_struct *mptr;
+  guchar *pixels;
+  JSAMPROW row;
+  unsigned int denom;
+  int rowstride;
+
+  ctx.pixbuf = NULL;
+  jpeg_std_error (&em);
+  em.emit_message = &no_emit;
+  em.output_message = &no_output;
+  em.error_exit = &no_exit;
+  jds.client_data = &ctx;
+  if (1 == setjmp (ctx.env))
+    {
+      /* we get here if libjpeg calls 'no_exit' because it wants to die */
+      if (NULL != ctx.pixbuf)
+	g_object_unref (ctx.pixbuf);
+      jpeg_destroy_decompress (&jds);
+      return NULL;
+    }
+  jds.err = &em;
+  jpeg_create_decompress (&jds);
+  if (NULL != app1)
+    jpeg_save_markers (&jds, JPEG_APP0 + 1, 0xFFFF);
+  jpeg_mem_src (&jds, (unsigned char *) data, size);
+  if (JPEG_HEADER_OK != jpeg_read_header (&jds, TRUE))
+    {
+      jpeg_destroy_decompress (&jds);
+      return NULL;
+    }
+  *width = jds.image_width;
+  *height = jds.image_height;
+  if (NULL != app1)
+    {
+      *app1 = NULL;
+      for (mptr = jds.marker_list; NULL != mptr; mptr = mptr->next)
+	if ( (JPEG_APP0 + 1 == mptr->marker) &&
+	     (mptr->data_length >= 6) &&
+	     (0 == memcmp (mptr->data, "Exif\0\0", 6)) )
+	  {
+	    /* the marker data lives until jpeg_destroy_decompress,
+	       so the caller gets a copy */
+	    if (NULL != (*app1 = malloc (mptr->data_length)))
+	      {
+		memcpy ((void *) *app1, mptr->data, mptr->data_length);
+		*app1_len = mptr->data_length;
+	      }
+	    break;
+	  }
+    }
+  if ( (jds.image_width < min_width) ||
+       (jds.image_height < min_height) ||
+       (JCS_CMYK == jds.jpeg_color_space) ||
+       (JCS_YCCK == jds.jpeg_color_space) )
+    {
+      /* too small, or a colour space we leave to gdk-pixbuf */
+      jpeg_destroy_decompress (&jds);
+      return NULL;
+    }
+  for (denom = 8; denom > 1; denom /= 2)
+    if ( ((jds.image_width + denom - 1) / denom >= min_width) &&
+	 ((jds.image_height + denom - 1) / denom >= min_height) )
+      break;
+  jds.scale_num = 1;
+  jds.scale_denom = denom;
+  jds.out_color_space = JCS_RGB;
+  jds.dct_method = JDCT_IFAST;
+  jds.do_fancy_upsampling = FALSE;
+  jpeg_start_decompress (&jds);
+  if (3 != jds.output_components)
+    {
+      jpeg_destroy_decompress (&jds);
+      return NULL;
+    }
+  if (NULL == (ctx.pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB,
+					    FALSE, 8,
+					    jds.output_width,
+					    jds.output_height)))
+    {
+      jpeg_destroy_decompress (&jds);
+      return NULL;
+    }
+  pixels = gdk_pixbuf_get_pixels (ctx.pixbuf);
+  rowstride = gdk_pixbuf_get_rowstride (ctx.pixbuf);
+  while (jds.output_scanline < jds.output_height)
+    {
+      row = pixels + jds.output_scanline * rowstride;
+      jpeg_read_scanlines (&jds, &row, 1);
+    }
+  jpeg_finish_decompress (&jds);
+  jpeg_destroy_decompress (&jds);
+  return ctx.pixbuf;
+}
+
+
+/**
+ * Check if a thumbnail has (nearly) the aspect ratio of the image
+ * (EXIF thumbnails are sometimes padded to 4:3).
+ *
+ * @param width width of the image
+ * @param height height of the image
+ * @param thumb_width width of the thumbnail
+ * @param thumb_height height of the thumbnail
+ * @return 1 if the aspect ratios match within 2%
+ */
+static int
+same_aspect (unsigned long width,
+	     unsigned long height,
+	     unsigned long thumb_width,
+	     unsigned long thumb_height)
+{
+  uint64_t a = (uint64_t) width * thumb_height;
+  uint64_t b = (uint64_t) height * thumb_width;
+
+  return 50 * (a > b ? a - b : b - a) <= a;
+}
+
+
+/**
+ * Create the thumbnail for a JPEG image, preferably from the
+ * thumbnail in the EXIF data, otherwise by decoding the image at a
+ * reduced scale.
+ *
+ * @param ec extraction context
+ * @param buf the JPEG image
+ * @param size number of bytes in buf
+ * @param want_thumb 0 if we only need the dimensions
+ * @return 0 if we are done, -1 if gdk-pixbuf should try
+ */
+static int
+extract_jpeg (struct EXTRACTOR_ExtractContext *ec,
+	      const void *buf,
+	      size_t size,
+	      int want_thumb)
+{
+  GdkPixbuf *in;
+  const unsigned char *app1;
+  const unsigned char *exif_thumb;
+  size_t app1_len;
+  size_t exif_thumb_len;
+  unsigned long width;
+  unsigned long height;
+  unsigned long thumb_width;
+  unsigned long thumb_height;
+  unsigned long exif_width;
+  unsigned long exif_height;
+
+  /* first pass only to learn the size (and get the EXIF data) */
+  width = 0;
+  height = 0;
+  app1 = NULL;
+  decode_jpeg (buf, size,
+	       ULONG_MAX, ULONG_MAX,
+	       &width, &height,
+	       &app1, &app1_len);
+  if ( (0 == width) || (0 == height) )
+    {
+      free ((void *) app1);
+      return -1;
+    }
+  if ( (0 != send_dimensions (ec, width, height)) ||
+       (0 == want_thumb) ||
+       (0 != get_thumbnail_size (width, height,
+				 &thumb_width, &thumb_height)) )
+    {
+      free ((void *) app1);
+      return 0;
+    }
+  in = NULL;
+  if ( (NULL != app1) &&
+       (NULL != (exif_thumb = find_exif_thumbnail (app1, app1_len,
+						   &exif_thumb_len))) )
+    {
+      in = decode_jpeg (exif_thumb, exif_thumb_len,
+			thumb_width, thumb_height,
+			&exif_width, &exif_height,
+			NULL, NULL);
+      if ( (NULL != in) &&
+	   (! same_aspect (width, height, exif_width, exif_height)) )
+	{
+	  g_object_unref (in);
+	  in = NULL;
+	}
+    }
+  free ((void *) app1);
+  if (NULL == in)
+    in = decode_jpeg (buf, size,
+		      thumb_width, thumb_height,
+		      &width, &height,
+		      NULL, NULL);
+  if (NULL == in)
+    return 0; /* dimensions were already sent */
+  send_thumbnail (ec, in, thumb_width, thumb_height);
+  return 0;
+}
+#endif
+
+
+/**
+ * Closure for 'size_prepared_cb'.
+ */
+struct LoaderContext
+{
+  /**
+   * Width of the image.
+   */
+  unsigned long width;
+
+  /**
+   * Height of the image.
+   */
+  unsigned long height;
+
+  /**
+   * 0 if we only need the dimensions.
+   */
+  int want_thumb;
+};
+
+
+/**
+ * Called by the pixbuf loader once it knows the size of the image.
+ * Asks the loader to decode straight to the size of the thumbnail
+ * (for formats where the loader supports this).
+ *
+ * @param loader the loader
+ * @param width width of the image
+ * @param height height of the image
+ * @param cls our 'struct LoaderContext'
+ */
+static void
+size_prepared_cb (GdkPixbufLoader *loader,
+		  gint width,
+		  gint height,
+		  gpointer cls)
+{
+  struct LoaderContext *lc = cls;
+  unsigned long thumb_width;
+  unsigned long thumb_height;
+
+  lc->width = width;
+  lc->height = height;
+  if (0 != get_thumbnail_size (width, height,
+			       &thumb_width, &thumb_height))
+    return;
+  if (0 == lc->want_thumb)
+    {
+      /* we only want the size, keep the loader from wasting memory */
+      thumb_width = 1;
+      thumb_height = 1;
+    }
+  gdk_pixbuf_loader_set_size (loader, thumb_width, thumb_height);
+}
 
 
 /**
@@ -59,135 +644,125 @@ static magic_t magic;
 void
 EXTRACTOR_thumbnailgtk_extract_method (struct EXTRACTOR_ExtractContext *ec)
 {
+  struct LoaderContext lc;
   GdkPixbufLoader *loader;
   GdkPixbuf *in;
-  GdkPixbuf *out;
-  size_t length;
-  char *thumb;
-  unsigned long width;
-  unsigned long height;
-  char format[64];
+  unsigned long thumb_width;
+  unsigned long thumb_height;
   void *data;
   uint64_t size;
   size_t off;
   ssize_t iret;
-  void *buf;
   const char *mime;
+  int want_thumb;
+  int ok;
 
+  want_thumb = ec->wants (ec->cls, EXTRACTOR_METATYPE_THUMBNAIL);
+  if ( (0 == want_thumb) &&
+       (0 == ec->wants (ec->cls, EXTRACTOR_METATYPE_IMAGE_DIMENSIONS)) )
+    return;
+  if ( (NULL != ec->mime_hint) &&
+       (0 != strncmp (ec->mime_hint,
+		      "image/",
+		      strlen ("image/"))) )
+    return; /* not an image */
   if (-1 == (iret = ec->read (ec->cls,
 			      &data,
 			      16 * 1024)))
     return;
-  if (NULL == (mime = magic_buffer (magic, data, iret)))
+  if ( (NULL == (mime = ec->mime_hint)) &&
+       (NULL == (mime = EXTRACTOR_common_get_mime_type (data, iret))) &&
+       (NULL == (mime = EXTRACTOR_common_get_magic_mime_type (data, iret))) )
     return;
   if (0 != strncmp (mime,
 		    "image/",
 		    strlen ("image/")))
     return; /* not an image */
 
-  /* read entire image into memory */
   size = ec->get_size (ec->cls);
   if (UINT64_MAX == size)
     size = MAX_IMAGE_SIZE; /* unknown size, cap at max */
   if (size > MAX_IMAGE_SIZE)
     return; /* FAR too big to be an image */
-  if (NULL == (buf = malloc (size)))
-    return; /* too big to fit into memory on this system */
-
-  /* start with data already read */
-  memcpy (buf, data, iret);
-  off = iret;
-  while (off < size)
+#if HAVE_JPEG
+  if (0 == strcmp (mime, "image/jpeg"))
     {
-      iret = ec->read (ec->cls, &data, size - off);
-      if (iret <= 0)
+      void *buf;
+
+      /* libjpeg needs the entire image in memory */
+      if (NULL == (buf = malloc (size)))
+	return; /* too big to fit into memory on this system */
+      /* start with data already read */
+      memcpy (buf, data, iret);
+      off = iret;
+      while (off < size)
+	{
+	  iret = ec->read (ec->cls, &data, size - off);
+	  if (iret <= 0)
+	    break;
+	  memcpy (buf + off, data, iret);
+	  off += iret;
+	}
+      if ( (off < size) ||
+	   (0 == extract_jpeg (ec, buf, size, want_thumb)) )
 	{
-	  /* io error */
 	  free (buf);
 	  return;
 	}
-      memcpy (buf + off, data, iret);
-      off += iret;
-    }
-
-  loader = gdk_pixbuf_loader_new ();
-  gdk_pixbuf_loader_write (loader, 
-			   buf, 
-			   size, NULL);
-  free (buf);
-  in = gdk_pixbuf_loader_get_pixbuf (loader);
-  gdk_pixbuf_loader_close (loader, NULL);
-  if (NULL == in)
-    {
-      g_object_unref (loader);
-      return;
-    }
-  g_object_ref (in);
-  g_object_unref (loader);
-  height = gdk_pixbuf_get_height (in);
-  width = gdk_pixbuf_get_width (in);
-  snprintf (format, 
-	    sizeof (format),
-	    "%ux%u",
-	    (unsigned int) width, 
-	    (unsigned int) height);
-  if (0 != ec->proc (ec->cls,
-		     "thumbnailgtk",
-		     EXTRACTOR_METATYPE_IMAGE_DIMENSIONS,
-		     EXTRACTOR_METAFORMAT_UTF8,
-		     "text/plain",
-		     format,
-		     strlen (format) + 1))
-    {
-      g_object_unref (in);
-      return;
-    }
-  if ((height <= THUMBSIZE) && (width <= THUMBSIZE))
-    {
-      g_object_unref (in);
-      return;
+      /* let gdk-pixbuf try, starting from the data we already have */
+      lc.width = 0;
+      lc.height = 0;
+      lc.want_thumb = want_thumb;
+      loader = gdk_pixbuf_loader_new ();
+      g_signal_connect (loader, "size-prepared",
+			G_CALLBACK (&size_prepared_cb), &lc);
+      ok = gdk_pixbuf_loader_write (loader, buf, size, NULL);
+      free (buf);
+      off = size;
     }
-  if (height > THUMBSIZE)
+  else
+#endif
     {
-      width = width * THUMBSIZE / height;
-      height = THUMBSIZE;
+      /* feed the image to the loader as we read it */
+      lc.width = 0;
+      lc.height = 0;
+      lc.want_thumb = want_thumb;
+      loader = gdk_pixbuf_loader_new ();
+      g_signal_connect (loader, "size-prepared",
+			G_CALLBACK (&size_prepared_cb), &lc);
+      ok = gdk_pixbuf_loader_write (loader, data, iret, NULL);
+      off = iret;
     }
-  if (width > THUMBSIZE)
+  while ( ok &&
+	  (off < size) &&
+	  ( (0 == lc.width) ||
+	    (0 != want_thumb) ) )
     {
-      height = height * THUMBSIZE / width;
-      width = THUMBSIZE;
+      iret = ec->read (ec->cls, &data, LOADER_CHUNK_SIZE);
+      if (iret <= 0)
+	break;
+      ok = gdk_pixbuf_loader_write (loader, data, iret, NULL);
+      off += iret;
     }
-  if ( (0 == height) || (0 == width) )
+  gdk_pixbuf_loader_close (loader, NULL);
+  if ( (0 == lc.width) ||
+       (0 == lc.height) )
     {
-      g_object_unref (in);
+      g_object_unref (loader);
       return;
     }
-  out = gdk_pixbuf_scale_simple (in, width, height,
-				 GDK_INTERP_BILINEAR);
-  g_object_unref (in);
-  thumb = NULL;
-  length = 0;
-  if (NULL == out)
-    return;
-  if (! gdk_pixbuf_save_to_buffer (out, &thumb, 
-				   &length, 
-				   "png", NULL, 
-				   "compression", "9", 
-				   NULL))
+  if ( (0 != send_dimensions (ec, lc.width, lc.height)) ||
+       (0 == want_thumb) ||
+       (0 != get_thumbnail_size (lc.width, lc.height,
+				 &thumb_width, &thumb_height)) ||
+       (NULL == (in = gdk_pixbuf_loader_get_pixbuf (loader))) )
     {
-      g_object_unref (out);
+      g_object_unref (loader);
       return;
     }
-  g_object_unref (out);
-  if (NULL == thumb)
-    return;
-  ec->proc (ec->cls,
-	    "thumbnailgtk",
-	    EXTRACTOR_METATYPE_THUMBNAIL,
-	    EXTRACTOR_METAFORMAT_BINARY,
-	    "image/png",
-	    thumb, length);  
-  free (thumb);
+  g_object_ref (in);
+  g_object_unref (loader);
+  send_thumbnail (ec, in, thumb_width, thumb_height);
 }
 
 
@@ -205,7 +780,7 @@ EXTRACTOR_thumbnail_extract_method (struct EXTRACTOR_ExtractContext *ec)
 
 
 /**
- * Initialize glib and load magic file.
+ * Initialize glib.
  */
 void __attribute__ ((constructor)) 
 thumbnailgtk_gobject_init ()
@@ -213,25 +788,6 @@ thumbnailgtk_gobject_init ()
 #if !GLIB_CHECK_VERSION(2, 35, 0)
   g_type_init ();
 #endif
-  magic = magic_open (MAGIC_MIME_TYPE);
-  if (0 != magic_load (magic, NULL))
-    {
-      /* FIXME: how to deal with errors? */
-    }
-}
-
-
-/**
- * Destructor for the library, cleans up.
- */
-void __attribute__ ((destructor)) 
-thumbnailgtk_ltdl_fini () 
-{
-  if (NULL != magic)
-    {
-      magic_close (magic);
-      magic = NULL;
-    }
 }
 
 /* end of thumbnailgtk_extractor.c */